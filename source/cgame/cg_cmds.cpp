@@ -1162,6 +1162,7 @@ static const cgcmd_t cgcmds[] =
 	{ "weapcross", CG_Cmd_WeaponCross_f, true },
 	{ "viewpos", CG_Viewpos_f, true },
 	{ "centerview", CG_CenterViewCmd_f, false },
+	{ "effectstats", CG_PoolStats_f, true },
 	{ "players", NULL, false },
 	{ "spectators", NULL, false },
 
@@ -19,13 +19,30 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 */
 #include "cg_local.h"
 
-#define MAX_DECALS          512
+#define MAX_DECALS          1024
 #define MAX_DECAL_VERTS     64
-#define MAX_DECAL_FRAGMENTS 64
+
+#define DECAL_CACHE_SIZE        128
+#define DECAL_CACHE_HASH_SIZE   256
+
+// coarse steps for impact decals, so that repeated hits on a spot share fragments
+#define DECAL_ORIGIN_STEP           2.0f
+#define DECAL_ORIENT_STEP           5.0f
+#define DECAL_RADIUS_STEP           1.0f
+
+// fine steps for decals that follow entities
+#define DECAL_PRECISE_ORIGIN_STEP   0.125f
+#define DECAL_PRECISE_ORIENT_STEP   0.25f
+#define DECAL_PRECISE_RADIUS_STEP   0.125f
+
+#define DECAL_NORMAL_SCALE          1024.0f
+
+#define DECAL_REQUEST_PIPE_SIZE     0x4000
+#define DECAL_RESULT_PIPE_SIZE      0x40000
 
 typedef struct cdecal_s
 {
-	struct cdecal_s *prev, *next;
+	cg_poolnode_t node;
 
 	int64_t die;                   // remove after this time
 	int64_t fadetime;
@@ -36,40 +53,397 @@ typedef struct cdecal_s
 	struct shader_s *shader;
 
 	poly_t *poly;
+
+	poly_t drawpoly;
+	vec4_t verts[MAX_DECAL_VERTS];
+	vec4_t norms[MAX_DECAL_VERTS];
+	vec2_t stcoords[MAX_DECAL_VERTS];
+	byte_vec4_t colors[MAX_DECAL_VERTS];
 } cdecal_t;
 
-static cdecal_t cg_decals[MAX_DECALS];
-static cdecal_t cg_decals_headnode, *cg_free_decals;
+// quantized placement, all ints so keys can be hashed and compared as memory
+typedef struct {
+	int origin[3];
+	int normal[3];
+	int orient;                     // in steps, modulo 90 degrees as the clipping box is square
+	int radius;
+	int precise;
+} cdecalkey_t;
+
+// placement snapped to the key
+typedef struct {
+	cdecalkey_t key;
+	vec3_t origin;
+	vec3_t axis[3];
+	float radius;
+} cdecalplace_t;
+
+typedef struct cdecalcache_s {
+	cdecalkey_t key;
+	struct cdecalcache_s *hashNext;
+	struct cdecalcache_s *prev, *next;  // most recently used first
+	cg_decalfragments_t frags;
+} cdecalcache_t;
+
+typedef struct {
+	int64_t die;
+	int64_t fadetime;
+	float fadefreq;
+	bool fadealpha;
+	float color[4];
+	struct shader_s *shader;
+} cdecalparams_t;
 
-static poly_t cg_decal_polys[MAX_DECALS];
-static vec4_t cg_decal_verts[MAX_DECALS][MAX_DECAL_VERTS];
-static vec4_t cg_decal_norms[MAX_DECALS][MAX_DECAL_VERTS];
-static vec2_t cg_decal_stcoords[MAX_DECALS][MAX_DECAL_VERTS];
-static byte_vec4_t cg_decal_colors[MAX_DECALS][MAX_DECAL_VERTS];
+enum
+{
+	DECAL_CMD_CLIP,
+	DECAL_CMD_CLEAR,
+	DECAL_CMD_SHUTDOWN,
+
+	DECAL_NUM_CMDS
+};
+
+enum
+{
+	DECAL_CMD_RESULT,
+
+	DECAL_NUM_RESULT_CMDS
+};
+
+typedef struct {
+	int id;
+	cdecalplace_t place;
+	cdecalparams_t params;
+} cdecalclipcmd_t;
+
+// followed by numverts vertices and numfragments fragments
+typedef struct {
+	int id;
+	int numverts, numfragments;
+	cdecalplace_t place;
+	cdecalparams_t params;
+} cdecalresultcmd_t;
+
+typedef unsigned (*queueCmdHandler_t)( const void * );
+
+static cg_pool_t cg_decals;
+
+static cdecalcache_t cg_decalCache[DECAL_CACHE_SIZE];
+static cdecalcache_t *cg_decalCacheHash[DECAL_CACHE_HASH_SIZE];
+static cdecalcache_t cg_decalCacheHead;
+static int cg_numDecalCache;
+
+static qthread_t *cg_decalThread;
+static qbufPipe_t *cg_decalRequests;
+static qbufPipe_t *cg_decalResults;
+static bool cg_discardDecalResults;
+
+// owned by the clipping thread
+static struct {
+	cdecalkey_t key;
+	bool valid;
+	vec4_t verts[MAX_DECAL_CACHE_VERTS];
+	fragment_t fragments[MAX_DECAL_CACHE_FRAGMENTS];
+	uint8_t cmd[sizeof( cdecalresultcmd_t ) + sizeof( vec4_t ) * MAX_DECAL_CACHE_VERTS + sizeof( fragment_t ) * MAX_DECAL_CACHE_FRAGMENTS];
+} cg_decalClip;
 
 /*
-* CG_ClearDecals
+* CG_PlaceDecal
+*
+* Snaps the decal to the cache grid and calculates its orientation matrix
 */
-void CG_ClearDecals( void ) {
-	int i;
+static void CG_PlaceDecal( cdecalplace_t *place, const vec3_t origin, const vec3_t dir, float orient, float radius, bool precise ) {
+	int i, steps, stepsPerQuadrant;
+	float originStep, orientStep, radiusStep;
+	vec3_t normal;
+	cdecalkey_t *key = &place->key;
+
+	if( precise ) {
+		originStep = DECAL_PRECISE_ORIGIN_STEP;
+		orientStep = DECAL_PRECISE_ORIENT_STEP;
+		radiusStep = DECAL_PRECISE_RADIUS_STEP;
+	} else {
+		originStep = DECAL_ORIGIN_STEP;
+		orientStep = DECAL_ORIENT_STEP;
+		radiusStep = DECAL_RADIUS_STEP;
+	}
+
+	memset( key, 0, sizeof( *key ) );
+	key->precise = precise ? 1 : 0;
+
+	VectorNormalize2( dir, normal );
+	for( i = 0; i < 3; i++ ) {
+		key->origin[i] = (int)floorf( origin[i] / originStep + 0.5f );
+		place->origin[i] = key->origin[i] * originStep;
+		key->normal[i] = (int)floorf( normal[i] * DECAL_NORMAL_SCALE + 0.5f );
+		normal[i] = key->normal[i] / DECAL_NORMAL_SCALE;
+	}
+
+	steps = (int)floorf( orient / orientStep + 0.5f );
+	stepsPerQuadrant = (int)( 90.0f / orientStep );
+	key->orient = ( ( steps % stepsPerQuadrant ) + stepsPerQuadrant ) % stepsPerQuadrant;
+	orient = steps * orientStep;
+
+	key->radius = (int)floorf( radius / radiusStep + 0.5f );
+	if( key->radius < 1 ) {
+		key->radius = 1;
+	}
+	place->radius = key->radius * radiusStep;
+
+	// calculate orientation matrix
+	VectorNormalize2( normal, place->axis[0] );
+	PerpendicularVector( place->axis[1], place->axis[0] );
+	RotatePointAroundVector( place->axis[2], place->axis[0], place->axis[1], orient );
+	CrossProduct( place->axis[0], place->axis[2], place->axis[1] );
+}
+
+/*
+* CG_DecalKeyHash
+*/
+static unsigned CG_DecalKeyHash( const cdecalkey_t *key ) {
+	unsigned i, hash = 0;
+	const int *v = ( const int * )key;
+
+	for( i = 0; i < sizeof( *key ) / sizeof( int ); i++ ) {
+		hash = hash * 31 + v[i];
+	}
+	return ( hash ^ ( hash >> 16 ) ) & ( DECAL_CACHE_HASH_SIZE - 1 );
+}
+
+/*
+* CG_ClearDecalCache
+*/
+static void CG_ClearDecalCache( void ) {
+	memset( cg_decalCacheHash, 0, sizeof( cg_decalCacheHash ) );
+	cg_decalCacheHead.prev = cg_decalCacheHead.next = &cg_decalCacheHead;
+	cg_numDecalCache = 0;
+}
+
+/*
+* CG_FindDecalCache
+*/
+static cdecalcache_t *CG_FindDecalCache( const cdecalkey_t *key ) {
+	cdecalcache_t *dc;
+
+	for( dc = cg_decalCacheHash[CG_DecalKeyHash( key )]; dc; dc = dc->hashNext ) {
+		if( !memcmp( &dc->key, key, sizeof( *key ) ) ) {
+			// move to the front of the LRU list
+			dc->prev->next = dc->next;
+			dc->next->prev = dc->prev;
+			dc->prev = &cg_decalCacheHead;
+			dc->next = cg_decalCacheHead.next;
+			dc->next->prev = dc;
+			dc->prev->next = dc;
+			return dc;
+		}
+	}
+
+	return NULL;
+}
+
+/*
+* CG_AllocDecalCache
+*
+* Returns an empty entry for the key, recycling the least recently used one
+*/
+static cdecalcache_t *CG_AllocDecalCache( const cdecalkey_t *key ) {
+	unsigned hash;
+	cdecalcache_t *dc, **prev;
 
-	memset( cg_decals, 0, sizeof( cg_decals ) );
+	if( !cg_decalCacheHead.next ) {
+		CG_ClearDecalCache();
+	}
 
-	// link decals
-	cg_free_decals = cg_decals;
-	cg_decals_headnode.prev = &cg_decals_headnode;
-	cg_decals_headnode.next = &cg_decals_headnode;
-	for( i = 0; i < MAX_DECALS; i++ ) {
-		if( i < MAX_DECALS - 1 ) {
-			cg_decals[i].next = &cg_decals[i + 1];
+	if( cg_numDecalCache < DECAL_CACHE_SIZE ) {
+		dc = &cg_decalCache[cg_numDecalCache++];
+	} else {
+		dc = cg_decalCacheHead.prev;
+		dc->prev->next = dc->next;
+		dc->next->prev = dc->prev;
+
+		for( prev = &cg_decalCacheHash[CG_DecalKeyHash( &dc->key )]; *prev; prev = &( *prev )->hashNext ) {
+			if( *prev == dc ) {
+				*prev = dc->hashNext;
+				break;
+			}
 		}
+	}
+
+	hash = CG_DecalKeyHash( key );
+	dc->key = *key;
+	dc->hashNext = cg_decalCacheHash[hash];
+	cg_decalCacheHash[hash] = dc;
+
+	dc->prev = &cg_decalCacheHead;
+	dc->next = cg_decalCacheHead.next;
+	dc->next->prev = dc;
+	dc->prev->next = dc;
+
+	dc->frags.numverts = dc->frags.numfragments = 0;
+	return dc;
+}
+
+/*
+* CG_CountFragmentVerts
+*/
+static int CG_CountFragmentVerts( const fragment_t *fragments, int numfragments ) {
+	int i, numverts = 0;
 
-		cg_decals[i].poly = &cg_decal_polys[i];
-		cg_decals[i].poly->verts = cg_decal_verts[i];
-		cg_decals[i].poly->normals = cg_decal_norms[i];
-		cg_decals[i].poly->stcoords = cg_decal_stcoords[i];
-		cg_decals[i].poly->colors = cg_decal_colors[i];
+	for( i = 0; i < numfragments; i++ ) {
+		if( fragments[i].numverts > 0 && fragments[i].firstvert + fragments[i].numverts > numverts ) {
+			numverts = fragments[i].firstvert + fragments[i].numverts;
+		}
 	}
+	return numverts;
+}
+
+/*
+* CG_ClipDecalCache
+*/
+static cdecalcache_t *CG_ClipDecalCache( cdecalplace_t *place ) {
+	cdecalcache_t *dc = CG_AllocDecalCache( &place->key );
+
+	dc->frags.numfragments = trap_R_GetClippedFragments( place->origin, place->radius, place->axis,
+														 MAX_DECAL_CACHE_VERTS, dc->frags.verts, MAX_DECAL_CACHE_FRAGMENTS, dc->frags.fragments );
+	dc->frags.numverts = CG_CountFragmentVerts( dc->frags.fragments, dc->frags.numfragments );
+	return dc;
+}
+
+/*
+* CG_GetDecalFragments
+*
+* Returns the clipped fragments of a decal following an entity, clipping them now
+* if they aren't cached. The placement is snapped to what the fragments were
+* clipped with.
+*/
+const cg_decalfragments_t *CG_GetDecalFragments( const vec3_t origin, const vec3_t dir, float orient, float radius,
+												 vec3_t placedOrigin, vec3_t placedAxis[3], float *placedRadius ) {
+	cdecalplace_t place;
+	cdecalcache_t *dc;
+
+	CG_PlaceDecal( &place, origin, dir, orient, radius, true );
+
+	dc = CG_FindDecalCache( &place.key );
+	if( !dc ) {
+		dc = CG_ClipDecalCache( &place );
+	}
+
+	VectorCopy( place.origin, placedOrigin );
+	VectorCopy( place.axis[0], placedAxis[0] );
+	VectorCopy( place.axis[1], placedAxis[1] );
+	VectorCopy( place.axis[2], placedAxis[2] );
+	*placedRadius = place.radius;
+	return &dc->frags;
+}
+
+/*
+* CG_HandleClipCmd
+*/
+static unsigned CG_HandleClipCmd( const void *pcmd ) {
+	int numverts, numfragments;
+	cdecalclipcmd_t cmd;
+	cdecalresultcmd_t *result = ( cdecalresultcmd_t * )cg_decalClip.cmd;
+	uint8_t *data;
+
+	memcpy( &cmd, pcmd, sizeof( cmd ) );
+
+	// repeated hits on the same spot are likely to be queued before the first result is back
+	if( !cg_decalClip.valid || memcmp( &cg_decalClip.key, &cmd.place.key, sizeof( cmd.place.key ) ) ) {
+		// the renderer's clipper only reads the world model, so it's safe to call from here
+		numfragments = trap_R_GetClippedFragments( cmd.place.origin, cmd.place.radius, cmd.place.axis,
+												   MAX_DECAL_CACHE_VERTS, cg_decalClip.verts, MAX_DECAL_CACHE_FRAGMENTS, cg_decalClip.fragments );
+
+		numverts = CG_CountFragmentVerts( cg_decalClip.fragments, numfragments );
+
+		data = cg_decalClip.cmd + sizeof( *result );
+		memcpy( data, cg_decalClip.verts, sizeof( vec4_t ) * numverts );
+		memcpy( data + sizeof( vec4_t ) * numverts, cg_decalClip.fragments, sizeof( fragment_t ) * numfragments );
+
+		result->id = DECAL_CMD_RESULT;
+		result->numverts = numverts;
+		result->numfragments = numfragments;
+		cg_decalClip.key = cmd.place.key;
+		cg_decalClip.valid = true;
+	}
+
+	result->place = cmd.place;
+	result->params = cmd.params;
+
+	trap_BufPipe_WriteCmd( cg_decalResults, result,
+						   sizeof( *result ) + sizeof( vec4_t ) * result->numverts + sizeof( fragment_t ) * result->numfragments );
+
+	return sizeof( cmd );
+}
+
+/*
+* CG_HandleClearCmd
+*/
+static unsigned CG_HandleClearCmd( const void *pcmd ) {
+	cg_decalClip.valid = false;
+	return sizeof( int );
+}
+
+/*
+* CG_HandleShutdownCmd
+*/
+static unsigned CG_HandleShutdownCmd( const void *pcmd ) {
+	return 0;
+}
+
+/*
+* CG_DecalCmdsWaiter
+*/
+static int CG_DecalCmdsWaiter( qbufPipe_t *queue, queueCmdHandler_t *cmdHandlers, bool timeout ) {
+	return trap_BufPipe_ReadCmds( queue, cmdHandlers );
+}
+
+/*
+* CG_DecalThreadProc
+*/
+static void *CG_DecalThreadProc( void *param ) {
+	queueCmdHandler_t cmdHandlers[DECAL_NUM_CMDS] =
+	{
+		(queueCmdHandler_t)CG_HandleClipCmd,
+		(queueCmdHandler_t)CG_HandleClearCmd,
+		(queueCmdHandler_t)CG_HandleShutdownCmd,
+	};
+
+	trap_BufPipe_Wait( ( qbufPipe_t * )param, CG_DecalCmdsWaiter, cmdHandlers, Q_THREADS_WAIT_INFINITE );
+
+	return NULL;
+}
+
+/*
+* CG_InitDecalThread
+*/
+static void CG_InitDecalThread( void ) {
+	if( cg_decalRequests ) {
+		return;
+	}
+
+	cg_decalRequests = trap_BufPipe_Create( DECAL_REQUEST_PIPE_SIZE, 0 );
+	cg_decalResults = trap_BufPipe_Create( DECAL_RESULT_PIPE_SIZE, 0 );
+	cg_decalThread = trap_Thread_Create( CG_DecalThreadProc, cg_decalRequests );
+}
+
+/*
+* CG_ShutdownDecalThread
+*/
+static void CG_ShutdownDecalThread( void ) {
+	int cmd = DECAL_CMD_SHUTDOWN;
+
+	if( !cg_decalRequests ) {
+		return;
+	}
+
+	if( cg_decalThread ) {
+		trap_BufPipe_WriteCmd( cg_decalRequests, &cmd, sizeof( cmd ) );
+		trap_Thread_Join( cg_decalThread );
+		cg_decalThread = NULL;
+	}
+
+	trap_BufPipe_Destroy( &cg_decalRequests );
+	trap_BufPipe_Destroy( &cg_decalResults );
 }
 
 /*
@@ -80,22 +454,14 @@ void CG_ClearDecals( void ) {
 static cdecal_t *CG_AllocDecal( void ) {
 	cdecal_t *dl;
 
-	if( cg_free_decals ) {
-		// take a free decal if possible
-		dl = cg_free_decals;
-		cg_free_decals = dl->next;
-	} else {
-		// grab the oldest one otherwise
-		dl = cg_decals_headnode.prev;
-		dl->prev->next = dl->next;
-		dl->next->prev = dl->prev;
-	}
+	dl = ( cdecal_t * )CG_PoolAlloc( &cg_decals, true );
 
-	// put the decal at the start of the list
-	dl->prev = &cg_decals_headnode;
-	dl->next = cg_decals_headnode.next;
-	dl->next->prev = dl;
-	dl->prev->next = dl;
+	memset( &dl->drawpoly, 0, sizeof( dl->drawpoly ) );
+	dl->poly = &dl->drawpoly;
+	dl->poly->verts = dl->verts;
+	dl->poly->normals = dl->norms;
+	dl->poly->stcoords = dl->stcoords;
+	dl->poly->colors = dl->colors;
 
 	return dl;
 }
@@ -104,30 +470,140 @@ static cdecal_t *CG_AllocDecal( void ) {
 * CG_FreeDecal
 */
 static void CG_FreeDecal( cdecal_t *dl ) {
-	// remove from linked active list
-	dl->prev->next = dl->next;
-	dl->next->prev = dl->prev;
-
-	// insert into linked free list
-	dl->next = cg_free_decals;
-	cg_free_decals = dl;
+	CG_PoolFree( &cg_decals, dl );
 }
 
 /*
-* CG_SpawnDecal
+* CG_SpawnDecalFragments
 */
-int CG_SpawnDecal( const vec3_t origin, const vec3_t dir, float orient, float radius,
-				   float r, float g, float b, float a, float die, float fadetime, bool fadealpha, struct shader_s *shader ) {
+static void CG_SpawnDecalFragments( const cdecalplace_t *place, const cdecalparams_t *params, const cg_decalfragments_t *frags ) {
 	int i, j;
 	cdecal_t *dl;
 	poly_t *poly;
-	vec3_t axis[3];
-	vec4_t verts[MAX_DECAL_VERTS];
-	vec3_t v;
+	vec3_t v, axis[2];
 	byte_vec4_t color;
-	fragment_t *fr, fragments[MAX_DECAL_FRAGMENTS];
-	int numfragments;
-	float dietime, fadefreq;
+	const fragment_t *fr;
+	float scale;
+
+	color[0] = ( uint8_t )( params->color[0] );
+	color[1] = ( uint8_t )( params->color[1] );
+	color[2] = ( uint8_t )( params->color[2] );
+	color[3] = ( uint8_t )( params->color[3] );
+
+	scale = 0.5f / place->radius;
+	VectorScale( place->axis[1], scale, axis[0] );
+	VectorScale( place->axis[2], scale, axis[1] );
+
+	for( i = 0, fr = frags->fragments; i < frags->numfragments; i++, fr++ ) {
+		if( fr->numverts > MAX_DECAL_VERTS ) {
+			return;
+		} else if( fr->numverts <= 0 ) {
+			continue;
+		}
+
+		// allocate decal
+		dl = CG_AllocDecal();
+		dl->die = params->die;
+		dl->fadetime = params->fadetime;
+		dl->fadefreq = params->fadefreq;
+		dl->fadealpha = params->fadealpha;
+		dl->shader = params->shader;
+		Vector4Copy( params->color, dl->color );
+
+		// setup polygon for drawing
+		poly = dl->poly;
+		poly->shader = params->shader;
+		poly->numverts = fr->numverts;
+		poly->fognum = fr->fognum;
+
+		for( j = 0; j < fr->numverts; j++ ) {
+			Vector4Copy( frags->verts[fr->firstvert + j], poly->verts[j] );
+			VectorCopy( fr->normal, poly->normals[j] ); poly->normals[j][3] = 0;
+			VectorSubtract( poly->verts[j], place->origin, v );
+			poly->stcoords[j][0] = DotProduct( v, axis[0] ) + 0.5f;
+			poly->stcoords[j][1] = DotProduct( v, axis[1] ) + 0.5f;
+			*( int * )poly->colors[j] = *( int * )color;
+		}
+	}
+}
+
+/*
+* CG_HandleResultCmd
+*
+* Caches the fragments clipped by the worker thread and spawns the decal
+*/
+static unsigned CG_HandleResultCmd( const void *pcmd ) {
+	cdecalresultcmd_t cmd;
+	cdecalcache_t *dc;
+	const uint8_t *data = ( const uint8_t * )pcmd + sizeof( cmd );
+
+	memcpy( &cmd, pcmd, sizeof( cmd ) );
+
+	if( !cg_discardDecalResults ) {
+		dc = CG_FindDecalCache( &cmd.place.key );
+		if( !dc ) {
+			dc = CG_AllocDecalCache( &cmd.place.key );
+			dc->frags.numverts = cmd.numverts;
+			dc->frags.numfragments = cmd.numfragments;
+			memcpy( dc->frags.verts, data, sizeof( vec4_t ) * cmd.numverts );
+			memcpy( dc->frags.fragments, data + sizeof( vec4_t ) * cmd.numverts, sizeof( fragment_t ) * cmd.numfragments );
+		}
+
+		if( cg_addDecals->integer ) {
+			CG_SpawnDecalFragments( &cmd.place, &cmd.params, &dc->frags );
+		}
+	}
+
+	return sizeof( cmd ) + sizeof( vec4_t ) * cmd.numverts + sizeof( fragment_t ) * cmd.numfragments;
+}
+
+/*
+* CG_ClearDecals
+*/
+void CG_ClearDecals( void ) {
+	int cmd = DECAL_CMD_CLEAR;
+	static queueCmdHandler_t cmdHandlers[DECAL_NUM_RESULT_CMDS] =
+	{
+		(queueCmdHandler_t)CG_HandleResultCmd,
+	};
+
+	CG_InitPool( &cg_decals, "decals", sizeof( cdecal_t ), MAX_DECALS, NULL );
+
+	CG_InitDecalThread();
+
+	// drop the decals still being clipped
+	if( cg_decalThread ) {
+		trap_BufPipe_WriteCmd( cg_decalRequests, &cmd, sizeof( cmd ) );
+		trap_BufPipe_Finish( cg_decalRequests );
+
+		cg_discardDecalResults = true;
+		trap_BufPipe_ReadCmds( cg_decalResults, cmdHandlers );
+		cg_discardDecalResults = false;
+	}
+
+	CG_ClearDecalCache();
+}
+
+/*
+* CG_FreeDecals
+*/
+void CG_FreeDecals( void ) {
+	CG_ShutdownDecalThread();
+	CG_ClearDecalCache();
+	CG_FreePool( &cg_decals );
+}
+
+/*
+* CG_SpawnDecal
+*
+* Decals at spots that haven't been clipped yet are clipped by the worker
+* thread and appear on the next frame, 0 is returned for them.
+*/
+int CG_SpawnDecal( const vec3_t origin, const vec3_t dir, float orient, float radius,
+				   float r, float g, float b, float a, float die, float fadetime, bool fadealpha, struct shader_s *shader ) {
+	cdecalcache_t *dc;
+	cdecalclipcmd_t cmd;
+	cdecalparams_t *params = &cmd.params;
 
 	// invalid decal
 	if( radius <= 0 || VectorCompare( dir, vec3_origin ) ) {
@@ -139,22 +615,25 @@ int CG_SpawnDecal( const vec3_t origin, const vec3_t dir, float orient, float ra
 		return 0;
 	}
 
-	// calculate orientation matrix
-	VectorNormalize2( dir, axis[0] );
-	PerpendicularVector( axis[1], axis[0] );
-	RotatePointAroundVector( axis[2], axis[0], axis[1], orient );
-	CrossProduct( axis[0], axis[2], axis[1] );
+	CG_PlaceDecal( &cmd.place, origin, dir, orient, radius, false );
 
-	numfragments = trap_R_GetClippedFragments( origin, radius, axis, // clip it
-											   MAX_DECAL_VERTS, verts, MAX_DECAL_FRAGMENTS, fragments );
+	dc = CG_FindDecalCache( &cmd.place.key );
+	if( !dc ) {
+		if( !cg_addDecals->integer ) {
+			return 0;
+		}
+		if( !cg_decalThread ) {
+			dc = CG_ClipDecalCache( &cmd.place );
+		}
+	}
 
 	// no valid fragments
-	if( !numfragments ) {
+	if( dc && !dc->frags.numfragments ) {
 		return 0;
 	}
 
 	if( !cg_addDecals->integer ) {
-		return numfragments;
+		return dc->frags.numfragments;
 	}
 
 	// clamp and scale colors
@@ -187,55 +666,25 @@ int CG_SpawnDecal( const vec3_t origin, const vec3_t dir, float orient, float ra
 		a *= 255;
 	}
 
-	color[0] = ( uint8_t )( r );
-	color[1] = ( uint8_t )( g );
-	color[2] = ( uint8_t )( b );
-	color[3] = ( uint8_t )( a );
-
-	radius = 0.5f / radius;
-	VectorScale( axis[1], radius, axis[1] );
-	VectorScale( axis[2], radius, axis[2] );
-
-	dietime = cg.time + die * 1000;
-	fadefreq = 0.001f / fminf( fadetime, die );
-	fadetime = cg.time + ( die - fminf( fadetime, die ) ) * 1000;
-
-	for( i = 0, fr = fragments; i < numfragments; i++, fr++ ) {
-		if( fr->numverts > MAX_DECAL_VERTS ) {
-			return numfragments;
-		} else if( fr->numverts <= 0 ) {
-			continue;
-		}
-
-		// allocate decal
-		dl = CG_AllocDecal();
-		dl->die = dietime;
-		dl->fadetime = fadetime;
-		dl->fadefreq = fadefreq;
-		dl->fadealpha = fadealpha;
-		dl->shader = shader;
-		dl->color[0] = r;
-		dl->color[1] = g;
-		dl->color[2] = b;
-		dl->color[3] = a;
-
-		// setup polygon for drawing
-		poly = dl->poly;
-		poly->shader = shader;
-		poly->numverts = fr->numverts;
-		poly->fognum = fr->fognum;
-
-		for( j = 0; j < fr->numverts; j++ ) {
-			Vector4Copy( verts[fr->firstvert + j], poly->verts[j] );
-			VectorCopy( fr->normal, poly->normals[j] ); poly->normals[j][3] = 0;
-			VectorSubtract( poly->verts[j], origin, v );
-			poly->stcoords[j][0] = DotProduct( v, axis[1] ) + 0.5f;
-			poly->stcoords[j][1] = DotProduct( v, axis[2] ) + 0.5f;
-			*( int * )poly->colors[j] = *( int * )color;
-		}
+	params->color[0] = r;
+	params->color[1] = g;
+	params->color[2] = b;
+	params->color[3] = a;
+	params->fadealpha = fadealpha;
+	params->shader = shader;
+	params->die = cg.time + die * 1000;
+	params->fadefreq = 0.001f / fminf( fadetime, die );
+	params->fadetime = cg.time + ( die - fminf( fadetime, die ) ) * 1000;
+
+	if( !dc ) {
+		cmd.id = DECAL_CMD_CLIP;
+		trap_BufPipe_WriteCmd( cg_decalRequests, &cmd, sizeof( cmd ) );
+		return 0;
 	}
 
-	return numfragments;
+	CG_SpawnDecalFragments( &cmd.place, params, &dc->frags );
+
+	return dc->frags.numfragments;
 }
 
 /*
@@ -244,14 +693,25 @@ int CG_SpawnDecal( const vec3_t origin, const vec3_t dir, float orient, float ra
 void CG_AddDecals( void ) {
 	int i;
 	float fade;
-	cdecal_t *dl, *next, *hnode;
+	cdecal_t *dl;
+	cg_poolnode_t *node, *next, *hnode;
 	poly_t *poly;
 	byte_vec4_t color;
+	static queueCmdHandler_t cmdHandlers[DECAL_NUM_RESULT_CMDS] =
+	{
+		(queueCmdHandler_t)CG_HandleResultCmd,
+	};
+
+	// spawn the decals clipped since the last frame
+	if( cg_decalThread ) {
+		trap_BufPipe_ReadCmds( cg_decalResults, cmdHandlers );
+	}
 
 	// add decals in first-spawed - first-drawn order
-	hnode = &cg_decals_headnode;
-	for( dl = hnode->prev; dl != hnode; dl = next ) {
-		next = dl->prev;
+	hnode = &cg_decals.active;
+	for( node = hnode->prev; node != hnode; node = next ) {
+		next = node->prev;
+		dl = ( cdecal_t * )node;
 
 		// it's time to DIE
 		if( dl->die <= cg.time ) {
@@ -407,7 +407,6 @@ TEMPORARY (ONE-FRAME) DECALS
 
 #define MAX_TEMPDECALS              32      // in fact, a semi-random multiplier
 #define MAX_TEMPDECAL_VERTS         128
-#define MAX_TEMPDECAL_FRAGMENTS     64
 
 static unsigned int cg_numDecalVerts = 0;
 
@@ -424,12 +423,11 @@ void CG_ClearFragmentedDecals( void ) {
 void CG_AddFragmentedDecal( vec3_t origin, vec3_t dir, float orient, float radius,
 							float r, float g, float b, float a, struct shader_s *shader ) {
 	int i, j, c;
-	vec3_t axis[3];
+	vec3_t axis[3], placedOrigin;
 	byte_vec4_t color;
-	fragment_t *fr, fragments[MAX_TEMPDECAL_FRAGMENTS];
-	int numfragments;
+	const fragment_t *fr;
+	const cg_decalfragments_t *frags;
 	poly_t poly;
-	vec4_t verts[MAX_BLOBSHADOW_VERTS];
 	static vec4_t t_verts[MAX_TEMPDECAL_VERTS * MAX_TEMPDECALS];
 	static vec4_t t_norms[MAX_TEMPDECAL_VERTS * MAX_TEMPDECALS];
 	static vec2_t t_stcoords[MAX_TEMPDECAL_VERTS * MAX_TEMPDECALS];
@@ -440,17 +438,11 @@ void CG_AddFragmentedDecal( vec3_t origin, vec3_t dir, float orient, float radiu
 
 	}
 
-	// calculate orientation matrix
-	VectorNormalize2( dir, axis[0] );
-	PerpendicularVector( axis[1], axis[0] );
-	RotatePointAroundVector( axis[2], axis[0], axis[1], orient );
-	CrossProduct( axis[0], axis[2], axis[1] );
-
-	numfragments = trap_R_GetClippedFragments( origin, radius, axis, // clip it
-											   MAX_BLOBSHADOW_VERTS, verts, MAX_TEMPDECAL_FRAGMENTS, fragments );
+	// static decals are only clipped once
+	frags = CG_GetDecalFragments( origin, dir, orient, radius, placedOrigin, axis, &radius );
 
 	// no valid fragments
-	if( !numfragments ) {
+	if( !frags->numfragments ) {
 		return;
 	}
 
@@ -496,7 +488,7 @@ void CG_AddFragmentedDecal( vec3_t origin, vec3_t dir, float orient, float radiu
 
 	memset( &poly, 0, sizeof( poly ) );
 
-	for( i = 0, fr = fragments; i < numfragments; i++, fr++ ) {
+	for( i = 0, fr = frags->fragments; i < frags->numfragments; i++, fr++ ) {
 		if( fr->numverts <= 0 ) {
 			continue;
 		}
@@ -516,9 +508,9 @@ void CG_AddFragmentedDecal( vec3_t origin, vec3_t dir, float orient, float radiu
 		for( j = 0; j < fr->numverts; j++ ) {
 			vec3_t v;
 
-			Vector4Copy( verts[fr->firstvert + j], poly.verts[j] );
+			Vector4Copy( frags->verts[fr->firstvert + j], poly.verts[j] );
 			VectorCopy( axis[0], poly.normals[j] ); poly.normals[j][3] = 0;
-			VectorSubtract( poly.verts[j], origin, v );
+			VectorSubtract( poly.verts[j], placedOrigin, v );
 			poly.stcoords[j][0] = DotProduct( v, axis[1] ) + 0.5f;
 			poly.stcoords[j][1] = DotProduct( v, axis[2] ) + 0.5f;
 			*( int * )poly.colors[j] = c;
@@ -536,65 +528,193 @@ PARTICLE MANAGEMENT
 ==============================================================
 */
 
-typedef struct particle_s
-{
-	float time;
+#if defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && ( _M_IX86_FP >= 2 ) )
+#define CG_PARTICLES_SSE2
+#include <emmintrin.h>
+#endif
 
-	vec3_t org;
-	vec3_t vel;
-	vec3_t accel;
-	vec3_t color;
-	float alpha;
-	float alphavel;
-	float scale;
-	bool fog;
+#define PARTICLE_GRAVITY        500
 
-	poly_t poly;
-	vec4_t pVerts[4];
-	vec2_t pStcoords[4];
-	byte_vec4_t pColor[4];
+// every particle costs 124 bytes of poly data in the frame command buffer
+// (4 verts, colors and st coords, 6 elems), so keep the worst case around
+// 2MB, half of the 4MB buffer, leaving room for the rest of the scene
+#define MIN_PARTICLES           2048
+#define MAX_PARTICLES           16384
+#define MAX_PARTICLE_BATCH      ( MAX_POLY_VERTS / 4 )
+#define MAX_PARTICLE_BATCHES    64
 
+/*
+* Particles are stored as parallel arrays so the per-frame update runs over
+* contiguous floats. The position and alpha are evaluated analytically from
+* the spawn state, which is never modified after the particle is created.
+*/
+typedef struct {
+	int num, max;
+	int64_t baseTime;           // spawn times are in seconds relative to this
+
+	float *time;
+	float *orgX, *orgY, *orgZ;
+	float *velX, *velY, *velZ;
+	float *accelX, *accelY, *accelZ;
+	float *alpha, *alphavel;
+	float *scale;
+	byte_vec4_t *color;
+	struct shader_s **shader;
+	bool *fog;
+
+	// evaluated by CG_EvaluateParticles every frame
+	float *curX, *curY, *curZ, *curAlpha;
+
+	// scratch space for sorting particles into batches
+	uint8_t *batch;
+	int *order;
+} cparticles_t;
+
+typedef struct {
 	struct shader_s *shader;
-} cparticle_t;
+	int fognum;
+	int count, first;
+} cparticlebatch_t;
 
-#define PARTICLE_GRAVITY    500
+static vec3_t avelocities[NUMVERTEXNORMALS];
 
-#define MAX_PARTICLES       2048
+static cparticles_t particles;
 
-static vec3_t avelocities[NUMVERTEXNORMALS];
+/*
+* CG_GrowParticleArray
+*/
+static void *CG_GrowParticleArray( void *data, size_t size, int num, int max ) {
+	void *newData = CG_Malloc( size * max );
+
+	if( data ) {
+		memcpy( newData, data, size * num );
+		CG_Free( data );
+	}
+	return newData;
+}
 
-cparticle_t particles[MAX_PARTICLES];
-int cg_numparticles;
+/*
+* CG_GrowParticles
+*/
+static void CG_GrowParticles( int max ) {
+	cparticles_t *ps = &particles;
+	int num = ps->num;
+
+#define CG_GROW_PARTICLES( a, type ) ( ps->a = ( type )CG_GrowParticleArray( ps->a, sizeof( *ps->a ), num, max ) )
+	CG_GROW_PARTICLES( time, float * );
+	CG_GROW_PARTICLES( orgX, float * ); CG_GROW_PARTICLES( orgY, float * ); CG_GROW_PARTICLES( orgZ, float * );
+	CG_GROW_PARTICLES( velX, float * ); CG_GROW_PARTICLES( velY, float * ); CG_GROW_PARTICLES( velZ, float * );
+	CG_GROW_PARTICLES( accelX, float * ); CG_GROW_PARTICLES( accelY, float * ); CG_GROW_PARTICLES( accelZ, float * );
+	CG_GROW_PARTICLES( alpha, float * ); CG_GROW_PARTICLES( alphavel, float * );
+	CG_GROW_PARTICLES( scale, float * );
+	CG_GROW_PARTICLES( color, byte_vec4_t * );
+	CG_GROW_PARTICLES( shader, struct shader_s ** );
+	CG_GROW_PARTICLES( fog, bool * );
+	CG_GROW_PARTICLES( curX, float * ); CG_GROW_PARTICLES( curY, float * ); CG_GROW_PARTICLES( curZ, float * );
+	CG_GROW_PARTICLES( curAlpha, float * );
+	CG_GROW_PARTICLES( batch, uint8_t * );
+	CG_GROW_PARTICLES( order, int * );
+#undef CG_GROW_PARTICLES
+
+	ps->max = max;
+}
+
+/*
+* CG_FreeParticles
+*/
+void CG_FreeParticles( void ) {
+	cparticles_t *ps = &particles;
+
+	if( !ps->max ) {
+		return;
+	}
+
+	CG_Free( ps->time );
+	CG_Free( ps->orgX ); CG_Free( ps->orgY ); CG_Free( ps->orgZ );
+	CG_Free( ps->velX ); CG_Free( ps->velY ); CG_Free( ps->velZ );
+	CG_Free( ps->accelX ); CG_Free( ps->accelY ); CG_Free( ps->accelZ );
+	CG_Free( ps->alpha ); CG_Free( ps->alphavel );
+	CG_Free( ps->scale );
+	CG_Free( ps->color );
+	CG_Free( ps->shader );
+	CG_Free( ps->fog );
+	CG_Free( ps->curX ); CG_Free( ps->curY ); CG_Free( ps->curZ ); CG_Free( ps->curAlpha );
+	CG_Free( ps->batch );
+	CG_Free( ps->order );
+
+	memset( ps, 0, sizeof( *ps ) );
+}
 
 /*
 * CG_ClearParticles
 */
 static void CG_ClearParticles( void ) {
-	int i;
-	cparticle_t *p;
+	particles.num = 0;
+}
 
-	cg_numparticles = 0;
-	memset( particles, 0, sizeof( cparticle_t ) * MAX_PARTICLES );
+/*
+* CG_AllocParticles
+*
+* Returns the index of the first of count consecutive new particles. The count is
+* clamped when the budget runs out.
+*/
+static int CG_AllocParticles( int *count ) {
+	cparticles_t *ps = &particles;
+	int first = ps->num;
+	int newMax;
+
+	if( *count <= 0 ) {
+		*count = 0;
+		return first;
+	}
+
+	if( first + *count > ps->max && ps->max < MAX_PARTICLES ) {
+		newMax = ps->max ? ps->max : MIN_PARTICLES;
+		while( newMax < first + *count && newMax < MAX_PARTICLES ) {
+			newMax *= 2;
+		}
+		CG_GrowParticles( newMax < MAX_PARTICLES ? newMax : MAX_PARTICLES );
+	}
+
+	if( first + *count > ps->max ) {
+		*count = ps->max - first;
+	}
 
-	for( i = 0, p = particles; i < MAX_PARTICLES; i++, p++ ) {
-		p->pStcoords[0][0] = 0; p->pStcoords[0][1] = 1;
-		p->pStcoords[1][0] = 0; p->pStcoords[1][1] = 0;
-		p->pStcoords[2][0] = 1; p->pStcoords[2][1] = 0;
-		p->pStcoords[3][0] = 1; p->pStcoords[3][1] = 1;
+	if( !first ) {
+		ps->baseTime = cg.time;
 	}
+	ps->num += *count;
+	return first;
 }
 
-#define CG_InitParticle( p, s, a, r, g, b, h ) \
-	( \
-		( p )->time = cg.time, \
-		( p )->scale = ( s ), \
-		( p )->alpha = ( a ), \
-		( p )->color[0] = ( r ), \
-		( p )->color[1] = ( g ), \
-		( p )->color[2] = ( b ), \
-		( p )->shader = ( h ), \
-		( p )->fog = true \
-	)
+/*
+* CG_InitParticle
+*/
+static void CG_InitParticle( int i, float scale, float alpha, float r, float g, float b, struct shader_s *shader ) {
+	cparticles_t *ps = &particles;
+
+	ps->time[i] = ( cg.time - ps->baseTime ) * 0.001f;
+	ps->scale[i] = scale;
+	ps->alpha[i] = alpha;
+	ps->color[i][0] = (uint8_t)( Q_bound( 0, r, 1.0f ) * 255 );
+	ps->color[i][1] = (uint8_t)( Q_bound( 0, g, 1.0f ) * 255 );
+	ps->color[i][2] = (uint8_t)( Q_bound( 0, b, 1.0f ) * 255 );
+	ps->color[i][3] = 0;
+	ps->shader[i] = shader;
+	ps->fog[i] = true;
+}
+
+/*
+* CG_SetParticleMotion
+*/
+static void CG_SetParticleMotion( int i, const vec3_t org, const vec3_t vel, const vec3_t accel, float alphavel ) {
+	cparticles_t *ps = &particles;
+
+	ps->orgX[i] = org[0]; ps->orgY[i] = org[1]; ps->orgZ[i] = org[2];
+	ps->velX[i] = vel[0]; ps->velY[i] = vel[1]; ps->velZ[i] = vel[2];
+	ps->accelX[i] = accel[0]; ps->accelY[i] = accel[1]; ps->accelZ[i] = accel[2];
+	ps->alphavel[i] = alphavel;
+}
 
 /*
 * CG_ParticleEffect
@@ -602,29 +722,25 @@ static void CG_ClearParticles( void ) {
 * Wall impact puffs
 */
 void CG_ParticleEffect( const vec3_t org, const vec3_t dir, float r, float g, float b, int count ) {
-	int j;
-	cparticle_t *p;
+	int i, j;
 	float d;
+	vec3_t porg, vel;
+	const vec3_t accel = { 0, 0, -PARTICLE_GRAVITY };
 
 	if( !cg_particles->integer ) {
 		return;
 	}
 
-	if( cg_numparticles + count > MAX_PARTICLES ) {
-		count = MAX_PARTICLES - cg_numparticles;
-	}
-	for( p = &particles[cg_numparticles], cg_numparticles += count; count > 0; count--, p++ ) {
-		CG_InitParticle( p, 0.75, 1, r + random() * 0.1, g + random() * 0.1, b + random() * 0.1, NULL );
+	for( i = CG_AllocParticles( &count ); count > 0; count--, i++ ) {
+		CG_InitParticle( i, 0.75, 1, r + random() * 0.1, g + random() * 0.1, b + random() * 0.1, NULL );
 
 		d = rand() & 31;
 		for( j = 0; j < 3; j++ ) {
-			p->org[j] = org[j] + ( ( rand() & 7 ) - 4 ) + d * dir[j];
-			p->vel[j] = crandom() * 20;
+			porg[j] = org[j] + ( ( rand() & 7 ) - 4 ) + d * dir[j];
+			vel[j] = crandom() * 20;
 		}
 
-		p->accel[0] = p->accel[1] = 0;
-		p->accel[2] = -PARTICLE_GRAVITY;
-		p->alphavel = -1.0 / ( 0.5 + random() * 0.3 );
+		CG_SetParticleMotion( i, porg, vel, accel, -1.0 / ( 0.5 + random() * 0.3 ) );
 	}
 }
 
@@ -632,29 +748,25 @@ void CG_ParticleEffect( const vec3_t org, const vec3_t dir, float r, float g, fl
 * CG_ParticleEffect2
 */
 void CG_ParticleEffect2( const vec3_t org, const vec3_t dir, float r, float g, float b, int count ) {
-	int j;
+	int i, j;
 	float d;
-	cparticle_t *p;
+	vec3_t porg, vel;
+	const vec3_t accel = { 0, 0, -PARTICLE_GRAVITY };
 
 	if( !cg_particles->integer ) {
 		return;
 	}
 
-	if( cg_numparticles + count > MAX_PARTICLES ) {
-		count = MAX_PARTICLES - cg_numparticles;
-	}
-	for( p = &particles[cg_numparticles], cg_numparticles += count; count > 0; count--, p++ ) {
-		CG_InitParticle( p, 0.75, 1, r, g, b, NULL );
+	for( i = CG_AllocParticles( &count ); count > 0; count--, i++ ) {
+		CG_InitParticle( i, 0.75, 1, r, g, b, NULL );
 
 		d = rand() & 7;
 		for( j = 0; j < 3; j++ ) {
-			p->org[j] = org[j] + ( ( rand() & 7 ) - 4 ) + d * dir[j];
-			p->vel[j] = crandom() * 20;
+			porg[j] = org[j] + ( ( rand() & 7 ) - 4 ) + d * dir[j];
+			vel[j] = crandom() * 20;
 		}
 
-		p->accel[0] = p->accel[1] = 0;
-		p->accel[2] = -PARTICLE_GRAVITY;
-		p->alphavel = -1.0 / ( 0.5 + random() * 0.3 );
+		CG_SetParticleMotion( i, porg, vel, accel, -1.0 / ( 0.5 + random() * 0.3 ) );
 	}
 }
 
@@ -662,29 +774,25 @@ void CG_ParticleEffect2( const vec3_t org, const vec3_t dir, float r, float g, f
 * CG_ParticleExplosionEffect
 */
 void CG_ParticleExplosionEffect( const vec3_t org, const vec3_t dir, float r, float g, float b, int count ) {
-	int j;
-	cparticle_t *p;
+	int i, j;
 	float d;
+	vec3_t porg, vel;
+	const vec3_t accel = { 0, 0, -PARTICLE_GRAVITY };
 
 	if( !cg_particles->integer ) {
 		return;
 	}
 
-	if( cg_numparticles + count > MAX_PARTICLES ) {
-		count = MAX_PARTICLES - cg_numparticles;
-	}
-	for( p = &particles[cg_numparticles], cg_numparticles += count; count > 0; count--, p++ ) {
-		CG_InitParticle( p, 0.75, 1, r + random() * 0.1, g + random() * 0.1, b + random() * 0.1, NULL );
+	for( i = CG_AllocParticles( &count ); count > 0; count--, i++ ) {
+		CG_InitParticle( i, 0.75, 1, r + random() * 0.1, g + random() * 0.1, b + random() * 0.1, NULL );
 
 		d = rand() & 31;
 		for( j = 0; j < 3; j++ ) {
-			p->org[j] = org[j] + ( ( rand() & 7 ) - 4 ) + d * dir[j];
-			p->vel[j] = crandom() * 400;
+			porg[j] = org[j] + ( ( rand() & 7 ) - 4 ) + d * dir[j];
+			vel[j] = crandom() * 400;
 		}
 
-		//p->accel[0] = p->accel[1] = 0;
-		p->accel[2] = -PARTICLE_GRAVITY;
-		p->alphavel = -1.0 / ( 0.7 + random() * 0.25 );
+		CG_SetParticleMotion( i, porg, vel, accel, -1.0 / ( 0.7 + random() * 0.25 ) );
 	}
 }
 
@@ -693,13 +801,13 @@ void CG_ParticleExplosionEffect( const vec3_t org, const vec3_t dir, float r, fl
 * CG_BlasterTrail
 */
 void CG_BlasterTrail( const vec3_t start, const vec3_t end ) {
-	int j, count;
+	int i, j, count;
 	vec3_t move, vec;
+	vec3_t porg, vel;
 	float len;
 
 	//const float	dec = 5.0f;
 	const float dec = 3.0f;
-	cparticle_t *p;
 
 	if( !cg_particles->integer ) {
 		return;
@@ -711,19 +819,15 @@ void CG_BlasterTrail( const vec3_t start, const vec3_t end ) {
 	VectorScale( vec, dec, vec );
 
 	count = (int)( len / dec ) + 1;
-	if( cg_numparticles + count > MAX_PARTICLES ) {
-		count = MAX_PARTICLES - cg_numparticles;
-	}
-	for( p = &particles[cg_numparticles], cg_numparticles += count; count > 0; count--, p++ ) {
-		CG_InitParticle( p, 2.5f, 0.25f, 1.0f, 0.85f, 0, NULL );
+	for( i = CG_AllocParticles( &count ); count > 0; count--, i++ ) {
+		CG_InitParticle( i, 2.5f, 0.25f, 1.0f, 0.85f, 0, NULL );
 
-		p->alphavel = -1.0 / ( 0.1 + random() * 0.2 );
 		for( j = 0; j < 3; j++ ) {
-			p->org[j] = move[j] + crandom();
-			p->vel[j] = crandom() * 5;
+			porg[j] = move[j] + crandom();
+			vel[j] = crandom() * 5;
 		}
 
-		VectorClear( p->accel );
+		CG_SetParticleMotion( i, porg, vel, vec3_origin, -1.0 / ( 0.1 + random() * 0.2 ) );
 		VectorAdd( move, vec, move );
 	}
 }
@@ -732,11 +836,11 @@ void CG_BlasterTrail( const vec3_t start, const vec3_t end ) {
 * CG_ElectroWeakTrail
 */
 void CG_ElectroWeakTrail( const vec3_t start, const vec3_t end, const vec4_t color ) {
-	int j, count;
+	int i, j, count;
 	vec3_t move, vec;
+	vec3_t porg, vel;
 	float len;
 	const float dec = 5;
-	cparticle_t *p;
 	vec4_t ucolor = { 1.0f, 1.0f, 1.0f, 0.8f };
 
 	if( color ) {
@@ -753,21 +857,16 @@ void CG_ElectroWeakTrail( const vec3_t start, const vec3_t end, const vec4_t col
 	VectorScale( vec, dec, vec );
 
 	count = (int)( len / dec ) + 1;
-	if( cg_numparticles + count > MAX_PARTICLES ) {
-		count = MAX_PARTICLES - cg_numparticles;
-	}
-
-	for( p = &particles[cg_numparticles], cg_numparticles += count; count > 0; count--, p++ ) {
-		//CG_InitParticle( p, 2.0f, 0.8f, 1.0f, 1.0f, 1.0f, NULL );
-		CG_InitParticle( p, 2.0f, ucolor[3], ucolor[0], ucolor[1], ucolor[2], NULL );
+	for( i = CG_AllocParticles( &count ); count > 0; count--, i++ ) {
+		//CG_InitParticle( i, 2.0f, 0.8f, 1.0f, 1.0f, 1.0f, NULL );
+		CG_InitParticle( i, 2.0f, ucolor[3], ucolor[0], ucolor[1], ucolor[2], NULL );
 
-		p->alphavel = -1.0 / ( 0.2 + random() * 0.1 );
 		for( j = 0; j < 3; j++ ) {
-			p->org[j] = move[j] + random();/* + crandom();*/
-			p->vel[j] = crandom() * 2;
+			porg[j] = move[j] + random();/* + crandom();*/
+			vel[j] = crandom() * 2;
 		}
 
-		VectorClear( p->accel );
+		CG_SetParticleMotion( i, porg, vel, vec3_origin, -1.0 / ( 0.2 + random() * 0.1 ) );
 		VectorAdd( move, vec, move );
 	}
 }
@@ -777,29 +876,25 @@ void CG_ElectroWeakTrail( const vec3_t start, const vec3_t end, const vec4_t col
 * Wall impact puffs
 */
 void CG_ImpactPuffParticles( const vec3_t org, const vec3_t dir, int count, float scale, float r, float g, float b, float a, struct shader_s *shader ) {
-	int j;
+	int i, j;
 	float d;
-	cparticle_t *p;
+	vec3_t porg, vel;
+	const vec3_t accel = { 0, 0, -PARTICLE_GRAVITY };
 
 	if( !cg_particles->integer ) {
 		return;
 	}
 
-	if( cg_numparticles + count > MAX_PARTICLES ) {
-		count = MAX_PARTICLES - cg_numparticles;
-	}
-	for( p = &particles[cg_numparticles], cg_numparticles += count; count > 0; count--, p++ ) {
-		CG_InitParticle( p, scale, a, r, g, b, shader );
+	for( i = CG_AllocParticles( &count ); count > 0; count--, i++ ) {
+		CG_InitParticle( i, scale, a, r, g, b, shader );
 
 		d = rand() & 15;
 		for( j = 0; j < 3; j++ ) {
-			p->org[j] = org[j] + ( ( rand() & 7 ) - 4 ) + d * dir[j];
-			p->vel[j] = dir[j] * 90 + crandom() * 40;
+			porg[j] = org[j] + ( ( rand() & 7 ) - 4 ) + d * dir[j];
+			vel[j] = dir[j] * 90 + crandom() * 40;
 		}
 
-		p->accel[0] = p->accel[1] = 0;
-		p->accel[2] = -PARTICLE_GRAVITY;
-		p->alphavel = -1.0 / ( 0.5 + random() * 0.3 );
+		CG_SetParticleMotion( i, porg, vel, accel, -1.0 / ( 0.5 + random() * 0.3 ) );
 	}
 }
 
@@ -808,29 +903,25 @@ void CG_ImpactPuffParticles( const vec3_t org, const vec3_t dir, int count, floa
 * High velocity wall impact puffs
 */
 void CG_HighVelImpactPuffParticles( const vec3_t org, const vec3_t dir, int count, float scale, float r, float g, float b, float a, struct shader_s *shader ) {
-	int j;
+	int i, j;
 	float d;
-	cparticle_t *p;
+	vec3_t porg, vel;
+	const vec3_t accel = { 0, 0, -PARTICLE_GRAVITY * 2 };
 
 	if( !cg_particles->integer ) {
 		return;
 	}
 
-	if( cg_numparticles + count > MAX_PARTICLES ) {
-		count = MAX_PARTICLES - cg_numparticles;
-	}
-	for( p = &particles[cg_numparticles], cg_numparticles += count; count > 0; count--, p++ ) {
-		CG_InitParticle( p, scale, a, r, g, b, shader );
+	for( i = CG_AllocParticles( &count ); count > 0; count--, i++ ) {
+		CG_InitParticle( i, scale, a, r, g, b, shader );
 
 		d = rand() & 15;
 		for( j = 0; j < 3; j++ ) {
-			p->org[j] = org[j] + ( ( rand() & 7 ) - 4 ) + d * dir[j];
-			p->vel[j] = dir[j] * 180 + crandom() * 40;
+			porg[j] = org[j] + ( ( rand() & 7 ) - 4 ) + d * dir[j];
+			vel[j] = dir[j] * 180 + crandom() * 40;
 		}
 
-		p->accel[0] = p->accel[1] = 0;
-		p->accel[2] = -PARTICLE_GRAVITY * 2;
-		p->alphavel = -5.0 / ( 0.5 + random() * 0.3 );
+		CG_SetParticleMotion( i, porg, vel, accel, -5.0 / ( 0.5 + random() * 0.3 ) );
 	}
 }
 
@@ -839,11 +930,11 @@ void CG_HighVelImpactPuffParticles( const vec3_t org, const vec3_t dir, int coun
 */
 void CG_ElectroIonsTrail( const vec3_t start, const vec3_t end, const vec4_t color ) {
 #define MAX_BOLT_IONS 48
-	int i, count;
+	int i, j, count;
 	vec3_t move, vec;
+	vec3_t vel;
 	float len;
 	float dec2 = 24.0f;
-	cparticle_t *p;
 
 	if( !cg_particles->integer ) {
 		return;
@@ -860,29 +951,24 @@ void CG_ElectroIonsTrail( const vec3_t start, const vec3_t end, const vec4_t col
 	VectorScale( vec, dec2, vec );
 	VectorCopy( start, move );
 
-	if( cg_numparticles + count > MAX_PARTICLES ) {
-		count = MAX_PARTICLES - cg_numparticles;
-	}
-	for( p = &particles[cg_numparticles], cg_numparticles += count; count > 0; count--, p++ ) {
-		CG_InitParticle( p, 0.65f, color[3], color[0] + crandom() * 0.1, color[1] + crandom() * 0.1, color[2] + crandom() * 0.1, NULL );
+	for( i = CG_AllocParticles( &count ); count > 0; count--, i++ ) {
+		CG_InitParticle( i, 0.65f, color[3], color[0] + crandom() * 0.1, color[1] + crandom() * 0.1, color[2] + crandom() * 0.1, NULL );
 
-		for( i = 0; i < 3; i++ ) {
-			p->org[i] = move[i];
-			p->vel[i] = crandom() * 4;
+		for( j = 0; j < 3; j++ ) {
+			vel[j] = crandom() * 4;
 		}
-		p->alphavel = -1.0 / ( 0.6 + random() * 0.6 );
-		VectorClear( p->accel );
+
+		CG_SetParticleMotion( i, move, vel, vec3_origin, -1.0 / ( 0.6 + random() * 0.6 ) );
 		VectorAdd( move, vec, move );
 	}
 }
 
 void CG_ElectroIonsTrail2( const vec3_t start, const vec3_t end, const vec4_t color ) {
 #define MAX_RING_IONS 96
-	int count;
+	int i, count;
 	vec3_t move, vec;
 	float len;
 	float dec2 = 8.0f;
-	cparticle_t *p;
 
 	if( !cg_particles->integer ) {
 		return;
@@ -899,19 +985,11 @@ void CG_ElectroIonsTrail2( const vec3_t start, const vec3_t end, const vec4_t co
 	VectorScale( vec, dec2, vec );
 	VectorCopy( start, move );
 
-	if( cg_numparticles + count > MAX_PARTICLES ) {
-		count = MAX_PARTICLES - cg_numparticles;
-	}
-
 	// Ring rail eb particles
-	for( p = &particles[cg_numparticles], cg_numparticles += count; count > 0; count--, p++ ) {
-		CG_InitParticle( p, 0.65f, color[3], color[0] + crandom() * 0.1, color[1] + crandom() * 0.1, color[2] + crandom() * 0.1, NULL );
-
-		p->alphavel = -1.0 / ( 0.6 + random() * 0.6 );
+	for( i = CG_AllocParticles( &count ); count > 0; count--, i++ ) {
+		CG_InitParticle( i, 0.65f, color[3], color[0] + crandom() * 0.1, color[1] + crandom() * 0.1, color[2] + crandom() * 0.1, NULL );
 
-		VectorCopy( move, p->org );
-		VectorClear( p->accel );
-		VectorClear( p->vel );
+		CG_SetParticleMotion( i, move, vec3_origin, vec3_origin, -1.0 / ( 0.6 + random() * 0.6 ) );
 		VectorAdd( move, vec, move );
 	}
 }
@@ -922,11 +1000,10 @@ void CG_ElectroIonsTrail2( const vec3_t start, const vec3_t end, const vec4_t co
 * CG_FlyParticles
 */
 static void CG_FlyParticles( const vec3_t origin, int count ) {
-	int i, j;
+	int i, j, n;
 	float angle, sp, sy, cp, cy;
-	vec3_t forward, dir;
+	vec3_t forward, dir, org;
 	float dist, ltime;
-	cparticle_t *p;
 
 	if( !cg_particles->integer ) {
 		return;
@@ -946,11 +1023,8 @@ static void CG_FlyParticles( const vec3_t origin, int count ) {
 	ltime = (float)cg.time / 1000.0;
 
 	count /= 2;
-	if( cg_numparticles + count > MAX_PARTICLES ) {
-		count = MAX_PARTICLES - cg_numparticles;
-	}
-	for( p = &particles[cg_numparticles], cg_numparticles += count; count > 0; count--, p++ ) {
-		CG_InitParticle( p, 1, 1, 0, 0, 0, NULL );
+	for( n = CG_AllocParticles( &count ); count > 0; count--, n++ ) {
+		CG_InitParticle( n, 1, 1, 0, 0, 0, NULL );
 
 		angle = ltime * avelocities[i][0];
 		sy = sin( angle );
@@ -965,13 +1039,11 @@ static void CG_FlyParticles( const vec3_t origin, int count ) {
 
 		dist = sin( ltime + i ) * 64;
 		ByteToDir( i, dir );
-		p->org[0] = origin[0] + dir[0] * dist + forward[0] * BEAMLENGTH;
-		p->org[1] = origin[1] + dir[1] * dist + forward[1] * BEAMLENGTH;
-		p->org[2] = origin[2] + dir[2] * dist + forward[2] * BEAMLENGTH;
+		org[0] = origin[0] + dir[0] * dist + forward[0] * BEAMLENGTH;
+		org[1] = origin[1] + dir[1] * dist + forward[1] * BEAMLENGTH;
+		org[2] = origin[2] + dir[2] * dist + forward[2] * BEAMLENGTH;
 
-		VectorClear( p->vel );
-		VectorClear( p->accel );
-		p->alphavel = -100;
+		CG_SetParticleMotion( n, org, vec3_origin, vec3_origin, -100 );
 
 		i += 2;
 	}
@@ -1012,86 +1084,261 @@ void CG_FlyEffect( centity_t *ent, const vec3_t origin ) {
 }
 
 /*
-* CG_AddParticles
+* CG_EvaluateParticleSpan_Generic
+*
+* Evaluates particles [first, count)
 */
-void CG_AddParticles( void ) {
-	int i, j, k;
-	float alpha;
-	float time, time2;
-	vec3_t org;
-	vec3_t corner;
-	byte_vec4_t color;
-	int maxparticle, activeparticles;
-	float alphaValues[MAX_PARTICLES];
-	cparticle_t *p, *free_particles[MAX_PARTICLES];
+static void CG_EvaluateParticleSpan_Generic( cparticles_t *ps, int first, int count, float now ) {
+	int i;
+	float t, t2;
 
-	if( !cg_numparticles ) {
-		return;
+	for( i = first; i < count; i++ ) {
+		t = now - ps->time[i];
+		t2 = t * t * 0.5f;
+
+		ps->curAlpha[i] = ps->alpha[i] + t * ps->alphavel[i];
+		ps->curX[i] = ps->orgX[i] + ps->velX[i] * t + ps->accelX[i] * t2;
+		ps->curY[i] = ps->orgY[i] + ps->velY[i] * t + ps->accelY[i] * t2;
+		ps->curZ[i] = ps->orgZ[i] + ps->velZ[i] * t + ps->accelZ[i] * t2;
 	}
+}
+
+#ifdef CG_PARTICLES_SSE2
+/*
+* CG_EvaluateParticleSpan_SSE2
+*
+* Returns the number of particles evaluated, the rest is left for the generic path
+*/
+static int CG_EvaluateParticleSpan_SSE2( cparticles_t *ps, int count, float now ) {
+	int i;
+	const __m128 vnow = _mm_set1_ps( now );
+	const __m128 half = _mm_set1_ps( 0.5f );
+
+	for( i = 0; i + 4 <= count; i += 4 ) {
+		__m128 t = _mm_sub_ps( vnow, _mm_loadu_ps( ps->time + i ) );
+		__m128 t2 = _mm_mul_ps( _mm_mul_ps( t, t ), half );
 
-	j = 0;
-	maxparticle = -1;
-	activeparticles = 0;
+#define CG_EVALUATE_PARTICLE_AXIS( cur, org, vel, accel ) \
+	_mm_storeu_ps( ps->cur + i, _mm_add_ps( _mm_add_ps( _mm_loadu_ps( ps->org + i ), \
+		_mm_mul_ps( _mm_loadu_ps( ps->vel + i ), t ) ), _mm_mul_ps( _mm_loadu_ps( ps->accel + i ), t2 ) ) )
+		CG_EVALUATE_PARTICLE_AXIS( curX, orgX, velX, accelX );
+		CG_EVALUATE_PARTICLE_AXIS( curY, orgY, velY, accelY );
+		CG_EVALUATE_PARTICLE_AXIS( curZ, orgZ, velZ, accelZ );
+#undef CG_EVALUATE_PARTICLE_AXIS
+
+		_mm_storeu_ps( ps->curAlpha + i, _mm_add_ps( _mm_loadu_ps( ps->alpha + i ),
+			_mm_mul_ps( _mm_loadu_ps( ps->alphavel + i ), t ) ) );
+	}
+
+	return i;
+}
+#endif
+
+/*
+* CG_EvaluateParticles
+*/
+static void CG_EvaluateParticles( cparticles_t *ps ) {
+	int first = 0;
+	float now = ( cg.time - ps->baseTime ) * 0.001f;
+
+#ifdef CG_PARTICLES_SSE2
+	first = CG_EvaluateParticleSpan_SSE2( ps, ps->num, now );
+#endif
+
+	CG_EvaluateParticleSpan_Generic( ps, first, ps->num, now );
+}
+
+/*
+* CG_MoveParticle
+*/
+static void CG_MoveParticle( cparticles_t *ps, int from, int to ) {
+	ps->time[to] = ps->time[from];
+	ps->orgX[to] = ps->orgX[from]; ps->orgY[to] = ps->orgY[from]; ps->orgZ[to] = ps->orgZ[from];
+	ps->velX[to] = ps->velX[from]; ps->velY[to] = ps->velY[from]; ps->velZ[to] = ps->velZ[from];
+	ps->accelX[to] = ps->accelX[from]; ps->accelY[to] = ps->accelY[from]; ps->accelZ[to] = ps->accelZ[from];
+	ps->alpha[to] = ps->alpha[from];
+	ps->alphavel[to] = ps->alphavel[from];
+	ps->scale[to] = ps->scale[from];
+	Vector4Copy( ps->color[from], ps->color[to] );
+	ps->shader[to] = ps->shader[from];
+	ps->fog[to] = ps->fog[from];
+	ps->curX[to] = ps->curX[from]; ps->curY[to] = ps->curY[from]; ps->curZ[to] = ps->curZ[from];
+	ps->curAlpha[to] = ps->curAlpha[from];
+}
+
+/*
+* CG_SortParticleBatches
+*
+* Buckets live particles by shader and fog, returns the number of batches
+*/
+static int CG_SortParticleBatches( cparticles_t *ps, cparticlebatch_t *batches ) {
+	int i, j, numBatches = 0;
+	int fognum;
+	struct shader_s *shader;
+	struct shader_s *defaultShader = CG_MediaShader( cgs.media.shaderParticle );
 
-	for( i = 0, p = particles; i < cg_numparticles; i++, p++ ) {
-		time = ( cg.time - p->time ) * 0.001f;
-		alpha = alphaValues[i] = p->alpha + time * p->alphavel;
+	for( i = 0; i < ps->num; i++ ) {
+		shader = ps->shader[i] ? ps->shader[i] : defaultShader;
+		if( ps->fog[i] ) {
+			vec3_t origin = { ps->curX[i], ps->curY[i], ps->curZ[i] };
 
-		if( alpha <= 0 ) { // faded out
-			free_particles[j++] = p;
+			// the renderer resolves the fog once per poly, so look it up for each particle
+			fognum = trap_R_GetFogNumForSphere( origin, ps->scale[i] * 0.5f );
+		} else {
+			fognum = -1;
+		}
+
+		// particles spawned together share the shader, so check the previous one first
+		j = ps->batch[i > 0 ? i - 1 : 0];
+		if( j >= numBatches || batches[j].shader != shader || batches[j].fognum != fognum ) {
+			for( j = 0; j < numBatches; j++ ) {
+				if( batches[j].shader == shader && batches[j].fognum == fognum ) {
+					break;
+				}
+			}
+			if( j == numBatches ) {
+				if( numBatches == MAX_PARTICLE_BATCHES ) {
+					// not drawn this frame
+					ps->batch[i] = MAX_PARTICLE_BATCHES;
+					continue;
+				}
+				batches[j].shader = shader;
+				batches[j].fognum = fognum;
+				batches[j].count = 0;
+				numBatches++;
+			}
+		}
+
+		ps->batch[i] = j;
+		batches[j].count++;
+	}
+
+	for( i = 0, j = 0; i < numBatches; i++ ) {
+		batches[i].first = j;
+		j += batches[i].count;
+		batches[i].count = 0;
+	}
+
+	for( i = 0; i < ps->num; i++ ) {
+		cparticlebatch_t *b;
+
+		if( ps->batch[i] == MAX_PARTICLE_BATCHES ) {
 			continue;
 		}
+		b = &batches[ps->batch[i]];
+		ps->order[b->first + b->count++] = i;
+	}
 
-		maxparticle = i;
-		activeparticles++;
+	return numBatches;
+}
 
-		time2 = time * time * 0.5f;
+/*
+* CG_AddParticleBatch
+*/
+static void CG_AddParticleBatch( cparticles_t *ps, const cparticlebatch_t *b, const int *order, int count ) {
+	int i, k, n;
+	float s;
+	vec3_t corner;
+	poly_t poly;
+	static vec4_t verts[MAX_PARTICLE_BATCH * 4];
+	static byte_vec4_t colors[MAX_PARTICLE_BATCH * 4];
+	static vec2_t stcoords[MAX_PARTICLE_BATCH * 4];
+	static unsigned short elems[MAX_PARTICLE_BATCH * 6];
+	static bool init = false;
+
+	// the texture coordinates and triangles are the same for every batch
+	if( !init ) {
+		for( i = 0; i < MAX_PARTICLE_BATCH; i++ ) {
+			Vector2Set( stcoords[i * 4 + 0], 0, 1 );
+			Vector2Set( stcoords[i * 4 + 1], 0, 0 );
+			Vector2Set( stcoords[i * 4 + 2], 1, 0 );
+			Vector2Set( stcoords[i * 4 + 3], 1, 1 );
+
+			elems[i * 6 + 0] = i * 4 + 0;
+			elems[i * 6 + 1] = i * 4 + 1;
+			elems[i * 6 + 2] = i * 4 + 2;
+			elems[i * 6 + 3] = i * 4 + 0;
+			elems[i * 6 + 4] = i * 4 + 2;
+			elems[i * 6 + 5] = i * 4 + 3;
+		}
+		init = true;
+	}
 
-		org[0] = p->org[0] + p->vel[0] * time + p->accel[0] * time2;
-		org[1] = p->org[1] + p->vel[1] * time + p->accel[1] * time2;
-		org[2] = p->org[2] + p->vel[2] * time + p->accel[2] * time2;
+	for( i = 0; i < count; i++ ) {
+		n = order[i];
+		s = ps->scale[n];
 
-		color[0] = (uint8_t)( Q_bound( 0, p->color[0], 1.0f ) * 255 );
-		color[1] = (uint8_t)( Q_bound( 0, p->color[1], 1.0f ) * 255 );
-		color[2] = (uint8_t)( Q_bound( 0, p->color[2], 1.0f ) * 255 );
-		color[3] = (uint8_t)( Q_bound( 0, alpha, 1.0f ) * 255 );
+		corner[0] = ps->curX[n];
+		corner[1] = ps->curY[n] - 0.5f * s;
+		corner[2] = ps->curZ[n] - 0.5f * s;
 
-		corner[0] = org[0];
-		corner[1] = org[1] - 0.5f * p->scale;
-		corner[2] = org[2] - 0.5f * p->scale;
+		Vector4Set( verts[i * 4 + 0], corner[0], corner[1] + s, corner[2] + s, 1 );
+		Vector4Set( verts[i * 4 + 1], corner[0], corner[1], corner[2] + s, 1 );
+		Vector4Set( verts[i * 4 + 2], corner[0], corner[1], corner[2], 1 );
+		Vector4Set( verts[i * 4 + 3], corner[0], corner[1] + s, corner[2], 1 );
 
-		Vector4Set( p->pVerts[0], corner[0], corner[1] + p->scale, corner[2] + p->scale, 1 );
-		Vector4Set( p->pVerts[1], corner[0], corner[1], corner[2] + p->scale, 1 );
-		Vector4Set( p->pVerts[2], corner[0], corner[1], corner[2], 1 );
-		Vector4Set( p->pVerts[3], corner[0], corner[1] + p->scale, corner[2], 1 );
 		for( k = 0; k < 4; k++ ) {
-			Vector4Copy( color, p->pColor[k] );
+			Vector4Copy( ps->color[n], colors[i * 4 + k] );
+			colors[i * 4 + k][3] = (uint8_t)( Q_bound( 0, ps->curAlpha[n], 1.0f ) * 255 );
 		}
+	}
+
+	memset( &poly, 0, sizeof( poly ) );
+	poly.numverts = count * 4;
+	poly.verts = verts;
+	poly.stcoords = stcoords;
+	poly.colors = colors;
+	poly.numelems = count * 6;
+	poly.elems = elems;
+	poly.fognum = b->fognum;
+	poly.shader = b->shader;
+
+	trap_R_AddPolyToScene( &poly );
+}
 
-		p->poly.numverts = 4;
-		p->poly.verts = p->pVerts;
-		p->poly.stcoords = p->pStcoords;
-		p->poly.colors = p->pColor;
-		p->poly.fognum = p->fog ? 0 : -1;
-		p->poly.shader = ( p->shader == NULL ) ? CG_MediaShader( cgs.media.shaderParticle ) : p->shader;
+/*
+* CG_AddParticles
+*
+* Particles are submitted as one poly per shader, split into chunks
+* that fit into a single poly.
+*/
+void CG_AddParticles( void ) {
+	int i, j, count;
+	int numBatches;
+	cparticles_t *ps = &particles;
+	cparticlebatch_t batches[MAX_PARTICLE_BATCHES];
 
-		trap_R_AddPolyToScene( &p->poly );
+	if( !ps->num ) {
+		return;
 	}
 
-	i = 0;
-	while( maxparticle >= activeparticles ) {
-		*free_particles[i++] = particles[maxparticle--];
-
-		while( maxparticle >= activeparticles ) {
-			if( alphaValues[maxparticle] <= 0 ) {
-				maxparticle--;
-			} else {
-				break;
+	CG_EvaluateParticles( ps );
+
+	// remove faded out particles by moving the last one into their slot
+	for( i = 0; i < ps->num; ) {
+		if( ps->curAlpha[i] <= 0 ) {
+			ps->num--;
+			if( i != ps->num ) {
+				CG_MoveParticle( ps, ps->num, i );
 			}
+			continue;
 		}
+		i++;
 	}
 
-	cg_numparticles = activeparticles;
+	numBatches = CG_SortParticleBatches( ps, batches );
+
+	for( i = 0; i < numBatches; i++ ) {
+		const cparticlebatch_t *b = &batches[i];
+
+		for( j = 0; j < b->count; j += count ) {
+			count = b->count - j;
+			if( count > MAX_PARTICLE_BATCH ) {
+				count = MAX_PARTICLE_BATCH;
+			}
+			CG_AddParticleBatch( ps, b, ps->order + b->first + j, count );
+		}
+	}
 }
 
 /*
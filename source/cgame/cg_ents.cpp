@@ -22,6 +22,47 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 static void CG_UpdateEntities( void );
 
+#if defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && ( _M_IX86_FP >= 2 ) )
+#define CG_LERP_SSE2
+#include <emmintrin.h>
+#endif
+
+enum
+{
+	LERP_ORIGIN_X,
+	LERP_ORIGIN_Y,
+	LERP_ORIGIN_Z,
+	LERP_PITCH,
+	LERP_YAW,
+	LERP_ROLL,
+
+	LERP_NUM_COMPONENTS
+};
+
+// interpolation state of the current snapshot, rebuilt by CG_UpdateEntities
+typedef struct {
+	bool valid;
+	unsigned extrapolationTime;     // the batch is only valid for this setting
+
+	// generic entities that didn't move since the last snapshot
+	int numStill;
+	int stillEnts[MAX_EDICTS];
+
+	// generic entities with plain interpolation, as arrays of components
+	int numMoving;
+	int movingEnts[MAX_EDICTS];
+	bool movingTurns[MAX_EDICTS];
+	float from[LERP_NUM_COMPONENTS][MAX_EDICTS];
+	float delta[LERP_NUM_COMPONENTS][MAX_EDICTS];
+	float lerped[LERP_NUM_COMPONENTS][MAX_EDICTS];
+
+	// everything else is interpolated one by one
+	int numScalar;
+	int scalarEnts[MAX_EDICTS];
+} cg_lerpbatch_t;
+
+static cg_lerpbatch_t cg_lerpBatch;
+
 /*
 * CG_FixVolumeCvars
 * Don't let the user go too far away with volumes
@@ -363,6 +404,7 @@ bool CG_NewFrameSnap( snapshot_t *frame, snapshot_t *lerpframe ) {
 	gs.gameState = frame->gameState;
 
 	cg.portalInView = false;
+	cg_lerpBatch.valid = false;
 
 	if( cg_projectileAntilagOffset->value > 1.0f || cg_projectileAntilagOffset->value < 0.0f ) {
 		trap_Cvar_ForceSet( "cg_projectileAntilagOffset", cg_projectileAntilagOffset->dvalue );
@@ -1834,6 +1876,36 @@ void CG_EntityLoopSound( entity_state_t *state, float attenuation ) {
 	trap_S_AddLoopSound( cgs.soundPrecache[state->sound], state->number, cg_volume_effects->value, ISVIEWERENTITY( state->number ) ? ATTN_NONE : ATTN_IDLE );
 }
 
+/*
+* CG_EntityOutsidePVS
+*
+* Multiview and all-entities snapshots aren't culled by the server for our point of view,
+* so models that can't be seen from the view origin are skipped. Portals may see past the
+* PVS of the view, so nothing is culled while there's one in view.
+*/
+static bool CG_EntityOutsidePVS( const centity_t *cent, bool cullByPVS ) {
+	int i;
+	float radius;
+	vec3_t mins, maxs;
+
+	if( !cullByPVS || cent->current.solid == SOLID_BMODEL ) {
+		return false;
+	}
+
+	// the model may be rotated, so test the box around its bounding sphere
+	radius = 0;
+	if( cent->ent.model ) {
+		trap_R_ModelBounds( cent->ent.model, mins, maxs );
+		radius = RadiusFromBounds( mins, maxs ) * ( cent->ent.scale ? cent->ent.scale : 1.0f );
+	}
+	for( i = 0; i < 3; i++ ) {
+		mins[i] = cent->ent.origin[i] - radius - 1;
+		maxs[i] = cent->ent.origin[i] + radius + 1;
+	}
+
+	return !trap_CM_BoxInPVS( cg.view.origin, mins, maxs );
+}
+
 /*
 * CG_AddPacketEntitiesToScene
 * Add the entities to the rendering list
@@ -1843,12 +1915,14 @@ void CG_AddEntities( void ) {
 	vec3_t autorotate;
 	int pnum;
 	centity_t *cent;
-	bool canLight;
+	bool canLight, cullByPVS;
 
 	// bonus items rotate at a fixed rate
 	VectorSet( autorotate, 0, ( cg.time % 3600 ) * 0.1 * ( cg.view.flipped ? -1.0f : 1.0f ), 0 );
 	AnglesToAxis( autorotate, cg.autorotateAxis );
 
+	cullByPVS = ( cg.frame.multipov || cg.frame.allentities ) && !cg.portalInView;
+
 	for( pnum = 0; pnum < cg.frame.numEntities; pnum++ ) {
 		state = &cg.frame.parsedEntities[pnum & ( MAX_PARSE_ENTITIES - 1 )];
 		cent = &cg_entities[state->number];
@@ -1863,7 +1937,9 @@ void CG_AddEntities( void ) {
 
 		switch( cent->type ) {
 			case ET_GENERIC:
-				CG_AddGenericEnt( cent );
+				if( !CG_EntityOutsidePVS( cent, cullByPVS ) ) {
+					CG_AddGenericEnt( cent );
+				}
 				if( cg_drawEntityBoxes->integer ) {
 					CG_DrawEntityBox( cent );
 				}
@@ -1872,7 +1948,9 @@ void CG_AddEntities( void ) {
 				break;
 			case ET_GIB:
 				if( cg_gibs->integer ) {
-					CG_AddGenericEnt( cent );
+					if( !CG_EntityOutsidePVS( cent, cullByPVS ) ) {
+						CG_AddGenericEnt( cent );
+					}
 					CG_EntityLoopSound( state, ATTN_STATIC );
 					canLight = true;
 				}
@@ -1909,6 +1987,13 @@ void CG_AddEntities( void ) {
 				break;
 
 			case ET_SPRITE:
+				if( !CG_EntityOutsidePVS( cent, cullByPVS ) ) {
+					CG_AddSpriteEnt( cent );
+				}
+				CG_EntityLoopSound( state, ATTN_STATIC );
+				canLight = true;
+				break;
+
 			case ET_RADAR:
 				CG_AddSpriteEnt( cent );
 				CG_EntityLoopSound( state, ATTN_STATIC );
@@ -1916,7 +2001,9 @@ void CG_AddEntities( void ) {
 				break;
 
 			case ET_ITEM:
-				CG_AddItemEnt( cent );
+				if( !CG_EntityOutsidePVS( cent, cullByPVS ) ) {
+					CG_AddItemEnt( cent );
+				}
 				if( cg_drawEntityBoxes->integer ) {
 					CG_DrawEntityBox( cent );
 				}
@@ -2037,22 +2124,99 @@ void CG_AddEntities( void ) {
 }
 
 /*
-* CG_LerpEntities
-* Interpolate the entity states positions into the entity_t structs
+* CG_LerpEntity
 */
-void CG_LerpEntities( void ) {
+static void CG_LerpEntity( centity_t *cent ) {
+	switch( cent->type ) {
+		case ET_GENERIC:
+		case ET_GIB:
+		case ET_BLASTER:
+		case ET_ELECTRO_WEAK:
+		case ET_ROCKET:
+		case ET_PLASMA:
+		case ET_GRENADE:
+		case ET_ITEM:
+		case ET_PLAYER:
+		case ET_CORPSE:
+		case ET_FLAG_BASE:
+		case ET_MONSTER_PLAYER:
+		case ET_MONSTER_CORPSE:
+			if( cent->current.linearMovement ) {
+				CG_ExtrapolateLinearProjectile( cent );
+			} else {
+				CG_LerpGenericEnt( cent );
+			}
+			break;
+
+		case ET_SPRITE:
+		case ET_RADAR:
+			CG_LerpSpriteEnt( cent );
+			break;
+
+		case ET_DECAL:
+			CG_LerpDecalEnt( cent );
+			break;
+
+		case ET_BEAM:
+
+			// beams aren't interpolated
+			break;
+
+		case ET_LASERBEAM:
+		case ET_CURVELASERBEAM:
+			CG_LerpLaserbeamEnt( cent );
+			break;
+
+		case ET_MINIMAP_ICON:
+			break;
+
+		case ET_PORTALSURFACE:
+
+			//portals aren't interpolated
+			break;
+
+		case ET_PUSH_TRIGGER:
+			break;
+
+		case ET_EVENT:
+		case ET_SOUNDEVENT:
+			break;
+
+		case ET_ITEM_TIMER:
+			break;
+
+		case ET_PARTICLES:
+			break;
+
+		case ET_VIDEO_SPEAKER:
+			break;
+
+		default:
+			CG_Error( "CG_LerpEntities: unknown entity type" );
+			break;
+	}
+}
+
+/*
+* CG_BuildLerpBatch
+*
+* Sorts the entities of the new snapshot by how they are interpolated. Generic entities
+* with plain interpolation have their origins and angles laid out for CG_LerpEntityBatch,
+* the ones that don't move only get their axis rebuilt when their angles change.
+*/
+static void CG_BuildLerpBatch( void ) {
+	int pnum, i, k;
+	float a1, a2;
 	entity_state_t *state;
-	int pnum;
 	centity_t *cent;
+	cg_lerpbatch_t *batch = &cg_lerpBatch;
 
-	for( pnum = 0; pnum < cg.frame.numEntities; pnum++ ) {
-		int number;
-		bool spatialize;
+	batch->numStill = batch->numMoving = batch->numScalar = 0;
+	batch->extrapolationTime = cgs.extrapolationTime;
 
+	for( pnum = 0; pnum < cg.frame.numEntities; pnum++ ) {
 		state = &cg.frame.parsedEntities[pnum & ( MAX_PARSE_ENTITIES - 1 )];
-		number = state->number;
-		cent = &cg_entities[number];
-		spatialize = true;
+		cent = &cg_entities[state->number];
 
 		switch( cent->type ) {
 			case ET_GENERIC:
@@ -2068,67 +2232,200 @@ void CG_LerpEntities( void ) {
 			case ET_FLAG_BASE:
 			case ET_MONSTER_PLAYER:
 			case ET_MONSTER_CORPSE:
-				if( state->linearMovement ) {
-					CG_ExtrapolateLinearProjectile( cent );
+				if( !state->linearMovement && !( cent->renderfx & RF_FRAMELERP ) &&
+					!( cgs.extrapolationTime && cent->canExtrapolate ) ) {
+					break;
+				}
+				batch->scalarEnts[batch->numScalar++] = state->number;
+				continue;
+
+			case ET_BEAM:
+			case ET_MINIMAP_ICON:
+			case ET_PORTALSURFACE:
+			case ET_PUSH_TRIGGER:
+			case ET_EVENT:
+			case ET_SOUNDEVENT:
+			case ET_ITEM_TIMER:
+			case ET_PARTICLES:
+			case ET_VIDEO_SPEAKER:
+				continue;
+
+			default:
+				batch->scalarEnts[batch->numScalar++] = state->number;
+				continue;
+		}
+
+		if( VectorCompare( cent->prev.angles, cent->current.angles ) ) {
+			if( !cent->lerpAxisValid || !VectorCompare( cent->lerpAxisAngles, cent->current.angles ) ) {
+				if( cent->current.angles[0] || cent->current.angles[1] || cent->current.angles[2] ) {
+					AnglesToAxis( cent->current.angles, cent->lerpAxis );
 				} else {
-					CG_LerpGenericEnt( cent );
+					Matrix3_Copy( axis_identity, cent->lerpAxis );
 				}
-				break;
+				VectorCopy( cent->current.angles, cent->lerpAxisAngles );
+				cent->lerpAxisValid = true;
+			}
 
-			case ET_SPRITE:
-			case ET_RADAR:
-				CG_LerpSpriteEnt( cent );
-				break;
+			if( VectorCompare( cent->prev.origin, cent->current.origin ) ) {
+				batch->stillEnts[batch->numStill++] = state->number;
+				continue;
+			}
+		}
 
-			case ET_DECAL:
-				CG_LerpDecalEnt( cent );
-				break;
+		i = batch->numMoving++;
+		batch->movingEnts[i] = state->number;
+		batch->movingTurns[i] = !VectorCompare( cent->prev.angles, cent->current.angles );
 
-			case ET_BEAM:
+		for( k = 0; k < 3; k++ ) {
+			batch->from[LERP_ORIGIN_X + k][i] = cent->prev.origin[k];
+			batch->delta[LERP_ORIGIN_X + k][i] = cent->current.origin[k] - cent->prev.origin[k];
 
-				// beams aren't interpolated
-				break;
+			// same as LerpAngle, with the shortest turn worked out once per snapshot
+			a2 = cent->prev.angles[k];
+			a1 = cent->current.angles[k];
+			if( a1 - a2 > 180 ) {
+				a1 -= 360;
+			}
+			if( a1 - a2 < -180 ) {
+				a1 += 360;
+			}
+			batch->from[LERP_PITCH + k][i] = a2;
+			batch->delta[LERP_PITCH + k][i] = a1 - a2;
+		}
+	}
 
-			case ET_LASERBEAM:
-			case ET_CURVELASERBEAM:
-				CG_LerpLaserbeamEnt( cent );
-				break;
+	batch->valid = true;
+}
 
-			case ET_MINIMAP_ICON:
-				break;
+/*
+* CG_LerpComponents_Generic
+*
+* Interpolates components [first, count)
+*/
+static void CG_LerpComponents_Generic( float *out, const float *from, const float *delta, int first, int count, float frac ) {
+	int i;
 
-			case ET_PORTALSURFACE:
+	for( i = first; i < count; i++ ) {
+		out[i] = from[i] + frac * delta[i];
+	}
+}
 
-				//portals aren't interpolated
-				break;
+#ifdef CG_LERP_SSE2
+/*
+* CG_LerpComponents_SSE2
+*
+* Returns the number of components interpolated, the rest is left for the generic path
+*/
+static int CG_LerpComponents_SSE2( float *out, const float *from, const float *delta, int count, float frac ) {
+	int i;
+	const __m128 f = _mm_set1_ps( frac );
 
-			case ET_PUSH_TRIGGER:
-				break;
+	for( i = 0; i + 4 <= count; i += 4 ) {
+		_mm_storeu_ps( out + i, _mm_add_ps( _mm_loadu_ps( from + i ), _mm_mul_ps( f, _mm_loadu_ps( delta + i ) ) ) );
+	}
 
-			case ET_EVENT:
-			case ET_SOUNDEVENT:
-				break;
+	return i;
+}
+#endif
 
-			case ET_ITEM_TIMER:
-				break;
+/*
+* CG_LerpEntityBatch
+*/
+static void CG_LerpEntityBatch( void ) {
+	int i, k, first;
+	float backlerp;
+	vec3_t angles;
+	centity_t *cent;
+	cg_lerpbatch_t *batch = &cg_lerpBatch;
 
-			case ET_PARTICLES:
-				break;
+	for( k = 0; k < LERP_NUM_COMPONENTS; k++ ) {
+		first = 0;
+#ifdef CG_LERP_SSE2
+		first = CG_LerpComponents_SSE2( batch->lerped[k], batch->from[k], batch->delta[k], batch->numMoving, cg.lerpfrac );
+#endif
+		CG_LerpComponents_Generic( batch->lerped[k], batch->from[k], batch->delta[k], first, batch->numMoving, cg.lerpfrac );
+	}
 
-			case ET_VIDEO_SPEAKER:
-				break;
+	backlerp = 1.0f - cg.lerpfrac;
 
-			default:
-				CG_Error( "CG_LerpEntities: unknown entity type" );
-				break;
+	for( i = 0; i < batch->numMoving; i++ ) {
+		cent = &cg_entities[batch->movingEnts[i]];
+
+		// the viewed player isn't known until the view is set up
+		if( ISVIEWERENTITY( cent->current.number ) || cg.view.POVent == cent->current.number ) {
+			CG_LerpGenericEnt( cent );
+			continue;
+		}
+
+		cent->ent.backlerp = backlerp;
+
+		if( batch->movingTurns[i] ) {
+			angles[0] = batch->lerped[LERP_PITCH][i];
+			angles[1] = batch->lerped[LERP_YAW][i];
+			angles[2] = batch->lerped[LERP_ROLL][i];
+			if( angles[0] || angles[1] || angles[2] ) {
+				AnglesToAxis( angles, cent->ent.axis );
+			} else {
+				Matrix3_Copy( axis_identity, cent->ent.axis );
+			}
+		} else {
+			Matrix3_Copy( cent->lerpAxis, cent->ent.axis );
+		}
+
+		cent->ent.origin[0] = batch->lerped[LERP_ORIGIN_X][i];
+		cent->ent.origin[1] = batch->lerped[LERP_ORIGIN_Y][i];
+		cent->ent.origin[2] = batch->lerped[LERP_ORIGIN_Z][i];
+		VectorCopy( cent->ent.origin, cent->ent.origin2 );
+		VectorCopy( cent->ent.origin, cent->ent.lightingOrigin );
+	}
+
+	for( i = 0; i < batch->numStill; i++ ) {
+		cent = &cg_entities[batch->stillEnts[i]];
+
+		if( ISVIEWERENTITY( cent->current.number ) || cg.view.POVent == cent->current.number ) {
+			CG_LerpGenericEnt( cent );
+			continue;
 		}
 
-		if( spatialize ) {
-			vec3_t origin, velocity;
-			CG_GetEntitySpatilization( number, origin, velocity );
-			trap_S_SetEntitySpatilization( number, origin, velocity );
+		cent->ent.backlerp = backlerp;
+		Matrix3_Copy( cent->lerpAxis, cent->ent.axis );
+		VectorCopy( cent->current.origin, cent->ent.origin );
+		VectorCopy( cent->current.origin, cent->ent.origin2 );
+		VectorCopy( cent->current.origin, cent->ent.lightingOrigin );
+	}
+
+	for( i = 0; i < batch->numScalar; i++ ) {
+		CG_LerpEntity( &cg_entities[batch->scalarEnts[i]] );
+	}
+}
+
+/*
+* CG_LerpEntities
+* Interpolate the entity states positions into the entity_t structs
+*/
+void CG_LerpEntities( void ) {
+	entity_state_t *state;
+	int pnum;
+
+	if( cg_lerpBatch.valid && cg_lerpBatch.extrapolationTime == cgs.extrapolationTime ) {
+		CG_LerpEntityBatch();
+	} else {
+		for( pnum = 0; pnum < cg.frame.numEntities; pnum++ ) {
+			state = &cg.frame.parsedEntities[pnum & ( MAX_PARSE_ENTITIES - 1 )];
+			CG_LerpEntity( &cg_entities[state->number] );
 		}
 	}
+
+	for( pnum = 0; pnum < cg.frame.numEntities; pnum++ ) {
+		int number;
+		vec3_t origin, velocity;
+
+		state = &cg.frame.parsedEntities[pnum & ( MAX_PARSE_ENTITIES - 1 )];
+		number = state->number;
+
+		CG_GetEntitySpatilization( number, origin, velocity );
+		trap_S_SetEntitySpatilization( number, origin, velocity );
+	}
 }
 
 /*
@@ -2248,6 +2545,8 @@ void CG_UpdateEntities( void ) {
 	}
 
 	CG_SortItemTimers();
+
+	CG_BuildLerpBatch();
 }
 
 //=============================================================
@@ -1632,8 +1632,9 @@ static opFunc_t CG_OperatorFuncForArgument( const char *token ) {
 
 //=============================================================================
 
-static const char *CG_GetStringArg( struct cg_layoutnode_s **argumentsnode );
-static float CG_GetNumericArg( struct cg_layoutnode_s **argumentsnode );
+static const char *CG_GetStringArg( struct cg_layoutarg_s **argumentsnode );
+static float CG_GetNumericArg( struct cg_layoutarg_s **argumentsnode );
+static struct shader_s *CG_GetShaderArg( struct cg_layoutarg_s **argumentsnode );
 
 //=============================================================================
 
@@ -1653,6 +1654,21 @@ static int layout_cursor_font_style;
 struct qfontface_s *(*layout_cursor_font_regfunc)( const char *, int, unsigned int );
 static bool layout_cursor_font_dirty = true;
 
+// HUDs switch between a few fonts many times per frame, so remember the registered ones
+#define MAX_LAYOUT_FONTS 16
+
+typedef struct
+{
+	char name[MAX_QPATH];
+	int size;
+	int style;
+	struct qfontface_s *(*regfunc)( const char *, int, unsigned int );
+	struct qfontface_s *font;
+} cg_layoutfont_t;
+
+static cg_layoutfont_t layout_fonts[MAX_LAYOUT_FONTS];
+static int layout_numFonts;
+
 static struct qfontface_s *CG_GetLayoutCursorFont( void );
 
 enum
@@ -1660,13 +1676,15 @@ enum
 	LNODE_NUMERIC,
 	LNODE_STRING,
 	LNODE_REFERENCE_NUMERIC,
+	LNODE_REFERENCE_STAT,       // only in compiled programs
+	LNODE_REFERENCE_CVAR,       // only in compiled programs
 	LNODE_COMMAND
 };
 
 //=============================================================================
 // Commands' Functions
 //=============================================================================
-static bool CG_LFuncDrawTimer( struct cg_layoutnode_s *commandnode, struct cg_layoutnode_s *argumentnode, int numArguments ) {
+static bool CG_LFuncDrawTimer( struct cg_layoutinstr_s *commandnode, struct cg_layoutarg_s *argumentnode, int numArguments ) {
 	char time[64];
 	int min, sec, milli;
 
@@ -1687,7 +1705,7 @@ static bool CG_LFuncDrawTimer( struct cg_layoutnode_s *commandnode, struct cg_la
 	return true;
 }
 
-static bool CG_LFuncDrawPicVar( struct cg_layoutnode_s *commandnode, struct cg_layoutnode_s *argumentnode, int numArguments ) {
+static bool CG_LFuncDrawPicVar( struct cg_layoutinstr_s *commandnode, struct cg_layoutarg_s *argumentnode, int numArguments ) {
 	int min, max, val, firstimg, lastimg, imgcount;
 	static char filefmt[MAX_QPATH], filenm[MAX_QPATH], *ptr;
 	int x, y, filenr;
@@ -1764,7 +1782,7 @@ static bool CG_LFuncDrawPicVar( struct cg_layoutnode_s *commandnode, struct cg_l
 	return true;
 }
 
-static bool CG_LFuncDrawPicByIndex( struct cg_layoutnode_s *commandnode, struct cg_layoutnode_s *argumentnode, int numArguments ) {
+static bool CG_LFuncDrawPicByIndex( struct cg_layoutinstr_s *commandnode, struct cg_layoutarg_s *argumentnode, int numArguments ) {
 	int value = (int)CG_GetNumericArg( &argumentnode );
 	int x, y;
 
@@ -1780,7 +1798,7 @@ static bool CG_LFuncDrawPicByIndex( struct cg_layoutnode_s *commandnode, struct
 	return false;
 }
 
-static bool CG_LFuncDrawPicByItemIndex( struct cg_layoutnode_s *commandnode, struct cg_layoutnode_s *argumentnode, int numArguments ) {
+static bool CG_LFuncDrawPicByItemIndex( struct cg_layoutinstr_s *commandnode, struct cg_layoutarg_s *argumentnode, int numArguments ) {
 	int itemindex = (int)CG_GetNumericArg( &argumentnode );
 	int x, y;
 	gsitem_t    *item;
@@ -1795,16 +1813,16 @@ static bool CG_LFuncDrawPicByItemIndex( struct cg_layoutnode_s *commandnode, str
 	return true;
 }
 
-static bool CG_LFuncDrawPicByName( struct cg_layoutnode_s *commandnode, struct cg_layoutnode_s *argumentnode, int numArguments ) {
+static bool CG_LFuncDrawPicByName( struct cg_layoutinstr_s *commandnode, struct cg_layoutarg_s *argumentnode, int numArguments ) {
 	int x, y;
 
 	x = CG_HorizontalAlignForWidth( layout_cursor_x, layout_cursor_align, layout_cursor_width );
 	y = CG_VerticalAlignForHeight( layout_cursor_y, layout_cursor_align, layout_cursor_height );
-	trap_R_DrawStretchPic( x, y, layout_cursor_width, layout_cursor_height, 0, 0, 1, 1, layout_cursor_color, trap_R_RegisterPic( CG_GetStringArg( &argumentnode ) ) );
+	trap_R_DrawStretchPic( x, y, layout_cursor_width, layout_cursor_height, 0, 0, 1, 1, layout_cursor_color, CG_GetShaderArg( &argumentnode ) );
 	return true;
 }
 
-static bool CG_LFuncDrawSubPicByName( struct cg_layoutnode_s *commandnode, struct cg_layoutnode_s *argumentnode, int numArguments ) {
+static bool CG_LFuncDrawSubPicByName( struct cg_layoutinstr_s *commandnode, struct cg_layoutarg_s *argumentnode, int numArguments ) {
 	int x, y;
 	struct shader_s *shader;
 	float s1, t1, s2, t2;
@@ -1812,7 +1830,7 @@ static bool CG_LFuncDrawSubPicByName( struct cg_layoutnode_s *commandnode, struc
 	x = CG_HorizontalAlignForWidth( layout_cursor_x, layout_cursor_align, layout_cursor_width );
 	y = CG_VerticalAlignForHeight( layout_cursor_y, layout_cursor_align, layout_cursor_height );
 
-	shader = trap_R_RegisterPic( CG_GetStringArg( &argumentnode ) );
+	shader = CG_GetShaderArg( &argumentnode );
 
 	s1 = CG_GetNumericArg( &argumentnode );
 	t1 = CG_GetNumericArg( &argumentnode );
@@ -1823,7 +1841,7 @@ static bool CG_LFuncDrawSubPicByName( struct cg_layoutnode_s *commandnode, struc
 	return true;
 }
 
-static bool CG_LFuncDrawRotatedPicByName( struct cg_layoutnode_s *commandnode, struct cg_layoutnode_s *argumentnode, int numArguments ) {
+static bool CG_LFuncDrawRotatedPicByName( struct cg_layoutinstr_s *commandnode, struct cg_layoutarg_s *argumentnode, int numArguments ) {
 	int x, y;
 	struct shader_s *shader;
 	float angle;
@@ -1831,7 +1849,7 @@ static bool CG_LFuncDrawRotatedPicByName( struct cg_layoutnode_s *commandnode, s
 	x = CG_HorizontalAlignForWidth( layout_cursor_x, layout_cursor_align, layout_cursor_width );
 	y = CG_VerticalAlignForHeight( layout_cursor_y, layout_cursor_align, layout_cursor_height );
 
-	shader = trap_R_RegisterPic( CG_GetStringArg( &argumentnode ) );
+	shader = CG_GetShaderArg( &argumentnode );
 
 	angle = CG_GetNumericArg( &argumentnode );
 
@@ -1839,7 +1857,7 @@ static bool CG_LFuncDrawRotatedPicByName( struct cg_layoutnode_s *commandnode, s
 	return true;
 }
 
-static bool CG_LFuncDrawModelByIndex( struct cg_layoutnode_s *commandnode, struct cg_layoutnode_s *argumentnode, int numArguments ) {
+static bool CG_LFuncDrawModelByIndex( struct cg_layoutinstr_s *commandnode, struct cg_layoutarg_s *argumentnode, int numArguments ) {
 	struct model_s *model;
 	int value = (int)CG_GetNumericArg( &argumentnode );
 
@@ -1852,7 +1870,7 @@ static bool CG_LFuncDrawModelByIndex( struct cg_layoutnode_s *commandnode, struc
 	return false;
 }
 
-static bool CG_LFuncDrawModelByName( struct cg_layoutnode_s *commandnode, struct cg_layoutnode_s *argumentnode, int numArguments ) {
+static bool CG_LFuncDrawModelByName( struct cg_layoutinstr_s *commandnode, struct cg_layoutarg_s *argumentnode, int numArguments ) {
 	struct model_s *model;
 	struct shader_s *shader;
 	const char *shadername;
@@ -1864,7 +1882,7 @@ static bool CG_LFuncDrawModelByName( struct cg_layoutnode_s *commandnode, struct
 	return true;
 }
 
-static bool CG_LFuncDrawModelByItemIndex( struct cg_layoutnode_s *commandnode, struct cg_layoutnode_s *argumentnode, int numArguments ) {
+static bool CG_LFuncDrawModelByItemIndex( struct cg_layoutinstr_s *commandnode, struct cg_layoutarg_s *argumentnode, int numArguments ) {
 	int i;
 	gsitem_t    *item;
 	struct model_s *model;
@@ -1883,7 +1901,7 @@ static bool CG_LFuncDrawModelByItemIndex( struct cg_layoutnode_s *commandnode, s
 	return true;
 }
 
-static bool CG_LFuncScale( struct cg_layoutnode_s *commandnode, struct cg_layoutnode_s *argumentnode, int numArguments ) {
+static bool CG_LFuncScale( struct cg_layoutinstr_s *commandnode, struct cg_layoutarg_s *argumentnode, int numArguments ) {
 	layout_cursor_scale = (int)CG_GetNumericArg( &argumentnode );
 	return true;
 }
@@ -1891,7 +1909,7 @@ static bool CG_LFuncScale( struct cg_layoutnode_s *commandnode, struct cg_layout
 #define SCALE_X( n ) ( ( layout_cursor_scale == NOSCALE ) ? ( n ) : ( ( layout_cursor_scale == SCALEBYHEIGHT ) ? ( n ) * cgs.vidHeight / 600.0f : ( n ) * cgs.vidWidth / 800.0f ) )
 #define SCALE_Y( n ) ( ( layout_cursor_scale == NOSCALE ) ? ( n ) : ( ( layout_cursor_scale == SCALEBYWIDTH ) ? ( n ) * cgs.vidWidth / 800.0f : ( n ) * cgs.vidHeight / 600.0f ) )
 
-static bool CG_LFuncCursor( struct cg_layoutnode_s *commandnode, struct cg_layoutnode_s *argumentnode, int numArguments ) {
+static bool CG_LFuncCursor( struct cg_layoutinstr_s *commandnode, struct cg_layoutarg_s *argumentnode, int numArguments ) {
 	float x, y;
 
 	x = CG_GetNumericArg( &argumentnode );
@@ -1904,7 +1922,7 @@ static bool CG_LFuncCursor( struct cg_layoutnode_s *commandnode, struct cg_layou
 	return true;
 }
 
-static bool CG_LFuncCursorX( struct cg_layoutnode_s *commandnode, struct cg_layoutnode_s *argumentnode, int numArguments ) {
+static bool CG_LFuncCursorX( struct cg_layoutinstr_s *commandnode, struct cg_layoutarg_s *argumentnode, int numArguments ) {
 	float x;
 
 	x = CG_GetNumericArg( &argumentnode );
@@ -1914,7 +1932,7 @@ static bool CG_LFuncCursorX( struct cg_layoutnode_s *commandnode, struct cg_layo
 	return true;
 }
 
-static bool CG_LFuncCursorY( struct cg_layoutnode_s *commandnode, struct cg_layoutnode_s *argumentnode, int numArguments ) {
+static bool CG_LFuncCursorY( struct cg_layoutinstr_s *commandnode, struct cg_layoutarg_s *argumentnode, int numArguments ) {
 	float y;
 
 	y = CG_GetNumericArg( &argumentnode );
@@ -1924,7 +1942,7 @@ static bool CG_LFuncCursorY( struct cg_layoutnode_s *commandnode, struct cg_layo
 	return true;
 }
 
-static bool CG_LFuncMoveCursor( struct cg_layoutnode_s *commandnode, struct cg_layoutnode_s *argumentnode, int numArguments ) {
+static bool CG_LFuncMoveCursor( struct cg_layoutinstr_s *commandnode, struct cg_layoutarg_s *argumentnode, int numArguments ) {
 	float x, y;
 
 	x = CG_GetNumericArg( &argumentnode );
@@ -1937,7 +1955,7 @@ static bool CG_LFuncMoveCursor( struct cg_layoutnode_s *commandnode, struct cg_l
 	return true;
 }
 
-static bool CG_LFuncSize( struct cg_layoutnode_s *commandnode, struct cg_layoutnode_s *argumentnode, int numArguments ) {
+static bool CG_LFuncSize( struct cg_layoutinstr_s *commandnode, struct cg_layoutarg_s *argumentnode, int numArguments ) {
 	float x, y;
 
 	x = CG_GetNumericArg( &argumentnode );
@@ -1950,7 +1968,7 @@ static bool CG_LFuncSize( struct cg_layoutnode_s *commandnode, struct cg_layoutn
 	return true;
 }
 
-static bool CG_LFuncSizeWidth( struct cg_layoutnode_s *commandnode, struct cg_layoutnode_s *argumentnode, int numArguments ) {
+static bool CG_LFuncSizeWidth( struct cg_layoutinstr_s *commandnode, struct cg_layoutarg_s *argumentnode, int numArguments ) {
 	float x;
 
 	x = CG_GetNumericArg( &argumentnode );
@@ -1960,7 +1978,7 @@ static bool CG_LFuncSizeWidth( struct cg_layoutnode_s *commandnode, struct cg_la
 	return true;
 }
 
-static bool CG_LFuncSizeHeight( struct cg_layoutnode_s *commandnode, struct cg_layoutnode_s *argumentnode, int numArguments ) {
+static bool CG_LFuncSizeHeight( struct cg_layoutinstr_s *commandnode, struct cg_layoutarg_s *argumentnode, int numArguments ) {
 	float y;
 
 	y = CG_GetNumericArg( &argumentnode );
@@ -1970,7 +1988,7 @@ static bool CG_LFuncSizeHeight( struct cg_layoutnode_s *commandnode, struct cg_l
 	return true;
 }
 
-static bool CG_LFuncColor( struct cg_layoutnode_s *commandnode, struct cg_layoutnode_s *argumentnode, int numArguments ) {
+static bool CG_LFuncColor( struct cg_layoutinstr_s *commandnode, struct cg_layoutarg_s *argumentnode, int numArguments ) {
 	int i;
 	for( i = 0; i < 4; i++ ) {
 		layout_cursor_color[i] = CG_GetNumericArg( &argumentnode );
@@ -1979,17 +1997,17 @@ static bool CG_LFuncColor( struct cg_layoutnode_s *commandnode, struct cg_layout
 	return true;
 }
 
-static bool CG_LFuncColorToTeamColor( struct cg_layoutnode_s *commandnode, struct cg_layoutnode_s *argumentnode, int numArguments ) {
+static bool CG_LFuncColorToTeamColor( struct cg_layoutinstr_s *commandnode, struct cg_layoutarg_s *argumentnode, int numArguments ) {
 	CG_TeamColor( CG_GetNumericArg( &argumentnode ), layout_cursor_color );
 	return true;
 }
 
-static bool CG_LFuncColorAlpha( struct cg_layoutnode_s *commandnode, struct cg_layoutnode_s *argumentnode, int numArguments ) {
+static bool CG_LFuncColorAlpha( struct cg_layoutinstr_s *commandnode, struct cg_layoutarg_s *argumentnode, int numArguments ) {
 	layout_cursor_color[3] = CG_GetNumericArg( &argumentnode );
 	return true;
 }
 
-static bool CG_LFuncRotationSpeed( struct cg_layoutnode_s *commandnode, struct cg_layoutnode_s *argumentnode, int numArguments ) {
+static bool CG_LFuncRotationSpeed( struct cg_layoutinstr_s *commandnode, struct cg_layoutarg_s *argumentnode, int numArguments ) {
 	int i;
 	for( i = 0; i < 3; i++ ) {
 		layout_cursor_rotation[i] = CG_GetNumericArg( &argumentnode );
@@ -1998,7 +2016,7 @@ static bool CG_LFuncRotationSpeed( struct cg_layoutnode_s *commandnode, struct c
 	return true;
 }
 
-static bool CG_LFuncAlign( struct cg_layoutnode_s *commandnode, struct cg_layoutnode_s *argumentnode, int numArguments ) {
+static bool CG_LFuncAlign( struct cg_layoutinstr_s *commandnode, struct cg_layoutarg_s *argumentnode, int numArguments ) {
 	int v, h;
 
 	h = (int)CG_GetNumericArg( &argumentnode );
@@ -2014,7 +2032,9 @@ static bool CG_LFuncAlign( struct cg_layoutnode_s *commandnode, struct cg_layout
 }
 
 static struct qfontface_s *CG_GetLayoutCursorFont( void ) {
+	int i;
 	struct qfontface_s *font;
+	cg_layoutfont_t *cached;
 
 	if( !layout_cursor_font_dirty ) {
 		return layout_cursor_font;
@@ -2023,18 +2043,37 @@ static struct qfontface_s *CG_GetLayoutCursorFont( void ) {
 		layout_cursor_font_regfunc = trap_SCR_RegisterFont;
 	}
 
+	layout_cursor_font_dirty = false;
+
+	for( i = 0; i < layout_numFonts; i++ ) {
+		cached = &layout_fonts[i];
+		if( cached->size == layout_cursor_font_size && cached->style == layout_cursor_font_style &&
+			cached->regfunc == layout_cursor_font_regfunc && !strcmp( cached->name, layout_cursor_font_name ) ) {
+			layout_cursor_font = cached->font;
+			return layout_cursor_font;
+		}
+	}
+
 	font = layout_cursor_font_regfunc( layout_cursor_font_name, layout_cursor_font_style, layout_cursor_font_size );
 	if( font ) {
 		layout_cursor_font = font;
 	} else {
 		layout_cursor_font = cgs.fontSystemSmall;
 	}
-	layout_cursor_font_dirty = false;
+
+	if( layout_numFonts < MAX_LAYOUT_FONTS ) {
+		cached = &layout_fonts[layout_numFonts++];
+		Q_strncpyz( cached->name, layout_cursor_font_name, sizeof( cached->name ) );
+		cached->size = layout_cursor_font_size;
+		cached->style = layout_cursor_font_style;
+		cached->regfunc = layout_cursor_font_regfunc;
+		cached->font = layout_cursor_font;
+	}
 
 	return layout_cursor_font;
 }
 
-static bool CG_LFuncFontFamily( struct cg_layoutnode_s *commandnode, struct cg_layoutnode_s *argumentnode, int numArguments ) {
+static bool CG_LFuncFontFamily( struct cg_layoutinstr_s *commandnode, struct cg_layoutarg_s *argumentnode, int numArguments ) {
 	const char *fontname = CG_GetStringArg( &argumentnode );
 
 	if( !Q_stricmp( fontname, "con_fontSystem" ) ) {
@@ -2050,7 +2089,7 @@ static bool CG_LFuncFontFamily( struct cg_layoutnode_s *commandnode, struct cg_l
 	return true;
 }
 
-static bool CG_LFuncSpecialFontFamily( struct cg_layoutnode_s *commandnode, struct cg_layoutnode_s *argumentnode, int numArguments ) {
+static bool CG_LFuncSpecialFontFamily( struct cg_layoutinstr_s *commandnode, struct cg_layoutarg_s *argumentnode, int numArguments ) {
 	const char *fontname = CG_GetStringArg( &argumentnode );
 
 	Q_strncpyz( layout_cursor_font_name, fontname, sizeof( layout_cursor_font_name ) );
@@ -2060,8 +2099,8 @@ static bool CG_LFuncSpecialFontFamily( struct cg_layoutnode_s *commandnode, stru
 	return true;
 }
 
-static bool CG_LFuncFontSize( struct cg_layoutnode_s *commandnode, struct cg_layoutnode_s *argumentnode, int numArguments ) {
-	struct cg_layoutnode_s *charnode = argumentnode;
+static bool CG_LFuncFontSize( struct cg_layoutinstr_s *commandnode, struct cg_layoutarg_s *argumentnode, int numArguments ) {
+	struct cg_layoutarg_s *charnode = argumentnode;
 	const char *fontsize = CG_GetStringArg( &charnode );
 
 	if( !Q_stricmp( fontsize, "con_fontsystemsmall" ) ) {
@@ -2081,7 +2120,7 @@ static bool CG_LFuncFontSize( struct cg_layoutnode_s *commandnode, struct cg_lay
 	return true;
 }
 
-static bool CG_LFuncFontStyle( struct cg_layoutnode_s *commandnode, struct cg_layoutnode_s *argumentnode, int numArguments ) {
+static bool CG_LFuncFontStyle( struct cg_layoutinstr_s *commandnode, struct cg_layoutarg_s *argumentnode, int numArguments ) {
 	const char *fontstyle = CG_GetStringArg( &argumentnode );
 
 	if( !Q_stricmp( fontstyle, "normal" ) ) {
@@ -2102,7 +2141,7 @@ static bool CG_LFuncFontStyle( struct cg_layoutnode_s *commandnode, struct cg_la
 	return true;
 }
 
-static bool CG_LFuncDrawObituaries( struct cg_layoutnode_s *commandnode, struct cg_layoutnode_s *argumentnode, int numArguments ) {
+static bool CG_LFuncDrawObituaries( struct cg_layoutinstr_s *commandnode, struct cg_layoutarg_s *argumentnode, int numArguments ) {
 	int internal_align = (int)CG_GetNumericArg( &argumentnode );
 	int icon_size = (int)CG_GetNumericArg( &argumentnode );
 
@@ -2111,12 +2150,12 @@ static bool CG_LFuncDrawObituaries( struct cg_layoutnode_s *commandnode, struct
 	return true;
 }
 
-static bool CG_LFuncDrawAwards( struct cg_layoutnode_s *commandnode, struct cg_layoutnode_s *argumentnode, int numArguments ) {
+static bool CG_LFuncDrawAwards( struct cg_layoutinstr_s *commandnode, struct cg_layoutarg_s *argumentnode, int numArguments ) {
 	CG_DrawAwards( layout_cursor_x, layout_cursor_y, layout_cursor_align, CG_GetLayoutCursorFont(), layout_cursor_color );
 	return true;
 }
 
-static bool CG_LFuncDrawClock( struct cg_layoutnode_s *commandnode, struct cg_layoutnode_s *argumentnode, int numArguments ) {
+static bool CG_LFuncDrawClock( struct cg_layoutinstr_s *commandnode, struct cg_layoutarg_s *argumentnode, int numArguments ) {
 	CG_DrawClock( layout_cursor_x, layout_cursor_y, layout_cursor_align, CG_GetLayoutCursorFont(), layout_cursor_color );
 	return true;
 }
@@ -2125,7 +2164,7 @@ static bool CG_LFuncDrawClock( struct cg_layoutnode_s *commandnode, struct cg_la
 #define HELPMESSAGE_OVERSHOOT_FREQUENCY 6.0f
 #define HELPMESSAGE_OVERSHOOT_DECAY 10.0f
 
-static bool CG_LFuncDrawHelpMessage( struct cg_layoutnode_s *commandnode, struct cg_layoutnode_s *argumentnode, int numArguments ) {
+static bool CG_LFuncDrawHelpMessage( struct cg_layoutinstr_s *commandnode, struct cg_layoutarg_s *argumentnode, int numArguments ) {
 	// hide this one when scoreboard is up
 	if( !CG_IsScoreboardShown() ) {
 		if( !cgs.demoPlaying ) {
@@ -2186,17 +2225,17 @@ static bool CG_LFuncDrawHelpMessage( struct cg_layoutnode_s *commandnode, struct
 	return true;
 }
 
-static bool CG_LFuncDrawTeamMates( struct cg_layoutnode_s *commandnode, struct cg_layoutnode_s *argumentnode, int numArguments ) {
+static bool CG_LFuncDrawTeamMates( struct cg_layoutinstr_s *commandnode, struct cg_layoutarg_s *argumentnode, int numArguments ) {
 	CG_DrawTeamMates();
 	return true;
 }
 
-static bool CG_LFuncDrawPointed( struct cg_layoutnode_s *commandnode, struct cg_layoutnode_s *argumentnode, int numArguments ) {
+static bool CG_LFuncDrawPointed( struct cg_layoutinstr_s *commandnode, struct cg_layoutarg_s *argumentnode, int numArguments ) {
 	CG_DrawPlayerNames( CG_GetLayoutCursorFont(), layout_cursor_color );
 	return true;
 }
 
-static bool CG_LFuncDrawString( struct cg_layoutnode_s *commandnode, struct cg_layoutnode_s *argumentnode, int numArguments ) {
+static bool CG_LFuncDrawString( struct cg_layoutinstr_s *commandnode, struct cg_layoutarg_s *argumentnode, int numArguments ) {
 	const char *string = CG_GetStringArg( &argumentnode );
 
 	if( !string || !string[0] ) {
@@ -2237,13 +2276,13 @@ static bool CG_LFuncDrawStringRepeat_x( const char *string, int num_draws ) {
 	return true;
 }
 
-static bool CG_LFuncDrawStringRepeat( struct cg_layoutnode_s *commandnode, struct cg_layoutnode_s *argumentnode, int numArguments ) {
+static bool CG_LFuncDrawStringRepeat( struct cg_layoutinstr_s *commandnode, struct cg_layoutarg_s *argumentnode, int numArguments ) {
 	const char *string = CG_GetStringArg( &argumentnode );
 	int num_draws = CG_GetNumericArg( &argumentnode );
 	return CG_LFuncDrawStringRepeat_x( string, num_draws );
 }
 
-static bool CG_LFuncDrawStringRepeatConfigString( struct cg_layoutnode_s *commandnode, struct cg_layoutnode_s *argumentnode, int numArguments ) {
+static bool CG_LFuncDrawStringRepeatConfigString( struct cg_layoutinstr_s *commandnode, struct cg_layoutarg_s *argumentnode, int numArguments ) {
 	const char *string = CG_GetStringArg( &argumentnode );
 	int index = (int)CG_GetNumericArg( &argumentnode );
 
@@ -2256,7 +2295,7 @@ static bool CG_LFuncDrawStringRepeatConfigString( struct cg_layoutnode_s *comman
 	return CG_LFuncDrawStringRepeat_x( string, num_draws );
 }
 
-static bool CG_LFuncDrawItemNameFromIndex( struct cg_layoutnode_s *commandnode, struct cg_layoutnode_s *argumentnode, int numArguments ) {
+static bool CG_LFuncDrawItemNameFromIndex( struct cg_layoutinstr_s *commandnode, struct cg_layoutarg_s *argumentnode, int numArguments ) {
 	gsitem_t    *item;
 	int itemindex = CG_GetNumericArg( &argumentnode );
 
@@ -2269,7 +2308,7 @@ static bool CG_LFuncDrawItemNameFromIndex( struct cg_layoutnode_s *commandnode,
 	return true;
 }
 
-static bool CG_LFuncDrawConfigstring( struct cg_layoutnode_s *commandnode, struct cg_layoutnode_s *argumentnode, int numArguments ) {
+static bool CG_LFuncDrawConfigstring( struct cg_layoutinstr_s *commandnode, struct cg_layoutarg_s *argumentnode, int numArguments ) {
 	int index = (int)CG_GetNumericArg( &argumentnode );
 
 	if( index < 0 || index >= MAX_CONFIGSTRINGS ) {
@@ -2281,7 +2320,7 @@ static bool CG_LFuncDrawConfigstring( struct cg_layoutnode_s *commandnode, struc
 	return true;
 }
 
-static bool CG_LFuncDrawCleanConfigstring( struct cg_layoutnode_s *commandnode, struct cg_layoutnode_s *argumentnode, int numArguments ) {
+static bool CG_LFuncDrawCleanConfigstring( struct cg_layoutinstr_s *commandnode, struct cg_layoutarg_s *argumentnode, int numArguments ) {
 	int index = (int)CG_GetNumericArg( &argumentnode );
 
 	if( index < 0 || index >= MAX_CONFIGSTRINGS ) {
@@ -2293,7 +2332,7 @@ static bool CG_LFuncDrawCleanConfigstring( struct cg_layoutnode_s *commandnode,
 	return true;
 }
 
-static bool CG_LFuncDrawPlayerName( struct cg_layoutnode_s *commandnode, struct cg_layoutnode_s *argumentnode, int numArguments ) {
+static bool CG_LFuncDrawPlayerName( struct cg_layoutinstr_s *commandnode, struct cg_layoutarg_s *argumentnode, int numArguments ) {
 	int index = (int)CG_GetNumericArg( &argumentnode ) - 1;
 
 	if( cgs.demoTutorial ) {
@@ -2311,7 +2350,7 @@ static bool CG_LFuncDrawPlayerName( struct cg_layoutnode_s *commandnode, struct
 	return false;
 }
 
-static bool CG_LFuncDrawCleanPlayerName( struct cg_layoutnode_s *commandnode, struct cg_layoutnode_s *argumentnode, int numArguments ) {
+static bool CG_LFuncDrawCleanPlayerName( struct cg_layoutinstr_s *commandnode, struct cg_layoutarg_s *argumentnode, int numArguments ) {
 	int index = (int)CG_GetNumericArg( &argumentnode ) - 1;
 
 	if( cgs.demoTutorial ) {
@@ -2326,13 +2365,13 @@ static bool CG_LFuncDrawCleanPlayerName( struct cg_layoutnode_s *commandnode, st
 	return false;
 }
 
-static bool CG_LFuncDrawNumeric( struct cg_layoutnode_s *commandnode, struct cg_layoutnode_s *argumentnode, int numArguments ) {
+static bool CG_LFuncDrawNumeric( struct cg_layoutinstr_s *commandnode, struct cg_layoutarg_s *argumentnode, int numArguments ) {
 	int value = (int)CG_GetNumericArg( &argumentnode );
 	CG_DrawHUDNumeric( layout_cursor_x, layout_cursor_y, layout_cursor_align, layout_cursor_color, layout_cursor_width, layout_cursor_height, value );
 	return true;
 }
 
-static bool CG_LFuncDrawStretchNum( struct cg_layoutnode_s *commandnode, struct cg_layoutnode_s *argumentnode, int numArguments ) {
+static bool CG_LFuncDrawStretchNum( struct cg_layoutinstr_s *commandnode, struct cg_layoutarg_s *argumentnode, int numArguments ) {
 	static char num[16];
 	int len;
 	int value = (int)CG_GetNumericArg( &argumentnode );
@@ -2347,14 +2386,14 @@ static bool CG_LFuncDrawStretchNum( struct cg_layoutnode_s *commandnode, struct
 	return true;
 }
 
-static bool CG_LFuncDrawNumeric2( struct cg_layoutnode_s *commandnode, struct cg_layoutnode_s *argumentnode, int numArguments ) {
+static bool CG_LFuncDrawNumeric2( struct cg_layoutinstr_s *commandnode, struct cg_layoutarg_s *argumentnode, int numArguments ) {
 	int value = (int)CG_GetNumericArg( &argumentnode );
 
 	trap_SCR_DrawString( layout_cursor_x, layout_cursor_y, layout_cursor_align, va( "%i", value ), CG_GetLayoutCursorFont(), layout_cursor_color );
 	return true;
 }
 
-static bool CG_LFuncDrawBar( struct cg_layoutnode_s *commandnode, struct cg_layoutnode_s *argumentnode, int numArguments ) {
+static bool CG_LFuncDrawBar( struct cg_layoutinstr_s *commandnode, struct cg_layoutarg_s *argumentnode, int numArguments ) {
 	int value = (int)CG_GetNumericArg( &argumentnode );
 	int maxvalue = (int)CG_GetNumericArg( &argumentnode );
 	CG_DrawHUDRect( layout_cursor_x, layout_cursor_y, layout_cursor_align,
@@ -2363,17 +2402,17 @@ static bool CG_LFuncDrawBar( struct cg_layoutnode_s *commandnode, struct cg_layo
 	return true;
 }
 
-static bool CG_LFuncDrawPicBar( struct cg_layoutnode_s *commandnode, struct cg_layoutnode_s *argumentnode, int numArguments ) {
+static bool CG_LFuncDrawPicBar( struct cg_layoutinstr_s *commandnode, struct cg_layoutarg_s *argumentnode, int numArguments ) {
 	int value = (int)CG_GetNumericArg( &argumentnode );
 	int maxvalue = (int)CG_GetNumericArg( &argumentnode );
 
 	CG_DrawHUDRect( layout_cursor_x, layout_cursor_y, layout_cursor_align,
 					layout_cursor_width, layout_cursor_height, value, maxvalue,
-					layout_cursor_color, trap_R_RegisterPic( CG_GetStringArg( &argumentnode ) ) );
+					layout_cursor_color, CG_GetShaderArg( &argumentnode ) );
 	return true;
 }
 
-static bool CG_LFuncDrawWeaponIcon( struct cg_layoutnode_s *commandnode, struct cg_layoutnode_s *argumentnode, int numArguments ) {
+static bool CG_LFuncDrawWeaponIcon( struct cg_layoutinstr_s *commandnode, struct cg_layoutarg_s *argumentnode, int numArguments ) {
 	int weapon = cg.predictedPlayerState.stats[STAT_WEAPON];
 	int x, y;
 
@@ -2387,7 +2426,7 @@ static bool CG_LFuncDrawWeaponIcon( struct cg_layoutnode_s *commandnode, struct
 	return true;
 }
 
-static bool CG_LFuncCustomWeaponIcons( struct cg_layoutnode_s *commandnode, struct cg_layoutnode_s *argumentnode, int numArguments ) {
+static bool CG_LFuncCustomWeaponIcons( struct cg_layoutinstr_s *commandnode, struct cg_layoutarg_s *argumentnode, int numArguments ) {
 	int weapon = (int)CG_GetNumericArg( &argumentnode );
 	int hasgun = (int)CG_GetNumericArg( &argumentnode );
 
@@ -2404,7 +2443,7 @@ static bool CG_LFuncCustomWeaponIcons( struct cg_layoutnode_s *commandnode, stru
 	return true;
 }
 
-static bool CG_LFuncResetCustomWeaponIcons( struct cg_layoutnode_s *commandnode, struct cg_layoutnode_s *argumentnode, int numArguments ) {
+static bool CG_LFuncResetCustomWeaponIcons( struct cg_layoutinstr_s *commandnode, struct cg_layoutarg_s *argumentnode, int numArguments ) {
 	int weapon;
 	for( weapon = 0; weapon < WEAP_TOTAL - 1; weapon++ ) {
 		customWeaponPics[weapon] = NULL;
@@ -2414,12 +2453,12 @@ static bool CG_LFuncResetCustomWeaponIcons( struct cg_layoutnode_s *commandnode,
 	return true;
 }
 
-static bool CG_LFuncCustomWeaponSelect( struct cg_layoutnode_s *commandnode, struct cg_layoutnode_s *argumentnode, int numArguments ) {
+static bool CG_LFuncCustomWeaponSelect( struct cg_layoutinstr_s *commandnode, struct cg_layoutarg_s *argumentnode, int numArguments ) {
 	customWeaponSelectPic = CG_GetStringArg( &argumentnode );
 	return true;
 }
 
-static void CG_LFuncsWeaponIcons( struct cg_layoutnode_s *argumentnode, bool touch ) {
+static void CG_LFuncsWeaponIcons( struct cg_layoutarg_s *argumentnode, bool touch ) {
 	int offx, offy, w, h;
 
 	offx = (int)( CG_GetNumericArg( &argumentnode ) * cgs.vidWidth / 800 );
@@ -2430,17 +2469,17 @@ static void CG_LFuncsWeaponIcons( struct cg_layoutnode_s *argumentnode, bool tou
 	CG_DrawWeaponIcons( layout_cursor_x, layout_cursor_y, offx, offy, w, h, layout_cursor_align, touch );
 }
 
-static bool CG_LFuncDrawWeaponIcons( struct cg_layoutnode_s *commandnode, struct cg_layoutnode_s *argumentnode, int numArguments ) {
+static bool CG_LFuncDrawWeaponIcons( struct cg_layoutinstr_s *commandnode, struct cg_layoutarg_s *argumentnode, int numArguments ) {
 	CG_LFuncsWeaponIcons( argumentnode, false );
 	return true;
 }
 
-static bool CG_LFuncTouchWeaponIcons( struct cg_layoutnode_s *commandnode, struct cg_layoutnode_s *argumentnode, int numArguments ) {
+static bool CG_LFuncTouchWeaponIcons( struct cg_layoutinstr_s *commandnode, struct cg_layoutarg_s *argumentnode, int numArguments ) {
 	CG_LFuncsWeaponIcons( argumentnode, true );
 	return true;
 }
 
-static bool CG_LFuncSetTouchWeaponDropOffset( struct cg_layoutnode_s *commandnode, struct cg_layoutnode_s *argumentnode, int numArguments ) {
+static bool CG_LFuncSetTouchWeaponDropOffset( struct cg_layoutinstr_s *commandnode, struct cg_layoutarg_s *argumentnode, int numArguments ) {
 	float x, y;
 
 	x = CG_GetNumericArg( &argumentnode );
@@ -2453,7 +2492,7 @@ static bool CG_LFuncSetTouchWeaponDropOffset( struct cg_layoutnode_s *commandnod
 	return true;
 }
 
-static bool CG_LFuncDrawWeaponCross( struct cg_layoutnode_s *commandnode, struct cg_layoutnode_s *argumentnode, int numArguments ) {
+static bool CG_LFuncDrawWeaponCross( struct cg_layoutinstr_s *commandnode, struct cg_layoutarg_s *argumentnode, int numArguments ) {
 	int ammoofs = (int)( CG_GetNumericArg( &argumentnode ) * cgs.vidHeight / 600 );
 	int ammosize = (int)( CG_GetNumericArg( &argumentnode ) * cgs.vidHeight / 600 );
 	int ammopass;
@@ -2472,12 +2511,12 @@ static bool CG_LFuncDrawWeaponCross( struct cg_layoutnode_s *commandnode, struct
 	return true;
 }
 
-static bool CG_LFuncDrawCaptureAreas( struct cg_layoutnode_s *commandnode, struct cg_layoutnode_s *argumentnode, int numArguments ) {
+static bool CG_LFuncDrawCaptureAreas( struct cg_layoutinstr_s *commandnode, struct cg_layoutarg_s *argumentnode, int numArguments ) {
 	// FIXME: DELETE ME
 	return true;
 }
 
-static bool CG_LFuncDrawMiniMap( struct cg_layoutnode_s *commandnode, struct cg_layoutnode_s *argumentnode, int numArguments ) {
+static bool CG_LFuncDrawMiniMap( struct cg_layoutinstr_s *commandnode, struct cg_layoutarg_s *argumentnode, int numArguments ) {
 	float viewDist;
 
 	viewDist = CG_GetNumericArg( &argumentnode );
@@ -2487,7 +2526,7 @@ static bool CG_LFuncDrawMiniMap( struct cg_layoutnode_s *commandnode, struct cg_
 	return true;
 }
 
-static bool CG_LFuncDrawLocationName( struct cg_layoutnode_s *commandnode, struct cg_layoutnode_s *argumentnode, int numArguments ) {
+static bool CG_LFuncDrawLocationName( struct cg_layoutinstr_s *commandnode, struct cg_layoutarg_s *argumentnode, int numArguments ) {
 	int loc_tag = CG_GetNumericArg( &argumentnode );
 	char string[MAX_CONFIGSTRING_CHARS];
 
@@ -2501,7 +2540,7 @@ static bool CG_LFuncDrawLocationName( struct cg_layoutnode_s *commandnode, struc
 	return true;
 }
 
-static bool CG_LFuncDrawWeaponWeakAmmo( struct cg_layoutnode_s *commandnode, struct cg_layoutnode_s *argumentnode, int numArguments ) {
+static bool CG_LFuncDrawWeaponWeakAmmo( struct cg_layoutinstr_s *commandnode, struct cg_layoutarg_s *argumentnode, int numArguments ) {
 	int offx, offy, fontsize;
 
 	offx = (int)( CG_GetNumericArg( &argumentnode ) * cgs.vidWidth / 800 );
@@ -2513,7 +2552,7 @@ static bool CG_LFuncDrawWeaponWeakAmmo( struct cg_layoutnode_s *commandnode, str
 	return true;
 }
 
-static bool CG_LFuncDrawWeaponStrongAmmo( struct cg_layoutnode_s *commandnode, struct cg_layoutnode_s *argumentnode, int numArguments ) {
+static bool CG_LFuncDrawWeaponStrongAmmo( struct cg_layoutinstr_s *commandnode, struct cg_layoutarg_s *argumentnode, int numArguments ) {
 	int offx, offy, fontsize;
 
 	offx = (int)( CG_GetNumericArg( &argumentnode ) * cgs.vidWidth / 800 );
@@ -2525,35 +2564,35 @@ static bool CG_LFuncDrawWeaponStrongAmmo( struct cg_layoutnode_s *commandnode, s
 	return true;
 }
 
-static bool CG_LFuncDrawTeamInfo( struct cg_layoutnode_s *commandnode, struct cg_layoutnode_s *argumentnode, int numArguments ) {
+static bool CG_LFuncDrawTeamInfo( struct cg_layoutinstr_s *commandnode, struct cg_layoutarg_s *argumentnode, int numArguments ) {
 	CG_DrawTeamInfo( layout_cursor_x, layout_cursor_y, layout_cursor_align, CG_GetLayoutCursorFont(), layout_cursor_color );
 	return true;
 }
 
-static bool CG_LFuncDrawCrossHair( struct cg_layoutnode_s *commandnode, struct cg_layoutnode_s *argumentnode, int numArguments ) {
+static bool CG_LFuncDrawCrossHair( struct cg_layoutinstr_s *commandnode, struct cg_layoutarg_s *argumentnode, int numArguments ) {
 	CG_DrawCrosshair( layout_cursor_x, layout_cursor_y, layout_cursor_align );
 	return true;
 }
 
-static bool CG_LFuncDrawKeyState( struct cg_layoutnode_s *commandnode, struct cg_layoutnode_s *argumentnode, int numArguments ) {
+static bool CG_LFuncDrawKeyState( struct cg_layoutinstr_s *commandnode, struct cg_layoutarg_s *argumentnode, int numArguments ) {
 	const char *key = CG_GetStringArg( &argumentnode );
 
 	CG_DrawKeyState( layout_cursor_x, layout_cursor_y, layout_cursor_width, layout_cursor_height, layout_cursor_align, key );
 	return true;
 }
 
-static bool CG_LFuncDrawNet( struct cg_layoutnode_s *commandnode, struct cg_layoutnode_s *argumentnode, int numArguments ) {
+static bool CG_LFuncDrawNet( struct cg_layoutinstr_s *commandnode, struct cg_layoutarg_s *argumentnode, int numArguments ) {
 	CG_DrawNet( layout_cursor_x, layout_cursor_y, layout_cursor_width, layout_cursor_height, layout_cursor_align, layout_cursor_color );
 	return true;
 }
 
-static bool CG_LFuncDrawChat( struct cg_layoutnode_s *commandnode, struct cg_layoutnode_s *argumentnode, int numArguments ) {
+static bool CG_LFuncDrawChat( struct cg_layoutinstr_s *commandnode, struct cg_layoutarg_s *argumentnode, int numArguments ) {
 	int padding_x, padding_y;
 	struct shader_s *shader;
 
 	padding_x = (int)( CG_GetNumericArg( &argumentnode ) ) * cgs.vidWidth / 800;
 	padding_y = (int)( CG_GetNumericArg( &argumentnode ) ) * cgs.vidHeight / 600;
-	shader = trap_R_RegisterPic( CG_GetStringArg( &argumentnode ) );
+	shader = CG_GetShaderArg( &argumentnode );
 
 	CG_DrawChat( &cg.chat, layout_cursor_x, layout_cursor_y, layout_cursor_font_name, CG_GetLayoutCursorFont(), layout_cursor_font_size,
 				 layout_cursor_width, layout_cursor_height, padding_x, padding_y, layout_cursor_color, shader );
@@ -2564,7 +2603,7 @@ static void CG_MoveUpFunc( int id, int64_t time ) {
 	CG_SetTouchpad( TOUCHPAD_MOVE, -1 );
 }
 
-static bool CG_LFuncTouchMove( struct cg_layoutnode_s *commandnode, struct cg_layoutnode_s *argumentnode, int numArguments ) {
+static bool CG_LFuncTouchMove( struct cg_layoutinstr_s *commandnode, struct cg_layoutarg_s *argumentnode, int numArguments ) {
 	int touch = CG_TouchArea( TOUCHAREA_HUD_MOVE,
 							  CG_HorizontalAlignForWidth( layout_cursor_x, layout_cursor_align, layout_cursor_width ),
 							  CG_VerticalAlignForHeight( layout_cursor_y, layout_cursor_align, layout_cursor_height ),
@@ -2603,7 +2642,7 @@ static void CG_ViewUpFunc( int id, int64_t time ) {
 	}
 }
 
-static bool CG_LFuncTouchView( struct cg_layoutnode_s *commandnode, struct cg_layoutnode_s *argumentnode, int numArguments ) {
+static bool CG_LFuncTouchView( struct cg_layoutinstr_s *commandnode, struct cg_layoutarg_s *argumentnode, int numArguments ) {
 	int touchID = CG_TouchArea( TOUCHAREA_HUD_VIEW,
 								CG_HorizontalAlignForWidth( layout_cursor_x, layout_cursor_align, layout_cursor_width ),
 								CG_VerticalAlignForHeight( layout_cursor_y, layout_cursor_align, layout_cursor_height ),
@@ -2639,7 +2678,7 @@ static void CG_UpmoveUpFunc( int id, int64_t time ) {
 	cg_hud_touch_upmove = 0;
 }
 
-static bool CG_LFuncTouchJump( struct cg_layoutnode_s *commandnode, struct cg_layoutnode_s *argumentnode, int numArguments ) {
+static bool CG_LFuncTouchJump( struct cg_layoutinstr_s *commandnode, struct cg_layoutarg_s *argumentnode, int numArguments ) {
 	if( CG_TouchArea( TOUCHAREA_HUD_JUMP,
 					  CG_HorizontalAlignForWidth( layout_cursor_x, layout_cursor_align, layout_cursor_width ),
 					  CG_VerticalAlignForHeight( layout_cursor_y, layout_cursor_align, layout_cursor_height ),
@@ -2649,7 +2688,7 @@ static bool CG_LFuncTouchJump( struct cg_layoutnode_s *commandnode, struct cg_la
 	return true;
 }
 
-static bool CG_LFuncTouchCrouch( struct cg_layoutnode_s *commandnode, struct cg_layoutnode_s *argumentnode, int numArguments ) {
+static bool CG_LFuncTouchCrouch( struct cg_layoutinstr_s *commandnode, struct cg_layoutarg_s *argumentnode, int numArguments ) {
 	if( CG_TouchArea( TOUCHAREA_HUD_CROUCH,
 					  CG_HorizontalAlignForWidth( layout_cursor_x, layout_cursor_align, layout_cursor_width ),
 					  CG_VerticalAlignForHeight( layout_cursor_y, layout_cursor_align, layout_cursor_height ),
@@ -2663,7 +2702,7 @@ static void CG_AttackUpFunc( int id, int64_t time ) {
 	cg_hud_touch_buttons &= ~BUTTON_ATTACK;
 }
 
-static bool CG_LFuncTouchAttack( struct cg_layoutnode_s *commandnode, struct cg_layoutnode_s *argumentnode, int numArguments ) {
+static bool CG_LFuncTouchAttack( struct cg_layoutinstr_s *commandnode, struct cg_layoutarg_s *argumentnode, int numArguments ) {
 	if( CG_TouchArea( TOUCHAREA_HUD_ATTACK,
 					  CG_HorizontalAlignForWidth( layout_cursor_x, layout_cursor_align, layout_cursor_width ),
 					  CG_VerticalAlignForHeight( layout_cursor_y, layout_cursor_align, layout_cursor_height ),
@@ -2677,7 +2716,7 @@ static void CG_SpecialUpFunc( int id, int64_t time ) {
 	cg_hud_touch_buttons &= ~BUTTON_SPECIAL;
 }
 
-static bool CG_LFuncTouchSpecial( struct cg_layoutnode_s *commandnode, struct cg_layoutnode_s *argumentnode, int numArguments ) {
+static bool CG_LFuncTouchSpecial( struct cg_layoutinstr_s *commandnode, struct cg_layoutarg_s *argumentnode, int numArguments ) {
 	if( CG_TouchArea( TOUCHAREA_HUD_SPECIAL,
 					  CG_HorizontalAlignForWidth( layout_cursor_x, layout_cursor_align, layout_cursor_width ),
 					  CG_VerticalAlignForHeight( layout_cursor_y, layout_cursor_align, layout_cursor_height ),
@@ -2687,7 +2726,7 @@ static bool CG_LFuncTouchSpecial( struct cg_layoutnode_s *commandnode, struct cg
 	return true;
 }
 
-static bool CG_LFuncTouchClassAction( struct cg_layoutnode_s *commandnode, struct cg_layoutnode_s *argumentnode, int numArguments ) {
+static bool CG_LFuncTouchClassAction( struct cg_layoutinstr_s *commandnode, struct cg_layoutarg_s *argumentnode, int numArguments ) {
 	if( CG_TouchArea( TOUCHAREA_HUD_CLASSACTION,
 					  CG_HorizontalAlignForWidth( layout_cursor_x, layout_cursor_align, layout_cursor_width ),
 					  CG_VerticalAlignForHeight( layout_cursor_y, layout_cursor_align, layout_cursor_height ),
@@ -2697,7 +2736,7 @@ static bool CG_LFuncTouchClassAction( struct cg_layoutnode_s *commandnode, struc
 	return true;
 }
 
-static bool CG_LFuncTouchDropItem( struct cg_layoutnode_s *commandnode, struct cg_layoutnode_s *argumentnode, int numArguments ) {
+static bool CG_LFuncTouchDropItem( struct cg_layoutinstr_s *commandnode, struct cg_layoutarg_s *argumentnode, int numArguments ) {
 	if( CG_TouchArea( TOUCHAREA_HUD_DROPITEM,
 					  CG_HorizontalAlignForWidth( layout_cursor_x, layout_cursor_align, layout_cursor_width ),
 					  CG_VerticalAlignForHeight( layout_cursor_y, layout_cursor_align, layout_cursor_height ),
@@ -2711,7 +2750,7 @@ static void CG_ScoresUpFunc( int id, int64_t time ) {
 	CG_ScoresOff_f();
 }
 
-static bool CG_LFuncTouchScores( struct cg_layoutnode_s *commandnode, struct cg_layoutnode_s *argumentnode, int numArguments ) {
+static bool CG_LFuncTouchScores( struct cg_layoutinstr_s *commandnode, struct cg_layoutarg_s *argumentnode, int numArguments ) {
 	if( CG_TouchArea( TOUCHAREA_HUD_SCORES,
 					  CG_HorizontalAlignForWidth( layout_cursor_x, layout_cursor_align, layout_cursor_width ),
 					  CG_VerticalAlignForHeight( layout_cursor_y, layout_cursor_align, layout_cursor_height ),
@@ -2721,11 +2760,11 @@ static bool CG_LFuncTouchScores( struct cg_layoutnode_s *commandnode, struct cg_
 	return true;
 }
 
-static bool CG_LFuncIf( struct cg_layoutnode_s *commandnode, struct cg_layoutnode_s *argumentnode, int numArguments ) {
+static bool CG_LFuncIf( struct cg_layoutinstr_s *commandnode, struct cg_layoutarg_s *argumentnode, int numArguments ) {
 	return (int)CG_GetNumericArg( &argumentnode ) != 0;
 }
 
-static bool CG_LFuncIfNot( struct cg_layoutnode_s *commandnode, struct cg_layoutnode_s *argumentnode, int numArguments ) {
+static bool CG_LFuncIfNot( struct cg_layoutinstr_s *commandnode, struct cg_layoutarg_s *argumentnode, int numArguments ) {
 	return (int)CG_GetNumericArg( &argumentnode ) == 0;
 }
 
@@ -2733,8 +2772,8 @@ static bool CG_LFuncIfNot( struct cg_layoutnode_s *commandnode, struct cg_layout
 typedef struct cg_layoutcommand_s
 {
 	const char *name;
-	bool ( *func )( struct cg_layoutnode_s *commandnode, struct cg_layoutnode_s *argumentnode, int numArguments );
-	bool ( *touchfunc )( struct cg_layoutnode_s *commandnode, struct cg_layoutnode_s *argumentnode, int numArguments );
+	bool ( *func )( struct cg_layoutinstr_s *commandnode, struct cg_layoutarg_s *argumentnode, int numArguments );
+	bool ( *touchfunc )( struct cg_layoutinstr_s *commandnode, struct cg_layoutarg_s *argumentnode, int numArguments );
 	int numparms;
 	const char *help;
 	bool precache;
@@ -3476,8 +3515,8 @@ void Cmd_CG_PrintHudHelp_f( void ) {
 
 typedef struct cg_layoutnode_s
 {
-	bool ( *func )( struct cg_layoutnode_s *commandnode, struct cg_layoutnode_s *argumentnode, int numArguments );
-	bool ( *touchfunc )( struct cg_layoutnode_s *commandnode, struct cg_layoutnode_s *argumentnode, int numArguments );
+	bool ( *func )( struct cg_layoutinstr_s *commandnode, struct cg_layoutarg_s *argumentnode, int numArguments );
+	bool ( *touchfunc )( struct cg_layoutinstr_s *commandnode, struct cg_layoutarg_s *argumentnode, int numArguments );
 	int type;
 	char *string;
 	int integer;
@@ -3489,18 +3528,59 @@ typedef struct cg_layoutnode_s
 	bool precache;
 } cg_layoutnode_t;
 
+// The parsed script is compiled into a flat program. Each instruction points to its
+// arguments, which are stored contiguously and terminated by an LNODE_COMMAND entry.
+// The instructions of an "if" block follow the "if" instruction and are skipped
+// altogether when the condition is false.
+
+typedef struct cg_layoutarg_s
+{
+	int type;
+	char *string;
+	int integer;                // stat or cvar index for the resolved references
+	float value;
+	int ( *func )( const void *parameter );
+	const void *parameter;
+	opFunc_t opFunc;
+	struct shader_s *shader;    // cached by CG_GetShaderArg
+} cg_layoutarg_t;
+
+typedef struct cg_layoutinstr_s
+{
+	bool ( *func )( struct cg_layoutinstr_s *commandnode, struct cg_layoutarg_s *argumentnode, int numArguments );
+	bool ( *touchfunc )( struct cg_layoutinstr_s *commandnode, struct cg_layoutarg_s *argumentnode, int numArguments );
+	cg_layoutarg_t *args;
+	int numArgs;
+	int numSkip;                // number of instructions in the "if" block
+} cg_layoutinstr_t;
+
+typedef struct cg_layoutprogram_s
+{
+	cg_layoutinstr_t *instrs;
+	int numInstrs;
+	cg_layoutarg_t *args;
+	int numArgs;
+
+	// cvars are looked up once per execution instead of once per reference
+	const char **cvarNames;
+	float *cvarValues;
+	int numCvars;
+} cg_layoutprogram_t;
+
+static cg_layoutprogram_t *cg_layoutProgram;   // the one being executed
+
 /*
 * CG_GetStringArg
 */
-static const char *CG_GetStringArg( struct cg_layoutnode_s **argumentsnode ) {
-	struct cg_layoutnode_s *anode = *argumentsnode;
+static const char *CG_GetStringArg( struct cg_layoutarg_s **argumentsnode ) {
+	struct cg_layoutarg_s *anode = *argumentsnode;
 
-	if( !anode || anode->type == LNODE_COMMAND ) {
+	if( anode->type == LNODE_COMMAND ) {
 		CG_Error( "'CG_LayoutGetIntegerArg': bad arg count" );
 	}
 
 	// we can return anything as string
-	*argumentsnode = anode->next;
+	*argumentsnode = anode + 1;
 	return anode->string;
 }
 
@@ -3508,23 +3588,32 @@ static const char *CG_GetStringArg( struct cg_layoutnode_s **argumentsnode ) {
 * CG_GetNumericArg
 * can use recursion for mathematical operations
 */
-static float CG_GetNumericArg( struct cg_layoutnode_s **argumentsnode ) {
-	struct cg_layoutnode_s *anode = *argumentsnode;
+static float CG_GetNumericArg( struct cg_layoutarg_s **argumentsnode ) {
+	struct cg_layoutarg_s *anode = *argumentsnode;
 	float value;
 
-	if( !anode || anode->type == LNODE_COMMAND ) {
+	if( anode->type == LNODE_COMMAND ) {
 		CG_Error( "'CG_LayoutGetIntegerArg': bad arg count" );
 	}
 
-	if( anode->type != LNODE_NUMERIC && anode->type != LNODE_REFERENCE_NUMERIC ) {
+	if( anode->type == LNODE_STRING ) {
 		CG_Printf( "WARNING: 'CG_LayoutGetIntegerArg': arg %s is not numeric", anode->string );
 	}
 
-	*argumentsnode = anode->next;
-	if( anode->type == LNODE_REFERENCE_NUMERIC ) {
-		value = cg_numeric_references[anode->integer].func( cg_numeric_references[anode->integer].parameter );
-	} else {
-		value = anode->value;
+	*argumentsnode = anode + 1;
+	switch( anode->type ) {
+		case LNODE_REFERENCE_STAT:
+			value = cg.predictedPlayerState.stats[anode->integer];
+			break;
+		case LNODE_REFERENCE_CVAR:
+			value = cg_layoutProgram->cvarValues[anode->integer];
+			break;
+		case LNODE_REFERENCE_NUMERIC:
+			value = anode->func( anode->parameter );
+			break;
+		default:
+			value = anode->value;
+			break;
 	}
 
 	// recurse if there are operators
@@ -3535,6 +3624,20 @@ static float CG_GetNumericArg( struct cg_layoutnode_s **argumentsnode ) {
 	return value;
 }
 
+/*
+* CG_GetShaderArg
+* registers the pic named by the argument the first time it's used
+*/
+static struct shader_s *CG_GetShaderArg( struct cg_layoutarg_s **argumentsnode ) {
+	struct cg_layoutarg_s *anode = *argumentsnode;
+	const char *name = CG_GetStringArg( argumentsnode );
+
+	if( !anode->shader ) {
+		anode->shader = trap_R_RegisterPic( name );
+	}
+	return anode->shader;
+}
+
 /*
 * CG_LayoutParseCommandNode
 * alloc a new node for a command
@@ -3791,7 +3894,6 @@ static bool CG_LayoutFixCommasInToken( char **ptr, char **backptr ) {
 */
 static cg_layoutnode_t *CG_RecurseParseLayoutScript( char **ptr, int level ) {
 	cg_layoutnode_t *command = NULL;
-	cg_layoutnode_t *argumentnode = NULL;
 	cg_layoutnode_t *node = NULL;
 	cg_layoutnode_t *rootnode = NULL;
 	int expecArgs = 0, numArgs = 0;
@@ -3919,7 +4021,6 @@ static cg_layoutnode_t *CG_RecurseParseLayoutScript( char **ptr, int level ) {
 
 				// move on into the new command
 				command = node;
-				argumentnode = NULL;
 				numArgs = 0;
 				expecArgs = command->integer;
 				add = true;
@@ -3930,27 +4031,11 @@ static cg_layoutnode_t *CG_RecurseParseLayoutScript( char **ptr, int level ) {
 		}
 
 		if( add == true ) {
-			if( command && command == rootnode ) {
-				if( !argumentnode ) {
-					argumentnode = node;
-				}
-			}
-
 			if( rootnode ) {
 				rootnode->next = node;
 			}
 			node->parent = rootnode;
 			rootnode = node;
-
-			// precache arguments by calling the function at load time
-			if( command && expecArgs == numArgs && command->func && command->precache ) {
-				Vector4Set( layout_cursor_color, 0, 0, 0, 0 );
-				layout_cursor_x = -layout_cursor_width - 1;
-				layout_cursor_y = -layout_cursor_height - 1;
-				layout_cursor_width = 0;
-				layout_cursor_height = 0;
-				command->func( command, argumentnode, numArgs );
-			}
 		}
 	}
 
@@ -3985,39 +4070,142 @@ static void CG_RecursePrintLayoutThread( cg_layoutnode_t *rootnode, int level )
 #endif
 
 /*
-* CG_ParseLayoutScript
+* CG_CountLayoutThread
+* counts the instructions and arguments needed to compile the thread and its "if" subtrees
 */
-static void CG_ParseLayoutScript( char *string, cg_layoutnode_t *rootnode ) {
+static void CG_CountLayoutThread( cg_layoutnode_t *rootnode, int *numInstrs, int *numArgs ) {
+	cg_layoutnode_t *node;
+
+	if( !rootnode ) {
+		return;
+	}
 
-	CG_RecurseFreeLayoutThread( cg.statusBar );
-	cg.statusBar = CG_RecurseParseLayoutScript( &string, 0 );
+	node = rootnode;
+	while( node->parent ) {
+		node = node->parent;
+	}
 
-#if 0
-	CG_RecursePrintLayoutThread( cg_layoutRootNode, 0 );
-#endif
+	for( ; node; node = node->next ) {
+		// commands need an extra argument to terminate their list
+		( *numArgs )++;
+
+		if( node->type == LNODE_COMMAND ) {
+			( *numInstrs )++;
+			CG_CountLayoutThread( node->ifthread, numInstrs, numArgs );
+		}
+	}
 }
 
-//=============================================================================
+/*
+* CG_LayoutCvarIndex
+*/
+static int CG_LayoutCvarIndex( cg_layoutprogram_t *program, const char *name ) {
+	int i;
 
-//=============================================================================
+	for( i = 0; i < program->numCvars; i++ ) {
+		if( !strcmp( program->cvarNames[i], name ) ) {
+			return i;
+		}
+	}
+
+	program->cvarNames[i] = name;
+	program->cvarValues[i] = (int)trap_Cvar_Value( name );
+	program->numCvars++;
+	return i;
+}
+
+/*
+* CG_CompileLayoutArgument
+* moves the argument node into the program, resolving the references
+*/
+static cg_layoutarg_t *CG_CompileLayoutArgument( cg_layoutprogram_t *program, cg_layoutnode_t *node ) {
+	cg_layoutarg_t *arg = &program->args[program->numArgs++];
+	const reference_numeric_t *ref;
+
+	arg->type = node->type;
+	arg->string = node->string;
+	arg->integer = node->integer;
+	arg->value = node->value;
+	arg->opFunc = node->opFunc;
+	node->string = NULL;
+
+	if( node->type == LNODE_REFERENCE_NUMERIC ) {
+		ref = &cg_numeric_references[node->integer];
+		if( ref->func == CG_GetStatValue || ref->func == CG_GetRaceStatValue ) {
+			arg->type = LNODE_REFERENCE_STAT;
+			arg->integer = (intptr_t)ref->parameter;
+		} else if( ref->func == CG_GetCvar ) {
+			arg->type = LNODE_REFERENCE_CVAR;
+			arg->integer = CG_LayoutCvarIndex( program, (const char *)ref->parameter );
+		} else {
+			arg->func = ref->func;
+			arg->parameter = ref->parameter;
+		}
+	}
+
+	return arg;
+}
+
+/*
+* CG_CompileLayoutArguments
+* compiles the arguments in [node, end), folding the constant parts of the expressions
+*/
+static void CG_CompileLayoutArguments( cg_layoutprogram_t *program, cg_layoutnode_t *node, cg_layoutnode_t *end ) {
+	cg_layoutnode_t *last, *constant;
+	cg_layoutarg_t *arg;
+	float value;
+
+	while( node != end ) {
+		// operators are evaluated from right to left, so the constant tail of the expression can be folded
+		constant = NULL;
+		for( last = node; ; last = last->next ) {
+			if( last->type != LNODE_NUMERIC ) {
+				constant = NULL;
+			} else if( !constant ) {
+				constant = last;
+			}
+
+			if( !last->opFunc || last->next == end ) {
+				break;
+			}
+		}
+
+		for( ; node != constant && node != last->next; node = node->next ) {
+			CG_CompileLayoutArgument( program, node );
+		}
+
+		if( constant == last ) {
+			CG_CompileLayoutArgument( program, constant );
+		} else if( constant ) {
+			value = last->value;
+			for( node = last; node != constant; ) {
+				node = node->parent;
+				value = node->opFunc( node->value, value );
+			}
+
+			arg = CG_CompileLayoutArgument( program, constant );
+			arg->integer = (int)value;
+			arg->value = value;
+			arg->opFunc = NULL;
+		}
+
+		node = last->next;
+	}
+}
 
 /*
-* CG_RecurseExecuteLayoutThread
-* Execution works like this: First node (on backwards) is expected to be the command, followed by arguments nodes.
-* we keep a pointer to the command and run the tree counting arguments until we reach the next command,
-* then we call the command function sending the pointer to first argument and the pointer to the command.
-* At return we advance one node (we stopped at last argument node) so it starts again from the next command (if any).
-*
-* When finding an "if" command with a subtree, we execute the "if" command. In the case it
-* returns any value, we recurse execute the subtree
+* CG_CompileLayoutThread
+* appends the thread to the program, returns the number of instructions added
 */
-static void CG_RecurseExecuteLayoutThread( cg_layoutnode_t *rootnode, bool touch ) {
-	cg_layoutnode_t *argumentnode = NULL;
-	cg_layoutnode_t *commandnode = NULL;
+static int CG_CompileLayoutThread( cg_layoutprogram_t *program, cg_layoutnode_t *rootnode ) {
+	cg_layoutnode_t *argumentnode;
+	cg_layoutnode_t *commandnode;
+	cg_layoutinstr_t *instr;
 	int numArguments;
+	int firstInstr = program->numInstrs;
 
 	if( !rootnode ) {
-		return;
+		return 0;
 	}
 
 	// run until the real root
@@ -4026,64 +4214,147 @@ static void CG_RecurseExecuteLayoutThread( cg_layoutnode_t *rootnode, bool touch
 		commandnode = commandnode->parent;
 	}
 
-	// now run backwards up to the next command node
 	while( commandnode ) {
-		argumentnode = commandnode->next;
-
 		// we could trust the parser, but I prefer counting the arguments here
 		numArguments = 0;
-		while( argumentnode ) {
+		for( argumentnode = commandnode->next; argumentnode; argumentnode = argumentnode->next ) {
 			if( argumentnode->type == LNODE_COMMAND ) {
 				break;
 			}
-
-			argumentnode = argumentnode->next;
 			numArguments++;
 		}
 
-		// reset
-		argumentnode = commandnode->next;
-
-		// Execute the command node
 		if( commandnode->integer != numArguments ) {
 			CG_Printf( "ERROR: Layout command %s: invalid argument count (expecting %i, found %i)\n", commandnode->string, commandnode->integer, numArguments );
-			return;
+			break;
 		}
-		if( !touch && commandnode->func ) {
-			//special case for if commands
-			if( commandnode->func( commandnode, argumentnode, numArguments ) ) {
-				// execute the "if" thread when command returns a value
-				if( commandnode->ifthread ) {
-					CG_RecurseExecuteLayoutThread( commandnode->ifthread, touch );
-				}
-			}
-		} else if( touch && commandnode->touchfunc ) {
-			//special case for if commands
-			if( commandnode->touchfunc( commandnode, argumentnode, numArguments ) ) {
-				// execute the "if" thread when command returns a value
-				if( commandnode->ifthread ) {
-					CG_RecurseExecuteLayoutThread( commandnode->ifthread, touch );
-				}
-			}
+
+		instr = &program->instrs[program->numInstrs++];
+		instr->func = commandnode->func;
+		instr->touchfunc = commandnode->touchfunc;
+		instr->args = &program->args[program->numArgs];
+		CG_CompileLayoutArguments( program, commandnode->next, argumentnode );
+		instr->numArgs = &program->args[program->numArgs] - instr->args;
+		program->args[program->numArgs++].type = LNODE_COMMAND;
+
+		// precache arguments by calling the function at load time
+		if( commandnode->func && commandnode->precache ) {
+			Vector4Set( layout_cursor_color, 0, 0, 0, 0 );
+			layout_cursor_x = -layout_cursor_width - 1;
+			layout_cursor_y = -layout_cursor_height - 1;
+			layout_cursor_width = 0;
+			layout_cursor_height = 0;
+			instr->func( instr, instr->args, instr->numArgs );
 		}
 
-		//move up to next command node
+		// the "if" subtree follows the command and is skipped when it returns false
+		instr->numSkip = CG_CompileLayoutThread( program, commandnode->ifthread );
+
 		commandnode = argumentnode;
-		if( commandnode == rootnode ) {
-			return;
-		}
+	}
+
+	return program->numInstrs - firstInstr;
+}
+
+/*
+* CG_CompileLayoutProgram
+*/
+static cg_layoutprogram_t *CG_CompileLayoutProgram( cg_layoutnode_t *rootnode ) {
+	int numInstrs = 0, numArgs = 0;
+	cg_layoutprogram_t *program;
+
+	CG_CountLayoutThread( rootnode, &numInstrs, &numArgs );
+	if( !numInstrs ) {
+		return NULL;
+	}
+
+	program = ( cg_layoutprogram_t * )CG_Malloc( sizeof( *program ) );
+	program->instrs = ( cg_layoutinstr_t * )CG_Malloc( numInstrs * sizeof( *program->instrs ) );
+	program->args = ( cg_layoutarg_t * )CG_Malloc( numArgs * sizeof( *program->args ) );
+	program->cvarNames = ( const char ** )CG_Malloc( numArgs * sizeof( *program->cvarNames ) );
+	program->cvarValues = ( float * )CG_Malloc( numArgs * sizeof( *program->cvarValues ) );
 
-		while( commandnode && commandnode->type != LNODE_COMMAND ) {
-			commandnode = commandnode->next;
+	cg_layoutProgram = program;
+	CG_CompileLayoutThread( program, rootnode );
+	cg_layoutProgram = NULL;
+
+	if( cg_debugHUD && cg_debugHUD->integer ) {
+		CG_Printf( "HUD: Compiled %i commands, %i arguments, %i cvars\n", program->numInstrs, program->numArgs, program->numCvars );
+	}
+
+	return program;
+}
+
+/*
+* CG_FreeLayoutProgram
+*/
+static void CG_FreeLayoutProgram( cg_layoutprogram_t *program ) {
+	int i;
+
+	if( !program ) {
+		return;
+	}
+
+	for( i = 0; i < program->numArgs; i++ ) {
+		if( program->args[i].string ) {
+			CG_Free( program->args[i].string );
 		}
 	}
+
+	CG_Free( program->instrs );
+	CG_Free( program->args );
+	CG_Free( program->cvarNames );
+	CG_Free( program->cvarValues );
+	CG_Free( program );
+}
+
+/*
+* CG_ParseLayoutScript
+*/
+static void CG_ParseLayoutScript( char *string ) {
+	cg_layoutnode_t *rootnode;
+
+	CG_FreeLayoutProgram( cg.statusBar );
+
+	rootnode = CG_RecurseParseLayoutScript( &string, 0 );
+	cg.statusBar = CG_CompileLayoutProgram( rootnode );
+	CG_RecurseFreeLayoutThread( rootnode );
+
+#if 0
+	CG_RecursePrintLayoutThread( cg_layoutRootNode, 0 );
+#endif
 }
 
+//=============================================================================
+
+//=============================================================================
+
 /*
 * CG_ExecuteLayoutProgram
 */
-void CG_ExecuteLayoutProgram( struct cg_layoutnode_s *rootnode, bool touch ) {
-	CG_RecurseExecuteLayoutThread( rootnode, touch );
+void CG_ExecuteLayoutProgram( struct cg_layoutprogram_s *program, bool touch ) {
+	int i;
+	cg_layoutinstr_t *instr, *end;
+	bool ( *func )( struct cg_layoutinstr_s *commandnode, struct cg_layoutarg_s *argumentnode, int numArguments );
+
+	if( !program ) {
+		return;
+	}
+
+	for( i = 0; i < program->numCvars; i++ ) {
+		program->cvarValues[i] = (int)trap_Cvar_Value( program->cvarNames[i] );
+	}
+
+	cg_layoutProgram = program;
+
+	for( instr = program->instrs, end = instr + program->numInstrs; instr < end; instr++ ) {
+		func = touch ? instr->touchfunc : instr->func;
+		if( !func || !func( instr, instr->args, instr->numArgs ) ) {
+			instr += instr->numSkip;
+		}
+	}
+
+	cg_layoutProgram = NULL;
 }
 
 //=============================================================================
@@ -4457,7 +4728,7 @@ static void CG_LoadStatusBarFile( char *path ) {
 	CG_ClearHUDInputState();
 
 	// load the new status bar program
-	CG_ParseLayoutScript( opt, cg.statusBar );
+	CG_ParseLayoutScript( opt );
 
 	// Free the opt buffer!
 	CG_Free( opt );
@@ -4468,6 +4739,7 @@ static void CG_LoadStatusBarFile( char *path ) {
 	layout_cursor_font_size = DEFAULT_SYSTEM_FONT_SMALL_SIZE;
 	layout_cursor_font_dirty = true;
 	layout_cursor_font_regfunc = trap_SCR_RegisterFont;
+	layout_numFonts = 0;
 
 	for( i = 0; i < WEAP_TOTAL - 1; i++ ) {
 		customWeaponPics[i] = NULL;
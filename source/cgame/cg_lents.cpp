@@ -17,13 +17,10 @@ along with this program; if not, write to the Free Software
 Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 */
-
 // cg_lents.c -- client side temporary entities
 
 #include "cg_local.h"
 
-#define MAX_LOCAL_ENTITIES  512
-
 static vec3_t debris_maxs = { 4, 4, 8 };
 static vec3_t debris_mins = { -4, -4, 0 };
 
@@ -40,12 +37,14 @@ typedef enum
 	LE_EXPLOSION_TRACER,
 	LE_DASH_SCALE,
 	LE_PUFF_SCALE,
-	LE_PUFF_SHRINK
+	LE_PUFF_SHRINK,
+
+	LE_NUM_TYPES
 } letype_t;
 
 typedef struct lentity_s
 {
-	struct lentity_s *prev, *next;
+	cg_poolnode_t node;
 
 	letype_t type;
 
@@ -70,8 +69,64 @@ typedef struct lentity_s
 	bonepose_t *static_boneposes;
 } lentity_t;
 
-lentity_t cg_localents[MAX_LOCAL_ENTITIES];
-lentity_t cg_localents_headnode, *cg_free_lents;
+// the lifetime of a local entity, evaluated once per frame
+typedef struct
+{
+	int frame;
+	float frac;
+	float scale;
+	float fade, fadeIn;
+} leframe_t;
+
+typedef struct
+{
+	const char *name;
+	int budget;
+	bool entity;                // added to the scene as a refdef entity
+
+	// returns false when the local entity should be removed
+	bool ( *think )( lentity_t *le, const leframe_t *lf );
+} letypeinfo_t;
+
+static bool CG_LE_RGBFade( lentity_t *le, const leframe_t *lf );
+static bool CG_LE_AlphaFade( lentity_t *le, const leframe_t *lf );
+static bool CG_LE_ScaleAlphaFade( lentity_t *le, const leframe_t *lf );
+static bool CG_LE_InverseScaleAlphaFade( lentity_t *le, const leframe_t *lf );
+static bool CG_LE_Laser( lentity_t *le, const leframe_t *lf );
+static bool CG_LE_ExplosionTracer( lentity_t *le, const leframe_t *lf );
+static bool CG_LE_DashScale( lentity_t *le, const leframe_t *lf );
+static bool CG_LE_PuffScale( lentity_t *le, const leframe_t *lf );
+static bool CG_LE_PuffShrink( lentity_t *le, const leframe_t *lf );
+
+static const letypeinfo_t cg_letypes[LE_NUM_TYPES] =
+{
+	{ "lents/free", 0, false, NULL },
+	{ "lents/nofade", 256, true, NULL },
+	{ "lents/rgbfade", 128, true, CG_LE_RGBFade },
+	{ "lents/alphafade", 512, true, CG_LE_AlphaFade },
+	{ "lents/scalefade", 256, true, CG_LE_ScaleAlphaFade },
+	{ "lents/invscalefade", 256, true, CG_LE_InverseScaleAlphaFade },
+	{ "lents/laser", 64, false, CG_LE_Laser },
+	{ "lents/tracer", 64, true, CG_LE_ExplosionTracer },
+	{ "lents/dash", 64, true, CG_LE_DashScale },
+	{ "lents/puffscale", 512, true, CG_LE_PuffScale },
+	{ "lents/puffshrink", 256, true, CG_LE_PuffShrink },
+};
+
+// local entities are bucketed by type, so each type has its own budget
+static cg_pool_t cg_localents[LE_NUM_TYPES];
+
+/*
+* CG_ReleaseLocalEntity
+*/
+static void CG_ReleaseLocalEntity( void *object ) {
+	lentity_t *le = ( lentity_t * )object;
+
+	if( le->static_boneposes ) {
+		CG_Free( le->static_boneposes );
+		le->static_boneposes = NULL;
+	}
+}
 
 /*
 * CG_ClearLocalEntities
@@ -79,32 +134,22 @@ lentity_t cg_localents_headnode, *cg_free_lents;
 void CG_ClearLocalEntities( void ) {
 	int i;
 
-	memset( cg_localents, 0, sizeof( cg_localents ) );
-
-	// link local entities
-	cg_free_lents = cg_localents;
-	cg_localents_headnode.prev = &cg_localents_headnode;
-	cg_localents_headnode.next = &cg_localents_headnode;
-	for( i = 0; i < MAX_LOCAL_ENTITIES - 1; i++ )
-		cg_localents[i].next = &cg_localents[i + 1];
+	for( i = LE_FREE + 1; i < LE_NUM_TYPES; i++ ) {
+		CG_InitPool( &cg_localents[i], cg_letypes[i].name, sizeof( lentity_t ), cg_letypes[i].budget, CG_ReleaseLocalEntity );
+	}
 }
 
 /*
 * CG_AllocLocalEntity
+*
+* Recycles the oldest local entity of the type when its budget is used up
 */
 static lentity_t *CG_AllocLocalEntity( letype_t type, float r, float g, float b, float a ) {
 	lentity_t *le;
 
-	if( cg_free_lents ) { // take a free decal if possible
-		le = cg_free_lents;
-		cg_free_lents = le->next;
-	} else {              // grab the oldest one otherwise
-		le = cg_localents_headnode.prev;
-		le->prev->next = le->next;
-		le->next->prev = le->prev;
-	}
+	le = ( lentity_t * )CG_PoolAlloc( &cg_localents[type], true );
 
-	memset( le, 0, sizeof( *le ) );
+	memset( ( uint8_t * )le + sizeof( le->node ), 0, sizeof( *le ) - sizeof( le->node ) );
 	le->type = type;
 	le->start = cg.time;
 	le->color[0] = r;
@@ -141,12 +186,6 @@ static lentity_t *CG_AllocLocalEntity( letype_t type, float r, float g, float b,
 			break;
 	}
 
-	// put the decal at the start of the list
-	le->prev = &cg_localents_headnode;
-	le->next = cg_localents_headnode.next;
-	le->next->prev = le;
-	le->prev->next = le;
-
 	return le;
 }
 
@@ -154,18 +193,7 @@ static lentity_t *CG_AllocLocalEntity( letype_t type, float r, float g, float b,
 * CG_FreeLocalEntity
 */
 static void CG_FreeLocalEntity( lentity_t *le ) {
-	if( le->static_boneposes ) {
-		CG_Free( le->static_boneposes );
-		le->static_boneposes = NULL;
-	}
-
-	// remove from linked active list
-	le->prev->next = le->next;
-	le->next->prev = le->prev;
-
-	// insert into linked free list
-	le->next = cg_free_lents;
-	cg_free_lents = le;
+	CG_PoolFree( &cg_localents[le->type], le );
 }
 
 /*
@@ -1489,231 +1517,317 @@ void CG_SmallPileOfGibs( const vec3_t origin, int damage, const vec3_t initialVe
 }
 
 /*
-* CG_AddLocalEntities
+* CG_LE_RGBFade
 */
-void CG_AddLocalEntities( void ) {
-#define FADEINFRAMES 2
-	int f;
-	lentity_t *le, *next, *hnode;
-	entity_t *ent;
-	float scale, frac, fade, time, scaleIn, fadeIn;
-	float backlerp;
-	vec3_t angles;
+static bool CG_LE_RGBFade( lentity_t *le, const leframe_t *lf ) {
+	float fade = fminf( lf->fade, lf->fadeIn );
 
-	time = (float)cg.frameTime * 0.001f;
-	backlerp = 1.0f - cg.lerpfrac;
+	le->ent.shaderRGBA[0] = ( uint8_t )( fade * le->color[0] );
+	le->ent.shaderRGBA[1] = ( uint8_t )( fade * le->color[1] );
+	le->ent.shaderRGBA[2] = ( uint8_t )( fade * le->color[2] );
+	return true;
+}
 
-	hnode = &cg_localents_headnode;
-	for( le = hnode->next; le != hnode; le = next ) {
-		next = le->next;
+/*
+* CG_LE_AlphaFade
+*/
+static bool CG_LE_AlphaFade( lentity_t *le, const leframe_t *lf ) {
+	float fade = fminf( lf->fade, lf->fadeIn );
 
-		frac = ( cg.time - le->start ) * 0.01f;
-		f = ( int )floor( frac );
-		clamp_low( f, 0 );
+	le->ent.shaderRGBA[3] = ( uint8_t )( fade * le->color[3] );
+	return true;
+}
 
-		// it's time to DIE
-		if( f >= le->frames - 1 ) {
-			le->type = LE_FREE;
-			CG_FreeLocalEntity( le );
-			continue;
-		}
+/*
+* CG_LE_ScaleAlphaFade
+*/
+static bool CG_LE_ScaleAlphaFade( lentity_t *le, const leframe_t *lf ) {
+	entity_t *ent = &le->ent;
+	float fade = fminf( lf->fade, lf->fadeIn );
+
+	ent->scale = 1.0f + 1.0f / lf->scale;
+	ent->scale = fminf( ent->scale, 5.0f );
+	ent->shaderRGBA[3] = ( uint8_t )( fade * le->color[3] );
+	return true;
+}
 
-		if( le->frames > 1 ) {
-			scale = 1.0f - frac / ( le->frames - 1 );
-			scale = Q_bound( 0.0f, scale, 1.0f );
-			fade = scale * 255.0f;
+/*
+* CG_LE_InverseScaleAlphaFade
+*/
+static bool CG_LE_InverseScaleAlphaFade( lentity_t *le, const leframe_t *lf ) {
+	entity_t *ent = &le->ent;
+	float fade = fminf( lf->fade, lf->fadeIn );
+
+	ent->scale = lf->scale + 0.1f;
+	Q_clamp( ent->scale, 0.1f, 1.0f );
+	ent->shaderRGBA[3] = ( uint8_t )( fade * le->color[3] );
+	return true;
+}
 
-			// quick fade in, if time enough
-			if( le->frames > FADEINFRAMES * 2 ) {
-				scaleIn = frac / (float)FADEINFRAMES;
-				Q_clamp( scaleIn, 0.0f, 1.0f );
-				fadeIn = scaleIn * 255.0f;
-			} else {
-				fadeIn = 255.0f;
-			}
-		} else {
-			scale = 1.0f;
-			fade = 255.0f;
-			fadeIn = 255.0f;
-		}
+/*
+* CG_LE_Laser
+*/
+static bool CG_LE_Laser( lentity_t *le, const leframe_t *lf ) {
+	entity_t *ent = &le->ent;
 
-		ent = &le->ent;
+	CG_QuickPolyBeam( ent->origin, ent->origin2, ent->radius, ent->customShader ); // wsw : jalfixme: missing the color (comes inside ent->skinnum)
+	return true;
+}
 
-		if( le->light && scale ) {
-			CG_AddLightToScene( ent->origin, le->light * scale, le->lightcolor[0], le->lightcolor[1], le->lightcolor[2] );
-		}
+/*
+* CG_LE_ExplosionTracer
+*/
+static bool CG_LE_ExplosionTracer( lentity_t *le, const leframe_t *lf ) {
+	entity_t *ent = &le->ent;
 
-		if( le->type == LE_LASER ) {
-			CG_QuickPolyBeam( ent->origin, ent->origin2, ent->radius, ent->customShader ); // wsw : jalfixme: missing the color (comes inside ent->skinnum)
-			continue;
+	if( cg.time - ent->rotation > 10.0f ) {
+		ent->rotation = cg.time;
+		if( ent->radius - 16 * lf->frac > 4 ) {
+			CG_Explosion_Puff( ent->origin, ent->radius - 16 * lf->frac, le->frames - lf->frame );
 		}
+	}
+	return true;
+}
 
-		if( le->type == LE_DASH_SCALE ) {
-			if( f < 1 ) {
-				ent->scale = 0.15 * frac;
-			} else {
-				VecToAngles( &ent->axis[AXIS_RIGHT], angles );
-				ent->axis[1 * 3 + 1] += 0.005f * sin( DEG2RAD( angles[YAW] ) ); //length
-				ent->axis[1 * 3 + 0] += 0.005f * cos( DEG2RAD( angles[YAW] ) ); //length
-				ent->axis[0 * 3 + 1] += 0.008f * cos( DEG2RAD( angles[YAW] ) ); //width
-				ent->axis[0 * 3 + 0] -= 0.008f * sin( DEG2RAD( angles[YAW] ) ); //width
-				ent->axis[2 * 3 + 2] -= 0.052f;              //height
-
-				if( ent->axis[AXIS_UP + 2] <= 0 ) {
-					le->type = LE_FREE;
-					CG_FreeLocalEntity( le );
-				}
-			}
-		}
-		if( le->type == LE_PUFF_SCALE ) {
-			if( le->frames - f < 4 ) {
-				ent->scale = 1.0f - 1.0f * ( frac - abs( 4 - le->frames ) ) / 4;
-			}
-		}
-		if( le->type == LE_PUFF_SHRINK ) {
-			if( frac < 3 ) {
-				ent->scale = 1.0f - 0.2f * frac / 4;
-			} else {
-				ent->scale = 0.8 - 0.8 * ( frac - 3 ) / 3;
-				VectorScale( le->velocity, 0.85f, le->velocity );
-			}
-		}
+/*
+* CG_LE_DashScale
+*/
+static bool CG_LE_DashScale( lentity_t *le, const leframe_t *lf ) {
+	entity_t *ent = &le->ent;
+	vec3_t angles;
 
-		if( le->type == LE_EXPLOSION_TRACER ) {
-			if( cg.time - ent->rotation > 10.0f ) {
-				ent->rotation = cg.time;
-				if( ent->radius - 16 * frac > 4 ) {
-					CG_Explosion_Puff( ent->origin, ent->radius - 16 * frac, le->frames - f );
-				}
-			}
-		}
+	if( lf->frame < 1 ) {
+		ent->scale = 0.15 * lf->frac;
+		return true;
+	}
 
-		switch( le->type ) {
-			case LE_NO_FADE:
-				break;
-			case LE_RGB_FADE:
-				fade = fminf( fade, fadeIn );
-				ent->shaderRGBA[0] = ( uint8_t )( fade * le->color[0] );
-				ent->shaderRGBA[1] = ( uint8_t )( fade * le->color[1] );
-				ent->shaderRGBA[2] = ( uint8_t )( fade * le->color[2] );
-				break;
-			case LE_SCALE_ALPHA_FADE:
-				fade = fminf( fade, fadeIn );
-				ent->scale = 1.0f + 1.0f / scale;
-				ent->scale = fminf( ent->scale, 5.0f );
-				ent->shaderRGBA[3] = ( uint8_t )( fade * le->color[3] );
-				break;
-			case LE_INVERSESCALE_ALPHA_FADE:
-				fade = fminf( fade, fadeIn );
-				ent->scale = scale + 0.1f;
-				Q_clamp( ent->scale, 0.1f, 1.0f );
-				ent->shaderRGBA[3] = ( uint8_t )( fade * le->color[3] );
-				break;
-			case LE_ALPHA_FADE:
-				fade = fminf( fade, fadeIn );
-				ent->shaderRGBA[3] = ( uint8_t )( fade * le->color[3] );
-				break;
-			default:
-				break;
-		}
+	VecToAngles( &ent->axis[AXIS_RIGHT], angles );
+	ent->axis[1 * 3 + 1] += 0.005f * sin( DEG2RAD( angles[YAW] ) ); //length
+	ent->axis[1 * 3 + 0] += 0.005f * cos( DEG2RAD( angles[YAW] ) ); //length
+	ent->axis[0 * 3 + 1] += 0.008f * cos( DEG2RAD( angles[YAW] ) ); //width
+	ent->axis[0 * 3 + 0] -= 0.008f * sin( DEG2RAD( angles[YAW] ) ); //width
+	ent->axis[2 * 3 + 2] -= 0.052f;              //height
 
-		ent->backlerp = backlerp;
+	return ent->axis[AXIS_UP + 2] > 0;
+}
 
-		if( le->avelocity[0] || le->avelocity[1] || le->avelocity[2] ) {
-			VectorMA( le->angles, time, le->avelocity, le->angles );
-			AnglesToAxis( le->angles, le->ent.axis );
+/*
+* CG_LE_PuffScale
+*/
+static bool CG_LE_PuffScale( lentity_t *le, const leframe_t *lf ) {
+	if( le->frames - lf->frame < 4 ) {
+		le->ent.scale = 1.0f - 1.0f * ( lf->frac - abs( 4 - le->frames ) ) / 4;
+	}
+	return true;
+}
+
+/*
+* CG_LE_PuffShrink
+*/
+static bool CG_LE_PuffShrink( lentity_t *le, const leframe_t *lf ) {
+	if( lf->frac < 3 ) {
+		le->ent.scale = 1.0f - 0.2f * lf->frac / 4;
+	} else {
+		le->ent.scale = 0.8 - 0.8 * ( lf->frac - 3 ) / 3;
+		VectorScale( le->velocity, 0.85f, le->velocity );
+	}
+	return true;
+}
+
+/*
+* CG_LocalEntityFrame
+*
+* Returns false when the local entity has run out of frames
+*/
+static bool CG_LocalEntityFrame( const lentity_t *le, leframe_t *lf ) {
+#define FADEINFRAMES 2
+	float scaleIn;
+
+	lf->frac = ( cg.time - le->start ) * 0.01f;
+	lf->frame = ( int )floor( lf->frac );
+	clamp_low( lf->frame, 0 );
+
+	// it's time to DIE
+	if( lf->frame >= le->frames - 1 ) {
+		return false;
+	}
+
+	if( le->frames > 1 ) {
+		lf->scale = 1.0f - lf->frac / ( le->frames - 1 );
+		lf->scale = Q_bound( 0.0f, lf->scale, 1.0f );
+		lf->fade = lf->scale * 255.0f;
+
+		// quick fade in, if time enough
+		if( le->frames > FADEINFRAMES * 2 ) {
+			scaleIn = lf->frac / (float)FADEINFRAMES;
+			Q_clamp( scaleIn, 0.0f, 1.0f );
+			lf->fadeIn = scaleIn * 255.0f;
+		} else {
+			lf->fadeIn = 255.0f;
 		}
+	} else {
+		lf->scale = 1.0f;
+		lf->fade = 255.0f;
+		lf->fadeIn = 255.0f;
+	}
 
-		// apply rotational friction
-		if( le->bounce ) { // FIXME?
-			int i;
-			const float adj = 100 * 6 * time; // magic constants here
+	return true;
+}
 
-			for( i = 0; i < 3; i++ ) {
+/*
+* CG_MoveLocalEntity
+*
+* Returns false when the local entity should be removed
+*/
+static bool CG_MoveLocalEntity( lentity_t *le, float time ) {
+	entity_t *ent = &le->ent;
+
+	if( le->avelocity[0] || le->avelocity[1] || le->avelocity[2] ) {
+		VectorMA( le->angles, time, le->avelocity, le->angles );
+		AnglesToAxis( le->angles, le->ent.axis );
+	}
+
+	// apply rotational friction
+	if( le->bounce ) { // FIXME?
+		int i;
+		const float adj = 100 * 6 * time; // magic constants here
+
+		for( i = 0; i < 3; i++ ) {
+			if( le->avelocity[i] > 0.0f ) {
+				le->avelocity[i] -= adj;
+				if( le->avelocity[i] < 0.0f ) {
+					le->avelocity[i] = 0.0f;
+				}
+			} else if( le->avelocity[i] < 0.0f ) {
+				le->avelocity[i] += adj;
 				if( le->avelocity[i] > 0.0f ) {
-					le->avelocity[i] -= adj;
-					if( le->avelocity[i] < 0.0f ) {
-						le->avelocity[i] = 0.0f;
-					}
-				} else if( le->avelocity[i] < 0.0f ) {
-					le->avelocity[i] += adj;
-					if( le->avelocity[i] > 0.0f ) {
-						le->avelocity[i] = 0.0f;
-					}
+					le->avelocity[i] = 0.0f;
 				}
 			}
 		}
+	}
 
-		if( le->bounce ) {
-			trace_t trace;
-			vec3_t next_origin;
+	if( le->bounce ) {
+		trace_t trace;
+		vec3_t next_origin;
 
-			VectorMA( ent->origin, time, le->velocity, next_origin );
+		VectorMA( ent->origin, time, le->velocity, next_origin );
 
-			CG_Trace( &trace, ent->origin, debris_mins, debris_maxs, next_origin, 0, MASK_SOLID );
+		CG_Trace( &trace, ent->origin, debris_mins, debris_maxs, next_origin, 0, MASK_SOLID );
 
-			// remove the particle when going out of the map
-			if( ( trace.contents & CONTENTS_NODROP ) || ( trace.surfFlags & SURF_SKY ) ) {
-				le->frames = 0;
-			} else if( trace.fraction != 1.0 ) {   // found solid
-				float dot;
-				float xyzspeed, orig_xyzspeed;
-				float bounce;
+		// remove the particle when going out of the map
+		if( ( trace.contents & CONTENTS_NODROP ) || ( trace.surfFlags & SURF_SKY ) ) {
+			le->frames = 0;
+		} else if( trace.fraction != 1.0 ) {   // found solid
+			float dot;
+			float xyzspeed, orig_xyzspeed;
+			float bounce;
 
-				orig_xyzspeed = VectorLength( le->velocity );
+			orig_xyzspeed = VectorLength( le->velocity );
 
-				// Reflect velocity
-				dot = DotProduct( le->velocity, trace.plane.normal );
-				VectorMA( le->velocity, -2.0f * dot, trace.plane.normal, le->velocity );
+			// Reflect velocity
+			dot = DotProduct( le->velocity, trace.plane.normal );
+			VectorMA( le->velocity, -2.0f * dot, trace.plane.normal, le->velocity );
 
-				//put new origin in the impact point, but move it out a bit along the normal
-				VectorMA( trace.endpos, 1, trace.plane.normal, ent->origin );
+			//put new origin in the impact point, but move it out a bit along the normal
+			VectorMA( trace.endpos, 1, trace.plane.normal, ent->origin );
 
-				// make sure we don't gain speed from bouncing off
-				bounce = 2.0f * le->bounce * 0.01f;
-				if( bounce < 1.5f ) {
-					bounce = 1.5f;
-				}
-				xyzspeed = orig_xyzspeed / bounce;
-
-				VectorNormalize( le->velocity );
-				VectorScale( le->velocity, xyzspeed, le->velocity );
-
-				//the entity has not speed enough. Stop checks
-				if( xyzspeed * time < 1.0f ) {
-					trace_t traceground;
-					vec3_t ground_origin;
-
-					//see if we have ground
-					VectorCopy( ent->origin, ground_origin );
-					ground_origin[2] += ( debris_mins[2] - 4 );
-					CG_Trace( &traceground, ent->origin, debris_mins, debris_maxs, ground_origin, 0, MASK_SOLID );
-					if( traceground.fraction != 1.0 ) {
-						le->bounce = 0;
-						VectorClear( le->velocity );
-						VectorClear( le->accel );
-						VectorClear( le->avelocity );
-						if( le->type == LE_EXPLOSION_TRACER ) {
-							// blx
-							le->type = LE_FREE;
-							CG_FreeLocalEntity( le );
-						}
+			// make sure we don't gain speed from bouncing off
+			bounce = 2.0f * le->bounce * 0.01f;
+			if( bounce < 1.5f ) {
+				bounce = 1.5f;
+			}
+			xyzspeed = orig_xyzspeed / bounce;
+
+			VectorNormalize( le->velocity );
+			VectorScale( le->velocity, xyzspeed, le->velocity );
+
+			//the entity has not speed enough. Stop checks
+			if( xyzspeed * time < 1.0f ) {
+				trace_t traceground;
+				vec3_t ground_origin;
+
+				//see if we have ground
+				VectorCopy( ent->origin, ground_origin );
+				ground_origin[2] += ( debris_mins[2] - 4 );
+				CG_Trace( &traceground, ent->origin, debris_mins, debris_maxs, ground_origin, 0, MASK_SOLID );
+				if( traceground.fraction != 1.0 ) {
+					le->bounce = 0;
+					VectorClear( le->velocity );
+					VectorClear( le->accel );
+					VectorClear( le->avelocity );
+					if( le->type == LE_EXPLOSION_TRACER ) {
+						// blx
+						return false;
 					}
 				}
-
-			} else {
-				VectorCopy( ent->origin, ent->origin2 );
-				VectorCopy( next_origin, ent->origin );
 			}
+
 		} else {
 			VectorCopy( ent->origin, ent->origin2 );
-			VectorMA( ent->origin, time, le->velocity, ent->origin );
+			VectorCopy( next_origin, ent->origin );
 		}
+	} else {
+		VectorCopy( ent->origin, ent->origin2 );
+		VectorMA( ent->origin, time, le->velocity, ent->origin );
+	}
 
-		VectorCopy( ent->origin, ent->lightingOrigin );
-		VectorMA( le->velocity, time, le->accel, le->velocity );
+	VectorCopy( ent->origin, ent->lightingOrigin );
+	VectorMA( le->velocity, time, le->accel, le->velocity );
 
-		CG_AddEntityToScene( ent );
+	return true;
+}
+
+/*
+* CG_AddLocalEntities
+*/
+void CG_AddLocalEntities( void ) {
+	int type;
+	float time, backlerp;
+	leframe_t lf;
+	lentity_t *le;
+	cg_poolnode_t *node, *next, *hnode;
+	const letypeinfo_t *info;
+
+	time = (float)cg.frameTime * 0.001f;
+	backlerp = 1.0f - cg.lerpfrac;
+
+	// run each type in its own loop, new local entities spawned meanwhile wait for the next frame
+	for( type = LE_FREE + 1; type < LE_NUM_TYPES; type++ ) {
+		info = &cg_letypes[type];
+
+		hnode = &cg_localents[type].active;
+		for( node = hnode->next; node != hnode; node = next ) {
+			next = node->next;
+			le = ( lentity_t * )node;
+
+			if( !CG_LocalEntityFrame( le, &lf ) ) {
+				CG_FreeLocalEntity( le );
+				continue;
+			}
+
+			if( le->light && lf.scale ) {
+				CG_AddLightToScene( le->ent.origin, le->light * lf.scale, le->lightcolor[0], le->lightcolor[1], le->lightcolor[2] );
+			}
+
+			if( info->think && !info->think( le, &lf ) ) {
+				CG_FreeLocalEntity( le );
+				continue;
+			}
+
+			if( !info->entity ) {
+				continue;
+			}
+
+			le->ent.backlerp = backlerp;
+
+			if( !CG_MoveLocalEntity( le, time ) ) {
+				CG_FreeLocalEntity( le );
+				continue;
+			}
+
+			CG_AddEntityToScene( &le->ent );
+		}
 	}
 }
 
@@ -1721,15 +1835,9 @@ void CG_AddLocalEntities( void ) {
 * CG_FreeLocalEntities
 */
 void CG_FreeLocalEntities( void ) {
-	lentity_t *le, *next, *hnode;
-
-	hnode = &cg_localents_headnode;
-	for( le = hnode->next; le != hnode; le = next ) {
-		next = le->next;
+	int i;
 
-		le->type = LE_FREE;
-		CG_FreeLocalEntity( le );
+	for( i = LE_FREE + 1; i < LE_NUM_TYPES; i++ ) {
+		CG_FreePool( &cg_localents[i] );
 	}
-
-	CG_ClearLocalEntities();
 }
@@ -77,6 +77,9 @@ typedef struct {
 
 	entity_t ent;                   // interpolated, to be added to render list
 	unsigned int type;
+	bool lerpAxisValid;
+	vec3_t lerpAxisAngles;          // angles the cached axis was built from
+	mat3_t lerpAxis;
 	unsigned int renderfx;
 	unsigned int effects;
 	struct cgs_skeleton_s *skel;
@@ -646,7 +649,7 @@ typedef struct {
 	int award_head;
 
 	// statusbar program
-	struct cg_layoutnode_s *statusBar;
+	struct cg_layoutprogram_s *statusBar;
 
 	cg_viewweapon_t weapon;
 	cg_viewdef_t view;
@@ -848,7 +851,7 @@ extern cvar_t *cg_touch_zoomTime;
 void CG_SC_ResetObituaries( void );
 void CG_SC_Obituary( void );
 void Cmd_CG_PrintHudHelp_f( void );
-void CG_ExecuteLayoutProgram( struct cg_layoutnode_s *rootnode, bool touch );
+void CG_ExecuteLayoutProgram( struct cg_layoutprogram_s *program, bool touch );
 void CG_GetHUDTouchButtons( int *buttons, int *upmove );
 void CG_UpdateHUDPostDraw( void );
 void CG_UpdateHUDPostTouch( void );
@@ -1052,6 +1055,38 @@ void CG_AddKickAngles( vec3_t viewangles );
 bool CG_ChaseStep( int step );
 bool CG_SwitchChaseCamMode( void );
 
+//
+// cg_pool.cpp
+//
+
+// pooled objects must start with this
+typedef struct cg_poolnode_s {
+	struct cg_poolnode_s *prev, *next;
+} cg_poolnode_t;
+
+typedef struct cg_pool_s {
+	const char *name;
+	size_t objectSize;
+	int budget;                     // the maximum number of objects
+	void ( *release )( void *object );
+
+	cg_poolnode_t active;           // most recently allocated first
+	cg_poolnode_t *free;
+	struct cg_poolslab_s *slabs;
+
+	int numActive, peakActive, numAllocated;
+	unsigned numDropped;            // allocations past the budget
+
+	struct cg_pool_s *nextPool;
+} cg_pool_t;
+
+void CG_InitPool( cg_pool_t *pool, const char *name, size_t objectSize, int budget, void ( *release )( void *object ) );
+void *CG_PoolAlloc( cg_pool_t *pool, bool steal );
+void CG_PoolFree( cg_pool_t *pool, void *object );
+void CG_ClearPool( cg_pool_t *pool );
+void CG_FreePool( cg_pool_t *pool );
+void CG_PoolStats_f( void );
+
 //
 // cg_lents.c
 //
@@ -1101,7 +1136,19 @@ void CG_ExplosionsDust( const vec3_t pos, const vec3_t dir, float radius );
 //
 extern cvar_t *cg_addDecals;
 
+#define MAX_DECAL_CACHE_VERTS       128
+#define MAX_DECAL_CACHE_FRAGMENTS   64
+
+typedef struct {
+	int numverts, numfragments;
+	vec4_t verts[MAX_DECAL_CACHE_VERTS];
+	fragment_t fragments[MAX_DECAL_CACHE_FRAGMENTS];
+} cg_decalfragments_t;
+
+const cg_decalfragments_t *CG_GetDecalFragments( const vec3_t origin, const vec3_t dir, float orient, float radius,
+												 vec3_t placedOrigin, vec3_t placedAxis[3], float *placedRadius );
 void CG_ClearDecals( void );
+void CG_FreeDecals( void );
 int CG_SpawnDecal( const vec3_t origin, const vec3_t dir, float orient, float radius,
 				   float r, float g, float b, float a, float die, float fadetime, bool fadealpha, struct shader_s *shader );
 void CG_AddDecals( void );
@@ -1118,6 +1165,7 @@ extern cvar_t *cg_instabeam_alpha;
 extern cvar_t *cg_instabeam_time;
 
 void CG_ClearPolys( void );
+void CG_FreePolys( void );
 void CG_AddPolys( void );
 void CG_KillPolyBeamsByTag( int key );
 void CG_QuickPolyBeam( const vec3_t start, const vec3_t end, int width, struct shader_s *shader );
@@ -1132,6 +1180,7 @@ void CG_PLink( const vec3_t start, const vec3_t end, const vec4_t color, int fla
 // cg_effects.c
 //
 void CG_ClearEffects( void );
+void CG_FreeParticles( void );
 
 void CG_AddLightToScene( vec3_t org, float radius, float r, float g, float b );
 void CG_AddDlights( void );
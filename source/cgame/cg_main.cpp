@@ -1222,6 +1222,9 @@ void CG_Init( const char *serverName, unsigned int playerNum,
 */
 void CG_Shutdown( void ) {
 	CG_FreeLocalEntities();
+	CG_FreeDecals();
+	CG_FreePolys();
+	CG_FreeParticles();
 	CG_DemocamShutdown();
 	CG_ScreenShutdown();
 	CG_UnregisterCGameCommands();
@@ -25,7 +25,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 typedef struct cpoly_s
 {
-	struct cpoly_s *prev, *next;
+	cg_poolnode_t node;
 
 	struct shader_s *shader;
 
@@ -37,43 +37,26 @@ typedef struct cpoly_s
 	int tag;
 	poly_t *poly;
 
+	poly_t drawpoly;
 	vec4_t verts[MAX_CGPOLY_VERTS];
+	vec2_t stcoords[MAX_CGPOLY_VERTS];
+	byte_vec4_t colors[MAX_CGPOLY_VERTS];
 } cpoly_t;
 
-static cpoly_t cg_polys[MAX_CGPOLYS];
-static cpoly_t cg_polys_headnode, *cg_free_polys;
-
-static poly_t cg_poly_polys[MAX_CGPOLYS];
-static vec4_t cg_poly_verts[MAX_CGPOLYS][MAX_CGPOLY_VERTS];
-static vec2_t cg_poly_stcoords[MAX_CGPOLYS][MAX_CGPOLY_VERTS];
-static byte_vec4_t cg_poly_colors[MAX_CGPOLYS][MAX_CGPOLY_VERTS];
+static cg_pool_t cg_polys;
 
 /*
 * CG_Clearpolys
 */
 void CG_ClearPolys( void ) {
-	int i, j;
-
-	memset( cg_polys, 0, sizeof( cg_polys ) );
-
-	// link polys
-	cg_free_polys = cg_polys;
-	cg_polys_headnode.prev = &cg_polys_headnode;
-	cg_polys_headnode.next = &cg_polys_headnode;
-
-	for( i = 0; i < MAX_CGPOLYS; i++ ) {
-		if( i < MAX_CGPOLYS - 1 ) {
-			cg_polys[i].next = &cg_polys[i + 1];
-		}
-		cg_polys[i].poly = &cg_poly_polys[i];
-		cg_polys[i].poly->verts = cg_poly_verts[i];
-		cg_polys[i].poly->stcoords = cg_poly_stcoords[i];
-		cg_polys[i].poly->colors = cg_poly_colors[i];
+	CG_InitPool( &cg_polys, "polys", sizeof( cpoly_t ), MAX_CGPOLYS, NULL );
+}
 
-		for( j = 0; j < MAX_CGPOLY_VERTS; j++ ) {
-			cg_polys[i].poly->verts[j][3] = 1;
-		}
-	}
+/*
+* CG_FreePolys
+*/
+void CG_FreePolys( void ) {
+	CG_FreePool( &cg_polys );
 }
 
 /*
@@ -82,24 +65,20 @@ void CG_ClearPolys( void ) {
 * Returns either a free poly or the oldest one
 */
 static cpoly_t *CG_AllocPoly( void ) {
+	int i;
 	cpoly_t *pl;
 
-	// take a free poly if possible
-	if( cg_free_polys ) {
-		pl = cg_free_polys;
-		cg_free_polys = pl->next;
-	} else {
-		// grab the oldest one otherwise
-		pl = cg_polys_headnode.prev;
-		pl->prev->next = pl->next;
-		pl->next->prev = pl->prev;
-	}
+	pl = ( cpoly_t * )CG_PoolAlloc( &cg_polys, true );
 
-	// put the poly at the start of the list
-	pl->prev = &cg_polys_headnode;
-	pl->next = cg_polys_headnode.next;
-	pl->next->prev = pl;
-	pl->prev->next = pl;
+	memset( &pl->drawpoly, 0, sizeof( pl->drawpoly ) );
+	pl->poly = &pl->drawpoly;
+	pl->poly->verts = pl->verts;
+	pl->poly->stcoords = pl->stcoords;
+	pl->poly->colors = pl->colors;
+
+	for( i = 0; i < MAX_CGPOLY_VERTS; i++ ) {
+		pl->verts[i][3] = 1;
+	}
 
 	return pl;
 }
@@ -108,13 +87,7 @@ static cpoly_t *CG_AllocPoly( void ) {
 * CG_FreePoly
 */
 static void CG_FreePoly( cpoly_t *dl ) {
-	// remove from linked active list
-	dl->prev->next = dl->next;
-	dl->next->prev = dl->prev;
-
-	// insert into linked free list
-	dl->next = cg_free_polys;
-	cg_free_polys = dl;
+	CG_PoolFree( &cg_polys, dl );
 }
 
 /*
@@ -244,12 +217,14 @@ static cpoly_t *CG_SpawnPolyBeam( const vec3_t start, const vec3_t end, const ve
 * CG_KillPolyBeamsByTag
 */
 void CG_KillPolyBeamsByTag( int tag ) {
-	cpoly_t *cgpoly, *next, *hnode;
+	cpoly_t *cgpoly;
+	cg_poolnode_t *node, *next, *hnode;
 
 	// kill polys that have this tag
-	hnode = &cg_polys_headnode;
-	for( cgpoly = hnode->prev; cgpoly != hnode; cgpoly = next ) {
-		next = cgpoly->prev;
+	hnode = &cg_polys.active;
+	for( node = hnode->prev; node != hnode; node = next ) {
+		next = node->prev;
+		cgpoly = ( cpoly_t * )node;
 		if( cgpoly->tag == tag ) {
 			CG_FreePoly( cgpoly );
 		}
@@ -480,13 +455,15 @@ void CG_PLink( const vec3_t start, const vec3_t end, const vec4_t color, int fla
 void CG_AddPolys( void ) {
 	int i;
 	float fade;
-	cpoly_t *cgpoly, *next, *hnode;
+	cpoly_t *cgpoly;
+	cg_poolnode_t *node, *next, *hnode;
 	poly_t *poly;
 
 	// add polys in first-spawned - first-drawn order
-	hnode = &cg_polys_headnode;
-	for( cgpoly = hnode->prev; cgpoly != hnode; cgpoly = next ) {
-		next = cgpoly->prev;
+	hnode = &cg_polys.active;
+	for( node = hnode->prev; node != hnode; node = next ) {
+		next = node->prev;
+		cgpoly = ( cpoly_t * )node;
 
 		// it's time to die
 		if( cgpoly->die <= cg.time ) {
@@ -0,0 +1,209 @@
+/*
+Copyright (C) 2018 Warsow development team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+// cg_pool.cpp -- slab allocator for short-lived effect objects
+
+#include "cg_local.h"
+
+#define POOL_MIN_SLAB_OBJECTS   32
+#define POOL_ALIGNMENT          16
+
+typedef struct cg_poolslab_s {
+	struct cg_poolslab_s *next;
+} cg_poolslab_t;
+
+static cg_pool_t *cg_pools;
+
+/*
+* CG_InitPool
+*
+* Sets up the pool on first use, releases all objects otherwise. Memory
+* is only allocated as objects are needed, up to the budget.
+*/
+void CG_InitPool( cg_pool_t *pool, const char *name, size_t objectSize, int budget, void ( *release )( void *object ) ) {
+	if( pool->objectSize ) {
+		CG_ClearPool( pool );
+		pool->budget = budget;
+		return;
+	}
+
+	memset( pool, 0, sizeof( *pool ) );
+	pool->name = name;
+	pool->objectSize = ( objectSize + POOL_ALIGNMENT - 1 ) & ~( POOL_ALIGNMENT - 1 );
+	pool->budget = budget;
+	pool->release = release;
+	pool->active.prev = pool->active.next = &pool->active;
+
+	pool->nextPool = cg_pools;
+	cg_pools = pool;
+}
+
+/*
+* CG_GrowPool
+*/
+static bool CG_GrowPool( cg_pool_t *pool ) {
+	int i, count;
+	size_t headerSize;
+	uint8_t *mem;
+	cg_poolslab_t *slab;
+	cg_poolnode_t *node;
+
+	// double the capacity with each slab
+	count = pool->numAllocated > POOL_MIN_SLAB_OBJECTS ? pool->numAllocated : POOL_MIN_SLAB_OBJECTS;
+	if( count > pool->budget - pool->numAllocated ) {
+		count = pool->budget - pool->numAllocated;
+	}
+	if( count <= 0 ) {
+		return false;
+	}
+
+	headerSize = ( sizeof( cg_poolslab_t ) + POOL_ALIGNMENT - 1 ) & ~( POOL_ALIGNMENT - 1 );
+	mem = ( uint8_t * )CG_Malloc( headerSize + pool->objectSize * count );
+
+	slab = ( cg_poolslab_t * )mem;
+	slab->next = pool->slabs;
+	pool->slabs = slab;
+
+	for( i = count - 1, mem += headerSize; i >= 0; i-- ) {
+		node = ( cg_poolnode_t * )( mem + pool->objectSize * i );
+		node->next = pool->free;
+		pool->free = node;
+	}
+
+	pool->numAllocated += count;
+	return true;
+}
+
+/*
+* CG_UnlinkPoolNode
+*/
+static inline void CG_UnlinkPoolNode( cg_poolnode_t *node ) {
+	node->prev->next = node->next;
+	node->next->prev = node->prev;
+}
+
+/*
+* CG_PoolAlloc
+*
+* Returns an uninitialized object at the start of the active list. When the
+* budget is used up, the oldest object is recycled and counted as dropped,
+* unless steal is false, in which case NULL is returned.
+*/
+void *CG_PoolAlloc( cg_pool_t *pool, bool steal ) {
+	cg_poolnode_t *node;
+
+	if( !pool->free ) {
+		CG_GrowPool( pool );
+	}
+
+	if( pool->free ) {
+		node = pool->free;
+		pool->free = node->next;
+		pool->numActive++;
+		if( pool->numActive > pool->peakActive ) {
+			pool->peakActive = pool->numActive;
+		}
+	} else {
+		pool->numDropped++;
+		if( !steal || pool->active.prev == &pool->active ) {
+			return NULL;
+		}
+
+		node = pool->active.prev;
+		CG_UnlinkPoolNode( node );
+		if( pool->release ) {
+			pool->release( node );
+		}
+	}
+
+	node->prev = &pool->active;
+	node->next = pool->active.next;
+	node->next->prev = node;
+	node->prev->next = node;
+
+	return node;
+}
+
+/*
+* CG_PoolFree
+*/
+void CG_PoolFree( cg_pool_t *pool, void *object ) {
+	cg_poolnode_t *node = ( cg_poolnode_t * )object;
+
+	if( pool->release ) {
+		pool->release( object );
+	}
+
+	CG_UnlinkPoolNode( node );
+
+	node->next = pool->free;
+	pool->free = node;
+	pool->numActive--;
+}
+
+/*
+* CG_ClearPool
+*/
+void CG_ClearPool( cg_pool_t *pool ) {
+	while( pool->active.next != &pool->active ) {
+		CG_PoolFree( pool, pool->active.next );
+	}
+}
+
+/*
+* CG_FreePool
+*/
+void CG_FreePool( cg_pool_t *pool ) {
+	cg_pool_t **prev;
+	cg_poolslab_t *slab, *next;
+
+	if( !pool->objectSize ) {
+		return;
+	}
+
+	CG_ClearPool( pool );
+
+	for( slab = pool->slabs; slab; slab = next ) {
+		next = slab->next;
+		CG_Free( slab );
+	}
+
+	for( prev = &cg_pools; *prev; prev = &( *prev )->nextPool ) {
+		if( *prev == pool ) {
+			*prev = pool->nextPool;
+			break;
+		}
+	}
+
+	memset( pool, 0, sizeof( *pool ) );
+}
+
+/*
+* CG_PoolStats_f
+*/
+void CG_PoolStats_f( void ) {
+	cg_pool_t *pool;
+
+	Com_Printf( "%-20s %7s %7s %7s %7s %9s\n", "pool", "active", "peak", "slots", "budget", "dropped" );
+	for( pool = cg_pools; pool; pool = pool->nextPool ) {
+		Com_Printf( "%-20s %7i %7i %7i %7i %9u\n", pool->name, pool->numActive, pool->peakActive,
+					pool->numAllocated, pool->budget, pool->numDropped );
+	}
+}
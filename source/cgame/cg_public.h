@@ -43,7 +43,7 @@ typedef void ( *cg_fdrawchar_t )( int x, int y, int w, int h, float s1, float t1
 
 // cg_public.h -- client game dll information visible to engine
 
-#define CGAME_API_VERSION   104
+#define CGAME_API_VERSION   105
 
 //
 // structs and variables shared with the main engine
@@ -138,6 +138,7 @@ typedef struct {
 
 	void ( *GetConfigString )( int i, char *str, int size );
 	int64_t ( *Milliseconds )( void );
+	uint64_t ( *Microseconds )( void );
 	bool ( *DownloadRequest )( const char *filename, bool requestpak );
 
 	unsigned int ( * Hash_BlockChecksum )( const uint8_t * data, size_t len );
@@ -190,6 +191,7 @@ typedef struct {
 	int ( *R_SkeletalGetNumBones )( const struct model_s *mod, int *numFrames );
 	int ( *R_SkeletalGetBoneInfo )( const struct model_s *mod, int bone, char *name, size_t name_size, int *flags );
 	void ( *R_SkeletalGetBonePose )( const struct model_s *mod, int bone, int frame, struct bonepose_s *bonepose );
+	int ( *R_GetFogNumForSphere )( const vec3_t centre, float radius );
 	struct shader_s *( *R_GetShaderForOrigin )( const vec3_t origin );
 	struct cinematics_s *( *R_GetShaderCinematic )( struct shader_s *shader );
 
@@ -205,6 +207,7 @@ typedef struct {
 	void ( *CM_RoundUpToHullSize )( vec3_t mins, vec3_t maxs, struct cmodel_s *cmodel );
 	void ( *CM_InlineModelBounds )( struct cmodel_s *cmodel, vec3_t mins, vec3_t maxs );
 	bool ( *CM_InPVS )( const vec3_t p1, const vec3_t p2 );
+	bool ( *CM_BoxInPVS )( const vec3_t p, const vec3_t mins, const vec3_t maxs );
 
 	// sound system
 	struct sfx_s *( *S_RegisterSound )( const char *name );
@@ -255,6 +258,22 @@ typedef struct {
 	void *( *Mem_Alloc )( size_t size, const char *filename, int fileline );
 	void ( *Mem_Free )( void *data, const char *filename, int fileline );
 
+	// multithreading
+	struct qthread_s *( *Thread_Create )( void *( *routine )( void* ), void *param );
+	void ( *Thread_Join )( struct qthread_s *thread );
+	struct qmutex_s *( *Mutex_Create )( void );
+	void ( *Mutex_Destroy )( struct qmutex_s **mutex );
+	void ( *Mutex_Lock )( struct qmutex_s *mutex );
+	void ( *Mutex_Unlock )( struct qmutex_s *mutex );
+
+	struct qbufPipe_s *( *BufPipe_Create )( size_t bufSize, int flags );
+	void ( *BufPipe_Destroy )( struct qbufPipe_s **pqueue );
+	void ( *BufPipe_Finish )( struct qbufPipe_s *queue );
+	void ( *BufPipe_WriteCmd )( struct qbufPipe_s *queue, const void *cmd, unsigned cmd_size );
+	int ( *BufPipe_ReadCmds )( struct qbufPipe_s *queue, unsigned( **cmdHandlers )( const void * ) );
+	void ( *BufPipe_Wait )( struct qbufPipe_s *queue, int ( *read )( struct qbufPipe_s *, unsigned( ** )( const void * ), bool ),
+							unsigned( **cmdHandlers )( const void * ), unsigned timeout_msec );
+
 	// l10n
 	void ( *L10n_ClearDomain )( void );
 	void ( *L10n_LoadLangPOFile )( const char *filepath );
@@ -59,6 +59,7 @@ cvar_t *cg_crosshair_damage_color;
 cvar_t *cg_clientHUD;
 cvar_t *cg_specHUD;
 cvar_t *cg_debugHUD;
+cvar_t *cg_showHUDTime;
 cvar_t *cg_showSpeed;
 cvar_t *cg_showPickup;
 cvar_t *cg_showTimer;
@@ -289,6 +290,7 @@ void CG_ScreenInit( void ) {
 
 	// wsw : hud debug prints
 	cg_debugHUD =           trap_Cvar_Get( "cg_debugHUD", "0", 0 );
+	cg_showHUDTime =        trap_Cvar_Get( "cg_showHUDTime", "0", 0 );
 
 	//
 	// register our commands
@@ -1366,10 +1368,35 @@ static void CG_SCRDrawViewBlend( void ) {
 
 //=======================================================
 
+static uint64_t scr_hudTime;
+static int scr_hudTimeFrames;
+static int64_t scr_hudTimeUpdate;
+static float scr_hudTimeAverage;
+
+/*
+* CG_DrawHUDTime
+*
+* Shows the average time spent executing the HUD program, both for drawing and touch.
+*/
+static void CG_DrawHUDTime( void ) {
+	scr_hudTimeFrames++;
+	if( cg.realTime >= scr_hudTimeUpdate ) {
+		scr_hudTimeAverage = (float)scr_hudTime / scr_hudTimeFrames * 0.001f;
+		scr_hudTime = 0;
+		scr_hudTimeFrames = 0;
+		scr_hudTimeUpdate = cg.realTime + 1000;
+	}
+
+	trap_SCR_DrawString( cgs.vidWidth, cgs.vidHeight / 2, ALIGN_RIGHT_BOTTOM,
+						 va( "HUD: %.3f ms", scr_hudTimeAverage ), cgs.fontSystemSmall, colorWhite );
+}
+
 /*
 * CG_DrawHUD
 */
 void CG_DrawHUD( bool touch ) {
+	uint64_t start;
+
 	if( !cg_showHUD->integer ) {
 		return;
 	}
@@ -1386,7 +1413,16 @@ void CG_DrawHUD( bool touch ) {
 		hud->modified = false;
 	}
 
+	start = trap_Microseconds();
+
 	CG_ExecuteLayoutProgram( cg.statusBar, touch );
+
+	if( cg_showHUDTime->integer ) {
+		scr_hudTime += trap_Microseconds() - start;
+		if( !touch ) {
+			CG_DrawHUDTime();
+		}
+	}
 }
 
 /*
@@ -20,6 +20,10 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 extern cgame_import_t CGAME_IMPORT;
 
+typedef struct qthread_s qthread_t;
+typedef struct qmutex_s qmutex_t;
+typedef struct qbufPipe_s qbufPipe_t;
+
 static inline void trap_Print( const char *msg ) {
 	CGAME_IMPORT.Print( msg );
 }
@@ -171,6 +175,10 @@ static inline int64_t trap_Milliseconds( void ) {
 	return CGAME_IMPORT.Milliseconds();
 }
 
+static inline uint64_t trap_Microseconds( void ) {
+	return CGAME_IMPORT.Microseconds();
+}
+
 static inline bool trap_DownloadRequest( const char *filename, bool requestpak ) {
 	return CGAME_IMPORT.DownloadRequest( filename, requestpak == true ? true : false ) == true;
 }
@@ -197,6 +205,10 @@ static inline int trap_R_GetClippedFragments( const vec3_t origin, float radius,
 											   maxfverts, fverts, maxfragments, fragments );
 }
 
+static inline int trap_R_GetFogNumForSphere( const vec3_t centre, float radius ) {
+	return CGAME_IMPORT.R_GetFogNumForSphere( centre, radius );
+}
+
 static inline struct shader_s *trap_R_GetShaderForOrigin( const vec3_t origin ) {
 	return CGAME_IMPORT.R_GetShaderForOrigin( origin );
 }
@@ -380,6 +392,10 @@ static inline bool trap_CM_InPVS( const vec3_t p1, const vec3_t p2 ) {
 	return CGAME_IMPORT.CM_InPVS( p1, p2 );
 }
 
+static inline bool trap_CM_BoxInPVS( const vec3_t p, const vec3_t mins, const vec3_t maxs ) {
+	return CGAME_IMPORT.CM_BoxInPVS( p, mins, maxs );
+}
+
 static inline struct sfx_s *trap_S_RegisterSound( const char *name ) {
 	return CGAME_IMPORT.S_RegisterSound( name );
 }
@@ -519,6 +535,55 @@ static inline void trap_MemFree( void *data, const char *filename, int fileline
 	CGAME_IMPORT.Mem_Free( data, filename, fileline );
 }
 
+static inline struct qthread_s *trap_Thread_Create( void *( *routine )( void* ), void *param ) {
+	return CGAME_IMPORT.Thread_Create( routine, param );
+}
+
+static inline void trap_Thread_Join( struct qthread_s *thread ) {
+	CGAME_IMPORT.Thread_Join( thread );
+}
+
+static inline struct qmutex_s *trap_Mutex_Create( void ) {
+	return CGAME_IMPORT.Mutex_Create();
+}
+
+static inline void trap_Mutex_Destroy( struct qmutex_s **mutex ) {
+	CGAME_IMPORT.Mutex_Destroy( mutex );
+}
+
+static inline void trap_Mutex_Lock( struct qmutex_s *mutex ) {
+	CGAME_IMPORT.Mutex_Lock( mutex );
+}
+
+static inline void trap_Mutex_Unlock( struct qmutex_s *mutex ) {
+	CGAME_IMPORT.Mutex_Unlock( mutex );
+}
+
+static inline qbufPipe_t *trap_BufPipe_Create( size_t bufSize, int flags ) {
+	return CGAME_IMPORT.BufPipe_Create( bufSize, flags );
+}
+
+static inline void trap_BufPipe_Destroy( qbufPipe_t **pqueue ) {
+	CGAME_IMPORT.BufPipe_Destroy( pqueue );
+}
+
+static inline void trap_BufPipe_Finish( qbufPipe_t *queue ) {
+	CGAME_IMPORT.BufPipe_Finish( queue );
+}
+
+static inline void trap_BufPipe_WriteCmd( qbufPipe_t *queue, const void *cmd, unsigned cmd_size ) {
+	CGAME_IMPORT.BufPipe_WriteCmd( queue, cmd, cmd_size );
+}
+
+static inline int trap_BufPipe_ReadCmds( qbufPipe_t *queue, unsigned( **cmdHandlers )( const void * ) ) {
+	return CGAME_IMPORT.BufPipe_ReadCmds( queue, cmdHandlers );
+}
+
+static inline void trap_BufPipe_Wait( qbufPipe_t *queue, int ( *read )( qbufPipe_t *, unsigned( ** )( const void * ), bool ),
+									  unsigned( **cmdHandlers )( const void * ), unsigned timeout_msec ) {
+	CGAME_IMPORT.BufPipe_Wait( queue, read, cmdHandlers, timeout_msec );
+}
+
 static inline void trap_AsyncStream_UrlEncode( const char *src, char *dst, size_t size ) {
 	CGAME_IMPORT.AsyncStream_UrlEncode( src, dst, size );
 }
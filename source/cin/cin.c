@@ -93,6 +93,527 @@ static const cin_type_t cin_types[] =
 	}
 };
 
+/*
+=======================================================================
+
+ASYNCHRONOUS DECODING
+
+The decoder runs on a worker thread, a few frames ahead of the clock
+reported by the caller. Finished frames are copied into a small ring
+of slots and decoded audio goes into a PCM ring, both of which are
+drained on the calling thread, so the raw samples listeners are never
+called from the worker. The caller always gets the newest finished
+frame that is due, older ones are dropped.
+
+=======================================================================
+*/
+
+#define CIN_ASYNC_FRAMES            4
+#define CIN_ASYNC_AUDIO_SIZE        0x40000     // must be a power of two
+#define CIN_ASYNC_POLL_MSEC         4
+
+enum {
+	CIN_SLOT_FREE,
+	CIN_SLOT_READY,
+	CIN_SLOT_SHOWN
+};
+
+typedef struct {
+	int state;
+	int64_t pts;                // msec since the start of the cinematic
+	int width, height;
+	cin_yuv_t yuv;
+	uint8_t *data;
+	size_t size;
+} cin_asyncslot_t;
+
+typedef struct cin_async_s {
+	qthread_t *thread;
+	qmutex_t *mutex;
+	qbufPipe_t *pipe;
+
+	bool hasOggAudio;
+	int64_t startTime;          // caller time of the first frame
+
+	// written by the caller
+	bool stop;
+	int64_t clock;
+	unsigned int listenersLength;
+
+	// written by the worker
+	bool eos;
+	bool looped;
+	unsigned int framesDecoded;
+	unsigned int framesDropped;
+
+	cin_asyncslot_t slots[CIN_ASYNC_FRAMES];
+	int writeSlot, readSlot, shownSlot;
+	int numReady;
+
+	uint8_t *audio;
+	size_t audioRead, audioWrite;
+	unsigned int s_rate;
+	unsigned short s_width, s_channels;
+	unsigned int audioDropped;
+} cin_async_t;
+
+enum {
+	CIN_ASYNC_CMD_STOP
+};
+
+typedef unsigned ( *queueCmdHandler_t )( const void * );
+
+/*
+* CIN_AsyncCmd_Stop
+*/
+static unsigned CIN_AsyncCmd_Stop( const void *pcmd ) {
+	return 0;
+}
+
+static queueCmdHandler_t cin_asyncCmdHandlers[] =
+{
+	( queueCmdHandler_t )CIN_AsyncCmd_Stop
+};
+
+/*
+* CIN_AsyncWakeup
+*
+* Called when the worker is woken up by a command or the poll timeout
+*/
+static int CIN_AsyncWakeup( qbufPipe_t *queue, unsigned( **cmdHandlers )( const void * ), bool timeout ) {
+	trap_BufPipe_ReadCmds( queue, cmdHandlers );
+	return -1;
+}
+
+/*
+* CIN_AsyncAudioMsec
+*/
+static unsigned int CIN_AsyncAudioMsec( const cin_async_t *async, size_t bytes ) {
+	unsigned int frameSize = async->s_width * async->s_channels;
+
+	if( !frameSize || !async->s_rate ) {
+		return 0;
+	}
+	return (uint64_t)( bytes / frameSize ) * 1000 / async->s_rate;
+}
+
+/*
+* CIN_AsyncWriteAudio
+*
+* Queues raw samples decoded by the worker, dropping them if the caller
+* doesn't keep up
+*/
+static void CIN_AsyncWriteAudio( cinematics_t *cin, unsigned int samples, unsigned int rate,
+								 unsigned short width, unsigned short channels, const uint8_t *data ) {
+	cin_async_t *async = cin->async;
+	size_t size = samples * width * channels;
+	size_t write, offset, len;
+
+	trap_Mutex_Lock( async->mutex );
+	if( async->audioWrite - async->audioRead + size > CIN_ASYNC_AUDIO_SIZE ) {
+		async->audioDropped += samples;
+		trap_Mutex_Unlock( async->mutex );
+		return;
+	}
+	write = async->audioWrite;
+	trap_Mutex_Unlock( async->mutex );
+
+	// the caller only reads up to audioWrite, so copy outside of the lock
+	while( size > 0 ) {
+		offset = write & ( CIN_ASYNC_AUDIO_SIZE - 1 );
+		len = CIN_ASYNC_AUDIO_SIZE - offset;
+		if( len > size ) {
+			len = size;
+		}
+		memcpy( async->audio + offset, data, len );
+		data += len;
+		write += len;
+		size -= len;
+	}
+
+	trap_Mutex_Lock( async->mutex );
+	async->s_rate = rate;
+	async->s_width = width;
+	async->s_channels = channels;
+	async->audioWrite = write;
+	trap_Mutex_Unlock( async->mutex );
+}
+
+/*
+* CIN_AsyncCopyFrame
+*
+* Copies the decoder output, which is only valid until the next decoder call, into the slot
+*/
+static void CIN_AsyncCopyFrame( cinematics_t *cin, cin_asyncslot_t *slot, const uint8_t *frame ) {
+	int i;
+	size_t size;
+	uint8_t *out;
+
+	if( cin->yuv ) {
+		const cin_yuv_t *cyuv = ( const cin_yuv_t * )frame;
+
+		size = 0;
+		for( i = 0; i < 3; i++ ) {
+			size += abs( cyuv->yuv[i].stride ) * cyuv->yuv[i].height;
+		}
+	} else {
+		size = cin->width * cin->height * 3;
+	}
+
+	if( slot->size < size ) {
+		if( slot->data ) {
+			CIN_Free( slot->data );
+		}
+		slot->data = CIN_Alloc( cin->mempool, size );
+		slot->size = size;
+	}
+
+	slot->width = cin->width;
+	slot->height = cin->height;
+
+	if( !cin->yuv ) {
+		memcpy( slot->data, frame, size );
+		return;
+	}
+
+	// keep the strides, negative ones flip the image
+	slot->yuv = *( const cin_yuv_t * )frame;
+	for( i = 0, out = slot->data; i < 3; i++ ) {
+		cin_img_plane_t *plane = &slot->yuv.yuv[i];
+		size_t planeSize = abs( plane->stride ) * plane->height;
+
+		if( plane->stride < 0 ) {
+			// data points at the first row, the last one is the lowest in memory
+			memcpy( out, plane->data + plane->stride * ( plane->height - 1 ), planeSize );
+			plane->data = out - plane->stride * ( plane->height - 1 );
+		} else {
+			memcpy( out, plane->data, planeSize );
+			plane->data = out;
+		}
+		out += planeSize;
+	}
+}
+
+/*
+* CIN_AsyncDecodeFrame
+*
+* Runs the decoder once if needed, returns false if the worker should wait
+*/
+static bool CIN_AsyncDecodeFrame( cinematics_t *cin ) {
+	cin_async_t *async = cin->async;
+	const cin_type_t *type = &cin_types[cin->type];
+	cin_asyncslot_t *slot;
+	uint8_t *frame;
+	bool redraw = false;
+	bool full, eos;
+
+	trap_Mutex_Lock( async->mutex );
+	slot = &async->slots[async->writeSlot];
+	full = slot->state != CIN_SLOT_FREE;
+	eos = async->eos;
+	cin->cur_time = async->clock;
+	cin->s_samples_length = async->listenersLength
+							+ CIN_AsyncAudioMsec( async, async->audioWrite - async->audioRead );
+	trap_Mutex_Unlock( async->mutex );
+
+	if( full || eos ) {
+		return false;
+	}
+	if( cin->cur_time < cin->start_time ) {
+		return false;
+	}
+	if( !type->need_next_frame( cin ) ) {
+		return false;
+	}
+
+	cin->haveAudio = false;
+	if( cin->yuv ) {
+		frame = ( uint8_t * )type->read_next_frame_yuv( cin, &redraw );
+	} else {
+		frame = type->read_next_frame( cin, &redraw );
+	}
+
+	if( !frame ) {
+		if( !( cin->flags & CIN_LOOP ) || async->looped ) {
+			trap_Mutex_Lock( async->mutex );
+			async->eos = true;
+			trap_Mutex_Unlock( async->mutex );
+			return false;
+		}
+
+		// try again from the beginning if looping
+		type->reset( cin );
+		cin->frame = 0;
+		cin->start_time = cin->cur_time;
+		async->looped = true;
+		return true;
+	}
+
+	async->looped = false;
+	if( !redraw ) {
+		return true;
+	}
+
+	CIN_AsyncCopyFrame( cin, slot, frame );
+	slot->pts = cin->start_time + (int64_t)( cin->frame * 1000 / cin->framerate );
+
+	trap_Mutex_Lock( async->mutex );
+	slot->state = CIN_SLOT_READY;
+	async->writeSlot = ( async->writeSlot + 1 ) % CIN_ASYNC_FRAMES;
+	async->numReady++;
+	async->framesDecoded++;
+	trap_Mutex_Unlock( async->mutex );
+
+	return true;
+}
+
+/*
+* CIN_AsyncProc
+*/
+static void *CIN_AsyncProc( void *param ) {
+	cinematics_t *cin = param;
+	cin_async_t *async = cin->async;
+	bool stop = false;
+
+	while( !stop ) {
+		if( !CIN_AsyncDecodeFrame( cin ) ) {
+			trap_BufPipe_Wait( async->pipe, CIN_AsyncWakeup, cin_asyncCmdHandlers, CIN_ASYNC_POLL_MSEC );
+		}
+
+		trap_Mutex_Lock( async->mutex );
+		stop = async->stop;
+		trap_Mutex_Unlock( async->mutex );
+	}
+
+	return NULL;
+}
+
+/*
+* CIN_StartAsync
+*
+* The caller and the worker use separate clocks from here on: the caller
+* time is converted to msec since startTime, which the decoder sees as cur_time.
+*/
+static void CIN_StartAsync( cinematics_t *cin, int64_t start_time ) {
+	int i;
+	cin_async_t *async = cin->async;
+
+	if( !async ) {
+		async = CIN_Alloc( cin->mempool, sizeof( *async ) );
+		memset( async, 0, sizeof( *async ) );
+		async->audio = CIN_Alloc( cin->mempool, CIN_ASYNC_AUDIO_SIZE );
+	}
+
+	async->hasOggAudio = cin_types[cin->type].has_ogg_audio( cin );
+	async->startTime = start_time;
+	async->stop = false;
+	async->clock = 0;
+	async->eos = false;
+	async->looped = false;
+	async->writeSlot = async->readSlot = 0;
+	async->shownSlot = -1;
+	async->numReady = 0;
+	async->audioRead = async->audioWrite = 0;
+	for( i = 0; i < CIN_ASYNC_FRAMES; i++ ) {
+		async->slots[i].state = CIN_SLOT_FREE;
+	}
+
+	cin->start_time = cin->cur_time = 0;
+
+	// keep a spare slot so the worker doesn't stall on a full ring
+	if( cin->framerate > 0 ) {
+		cin->lookahead_msec = ( CIN_ASYNC_FRAMES - 2 ) * 1000 / cin->framerate;
+	}
+
+	async->mutex = trap_Mutex_Create();
+	async->pipe = trap_BufPipe_Create( 0x100, 0 );
+	cin->async = async;
+	async->thread = trap_Thread_Create( CIN_AsyncProc, cin );
+}
+
+/*
+* CIN_StopAsync
+*
+* Waits for the worker to finish, the buffers are kept for a restart
+*/
+static void CIN_StopAsync( cinematics_t *cin ) {
+	int cmd = CIN_ASYNC_CMD_STOP;
+	cin_async_t *async = cin->async;
+
+	if( !async || !async->thread ) {
+		return;
+	}
+
+	trap_Mutex_Lock( async->mutex );
+	async->stop = true;
+	trap_Mutex_Unlock( async->mutex );
+
+	trap_BufPipe_WriteCmd( async->pipe, &cmd, sizeof( cmd ) );
+	trap_Thread_Join( async->thread );
+	async->thread = NULL;
+
+	trap_BufPipe_Destroy( &async->pipe );
+	trap_Mutex_Destroy( &async->mutex );
+
+	cin->lookahead_msec = 0;
+}
+
+/*
+* CIN_FreeAsync
+*/
+static void CIN_FreeAsync( cinematics_t *cin ) {
+	int i;
+	cin_async_t *async = cin->async;
+
+	if( !async ) {
+		return;
+	}
+
+	CIN_StopAsync( cin );
+
+	for( i = 0; i < CIN_ASYNC_FRAMES; i++ ) {
+		if( async->slots[i].data ) {
+			CIN_Free( async->slots[i].data );
+		}
+	}
+	CIN_Free( async->audio );
+	CIN_Free( async );
+
+	cin->async = NULL;
+}
+
+/*
+* CIN_AsyncNeedNextFrame
+*/
+static bool CIN_AsyncNeedNextFrame( cinematics_t *cin, int64_t curtime ) {
+	cin_async_t *async = cin->async;
+	unsigned int length;
+	bool need;
+
+	if( curtime < async->startTime ) {
+		return false;
+	}
+
+	length = CIN_GetRawSamplesLengthFromListeners( cin );
+
+	trap_Mutex_Lock( async->mutex );
+
+	async->clock = curtime - async->startTime;
+	async->listenersLength = length;
+
+	if( async->numReady > 0 ) {
+		need = async->slots[async->readSlot].pts <= async->clock;
+	} else {
+		// let the caller know we're done
+		need = async->eos;
+	}
+
+	if( async->shownSlot >= 0 && async->audioWrite != async->audioRead ) {
+		need = true;
+	}
+
+	trap_Mutex_Unlock( async->mutex );
+
+	return need;
+}
+
+/*
+* CIN_AsyncFlushAudio
+*
+* Passes all queued raw samples to the listeners, returns false if there were none
+*/
+static bool CIN_AsyncFlushAudio( cinematics_t *cin ) {
+	int i;
+	cin_async_t *async = cin->async;
+	size_t read, write, offset, len;
+	unsigned int frameSize;
+
+	trap_Mutex_Lock( async->mutex );
+	read = async->audioRead;
+	write = async->audioWrite;
+	frameSize = async->s_width * async->s_channels;
+	trap_Mutex_Unlock( async->mutex );
+
+	if( read == write || !frameSize ) {
+		return false;
+	}
+
+	// the worker only writes past audioWrite, so deliver outside of the lock
+	while( read < write ) {
+		offset = read & ( CIN_ASYNC_AUDIO_SIZE - 1 );
+		len = CIN_ASYNC_AUDIO_SIZE - offset;
+		if( len > write - read ) {
+			len = write - read;
+		}
+
+		for( i = 0; i < cin->num_listeners; i++ ) {
+			cin->listeners[i].raw_samples( cin->listeners[i].listener, len / frameSize,
+										   async->s_rate, async->s_width, async->s_channels, async->audio + offset );
+		}
+
+		read += len;
+	}
+
+	trap_Mutex_Lock( async->mutex );
+	async->audioRead = read;
+	trap_Mutex_Unlock( async->mutex );
+
+	return true;
+}
+
+/*
+* CIN_AsyncReadNextFrame
+*
+* Returns the newest frame that is due, the frame stays valid until the next call
+*/
+static uint8_t *CIN_AsyncReadNextFrame( cinematics_t *cin, int *width, int *height, bool *redraw ) {
+	cin_async_t *async = cin->async;
+	cin_asyncslot_t *slot;
+	int picked = -1;
+	bool eos;
+
+	if( CIN_AsyncFlushAudio( cin ) ) {
+		CIN_ClearRawSamplesListeners( cin );
+	}
+
+	trap_Mutex_Lock( async->mutex );
+
+	while( async->numReady > 0 && async->slots[async->readSlot].pts <= async->clock ) {
+		if( picked >= 0 ) {
+			async->slots[picked].state = CIN_SLOT_FREE;
+			async->framesDropped++;
+		}
+
+		picked = async->readSlot;
+		async->readSlot = ( async->readSlot + 1 ) % CIN_ASYNC_FRAMES;
+		async->numReady--;
+	}
+
+	if( picked >= 0 ) {
+		if( async->shownSlot >= 0 ) {
+			async->slots[async->shownSlot].state = CIN_SLOT_FREE;
+		}
+		async->slots[picked].state = CIN_SLOT_SHOWN;
+		async->shownSlot = picked;
+	}
+
+	eos = async->eos && !async->numReady;
+
+	trap_Mutex_Unlock( async->mutex );
+
+	*redraw = picked >= 0;
+
+	if( async->shownSlot < 0 || ( eos && picked < 0 ) ) {
+		*width = *height = 0;
+		return NULL;
+	}
+
+	slot = &async->slots[async->shownSlot];
+	*width = slot->width;
+	*height = slot->height;
+	return cin->yuv ? ( uint8_t * )&slot->yuv : slot->data;
+}
+
 // =====================================================================
 
 /*
@@ -193,6 +714,10 @@ cinematics_t *CIN_Open( const char *name, int64_t start_time,
 	load_msec = trap_Milliseconds() - load_msec;
 	cin->start_time = cin->cur_time = start_time + load_msec;
 
+	if( cin_async->integer ) {
+		CIN_StartAsync( cin, cin->start_time );
+	}
+
 	return cin;
 }
 
@@ -205,6 +730,11 @@ bool CIN_HasOggAudio( cinematics_t *cin ) {
 	assert( cin );
 	assert( cin->type > CIN_TYPE_NONE && cin->type < CIN_NUM_TYPES );
 
+	if( cin->async ) {
+		// the decoder is reinitialized by the worker when looping
+		return cin->async->hasOggAudio;
+	}
+
 	type = &cin_types[cin->type];
 	return type->has_ogg_audio( cin );
 }
@@ -225,6 +755,10 @@ bool CIN_NeedNextFrame( cinematics_t *cin, int64_t curtime ) {
 	assert( cin );
 	assert( cin->type > CIN_TYPE_NONE && cin->type < CIN_NUM_TYPES );
 
+	if( cin->async ) {
+		return CIN_AsyncNeedNextFrame( cin, curtime );
+	}
+
 	type = &cin_types[cin->type];
 
 	cin->cur_time = curtime;
@@ -250,6 +784,29 @@ static uint8_t *CIN_ReadNextFrame_( cinematics_t *cin, int *width, int *height,
 	assert( cin );
 	assert( cin->type > CIN_TYPE_NONE && cin->type < CIN_NUM_TYPES );
 
+	if( cin->async ) {
+		int frameWidth, frameHeight;
+
+		frame = CIN_AsyncReadNextFrame( cin, &frameWidth, &frameHeight, &redraw_ );
+
+		if( width ) {
+			*width = frameWidth;
+		}
+		if( height ) {
+			*height = frameHeight;
+		}
+		if( aspect_numerator ) {
+			*aspect_numerator = cin->aspect_numerator;
+		}
+		if( aspect_denominator ) {
+			*aspect_denominator = cin->aspect_denominator;
+		}
+		if( redraw ) {
+			*redraw = redraw_;
+		}
+		return frame;
+	}
+
 	type = &cin_types[cin->type];
 
 	cin->haveAudio = false;
@@ -366,6 +923,14 @@ void CIN_RawSamplesToListeners( cinematics_t *cin, unsigned int samples, unsigne
 		return;
 	}
 
+	if( cin->async ) {
+		// called by the decoder on the worker thread
+		CIN_AsyncWriteAudio( cin, samples, rate, width, channels, data );
+		cin->haveAudio = true;
+		cin->s_samples_length += CIN_AsyncAudioMsec( cin->async, samples * width * channels );
+		return;
+	}
+
 	for( i = 0; i < cin->num_listeners; i++ ) {
 		cin->listeners[i].raw_samples( cin->listeners[i].listener, samples, rate, width, channels, data );
 	}
@@ -393,6 +958,18 @@ unsigned int CIN_GetRawSamplesLengthFromListeners( cinematics_t *cin ) {
 	return length;
 }
 
+/*
+* CIN_HasRawSamplesListeners
+*
+* Audio decoded ahead is queued, so there's always a listener in that case
+*/
+bool CIN_HasRawSamplesListeners( cinematics_t *cin ) {
+	if( cin->flags & CIN_NOAUDIO ) {
+		return false;
+	}
+	return cin->async != NULL || cin->num_listeners > 0;
+}
+
 /*
 * CIN_Reset
 */
@@ -404,10 +981,16 @@ void CIN_Reset( cinematics_t *cin, int64_t cur_time ) {
 
 	type = &cin_types[cin->type];
 
+	CIN_StopAsync( cin );
+
 	type->reset( cin );
 	cin->frame = 0;
 	cin->cur_time = cur_time;
 	cin->start_time = cur_time;
+
+	if( cin->async ) {
+		CIN_StartAsync( cin, cur_time );
+	}
 }
 
 /*
@@ -426,6 +1009,8 @@ void CIN_Close( cinematics_t *cin ) {
 	mempool = cin->mempool;
 	assert( mempool != NULL );
 
+	CIN_FreeAsync( cin );
+
 	type = &cin_types[cin->type];
 	type->shutdown( cin );
 
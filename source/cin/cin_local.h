@@ -78,8 +78,13 @@ typedef struct cinematics_s {
 	int type;
 	void        *fdata;             // format-dependent data
 	struct mempool_s *mempool;
+
+	struct cin_async_s *async;      // non-NULL if decoded on a worker thread
+	unsigned int lookahead_msec;    // how far ahead of cur_time video frames are decoded
 } cinematics_t;
 
+extern cvar_t *cin_async;
+
 void Com_DPrintf( const char *format, ... );
 
 int CIN_API( void );
@@ -112,6 +117,8 @@ void CIN_RawSamplesToListeners( cinematics_t *cin, unsigned int samples, unsigne
 
 unsigned int CIN_GetRawSamplesLengthFromListeners( cinematics_t *cin );
 
+bool CIN_HasRawSamplesListeners( cinematics_t *cin );
+
 void CIN_Reset( cinematics_t *cin, int64_t cur_time );
 
 void CIN_Close( cinematics_t *cin );
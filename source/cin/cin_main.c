@@ -23,6 +23,8 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 struct mempool_s *cinPool;
 
+cvar_t *cin_async;
+
 /*
 * CIN_API
 */
@@ -38,6 +40,8 @@ bool CIN_Init( bool verbose ) {
 
 	Theora_LoadTheoraLibraries();
 
+	cin_async = trap_Cvar_Get( "cin_async", "1", CVAR_ARCHIVE );
+
 	return true;
 }
 
@@ -532,7 +532,6 @@ cin_yuv_t *RoQ_ReadNextFrameYUV_CIN( cinematics_t *cin, bool *redraw ) {
 		if( chunk->id == RoQ_INFO ) {
 			RoQ_ReadInfo( cin );
 		} else if( ( chunk->id == RoQ_SOUND_MONO || chunk->id == RoQ_SOUND_STEREO ) ) {
-			assert( cin->num_listeners != 0 );
 			RoQ_ReadAudio( cin );
 		} else if( chunk->id == RoQ_QUAD_VQ ) {
 			*redraw = true;
@@ -621,19 +620,21 @@ void RoQ_Reset_CIN( cinematics_t *cin ) {
 * RoQ_NeedNextFrame
 */
 bool RoQ_NeedNextFrame_CIN( cinematics_t *cin ) {
-	unsigned int frame;
+	unsigned int frame, realframe;
 
-	if( cin->cur_time <= cin->start_time ) {
+	if( cin->cur_time + cin->lookahead_msec <= cin->start_time ) {
 		return false;
 	}
 
-	frame = ( cin->cur_time - cin->start_time ) * cin->framerate / 1000.0;
+	frame = ( cin->cur_time + cin->lookahead_msec - cin->start_time ) * cin->framerate / 1000.0;
 	if( frame <= cin->frame ) {
 		return false;
 	}
 
-	if( frame > cin->frame + 1 ) {
-		Com_DPrintf( "Dropped frame: %i > %i\n", frame, cin->frame + 1 );
+	// frames can't be skipped, slow down instead if lagging behind
+	realframe = cin->cur_time > cin->start_time ? ( cin->cur_time - cin->start_time ) * cin->framerate / 1000.0 : 0;
+	if( realframe > cin->frame + 1 ) {
+		Com_DPrintf( "Dropped frame: %i > %i\n", realframe, cin->frame + 1 );
 		cin->start_time = cin->cur_time - cin->frame * 1000 / cin->framerate;
 	}
 
@@ -24,6 +24,10 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 extern cin_import_t CIN_IMPORT;
 
+typedef struct qthread_s qthread_t;
+typedef struct qmutex_s qmutex_t;
+typedef struct qbufPipe_s qbufPipe_t;
+
 static inline void trap_Print( const char *msg ) {
 	CIN_IMPORT.Print( msg );
 }
@@ -176,3 +180,52 @@ static inline void *trap_LoadLibrary( char *name, dllfunc_t *funcs ) {
 static inline void trap_UnloadLibrary( void **lib ) {
 	CIN_IMPORT.Sys_UnloadLibrary( lib );
 }
+
+static inline struct qthread_s *trap_Thread_Create( void *( *routine )( void* ), void *param ) {
+	return CIN_IMPORT.Thread_Create( routine, param );
+}
+
+static inline void trap_Thread_Join( struct qthread_s *thread ) {
+	CIN_IMPORT.Thread_Join( thread );
+}
+
+static inline struct qmutex_s *trap_Mutex_Create( void ) {
+	return CIN_IMPORT.Mutex_Create();
+}
+
+static inline void trap_Mutex_Destroy( struct qmutex_s **mutex ) {
+	CIN_IMPORT.Mutex_Destroy( mutex );
+}
+
+static inline void trap_Mutex_Lock( struct qmutex_s *mutex ) {
+	CIN_IMPORT.Mutex_Lock( mutex );
+}
+
+static inline void trap_Mutex_Unlock( struct qmutex_s *mutex ) {
+	CIN_IMPORT.Mutex_Unlock( mutex );
+}
+
+static inline qbufPipe_t *trap_BufPipe_Create( size_t bufSize, int flags ) {
+	return CIN_IMPORT.BufPipe_Create( bufSize, flags );
+}
+
+static inline void trap_BufPipe_Destroy( qbufPipe_t **pqueue ) {
+	CIN_IMPORT.BufPipe_Destroy( pqueue );
+}
+
+static inline void trap_BufPipe_Finish( qbufPipe_t *queue ) {
+	CIN_IMPORT.BufPipe_Finish( queue );
+}
+
+static inline void trap_BufPipe_WriteCmd( qbufPipe_t *queue, const void *cmd, unsigned cmd_size ) {
+	CIN_IMPORT.BufPipe_WriteCmd( queue, cmd, cmd_size );
+}
+
+static inline int trap_BufPipe_ReadCmds( qbufPipe_t *queue, unsigned( **cmdHandlers )( const void * ) ) {
+	return CIN_IMPORT.BufPipe_ReadCmds( queue, cmdHandlers );
+}
+
+static inline void trap_BufPipe_Wait( qbufPipe_t *queue, int ( *read )( qbufPipe_t *, unsigned( ** )( const void * ), bool ),
+									  unsigned( **cmdHandlers )( const void * ), unsigned timeout_msec ) {
+	CIN_IMPORT.BufPipe_Wait( queue, read, cmdHandlers, timeout_msec );
+}
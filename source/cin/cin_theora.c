@@ -426,7 +426,7 @@ read_samples:
 			samplesNeeded = qth->s_samples_need - qth->s_samples_read;
 		}
 
-		if( cin->num_listeners > 0 ) {
+		if( CIN_HasRawSamplesListeners( cin ) ) {
 			if( cin->s_channels == 1 ) {
 				left = right = pcm[0];
 				for( i = 0; i < samplesNeeded; i++ ) {
@@ -492,7 +492,7 @@ static bool OggTheora_NeedVideoData( cinematics_t *cin ) {
 	}
 
 	// sync to audio timer
-	realframe = sync_time * cin->framerate / 1000.0;
+	realframe = ( sync_time + cin->lookahead_msec ) * cin->framerate / 1000.0;
 	if( realframe > cin->frame ) {
 		return true;
 	}
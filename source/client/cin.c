@@ -135,6 +135,20 @@ void CIN_LoadLibrary( bool verbose ) {
 	import.Mem_FreePool = &CL_CinModule_MemFreePool;
 	import.Mem_EmptyPool = &CL_CinModule_MemEmptyPool;
 
+	import.Thread_Create = QThread_Create;
+	import.Thread_Join = QThread_Join;
+	import.Mutex_Create = QMutex_Create;
+	import.Mutex_Destroy = QMutex_Destroy;
+	import.Mutex_Lock = QMutex_Lock;
+	import.Mutex_Unlock = QMutex_Unlock;
+
+	import.BufPipe_Create = QBufPipe_Create;
+	import.BufPipe_Destroy = QBufPipe_Destroy;
+	import.BufPipe_Finish = QBufPipe_Finish;
+	import.BufPipe_WriteCmd = QBufPipe_WriteCmd;
+	import.BufPipe_ReadCmds = QBufPipe_ReadCmds;
+	import.BufPipe_Wait = QBufPipe_Wait;
+
 	// load dynamic library
 	cin_export = NULL;
 	if( verbose ) {
@@ -22,6 +22,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "client.h"
 
 static void CL_PauseDemo( bool paused );
+static int CL_WriteDemoIndexFrame( msg_t *msg, const snapshot_t *frame, const entity_state_t *baselines );
 
 /*
 * CL_WriteDemoMessage
@@ -29,13 +30,39 @@ static void CL_PauseDemo( bool paused );
 * Dumps the current net message, prefixed by the length
 */
 void CL_WriteDemoMessage( msg_t *msg ) {
+	int offset, frameLength;
+	msg_t frameMsg;
+
 	if( cls.demo.file <= 0 ) {
 		cls.demo.recording = false;
 		return;
 	}
 
+	offset = FS_Tell( cls.demo.file );
+
 	// the first eight bytes are just packet sequencing stuff
 	SNAP_RecordDemoMessage( cls.demo.file, msg, 8 );
+
+	if( !cls.demo.keyframe ) {
+		return;
+	}
+	cls.demo.keyframe = false;
+
+	if( !cls.demo.keyframeSnap ) {
+		SNAP_AddDemoKeyframe( &cls.demo.index, offset, cls.demo.keyframeTime, cl.configstrings[0], NULL, 0 );
+		return;
+	}
+
+	// the made-up frame replaces this message, playback resumes after it
+	MSG_Init( &frameMsg, Mem_TempMalloc( MAX_MSGLEN ), MAX_MSGLEN );
+	frameLength = CL_WriteDemoIndexFrame( &frameMsg, cls.demo.keyframeSnap, cl_baselines );
+	if( frameLength <= MAX_MSGLEN / 2 ) {
+		SNAP_AddDemoKeyframe( &cls.demo.index, FS_Tell( cls.demo.file ), cls.demo.keyframeTime, cl.configstrings[0],
+							  frameMsg.data, frameLength );
+		cls.demo.keyframePending = true;
+	}
+	Mem_TempFree( frameMsg.data );
+	cls.demo.keyframeSnap = NULL;
 }
 
 /*
@@ -67,6 +94,8 @@ void CL_Stop_f( void ) {
 
 	// finish up
 	SNAP_StopDemoRecording( cls.demo.file );
+	CL_SetDemoMetaKeyValue( SNAP_DEMO_INDEX_META_KEY, va( "%i", SNAP_WriteDemoIndex( cls.demo.file, &cls.demo.index ) ) );
+	SNAP_FreeDemoIndex( &cls.demo.index );
 
 	// write some meta information about the match/demo
 	CL_SetDemoMetaKeyValue( "hostname", cl.configstrings[CS_HOSTNAME] );
@@ -183,6 +212,8 @@ void CL_Record_f( void ) {
 	cls.demo.filename = name;
 	cls.demo.recording = true;
 	cls.demo.basetime = cls.demo.duration = cls.demo.time = 0;
+	cls.demo.keyframe = cls.demo.keyframePending = false;
+	cls.demo.keyframeSnap = NULL;
 	cls.demo.name = ZoneCopyString( demoname );
 
 	// don't start saving messages until a non-delta compressed message is received
@@ -201,6 +232,10 @@ void CL_Record_f( void ) {
 static int demofilehandle;
 static int demofilelen, demofilelentotal;
 
+// keyframes to seek to, loaded on the first jump
+static snapDemoIndex_t demoindex;
+static bool demoindexloaded;
+
 /*
 * CL_BeginDemoAviDump
 */
@@ -261,6 +296,9 @@ void CL_DemoCompleted( void ) {
 	}
 	demofilelen = demofilelentotal = 0;
 
+	SNAP_FreeDemoIndex( &demoindex );
+	demoindexloaded = false;
+
 	cls.demo.playing = false;
 	cls.demo.basetime = cls.demo.duration = cls.demo.time = 0;
 	Mem_ZoneFree( cls.demo.filename );
@@ -308,7 +346,9 @@ static void CL_ReadDemoMessage( void ) {
 		return;
 	}
 
+	Prof_Begin( "CL_ParseServerMessage" );
 	CL_ParseServerMessage( &demomsg );
+	Prof_End( "CL_ParseServerMessage" );
 }
 
 /*
@@ -332,12 +372,432 @@ void CL_ReadDemoPackets( void ) {
 	cls.demo.play_jump = false;
 }
 
+/*
+=============================================================================
+
+DEMO KEYFRAME INDEX
+
+Demos recorded with keyframes carry their index after the end of the demo,
+see SNAP_WriteDemoIndex. Older demos are indexed in a single pass, which
+decodes every frame and stores a full copy of one every
+SNAP_DEMO_KEYFRAME_INTERVAL milliseconds, and the result is cached on disk.
+
+=============================================================================
+*/
+
+#define DEMOINDEX_CACHE_IDENT       ( ( 'X' << 24 ) + ( 'I' << 16 ) + ( 'D' << 8 ) + 'W' )
+#define DEMOINDEX_CACHE_VERSION     1
+#define DEMOINDEX_CACHE_EXTENSION   ".dix"
+#define DEMOINDEX_MAX_AREABYTES     255
+
+typedef struct {
+	int ident;
+	int version;
+	int demoLength;
+	int64_t demoTime;
+} demoIndexCacheHeader_t;
+
+typedef struct {
+	snapshot_t snapShots[UPDATE_BACKUP];
+	uint8_t areabits[UPDATE_BACKUP][DEMOINDEX_MAX_AREABYTES];
+	entity_state_t baselines[MAX_EDICTS];
+	char configstrings[MAX_CONFIGSTRINGS][MAX_CONFIGSTRING_CHARS];
+	uint8_t msgData[MAX_MSGLEN];
+	uint8_t frameData[MAX_MSGLEN];
+} demoIndexer_t;
+
+/*
+* CL_DemoIndexCacheFileName
+*
+* Only demos inside the game filesystem have their index cached.
+*/
+static bool CL_DemoIndexCacheFileName( char *dest, size_t size ) {
+	if( !cls.demo.filename || !COM_ValidateRelativeFilename( cls.demo.filename ) ) {
+		return false;
+	}
+
+	Q_snprintfz( dest, size, "cache/%s", cls.demo.filename );
+	COM_ReplaceExtension( dest, DEMOINDEX_CACHE_EXTENSION, size );
+	return true;
+}
+
+/*
+* CL_LoadDemoIndexCache
+*/
+static bool CL_LoadDemoIndexCache( const char *name, time_t demoTime ) {
+	int file;
+	bool loaded;
+	demoIndexCacheHeader_t header;
+
+	if( FS_FOpenFile( name, &file, FS_READ | FS_CACHE ) < 0 ) {
+		return false;
+	}
+
+	loaded = false;
+	if( FS_Read( &header, sizeof( header ), file ) == sizeof( header )
+		&& header.ident == DEMOINDEX_CACHE_IDENT && header.version == DEMOINDEX_CACHE_VERSION
+		&& header.demoLength == demofilelentotal && header.demoTime == (int64_t)demoTime ) {
+		loaded = SNAP_ReadDemoIndex( file, &demoindex );
+	}
+
+	FS_FCloseFile( file );
+	return loaded;
+}
+
+/*
+* CL_WriteDemoIndexCache
+*/
+static void CL_WriteDemoIndexCache( const char *name, time_t demoTime ) {
+	int file;
+	demoIndexCacheHeader_t header;
+
+	if( FS_FOpenFile( name, &file, FS_WRITE | FS_CACHE ) == -1 ) {
+		Com_Printf( S_COLOR_YELLOW "Could not open %s for writing.\n", name );
+		return;
+	}
+
+	header.ident = DEMOINDEX_CACHE_IDENT;
+	header.version = DEMOINDEX_CACHE_VERSION;
+	header.demoLength = demofilelentotal;
+	header.demoTime = (int64_t)demoTime;
+	FS_Write( &header, sizeof( header ), file );
+
+	SNAP_WriteDemoIndex( file, &demoindex );
+
+	FS_FCloseFile( file );
+}
+
+/*
+* CL_WriteDemoIndexFrame
+*
+* Writes a parsed snapshot as a non-delta frame, see SNAP_WriteFrameSnapToClient.
+* Game commands were handled when the original frame was parsed, so they're left out.
+*/
+static int CL_WriteDemoIndexFrame( msg_t *msg, const snapshot_t *frame, const entity_state_t *baselines ) {
+	int i, flags, pos, length, areabytes;
+	const entity_state_t *ent;
+
+	MSG_Clear( msg );
+
+	MSG_WriteUint8( msg, svc_frame );
+
+	pos = msg->cursize;
+	MSG_WriteInt16( msg, 0 );       // we will write length here
+
+	MSG_WriteIntBase128( msg, frame->serverTime );
+	MSG_WriteUintBase128( msg, frame->serverFrame );
+	MSG_WriteUintBase128( msg, 0 );
+	MSG_WriteUintBase128( msg, frame->ucmdExecuted );
+
+	flags = 0;
+	if( frame->allentities ) {
+		flags |= FRAMESNAP_FLAG_ALLENTITIES;
+	}
+	if( frame->multipov ) {
+		flags |= FRAMESNAP_FLAG_MULTIPOV;
+	}
+	MSG_WriteUint8( msg, flags );
+	MSG_WriteUint8( msg, 0 );
+
+	MSG_WriteUint8( msg, svc_gamecommands );
+	MSG_WriteInt16( msg, -1 );
+
+	// the reader clears the areabits first, so trailing zeros can be left out
+	for( areabytes = frame->areabytes; areabytes > 0 && !frame->areabits[areabytes - 1]; areabytes-- ) ;
+	MSG_WriteUint8( msg, areabytes );
+	MSG_WriteData( msg, frame->areabits, areabytes );
+
+	MSG_WriteUint8( msg, svc_match );
+	MSG_WriteDeltaGameState( msg, NULL, &frame->gameState );
+
+	for( i = 0; i < frame->numplayers; i++ ) {
+		MSG_WriteUint8( msg, svc_playerinfo );
+		MSG_WriteDeltaPlayerState( msg, NULL, &frame->playerStates[i] );
+	}
+	MSG_WriteUint8( msg, 0 );
+
+	MSG_WriteUint8( msg, svc_packetentities );
+	for( i = 0, ent = frame->parsedEntities; i < frame->numEntities; i++, ent++ ) {
+		MSG_WriteDeltaEntity( msg, &baselines[ent->number], ent, true );
+	}
+	MSG_WriteInt16( msg, 0 );
+
+	// write length into reserved space
+	length = msg->cursize - pos - 2;
+	msg->cursize = pos;
+	MSG_WriteInt16( msg, length );
+	msg->cursize += length;
+
+	return msg->cursize;
+}
+
+/*
+* CL_IndexDemoServerCommand
+*/
+static void CL_IndexDemoServerCommand( demoIndexer_t *indexer, const char *text ) {
+	int num;
+	char *token;
+
+	token = COM_Parse( &text );
+	if( Q_stricmp( token, "cs" ) ) {
+		return;
+	}
+
+	// configstrings may come batched
+	while( true ) {
+		token = COM_Parse( &text );
+		if( !text || !token[0] ) {
+			break;
+		}
+		num = atoi( token );
+
+		token = COM_Parse( &text );
+		if( num >= 0 && num < MAX_CONFIGSTRINGS ) {
+			Q_strncpyz( indexer->configstrings[num], token, sizeof( indexer->configstrings[num] ) );
+		}
+		if( !text ) {
+			break;
+		}
+	}
+}
+
+/*
+* CL_IndexDemoServerData
+*/
+static bool CL_IndexDemoServerData( msg_t *msg ) {
+	int bitflags, numpure;
+
+	MSG_ReadInt32( msg );   // protocol
+	MSG_ReadInt32( msg );   // spawn count
+	MSG_ReadInt16( msg );   // snap frame time
+	MSG_ReadString( msg );  // base game directory
+	MSG_ReadString( msg );  // game directory
+	MSG_ReadInt16( msg );   // player number
+	MSG_ReadString( msg );  // level name
+
+	bitflags = MSG_ReadUint8( msg );
+	if( bitflags & SV_BITFLAGS_HTTP ) {
+		if( bitflags & SV_BITFLAGS_HTTP_BASEURL ) {
+			MSG_ReadString( msg );
+		} else {
+			MSG_ReadInt16( msg );
+		}
+	}
+
+	for( numpure = MSG_ReadInt16( msg ); numpure > 0; numpure-- ) {
+		MSG_ReadString( msg );
+		MSG_ReadInt32( msg );
+	}
+
+	return ( bitflags & SV_BITFLAGS_RELIABLE ) != 0;
+}
+
+/*
+* CL_BuildDemoIndex
+*
+* Reads the whole demo once, keeping the non-delta frames it has and making
+* up new ones in between. A made-up keyframe replaces the message holding
+* the original frame, so it's dropped when the next frame isn't delta
+* compressed against that one.
+*/
+static bool CL_BuildDemoIndex( void ) {
+	int i, cmd, len, offset, frameLength;
+	bool reliable, pending;
+	int64_t pendingFrame, nextKeyframeTime;
+	demoIndexer_t *indexer;
+	snapshot_t *frame, *lastFrame;
+	msg_t msg, frameMsg;
+
+	if( FS_Seek( demofilehandle, 0, FS_SEEK_SET ) < 0 ) {
+		return false;
+	}
+
+	indexer = Mem_TempMalloc( sizeof( *indexer ) );
+	for( i = 0; i < UPDATE_BACKUP; i++ ) {
+		indexer->snapShots[i].areabytes = DEMOINDEX_MAX_AREABYTES;
+		indexer->snapShots[i].areabits = indexer->areabits[i];
+	}
+
+	MSG_Init( &msg, indexer->msgData, sizeof( indexer->msgData ) );
+	MSG_Init( &frameMsg, indexer->frameData, sizeof( indexer->frameData ) );
+
+	reliable = false;
+	pending = false;
+	pendingFrame = 0;
+	nextKeyframeTime = 0;
+	lastFrame = NULL;
+
+	while( true ) {
+		offset = FS_Tell( demofilehandle );
+		if( FS_Read( &len, 4, demofilehandle ) != 4 ) {
+			break;
+		}
+		len = LittleLong( len );
+		if( len < 0 || len > MAX_MSGLEN || FS_Read( msg.data, len, demofilehandle ) != len ) {
+			break;
+		}
+		msg.cursize = len;
+		msg.readcount = 0;
+
+		frame = NULL;
+		while( msg.readcount < msg.cursize ) {
+			cmd = MSG_ReadUint8( &msg );
+			switch( cmd ) {
+				case svc_nop:
+					break;
+				case svc_demoinfo:
+					MSG_ReadInt32( &msg );
+					MSG_ReadInt32( &msg );
+					MSG_ReadInt32( &msg );
+					MSG_SkipData( &msg, MSG_ReadInt32( &msg ) );
+					break;
+				case svc_serverdata:
+					reliable = CL_IndexDemoServerData( &msg );
+					break;
+				case svc_servercmd:
+					if( !reliable ) {
+						MSG_ReadInt32( &msg );
+					}
+					CL_IndexDemoServerCommand( indexer, MSG_ReadString( &msg ) );
+					break;
+				case svc_servercs:
+					CL_IndexDemoServerCommand( indexer, MSG_ReadString( &msg ) );
+					break;
+				case svc_spawnbaseline:
+					SNAP_ParseBaseline( &msg, indexer->baselines );
+					break;
+				case svc_clcack:
+					MSG_ReadUintBase128( &msg );
+					MSG_ReadUintBase128( &msg );
+					break;
+				case svc_frame:
+					frame = SNAP_ParseFrame( &msg, lastFrame, NULL, indexer->snapShots, indexer->baselines, 0 );
+					break;
+				case svc_extension:
+					MSG_ReadUint8( &msg );
+					MSG_ReadUint8( &msg );
+					MSG_SkipData( &msg, MSG_ReadInt16( &msg ) );
+					break;
+				default:
+					Com_Printf( S_COLOR_YELLOW "Unknown command %i while indexing the demo\n", cmd );
+					Mem_TempFree( indexer );
+					return false;
+			}
+		}
+
+		if( !frame || !frame->valid ) {
+			continue;
+		}
+		lastFrame = frame;
+
+		if( pending ) {
+			if( !frame->delta || frame->deltaFrameNum != pendingFrame ) {
+				SNAP_RemoveLastDemoKeyframe( &demoindex );
+			}
+			pending = false;
+		}
+
+		if( !frame->delta ) {
+			SNAP_AddDemoKeyframe( &demoindex, offset, frame->serverTime, indexer->configstrings[0], NULL, 0 );
+			nextKeyframeTime = frame->serverTime + SNAP_DEMO_KEYFRAME_INTERVAL;
+		} else if( frame->serverTime >= nextKeyframeTime ) {
+			frameLength = CL_WriteDemoIndexFrame( &frameMsg, frame, indexer->baselines );
+			if( frameLength <= MAX_MSGLEN / 2 ) {
+				SNAP_AddDemoKeyframe( &demoindex, FS_Tell( demofilehandle ), frame->serverTime, indexer->configstrings[0],
+									  frameMsg.data, frameLength );
+				pending = true;
+				pendingFrame = frame->serverFrame;
+				nextKeyframeTime = frame->serverTime + SNAP_DEMO_KEYFRAME_INTERVAL;
+			}
+		}
+	}
+
+	Mem_TempFree( indexer );
+
+	return demoindex.numKeyframes > 0;
+}
+
+/*
+* CL_LoadDemoIndex
+*/
+static void CL_LoadDemoIndex( void ) {
+	int position, offset;
+	bool loaded;
+	time_t demoTime;
+	const char *value;
+	char cacheName[MAX_QPATH];
+
+	demoindexloaded = true;
+	position = FS_Tell( demofilehandle );
+
+	loaded = false;
+	value = SNAP_GetDemoMetaKeyValue( cls.demo.meta_data, cls.demo.meta_data_realsize, SNAP_DEMO_INDEX_META_KEY );
+	if( value ) {
+		offset = atoi( value );
+		if( offset > 0 && FS_Seek( demofilehandle, offset, FS_SEEK_SET ) == 0 ) {
+			loaded = SNAP_ReadDemoIndex( demofilehandle, &demoindex );
+		}
+	}
+
+	if( !loaded && CL_DemoIndexCacheFileName( cacheName, sizeof( cacheName ) ) ) {
+		demoTime = FS_FileMTime( cls.demo.filename );
+		loaded = CL_LoadDemoIndexCache( cacheName, demoTime );
+		if( !loaded ) {
+			Com_Printf( "Indexing %s...\n", cls.demo.filename );
+			if( CL_BuildDemoIndex() ) {
+				CL_WriteDemoIndexCache( cacheName, demoTime );
+				loaded = true;
+			}
+		}
+	} else if( !loaded ) {
+		loaded = CL_BuildDemoIndex();
+	}
+
+	if( !loaded ) {
+		SNAP_FreeDemoIndex( &demoindex );
+	}
+
+	FS_Seek( demofilehandle, position, FS_SEEK_SET );
+}
+
+/*
+* CL_SeekDemoKeyframe
+*/
+static void CL_SeekDemoKeyframe( const snapDemoKeyframe_t *keyframe ) {
+	int i;
+	char *configstrings;
+	msg_t msg;
+
+	// bring the configstrings to their state at the keyframe
+	configstrings = Mem_TempMalloc( MAX_CONFIGSTRINGS * MAX_CONFIGSTRING_CHARS );
+	SNAP_GetDemoKeyframeConfigstrings( &demoindex, keyframe, configstrings );
+	for( i = 0; i < MAX_CONFIGSTRINGS; i++ ) {
+		const char *cs = configstrings + i * MAX_CONFIGSTRING_CHARS;
+		if( strncmp( cs, cl.configstrings[i], MAX_CONFIGSTRING_CHARS ) ) {
+			CL_UpdateConfigString( i, cs );
+		}
+	}
+	Mem_TempFree( configstrings );
+
+	FS_Seek( demofilehandle, keyframe->offset, FS_SEEK_SET );
+	cl.currentSnapNum = cl.receivedSnapNum = 0;
+
+	if( keyframe->frameLength ) {
+		MSG_Init( &msg, keyframe->frame, keyframe->frameLength );
+		msg.cursize = keyframe->frameLength;
+		CL_ParseServerMessage( &msg );
+	}
+}
+
 /*
 * CL_LatchedDemoJump
 *
 * See if it's time to read a new demo packet
 */
 void CL_LatchedDemoJump( void ) {
+	int64_t snapTime;
+	const snapDemoKeyframe_t *keyframe;
+
 	if( cls.demo.paused || !cls.demo.play_jump_latched ) {
 		return;
 	}
@@ -350,7 +810,16 @@ void CL_LatchedDemoJump( void ) {
 
 	CL_AdjustServerTime( 1 );
 
-	if( cl.serverTime < cl.snapShots[cl.receivedSnapNum & UPDATE_MASK].serverTime ) {
+	if( !demoindexloaded ) {
+		CL_LoadDemoIndex();
+	}
+
+	// seek to the closest keyframe when going back or when it's ahead of the last frame read
+	snapTime = cl.snapShots[cl.receivedSnapNum & UPDATE_MASK].serverTime;
+	keyframe = SNAP_FindDemoKeyframe( &demoindex, cl.serverTime );
+	if( keyframe && ( cl.serverTime < snapTime || keyframe->serverTime > snapTime ) ) {
+		CL_SeekDemoKeyframe( keyframe );
+	} else if( cl.serverTime < snapTime ) {
 		demofilelen = demofilelentotal;
 		FS_Seek( demofilehandle, 0, FS_SEEK_SET );
 		cl.currentSnapNum = cl.receivedSnapNum = 0;
@@ -593,19 +1062,22 @@ size_t CL_ReadDemoMetaData( const char *demopath, char *meta_data, size_t meta_d
 		Q_snprintfz( name, name_size, "demos/%s", servername );
 		COM_DefaultExtension( name, APP_DEMO_EXTENSION_STR, name_size );
 
-		demolength = FS_FOpenFile( name, &demofile, FS_READ | SNAP_DEMO_GZ );
-
-		if( !demofile || demolength < 1 ) {
-			// relative filename didn't work, try launching a demo from absolute path
-			Q_snprintfz( name, name_size, "%s", servername );
-			COM_DefaultExtension( name, APP_DEMO_EXTENSION_STR, name_size );
-			demolength = FS_FOpenAbsoluteFile( name, &demofile, FS_READ );
-		}
-
-		if( demolength > 0 ) {
-			meta_data_realsize = SNAP_ReadDemoMetaData( demofile, meta_data, meta_data_size );
+		// unchanged demos are served from the index
+		if( !CL_DemoIndex_ReadMetaData( name, meta_data, meta_data_size, &meta_data_realsize ) ) {
+			demolength = FS_FOpenFile( name, &demofile, FS_READ | SNAP_DEMO_GZ );
+
+			if( !demofile || demolength < 1 ) {
+				// relative filename didn't work, try launching a demo from absolute path
+				Q_snprintfz( name, name_size, "%s", servername );
+				COM_DefaultExtension( name, APP_DEMO_EXTENSION_STR, name_size );
+				demolength = FS_FOpenAbsoluteFile( name, &demofile, FS_READ );
+			}
+
+			if( demolength > 0 ) {
+				meta_data_realsize = SNAP_ReadDemoMetaData( demofile, meta_data, meta_data_size );
+			}
+			FS_FCloseFile( demofile );
 		}
-		FS_FCloseFile( demofile );
 
 		Mem_TempFree( name );
 	}
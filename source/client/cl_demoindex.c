@@ -0,0 +1,461 @@
+/*
+Copyright (C) 2018 Warsow development team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+// cl_demoindex.c -- persistent index of demo meta data, filled in the background
+
+#include "client.h"
+#include "../qalgo/q_trie.h"
+
+#define DEMOINDEX_CACHE         "cache/demoindex.dat"
+#define DEMOINDEX_MAGIC         "WDIX"
+#define DEMOINDEX_VERSION       1
+#define DEMOINDEX_NUM_THREADS   2
+
+typedef struct demoindex_entry_s {
+	char *filename;
+	int size;
+	unsigned mtime;
+	size_t meta_data_realsize;
+	size_t meta_data_size;          // stored bytes, not counting the terminating \0
+	char *meta_data;
+	bool stale;                     // not found by the last scan of its directory
+} demoindex_entry_t;
+
+typedef struct demoindex_job_s {
+	char *filename;
+	struct demoindex_job_s *next;
+} demoindex_job_t;
+
+typedef struct {
+	bool initialized;
+	bool dirty;
+	volatile bool terminated;
+
+	trie_t *entries;
+	qmutex_t *mutex;
+	qcondvar_t *nonempty;
+	demoindex_job_t *queue_head, *queue_tail;
+	qthread_t *threads[DEMOINDEX_NUM_THREADS];
+} demoindex_t;
+
+static demoindex_t demoindex;
+
+/*
+* CL_DemoIndex_Store
+*/
+static void CL_DemoIndex_Store( const char *filename, int size, unsigned mtime, const char *meta_data, size_t meta_data_realsize, size_t meta_data_size ) {
+	size_t filename_size = strlen( filename ) + 1;
+	demoindex_entry_t *entry, *old;
+
+	entry = ( demoindex_entry_t * )Mem_ZoneMalloc( sizeof( *entry ) + filename_size + meta_data_size + 1 );
+	entry->filename = ( char * )( entry + 1 );
+	memcpy( entry->filename, filename, filename_size );
+	entry->size = size;
+	entry->mtime = mtime;
+	entry->meta_data_realsize = meta_data_realsize;
+	entry->meta_data_size = meta_data_size;
+	entry->meta_data = entry->filename + filename_size;
+	memcpy( entry->meta_data, meta_data, meta_data_size );
+	entry->meta_data[meta_data_size] = '\0';
+	entry->stale = false;
+
+	QMutex_Lock( demoindex.mutex );
+	if( Trie_Find( demoindex.entries, filename, TRIE_EXACT_MATCH, (void **)&old ) == TRIE_OK ) {
+		Trie_Replace( demoindex.entries, filename, entry, (void **)&old );
+		Mem_ZoneFree( old );
+	} else {
+		Trie_Insert( demoindex.entries, filename, entry );
+	}
+	demoindex.dirty = true;
+	QMutex_Unlock( demoindex.mutex );
+}
+
+/*
+* CL_DemoIndex_Load
+*
+* Each entry is stored as filename size, file size, mtime, real and stored
+* meta data sizes, followed by the \0-terminated filename and the meta data
+*/
+static void CL_DemoIndex_Load( void ) {
+	int length;
+	uint8_t *buffer, *p, *end;
+	unsigned header[5];
+	const char *filename;
+
+	length = FS_LoadCacheFile( DEMOINDEX_CACHE, (void **)&buffer, NULL, 0 );
+	if( !buffer ) {
+		return;
+	}
+
+	if( length < 8 || memcmp( buffer, DEMOINDEX_MAGIC, 4 ) ) {
+		FS_FreeFile( buffer );
+		return;
+	}
+
+	memcpy( &header[0], buffer + 4, 4 );
+	if( LittleLong( header[0] ) != DEMOINDEX_VERSION ) {
+		FS_FreeFile( buffer );
+		return;
+	}
+
+	end = buffer + length;
+	for( p = buffer + 8; p + sizeof( header ) <= end; ) {
+		memcpy( header, p, sizeof( header ) );
+		header[0] = LittleLong( header[0] );
+		header[1] = LittleLong( header[1] );
+		header[2] = LittleLong( header[2] );
+		header[3] = LittleLong( header[3] );
+		header[4] = LittleLong( header[4] );
+		p += sizeof( header );
+
+		// checked separately so the sum can't wrap around
+		if( !header[0] || header[4] >= SNAP_MAX_DEMO_META_DATA_SIZE ) {
+			break;
+		}
+		if( header[0] > ( size_t )( end - p ) || header[4] > ( size_t )( end - p ) - header[0] ) {
+			break;
+		}
+
+		filename = ( const char * )p;
+		if( filename[header[0] - 1] != '\0' ) {
+			break;
+		}
+
+		CL_DemoIndex_Store( filename, ( int )header[1], header[2], ( const char * )p + header[0], header[3], header[4] );
+		p += header[0] + header[4];
+	}
+
+	FS_FreeFile( buffer );
+
+	demoindex.dirty = false;
+}
+
+/*
+* CL_DemoIndex_Save
+*/
+static void CL_DemoIndex_Save( void ) {
+	int filenum;
+	unsigned int i;
+	unsigned header[5];
+	demoindex_entry_t *entry;
+	struct trie_dump_s *dump;
+
+	if( !demoindex.dirty ) {
+		return;
+	}
+
+	if( FS_FOpenFile( DEMOINDEX_CACHE, &filenum, FS_WRITE | FS_CACHE ) == -1 ) {
+		Com_Printf( "CL_DemoIndex_Save: failed to open %s for writing\n", DEMOINDEX_CACHE );
+		return;
+	}
+
+	header[0] = LittleLong( DEMOINDEX_VERSION );
+	FS_Write( DEMOINDEX_MAGIC, 4, filenum );
+	FS_Write( &header[0], 4, filenum );
+
+	Trie_Dump( demoindex.entries, "", TRIE_DUMP_VALUES, &dump );
+	for( i = 0; i < dump->size; i++ ) {
+		entry = ( demoindex_entry_t * )dump->key_value_vector[i].value;
+		if( entry->stale ) {
+			continue;
+		}
+
+		header[0] = LittleLong( ( unsigned )strlen( entry->filename ) + 1 );
+		header[1] = LittleLong( ( unsigned )entry->size );
+		header[2] = LittleLong( entry->mtime );
+		header[3] = LittleLong( ( unsigned )entry->meta_data_realsize );
+		header[4] = LittleLong( ( unsigned )entry->meta_data_size );
+
+		FS_Write( header, sizeof( header ), filenum );
+		FS_Write( entry->filename, strlen( entry->filename ) + 1, filenum );
+		FS_Write( entry->meta_data, entry->meta_data_size, filenum );
+	}
+	Trie_FreeDump( dump );
+
+	FS_FCloseFile( filenum );
+
+	demoindex.dirty = false;
+}
+
+/*
+* CL_DemoIndex_Lookup
+*
+* Returns false if the file doesn't exist. The index entry is only used if the size
+* and modification time of the file match, otherwise the meta data is read from the
+* demo and stored in the index. Safe to call from any thread.
+*/
+static bool CL_DemoIndex_Lookup( const char *filename, char *meta_data, size_t meta_data_size, size_t *meta_data_realsize ) {
+	int size, demofile;
+	unsigned mtime;
+	size_t realsize, stored;
+	char *buffer;
+	demoindex_entry_t *entry;
+
+	size = FS_FOpenFile( filename, NULL, FS_READ );
+	if( size < 1 ) {
+		return false;
+	}
+	mtime = ( unsigned )FS_FileMTime( filename );
+
+	QMutex_Lock( demoindex.mutex );
+	if( Trie_Find( demoindex.entries, filename, TRIE_EXACT_MATCH, (void **)&entry ) == TRIE_OK
+		&& entry->size == size && entry->mtime == mtime ) {
+		entry->stale = false;
+		if( meta_data && meta_data_size ) {
+			stored = min( meta_data_size - 1, entry->meta_data_size );
+			memcpy( meta_data, entry->meta_data, stored );
+			meta_data[stored] = '\0';
+		}
+		*meta_data_realsize = entry->meta_data_realsize;
+		QMutex_Unlock( demoindex.mutex );
+		return true;
+	}
+	QMutex_Unlock( demoindex.mutex );
+
+	buffer = ( char * )Mem_TempMalloc( SNAP_MAX_DEMO_META_DATA_SIZE );
+
+	realsize = 0;
+	if( FS_FOpenFile( filename, &demofile, FS_READ | SNAP_DEMO_GZ ) > 0 ) {
+		realsize = SNAP_ReadDemoMetaData( demofile, buffer, SNAP_MAX_DEMO_META_DATA_SIZE );
+	}
+	FS_FCloseFile( demofile );
+
+	stored = min( realsize, SNAP_MAX_DEMO_META_DATA_SIZE - 1 );
+	CL_DemoIndex_Store( filename, size, mtime, buffer, realsize, stored );
+
+	if( meta_data && meta_data_size ) {
+		stored = min( meta_data_size - 1, stored );
+		memcpy( meta_data, buffer, stored );
+		meta_data[stored] = '\0';
+	}
+	*meta_data_realsize = realsize;
+
+	Mem_TempFree( buffer );
+
+	return true;
+}
+
+/*
+* CL_DemoIndex_ReadMetaData
+*
+* Same as SNAP_ReadDemoMetaData but served from the index when the demo hasn't changed
+*/
+bool CL_DemoIndex_ReadMetaData( const char *filename, char *meta_data, size_t meta_data_size, size_t *meta_data_realsize ) {
+	*meta_data_realsize = 0;
+
+	if( !demoindex.initialized ) {
+		return false;
+	}
+
+	return CL_DemoIndex_Lookup( filename, meta_data, meta_data_size, meta_data_realsize );
+}
+
+/*
+* CL_DemoIndex_WorkerProc
+*/
+static void *CL_DemoIndex_WorkerProc( void *param ) {
+	size_t realsize;
+	demoindex_job_t *job;
+
+	while( true ) {
+		QMutex_Lock( demoindex.mutex );
+		while( !demoindex.queue_head && !demoindex.terminated ) {
+			QCondVar_Wait( demoindex.nonempty, demoindex.mutex, 1000 );
+		}
+
+		if( demoindex.terminated ) {
+			QMutex_Unlock( demoindex.mutex );
+			break;
+		}
+
+		job = demoindex.queue_head;
+		demoindex.queue_head = job->next;
+		if( !demoindex.queue_head ) {
+			demoindex.queue_tail = NULL;
+		}
+		QMutex_Unlock( demoindex.mutex );
+
+		CL_DemoIndex_Lookup( job->filename, NULL, 0, &realsize );
+
+		Mem_ZoneFree( job );
+	}
+
+	return NULL;
+}
+
+/*
+* CL_DemoIndex_Scan
+*
+* Queues the demos in a directory inside the demos directory for indexing
+* by the worker threads, so the meta data is ready by the time it's needed
+*/
+void CL_DemoIndex_Scan( const char *dir ) {
+	int i, total;
+	unsigned int j, numStale;
+	size_t size = 0, len, pathlen;
+	char path[MAX_QPATH];
+	char *files, *name;
+	demoindex_job_t *job;
+	demoindex_entry_t *entry;
+	struct trie_dump_s *dump;
+
+	if( !demoindex.initialized ) {
+		return;
+	}
+
+	if( dir && *dir ) {
+		Q_snprintfz( path, sizeof( path ), "demos/%s", dir );
+	} else {
+		Q_strncpyz( path, "demos", sizeof( path ) );
+	}
+	COM_SanitizeFilePath( path );
+
+	pathlen = strlen( path );
+	while( pathlen && path[pathlen - 1] == '/' )
+		path[--pathlen] = '\0';
+
+	if( !COM_ValidateRelativeFilename( path ) ) {
+		return;
+	}
+
+	total = FS_GetFileListExt( path, APP_DEMO_EXTENSION_STR, NULL, &size, 0, 0 );
+
+	files = NULL;
+	if( total && size ) {
+		files = ( char * )Mem_TempMalloc( size );
+		FS_GetFileList( path, APP_DEMO_EXTENSION_STR, files, size, 0, 0 );
+	} else {
+		total = 0;
+	}
+
+	QMutex_Lock( demoindex.mutex );
+
+	// entries of this directory that the scan doesn't find again aren't saved
+	Q_strncatz( path, "/", sizeof( path ) );
+	Trie_Dump( demoindex.entries, path, TRIE_DUMP_VALUES, &dump );
+	for( j = 0, numStale = 0; j < dump->size; j++ ) {
+		entry = ( demoindex_entry_t * )dump->key_value_vector[j].value;
+		if( !strchr( entry->filename + pathlen + 1, '/' ) ) {
+			entry->stale = true;
+			numStale++;
+		}
+	}
+	Trie_FreeDump( dump );
+	path[pathlen] = '\0';
+
+	for( i = 0, len = 0; i < total; i++ ) {
+		name = files + len;
+		len += strlen( name ) + 1;
+
+		job = ( demoindex_job_t * )Mem_ZoneMalloc( sizeof( *job ) + pathlen + 1 + strlen( name ) + 1 );
+		job->filename = ( char * )( job + 1 );
+		sprintf( job->filename, "%s/%s", path, name );
+		job->next = NULL;
+
+		if( Trie_Find( demoindex.entries, job->filename, TRIE_EXACT_MATCH, (void **)&entry ) == TRIE_OK && entry->stale ) {
+			entry->stale = false;
+			numStale--;
+		}
+
+		if( demoindex.queue_tail ) {
+			demoindex.queue_tail->next = job;
+		} else {
+			demoindex.queue_head = job;
+		}
+		demoindex.queue_tail = job;
+	}
+	if( numStale ) {
+		demoindex.dirty = true;
+	}
+	QMutex_Unlock( demoindex.mutex );
+
+	if( files ) {
+		Mem_TempFree( files );
+	}
+
+	for( i = 0; i < DEMOINDEX_NUM_THREADS; i++ )
+		QCondVar_Wake( demoindex.nonempty );
+}
+
+/*
+* CL_DemoIndex_Init
+*/
+void CL_DemoIndex_Init( void ) {
+	int i;
+
+	if( demoindex.initialized ) {
+		return;
+	}
+
+	memset( &demoindex, 0, sizeof( demoindex ) );
+
+	Trie_Create( TRIE_CASE_INSENSITIVE, &demoindex.entries );
+	demoindex.mutex = QMutex_Create();
+	demoindex.nonempty = QCondVar_Create();
+
+	CL_DemoIndex_Load();
+
+	for( i = 0; i < DEMOINDEX_NUM_THREADS; i++ )
+		demoindex.threads[i] = QThread_Create( CL_DemoIndex_WorkerProc, NULL );
+
+	demoindex.initialized = true;
+}
+
+/*
+* CL_DemoIndex_Shutdown
+*/
+void CL_DemoIndex_Shutdown( void ) {
+	int i;
+	unsigned int j;
+	demoindex_job_t *job;
+	struct trie_dump_s *dump;
+
+	if( !demoindex.initialized ) {
+		return;
+	}
+
+	QMutex_Lock( demoindex.mutex );
+	demoindex.terminated = true;
+	QMutex_Unlock( demoindex.mutex );
+
+	for( i = 0; i < DEMOINDEX_NUM_THREADS; i++ )
+		QCondVar_Wake( demoindex.nonempty );
+	for( i = 0; i < DEMOINDEX_NUM_THREADS; i++ )
+		QThread_Join( demoindex.threads[i] );
+
+	while( demoindex.queue_head ) {
+		job = demoindex.queue_head;
+		demoindex.queue_head = job->next;
+		Mem_ZoneFree( job );
+	}
+
+	CL_DemoIndex_Save();
+
+	Trie_Dump( demoindex.entries, "", TRIE_DUMP_VALUES, &dump );
+	for( j = 0; j < dump->size; j++ )
+		Mem_ZoneFree( dump->key_value_vector[j].value );
+	Trie_FreeDump( dump );
+	Trie_Destroy( demoindex.entries );
+
+	QCondVar_Destroy( &demoindex.nonempty );
+	QMutex_Destroy( &demoindex.mutex );
+
+	memset( &demoindex, 0, sizeof( demoindex ) );
+}
@@ -78,6 +78,10 @@ static inline bool CL_GameModule_CM_InPVS( const vec3_t p1, const vec3_t p2 ) {
 	return CM_InPVS( cl.cms, p1, p2 );
 }
 
+static inline bool CL_GameModule_CM_BoxInPVS( const vec3_t p, const vec3_t mins, const vec3_t maxs ) {
+	return CM_BoxInPVS( cl.cms, p, mins, maxs );
+}
+
 //======================================================================
 
 #ifndef _MSC_VER
@@ -417,6 +421,7 @@ void CL_GameModule_Init( void ) {
 
 	import.GetConfigString = CL_GameModule_GetConfigString;
 	import.Milliseconds = Sys_Milliseconds;
+	import.Microseconds = Sys_Microseconds;
 	import.DownloadRequest = CL_DownloadRequest;
 
 	import.NET_GetUserCmd = CL_GameModule_NET_GetUserCmd;
@@ -458,6 +463,7 @@ void CL_GameModule_Init( void ) {
 	import.R_SkeletalGetBoneInfo = re.SkeletalGetBoneInfo;
 	import.R_SkeletalGetBonePose = re.SkeletalGetBonePose;
 
+	import.R_GetFogNumForSphere = re.GetFogNumForSphere;
 	import.R_GetShaderForOrigin = re.GetShaderForOrigin;
 	import.R_GetShaderCinematic = re.GetShaderCinematic;
 
@@ -472,6 +478,7 @@ void CL_GameModule_Init( void ) {
 	import.CM_OctagonModelForBBox = CL_GameModule_CM_OctagonModelForBBox;
 	import.CM_InlineModelBounds = CL_GameModule_CM_InlineModelBounds;
 	import.CM_InPVS = CL_GameModule_CM_InPVS;
+	import.CM_BoxInPVS = CL_GameModule_CM_BoxInPVS;
 
 	import.S_RegisterSound = CL_SoundModule_RegisterSound;
 	import.S_StartFixedSound = CL_SoundModule_StartFixedSound;
@@ -519,6 +526,20 @@ void CL_GameModule_Init( void ) {
 	import.Mem_Alloc = CL_GameModule_MemAlloc;
 	import.Mem_Free = CL_GameModule_MemFree;
 
+	import.Thread_Create = QThread_Create;
+	import.Thread_Join = QThread_Join;
+	import.Mutex_Create = QMutex_Create;
+	import.Mutex_Destroy = QMutex_Destroy;
+	import.Mutex_Lock = QMutex_Lock;
+	import.Mutex_Unlock = QMutex_Unlock;
+
+	import.BufPipe_Create = QBufPipe_Create;
+	import.BufPipe_Destroy = QBufPipe_Destroy;
+	import.BufPipe_Finish = QBufPipe_Finish;
+	import.BufPipe_WriteCmd = QBufPipe_WriteCmd;
+	import.BufPipe_ReadCmds = QBufPipe_ReadCmds;
+	import.BufPipe_Wait = QBufPipe_Wait;
+
 	import.L10n_LoadLangPOFile = &CL_GameModule_L10n_LoadLangPOFile;
 	import.L10n_TranslateString = &CL_GameModule_L10n_TranslateString;
 	import.L10n_ClearDomain = &CL_GameModule_L10n_ClearDomain;
@@ -640,8 +661,10 @@ bool CL_GameModule_NewSnapshot( int pendingSnapshot ) {
 */
 void CL_GameModule_RenderView( float stereo_separation ) {
 	if( cge && cls.cgameActive ) {
+		Prof_Begin( "CG_RenderView" );
 		cge->RenderView( cls.frametime, cls.realFrameTime, cls.realtime, cl.serverTime, stereo_separation,
 						 cl_extrapolate->integer && !cls.demo.playing ? cl_extrapolationTime->integer : 0 );
+		Prof_End( "CG_RenderView" );
 	}
 }
 
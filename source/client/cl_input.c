@@ -148,6 +148,7 @@ void CL_UserInputFrame( int realMsec ) {
 
 	// create a new usercmd_t structure for this frame
 	CL_CreateNewUserCommand( realMsec );
+	Prof_Mark( "input sampled" );
 
 	// process console commands
 	Cbuf_Execute();
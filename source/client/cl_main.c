@@ -1103,7 +1103,7 @@ static void CL_ConnectionlessPacket( const socket_t *socket, const netadr_t *add
 
 		Q_strncpyz( cls.session, MSG_ReadStringLine( msg ), sizeof( cls.session ) );
 
-		Netchan_Setup( &cls.netchan, socket, address, Netchan_GamePort() );
+		Netchan_Setup( &cls.netchan, socket, address, Netchan_GamePort(), APP_PROTOCOL_VERSION );
 		memset( cl.configstrings, 0, sizeof( cl.configstrings ) );
 		CL_SetClientState( CA_HANDSHAKE );
 		CL_AddReliableCommand( "new" );
@@ -1245,7 +1245,7 @@ static bool CL_ProcessPacket( netchan_t *netchan, msg_t *msg ) {
 	MSG_ReadInt32( msg ); // sequence
 	MSG_ReadInt32( msg ); // sequence_ack
 	if( msg->compressed ) {
-		zerror = Netchan_DecompressMessage( msg );
+		zerror = Netchan_DecompressMessage( msg, cls.netchan.zdict );
 		if( zerror < 0 ) {
 			// compression error. Drop the packet
 			Com_Printf( "CL_ProcessPacket: Compression error %i. Dropping packet\n", zerror );
@@ -1332,7 +1332,9 @@ void CL_ReadPackets( void ) {
 				continue; // wasn't accepted for some reason, like only one fragment of bigger message
 
 			}
+			Prof_Begin( "CL_ParseServerMessage" );
 			CL_ParseServerMessage( &msg );
+			Prof_End( "CL_ParseServerMessage" );
 			cls.lastPacketReceivedTime = cls.realtime;
 
 #ifdef TCP_ALLOW_CONNECT
@@ -2261,7 +2263,7 @@ void CL_Netchan_Transmit( msg_t *msg ) {
 	Netchan_PushAllFragments( &cls.netchan );
 
 	if( msg->cursize > 60 ) {
-		int zerror = Netchan_CompressMessage( msg );
+		int zerror = Netchan_CompressMessage( msg, cls.netchan.zdict );
 		if( zerror < 0 ) { // it's compression error, just send uncompressed
 			Com_DPrintf( "CL_Netchan_Transmit (ignoring compression): Compression error %i\n", zerror );
 		}
@@ -2459,8 +2461,14 @@ void CL_Frame( int realMsec, int gameMsec ) {
 
 	CL_UpdateSnapshot();
 	CL_AdjustServerTime( gameMsec );
+	Prof_Begin( "CL_UserInputFrame" );
 	CL_UserInputFrame( realMsec );
+	Prof_End( "CL_UserInputFrame" );
+
+	Prof_Begin( "CL_NetFrame" );
 	CL_NetFrame( realMsec, gameMsec );
+	Prof_End( "CL_NetFrame" );
+
 	CL_MM_Frame();
 
 	if( cls.state == CA_CINEMATIC ) {
@@ -2539,7 +2547,9 @@ void CL_Frame( int realMsec, int gameMsec ) {
 	if( host_speeds->integer ) {
 		time_before_ref = Sys_Milliseconds();
 	}
+	Prof_Begin( "SCR_UpdateScreen" );
 	SCR_UpdateScreen();
+	Prof_End( "SCR_UpdateScreen" );
 	if( host_speeds->integer ) {
 		time_after_ref = Sys_Milliseconds();
 	}
@@ -2923,6 +2933,8 @@ void CL_Init( void ) {
 
 	CL_InitAsyncStream();
 
+	CL_DemoIndex_Init();
+
 	CL_InitMedia();
 
 	CL_UIModule_ForceMenuOn();
@@ -2951,6 +2963,7 @@ void CL_Shutdown( void ) {
 	CL_SoundModule_StopAllSounds( true, true );
 
 	ML_Shutdown();
+	CL_DemoIndex_Shutdown();
 	CL_MM_Shutdown( true );
 	CL_ShutDownServerList();
 
@@ -987,6 +987,25 @@ static void CL_ParseFrame( msg_t *msg ) {
 
 			if( !cls.demo.waiting ) {
 				cls.demo.duration = snap->serverTime - cls.demo.basetime;
+
+				// a made-up keyframe only holds if the server deltas the next frame from it
+				if( cls.demo.keyframePending ) {
+					if( !snap->delta || snap->deltaFrameNum != cls.demo.keyframeFrame ) {
+						SNAP_RemoveLastDemoKeyframe( &cls.demo.index );
+					}
+					cls.demo.keyframePending = false;
+				}
+
+				// players can seek to non-delta frames, so every now and then a delta frame
+				// is written out in full from the parsed state, like CL_BuildDemoIndex does,
+				// instead of having the server send a non-delta one over the network
+				if( !snap->delta || snap->serverTime >= cls.demo.nextKeyframeTime ) {
+					cls.demo.keyframe = true;
+					cls.demo.keyframeSnap = snap->delta ? snap : NULL;
+					cls.demo.keyframeTime = snap->serverTime;
+					cls.demo.keyframeFrame = snap->serverFrame;
+					cls.demo.nextKeyframeTime = snap->serverTime + SNAP_DEMO_KEYFRAME_INTERVAL;
+				}
 			}
 			cls.demo.time = cls.demo.duration;
 		}
@@ -1082,7 +1101,7 @@ static void CL_CvarInfoRequest_f( void ) {
 /*
 * CL_UpdateConfigString
 */
-static void CL_UpdateConfigString( int idx, const char *s ) {
+void CL_UpdateConfigString( int idx, const char *s ) {
 	if( !s ) {
 		return;
 	}
@@ -1304,6 +1323,7 @@ void CL_ParseServerMessage( msg_t *msg ) {
 
 			case svc_playerinfo:
 			case svc_packetentities:
+			case svc_bitpacketentities:
 			case svc_match:
 				Com_Error( ERR_DROP, "Out of place frame data" );
 				break;
@@ -697,6 +697,9 @@ void SCR_UpdateScreen( void ) {
 
 	SCR_CheckSystemFontsModified();
 
+	// glyphs rendered in the background since the last frame
+	FTLIB_BeginFrame();
+
 	/*
 	** range check cl_camera_separation so we don't inadvertently fry someone's
 	** brain
@@ -246,6 +246,357 @@ void CL_ReadServerCache( void ) {
 	Mem_TempFree( buf );
 }
 
+//=========================================================
+// server pinger
+//
+// Pings are sent from a dedicated socket thread, paced to cl_pingrate
+// packets per second, and the replies are parsed on that thread too.
+// The results are passed on to the UI once per frame.
+
+#define PINGER_MAX_WAITING      2048
+#define PINGER_MAX_SENT         512
+#define PINGER_TIMEOUT_MSEC     3000
+#define PINGER_TICK_MSEC        10
+
+typedef unsigned (*queueCmdHandler_t)( const void * );
+
+enum {
+	PINGER_CMD_SHUTDOWN,
+	PINGER_CMD_QUERY
+};
+
+enum {
+	PINGER_CMD_RESULT
+};
+
+typedef struct {
+	int id;
+	netadr_t address;
+	char request[64];
+} pingerQueryCmd_t;
+
+typedef struct {
+	int id;
+	int ping;
+	char address[48];
+	char info[MAX_PACKETLEN];       // only the used part is written to the pipe
+} pingerResultCmd_t;
+
+#define PINGER_RESULT_CMD_SIZE( infolen ) ( ( offsetof( pingerResultCmd_t, info ) + ( infolen ) + 1 + 3 ) & ~3 )
+
+typedef struct {
+	netadr_t address;
+	char request[64];
+} pingerQuery_t;
+
+typedef struct {
+	netadr_t address;
+	int64_t sendTime;               // 0 if the slot is free
+} pingerSent_t;
+
+typedef struct {
+	qthread_t *thread;
+	qbufPipe_t *queries;            // main thread -> pinger
+	qbufPipe_t *results;            // pinger -> main thread
+	socket_t socket_udp;
+	socket_t socket_udp6;
+
+	// only touched by the pinger thread
+	pingerQuery_t waiting[PINGER_MAX_WAITING];
+	int waitingHead, numWaiting;
+	pingerSent_t sent[PINGER_MAX_SENT];
+	int numSent;
+	double sendBudget;
+	int64_t lastSendTime;
+} serverPinger_t;
+
+static serverPinger_t *pinger;
+static cvar_t *cl_pingrate;
+
+/*
+* CL_PingerCmd_Shutdown
+*/
+static unsigned CL_PingerCmd_Shutdown( const void *pcmd ) {
+	return 0;
+}
+
+/*
+* CL_PingerCmd_Query
+*/
+static unsigned CL_PingerCmd_Query( const void *pcmd ) {
+	pingerQueryCmd_t cmd;
+	pingerQuery_t *query;
+
+	memcpy( &cmd, pcmd, sizeof( cmd ) );
+
+	if( pinger->numWaiting < PINGER_MAX_WAITING ) {
+		query = &pinger->waiting[( pinger->waitingHead + pinger->numWaiting ) % PINGER_MAX_WAITING];
+		query->address = cmd.address;
+		Q_strncpyz( query->request, cmd.request, sizeof( query->request ) );
+		pinger->numWaiting++;
+	}
+
+	return sizeof( cmd );
+}
+
+static queueCmdHandler_t pingerCmdHandlers[] =
+{
+	CL_PingerCmd_Shutdown,
+	CL_PingerCmd_Query
+};
+
+/*
+* CL_PingerCmd_Result
+*
+* Called on the main thread
+*/
+static unsigned CL_PingerCmd_Result( const void *pcmd ) {
+	const pingerResultCmd_t *cmd = pcmd;
+	serverlist_t *pingserver;
+
+	pingserver = CL_ServerFindInList( masterList, (char *)cmd->address );
+	if( !pingserver ) {
+		pingserver = CL_ServerFindInList( favoritesList, (char *)cmd->address );
+	}
+	if( pingserver ) {
+		pingserver->pingTimeStamp = 0;
+		pingserver->lastValidPing = Com_DaysSince1900();
+	}
+
+	CL_UIModule_AddToServerList( cmd->address, va( "\\\\ping\\\\%i%s", cmd->ping, cmd->info ) );
+
+	return PINGER_RESULT_CMD_SIZE( strlen( cmd->info ) );
+}
+
+static queueCmdHandler_t pingerResultHandlers[] =
+{
+	CL_PingerCmd_Result
+};
+
+/*
+* CL_PingerSendQueries
+*
+* Sends as many waiting queries as the rate allows
+*/
+static void CL_PingerSendQueries( int64_t now ) {
+	int i, rate;
+	pingerQuery_t *query;
+	pingerSent_t *sent;
+	const socket_t *socket;
+
+	rate = cl_pingrate->integer > 0 ? cl_pingrate->integer : 1;
+
+	// allow bursts of up to a tenth of a second
+	pinger->sendBudget += (double)( now - pinger->lastSendTime ) * rate / 1000.0;
+	if( pinger->sendBudget > rate / 10.0 + 1.0 ) {
+		pinger->sendBudget = rate / 10.0 + 1.0;
+	}
+	pinger->lastSendTime = now;
+
+	for( i = 0; pinger->sendBudget >= 1.0 && pinger->numWaiting > 0 && pinger->numSent < PINGER_MAX_SENT; ) {
+		query = &pinger->waiting[pinger->waitingHead];
+		pinger->waitingHead = ( pinger->waitingHead + 1 ) % PINGER_MAX_WAITING;
+		pinger->numWaiting--;
+
+		socket = ( query->address.type == NA_IP6 ? &pinger->socket_udp6 : &pinger->socket_udp );
+		if( !socket->open ) {
+			continue;
+		}
+
+		while( pinger->sent[i].sendTime ) {
+			i++;
+		}
+		sent = &pinger->sent[i];
+		sent->address = query->address;
+		sent->sendTime = now;
+		pinger->numSent++;
+
+		// Netchan_OutOfBandPrint isn't reentrant
+		Netchan_OutOfBand( socket, &query->address, strlen( query->request ), (const uint8_t *)query->request );
+		pinger->sendBudget -= 1.0;
+	}
+}
+
+/*
+* CL_PingerCheckTimeouts
+*/
+static void CL_PingerCheckTimeouts( int64_t now ) {
+	int i;
+
+	for( i = 0; i < PINGER_MAX_SENT && pinger->numSent > 0; i++ ) {
+		if( pinger->sent[i].sendTime && pinger->sent[i].sendTime + PINGER_TIMEOUT_MSEC < now ) {
+			pinger->sent[i].sendTime = 0;
+			pinger->numSent--;
+		}
+	}
+}
+
+/*
+* CL_PingerReadPackets
+*/
+static void CL_PingerReadPackets( const socket_t *socket ) {
+	int i;
+	int64_t now;
+	msg_t msg;
+	uint8_t msgData[MAX_MSGLEN];
+	netadr_t address;
+	const char *s;
+	pingerSent_t *sent;
+	pingerResultCmd_t cmd;
+
+	MSG_Init( &msg, msgData, sizeof( msgData ) );
+
+	while( socket->open && NET_GetPacket( socket, &address, &msg ) > 0 ) {
+		now = Sys_Milliseconds();
+
+		MSG_BeginReading( &msg );
+		if( msg.cursize < 4 || MSG_ReadInt32( &msg ) != -1 ) {
+			continue;
+		}
+
+		s = MSG_ReadStringLine( &msg );
+		if( strcmp( s, "info" ) ) {
+			continue;
+		}
+
+		for( i = 0, sent = pinger->sent; i < PINGER_MAX_SENT; i++, sent++ ) {
+			if( sent->sendTime && NET_CompareAddress( &sent->address, &address ) ) {
+				break;
+			}
+		}
+		if( i == PINGER_MAX_SENT ) {
+			// timed out or unsolicited
+			continue;
+		}
+
+		cmd.id = PINGER_CMD_RESULT;
+		cmd.ping = (int)( now - sent->sendTime );
+		Q_strncpyz( cmd.address, NET_AddressToString( &address ), sizeof( cmd.address ) );
+		Q_strncpyz( cmd.info, MSG_ReadString( &msg ), sizeof( cmd.info ) );
+
+		sent->sendTime = 0;
+		pinger->numSent--;
+
+		QBufPipe_WriteCmd( pinger->results, &cmd, PINGER_RESULT_CMD_SIZE( strlen( cmd.info ) ) );
+	}
+}
+
+/*
+* CL_PingerThreadFunc
+*/
+static void *CL_PingerThreadFunc( void *param ) {
+	int numSockets = 0;
+	socket_t *sockets[3];
+
+	sockets[numSockets++] = &pinger->socket_udp;
+	if( pinger->socket_udp6.open ) {
+		sockets[numSockets++] = &pinger->socket_udp6;
+	}
+	sockets[numSockets] = NULL;
+
+	pinger->lastSendTime = Sys_Milliseconds();
+
+	while( QBufPipe_ReadCmds( pinger->queries, pingerCmdHandlers ) >= 0 ) {
+		int64_t now = Sys_Milliseconds();
+
+		CL_PingerCheckTimeouts( now );
+		CL_PingerSendQueries( now );
+
+		// wakes up early on incoming packets
+		NET_Sleep( PINGER_TICK_MSEC, sockets );
+
+		CL_PingerReadPackets( &pinger->socket_udp );
+		CL_PingerReadPackets( &pinger->socket_udp6 );
+	}
+
+	return NULL;
+}
+
+/*
+* CL_InitServerPinger
+*
+* Pings are sent from the main thread if this fails
+*/
+static void CL_InitServerPinger( void ) {
+	netadr_t address;
+
+	cl_pingrate = Cvar_Get( "cl_pingrate", "200", CVAR_ARCHIVE );
+
+	pinger = Mem_ZoneMalloc( sizeof( *pinger ) );
+
+	// replies come to these, not to the client sockets
+	NET_InitAddress( &address, NA_IP );
+	if( !NET_OpenSocket( &pinger->socket_udp, SOCKET_UDP, &address, false ) ) {
+		Com_Printf( "Couldn't open server pinger socket: %s\n", NET_ErrorString() );
+		Mem_ZoneFree( pinger );
+		pinger = NULL;
+		return;
+	}
+
+	NET_InitAddress( &address, NA_IP6 );
+	if( !NET_OpenSocket( &pinger->socket_udp6, SOCKET_UDP, &address, false ) ) {
+		Com_DPrintf( "Couldn't open IPv6 server pinger socket: %s\n", NET_ErrorString() );
+	}
+
+	pinger->queries = QBufPipe_Create( 0x10000, 1 );
+	pinger->results = QBufPipe_Create( 0x40000, 0 );
+	pinger->thread = QThread_Create( CL_PingerThreadFunc, NULL );
+}
+
+/*
+* CL_ShutdownServerPinger
+*/
+static void CL_ShutdownServerPinger( void ) {
+	int cmd = PINGER_CMD_SHUTDOWN;
+
+	if( !pinger ) {
+		return;
+	}
+
+	if( pinger->thread ) {
+		QBufPipe_WriteCmd( pinger->queries, &cmd, sizeof( cmd ) );
+		QThread_Join( pinger->thread );
+	}
+
+	QBufPipe_Destroy( &pinger->queries );
+	QBufPipe_Destroy( &pinger->results );
+
+	NET_CloseSocket( &pinger->socket_udp );
+	NET_CloseSocket( &pinger->socket_udp6 );
+
+	Mem_ZoneFree( pinger );
+	pinger = NULL;
+}
+
+/*
+* CL_PingerQueueQuery
+*/
+static bool CL_PingerQueueQuery( const netadr_t *address, const char *request ) {
+	pingerQueryCmd_t cmd;
+
+	if( !pinger || !pinger->thread ) {
+		return false;
+	}
+
+	cmd.id = PINGER_CMD_QUERY;
+	cmd.address = *address;
+	Q_strncpyz( cmd.request, request, sizeof( cmd.request ) );
+
+	QBufPipe_WriteCmd( pinger->queries, &cmd, sizeof( cmd ) );
+	return true;
+}
+
+/*
+* CL_PingerFrame
+*/
+static void CL_PingerFrame( void ) {
+	if( pinger ) {
+		QBufPipe_ReadCmds( pinger->results, pingerResultHandlers );
+	}
+}
+
+//=========================================================
+
 /*
 * CL_ParseGetInfoResponse
 *
@@ -315,28 +666,21 @@ void CL_QueryGetStatusMessage_f( void ) {
 }
 
 /*
-* CL_PingServer_f
+* CL_PingServer
 */
-void CL_PingServer_f( void ) {
-	char *address_string;
+static void CL_PingServer( const char *address_string ) {
 	char requestString[64];
 	netadr_t adr;
 	serverlist_t *pingserver;
 	socket_t *socket;
 
-	if( Cmd_Argc() < 2 ) {
-		Com_Printf( "Usage: pingserver [ip:port]\n" );
-	}
-
-	address_string = Cmd_Argv( 1 );
-
 	if( !NET_StringToAddress( address_string, &adr ) ) {
 		return;
 	}
 
-	pingserver = CL_ServerFindInList( masterList, address_string );
+	pingserver = CL_ServerFindInList( masterList, (char *)address_string );
 	if( !pingserver ) {
-		pingserver = CL_ServerFindInList( favoritesList, address_string );
+		pingserver = CL_ServerFindInList( favoritesList, (char *)address_string );
 	}
 	if( !pingserver ) {
 		return;
@@ -353,10 +697,30 @@ void CL_PingServer_f( void ) {
 				 filter_allow_full ? "full" : "",
 				 filter_allow_empty ? "empty" : "" );
 
+	if( CL_PingerQueueQuery( &adr, requestString ) ) {
+		return;
+	}
+
 	socket = ( adr.type == NA_IP6 ? &cls.socket_udp6 : &cls.socket_udp );
 	Netchan_OutOfBandPrint( socket, &adr, "%s", requestString );
 }
 
+/*
+* CL_PingServer_f - pingserver 83.97.146.17:27911 [...]
+*/
+void CL_PingServer_f( void ) {
+	int i;
+
+	if( Cmd_Argc() < 2 ) {
+		Com_Printf( "Usage: pingserver [ip:port] ...\n" );
+		return;
+	}
+
+	for( i = 1; i < Cmd_Argc(); i++ ) {
+		CL_PingServer( Cmd_Argv( i ) );
+	}
+}
+
 /*
 * CL_ParseStatusMessage
 * Handle a reply from a ping
@@ -697,6 +1061,8 @@ void CL_ServerListFrame( void ) {
 	int i;
 	masterserver_t *master;
 
+	CL_PingerFrame();
+
 	for( i = 0, master = masterServers; i < numMasterServers; i++, master++ ) {
 		if( !master->delayedRequestModName[0] || master->resolverActive ) {
 			continue;
@@ -719,6 +1085,8 @@ void CL_InitServerList( void ) {
 //	CL_ReadServerCache();
 
 	CL_MasterAddressCache_Init();
+
+	CL_InitServerPinger();
 }
 
 /*
@@ -727,6 +1095,8 @@ void CL_InitServerList( void ) {
 void CL_ShutDownServerList( void ) {
 //	CL_WriteServerCache();
 
+	CL_ShutdownServerPinger();
+
 	CL_FreeServerlist( &masterList );
 	CL_FreeServerlist( &favoritesList );
 
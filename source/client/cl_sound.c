@@ -274,6 +274,7 @@ void CL_SoundModule_Init( bool verbose ) {
 	import.Mutex_Destroy = QMutex_Destroy;
 	import.Mutex_Lock = QMutex_Lock;
 	import.Mutex_Unlock = QMutex_Unlock;
+	import.Atomic_CAS = QAtomic_CAS;
 
 	import.BufPipe_Create = QBufPipe_Create;
 	import.BufPipe_Destroy = QBufPipe_Destroy;
@@ -379,7 +380,9 @@ void CL_SoundModule_SetEntitySpatilization( int entNum, vec3_t origin, vec3_t ve
 void CL_SoundModule_Update( const vec3_t origin, const vec3_t velocity, const mat3_t axis,
 							const char *identity, bool avidump ) {
 	if( se ) {
+		Prof_Begin( "S_Update" );
 		se->Update( origin, velocity, axis, avidump );
+		Prof_End( "S_Update" );
 	}
 }
 
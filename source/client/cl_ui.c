@@ -216,6 +216,7 @@ void CL_UIModule_Init( void ) {
 	import.CL_IsBrowserAvailable = CL_IsBrowserAvailable;
 	import.CL_OpenURLInBrowser = CL_OpenURLInBrowser;
 	import.CL_ReadDemoMetaData = CL_ReadDemoMetaData;
+	import.CL_IndexDemos = CL_DemoIndex_Scan;
 	import.CL_PlayerNum = CL_UIModule_PlayerNum;
 
 	import.Key_GetBindingBuf = Key_GetBindingBuf;
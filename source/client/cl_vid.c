@@ -401,6 +401,10 @@ static bool VID_LoadRefresh( const char *name ) {
 	import.Mutex_Destroy = QMutex_Destroy;
 	import.Mutex_Lock = QMutex_Lock;
 	import.Mutex_Unlock = QMutex_Unlock;
+	import.CondVar_Create = QCondVar_Create;
+	import.CondVar_Destroy = QCondVar_Destroy;
+	import.CondVar_Wait = QCondVar_Wait;
+	import.CondVar_Wake = QCondVar_Wake;
 
 	import.BufPipe_Create = QBufPipe_Create;
 	import.BufPipe_Destroy = QBufPipe_Destroy;
@@ -409,6 +413,12 @@ static bool VID_LoadRefresh( const char *name ) {
 	import.BufPipe_ReadCmds = QBufPipe_ReadCmds;
 	import.BufPipe_Wait = QBufPipe_Wait;
 
+	import.Prof_SetThreadName = Prof_SetThreadName;
+	import.Prof_ReleaseThread = Prof_ReleaseThread;
+	import.Prof_Begin = Prof_Begin;
+	import.Prof_End = Prof_End;
+	import.Prof_Mark = Prof_Mark;
+
 	file_size = strlen( LIB_DIRECTORY "/" LIB_PREFIX ) + strlen( name ) + strlen( LIB_SUFFIX ) + 1;
 	file = Mem_TempMalloc( file_size );
 	Q_snprintfz( file, file_size, LIB_DIRECTORY "/" LIB_PREFIX "%s" LIB_SUFFIX, name );
@@ -199,6 +199,12 @@ typedef struct {
 
 	char meta_data[SNAP_MAX_DEMO_META_DATA_SIZE];
 	size_t meta_data_realsize;
+
+	bool keyframe;          // the message being recorded holds a keyframe
+	const snapshot_t *keyframeSnap;  // delta frame to write out in full for the keyframe
+	bool keyframePending;   // the last keyframe is dropped unless the next frame deltas from it
+	int64_t keyframeTime, nextKeyframeTime, keyframeFrame;
+	snapDemoIndex_t index;
 } cl_demo_t;
 
 typedef cl_demo_t demorec_t;
@@ -539,10 +545,19 @@ char **CL_DemoComplete( const char *partial );
 #define CL_WriteAvi() ( cls.demo.avi && cls.state == CA_ACTIVE && cls.demo.playing && !cls.demo.play_jump )
 #define CL_SetDemoMetaKeyValue( k,v ) cls.demo.meta_data_realsize = SNAP_SetDemoMetaKeyValue( cls.demo.meta_data, sizeof( cls.demo.meta_data ), cls.demo.meta_data_realsize, k, v )
 
+//
+// cl_demoindex.c
+//
+void CL_DemoIndex_Init( void );
+void CL_DemoIndex_Shutdown( void );
+void CL_DemoIndex_Scan( const char *dir );
+bool CL_DemoIndex_ReadMetaData( const char *filename, char *meta_data, size_t meta_data_size, size_t *meta_data_realsize );
+
 //
 // cl_parse.c
 //
 void CL_ParseServerMessage( msg_t *msg );
+void CL_UpdateConfigString( int idx, const char *s );
 #define SHOWNET( msg,s ) _SHOWNET( msg,s,cl_shownet->integer );
 
 void CL_FreeDownloadList( void );
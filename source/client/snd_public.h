@@ -20,7 +20,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 // snd_public.h -- sound dll information visible to engine
 
-#define SOUND_API_VERSION   40
+#define SOUND_API_VERSION   41
 
 #define ATTN_NONE 0
 
@@ -100,6 +100,7 @@ typedef struct {
 	void ( *Mutex_Destroy )( struct qmutex_s **mutex );
 	void ( *Mutex_Lock )( struct qmutex_s *mutex );
 	void ( *Mutex_Unlock )( struct qmutex_s *mutex );
+	bool ( *Atomic_CAS )( volatile int *value, int oldval, int newval, struct qmutex_s *mutex );
 
 	struct qbufPipe_s *( *BufPipe_Create )( size_t bufSize, int flags );
 	void ( *BufPipe_Destroy )( struct qbufPipe_s **pqueue );
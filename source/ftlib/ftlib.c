@@ -42,12 +42,48 @@ static qfontfamily_t *fontFamilies;
 #define QFTGLYPH_SEARCHED_FALLBACK  ( 1 << 1 )  // the fallback font has been searched for the gindex
 #define QFTGLYPH_FROM_FALLBACK      ( 1 << 2 )  // the fallback gindex should be used
 
+#define QFT_GLYPH_PIPE_SIZE         0x10000
+
+#define QFT_CACHE_DIR               "cache/fonts"
+#define QFT_CACHE_EXTENSION         ".glyphs"
+#define QFT_CACHE_MAGIC             ( 'F' | ( 'T' << 8 ) | ( 'G' << 16 ) | ( 'C' << 24 ) )
+#define QFT_CACHE_VERSION           1
+#define QFT_CACHE_HASH_BYTES        0x10000     // bytes hashed at each end of the font file
+
 static uint8_t *qftGlyphTempBitmap;
 static unsigned int qftGlyphTempBitmapHeight;
 #define QFT_GLYPH_BITMAP_HEIGHT_INCREMENT 64 // must be a power of two
 
 FT_Library ftLibrary = NULL;
 
+static cvar_t *ftlib_glyphcache;
+
+// FreeType objects are shared with the rasterizer thread, so they are only used under the lock
+static qmutex_t *qftLock;
+static qbufPipe_t *qftGlyphPipe;
+static qthread_t *qftGlyphThread;
+static volatile bool qftUploadsPending;
+
+enum {
+	QFT_CMD_RASTERIZE,
+	QFT_CMD_SHUTDOWN,
+
+	QFT_NUM_CMDS
+};
+
+typedef unsigned (*queueCmdHandler_t)( const void * );
+
+typedef struct {
+	int id;
+	struct qfontface_s *qfont;
+	FT_Size ftsize;
+	FT_UInt gindex;
+	unsigned int shaderNum;
+	int x, y;               // top left corner of the margin around the glyph in the image
+	int width, height;      // space reserved for the bitmap, without the margin
+	int left, top;          // expected position of the bitmap relative to the pen
+} qftRasterizeCmd_t;
+
 typedef struct qftfallback_s {
 	FT_Size ftsize;
 	unsigned int size;
@@ -56,16 +92,57 @@ typedef struct qftfallback_s {
 
 typedef struct {
 	FT_Byte *file;
+	size_t fileSize;
+	unsigned int fileHash;
 	FT_Face ftface;
 	qftfallback_t *fallbacks;
 } qftfamily_t;
 
+typedef struct {
+	int x1, y1, x2, y2;
+} qftrect_t;
+
+typedef struct {
+	wchar_t num;
+	unsigned int flags;
+	FT_UInt gindex;
+	unsigned short width, height;
+	unsigned short x_advance;
+	short x_offset, y_offset;
+	unsigned int shaderNum;
+	float s1, t1, s2, t2;
+} qftcacheglyph_t;
+
+typedef struct {
+	int magic;
+	int version;
+	unsigned int fileSize, fileHash;
+	unsigned int fallbackFileSize, fallbackFileHash;
+	char fallbackName[64];
+	unsigned int shaderWidth, shaderHeight;
+	unsigned int numShaders;
+	unsigned int imageCurX, imageCurY, imageCurLineHeight;
+	unsigned int numGlyphs;
+} qftcacheheader_t;
+
 typedef struct {
 	unsigned int imageCurX, imageCurY, imageCurLineHeight;
 
 	FT_Size ftsize, ftfallbacksize;
 	qfontfamily_t *fallbackFamily;
 	bool fallbackLoaded;
+
+	// copies of the font images, the rasterizer thread draws the glyphs there
+	// and the parts that have changed are uploaded once per frame
+	uint8_t **images;
+	qftrect_t *dirty;
+
+	// glyphs have been added since the face has been loaded
+	bool cacheModified;
+
+	// cached glyphs from the fallback family, added once the fallback is set
+	qftcacheheader_t *cachedFallback;
+	qftcacheglyph_t *cachedFallbackGlyphs;
 } qftface_t;
 
 typedef struct {
@@ -89,6 +166,7 @@ static FT_Error (*q_FT_New_Memory_Face)( FT_Library library, const FT_Byte* file
 static FT_Error (*q_FT_Done_Face)( FT_Face face );
 static FT_Error (*q_FT_Init_FreeType)( FT_Library  *alibrary );
 static FT_Error (*q_FT_Done_FreeType)( FT_Library library );
+static void (*q_FT_Outline_Get_CBox)( const FT_Outline *outline, FT_BBox *acbox );
 #ifdef FT_MULFIX_INLINED
 #define q_FT_MulFix FT_MulFix
 #else
@@ -108,6 +186,7 @@ static dllfunc_t freetypefuncs[] =
 	{ "FT_Done_Face", ( void **)&q_FT_Done_Face },
 	{ "FT_Init_FreeType", ( void **)&q_FT_Init_FreeType },
 	{ "FT_Done_FreeType", ( void **)&q_FT_Done_FreeType },
+	{ "FT_Outline_Get_CBox", ( void **)&q_FT_Outline_Get_CBox },
 #ifndef FT_MULFIX_INLINED
 	{ "FT_MulFix", ( void **)&q_FT_MulFix },
 #endif
@@ -127,6 +206,7 @@ static dllfunc_t freetypefuncs[] =
 #define q_FT_Done_Face FT_Done_Face
 #define q_FT_Init_FreeType FT_Init_FreeType
 #define q_FT_Done_FreeType FT_Done_FreeType
+#define q_FT_Outline_Get_CBox FT_Outline_Get_CBox
 #define q_FT_MulFix FT_MulFix
 
 #endif
@@ -194,44 +274,64 @@ static qftfallback_t *QFT_GetFallbackFace( qfontfamily_t *qfamily, unsigned int
 }
 
 /*
-* QFT_GetGlyph
+* QFT_LoadFallbackFace
 */
-static qglyph_t *QFT_GetGlyph( qfontface_t *qfont, void *glyphArray, unsigned int numInArray, wchar_t num ) {
-	qftglyph_t *qftglyph = &( ( ( qftglyph_t * )glyphArray )[numInArray] );
+static void QFT_LoadFallbackFace( qfontface_t *qfont ) {
 	qftface_t *qttf = ( ( qftface_t * )( qfont->facedata ) );
+	qftfallback_t *fallback;
 
-	if( !qftglyph->gindex ) {
-		if( !( qftglyph->flags & QFTGLYPH_SEARCHED_MAIN ) ) {
-			qftglyph->flags |= QFTGLYPH_SEARCHED_MAIN;
-			qftglyph->gindex = q_FT_Get_Char_Index( qttf->ftsize->face, num );
-			if( qftglyph->gindex ) {
-				return &( qftglyph->qglyph );
-			}
-		}
+	if( qttf->fallbackLoaded ) {
+		return;
+	}
 
-		if( qttf->fallbackFamily ) {
-			if( !qttf->fallbackLoaded ) {
-				qftfallback_t *fallback;
+	qttf->fallbackLoaded = true;
 
-				qttf->fallbackLoaded = true;
+	fallback = QFT_GetFallbackFace( qttf->fallbackFamily, qfont->size );
+	if( !fallback ) {
+		return;
+	}
+	qttf->ftfallbacksize = fallback->ftsize;
+	qfont->hasKerning |= ( FT_HAS_KERNING( qttf->ftfallbacksize->face ) ? true : false );
+}
 
-				fallback = QFT_GetFallbackFace( qttf->fallbackFamily, qfont->size );
-				if( !fallback ) {
-					return NULL;
-				}
-				qttf->ftfallbacksize = fallback->ftsize;
-				qfont->hasKerning |= ( FT_HAS_KERNING( qttf->ftfallbacksize->face ) ? true : false );
-			}
+/*
+* QFT_FindGlyphIndex
+*/
+static void QFT_FindGlyphIndex( qfontface_t *qfont, qftglyph_t *qftglyph, wchar_t num ) {
+	qftface_t *qttf = ( ( qftface_t * )( qfont->facedata ) );
 
-			if( qttf->ftfallbacksize && !( qftglyph->flags & QFTGLYPH_SEARCHED_FALLBACK ) ) {
-				qftglyph->flags |= QFTGLYPH_SEARCHED_FALLBACK;
-				qftglyph->gindex = q_FT_Get_Char_Index( qttf->ftfallbacksize->face, num );
-				if( qftglyph->gindex ) {
-					qftglyph->flags |= QFTGLYPH_FROM_FALLBACK;
-				}
+	if( !( qftglyph->flags & QFTGLYPH_SEARCHED_MAIN ) ) {
+		qftglyph->flags |= QFTGLYPH_SEARCHED_MAIN;
+		qftglyph->gindex = q_FT_Get_Char_Index( qttf->ftsize->face, num );
+		if( qftglyph->gindex ) {
+			return;
+		}
+	}
+
+	if( qttf->fallbackFamily ) {
+		QFT_LoadFallbackFace( qfont );
+
+		if( qttf->ftfallbacksize && !( qftglyph->flags & QFTGLYPH_SEARCHED_FALLBACK ) ) {
+			qftglyph->flags |= QFTGLYPH_SEARCHED_FALLBACK;
+			qftglyph->gindex = q_FT_Get_Char_Index( qttf->ftfallbacksize->face, num );
+			if( qftglyph->gindex ) {
+				qftglyph->flags |= QFTGLYPH_FROM_FALLBACK;
 			}
 		}
 	}
+}
+
+/*
+* QFT_GetGlyph
+*/
+static qglyph_t *QFT_GetGlyph( qfontface_t *qfont, void *glyphArray, unsigned int numInArray, wchar_t num ) {
+	qftglyph_t *qftglyph = &( ( ( qftglyph_t * )glyphArray )[numInArray] );
+
+	if( !qftglyph->gindex ) {
+		trap_Mutex_Lock( qftLock );
+		QFT_FindGlyphIndex( qfont, qftglyph, num );
+		trap_Mutex_Unlock( qftLock );
+	}
 
 	return qftglyph->gindex ? &( qftglyph->qglyph ) : NULL;
 }
@@ -272,31 +372,224 @@ static int QFT_GetKerning( qfontface_t *qfont, qglyph_t *g1_, qglyph_t *g2_ ) {
 
 	qttf = ( qftface_t * )( qfont->facedata );
 	ftsize = ( ( g1->flags & QFTGLYPH_FROM_FALLBACK ) ? qttf->ftfallbacksize : qttf->ftsize );
+	trap_Mutex_Lock( qftLock );
 	q_FT_Activate_Size( ftsize );
 	q_FT_Get_Kerning( ftsize->face, gi1, gi2, FT_KERNING_DEFAULT, &kvec );
+	trap_Mutex_Unlock( qftLock );
 	return kvec.x >> 6;
 }
 
 /*
-* QFT_UploadRenderedGlyphs
+* QFT_AddImage
+*
+* Adds an image for the glyphs that don't fit into the previous ones, optionally with
+* the pixels read from the glyph cache.
+*/
+static struct shader_s *QFT_AddImage( qfontface_t *qfont, const uint8_t *data, unsigned int rows ) {
+	qftface_t *qttf = ( qftface_t * )( qfont->facedata );
+	unsigned int shaderNum = qfont->numShaders;
+	size_t imageSize = qfont->shaderWidth * qfont->shaderHeight;
+	uint8_t *image;
+
+	image = FTLIB_Alloc( ftlibPool, imageSize );
+	if( data ) {
+		memcpy( image, data, min( rows, qfont->shaderHeight ) * qfont->shaderWidth );
+	}
+
+	// the rasterizer thread may be drawing into the other images
+	trap_Mutex_Lock( qftLock );
+	qttf->images = FTLIB_Realloc( qttf->images, ( shaderNum + 1 ) * sizeof( *qttf->images ) );
+	qttf->images[shaderNum] = image;
+	qttf->dirty = FTLIB_Realloc( qttf->dirty, ( shaderNum + 1 ) * sizeof( *qttf->dirty ) );
+	memset( &qttf->dirty[shaderNum], 0, sizeof( qttf->dirty[shaderNum] ) );
+	trap_Mutex_Unlock( qftLock );
+
+	qfont->shaders = FTLIB_Realloc( qfont->shaders, ( shaderNum + 1 ) * sizeof( struct shader_s * ) );
+	qfont->shaders[shaderNum] = trap_R_RegisterRawAlphaMask( FTLIB_FontShaderName( qfont, shaderNum ),
+															 qfont->shaderWidth, qfont->shaderHeight, image );
+	qfont->numShaders++;
+
+	return qfont->shaders[shaderNum];
+}
+
+/*
+* QFT_HandleRasterizeCmd
+*
+* Renders the glyph into the space reserved for it in the font image.
 */
-static void QFT_UploadRenderedGlyphs( uint8_t *pic, struct shader_s *shader, int x, int y, int src_width, int width, int height ) {
-	int i;
-	const uint8_t *src = pic;
-	uint8_t *dest = pic;
+static unsigned QFT_HandleRasterizeCmd( const void *pcmd ) {
+	const qftRasterizeCmd_t *cmd = pcmd;
+	qftface_t *qttf = ( qftface_t * )( cmd->qfont->facedata );
+	unsigned int shaderWidth = cmd->qfont->shaderWidth;
+	FT_GlyphSlot ftglyph;
+	FT_Error fterror;
+	int x, y, dx, dy;
+	int srcStride, pixelMode;
+	const uint8_t *src;
+	uint8_t *dest;
+	qftrect_t *dirty;
+
+	trap_Mutex_Lock( qftLock );
+
+	q_FT_Activate_Size( cmd->ftsize );
+	fterror = q_FT_Load_Glyph( cmd->ftsize->face, cmd->gindex, FT_LOAD_RENDER | FT_LOAD_TARGET_NORMAL );
+	if( fterror ) {
+		trap_Mutex_Unlock( qftLock );
+		return sizeof( *cmd );
+	}
+	ftglyph = cmd->ftsize->face->glyph;
+
+	pixelMode = ftglyph->bitmap.pixel_mode;
+	srcStride = ftglyph->bitmap.pitch;
 
-	if( !width || !height ) {
+	// the bitmap is expected where its bounding box has been predicted, clip it otherwise
+	dx = ftglyph->bitmap_left - cmd->left;
+	dy = cmd->top - ftglyph->bitmap_top;
+
+	src = ftglyph->bitmap.buffer;
+	for( y = 0; y < (int)ftglyph->bitmap.rows; y++, src += srcStride ) {
+		if( y + dy < 0 || y + dy >= cmd->height ) {
+			continue;
+		}
+
+		dest = qttf->images[cmd->shaderNum] + ( cmd->y + 1 + y + dy ) * shaderWidth + cmd->x + 1 + dx;
+		for( x = 0; x < (int)ftglyph->bitmap.width; x++ ) {
+			if( x + dx < 0 || x + dx >= cmd->width ) {
+				continue;
+			}
+
+			switch( pixelMode ) {
+				case FT_PIXEL_MODE_MONO:
+					dest[x] = ( ( ( ( unsigned int )( src[x >> 3] ) ) >> ( 7 - ( x & 7 ) ) ) & 1 ) * 255;
+					break;
+				case FT_PIXEL_MODE_GRAY:
+					dest[x] = src[x];
+					break;
+				default:
+					// shouldn't happen actually, but make it a valid glyph anyway
+					dest[x] = 255;
+					break;
+			}
+		}
+	}
+
+	dirty = &qttf->dirty[cmd->shaderNum];
+	if( dirty->x2 <= dirty->x1 ) {
+		dirty->x1 = cmd->x;
+		dirty->y1 = cmd->y;
+		dirty->x2 = cmd->x + cmd->width + 2;
+		dirty->y2 = cmd->y + cmd->height + 2;
+	} else {
+		dirty->x1 = min( dirty->x1, cmd->x );
+		dirty->y1 = min( dirty->y1, cmd->y );
+		dirty->x2 = max( dirty->x2, cmd->x + cmd->width + 2 );
+		dirty->y2 = max( dirty->y2, cmd->y + cmd->height + 2 );
+	}
+	qftUploadsPending = true;
+
+	trap_Mutex_Unlock( qftLock );
+
+	return sizeof( *cmd );
+}
+
+/*
+* QFT_HandleShutdownCmd
+*/
+static unsigned QFT_HandleShutdownCmd( const void *pcmd ) {
+	return 0;
+}
+
+/*
+* QFT_GlyphCmdsWaiter
+*/
+static int QFT_GlyphCmdsWaiter( qbufPipe_t *queue, queueCmdHandler_t *cmdHandlers, bool timeout ) {
+	return trap_BufPipe_ReadCmds( queue, cmdHandlers );
+}
+
+/*
+* QFT_GlyphThreadProc
+*/
+static void *QFT_GlyphThreadProc( void *param ) {
+	queueCmdHandler_t cmdHandlers[QFT_NUM_CMDS] =
+	{
+		(queueCmdHandler_t)QFT_HandleRasterizeCmd,
+		(queueCmdHandler_t)QFT_HandleShutdownCmd,
+	};
+
+	trap_BufPipe_Wait( param, QFT_GlyphCmdsWaiter, cmdHandlers, Q_THREADS_WAIT_INFINITE );
+
+	return NULL;
+}
+
+/*
+* QFT_FinishGlyphs
+*
+* Waits for the rasterizer thread to render all requested glyphs.
+*/
+static void QFT_FinishGlyphs( void ) {
+	if( qftGlyphPipe ) {
+		trap_BufPipe_Finish( qftGlyphPipe );
+	}
+}
+
+/*
+* QFT_UploadGlyphs
+*
+* Uploads the parts of the font images the rasterizer thread has drawn to.
+*/
+static void QFT_UploadGlyphs( void ) {
+	unsigned int i;
+	int y, width, height;
+	qfontfamily_t *qfamily;
+	qfontface_t *qface;
+	qftface_t *qttf;
+	qftrect_t *dirty;
+
+	if( !qftUploadsPending ) {
 		return;
 	}
 
-	for( i = 0; i < height; i++, src += src_width, dest += width ) {
-		memmove( dest, src, width );
+	trap_Mutex_Lock( qftLock );
+
+	qftUploadsPending = false;
+
+	for( qfamily = fontFamilies; qfamily; qfamily = qfamily->next ) {
+		for( qface = qfamily->faces; qface; qface = qface->next ) {
+			qttf = ( qftface_t * )( qface->facedata );
+
+			for( i = 0; i < qface->numShaders; i++ ) {
+				dirty = &qttf->dirty[i];
+				if( dirty->x2 <= dirty->x1 ) {
+					continue;
+				}
+
+				width = dirty->x2 - dirty->x1;
+				height = dirty->y2 - dirty->y1;
+				if( (unsigned int)height > qftGlyphTempBitmapHeight ) {
+					qftGlyphTempBitmapHeight = Q_ALIGN( height, QFT_GLYPH_BITMAP_HEIGHT_INCREMENT );
+					qftGlyphTempBitmap = FTLIB_Realloc( qftGlyphTempBitmap, FTLIB_FONT_MAX_IMAGE_WIDTH * qftGlyphTempBitmapHeight );
+				}
+
+				for( y = 0; y < height; y++ ) {
+					memcpy( qftGlyphTempBitmap + y * width,
+							qttf->images[i] + ( dirty->y1 + y ) * qface->shaderWidth + dirty->x1, width );
+				}
+				trap_R_ReplaceRawSubPic( qface->shaders[i], dirty->x1, dirty->y1, width, height, qftGlyphTempBitmap );
+
+				memset( dirty, 0, sizeof( *dirty ) );
+			}
+		}
 	}
-	trap_R_ReplaceRawSubPic( shader, x, y, width, height, pic );
+
+	trap_Mutex_Unlock( qftLock );
 }
 
 /*
 * QFT_RenderString
+*
+* Reserves space in the font images for the glyphs of the string that haven't been
+* rendered yet. The glyphs are rendered by the rasterizer thread and show up once
+* the images are uploaded at the beginning of the next frame.
 */
 static void QFT_RenderString( qfontface_t *qfont, const char *str ) {
 	int gc;
@@ -307,20 +600,16 @@ static void QFT_RenderString( qfontface_t *qfont, const char *str ) {
 	FT_Error fterror;
 	FT_Size ftsize;
 	FT_GlyphSlot ftglyph;
-	FT_UInt pixelMode;
-	int srcStride = 0;
+	FT_BBox cbox;
+	FT_Pos advance;
+	int left, top;
 	unsigned int bitmapWidth, bitmapHeight;
-	unsigned int tempWidth = 0, tempLineHeight = 0;
 	struct shader_s *shader = qfont->shaders[qfont->numShaders - 1];
-	int shaderNum;
-	int x, y;
-	uint8_t *src, *dest;
+	qftRasterizeCmd_t cmd;
 
 	for( ; ; ) {
 		gc = Q_GrabWCharFromColorString( &str, &num, NULL );
 		if( gc == GRABCHAR_END ) {
-			QFT_UploadRenderedGlyphs( qftGlyphTempBitmap, shader, qttf->imageCurX, qttf->imageCurY, qfont->shaderWidth, tempWidth, tempLineHeight );
-			qttf->imageCurX += tempWidth;
 			break;
 		}
 
@@ -334,38 +623,44 @@ static void QFT_RenderString( qfontface_t *qfont, const char *str ) {
 		}
 
 		qglyph = &( qftglyph->qglyph );
-		if( qglyph->shader ) {
-			continue;
-		}
 
 		// from now, it is assumed that the current glyph's shader will be valid after this function
 		// so if continue is used, any shader, even an empty one, should be assigned to the glyph
 
+		// only load the outline to get the size of the bitmap, rendering is left to the rasterizer thread
+		trap_Mutex_Lock( qftLock );
 		ftsize = ( ( qftglyph->flags & QFTGLYPH_FROM_FALLBACK ) ? qttf->ftfallbacksize : qttf->ftsize );
 		q_FT_Activate_Size( ftsize );
-		fterror = q_FT_Load_Glyph( ftsize->face, qftglyph->gindex, FT_LOAD_RENDER | FT_LOAD_TARGET_NORMAL );
+		fterror = q_FT_Load_Glyph( ftsize->face, qftglyph->gindex, FT_LOAD_TARGET_NORMAL );
 		if( fterror ) {
-			Com_Printf( S_COLOR_YELLOW "Warning: Failed to load and render glyph %i for '%s', error %i\n",
+			trap_Mutex_Unlock( qftLock );
+			Com_Printf( S_COLOR_YELLOW "Warning: Failed to load glyph %i for '%s', error %i\n",
 						num, qfont->family->name, fterror );
 			qglyph->shader = shader;
 			continue;
 		}
 		ftglyph = ftsize->face->glyph;
 
-		pixelMode = ftglyph->bitmap.pixel_mode;
-		switch( pixelMode ) {
-			case FT_PIXEL_MODE_MONO:
-				srcStride = Q_ALIGN( ftglyph->bitmap.width, 8 ) >> 3;
-				break;
-			case FT_PIXEL_MODE_GRAY:
-				srcStride = ftglyph->bitmap.width;
-				break;
-			default:
-				assert( 0 );
+		advance = ftglyph->advance.x;
+		if( ftglyph->format == FT_GLYPH_FORMAT_OUTLINE ) {
+			// the same rounding as when the outline is rendered
+			q_FT_Outline_Get_CBox( &ftglyph->outline, &cbox );
+			cbox.xMin &= ~63;
+			cbox.yMin &= ~63;
+			cbox.xMax = ( cbox.xMax + 63 ) & ~63;
+			cbox.yMax = ( cbox.yMax + 63 ) & ~63;
+			left = cbox.xMin >> 6;
+			top = cbox.yMax >> 6;
+			bitmapWidth = ( ( cbox.xMax - cbox.xMin ) >> 6 ) + 2;
+			bitmapHeight = ( ( cbox.yMax - cbox.yMin ) >> 6 ) + 2;
+		} else {
+			left = ftglyph->bitmap_left;
+			top = ftglyph->bitmap_top;
+			bitmapWidth = ftglyph->bitmap.width + 2;
+			bitmapHeight = ftglyph->bitmap.rows + 2;
 		}
+		trap_Mutex_Unlock( qftLock );
 
-		bitmapWidth = ftglyph->bitmap.width + 2;
-		bitmapHeight = ftglyph->bitmap.rows + 2;
 		if( bitmapWidth > qfont->shaderWidth ) {
 			Com_Printf( S_COLOR_YELLOW "Warning: Width limit exceeded for '%s' character %i - %i\n",
 						qfont->family->name, num, bitmapWidth - 2 );
@@ -377,88 +672,396 @@ static void QFT_RenderString( qfontface_t *qfont, const char *str ) {
 			bitmapHeight = qfont->shaderHeight;
 		}
 
-		if( ( qttf->imageCurX + tempWidth + bitmapWidth ) > qfont->shaderWidth ) {
-			QFT_UploadRenderedGlyphs( qftGlyphTempBitmap, shader, qttf->imageCurX, qttf->imageCurY, qfont->shaderWidth, tempWidth, tempLineHeight );
-			tempWidth = 0;
-			tempLineHeight = 0;
+		if( ( qttf->imageCurX + bitmapWidth ) > qfont->shaderWidth ) {
 			qttf->imageCurX = 0;
 			qttf->imageCurY += qttf->imageCurLineHeight - 1; // overlap the previous line's margin
 			qttf->imageCurLineHeight = 0;
 		}
 
-		if( bitmapHeight > qftGlyphTempBitmapHeight ) {
-			qftGlyphTempBitmapHeight = Q_ALIGN( bitmapHeight, QFT_GLYPH_BITMAP_HEIGHT_INCREMENT );
-			qftGlyphTempBitmap = FTLIB_Realloc( qftGlyphTempBitmap, FTLIB_FONT_MAX_IMAGE_WIDTH * qftGlyphTempBitmapHeight );
+		if( ( qttf->imageCurY + bitmapHeight ) > qfont->shaderHeight ) {
+			shader = QFT_AddImage( qfont, NULL, 0 );
+			qttf->imageCurX = 0;
+			qttf->imageCurY = 0;
+			qttf->imageCurLineHeight = 0;
 		}
 
-		if( bitmapHeight > tempLineHeight ) {
-			if( bitmapHeight > qttf->imageCurLineHeight ) {
-				if( ( qttf->imageCurY + bitmapHeight ) > qfont->shaderHeight ) {
-					QFT_UploadRenderedGlyphs( qftGlyphTempBitmap, shader, qttf->imageCurX, qttf->imageCurY, qfont->shaderWidth, tempWidth, tempLineHeight );
-					tempWidth = 0;
-					qttf->imageCurX = 0;
-					qttf->imageCurY = 0;
-					shaderNum = ( qfont->numShaders )++;
-					shader = trap_R_RegisterRawAlphaMask( FTLIB_FontShaderName( qfont, shaderNum ),
-														  qfont->shaderWidth, qfont->shaderHeight, NULL );
-					qfont->shaders = FTLIB_Realloc( qfont->shaders, qfont->numShaders * sizeof( struct shader_s * ) );
-					qfont->shaders[shaderNum] = shader;
-				}
-				qttf->imageCurLineHeight = bitmapHeight;
-			}
-			tempLineHeight = bitmapHeight;
+		if( bitmapHeight > qttf->imageCurLineHeight ) {
+			qttf->imageCurLineHeight = bitmapHeight;
 		}
 
 		qglyph->width = bitmapWidth - 2;
 		qglyph->height = bitmapHeight - 2;
-		qglyph->x_advance = ( ftglyph->advance.x + ( 1 << 5 ) ) >> 6;
-		qglyph->x_offset = ftglyph->bitmap_left;
-		qglyph->y_offset = -( (int)( ftglyph->bitmap_top ) );
+		qglyph->x_advance = ( advance + ( 1 << 5 ) ) >> 6;
+		qglyph->x_offset = left;
+		qglyph->y_offset = -top;
 		qglyph->shader = shader;
-		qglyph->s1 = ( float )( qttf->imageCurX + tempWidth + 1 ) / ( float )qfont->shaderWidth;
+		qglyph->s1 = ( float )( qttf->imageCurX + 1 ) / ( float )qfont->shaderWidth;
 		qglyph->t1 = ( float )( qttf->imageCurY + 1 ) / ( float )qfont->shaderHeight;
-		qglyph->s2 = ( float )( qttf->imageCurX + tempWidth + 1 + qglyph->width ) / ( float )qfont->shaderWidth;
+		qglyph->s2 = ( float )( qttf->imageCurX + 1 + qglyph->width ) / ( float )qfont->shaderWidth;
 		qglyph->t2 = ( float )( qttf->imageCurY + 1 + qglyph->height ) / ( float )qfont->shaderHeight;
 
-		src = ftglyph->bitmap.buffer;
-		dest = qftGlyphTempBitmap + tempWidth;
-		memset( dest, 0, bitmapWidth );
-		dest += qfont->shaderWidth;
-		for( y = 0; y < qglyph->height; ++y, src += srcStride ) {
-			dest[0] = 0;
-			switch( pixelMode ) {
-				case FT_PIXEL_MODE_MONO:
-					for( x = 0; x < qglyph->width; x++ ) {
-						dest[x + 1] = ( ( ( ( unsigned int )( src[x >> 3] ) ) >> ( 7 - ( x & 7 ) ) ) & 1 ) * 255;
-					}
-					break;
-				case FT_PIXEL_MODE_GRAY:
-					memcpy( dest + 1, src, qglyph->width );
-					break;
-				default:
-					// shouldn't happen actually, but make it a valid glyph anyway
-					if( !y || ( y == qglyph->height ) ) {
-						memset( dest + 1, 255, qglyph->width );
-					} else {
-						dest[1] = dest[qglyph->width] = 255;
-						memset( dest + 1, 0, qglyph->width );
-					}
+		if( qglyph->width && qglyph->height ) {
+			cmd.id = QFT_CMD_RASTERIZE;
+			cmd.qfont = qfont;
+			cmd.ftsize = ftsize;
+			cmd.gindex = qftglyph->gindex;
+			cmd.shaderNum = qfont->numShaders - 1;
+			cmd.x = qttf->imageCurX;
+			cmd.y = qttf->imageCurY;
+			cmd.width = qglyph->width;
+			cmd.height = qglyph->height;
+			cmd.left = left;
+			cmd.top = top;
+			trap_BufPipe_WriteCmd( qftGlyphPipe, &cmd, sizeof( cmd ) );
+		}
+
+		qttf->imageCurX += bitmapWidth - 1; // overlap the previous character's margin
+		qttf->cacheModified = true;
+	}
+}
+
+/*
+* QFT_HashFontFile
+*
+* Only the beginning and the end of the file are hashed, which is enough to tell different fonts apart.
+*/
+static unsigned int QFT_HashFontFile( const uint8_t *data, size_t size ) {
+	size_t i;
+	unsigned int hash = 2166136261u;
+
+	for( i = 0; i < size; i++ ) {
+		if( i == QFT_CACHE_HASH_BYTES && size > 2 * QFT_CACHE_HASH_BYTES ) {
+			i = size - QFT_CACHE_HASH_BYTES;
+		}
+		hash = ( hash ^ data[i] ) * 16777619u;
+	}
+
+	return hash;
+}
+
+/*
+* QFT_CacheFileName
+*/
+static void QFT_CacheFileName( qfontface_t *qfont, char *name, size_t size ) {
+	char *s;
+
+	Q_snprintfz( name, size, "%s/", QFT_CACHE_DIR );
+	s = name + strlen( name );
+	Q_strncatz( name, va( "%s_%i_%i", qfont->family->name, qfont->family->style, qfont->size ), size );
+	for( ; *s; s++ ) {
+		if( !isalnum( *s ) && *s != '_' ) {
+			*s = '_';
+		}
+	}
+	Q_strncatz( name, QFT_CACHE_EXTENSION, size );
+}
+
+/*
+* QFT_AddCachedGlyph
+*/
+static void QFT_AddCachedGlyph( qfontface_t *qfont, const qftcacheglyph_t *cached ) {
+	void *glyphs;
+	qftglyph_t *qftglyph;
+
+	glyphs = qfont->glyphs[cached->num >> 8];
+	if( !glyphs ) {
+		glyphs = qfont->f->allocGlyphs( qfont, cached->num & 0xff00, 256 );
+		qfont->glyphs[cached->num >> 8] = glyphs;
+	}
+
+	qftglyph = &( ( qftglyph_t * )glyphs )[cached->num & 255];
+	qftglyph->gindex = cached->gindex;
+	qftglyph->flags = cached->flags;
+	qftglyph->qglyph.width = cached->width;
+	qftglyph->qglyph.height = cached->height;
+	qftglyph->qglyph.x_advance = cached->x_advance;
+	qftglyph->qglyph.x_offset = cached->x_offset;
+	qftglyph->qglyph.y_offset = cached->y_offset;
+	qftglyph->qglyph.shader = qfont->shaders[cached->shaderNum];
+	qftglyph->qglyph.s1 = cached->s1;
+	qftglyph->qglyph.t1 = cached->t1;
+	qftglyph->qglyph.s2 = cached->s2;
+	qftglyph->qglyph.t2 = cached->t2;
+}
+
+/*
+* QFT_AddCachedFallbackGlyphs
+*
+* Glyphs from the fallback family are only valid if the face uses the same fallback font as when they were cached.
+*/
+static void QFT_AddCachedFallbackGlyphs( qfontface_t *qfont ) {
+	unsigned int i;
+	qftface_t *qttf = ( qftface_t * )( qfont->facedata );
+	qftcacheheader_t *header = qttf->cachedFallback;
+	qftfamily_t *qftfamily;
+
+	if( !header ) {
+		return;
+	}
+
+	qftfamily = ( qftfamily_t * )( qttf->fallbackFamily->familydata );
+	if( !Q_stricmp( header->fallbackName, qttf->fallbackFamily->name ) &&
+		header->fallbackFileSize == qftfamily->fileSize && header->fallbackFileHash == qftfamily->fileHash ) {
+		trap_Mutex_Lock( qftLock );
+		QFT_LoadFallbackFace( qfont );
+		trap_Mutex_Unlock( qftLock );
+
+		if( qttf->ftfallbacksize ) {
+			for( i = 0; i < header->numGlyphs; i++ ) {
+				QFT_AddCachedGlyph( qfont, &qttf->cachedFallbackGlyphs[i] );
+			}
+		}
+	}
+
+	FTLIB_Free( qttf->cachedFallback );
+	qttf->cachedFallback = NULL;
+	qttf->cachedFallbackGlyphs = NULL;
+}
+
+/*
+* QFT_ReadCache
+*
+* Restores the images and the glyphs of the face saved by QFT_WriteCache.
+*/
+static bool QFT_ReadCache( qfontface_t *qfont ) {
+	unsigned int i, numFallbackGlyphs;
+	int file, length;
+	size_t pos;
+	bool corrupt;
+	uint8_t *buffer;
+	qftcacheheader_t *header;
+	qftcacheglyph_t *glyphs;
+	qftface_t *qttf = ( qftface_t * )( qfont->facedata );
+	qftfamily_t *qftfamily = ( qftfamily_t * )( qfont->family->familydata );
+	char name[MAX_QPATH];
+
+	if( !ftlib_glyphcache->integer ) {
+		return false;
+	}
+
+	QFT_CacheFileName( qfont, name, sizeof( name ) );
+	length = trap_FS_FOpenFile( name, &file, FS_READ | FS_CACHE );
+	if( length < 0 ) {
+		return false;
+	}
+
+	buffer = NULL;
+	if( length >= (int)sizeof( *header ) ) {
+		buffer = FTLIB_Alloc( ftlibPool, length );
+		if( trap_FS_Read( buffer, length, file ) != length ) {
+			FTLIB_Free( buffer );
+			buffer = NULL;
+		}
+	}
+	trap_FS_FCloseFile( file );
+
+	if( !buffer ) {
+		return false;
+	}
+
+	header = ( qftcacheheader_t * )buffer;
+	glyphs = ( qftcacheglyph_t * )( header + 1 );
+	pos = sizeof( *header ) + header->numGlyphs * sizeof( *glyphs );
+
+	if( header->magic != QFT_CACHE_MAGIC || header->version != QFT_CACHE_VERSION ||
+		header->fileSize != qftfamily->fileSize || header->fileHash != qftfamily->fileHash ||
+		header->shaderWidth != qfont->shaderWidth || header->shaderHeight != qfont->shaderHeight ||
+		!header->numShaders || header->numGlyphs > ( unsigned int )length / sizeof( *glyphs ) || pos > (size_t)length ) {
+		FTLIB_Free( buffer );
+		return false;
+	}
+
+	// validate everything before touching the face
+	for( i = 0; i < header->numGlyphs; i++ ) {
+		if( glyphs[i].num < ' ' || glyphs[i].num > 0xffff || glyphs[i].shaderNum >= header->numShaders ) {
+			break;
+		}
+	}
+	corrupt = i != header->numGlyphs;
+	for( i = 0; i < header->numShaders && !corrupt; i++ ) {
+		unsigned int rows;
+
+		if( pos + sizeof( rows ) > (size_t)length ) {
+			corrupt = true;
+			break;
+		}
+		memcpy( &rows, buffer + pos, sizeof( rows ) );
+		pos += sizeof( rows );
+		if( rows > qfont->shaderHeight || pos + rows * qfont->shaderWidth > (size_t)length ) {
+			corrupt = true;
+			break;
+		}
+		pos += rows * qfont->shaderWidth;
+	}
+	if( corrupt ) {
+		Com_Printf( S_COLOR_YELLOW "Warning: Corrupt glyph cache %s\n", name );
+		FTLIB_Free( buffer );
+		return false;
+	}
+
+	pos = sizeof( *header ) + header->numGlyphs * sizeof( *glyphs );
+	for( i = 0; i < header->numShaders; i++ ) {
+		unsigned int rows;
+
+		memcpy( &rows, buffer + pos, sizeof( rows ) );
+		pos += sizeof( rows );
+		QFT_AddImage( qfont, buffer + pos, rows );
+		pos += rows * qfont->shaderWidth;
+	}
+
+	qttf->imageCurX = header->imageCurX;
+	qttf->imageCurY = header->imageCurY;
+	qttf->imageCurLineHeight = header->imageCurLineHeight;
+
+	numFallbackGlyphs = 0;
+	for( i = 0; i < header->numGlyphs; i++ ) {
+		if( glyphs[i].flags & QFTGLYPH_FROM_FALLBACK ) {
+			// keep them for later, in front of the other ones
+			glyphs[numFallbackGlyphs++] = glyphs[i];
+		} else {
+			QFT_AddCachedGlyph( qfont, &glyphs[i] );
+		}
+	}
+
+	if( numFallbackGlyphs && header->fallbackName[0] ) {
+		header->numGlyphs = numFallbackGlyphs;
+		qttf->cachedFallback = header;
+		qttf->cachedFallbackGlyphs = glyphs;
+	} else {
+		FTLIB_Free( buffer );
+	}
+
+	return true;
+}
+
+/*
+* QFT_WriteCache
+*/
+static void QFT_WriteCache( qfontface_t *qfont ) {
+	unsigned int i, j, k, rows;
+	int file;
+	qftcacheheader_t header;
+	qftcacheglyph_t cached;
+	const qftglyph_t *qftglyph;
+	qftface_t *qttf = ( qftface_t * )( qfont->facedata );
+	qftfamily_t *qftfamily = ( qftfamily_t * )( qfont->family->familydata );
+	char name[MAX_QPATH];
+
+	memset( &header, 0, sizeof( header ) );
+	header.magic = QFT_CACHE_MAGIC;
+	header.version = QFT_CACHE_VERSION;
+	header.fileSize = qftfamily->fileSize;
+	header.fileHash = qftfamily->fileHash;
+	if( qttf->fallbackFamily && qttf->ftfallbacksize ) {
+		qftfamily_t *qftfallback = ( qftfamily_t * )( qttf->fallbackFamily->familydata );
+		Q_strncpyz( header.fallbackName, qttf->fallbackFamily->name, sizeof( header.fallbackName ) );
+		header.fallbackFileSize = qftfallback->fileSize;
+		header.fallbackFileHash = qftfallback->fileHash;
+	}
+	header.shaderWidth = qfont->shaderWidth;
+	header.shaderHeight = qfont->shaderHeight;
+	header.numShaders = qfont->numShaders;
+	header.imageCurX = qttf->imageCurX;
+	header.imageCurY = qttf->imageCurY;
+	header.imageCurLineHeight = qttf->imageCurLineHeight;
+
+	for( i = 0; i < 256; i++ ) {
+		for( j = 0; qfont->glyphs[i] && j < 256; j++ ) {
+			qftglyph = &( ( const qftglyph_t * )qfont->glyphs[i] )[j];
+			if( qftglyph->gindex && qftglyph->qglyph.shader ) {
+				header.numGlyphs++;
+			}
+		}
+	}
+
+	QFT_CacheFileName( qfont, name, sizeof( name ) );
+	if( trap_FS_FOpenFile( name, &file, FS_WRITE | FS_CACHE ) == -1 ) {
+		Com_Printf( S_COLOR_YELLOW "Could not open %s for writing.\n", name );
+		return;
+	}
+
+	trap_FS_Write( &header, sizeof( header ), file );
+
+	memset( &cached, 0, sizeof( cached ) );
+	for( i = 0; i < 256; i++ ) {
+		for( j = 0; qfont->glyphs[i] && j < 256; j++ ) {
+			qftglyph = &( ( const qftglyph_t * )qfont->glyphs[i] )[j];
+			if( !qftglyph->gindex || !qftglyph->qglyph.shader ) {
+				continue;
+			}
+
+			for( k = 0; k < qfont->numShaders - 1; k++ ) {
+				if( qfont->shaders[k] == qftglyph->qglyph.shader ) {
 					break;
+				}
 			}
-			dest[qglyph->width + 1] = 0;
-			dest += qfont->shaderWidth;
+
+			cached.num = ( i << 8 ) | j;
+			cached.flags = qftglyph->flags;
+			cached.gindex = qftglyph->gindex;
+			cached.width = qftglyph->qglyph.width;
+			cached.height = qftglyph->qglyph.height;
+			cached.x_advance = qftglyph->qglyph.x_advance;
+			cached.x_offset = qftglyph->qglyph.x_offset;
+			cached.y_offset = qftglyph->qglyph.y_offset;
+			cached.shaderNum = k;
+			cached.s1 = qftglyph->qglyph.s1;
+			cached.t1 = qftglyph->qglyph.t1;
+			cached.s2 = qftglyph->qglyph.s2;
+			cached.t2 = qftglyph->qglyph.t2;
+			trap_FS_Write( &cached, sizeof( cached ), file );
 		}
-		memset( dest, 0, bitmapWidth );
+	}
 
-		tempWidth += bitmapWidth - 1; // overlap the previous character's margin
+	// only the used part of the last image is stored
+	for( i = 0; i < qfont->numShaders; i++ ) {
+		rows = qfont->shaderHeight;
+		if( i == qfont->numShaders - 1 ) {
+			rows = min( qttf->imageCurY + qttf->imageCurLineHeight, qfont->shaderHeight );
+		}
+		trap_FS_Write( &rows, sizeof( rows ), file );
+		trap_FS_Write( qttf->images[i], rows * qfont->shaderWidth, file );
 	}
+
+	trap_FS_FCloseFile( file );
+
+	qttf->cacheModified = false;
 }
 
+/*
+* QFT_WriteCaches
+*
+* Saves the faces which have had glyphs added since they have been loaded.
+* Must be called before any font family is unloaded, since faces refer to their fallbacks.
+*/
+static void QFT_WriteCaches( void ) {
+	qfontfamily_t *qfamily;
+	qfontface_t *qface;
+
+	if( !ftlib_glyphcache || !ftlib_glyphcache->integer ) {
+		return;
+	}
+
+	QFT_FinishGlyphs();
+
+	for( qfamily = fontFamilies; qfamily; qfamily = qfamily->next ) {
+		for( qface = qfamily->faces; qface; qface = qface->next ) {
+			if( ( ( qftface_t * )( qface->facedata ) )->cacheModified ) {
+				QFT_WriteCache( qface );
+			}
+		}
+	}
+}
+
+/*
+* QFT_SetFallback
+*/
 static void QFT_SetFallback( qfontface_t *qfont, qfontfamily_t *qfamily ) {
 	qftface_t *qttf = ( qftface_t * )( qfont->facedata );
 
 	if( !qttf->fallbackFamily ) {
 		qttf->fallbackFamily = qfamily;
+		QFT_AddCachedFallbackGlyphs( qfont );
 	}
 }
 
@@ -557,16 +1160,17 @@ static qfontface_t *QFT_LoadFace( qfontfamily_t *family, unsigned int size ) {
 		qfont->shaderHeight = maxShaderHeight;
 	}
 
-	qfont->numShaders = 1;
-	qfont->shaders = FTLIB_Alloc( ftlibPool, sizeof( struct shader_s * ) );
-	qfont->shaders[0] = trap_R_RegisterRawAlphaMask( FTLIB_FontShaderName( qfont, 0 ),
-													 qfont->shaderWidth, qfont->shaderHeight, NULL );
 	qfont->hasKerning = hasKerning;
 	qfont->f = &qft_face_funcs;
 	qfont->facedata = ( void * )qttf;
 	qfont->next = family->faces;
 	family->faces = qfont;
 
+	// restore the glyphs rendered in the previous sessions
+	if( !QFT_ReadCache( qfont ) ) {
+		QFT_AddImage( qfont, NULL, 0 );
+	}
+
 	// pre-render 32-126
 	for( i = 0; i < FTLIB_NUM_ASCII_CHARS; i++ ) {
 		renderStr[i] = FTLIB_FIRST_ASCII_CHAR + i;
@@ -581,6 +1185,7 @@ static qfontface_t *QFT_LoadFace( qfontfamily_t *family, unsigned int size ) {
 * QFT_UnloadFace
 */
 static void QFT_UnloadFace( qfontface_t *qfont ) {
+	unsigned int i;
 	qftface_t *qttf;
 
 	qttf = ( qftface_t * )qfont->facedata;
@@ -588,6 +1193,22 @@ static void QFT_UnloadFace( qfontface_t *qfont ) {
 		return;
 	}
 
+	// the rasterizer thread may still be drawing into the images
+	QFT_FinishGlyphs();
+
+	for( i = 0; i < qfont->numShaders; i++ ) {
+		FTLIB_Free( qttf->images[i] );
+	}
+	if( qttf->images ) {
+		FTLIB_Free( qttf->images );
+	}
+	if( qttf->dirty ) {
+		FTLIB_Free( qttf->dirty );
+	}
+	if( qttf->cachedFallback ) {
+		FTLIB_Free( qttf->cachedFallback );
+	}
+
 	q_FT_Done_Size( qttf->ftsize );
 
 	FTLIB_Free( qttf );
@@ -667,6 +1288,8 @@ static bool QFT_LoadFamily( const char *fileName, uint8_t *data, size_t dataSize
 	qftfamily = FTLIB_Alloc( ftlibPool, sizeof( qftfamily_t ) );
 	qftfamily->ftface = ftface;
 	qftfamily->file = data;
+	qftfamily->fileSize = dataSize;
+	qftfamily->fileHash = QFT_HashFontFile( data, dataSize );
 
 	qfamily = FTLIB_Alloc( ftlibPool, sizeof( qfontfamily_t ) );
 	qfamily->numFaces = 0;
@@ -787,12 +1410,34 @@ static void QFT_Init( bool verbose ) {
 	assert( !qftGlyphTempBitmap );
 	qftGlyphTempBitmap = FTLIB_Alloc( ftlibPool, FTLIB_FONT_MAX_IMAGE_WIDTH * QFT_GLYPH_BITMAP_HEIGHT_INCREMENT );
 	qftGlyphTempBitmapHeight = QFT_GLYPH_BITMAP_HEIGHT_INCREMENT;
+
+	ftlib_glyphcache = trap_Cvar_Get( "ftlib_glyphcache", "1", CVAR_ARCHIVE );
+
+	qftLock = trap_Mutex_Create();
+	qftGlyphPipe = trap_BufPipe_Create( QFT_GLYPH_PIPE_SIZE, 1 );
+	qftGlyphThread = trap_Thread_Create( QFT_GlyphThreadProc, qftGlyphPipe );
 }
 
 /*
 * QFT_Shutdown
 */
 static void QFT_Shutdown( void ) {
+	int cmd = QFT_CMD_SHUTDOWN;
+
+	// the fonts may still be loaded if the library is shut down without freeing them first
+	QFT_WriteCaches();
+
+	if( qftGlyphPipe ) {
+		trap_BufPipe_WriteCmd( qftGlyphPipe, &cmd, sizeof( cmd ) );
+		trap_Thread_Join( qftGlyphThread );
+		qftGlyphThread = NULL;
+		trap_BufPipe_Destroy( &qftGlyphPipe );
+	}
+
+	if( qftLock ) {
+		trap_Mutex_Destroy( &qftLock );
+	}
+
 	if( ftLibrary != NULL ) {
 		q_FT_Done_FreeType( ftLibrary );
 		ftLibrary = NULL;
@@ -937,6 +1582,9 @@ void FTLIB_FreeFonts( bool verbose ) {
 	qfontfamily_t *qfamily, *nextqfamily;
 	qfontface_t *qface, *nextqface;
 
+	// faces refer to the fallback families, so save everything before anything is unloaded
+	QFT_WriteCaches();
+
 	// unload all font families
 	for( qfamily = fontFamilies; qfamily; qfamily = nextqfamily ) {
 		nextqfamily = qfamily->next;
@@ -975,6 +1623,15 @@ void FTLIB_FreeFonts( bool verbose ) {
 	fontFamilies = NULL;
 }
 
+/*
+* FTLIB_BeginFrame
+*
+* Uploads the glyphs rendered since the previous frame.
+*/
+void FTLIB_BeginFrame( void ) {
+	QFT_UploadGlyphs();
+}
+
 /*
 * FTLIB_ShutdownSubsystems
 */
@@ -160,6 +160,7 @@ qfontface_t *FTLIB_RegisterFont( const char *family, const char *fallback, int s
 void FTLIB_TouchFont( qfontface_t *qfont );
 void FTLIB_TouchAllFonts( void );
 void FTLIB_FreeFonts( bool verbose );
+void FTLIB_BeginFrame( void );
 void FTLIB_PrintFontList( void );
 qglyph_t *FTLIB_GetGlyph( qfontface_t *font, wchar_t num );
 const char *FTLIB_FontShaderName( qfontface_t *qfont, unsigned int shaderNum );
@@ -23,7 +23,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 // ftlib_public.h - font provider subsystem
 
-#define FTLIB_API_VERSION           11
+#define FTLIB_API_VERSION           12
 
 //===============================================================
 
@@ -106,6 +106,22 @@ typedef struct {
 	void ( *Mem_Free )( void *data, const char *filename, int fileline );
 	void ( *Mem_FreePool )( struct mempool_s **pool, const char *filename, int fileline );
 	void ( *Mem_EmptyPool )( struct mempool_s *pool, const char *filename, int fileline );
+
+	// multithreading
+	struct qthread_s *( *Thread_Create )( void *( *routine )( void* ), void *param );
+	void ( *Thread_Join )( struct qthread_s *thread );
+	struct qmutex_s *( *Mutex_Create )( void );
+	void ( *Mutex_Destroy )( struct qmutex_s **mutex );
+	void ( *Mutex_Lock )( struct qmutex_s *mutex );
+	void ( *Mutex_Unlock )( struct qmutex_s *mutex );
+
+	struct qbufPipe_s *( *BufPipe_Create )( size_t bufSize, int flags );
+	void ( *BufPipe_Destroy )( struct qbufPipe_s **pqueue );
+	void ( *BufPipe_Finish )( struct qbufPipe_s *queue );
+	void ( *BufPipe_WriteCmd )( struct qbufPipe_s *queue, const void *cmd, unsigned cmd_size );
+	int ( *BufPipe_ReadCmds )( struct qbufPipe_s *queue, unsigned( **cmdHandlers )( const void * ) );
+	void ( *BufPipe_Wait )( struct qbufPipe_s *queue, int ( *read )( struct qbufPipe_s *, unsigned( ** )( const void * ), bool ),
+							unsigned( **cmdHandlers )( const void * ), unsigned timeout_msec );
 } ftlib_import_t;
 
 //
@@ -125,6 +141,7 @@ typedef struct {
 	void ( *TouchFont )( struct qfontface_s *qfont );
 	void ( *TouchAllFonts )( void );
 	void ( *FreeFonts )( bool verbose );
+	void ( *BeginFrame )( void );
 
 	// drawing functions
 	size_t ( *FontSize )( struct qfontface_s *font );
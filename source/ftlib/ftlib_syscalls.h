@@ -24,6 +24,10 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 extern ftlib_import_t FTLIB_IMPORT;
 
+typedef struct qthread_s qthread_t;
+typedef struct qmutex_s qmutex_t;
+typedef struct qbufPipe_s qbufPipe_t;
+
 static inline void trap_Print( const char *msg ) {
 	FTLIB_IMPORT.Print( msg );
 }
@@ -213,3 +217,52 @@ static inline void *trap_LoadLibrary( char *name, dllfunc_t *funcs ) {
 static inline void trap_UnloadLibrary( void **lib ) {
 	FTLIB_IMPORT.Sys_UnloadLibrary( lib );
 }
+
+static inline struct qthread_s *trap_Thread_Create( void *( *routine )( void* ), void *param ) {
+	return FTLIB_IMPORT.Thread_Create( routine, param );
+}
+
+static inline void trap_Thread_Join( struct qthread_s *thread ) {
+	FTLIB_IMPORT.Thread_Join( thread );
+}
+
+static inline struct qmutex_s *trap_Mutex_Create( void ) {
+	return FTLIB_IMPORT.Mutex_Create();
+}
+
+static inline void trap_Mutex_Destroy( struct qmutex_s **mutex ) {
+	FTLIB_IMPORT.Mutex_Destroy( mutex );
+}
+
+static inline void trap_Mutex_Lock( struct qmutex_s *mutex ) {
+	FTLIB_IMPORT.Mutex_Lock( mutex );
+}
+
+static inline void trap_Mutex_Unlock( struct qmutex_s *mutex ) {
+	FTLIB_IMPORT.Mutex_Unlock( mutex );
+}
+
+static inline qbufPipe_t *trap_BufPipe_Create( size_t bufSize, int flags ) {
+	return FTLIB_IMPORT.BufPipe_Create( bufSize, flags );
+}
+
+static inline void trap_BufPipe_Destroy( qbufPipe_t **pqueue ) {
+	FTLIB_IMPORT.BufPipe_Destroy( pqueue );
+}
+
+static inline void trap_BufPipe_Finish( qbufPipe_t *queue ) {
+	FTLIB_IMPORT.BufPipe_Finish( queue );
+}
+
+static inline void trap_BufPipe_WriteCmd( qbufPipe_t *queue, const void *cmd, unsigned cmd_size ) {
+	FTLIB_IMPORT.BufPipe_WriteCmd( queue, cmd, cmd_size );
+}
+
+static inline int trap_BufPipe_ReadCmds( qbufPipe_t *queue, unsigned( **cmdHandlers )( const void * ) ) {
+	return FTLIB_IMPORT.BufPipe_ReadCmds( queue, cmdHandlers );
+}
+
+static inline void trap_BufPipe_Wait( qbufPipe_t *queue, int ( *read )( qbufPipe_t *, unsigned( ** )( const void * ), bool ),
+									  unsigned( **cmdHandlers )( const void * ), unsigned timeout_msec ) {
+	FTLIB_IMPORT.BufPipe_Wait( queue, read, cmdHandlers, timeout_msec );
+}
@@ -398,6 +398,12 @@ typedef int socket_handle_t;
 #define ATTRIBUTE_NAKED
 #endif
 
+#if defined ( _MSC_VER )
+#define ATTRIBUTE_THREAD_LOCAL __declspec( thread )
+#else
+#define ATTRIBUTE_THREAD_LOCAL __thread
+#endif
+
 #ifdef HAVE___STRTOI64
 #define strtoll _strtoi64
 #define strtoull _strtoi64
@@ -266,7 +266,9 @@ typedef enum {
 	WIRE_ANGLE,					// 32-bit float angle value, normalized to [0..360], transmitted at half-precision
 
 	WIRE_BASE128,				// base-128 encoded unsigned integer
-	WIRE_UBASE128				// base-128 encoded signed integer
+	WIRE_UBASE128,				// base-128 encoded signed integer
+
+	WIRE_COORD					// 32-bit float coordinate, quantized to 1/8 unit in bit-packed messages
 } wireType_t;
 
 //==============================================
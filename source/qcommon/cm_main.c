@@ -899,6 +899,49 @@ bool CM_InPVS( cmodel_state_t *cms, const vec3_t p1, const vec3_t p2 ) {
 	return CM_LeafsInPVS( cms, leafnum1, leafnum2 );
 }
 
+/*
+* CM_BoxInPVS
+*
+* Like CM_InPVS, but the box is visible if any of its clusters is
+*/
+bool CM_BoxInPVS( cmodel_state_t *cms, const vec3_t p, const vec3_t mins, const vec3_t maxs ) {
+	int leafs[128];
+	int i, count, numClusters;
+	int leafnum, cluster, area;
+	uint8_t *mask;
+	vec3_t bmins, bmaxs;
+
+	leafnum = CM_PointLeafnum( cms, p );
+	area = CM_LeafArea( cms, leafnum );
+	mask = CM_ClusterPVS( cms, CM_LeafCluster( cms, leafnum ) );
+
+	VectorCopy( mins, bmins );
+	VectorCopy( maxs, bmaxs );
+	count = CM_BoxLeafnums( cms, bmins, bmaxs, leafs, sizeof( leafs ) / sizeof( int ), NULL );
+	if( count >= (int)( sizeof( leafs ) / sizeof( int ) ) ) {
+		return true; // the list may be incomplete
+	}
+
+	for( i = 0, numClusters = 0; i < count; i++ ) {
+		// solid leafs have no cluster and can't contain anything visible
+		cluster = CM_LeafCluster( cms, leafs[i] );
+		if( cluster == -1 ) {
+			continue;
+		}
+
+		numClusters++;
+		if( !( mask[cluster >> 3] & ( 1 << ( cluster & 7 ) ) ) ) {
+			continue;
+		}
+		if( CM_AreasConnected( cms, area, CM_LeafArea( cms, leafs[i] ) ) ) {
+			return true;
+		}
+	}
+
+	// entirely outside the vis data
+	return !numClusters;
+}
+
 bool CM_LeafsInPVS( cmodel_state_t *cms, int leafnum1, int leafnum2 ) {
 	int cluster;
 	int area1, area2;
@@ -911,7 +954,8 @@ bool CM_LeafsInPVS( cmodel_state_t *cms, int leafnum1, int leafnum2 ) {
 	cluster = CM_LeafCluster( cms, leafnum2 );
 	area2 = CM_LeafArea( cms, leafnum2 );
 
-	if( ( !( mask[cluster >> 3] & ( 1 << ( cluster & 7 ) ) ) ) ) {
+	// leafs without a cluster aren't in the vis data, don't cull them
+	if( cluster != -1 && ( !( mask[cluster >> 3] & ( 1 << ( cluster & 7 ) ) ) ) ) {
 		return false;
 	}
 
@@ -77,6 +77,7 @@ void CM_MergePVS( cmodel_state_t *cms, const vec3_t org, uint8_t *out );
 int CM_MergeVisSets( cmodel_state_t *cms, const vec3_t org, uint8_t *pvs, uint8_t *areabits );
 
 bool CM_InPVS( cmodel_state_t *cms, const vec3_t p1, const vec3_t p2 );
+bool CM_BoxInPVS( cmodel_state_t *cms, const vec3_t p, const vec3_t mins, const vec3_t maxs );
 
 bool CM_LeafsInPVS( cmodel_state_t *cms, int leafnum1, int leafnum2 );
 
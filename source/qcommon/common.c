@@ -876,6 +876,8 @@ void Qcommon_Init( int argc, char **argv ) {
 
 	Sys_Init();
 
+	Prof_Init();
+
 	NET_Init();
 	Netchan_Init();
 
@@ -943,6 +945,8 @@ void Qcommon_Frame( unsigned int realMsec ) {
 
 	}
 
+	Prof_Frame();
+
 	if( logconsole && logconsole->modified ) {
 		logconsole->modified = false;
 		Com_ReopenConsoleLog();
@@ -990,13 +994,17 @@ void Qcommon_Frame( unsigned int realMsec ) {
 		time_before = Sys_Milliseconds();
 	}
 
+	Prof_Begin( "SV_Frame" );
 	SV_Frame( realMsec, gameMsec );
+	Prof_End( "SV_Frame" );
 
 	if( host_speeds->integer ) {
 		time_between = Sys_Milliseconds();
 	}
 
+	Prof_Begin( "CL_Frame" );
 	CL_Frame( realMsec, gameMsec );
+	Prof_End( "CL_Frame" );
 
 	if( host_speeds->integer ) {
 		time_after = Sys_Milliseconds();
@@ -1041,6 +1049,8 @@ void Qcommon_Shutdown( void ) {
 
 	Com_Autoupdate_Shutdown();
 
+	Prof_Shutdown();
+
 	Qcommon_ShutdownCommands();
 	Memory_ShutdownCommands();
 
@@ -23,20 +23,39 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "qcommon.h"
 #include "../qalgo/q_trie.h"
 
-#define MLIST_CACHE "cache/mapcache.txt"
+#define MLIST_CACHE "cache/mapindex.txt"
 #define MLIST_NULL  ""
 
 #define MLIST_TRIE_CASING TRIE_CASE_INSENSITIVE
 
 #define MLIST_UNKNOWN_MAPNAME   "@#$"
 
+#define MLIST_NUM_THREADS       4       // including the main thread
+
 #define MLIST_CACHE_EXISTS ( FS_FOpenFile( MLIST_CACHE, NULL, FS_READ | FS_CACHE ) > 0 )
 
 typedef struct mapinfo_s {
 	char *filename, *fullname;
+	int size;
+	time_t mtime;
 	struct mapinfo_s *next;
 } mapinfo_t;
 
+typedef struct mapfile_s {
+	char filename[MAX_CONFIGSTRING_CHARS];
+	char fullname[MAX_CONFIGSTRING_CHARS];
+	int size;
+	time_t mtime;
+	bool resolved;
+} mapfile_t;
+
+typedef struct {
+	mapfile_t *files;
+	int numfiles;
+	volatile int *cnt;
+	qmutex_t *mutex;
+} mapfile_job_t;
+
 static mapinfo_t *maplist;
 static trie_t *mlist_filenames_trie = NULL, *mlist_fullnames_trie = NULL;
 
@@ -44,8 +63,7 @@ static bool ml_flush = true;
 static bool ml_initialized = false;
 
 static void ML_BuildCache( void );
-static void ML_InitFromCache( void );
-static void ML_InitFromMaps( void );
+static void ML_InitFromMaps( bool usecache );
 static void ML_GetFullnameFromMap( const char *filename, char *fullname, size_t len );
 static bool ML_FilenameExistsExt( const char *filename, bool quick );
 
@@ -54,7 +72,7 @@ static bool ML_FilenameExistsExt( const char *filename, bool quick );
 * Handles assigning memory for map and adding it to the list
 * in alphabetical order
 */
-static void ML_AddMap( const char *filename, const char *fullname ) {
+static void ML_AddMap( const char *filename, const char *fullname, int size, time_t mtime ) {
 	mapinfo_t *map;
 	char *buffer;
 	char fullname_[MAX_CONFIGSTRING_CHARS];
@@ -96,6 +114,9 @@ static void ML_AddMap( const char *filename, const char *fullname ) {
 	COM_RemoveColorTokens( map->fullname );
 	Q_strlwr( map->fullname );
 
+	map->size = size;
+	map->mtime = mtime;
+
 	Trie_Insert( mlist_filenames_trie, map->filename, map );
 	Trie_Insert( mlist_fullnames_trie, map->fullname, map );
 
@@ -105,7 +126,8 @@ static void ML_AddMap( const char *filename, const char *fullname ) {
 
 /*
 * ML_BuildCache
-* Write the map data to a cache file
+* Write the map data to a cache file, keyed by the size and
+* modification time of each map
 */
 static void ML_BuildCache( void ) {
 	int filenum;
@@ -122,7 +144,7 @@ static void ML_BuildCache( void ) {
 		Trie_Dump( mlist_filenames_trie, "", TRIE_DUMP_VALUES, &dump );
 		for( i = 0; i < dump->size; ++i ) {
 			map = ( mapinfo_t * )( dump->key_value_vector[i].value );
-			FS_Printf( filenum, "%s\r\n%s\r\n", map->filename, map->fullname );
+			FS_Printf( filenum, "%s\r\n%i %u\r\n%s\r\n", map->filename, map->size, (unsigned)map->mtime, map->fullname );
 		}
 		Trie_FreeDump( dump );
 
@@ -130,168 +152,203 @@ static void ML_BuildCache( void ) {
 	}
 }
 
-typedef struct mapdir_s {
-	char *filename;
-	struct mapdir_s *prev, *next;
-} mapdir_t;
-
 /*
-* ML_InitFromCache
-* Fills map list array from cache, much faster
+* ML_ScanMapFiles
+* Lists the maps directory along with the size and modification
+* time of each map, which the cache entries are validated against
 */
-static void ML_InitFromCache( void ) {
-	int count, i, total, len;
+static mapfile_t *ML_ScanMapFiles( int *numfiles ) {
+	int i, total, len, count;
 	size_t size = 0;
-	char *buffer, *chr, *current, *curend;
-	char *temp, *maps, *map;
-	mapdir_t *dir, *curmap, *prev;
+	char *maps, *map;
+	char filepath[MAX_QPATH];
+	mapfile_t *files, *file;
 
-	if( ml_initialized ) {
-		return;
-	}
+	*numfiles = 0;
 
 	total = FS_GetFileListExt( "maps", ".bsp", NULL, &size, 0, 0 );
-	if( !total ) {
-		return;
+	if( !total || !size ) {
+		return NULL;
 	}
 
-	// load maps from directory reading into a list
-	maps = temp = ( char* )Mem_TempMalloc( size + sizeof( mapdir_t ) * total );
-	temp += size;
+	maps = ( char* )Mem_TempMalloc( size );
 	FS_GetFileList( "maps", ".bsp", maps, size, 0, 0 );
-	len = 0;
-	prev = NULL;
-	dir = NULL;
-	for( i = 0; i < total; i++ ) {
+
+	files = ( mapfile_t * )Mem_TempMalloc( sizeof( mapfile_t ) * total );
+	for( i = 0, len = 0, count = 0; i < total; i++ ) {
 		map = maps + len;
 		len += strlen( map ) + 1;
 
-		curmap = ( mapdir_t * )temp;
-		temp += sizeof( mapdir_t );
-
+		COM_SanitizeFilePath( map );
 		COM_StripExtension( map );
-
-		if( !i ) {
-			dir = curmap;
-		} else {
-			prev->next = curmap;
-			curmap->prev = prev;
+		if( !ML_ValidateFilename( map ) ) {
+			continue;
 		}
 
-		curmap->filename = map;
-		prev = curmap;
+		file = &files[count++];
+		Q_strncpyz( file->filename, map, sizeof( file->filename ) );
+		file->fullname[0] = '\0';
+		file->resolved = false;
+
+		Q_snprintfz( filepath, sizeof( filepath ), "maps/%s.bsp", map );
+		file->size = FS_FOpenFile( filepath, NULL, FS_READ );
+		file->mtime = FS_FileMTime( filepath );
+	}
+
+	Mem_TempFree( maps );
+
+	if( !count ) {
+		Mem_TempFree( files );
+		return NULL;
 	}
 
+	*numfiles = count;
+	return files;
+}
+
+/*
+* ML_LoadCache
+* Takes fullnames from the cache for the maps which
+* haven't changed in size or modification time
+*/
+static void ML_LoadCache( mapfile_t *files, int numfiles ) {
+	int i, count;
+	char *buffer, *chr, *sep;
+	char *line[3];
+	trie_t *trie;
+	mapfile_t *file;
+
 	FS_LoadCacheFile( MLIST_CACHE, (void **)&buffer, NULL, 0 );
 	if( !buffer ) {
-		Mem_TempFree( maps );
 		return;
 	}
 
-	current = curend = buffer;
-	count = 0;
+	Trie_Create( MLIST_TRIE_CASING, &trie );
+	for( i = 0; i < numfiles; i++ )
+		Trie_Insert( trie, files[i].filename, &files[i] );
 
+	// each entry is made of three lines: filename, size and mtime, fullname
+	count = 0;
+	line[0] = buffer;
 	for( chr = buffer; *chr; chr++ ) {
-		// current character is a delimiter
-		if( *chr == '\n' ) {
-			if( *( chr - 1 ) == '\r' ) {
-				*( chr - 1 ) = '\0';    // clear the CR too
-			}
-			*chr = '\0';            // clear the LF
-
-			// if we have got both params
-			if( !( ++count & 1 ) ) {
-				// check if its in the maps directory
-				for( curmap = dir; curmap; curmap = curmap->next ) {
-					if( !Q_stricmp( curmap->filename, current ) ) {
-						if( curmap->prev ) {
-							curmap->prev->next = curmap->next;
-						} else {
-							dir = curmap->next;
-						}
-
-						if( curmap->next ) {
-							curmap->next->prev = curmap->prev;
-						}
-						break;
-					}
-				}
-
-				// if we found it in the maps directory
-				if( curmap ) {
-					COM_SanitizeFilePath( current );
-
-					// well, if we've got a map with an unknown fullname, load it from map
-					if( !strcmp( curend + 1, MLIST_UNKNOWN_MAPNAME ) ) {
-						ML_AddMap( current, NULL );
-					} else {
-						ML_AddMap( current, curend + 1 );
-					}
-				}
-				current = chr + 1;
-			} else {
-				curend = chr;
+		if( *chr != '\n' ) {
+			continue;
+		}
+
+		if( chr > buffer && *( chr - 1 ) == '\r' ) {
+			*( chr - 1 ) = '\0';    // clear the CR too
+		}
+		*chr = '\0';            // clear the LF
+
+		if( ++count < 3 ) {
+			line[count] = chr + 1;
+			continue;
+		}
+		count = 0;
+
+		if( Trie_Find( trie, line[0], TRIE_EXACT_MATCH, (void **)&file ) == TRIE_OK && !file->resolved ) {
+			sep = strchr( line[1], ' ' );
+			if( sep && file->size == atoi( line[1] ) && (unsigned)file->mtime == strtoul( sep + 1, NULL, 10 )
+				&& strcmp( line[2], MLIST_UNKNOWN_MAPNAME ) ) {
+				Q_strncpyz( file->fullname, line[2], sizeof( file->fullname ) );
+				file->resolved = true;
 			}
 		}
-	}
 
-	// we've now loaded the mapcache, but there may be files which
-	// have been added to maps directory, and the mapcache isnt aware
-	// these will be left over in our directory list
-	for( curmap = dir; curmap; curmap = curmap->next )
-		ML_AddMap( curmap->filename, NULL );
+		line[0] = chr + 1;
+	}
 
-	Mem_TempFree( maps );
+	Trie_Destroy( trie );
 	FS_FreeFile( buffer );
 }
 
+static void *ML_ResolveFullnames_Job( void *parg ) {
+	int i;
+	mapfile_t *file;
+	mapfile_job_t *job = parg;
+
+	while( true ) {
+		i = QAtomic_Add( job->cnt, 1, job->mutex );
+		if( i >= job->numfiles ) {
+			break;
+		}
+
+		file = &job->files[i];
+		if( !file->resolved ) {
+			ML_GetFullnameFromMap( file->filename, file->fullname, sizeof( file->fullname ) );
+			file->resolved = true;
+		}
+	}
+
+	return NULL;
+}
+
+/*
+* ML_ResolveFullnames
+* Reads fullnames of unresolved maps from map files, spreading the work over threads
+*/
+static void ML_ResolveFullnames( mapfile_t *files, int numfiles ) {
+	int i, numunresolved;
+	volatile int cnt;
+	qthread_t *threads[MLIST_NUM_THREADS - 1] = { NULL };
+	int num_threads;
+	mapfile_job_t job;
+
+	for( i = 0, numunresolved = 0; i < numfiles; i++ ) {
+		if( !files[i].resolved ) {
+			numunresolved++;
+		}
+	}
+	if( !numunresolved ) {
+		return;
+	}
+
+	cnt = 0;
+	job.files = files;
+	job.numfiles = numfiles;
+	job.cnt = &cnt;
+	job.mutex = QMutex_Create();
+
+	num_threads = min( numunresolved, MLIST_NUM_THREADS ) - 1;
+	for( i = 0; i < num_threads; i++ )
+		threads[i] = QThread_Create( ML_ResolveFullnames_Job, &job );
+
+	ML_ResolveFullnames_Job( &job );
+
+	for( i = 0; i < num_threads; i++ )
+		QThread_Join( threads[i] );
+
+	QMutex_Destroy( &job.mutex );
+}
+
 /*
 * ML_InitFromMaps
-* Fills map list array from each map file. Very slow
-* and should only be called if cache doesnt exist
+* Fills map list array from the maps directory. The cache is used for
+* maps which haven't changed, others are read from the map files
 */
-static void ML_InitFromMaps( void ) {
-	int i, j, total, len;
-	char maps[2048];
-	char *filename;
+static void ML_InitFromMaps( bool usecache ) {
+	int i, numfiles;
+	mapfile_t *files;
 
 	if( ml_initialized ) {
 		return;
 	}
 
-	total = FS_GetFileList( "maps", ".bsp", NULL, 0, 0, 0 );
-	if( !total ) {
+	files = ML_ScanMapFiles( &numfiles );
+	if( !files ) {
 		return;
 	}
 
-	i = 0;
-	while( i < total ) {
-		memset( maps, 0, sizeof( maps ) );
-		j = FS_GetFileList( "maps", ".bsp", maps, sizeof( maps ), i, total );
-
-		// no maps returned, map name is too big or end of list?
-		if( !j ) {
-			i++;
-			continue;
-		}
-		i += j;
-
-		// split the maps up and find their fullnames
-		len = 0;
-		while( j-- ) {
-			filename = maps + len;
-			if( !*filename ) {
-				continue;
-			}
+	if( usecache ) {
+		ML_LoadCache( files, numfiles );
+	}
 
-			len += strlen( filename ) + 1;
+	ML_ResolveFullnames( files, numfiles );
 
-			COM_SanitizeFilePath( filename );
-			COM_StripExtension( filename );
+	for( i = 0; i < numfiles; i++ )
+		ML_AddMap( files[i].filename, files[i].fullname, files[i].size, files[i].mtime );
 
-			ML_AddMap( filename, NULL );
-		}
-	}
+	Mem_TempFree( files );
 }
 
 static int ML_PatternMatchesMap( void *map, void *pattern ) {
@@ -380,11 +437,7 @@ void ML_Init( void ) {
 
 	Cmd_AddCommand( "maplist", ML_MapListCmd );
 
-	if( MLIST_CACHE_EXISTS ) {
-		ML_InitFromCache();
-	} else {
-		ML_InitFromMaps();
-	}
+	ML_InitFromMaps( MLIST_CACHE_EXISTS );
 
 	ml_initialized = true;
 	ml_flush = true;
@@ -439,32 +492,28 @@ void ML_Restart( bool forcemaps ) {
 * ML_Update
 */
 bool ML_Update( void ) {
-	int i, len, total, newpaks;
-	size_t size;
-	char *map, *maps, *filename;
+	int i, numfiles, newpaks;
+	mapfile_t *files;
 
 	newpaks = FS_Rescan();
 	if( !newpaks ) {
 		return false;
 	}
 
-	total = FS_GetFileListExt( "maps", ".bsp", NULL, &size, 0, 0 );
-	if( size ) {
-		maps = ( char* )Mem_TempMalloc( size );
-		FS_GetFileList( "maps", ".bsp", maps, size, 0, 0 );
-		for( i = 0, len = 0; i < total; i++ ) {
-			map = maps + len;
-			len += strlen( map ) + 1;
-
-			filename = ( char * )COM_FileBase( map );
-			COM_StripExtension( filename );
-
-			// don't check for existance of each file itself, as we've just got the fresh list
-			if( !ML_FilenameExistsExt( filename, true ) ) {
-				ML_AddMap( filename, MLIST_UNKNOWN_MAPNAME );
+	files = ML_ScanMapFiles( &numfiles );
+	if( files ) {
+		// don't check for existance of each file itself, as we've just got the fresh list
+		for( i = 0; i < numfiles; i++ )
+			files[i].resolved = ML_FilenameExistsExt( files[i].filename, true );
+
+		ML_ResolveFullnames( files, numfiles );
+
+		for( i = 0; i < numfiles; i++ ) {
+			if( !ML_FilenameExistsExt( files[i].filename, true ) ) {
+				ML_AddMap( files[i].filename, files[i].fullname, files[i].size, files[i].mtime );
 			}
 		}
-		Mem_TempFree( maps );
+		Mem_TempFree( files );
 	}
 
 	return true;
@@ -593,24 +642,26 @@ const char *ML_GetFullname( const char *filename ) {
 /*
 * ML_GetFullnameFromMap
 * Get fullname of map from file or worldspawn (slow)
+* Called from worker threads, so no static buffers here
 */
 static void ML_GetFullnameFromMap( const char *filename, char *fullname, size_t len ) {
 	char *buffer;
+	char path[MAX_QPATH];
+	char token[MAX_TOKEN_CHARS];
 
 	*fullname = '\0';
 
 	// Try and load fullname from a file
-	FS_LoadFile( va( "maps/%s.txt", filename ), ( void ** )&buffer, NULL, 0 );
+	FS_LoadFile( va_r( path, sizeof( path ), "maps/%s.txt", filename ), ( void ** )&buffer, NULL, 0 );
 	if( buffer ) {
 		char *line = buffer;
-		Q_strncpyz( fullname, COM_Parse( &line ), len );
+		Q_strncpyz( fullname, COM_Parse_r( token, sizeof( token ), &line ), len );
 		FS_FreeFile( buffer );
 		return;
 	}
 
 	// Try and load fullname from worldspawn
-	CM_LoadMapMessage( va( "maps/%s.bsp", filename ), fullname, len );
-	COM_RemoveColorTokens( fullname );
+	CM_LoadMapMessage( va_r( path, sizeof( path ), "maps/%s.bsp", filename ), fullname, len );
 }
 
 /*
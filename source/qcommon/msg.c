@@ -302,7 +302,7 @@ int MSG_SkipData( msg_t *msg, size_t length ) {
 
 static char *MSG_ReadString2( msg_t *msg, bool linebreak ) {
 	int l, c;
-	static char string[MAX_MSG_STRING_CHARS];
+	static ATTRIBUTE_THREAD_LOCAL char string[MAX_MSG_STRING_CHARS];
 
 	l = 0;
 	do {
@@ -328,6 +328,121 @@ char *MSG_ReadStringLine( msg_t *msg ) {
 	return MSG_ReadString2( msg, true );
 }
 
+//==================================================
+// BIT-PACKED MESSAGES
+//==================================================
+
+/*
+* MSG_BeginWritingBits
+*/
+void MSG_BeginWritingBits( msg_bitstream_t *bs, msg_t *msg ) {
+	bs->msg = msg;
+	bs->bits = 0;
+	bs->numBits = 0;
+}
+
+/*
+* MSG_WriteBits
+*/
+void MSG_WriteBits( msg_bitstream_t *bs, uint32_t value, unsigned numBits ) {
+	assert( numBits <= 32 );
+
+	if( numBits < 32 ) {
+		value &= ( 1U << numBits ) - 1;
+	}
+
+	bs->bits |= (uint64_t)value << bs->numBits;
+	bs->numBits += numBits;
+
+	while( bs->numBits >= 8 ) {
+		MSG_WriteUint8( bs->msg, (int)( bs->bits & 0xff ) );
+		bs->bits >>= 8;
+		bs->numBits -= 8;
+	}
+}
+
+/*
+* MSG_WriteBitsVarint
+*
+* Groups of 4 bits, each followed by a continuation bit.
+*/
+void MSG_WriteBitsVarint( msg_bitstream_t *bs, uint64_t value ) {
+	do {
+		unsigned group = value & 15;
+		value >>= 4;
+		MSG_WriteBits( bs, group | ( value ? 16 : 0 ), 5 );
+	} while( value );
+}
+
+/*
+* MSG_EndWritingBits
+*
+* Pads the last byte with zeroes.
+*/
+void MSG_EndWritingBits( msg_bitstream_t *bs ) {
+	if( bs->numBits ) {
+		MSG_WriteUint8( bs->msg, (int)( bs->bits & 0xff ) );
+	}
+	bs->bits = 0;
+	bs->numBits = 0;
+}
+
+/*
+* MSG_BeginReadingBits
+*/
+void MSG_BeginReadingBits( msg_bitstream_t *bs, msg_t *msg ) {
+	bs->msg = msg;
+	bs->bits = 0;
+	bs->numBits = 0;
+}
+
+/*
+* MSG_ReadBits
+*/
+uint32_t MSG_ReadBits( msg_bitstream_t *bs, unsigned numBits ) {
+	uint32_t value;
+
+	assert( numBits <= 32 );
+
+	while( bs->numBits < numBits ) {
+		bs->bits |= (uint64_t)MSG_ReadUint8( bs->msg ) << bs->numBits;
+		bs->numBits += 8;
+	}
+
+	value = (uint32_t)( bs->bits & ( ( (uint64_t)1 << numBits ) - 1 ) );
+	bs->bits >>= numBits;
+	bs->numBits -= numBits;
+	return value;
+}
+
+/*
+* MSG_ReadBitsVarint
+*/
+uint64_t MSG_ReadBitsVarint( msg_bitstream_t *bs ) {
+	unsigned group, shift = 0;
+	uint64_t value = 0;
+
+	do {
+		group = MSG_ReadBits( bs, 5 );
+		if( shift < 64 ) {
+			value |= (uint64_t)( group & 15 ) << shift;
+		}
+		shift += 4;
+	} while( ( group & 16 ) && bs->msg->readcount <= bs->msg->cursize );
+
+	return value;
+}
+
+/*
+* MSG_EndReadingBits
+*
+* The rest of the last partially read byte is padding.
+*/
+void MSG_EndReadingBits( msg_bitstream_t *bs ) {
+	bs->bits = 0;
+	bs->numBits = 0;
+}
+
 //==================================================
 // ENCODED FIELDS
 //==================================================
@@ -403,6 +518,7 @@ static void MSG_WriteField( msg_t *msg, const uint8_t *to, const msg_field_t *fi
 		MSG_WriteInt64( msg, *((int64_t *)( to + field->offset )) );
 		break;
 	case WIRE_FLOAT:
+	case WIRE_COORD:
 		MSG_WriteFloat( msg, *((float *)( to + field->offset )) );
 		break;
 	case WIRE_HALF_FLOAT:
@@ -476,6 +592,7 @@ static void MSG_ReadField( msg_t *msg, uint8_t *to, const msg_field_t *field ) {
 		*((int64_t *)( to + field->offset )) = MSG_ReadInt64( msg );
 		break;
 	case WIRE_FLOAT:
+	case WIRE_COORD:
 		*((float *)( to + field->offset )) = MSG_ReadFloat( msg );
 		break;
 	case WIRE_HALF_FLOAT:
@@ -907,9 +1024,9 @@ static const msg_field_t ent_state_fields[] = {
 	{ ESOFS( events[0] ), 32, 1, WIRE_UBASE128 },
 	{ ESOFS( eventParms[0] ), 32, 1, WIRE_BASE128 },
 
-	{ ESOFS( origin[0] ), 0, 1, WIRE_FLOAT },
-	{ ESOFS( origin[1] ), 0, 1, WIRE_FLOAT },
-	{ ESOFS( origin[2] ), 0, 1, WIRE_FLOAT },
+	{ ESOFS( origin[0] ), 0, 1, WIRE_COORD },
+	{ ESOFS( origin[1] ), 0, 1, WIRE_COORD },
+	{ ESOFS( origin[2] ), 0, 1, WIRE_COORD },
 
 	{ ESOFS( angles[0] ), 0, 1, WIRE_ANGLE },
 	{ ESOFS( angles[1] ), 0, 1, WIRE_ANGLE },
@@ -978,22 +1095,10 @@ static void MSG_WriteEntityNumber( msg_t *msg, int number, bool remove, unsigned
 }
 
 /*
-* MSG_WriteDeltaEntity
-*
-* Writes part of a packetentities message.
-* Can delta from either a baseline or a previous packet_entity
+* MSG_DeltaEntityNumber
 */
-void MSG_WriteDeltaEntity( msg_t *msg, const entity_state_t *from, const entity_state_t *to, bool force ) {
+static int MSG_DeltaEntityNumber( const entity_state_t *from, const entity_state_t *to ) {
 	int number;
-	unsigned byteMask;
-	uint8_t fieldMask[32] = { 0 };
-	const msg_field_t *fields = ent_state_fields;
-	int numFields = sizeof( ent_state_fields ) / sizeof( ent_state_fields[0] );
-
-	assert( numFields < 256 );
-	if( numFields > 256 ) {
-		Com_Error( ERR_FATAL, "MSG_WriteDeltaEntity: numFields == %i", numFields );
-	}
 
 	if( !to ) {
 		if( !from )
@@ -1011,6 +1116,29 @@ void MSG_WriteDeltaEntity( msg_t *msg, const entity_state_t *from, const entity_
 		Com_Error( ERR_FATAL, "MSG_WriteDeltaEntity: Invalid Entity number" );
 	}
 
+	return number;
+}
+
+/*
+* MSG_WriteDeltaEntity
+*
+* Writes part of a packetentities message.
+* Can delta from either a baseline or a previous packet_entity
+*/
+void MSG_WriteDeltaEntity( msg_t *msg, const entity_state_t *from, const entity_state_t *to, bool force ) {
+	int number;
+	unsigned byteMask;
+	uint8_t fieldMask[32] = { 0 };
+	const msg_field_t *fields = ent_state_fields;
+	int numFields = sizeof( ent_state_fields ) / sizeof( ent_state_fields[0] );
+
+	assert( numFields < 256 );
+	if( numFields > 256 ) {
+		Com_Error( ERR_FATAL, "MSG_WriteDeltaEntity: numFields == %i", numFields );
+	}
+
+	number = MSG_DeltaEntityNumber( from, to );
+
 	if( !to ) {
 		// remove
 		MSG_WriteEntityNumber( msg, number, true, 0 );
@@ -1065,6 +1193,360 @@ void MSG_ReadDeltaEntity( msg_t *msg, const entity_state_t *from, entity_state_t
 	MSG_ReadStructFields( msg, from, to, fields, numFields, fieldMask, sizeof( fieldMask ), byteMask );
 }
 
+/*
+* MSG_QuantizeCoord
+*/
+static int32_t MSG_QuantizeCoord( float v ) {
+	v = v * MSG_COORD_SCALE + 0.5f;
+	if( v <= (float)INT32_MIN ) {
+		return INT32_MIN;
+	}
+	if( v >= (float)INT32_MAX ) {
+		return INT32_MAX;
+	}
+	return (int32_t)floorf( v );
+}
+
+/*
+* MSG_QuantizeAngle
+*/
+static uint32_t MSG_QuantizeAngle( float v, int angleBits ) {
+	return (uint32_t)floorf( anglemod( v ) * ( 1 << angleBits ) / 360.0f + 0.5f ) & ( ( 1U << angleBits ) - 1 );
+}
+
+/*
+* MSG_CompareFieldBits
+*
+* Quantized fields only count as changed when their quantized values differ.
+*/
+static bool MSG_CompareFieldBits( const uint8_t *from, const uint8_t *to, const msg_field_t *field, int angleBits ) {
+	float ftv = *((float *)( to + field->offset ));
+	float ffv = *((float *)( from + field->offset ));
+
+	switch( field->encoding ) {
+		case WIRE_COORD:
+			return MSG_QuantizeCoord( ftv ) != MSG_QuantizeCoord( ffv );
+		case WIRE_ANGLE:
+			return MSG_QuantizeAngle( ftv, angleBits ) != MSG_QuantizeAngle( ffv, angleBits );
+		default:
+			break;
+	}
+
+	return MSG_CompareField( from, to, field );
+}
+
+/*
+* MSG_WriteFieldBits
+*/
+static void MSG_WriteFieldBits( msg_bitstream_t *bs, const uint8_t *from, const uint8_t *to, const msg_field_t *field, int angleBits ) {
+	union {
+		float f;
+		uint32_t u;
+	} dat;
+	int64_t delta;
+	uint64_t zz, value;
+
+	switch( field->encoding ) {
+	case WIRE_BOOL:
+		break;
+	case WIRE_FIXED_INT8:
+		MSG_WriteBits( bs, *((uint8_t *)( to + field->offset )), 8 );
+		break;
+	case WIRE_FIXED_INT16:
+		MSG_WriteBits( bs, *((uint16_t *)( to + field->offset )), 16 );
+		break;
+	case WIRE_FIXED_INT32:
+		MSG_WriteBits( bs, *((uint32_t *)( to + field->offset )), 32 );
+		break;
+	case WIRE_FIXED_INT64:
+		value = *((uint64_t *)( to + field->offset ));
+		MSG_WriteBits( bs, (uint32_t)value, 32 );
+		MSG_WriteBits( bs, (uint32_t)( value >> 32 ), 32 );
+		break;
+	case WIRE_FLOAT:
+		dat.f = *((float *)( to + field->offset ));
+		MSG_WriteBits( bs, dat.u, 32 );
+		break;
+	case WIRE_HALF_FLOAT:
+		MSG_WriteBits( bs, Com_FloatToHalf( *((float *)( to + field->offset )) ), 16 );
+		break;
+	case WIRE_ANGLE:
+		MSG_WriteBits( bs, MSG_QuantizeAngle( *((float *)( to + field->offset )), angleBits ), angleBits );
+		break;
+	case WIRE_COORD:
+		// the quantized value on the other end always matches the quantized base value here,
+		// so the delta against it is exact. Small moves take 7 or 14 bits
+		value = (uint32_t)MSG_QuantizeCoord( *((float *)( to + field->offset )) );
+		delta = (int64_t)(int32_t)value - MSG_QuantizeCoord( *((float *)( from + field->offset )) );
+		zz = (uint64_t)( delta << 1 ) ^ (uint64_t)( delta >> 63 );
+		if( zz < ( 1 << 6 ) ) {
+			MSG_WriteBits( bs, (uint32_t)zz << 1, 7 );
+		} else if( zz < ( 1 << 12 ) ) {
+			MSG_WriteBits( bs, 1 | ( (uint32_t)zz << 2 ), 14 );
+		} else {
+			MSG_WriteBits( bs, 3, 2 );
+			MSG_WriteBits( bs, (uint32_t)value, 32 );
+		}
+		break;
+	case WIRE_BASE128:
+		switch( field->bits ) {
+		case 8:
+			MSG_WriteBits( bs, *((uint8_t *)( to + field->offset )), 8 );
+			break;
+		case 16:
+			delta = *((int16_t *)( to + field->offset ));
+			MSG_WriteBitsVarint( bs, (uint64_t)( delta << 1 ) ^ (uint64_t)( delta >> 63 ) );
+			break;
+		case 32:
+			delta = *((int32_t *)( to + field->offset ));
+			MSG_WriteBitsVarint( bs, (uint64_t)( delta << 1 ) ^ (uint64_t)( delta >> 63 ) );
+			break;
+		case 64:
+			delta = *((int64_t *)( to + field->offset ));
+			MSG_WriteBitsVarint( bs, (uint64_t)( delta << 1 ) ^ (uint64_t)( delta >> 63 ) );
+			break;
+		default:
+			Com_Error( ERR_FATAL, "MSG_WriteFieldBits: unknown base128 field bits value %i", field->bits );
+			break;
+		}
+		break;
+	case WIRE_UBASE128:
+		switch( field->bits ) {
+		case 8:
+			MSG_WriteBits( bs, *((uint8_t *)( to + field->offset )), 8 );
+			break;
+		case 16:
+			MSG_WriteBitsVarint( bs, *((uint16_t *)( to + field->offset )) );
+			break;
+		case 32:
+			MSG_WriteBitsVarint( bs, *((uint32_t *)( to + field->offset )) );
+			break;
+		case 64:
+			MSG_WriteBitsVarint( bs, *((uint64_t *)( to + field->offset )) );
+			break;
+		default:
+			Com_Error( ERR_FATAL, "MSG_WriteFieldBits: unknown base128 field bits value %i", field->bits );
+			break;
+		}
+		break;
+	default:
+		Com_Error( ERR_FATAL, "MSG_WriteFieldBits: unknown encoding type %i", field->encoding );
+		break;
+	}
+}
+
+/*
+* MSG_ReadFieldBits
+*/
+static void MSG_ReadFieldBits( msg_bitstream_t *bs, const uint8_t *from, uint8_t *to, const msg_field_t *field, int angleBits ) {
+	union {
+		float f;
+		uint32_t u;
+	} dat;
+	int32_t coord;
+	uint64_t value;
+
+	switch( field->encoding ) {
+	case WIRE_BOOL:
+		*((bool *)( to + field->offset )) ^= true;
+		break;
+	case WIRE_FIXED_INT8:
+		*((int8_t *)( to + field->offset )) = (int8_t)MSG_ReadBits( bs, 8 );
+		break;
+	case WIRE_FIXED_INT16:
+		*((int16_t *)( to + field->offset )) = (int16_t)MSG_ReadBits( bs, 16 );
+		break;
+	case WIRE_FIXED_INT32:
+		*((int32_t *)( to + field->offset )) = (int32_t)MSG_ReadBits( bs, 32 );
+		break;
+	case WIRE_FIXED_INT64:
+		value = MSG_ReadBits( bs, 32 );
+		value |= (uint64_t)MSG_ReadBits( bs, 32 ) << 32;
+		*((int64_t *)( to + field->offset )) = (int64_t)value;
+		break;
+	case WIRE_FLOAT:
+		dat.u = MSG_ReadBits( bs, 32 );
+		*((float *)( to + field->offset )) = dat.f;
+		break;
+	case WIRE_HALF_FLOAT:
+		*((float *)( to + field->offset )) = Com_HalfToFloat( (unsigned short)MSG_ReadBits( bs, 16 ) );
+		break;
+	case WIRE_ANGLE:
+		*((float *)( to + field->offset )) = MSG_ReadBits( bs, angleBits ) * 360.0f / ( 1 << angleBits );
+		break;
+	case WIRE_COORD:
+		if( !MSG_ReadBits( bs, 1 ) ) {
+			value = MSG_ReadBits( bs, 6 );
+		} else if( !MSG_ReadBits( bs, 1 ) ) {
+			value = MSG_ReadBits( bs, 12 );
+		} else {
+			coord = (int32_t)MSG_ReadBits( bs, 32 );
+			*((float *)( to + field->offset )) = (float)coord / MSG_COORD_SCALE;
+			break;
+		}
+		coord = MSG_QuantizeCoord( *((float *)( from + field->offset )) );
+		coord += (int32_t)( value >> 1 ) ^ -(int32_t)( value & 1 );
+		*((float *)( to + field->offset )) = (float)coord / MSG_COORD_SCALE;
+		break;
+	case WIRE_BASE128:
+		switch( field->bits ) {
+		case 8:
+			*((int8_t *)( to + field->offset )) = (int8_t)MSG_ReadBits( bs, 8 );
+			break;
+		case 16:
+			value = MSG_ReadBitsVarint( bs );
+			*((int16_t *)( to + field->offset )) = (int16_t)( (int64_t)( value >> 1 ) ^ -(int64_t)( value & 1 ) );
+			break;
+		case 32:
+			value = MSG_ReadBitsVarint( bs );
+			*((int32_t *)( to + field->offset )) = (int32_t)( (int64_t)( value >> 1 ) ^ -(int64_t)( value & 1 ) );
+			break;
+		case 64:
+			value = MSG_ReadBitsVarint( bs );
+			*((int64_t *)( to + field->offset )) = (int64_t)( value >> 1 ) ^ -(int64_t)( value & 1 );
+			break;
+		default:
+			Com_Error( ERR_FATAL, "MSG_ReadFieldBits: unknown base128 field bits value %i", field->bits );
+			break;
+		}
+		break;
+	case WIRE_UBASE128:
+		switch( field->bits ) {
+		case 8:
+			*((uint8_t *)( to + field->offset )) = (uint8_t)MSG_ReadBits( bs, 8 );
+			break;
+		case 16:
+			*((uint16_t *)( to + field->offset )) = (uint16_t)MSG_ReadBitsVarint( bs );
+			break;
+		case 32:
+			*((uint32_t *)( to + field->offset )) = (uint32_t)MSG_ReadBitsVarint( bs );
+			break;
+		case 64:
+			*((uint64_t *)( to + field->offset )) = MSG_ReadBitsVarint( bs );
+			break;
+		default:
+			Com_Error( ERR_FATAL, "MSG_ReadFieldBits: unknown base128 field bits value %i", field->bits );
+			break;
+		}
+		break;
+	default:
+		Com_Error( ERR_FATAL, "MSG_ReadFieldBits: unknown encoding type %i", field->encoding );
+		break;
+	}
+}
+
+/*
+* MSG_WriteDeltaEntityBits
+*
+* Bit-packed version of MSG_WriteDeltaEntity. Entity numbers are coded as the gap
+* from the last entity written, the field mask is preceded by a mask of its
+* non-zero bytes and a gap of 0 terminates the list.
+*/
+void MSG_WriteDeltaEntityBits( msg_bitstream_t *bs, const entity_state_t *from, const entity_state_t *to,
+							   int *lastNumber, int angleBits, bool force ) {
+	int i, number;
+	unsigned byteMask, numBytes;
+	uint8_t fieldMask[32] = { 0 };
+	const msg_field_t *fields = ent_state_fields;
+	int numFields = sizeof( ent_state_fields ) / sizeof( ent_state_fields[0] );
+
+	number = MSG_DeltaEntityNumber( from, to );
+	if( number <= *lastNumber ) {
+		Com_Error( ERR_FATAL, "MSG_WriteDeltaEntityBits: Entity numbers out of order" );
+	}
+
+	if( !to ) {
+		// remove
+		MSG_WriteBitsVarint( bs, number - *lastNumber );
+		MSG_WriteBits( bs, 1, 1 );
+		*lastNumber = number;
+		return;
+	}
+
+	byteMask = 0;
+	for( i = 0; i < numFields; i++ ) {
+		if( MSG_CompareFieldBits( ( const uint8_t * )from, ( const uint8_t * )to, &fields[i], angleBits ) ) {
+			fieldMask[i >> 3] |= 1 << ( i & 7 );
+			byteMask |= 1 << ( i >> 3 );
+		}
+	}
+
+	if( !byteMask && !force ) {
+		// no changes
+		return;
+	}
+
+	MSG_WriteBitsVarint( bs, number - *lastNumber );
+	MSG_WriteBits( bs, 0, 1 );
+	*lastNumber = number;
+
+	numBytes = ( numFields + 7 ) >> 3;
+	MSG_WriteBits( bs, byteMask, numBytes );
+	for( i = 0; i < (int)numBytes; i++ ) {
+		if( byteMask & ( 1 << i ) ) {
+			MSG_WriteBits( bs, fieldMask[i], 8 );
+		}
+	}
+
+	for( i = 0; i < numFields; i++ ) {
+		if( fieldMask[i >> 3] & ( 1 << ( i & 7 ) ) ) {
+			MSG_WriteFieldBits( bs, ( const uint8_t * )from, ( const uint8_t * )to, &fields[i], angleBits );
+		}
+	}
+}
+
+/*
+* MSG_ReadEntityNumberBits
+*
+* Returns the entity number and the remove bit, or 0 at the end of the list
+*/
+int MSG_ReadEntityNumberBits( msg_bitstream_t *bs, int *lastNumber, bool *remove ) {
+	uint64_t gap;
+
+	*remove = false;
+
+	gap = MSG_ReadBitsVarint( bs );
+	if( !gap ) {
+		return 0;
+	}
+	if( gap >= MAX_EDICTS ) {
+		return MAX_EDICTS;
+	}
+
+	*remove = MSG_ReadBits( bs, 1 ) ? true : false;
+	*lastNumber += (int)gap;
+	return *lastNumber;
+}
+
+/*
+* MSG_ReadDeltaEntityBits
+*/
+void MSG_ReadDeltaEntityBits( msg_bitstream_t *bs, const entity_state_t *from, entity_state_t *to, int number, int angleBits ) {
+	int i;
+	unsigned byteMask, numBytes;
+	uint8_t fieldMask[32] = { 0 };
+	const msg_field_t *fields = ent_state_fields;
+	int numFields = sizeof( ent_state_fields ) / sizeof( ent_state_fields[0] );
+
+	// set everything to the state we are delta'ing from
+	*to = *from;
+	to->number = number;
+
+	numBytes = ( numFields + 7 ) >> 3;
+	byteMask = MSG_ReadBits( bs, numBytes );
+	for( i = 0; i < (int)numBytes; i++ ) {
+		if( byteMask & ( 1 << i ) ) {
+			fieldMask[i] = MSG_ReadBits( bs, 8 );
+		}
+	}
+
+	for( i = 0; i < numFields; i++ ) {
+		if( fieldMask[i >> 3] & ( 1 << ( i & 7 ) ) ) {
+			MSG_ReadFieldBits( bs, ( const uint8_t * )from, ( uint8_t * )to, &fields[i], angleBits );
+		}
+	}
+}
+
 //==================================================
 // DELTA USER CMDS
 //==================================================
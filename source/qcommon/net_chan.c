@@ -126,11 +126,12 @@ void Netchan_OutOfBandPrint( const socket_t *socket, const netadr_t *address, co
 /*
 * Netchan_Setup
 *
-* called to open a channel to a remote system
+* called to open a channel to a remote system using the given protocol version
 */
-void Netchan_Setup( netchan_t *chan, const socket_t *socket, const netadr_t *address, int game_port ) {
+void Netchan_Setup( netchan_t *chan, const socket_t *socket, const netadr_t *address, int game_port, int protocol ) {
 	memset( chan, 0, sizeof( *chan ) );
 
+	chan->zdict = protocol >= APP_PROTOCOL_VERSION_NETDICT;
 	chan->socket = socket;
 	chan->remoteAddress = *address;
 	chan->game_port = game_port;
@@ -146,84 +147,152 @@ static uint8_t msg_process_data[MAX_MSGLEN];
 //=============================================================
 
 #include "compression.h"
+#include "net_dict.h"
 
-static int Netchan_ZLibCompressChunk( const uint8_t *source, unsigned long sourceLen, uint8_t *dest, unsigned long destLen,
-									  int level, int wbits ) {
-	int result, zlerror;
+// Every message is compressed on its own since UDP packets may be lost or
+// reordered, but the streams are kept around and reset between messages to
+// avoid reallocating the deflate state each time. The preset dictionary
+// gives deflate something to match short messages against. Peers on older
+// protocols get raw deflate streams without the dictionary, so each format
+// has its own pair of streams.
+static cvar_t *net_compresslevel;
+
+static z_stream netchan_deflate[2], netchan_inflate[2];
+static bool netchan_deflateInit[2], netchan_inflateInit[2];
+static int netchan_deflateLevel[2];
 
-	zlerror = qzcompress2( dest, &destLen, source, sourceLen, level );
+/*
+* Netchan_ZLibError
+*/
+static int Netchan_ZLibError( int zlerror, const char *op ) {
 	switch( zlerror ) {
-		case Z_OK:
-			result = destLen; // returns the new length into destLen
-			break;
 		case Z_MEM_ERROR:
-			Com_DPrintf( "ZLib data error! Z_MEM_ERROR on compress.\n" );
-			result = -1;
+			Com_DPrintf( "ZLib data error! Z_MEM_ERROR on %s.\n", op );
 			break;
 		case Z_BUF_ERROR:
-			Com_DPrintf( "ZLib data error! Z_BUF_ERROR on compress.\n" );
-			result = -1;
+			Com_DPrintf( "ZLib data error! Z_BUF_ERROR on %s.\n", op );
 			break;
 		case Z_STREAM_ERROR:
-			Com_DPrintf( "ZLib data error! Z_STREAM_ERROR on compress.\n" );
-			result = -1;
+			Com_DPrintf( "ZLib data error! Z_STREAM_ERROR on %s.\n", op );
+			break;
+		case Z_DATA_ERROR:
+			Com_DPrintf( "ZLib data error! Z_DATA_ERROR on %s.\n", op );
 			break;
 		default:
-			Com_DPrintf( "ZLib data error! Error code %i on compress.\n", zlerror );
-			result = -1;
+			Com_DPrintf( "ZLib data error! Error code %i on %s.\n", zlerror, op );
 			break;
 	}
+	return -1;
+}
+
+/*
+* Netchan_CompressLevel
+*/
+static int Netchan_CompressLevel( void ) {
+	if( !net_compresslevel ) {
+		return Z_BEST_COMPRESSION;
+	}
+	return Q_bound( Z_BEST_SPEED, net_compresslevel->integer, Z_BEST_COMPRESSION );
+}
+
+static int Netchan_ZLibCompressChunk( const uint8_t *source, unsigned long sourceLen, uint8_t *dest, unsigned long destLen,
+									  int level, bool zdict ) {
+	int zlerror;
+	z_stream *strm = &netchan_deflate[zdict];
+
+	if( !netchan_deflateInit[zdict] ) {
+		// zlib wrapped like compress2 does, the dictionary id is stored in the header
+		memset( strm, 0, sizeof( *strm ) );
+		zlerror = qzdeflateInit2( strm, level, Z_DEFLATED, MAX_WBITS, MAX_MEM_LEVEL, Z_DEFAULT_STRATEGY );
+		if( zlerror != Z_OK ) {
+			return Netchan_ZLibError( zlerror, "compress" );
+		}
+		netchan_deflateInit[zdict] = true;
+		netchan_deflateLevel[zdict] = level;
+	} else {
+		qzdeflateReset( strm );
+		if( level != netchan_deflateLevel[zdict] ) {
+			// nothing has been fed to the stream yet so there's nothing to flush
+			qzdeflateParams( strm, level, Z_DEFAULT_STRATEGY );
+			netchan_deflateLevel[zdict] = level;
+		}
+	}
 
-	return result;
+	// the dictionary has to be set again after each reset
+	if( zdict ) {
+		zlerror = qzdeflateSetDictionary( strm, netchan_zdict, netchan_zdictSize );
+		if( zlerror != Z_OK ) {
+			return Netchan_ZLibError( zlerror, "compress" );
+		}
+	}
+
+	strm->next_in = ( Bytef * )source;
+	strm->avail_in = sourceLen;
+	strm->next_out = dest;
+	strm->avail_out = destLen;
+
+	zlerror = qzdeflate( strm, Z_FINISH );
+	if( zlerror != Z_STREAM_END ) {
+		return Netchan_ZLibError( zlerror == Z_OK ? Z_BUF_ERROR : zlerror, "compress" );
+	}
+
+	return strm->total_out;
 }
 
 static int Netchan_ZLibDecompressChunk( const uint8_t *source, unsigned long sourceLen, uint8_t *dest, unsigned long destLen,
-										int wbits ) {
-	int result, zlerror;
+										bool zdict ) {
+	int zlerror;
+	z_stream *strm = &netchan_inflate[zdict];
+
+	if( !netchan_inflateInit[zdict] ) {
+		memset( strm, 0, sizeof( *strm ) );
+		zlerror = qzinflateInit2( strm, MAX_WBITS );
+		if( zlerror != Z_OK ) {
+			return Netchan_ZLibError( zlerror, "decompress" );
+		}
+		netchan_inflateInit[zdict] = true;
+	} else {
+		qzinflateReset( strm );
+	}
 
-	zlerror = qzuncompress( dest, &destLen, source, sourceLen );
-	switch( zlerror ) {
-		case Z_OK:
-			result = destLen; // returns the new length into destLen
-			break;
-		case Z_MEM_ERROR:
-			Com_DPrintf( "ZLib data error! Z_MEM_ERROR on decompress.\n" );
-			result = -1;
-			break;
-		case Z_BUF_ERROR:
-			Com_DPrintf( "ZLib data error! Z_BUF_ERROR on decompress.\n" );
-			result = -1;
-			break;
-		case Z_DATA_ERROR:
-			Com_DPrintf( "ZLib data error! Z_DATA_ERROR on decompress.\n" );
-			result = -1;
-			break;
-		default:
-			Com_DPrintf( "ZLib data error! Error code %i on decompress.\n", zlerror );
-			result = -1;
-			break;
+	strm->next_in = ( Bytef * )source;
+	strm->avail_in = sourceLen;
+	strm->next_out = dest;
+	strm->avail_out = destLen;
+
+	zlerror = qzinflate( strm, Z_FINISH );
+	if( zlerror == Z_NEED_DICT ) {
+		// the zlib header tells whether the message was compressed with the preset
+		// dictionary, inflateSetDictionary rejects any other dictionary id
+		zlerror = qzinflateSetDictionary( strm, netchan_zdict, netchan_zdictSize );
+		if( zlerror != Z_OK ) {
+			return Netchan_ZLibError( Z_DATA_ERROR, "decompress" );
+		}
+		zlerror = qzinflate( strm, Z_FINISH );
+	}
+
+	if( zlerror != Z_STREAM_END ) {
+		return Netchan_ZLibError( zlerror == Z_OK ? Z_BUF_ERROR : zlerror, "decompress" );
 	}
 
-	return result;
+	return strm->total_out;
 }
 
 /*
 * Netchan_CompressMessage
+*
+* zdict tells whether the peer's protocol uses the preset dictionary
 */
-int Netchan_CompressMessage( msg_t *msg ) {
+int Netchan_CompressMessage( msg_t *msg, bool zdict ) {
 	int length;
 
 	if( msg == NULL || !msg->data ) {
 		return 0;
 	}
 
-	// zero-fill our buffer
-	length = 0;
-	memset( msg_process_data, 0, sizeof( msg_process_data ) );
-
 	//compress the message
 	length = Netchan_ZLibCompressChunk( msg->data, msg->cursize,
-										msg_process_data, sizeof( msg_process_data ), Z_BEST_COMPRESSION, -MAX_WBITS );
+										msg_process_data, sizeof( msg_process_data ), Netchan_CompressLevel(), zdict );
 	if( length < 0 ) { // failed to compress, return the error
 		return length;
 	}
@@ -243,7 +312,7 @@ int Netchan_CompressMessage( msg_t *msg ) {
 /*
 * Netchan_DecompressMessage
 */
-int Netchan_DecompressMessage( msg_t *msg ) {
+int Netchan_DecompressMessage( msg_t *msg, bool zdict ) {
 	int length;
 
 	if( msg == NULL || !msg->data ) {
@@ -254,7 +323,7 @@ int Netchan_DecompressMessage( msg_t *msg ) {
 		return 0;
 	}
 
-	length = Netchan_ZLibDecompressChunk( msg->data + msg->readcount, msg->cursize - msg->readcount, msg_process_data, ( sizeof( msg_process_data ) - msg->readcount ), -MAX_WBITS );
+	length = Netchan_ZLibDecompressChunk( msg->data + msg->readcount, msg->cursize - msg->readcount, msg_process_data, ( sizeof( msg_process_data ) - msg->readcount ), zdict );
 	if( length < 0 ) {
 		return length;
 	}
@@ -272,6 +341,24 @@ int Netchan_DecompressMessage( msg_t *msg ) {
 	return length;
 }
 
+/*
+* Netchan_ShutdownCompression
+*/
+static void Netchan_ShutdownCompression( void ) {
+	int i;
+
+	for( i = 0; i < 2; i++ ) {
+		if( netchan_deflateInit[i] ) {
+			qzdeflateEnd( &netchan_deflate[i] );
+			netchan_deflateInit[i] = false;
+		}
+		if( netchan_inflateInit[i] ) {
+			qzinflateEnd( &netchan_inflate[i] );
+			netchan_inflateInit[i] = false;
+		}
+	}
+}
+
 /*
 * Netchan_DropAllFragments
 *
@@ -624,10 +711,12 @@ void Netchan_Init( void ) {
 	showpackets = Cvar_Get( "showpackets", "0", 0 );
 	showdrop = Cvar_Get( "showdrop", "0", 0 );
 	net_showfragments = Cvar_Get( "net_showfragments", "0", 0 );
+	net_compresslevel = Cvar_Get( "net_compresslevel", "9", CVAR_ARCHIVE );
 }
 
 /*
 * Netchan_Shutdown
 */
 void Netchan_Shutdown( void ) {
+	Netchan_ShutdownCompression();
 }
@@ -0,0 +1,41 @@
+/*
+Copyright (C) 2018 Warsow development team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+#include "net_dict.h"
+
+// Strings that show up in reliable commands, configstrings and userinfo.
+// Deflate encodes closer matches with shorter distances, so the most
+// frequent strings go last.
+const unsigned char netchan_zdict[] =
+	"textures/sky/env/gfx/hud/icons/weapon/gfx/hud/icons/powerup/gfx/hud/icons/health/"
+	"gfx/hud/icons/armor/gfx/hud/icons/ammo/gfx/ui/"
+	"models/objects/projectile/models/weapons/models/powerups/models/items/"
+	"sounds/world/sounds/items/sounds/weapons/sounds/announcer/sounds/misc/"
+	"sounds/players/.ogg.wav.md3.iqm.skin.tga.jpg"
+	"bigvic/bobot/monada/padpork/silverclaw/viciious/default"
+	"\\cl_mm_session\\0\\cl_download_name\\\\socket\\\\ip\\\\rate\\\\fov\\\\zoomfov\\\\handicap\\0"
+	"\\hand\\2\\color\\255 255 255\\clan\\\\skin\\default\\model\\models/players/\\name\\"
+	"mapmsg \"motd 1 \"obry \"cvarinfo \"mm \"ti \"cmd \"aw \"ch \"cp \"disconnect\nprecache\nchangelevel\n"
+	" entered the game\n joined the ALPHA team.\n joined the BETA team.\n joined the spectators.\n"
+	" connected\n disconnected\n was killed by ^7\n^3^2^1^7"
+	"scb \"&t 1 &t 2 &s &p \"plstats 0 \"qm \"cs %i \"pr \"cs ";
+
+// the terminating nul isn't part of the dictionary
+const unsigned netchan_zdictSize = sizeof( netchan_zdict ) - 1;
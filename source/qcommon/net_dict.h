@@ -0,0 +1,33 @@
+/*
+Copyright (C) 2018 Warsow development team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+#ifndef NET_DICT_H
+#define NET_DICT_H
+
+// Preset deflate dictionary for netchan messages.
+//
+// Both ends of a connection must use the same dictionary, so any change
+// to it requires a protocol version bump. The dictionary can be
+// regenerated from recorded demos with tools/netcompress_bench -train.
+
+extern const unsigned char netchan_zdict[];
+extern const unsigned netchan_zdictSize;
+
+#endif // NET_DICT_H
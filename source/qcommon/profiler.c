@@ -0,0 +1,419 @@
+/*
+Copyright (C) 2018 Warsow development team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+#include "qcommon.h"
+
+#define PROF_MAX_THREADS        32
+#define PROF_RING_SIZE          0x4000  // events per thread, must be a power of two
+#define PROF_RING_MARGIN        256     // oldest events skipped when the ring has wrapped
+#define PROF_MAX_NAMES          256     // distinct event names per thread, must be a power of two
+#define PROF_MAX_NAME_LENGTH    48
+#define PROF_DEFAULT_FILENAME   "profiles/trace.json"
+
+enum {
+	PROF_EVENT_BEGIN,
+	PROF_EVENT_END,
+	PROF_EVENT_MARK
+};
+
+typedef struct {
+	unsigned name;  // index in the names of the thread
+	int type;
+	uint64_t time;
+} profEvent_t;
+
+typedef struct {
+	int id;
+	bool inUse;     // false once the owner thread has exited, the slot is reused by the next thread
+	char name[32];
+	volatile unsigned head;     // only ever written by the owner thread
+	profEvent_t events[PROF_RING_SIZE];
+
+	// names are copied as the modules passing them in can be unloaded before the dump
+	unsigned numNames;
+	char names[PROF_MAX_NAMES][PROF_MAX_NAME_LENGTH];
+} profThread_t;
+
+static cvar_t *com_profile;
+
+static volatile bool prof_enabled;
+static uint64_t prof_startTime;
+
+static qmutex_t *prof_lock;
+static int prof_numThreads;
+static profThread_t *prof_threads[PROF_MAX_THREADS];
+
+static ATTRIBUTE_THREAD_LOCAL profThread_t *prof_thread;
+
+/*
+* Prof_GetThread
+*/
+static profThread_t *Prof_GetThread( void ) {
+	int i;
+	profThread_t *thread = NULL;
+
+	if( prof_thread ) {
+		return prof_thread;
+	}
+	if( !prof_lock ) {
+		return NULL;
+	}
+
+	QMutex_Lock( prof_lock );
+	for( i = 0; i < prof_numThreads; i++ ) {
+		if( !prof_threads[i]->inUse ) {
+			thread = prof_threads[i];
+			break;
+		}
+	}
+	if( !thread && prof_numThreads < PROF_MAX_THREADS ) {
+		thread = Q_malloc( sizeof( *thread ) );
+		thread->id = prof_numThreads + 1;
+		prof_threads[prof_numThreads++] = thread;
+	}
+	if( thread ) {
+		// events of the previous owner are dropped
+		thread->inUse = true;
+		thread->head = 0;
+		thread->numNames = 0;
+		memset( thread->names, 0, sizeof( thread->names ) );
+		Q_snprintfz( thread->name, sizeof( thread->name ), "thread %i", thread->id );
+		prof_thread = thread;
+	}
+	QMutex_Unlock( prof_lock );
+
+	return prof_thread;
+}
+
+/*
+* Prof_FindName
+*
+* Returns the index of the copy of the name owned by the thread, adding it if needed.
+*/
+static int Prof_FindName( profThread_t *thread, const char *name ) {
+	unsigned i, hash;
+	const char *s;
+
+	hash = 5381;
+	for( s = name; *s && s - name < PROF_MAX_NAME_LENGTH - 1; s++ ) {
+		hash = hash * 33 + ( unsigned char )*s;
+	}
+
+	for( i = 0; i < PROF_MAX_NAMES; i++, hash++ ) {
+		char *slot = thread->names[hash & ( PROF_MAX_NAMES - 1 )];
+
+		if( !slot[0] ) {
+			// keep one slot free so that the probing always ends
+			if( thread->numNames == PROF_MAX_NAMES - 1 ) {
+				return -1;
+			}
+			Q_strncpyz( slot, name, PROF_MAX_NAME_LENGTH );
+			thread->numNames++;
+			return hash & ( PROF_MAX_NAMES - 1 );
+		}
+		if( !strncmp( slot, name, PROF_MAX_NAME_LENGTH - 1 ) ) {
+			return hash & ( PROF_MAX_NAMES - 1 );
+		}
+	}
+
+	return -1;
+}
+
+/*
+* Prof_AddEvent
+*/
+static void Prof_AddEvent( const char *name, int type ) {
+	int index;
+	profEvent_t *ev;
+	profThread_t *thread;
+
+	if( !prof_enabled || !name || !*name ) {
+		return;
+	}
+
+	thread = Prof_GetThread();
+	if( !thread ) {
+		return;
+	}
+
+	index = Prof_FindName( thread, name );
+	if( index < 0 ) {
+		return;
+	}
+
+	ev = &thread->events[thread->head & ( PROF_RING_SIZE - 1 )];
+	ev->name = index;
+	ev->time = Sys_Microseconds();
+	ev->type = type;
+	thread->head++;
+}
+
+/*
+* Prof_Begin
+*/
+void Prof_Begin( const char *name ) {
+	Prof_AddEvent( name, PROF_EVENT_BEGIN );
+}
+
+/*
+* Prof_End
+*/
+void Prof_End( const char *name ) {
+	Prof_AddEvent( name, PROF_EVENT_END );
+}
+
+/*
+* Prof_Mark
+*
+* Records an instant event, such as input being sampled or a frame being presented.
+*/
+void Prof_Mark( const char *name ) {
+	Prof_AddEvent( name, PROF_EVENT_MARK );
+}
+
+/*
+* Prof_SetThreadName
+*/
+void Prof_SetThreadName( const char *name ) {
+	profThread_t *thread = Prof_GetThread();
+
+	if( thread ) {
+		Q_strncpyz( thread->name, name, sizeof( thread->name ) );
+	}
+}
+
+/*
+* Prof_ReleaseThread
+*
+* Must be called by threads which have recorded events before they exit.
+* The events stay around for dumps until another thread takes the slot.
+*/
+void Prof_ReleaseThread( void ) {
+	if( !prof_thread ) {
+		return;
+	}
+
+	QMutex_Lock( prof_lock );
+	prof_thread->inUse = false;
+	prof_thread = NULL;
+	QMutex_Unlock( prof_lock );
+}
+
+/*
+* Prof_EscapeString
+*
+* Escapes the string to be written into JSON.
+*/
+static const char *Prof_EscapeString( const char *in, char *out, size_t size ) {
+	size_t len = 0;
+
+	for( ; *in && len + 2 < size; in++ ) {
+		if( *in == '"' || *in == '\\' ) {
+			out[len++] = '\\';
+		} else if( ( unsigned char )*in < ' ' ) {
+			continue;
+		}
+		out[len++] = *in;
+	}
+	out[len] = '\0';
+
+	return out;
+}
+
+/*
+* Prof_WriteThread
+*/
+static int Prof_WriteThread( int file, const profThread_t *thread, bool *first ) {
+	int depth, numEvents;
+	unsigned i, head, tail;
+	char buf[256], name[PROF_MAX_NAME_LENGTH * 2];
+
+	// names of threads show up in the viewer through metadata events
+	Q_snprintfz( buf, sizeof( buf ), "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%i,\"args\":{\"name\":\"%s\"}}",
+				 *first ? "" : ",\n", thread->id, Prof_EscapeString( thread->name, name, sizeof( name ) ) );
+	FS_Write( buf, strlen( buf ), file );
+	*first = false;
+
+	head = thread->head;
+	tail = 0;
+	if( head > PROF_RING_SIZE ) {
+		// the owner thread might still be overwriting the oldest events
+		tail = head - PROF_RING_SIZE + PROF_RING_MARGIN;
+	}
+
+	depth = 0;
+	numEvents = 0;
+	for( i = tail; i != head; i++ ) {
+		const profEvent_t *ev = &thread->events[i & ( PROF_RING_SIZE - 1 )];
+		const char *ph;
+		double ts;
+
+		if( ev->time < prof_startTime ) {
+			continue;
+		}
+
+		switch( ev->type ) {
+			case PROF_EVENT_BEGIN:
+				ph = "B";
+				depth++;
+				break;
+			case PROF_EVENT_END:
+				// skip ends of scopes whose beginning has been overwritten
+				if( !depth ) {
+					continue;
+				}
+				ph = "E";
+				depth--;
+				break;
+			default:
+				ph = "i";
+				break;
+		}
+
+		ts = (double)( ev->time - prof_startTime );
+		Q_snprintfz( buf, sizeof( buf ), ",\n{\"name\":\"%s\",\"ph\":\"%s\",\"ts\":%.0f,\"pid\":1,\"tid\":%i%s}",
+					 Prof_EscapeString( thread->names[ev->name], name, sizeof( name ) ), ph, ts, thread->id, ev->type == PROF_EVENT_MARK ? ",\"s\":\"g\"" : "" );
+		FS_Write( buf, strlen( buf ), file );
+		numEvents++;
+	}
+
+	return numEvents;
+}
+
+/*
+* Prof_Dump_f
+*/
+static void Prof_Dump_f( void ) {
+	int i, file, numEvents;
+	bool first, wasEnabled;
+	char filename[MAX_QPATH];
+	static const char header[] = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+	static const char footer[] = "\n]}\n";
+
+	if( Cmd_Argc() > 2 ) {
+		Com_Printf( "Usage: %s [filename]\n", Cmd_Argv( 0 ) );
+		return;
+	}
+
+	if( Cmd_Argc() == 2 ) {
+		Q_snprintfz( filename, sizeof( filename ), "profiles/%s", Cmd_Argv( 1 ) );
+		COM_DefaultExtension( filename, ".json", sizeof( filename ) );
+	} else {
+		Q_strncpyz( filename, PROF_DEFAULT_FILENAME, sizeof( filename ) );
+	}
+
+	if( !COM_ValidateRelativeFilename( filename ) ) {
+		Com_Printf( "Invalid filename: %s\n", filename );
+		return;
+	}
+
+	if( FS_FOpenFile( filename, &file, FS_WRITE ) == -1 ) {
+		Com_Printf( "Couldn't open %s for writing\n", filename );
+		return;
+	}
+
+	// stop recording while the buffers are read
+	wasEnabled = prof_enabled;
+	prof_enabled = false;
+
+	FS_Write( header, sizeof( header ) - 1, file );
+
+	first = true;
+	numEvents = 0;
+	QMutex_Lock( prof_lock );
+	for( i = 0; i < prof_numThreads; i++ ) {
+		numEvents += Prof_WriteThread( file, prof_threads[i], &first );
+	}
+	QMutex_Unlock( prof_lock );
+
+	FS_Write( footer, sizeof( footer ) - 1, file );
+	FS_FCloseFile( file );
+
+	prof_enabled = wasEnabled;
+
+	Com_Printf( "Wrote %i events from %i threads to %s\n", numEvents, prof_numThreads, filename );
+}
+
+/*
+* Prof_Clear_f
+*/
+static void Prof_Clear_f( void ) {
+	// events recorded before the start time are ignored by the dump
+	prof_startTime = Sys_Microseconds();
+}
+
+/*
+* Prof_Init
+*/
+void Prof_Init( void ) {
+	prof_lock = QMutex_Create();
+	prof_startTime = Sys_Microseconds();
+
+	com_profile = Cvar_Get( "com_profile", "0", 0 );
+	prof_enabled = com_profile->integer != 0;
+	com_profile->modified = false;
+
+	Cmd_AddCommand( "profile_dump", Prof_Dump_f );
+	Cmd_AddCommand( "profile_clear", Prof_Clear_f );
+
+	Prof_SetThreadName( "main" );
+}
+
+/*
+* Prof_Frame
+*/
+void Prof_Frame( void ) {
+	if( !com_profile || !com_profile->modified ) {
+		return;
+	}
+
+	com_profile->modified = false;
+	prof_enabled = com_profile->integer != 0;
+	if( prof_enabled ) {
+		Prof_Clear_f();
+	}
+}
+
+/*
+* Prof_Shutdown
+*
+* Must be called after all other threads have been stopped.
+*/
+void Prof_Shutdown( void ) {
+	int i;
+
+	if( !prof_lock ) {
+		return;
+	}
+
+	prof_enabled = false;
+
+	Cmd_RemoveCommand( "profile_dump" );
+	Cmd_RemoveCommand( "profile_clear" );
+
+	for( i = 0; i < prof_numThreads; i++ ) {
+		Q_free( prof_threads[i] );
+		prof_threads[i] = NULL;
+	}
+	prof_numThreads = 0;
+	prof_thread = NULL;
+
+	QMutex_Destroy( &prof_lock );
+}
@@ -0,0 +1,43 @@
+/*
+Copyright (C) 2018 Warsow development team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+#ifndef Q_PROFILER_H
+#define Q_PROFILER_H
+
+// Lightweight scoped profiler.
+//
+// Every thread records named begin/end events into its own ring buffer,
+// so recording never takes a lock. Event names are copied by the profiler,
+// so they may come from modules which get unloaded. Threads which exit after
+// recording must call Prof_ReleaseThread to give their buffer back. Recording
+// is enabled by com_profile and the buffers are dumped as Chrome trace JSON
+// by the "profile_dump" command.
+
+void Prof_Init( void );
+void Prof_Shutdown( void );
+void Prof_Frame( void );
+
+void Prof_SetThreadName( const char *name );
+void Prof_ReleaseThread( void );
+void Prof_Begin( const char *name );
+void Prof_End( const char *name );
+void Prof_Mark( const char *name );
+
+#endif // Q_PROFILER_H
@@ -65,6 +65,17 @@ typedef struct msg_field_s {
 	wireType_t encoding;
 } msg_field_t;
 
+// bit-level access to a message, bits are stored least significant first
+typedef struct {
+	msg_t *msg;
+	uint64_t bits;          // bits not yet flushed to or consumed from the message
+	unsigned numBits;
+} msg_bitstream_t;
+
+#define MSG_COORD_SCALE         8       // coordinates are quantized to 1/8 unit in bit-packed entities
+#define MSG_ANGLE_BITS_MIN      8
+#define MSG_ANGLE_BITS_MAX      16
+
 // msg.c
 void MSG_Init( msg_t *buf, uint8_t *data, size_t length );
 void MSG_Clear( msg_t *buf );
@@ -73,6 +84,15 @@ void MSG_WriteData( msg_t *msg, const void *data, size_t length );
 void MSG_CopyData( msg_t *buf, const void *data, size_t length );
 int MSG_SkipData( msg_t *sb, size_t length );
 
+void MSG_BeginWritingBits( msg_bitstream_t *bs, msg_t *msg );
+void MSG_WriteBits( msg_bitstream_t *bs, uint32_t value, unsigned numBits );
+void MSG_WriteBitsVarint( msg_bitstream_t *bs, uint64_t value );
+void MSG_EndWritingBits( msg_bitstream_t *bs );
+void MSG_BeginReadingBits( msg_bitstream_t *bs, msg_t *msg );
+uint32_t MSG_ReadBits( msg_bitstream_t *bs, unsigned numBits );
+uint64_t MSG_ReadBitsVarint( msg_bitstream_t *bs );
+void MSG_EndReadingBits( msg_bitstream_t *bs );
+
 //============================================================================
 
 struct usercmd_s;
@@ -92,6 +112,8 @@ void MSG_WriteString( msg_t *sb, const char *s );
 #define MSG_WriteAngle16( sb, f ) ( MSG_WriteInt16( ( sb ), ANGLE2SHORT( ( f ) ) ) )
 void MSG_WriteDeltaUsercmd( msg_t *sb, const struct usercmd_s *from, struct usercmd_s *cmd );
 void MSG_WriteDeltaEntity( msg_t *msg, const struct entity_state_s *from, const struct entity_state_s *to, bool force );
+void MSG_WriteDeltaEntityBits( msg_bitstream_t *bs, const struct entity_state_s *from, const struct entity_state_s *to,
+							   int *lastNumber, int angleBits, bool force );
 void MSG_WriteDeltaPlayerState( msg_t *msg, const player_state_t *ops, const player_state_t *ps );
 void MSG_WriteDeltaGameState( msg_t *msg, const game_state_t *from, const game_state_t *to );
 void MSG_WriteDir( msg_t *sb, vec3_t vector );
@@ -114,6 +136,8 @@ char *MSG_ReadStringLine( msg_t *sb );
 void MSG_ReadDeltaUsercmd( msg_t *sb, const struct usercmd_s *from, struct usercmd_s *cmd );
 int MSG_ReadEntityNumber( msg_t *msg, bool *remove, unsigned *byteMask );
 void MSG_ReadDeltaEntity( msg_t *msg, const entity_state_t *from, entity_state_t *to, int number, unsigned byteMask );
+int MSG_ReadEntityNumberBits( msg_bitstream_t *bs, int *lastNumber, bool *remove );
+void MSG_ReadDeltaEntityBits( msg_bitstream_t *bs, const entity_state_t *from, entity_state_t *to, int number, int angleBits );
 void MSG_ReadDeltaPlayerState( msg_t *msg, const player_state_t *ops, player_state_t *ps );
 void MSG_ReadDeltaGameState( msg_t *msg, const game_state_t *from, game_state_t *to );
 void MSG_ReadDir( msg_t *sb, vec3_t vector );
@@ -140,6 +164,31 @@ void Com_FreePureList( purelist_t **purelist );
 // define this 0 to disable compression of demo files
 #define SNAP_DEMO_GZ                    FS_GZ
 
+#define SNAP_DEMO_KEYFRAME_INTERVAL     10000   // milliseconds between non-delta frames in demos
+#define SNAP_DEMO_INDEX_META_KEY        "keyframes"
+
+// a point in a demo where playback can start without any of the earlier frames
+typedef struct {
+	int64_t serverTime;
+	int offset;                 // demo file offset playback resumes from
+	int numConfigstrings;       // configstring changes that apply up to this keyframe
+	int frameLength;            // full frame parsed before resuming, made by the indexer for old demos
+	uint8_t *frame;
+} snapDemoKeyframe_t;
+
+typedef struct {
+	int index;
+	char string[MAX_CONFIGSTRING_CHARS];
+} snapDemoConfigstring_t;
+
+typedef struct {
+	int numKeyframes, maxKeyframes;
+	snapDemoKeyframe_t *keyframes;
+	int numConfigstrings, maxConfigstrings;
+	snapDemoConfigstring_t *configstrings;
+	char *lastConfigstrings;    // state at the last keyframe, MAX_CONFIGSTRINGS * MAX_CONFIGSTRING_CHARS
+} snapDemoIndex_t;
+
 void SNAP_ParseBaseline( msg_t *msg, entity_state_t *baselines );
 void SNAP_SkipFrame( msg_t *msg, struct snapshot_s *header );
 struct snapshot_s *SNAP_ParseFrame( msg_t *msg, struct snapshot_s *lastFrame, int *suppressCount, struct snapshot_s *backup, entity_state_t *baselines, int showNet );
@@ -166,6 +215,16 @@ size_t SNAP_ClearDemoMeta( char *meta_data, size_t meta_data_max_size );
 size_t SNAP_SetDemoMetaKeyValue( char *meta_data, size_t meta_data_max_size, size_t meta_data_realsize,
 								 const char *key, const char *value );
 size_t SNAP_ReadDemoMetaData( int demofile, char *meta_data, size_t meta_data_size );
+const char *SNAP_GetDemoMetaKeyValue( const char *meta_data, size_t meta_data_realsize, const char *key );
+
+void SNAP_AddDemoKeyframe( snapDemoIndex_t *index, int offset, int64_t serverTime, const char *configstrings,
+						   const uint8_t *frame, int frameLength );
+void SNAP_RemoveLastDemoKeyframe( snapDemoIndex_t *index );
+const snapDemoKeyframe_t *SNAP_FindDemoKeyframe( const snapDemoIndex_t *index, int64_t serverTime );
+void SNAP_GetDemoKeyframeConfigstrings( const snapDemoIndex_t *index, const snapDemoKeyframe_t *keyframe, char *configstrings );
+int SNAP_WriteDemoIndex( int demofile, const snapDemoIndex_t *index );
+bool SNAP_ReadDemoIndex( int demofile, snapDemoIndex_t *index );
+void SNAP_FreeDemoIndex( snapDemoIndex_t *index );
 
 //============================================================================
 
@@ -250,7 +309,8 @@ enum svc_ops_e {
 	svc_servercs,           //tmp jalfixme : send reliable commands as unreliable
 	svc_frame,
 	svc_demoinfo,
-	svc_extension           // for future expansion
+	svc_extension,          // for future expansion
+	svc_bitpacketentities   // [angle bits] [bit-packed entity deltas]
 };
 
 //==============================================
@@ -549,6 +609,8 @@ typedef struct {
 	uint8_t unsentBuffer[MAX_MSGLEN];
 	bool unsentIsCompressed;
 
+	bool zdict;                 // messages are compressed with the preset dictionary
+
 	bool fatal_error;
 } netchan_t;
 
@@ -557,13 +619,13 @@ extern netadr_t net_from;
 
 void Netchan_Init( void );
 void Netchan_Shutdown( void );
-void Netchan_Setup( netchan_t *chan, const socket_t *socket, const netadr_t *address, int qport );
+void Netchan_Setup( netchan_t *chan, const socket_t *socket, const netadr_t *address, int qport, int protocol );
 bool Netchan_Process( netchan_t *chan, msg_t *msg );
 bool Netchan_Transmit( netchan_t *chan, msg_t *msg );
 bool Netchan_PushAllFragments( netchan_t *chan );
 bool Netchan_TransmitNextFragment( netchan_t *chan );
-int Netchan_CompressMessage( msg_t *msg );
-int Netchan_DecompressMessage( msg_t *msg );
+int Netchan_CompressMessage( msg_t *msg, bool zdict );
+int Netchan_DecompressMessage( msg_t *msg, bool zdict );
 void Netchan_OutOfBand( const socket_t *socket, const netadr_t *address, size_t length, const uint8_t *data );
 
 #ifndef _MSC_VER
@@ -977,6 +1039,15 @@ MULTITHREADING
 /*
 ==============================================================
 
+PROFILING
+
+==============================================================
+*/
+#include "profiler.h"
+
+/*
+==============================================================
+
 AUTOMATIC UPDATES
 
 ==============================================================
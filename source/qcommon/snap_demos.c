@@ -410,3 +410,330 @@ size_t SNAP_ReadDemoMetaData( int demofile, char *meta_data, size_t meta_data_si
 
 	return meta_data_realsize;
 }
+
+/*
+* SNAP_GetDemoMetaKeyValue
+*
+* Returns the value stored for the key by SNAP_SetDemoMetaKeyValue, or NULL.
+*/
+const char *SNAP_GetDemoMetaKeyValue( const char *meta_data, size_t meta_data_realsize, const char *key ) {
+	const char *s, *m_val;
+	const char *end = meta_data + meta_data_realsize;
+
+	for( s = meta_data; s < end && *s; ) {
+		m_val = s + strlen( s ) + 1;
+		if( m_val >= end ) {
+			break;
+		}
+		if( !Q_stricmp( s, key ) ) {
+			return m_val;
+		}
+		s = m_val + strlen( m_val ) + 1;
+	}
+
+	return NULL;
+}
+
+/*
+=============================================================================
+
+DEMO KEYFRAME INDEX
+
+Recorders write a non-delta frame every SNAP_DEMO_KEYFRAME_INTERVAL
+milliseconds and note where the message holding it starts. On stop, the
+list is appended after the terminating -1, where demo players don't look,
+and its offset is stored in the meta data under SNAP_DEMO_INDEX_META_KEY.
+
+The index is written as more length-prefixed messages. Configstring changes
+come right before the keyframe they apply to, so a player can restore the
+configstrings of any keyframe without reading the demo up to it.
+
+=============================================================================
+*/
+
+enum {
+	DEMOINDEX_CONFIGSTRING = 1,
+	DEMOINDEX_KEYFRAME
+};
+
+/*
+* SNAP_AddDemoIndexConfigstring
+*/
+static void SNAP_AddDemoIndexConfigstring( snapDemoIndex_t *index, int num, const char *string ) {
+	snapDemoConfigstring_t *cs;
+
+	if( index->numConfigstrings == index->maxConfigstrings ) {
+		index->maxConfigstrings = index->maxConfigstrings ? index->maxConfigstrings * 2 : 256;
+		if( index->configstrings ) {
+			index->configstrings = Mem_Realloc( index->configstrings, index->maxConfigstrings * sizeof( *cs ) );
+		} else {
+			index->configstrings = Mem_ZoneMalloc( index->maxConfigstrings * sizeof( *cs ) );
+		}
+	}
+
+	cs = &index->configstrings[index->numConfigstrings++];
+	cs->index = num;
+	Q_strncpyz( cs->string, string, sizeof( cs->string ) );
+}
+
+/*
+* SNAP_AddDemoIndexKeyframe
+*/
+static void SNAP_AddDemoIndexKeyframe( snapDemoIndex_t *index, int offset, int64_t serverTime,
+									   const uint8_t *frame, int frameLength ) {
+	snapDemoKeyframe_t *keyframe;
+
+	if( index->numKeyframes == index->maxKeyframes ) {
+		index->maxKeyframes = index->maxKeyframes ? index->maxKeyframes * 2 : 64;
+		if( index->keyframes ) {
+			index->keyframes = Mem_Realloc( index->keyframes, index->maxKeyframes * sizeof( *keyframe ) );
+		} else {
+			index->keyframes = Mem_ZoneMalloc( index->maxKeyframes * sizeof( *keyframe ) );
+		}
+	}
+
+	keyframe = &index->keyframes[index->numKeyframes++];
+	keyframe->serverTime = serverTime;
+	keyframe->offset = offset;
+	keyframe->numConfigstrings = index->numConfigstrings;
+	keyframe->frameLength = 0;
+	keyframe->frame = NULL;
+	if( frame && frameLength > 0 ) {
+		keyframe->frameLength = frameLength;
+		keyframe->frame = Mem_ZoneMalloc( frameLength );
+		memcpy( keyframe->frame, frame, frameLength );
+	}
+}
+
+/*
+* SNAP_AddDemoKeyframe
+*
+* Adds a keyframe at the given demo file offset. Configstrings are the ones
+* in effect once the message at the offset has been parsed, laid out like
+* in SNAP_BeginDemoRecording. Only the changes since the previous keyframe
+* are stored.
+*/
+void SNAP_AddDemoKeyframe( snapDemoIndex_t *index, int offset, int64_t serverTime, const char *configstrings,
+						   const uint8_t *frame, int frameLength ) {
+	int i;
+
+	if( !index->lastConfigstrings ) {
+		index->lastConfigstrings = Mem_ZoneMalloc( MAX_CONFIGSTRINGS * MAX_CONFIGSTRING_CHARS );
+	}
+
+	for( i = 0; i < MAX_CONFIGSTRINGS; i++ ) {
+		const char *cs = configstrings + i * MAX_CONFIGSTRING_CHARS;
+		char *last = index->lastConfigstrings + i * MAX_CONFIGSTRING_CHARS;
+
+		if( strncmp( cs, last, MAX_CONFIGSTRING_CHARS ) ) {
+			Q_strncpyz( last, cs, MAX_CONFIGSTRING_CHARS );
+			SNAP_AddDemoIndexConfigstring( index, i, last );
+		}
+	}
+
+	SNAP_AddDemoIndexKeyframe( index, offset, serverTime, frame, frameLength );
+}
+
+/*
+* SNAP_RemoveLastDemoKeyframe
+*
+* The configstring changes stay and will apply to the next keyframe.
+*/
+void SNAP_RemoveLastDemoKeyframe( snapDemoIndex_t *index ) {
+	snapDemoKeyframe_t *keyframe;
+
+	if( !index->numKeyframes ) {
+		return;
+	}
+
+	keyframe = &index->keyframes[--index->numKeyframes];
+	if( keyframe->frame ) {
+		Mem_Free( keyframe->frame );
+		keyframe->frame = NULL;
+	}
+}
+
+/*
+* SNAP_FindDemoKeyframe
+*
+* Returns the last keyframe at or before serverTime.
+*/
+const snapDemoKeyframe_t *SNAP_FindDemoKeyframe( const snapDemoIndex_t *index, int64_t serverTime ) {
+	int lo, hi, mid;
+
+	if( !index->numKeyframes || index->keyframes[0].serverTime > serverTime ) {
+		return NULL;
+	}
+
+	lo = 0;
+	hi = index->numKeyframes - 1;
+	while( lo < hi ) {
+		mid = ( lo + hi + 1 ) / 2;
+		if( index->keyframes[mid].serverTime <= serverTime ) {
+			lo = mid;
+		} else {
+			hi = mid - 1;
+		}
+	}
+
+	return &index->keyframes[lo];
+}
+
+/*
+* SNAP_GetDemoKeyframeConfigstrings
+*/
+void SNAP_GetDemoKeyframeConfigstrings( const snapDemoIndex_t *index, const snapDemoKeyframe_t *keyframe, char *configstrings ) {
+	int i;
+	const snapDemoConfigstring_t *cs;
+
+	memset( configstrings, 0, MAX_CONFIGSTRINGS * MAX_CONFIGSTRING_CHARS );
+
+	for( i = 0, cs = index->configstrings; i < keyframe->numConfigstrings; i++, cs++ ) {
+		Q_strncpyz( configstrings + cs->index * MAX_CONFIGSTRING_CHARS, cs->string, MAX_CONFIGSTRING_CHARS );
+	}
+}
+
+/*
+* SNAP_WriteDemoIndex
+*
+* Call after SNAP_StopDemoRecording. Returns the offset of the index.
+*/
+int SNAP_WriteDemoIndex( int demofile, const snapDemoIndex_t *index ) {
+	int i, j, offset;
+	msg_t msg;
+	uint8_t msg_buffer[MAX_MSGLEN];
+	const snapDemoKeyframe_t *keyframe;
+	const snapDemoConfigstring_t *cs;
+
+	offset = FS_Tell( demofile );
+
+	MSG_Init( &msg, msg_buffer, sizeof( msg_buffer ) );
+
+	for( i = 0, j = 0; i < index->numKeyframes; i++ ) {
+		keyframe = &index->keyframes[i];
+
+		for( ; j < keyframe->numConfigstrings; j++ ) {
+			cs = &index->configstrings[j];
+			MSG_WriteUint8( &msg, DEMOINDEX_CONFIGSTRING );
+			MSG_WriteInt16( &msg, cs->index );
+			MSG_WriteString( &msg, cs->string );
+
+			DEMO_SAFEWRITE( demofile, &msg, false );
+		}
+
+		// synthesized frames are kept under half a message in size
+		MSG_WriteUint8( &msg, DEMOINDEX_KEYFRAME );
+		MSG_WriteIntBase128( &msg, keyframe->serverTime );
+		MSG_WriteInt32( &msg, keyframe->offset );
+		MSG_WriteInt32( &msg, keyframe->frameLength );
+		MSG_WriteData( &msg, keyframe->frame, keyframe->frameLength );
+
+		DEMO_SAFEWRITE( demofile, &msg, false );
+	}
+
+	if( msg.cursize ) {
+		DEMO_SAFEWRITE( demofile, &msg, true );
+	}
+
+	SNAP_StopDemoRecording( demofile );
+
+	return offset;
+}
+
+/*
+* SNAP_ReadDemoIndex
+*
+* Reads an index written by SNAP_WriteDemoIndex from the current file position.
+*/
+bool SNAP_ReadDemoIndex( int demofile, snapDemoIndex_t *index ) {
+	int len, num, offset, frameLength;
+	int64_t serverTime;
+	msg_t msg;
+	uint8_t msg_buffer[MAX_MSGLEN];
+
+	memset( index, 0, sizeof( *index ) );
+
+	MSG_Init( &msg, msg_buffer, sizeof( msg_buffer ) );
+
+	while( true ) {
+		if( FS_Read( &len, 4, demofile ) != 4 ) {
+			goto error;
+		}
+		len = LittleLong( len );
+		if( len == -1 ) {
+			break;
+		}
+		if( len < 0 || len > MAX_MSGLEN || FS_Read( msg_buffer, len, demofile ) != len ) {
+			goto error;
+		}
+
+		msg.cursize = len;
+		msg.readcount = 0;
+
+		while( msg.readcount < msg.cursize ) {
+			switch( MSG_ReadUint8( &msg ) ) {
+				case DEMOINDEX_CONFIGSTRING:
+					num = MSG_ReadInt16( &msg );
+					if( num < 0 || num >= MAX_CONFIGSTRINGS ) {
+						goto error;
+					}
+					SNAP_AddDemoIndexConfigstring( index, num, MSG_ReadString( &msg ) );
+					break;
+
+				case DEMOINDEX_KEYFRAME:
+					serverTime = MSG_ReadIntBase128( &msg );
+					offset = MSG_ReadInt32( &msg );
+					frameLength = MSG_ReadInt32( &msg );
+					if( offset < 0 || frameLength < 0 || frameLength > (int)( msg.cursize - msg.readcount ) ) {
+						goto error;
+					}
+					if( index->numKeyframes && index->keyframes[index->numKeyframes - 1].serverTime > serverTime ) {
+						goto error;
+					}
+					SNAP_AddDemoIndexKeyframe( index, offset, serverTime, msg.data + msg.readcount, frameLength );
+					MSG_SkipData( &msg, frameLength );
+					break;
+
+				default:
+					goto error;
+			}
+		}
+
+		if( msg.readcount > msg.cursize ) {
+			goto error;
+		}
+	}
+
+	if( !index->numKeyframes ) {
+		goto error;
+	}
+	return true;
+
+error:
+	SNAP_FreeDemoIndex( index );
+	return false;
+}
+
+/*
+* SNAP_FreeDemoIndex
+*/
+void SNAP_FreeDemoIndex( snapDemoIndex_t *index ) {
+	int i;
+
+	for( i = 0; i < index->numKeyframes; i++ ) {
+		if( index->keyframes[i].frame ) {
+			Mem_Free( index->keyframes[i].frame );
+		}
+	}
+	if( index->keyframes ) {
+		Mem_Free( index->keyframes );
+	}
+	if( index->configstrings ) {
+		Mem_Free( index->configstrings );
+	}
+	if( index->lastConfigstrings ) {
+		Mem_Free( index->lastConfigstrings );
+	}
+
+	memset( index, 0, sizeof( *index ) );
+}
@@ -45,7 +45,8 @@ const char * const svc_strings[256] =
 	"svc_servercs", // reliable command as unreliable for demos
 	"svc_frame",
 	"svc_demoinfo",
-	"svc_extension"
+	"svc_extension",
+	"svc_bitpacketentities"
 };
 
 void _SHOWNET( msg_t *msg, const char *s, int shownet ) {
@@ -89,6 +90,17 @@ static void SNAP_ParseDeltaEntity( msg_t *msg, snapshot_t *frame, int newnum, en
 	MSG_ReadDeltaEntity( msg, old, state, newnum, byteMask );
 }
 
+/*
+* SNAP_ParseDeltaEntityBits
+*/
+static void SNAP_ParseDeltaEntityBits( msg_bitstream_t *bits, int angleBits, snapshot_t *frame, int newnum, entity_state_t *old ) {
+	entity_state_t *state;
+
+	state = &frame->parsedEntities[frame->numEntities & ( MAX_PARSE_ENTITIES - 1 )];
+	frame->numEntities++;
+	MSG_ReadDeltaEntityBits( bits, old, state, newnum, angleBits );
+}
+
 /*
 * SNAP_ParseBaseline
 */
@@ -114,18 +126,26 @@ void SNAP_ParseBaseline( msg_t *msg, entity_state_t *baselines ) {
 /*
 * SNAP_ParsePacketEntities
 *
-* An svc_packetentities has just been parsed, deal with the
-* rest of the data stream.
+* An svc_packetentities or svc_bitpacketentities has just been parsed,
+* deal with the rest of the data stream.
 */
-static void SNAP_ParsePacketEntities( msg_t *msg, snapshot_t *oldframe, snapshot_t *newframe, entity_state_t *baselines, int shownet ) {
+static void SNAP_ParsePacketEntities( msg_t *msg, snapshot_t *oldframe, snapshot_t *newframe, entity_state_t *baselines, int shownet,
+									  bool bitpacked ) {
 	int newnum;
 	bool remove;
-	unsigned byteMask;
+	unsigned byteMask = 0;
 	entity_state_t *oldstate = NULL;
 	int oldindex, oldnum;
+	int angleBits = 0, lastNumber = 0;
+	msg_bitstream_t bits;
 
 	newframe->numEntities = 0;
 
+	if( bitpacked ) {
+		MSG_BeginReadingBits( &bits, msg );
+		angleBits = MSG_ReadBits( &bits, 4 ) + 1;
+	}
+
 	// delta from the entities present in oldframe
 	oldindex = 0;
 	if( !oldframe ) {
@@ -138,7 +158,11 @@ static void SNAP_ParsePacketEntities( msg_t *msg, snapshot_t *oldframe, snapshot
 	}
 
 	while( true ) {
-		newnum = MSG_ReadEntityNumber( msg, &remove, &byteMask );
+		if( bitpacked ) {
+			newnum = MSG_ReadEntityNumberBits( &bits, &lastNumber, &remove );
+		} else {
+			newnum = MSG_ReadEntityNumber( msg, &remove, &byteMask );
+		}
 		if( newnum >= MAX_EDICTS ) {
 			Com_Error( ERR_DROP, "CL_ParsePacketEntities: bad number:%i", newnum );
 		}
@@ -179,7 +203,11 @@ static void SNAP_ParsePacketEntities( msg_t *msg, snapshot_t *oldframe, snapshot
 				Com_Printf( "   baseline: %i\n", newnum );
 			}
 
-			SNAP_ParseDeltaEntity( msg, newframe, newnum, &baselines[newnum], byteMask );
+			if( bitpacked ) {
+				SNAP_ParseDeltaEntityBits( &bits, angleBits, newframe, newnum, &baselines[newnum] );
+			} else {
+				SNAP_ParseDeltaEntity( msg, newframe, newnum, &baselines[newnum], byteMask );
+			}
 			continue;
 		}
 
@@ -209,7 +237,11 @@ static void SNAP_ParsePacketEntities( msg_t *msg, snapshot_t *oldframe, snapshot
 				Com_Printf( "   delta: %i\n", newnum );
 			}
 
-			SNAP_ParseDeltaEntity( msg, newframe, newnum, oldstate, byteMask );
+			if( bitpacked ) {
+				SNAP_ParseDeltaEntityBits( &bits, angleBits, newframe, newnum, oldstate );
+			} else {
+				SNAP_ParseDeltaEntity( msg, newframe, newnum, oldstate, byteMask );
+			}
 
 			oldindex++;
 			if( oldindex >= oldframe->numEntities ) {
@@ -222,6 +254,10 @@ static void SNAP_ParsePacketEntities( msg_t *msg, snapshot_t *oldframe, snapshot
 		}
 	}
 
+	if( bitpacked ) {
+		MSG_EndReadingBits( &bits );
+	}
+
 	// any remaining entities in the old frame are copied over
 	while( oldnum != 99999 ) {
 		// one or more entities from the old packet are unchanged
@@ -440,10 +476,10 @@ snapshot_t *SNAP_ParseFrame( msg_t *msg, snapshot_t *lastFrame, int *suppressCou
 	// read packet entities
 	cmd = MSG_ReadUint8( msg );
 	_SHOWNET( msg, svc_strings[cmd], showNet );
-	if( cmd != svc_packetentities ) {
+	if( cmd != svc_packetentities && cmd != svc_bitpacketentities ) {
 		Com_Error( ERR_DROP, "SNAP_ParseFrame: not packetentities" );
 	}
-	SNAP_ParsePacketEntities( msg, deltaframe, newframe, baselines, showNet );
+	SNAP_ParsePacketEntities( msg, deltaframe, newframe, baselines, showNet, cmd == svc_bitpacketentities );
 
 	return newframe;
 }
@@ -29,18 +29,41 @@ Encode a client frame onto the network channel
 =========================================================================
 */
 
+/*
+* SNAP_EmitDeltaEntity
+*/
+static void SNAP_EmitDeltaEntity( msg_t *msg, msg_bitstream_t *bits, int *lastNumber, int angleBits,
+								  const entity_state_t *from, const entity_state_t *to, bool force ) {
+	if( bits ) {
+		MSG_WriteDeltaEntityBits( bits, from, to, lastNumber, angleBits, force );
+	} else {
+		MSG_WriteDeltaEntity( msg, from, to, force );
+	}
+}
+
 /*
 * SNAP_EmitPacketEntities
 *
 * Writes a delta update of an entity_state_t list to the message.
+* The entities are bit-packed unless angleBits is 0.
 */
-static void SNAP_EmitPacketEntities( ginfo_t *gi, client_snapshot_t *from, client_snapshot_t *to, msg_t *msg, entity_state_t *baselines, entity_state_t *client_entities, int num_client_entities ) {
+static void SNAP_EmitPacketEntities( ginfo_t *gi, client_snapshot_t *from, client_snapshot_t *to, msg_t *msg, entity_state_t *baselines, entity_state_t *client_entities, int num_client_entities,
+									 int angleBits ) {
 	entity_state_t *oldent, *newent;
 	int oldindex, newindex;
 	int oldnum, newnum;
 	int from_num_entities;
-
-	MSG_WriteUint8( msg, svc_packetentities );
+	int lastNumber = 0;
+	msg_bitstream_t bitstream, *bits = NULL;
+
+	if( angleBits ) {
+		MSG_WriteUint8( msg, svc_bitpacketentities );
+		bits = &bitstream;
+		MSG_BeginWritingBits( bits, msg );
+		MSG_WriteBits( bits, angleBits - 1, 4 );
+	} else {
+		MSG_WriteUint8( msg, svc_packetentities );
+	}
 
 	if( !from ) {
 		from_num_entities = 0;
@@ -73,7 +96,7 @@ static void SNAP_EmitPacketEntities( ginfo_t *gi, client_snapshot_t *from, clien
 			// in any bytes being emited if the entity has not changed at all
 			// note that players are always 'newentities', this updates their oldorigin always
 			// and prevents warping ( wsw : jal : I removed it from the players )
-			MSG_WriteDeltaEntity( msg, oldent, newent, false );
+			SNAP_EmitDeltaEntity( msg, bits, &lastNumber, angleBits, oldent, newent, false );
 			oldindex++;
 			newindex++;
 			continue;
@@ -81,20 +104,25 @@ static void SNAP_EmitPacketEntities( ginfo_t *gi, client_snapshot_t *from, clien
 
 		if( newnum < oldnum ) {
 			// this is a new entity, send it from the baseline
-			MSG_WriteDeltaEntity( msg, &baselines[newnum], newent, true );
+			SNAP_EmitDeltaEntity( msg, bits, &lastNumber, angleBits, &baselines[newnum], newent, true );
 			newindex++;
 			continue;
 		}
 
 		if( newnum > oldnum ) {
 			// the old entity isn't present in the new message
-			MSG_WriteDeltaEntity( msg, oldent, NULL, false );
+			SNAP_EmitDeltaEntity( msg, bits, &lastNumber, angleBits, oldent, NULL, false );
 			oldindex++;
 			continue;
 		}
 	}
 
-	MSG_WriteInt16( msg, 0 ); // end of packetentities
+	if( bits ) {
+		MSG_WriteBitsVarint( bits, 0 ); // end of packetentities
+		MSG_EndWritingBits( bits );
+	} else {
+		MSG_WriteInt16( msg, 0 ); // end of packetentities
+	}
 }
 
 /*
@@ -270,7 +298,7 @@ void SNAP_WriteFrameSnapToClient( ginfo_t *gi, client_t *client, msg_t *msg, int
 								  entity_state_t *baselines, client_entities_t *client_entities,
 								  int numcmds, gcommand_t *commands, const char *commandsData ) {
 	client_snapshot_t *frame, *oldframe;
-	int flags, i, index, pos, length, supcnt;
+	int flags, i, index, pos, length, supcnt, angleBits;
 
 	// this is the frame we are creating
 	frame = &client->snapShots[frameNum & UPDATE_MASK];
@@ -383,8 +411,13 @@ void SNAP_WriteFrameSnapToClient( ginfo_t *gi, client_t *client, msg_t *msg, int
 	}
 	MSG_WriteUint8( msg, 0 );
 
-	// delta encode the entities
-	SNAP_EmitPacketEntities( gi, oldframe, frame, msg, baselines, client_entities ? client_entities->entities : NULL, client_entities ? client_entities->num_entities : 0 );
+	// delta encode the entities, clients using older protocols get them byte-aligned
+	angleBits = 0;
+	if( client->protocol >= APP_PROTOCOL_VERSION_BITPACK ) {
+		angleBits = Q_bound( MSG_ANGLE_BITS_MIN, sv_anglebits->integer, MSG_ANGLE_BITS_MAX );
+	}
+	SNAP_EmitPacketEntities( gi, oldframe, frame, msg, baselines, client_entities ? client_entities->entities : NULL, client_entities ? client_entities->num_entities : 0,
+							 angleBits );
 
 	// write length into reserved space
 	length = msg->cursize - pos - 2;
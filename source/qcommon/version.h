@@ -69,17 +69,44 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 #ifndef APP_PROTOCOL_VERSION
 #ifdef PUBLIC_BUILD
-#define APP_PROTOCOL_VERSION            1
+#define APP_PROTOCOL_VERSION            3
 #else
-#define APP_PROTOCOL_VERSION            1001    // we're using revision number as protocol version for internal builds
+#define APP_PROTOCOL_VERSION            1003    // we're using revision number as protocol version for internal builds
+#endif
+#endif
+
+// oldest protocol version servers still accept connections from
+#ifndef APP_PROTOCOL_VERSION_MIN
+#ifdef PUBLIC_BUILD
+#define APP_PROTOCOL_VERSION_MIN        1
+#else
+#define APP_PROTOCOL_VERSION_MIN        1001
+#endif
+#endif
+
+// first protocol version with netchan messages compressed using the preset dictionary
+#ifndef APP_PROTOCOL_VERSION_NETDICT
+#ifdef PUBLIC_BUILD
+#define APP_PROTOCOL_VERSION_NETDICT    2
+#else
+#define APP_PROTOCOL_VERSION_NETDICT    1002
+#endif
+#endif
+
+// first protocol version with bit-packed entity deltas
+#ifndef APP_PROTOCOL_VERSION_BITPACK
+#ifdef PUBLIC_BUILD
+#define APP_PROTOCOL_VERSION_BITPACK    3
+#else
+#define APP_PROTOCOL_VERSION_BITPACK    1003
 #endif
 #endif
 
 #ifndef APP_DEMO_PROTOCOL_VERSION
 #ifdef PUBLIC_BUILD
-#define APP_DEMO_PROTOCOL_VERSION       1
+#define APP_DEMO_PROTOCOL_VERSION       2
 #else
-#define APP_DEMO_PROTOCOL_VERSION       1001
+#define APP_DEMO_PROTOCOL_VERSION       1002
 #endif
 #endif
 
@@ -45,15 +45,36 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #endif
 
 #ifdef PUBLIC_BUILD
-#define APP_PROTOCOL_VERSION            1
+#define APP_PROTOCOL_VERSION            3
 #else
-#define APP_PROTOCOL_VERSION            1000
+#define APP_PROTOCOL_VERSION            1002
 #endif
 
+// oldest protocol version servers still accept connections from
 #ifdef PUBLIC_BUILD
-#define APP_DEMO_PROTOCOL_VERSION       1
+#define APP_PROTOCOL_VERSION_MIN        1
 #else
-#define APP_DEMO_PROTOCOL_VERSION       1
+#define APP_PROTOCOL_VERSION_MIN        1000
+#endif
+
+// first protocol version with netchan messages compressed using the preset dictionary
+#ifdef PUBLIC_BUILD
+#define APP_PROTOCOL_VERSION_NETDICT    2
+#else
+#define APP_PROTOCOL_VERSION_NETDICT    1001
+#endif
+
+// first protocol version with bit-packed entity deltas
+#ifdef PUBLIC_BUILD
+#define APP_PROTOCOL_VERSION_BITPACK    3
+#else
+#define APP_PROTOCOL_VERSION_BITPACK    1002
+#endif
+
+#ifdef PUBLIC_BUILD
+#define APP_DEMO_PROTOCOL_VERSION       2
+#else
+#define APP_DEMO_PROTOCOL_VERSION       2
 #endif
 
 #ifndef APP_URL
@@ -45,15 +45,36 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #endif
 
 #ifdef PUBLIC_BUILD
-#define APP_PROTOCOL_VERSION            22
+#define APP_PROTOCOL_VERSION            24
 #else
-#define APP_PROTOCOL_VERSION            2200
+#define APP_PROTOCOL_VERSION            2202
 #endif
 
+// oldest protocol version servers still accept connections from
 #ifdef PUBLIC_BUILD
-#define APP_DEMO_PROTOCOL_VERSION       20
+#define APP_PROTOCOL_VERSION_MIN        22
 #else
-#define APP_DEMO_PROTOCOL_VERSION       20
+#define APP_PROTOCOL_VERSION_MIN        2200
+#endif
+
+// first protocol version with netchan messages compressed using the preset dictionary
+#ifdef PUBLIC_BUILD
+#define APP_PROTOCOL_VERSION_NETDICT    23
+#else
+#define APP_PROTOCOL_VERSION_NETDICT    2201
+#endif
+
+// first protocol version with bit-packed entity deltas
+#ifdef PUBLIC_BUILD
+#define APP_PROTOCOL_VERSION_BITPACK    24
+#else
+#define APP_PROTOCOL_VERSION_BITPACK    2202
+#endif
+
+#ifdef PUBLIC_BUILD
+#define APP_DEMO_PROTOCOL_VERSION       21
+#else
+#define APP_DEMO_PROTOCOL_VERSION       21
 #endif
 
 #ifndef APP_URL
@@ -39,8 +39,17 @@
 // 100k at least
 #define WMINBUFFERING       102400
 
-// the maximum number of curl_multi handles to be processed simultaneously
-#define WMAXMULTIHANDLES    4
+// the maximum number of curl_multi handles to be processed simultaneously,
+// per-host limits are left to curl (see http_maxhostconnections)
+#define WMAXMULTIHANDLES    16
+
+// the maximum number of idle connections kept alive for reuse
+#define WMAXIDLECONNECTIONS 16
+
+// responses larger than this are never cached
+#define WCACHEMAXENTRYSIZE  0x40000
+// total size of cached responses
+#define WCACHEMAXSIZE       0x400000
 
 #define WSTATUS_NONE        0   // not started
 #define WSTATUS_STARTED     1   // started
@@ -57,6 +66,25 @@ typedef struct chained_buffer_s {
 	char data[1];
 } chained_buffer_t;
 
+// A cached GET response body along with the validators to revalidate it.
+// Entries are refcounted by the requests revalidating them, so an entry
+// that is evicted or replaced meanwhile is only freed on the last release.
+typedef struct wswcurl_cache_s {
+	char *url;
+	char *etag;
+	char *last_modified;
+	char *content_type;
+	char *data;
+	size_t size;
+
+	int refcount;
+	char linked;
+
+	// LRU list, most recently used first
+	struct wswcurl_cache_s *prev;
+	struct wswcurl_cache_s *next;
+} wswcurl_cache_t;
+
 struct wswcurl_req_s {
 
 	int status; // < 0 : error
@@ -75,10 +103,22 @@ struct wswcurl_req_s {
 
 	char headers_done;
 	char paused;
+	char nocache;   // POST or partial request, bypasses the response cache
 	time_t last_action;
 	time_t timeout;
 	size_t ignore_bytes;
 
+	// Response cache stuff
+	wswcurl_cache_t *cache_entry;   // entry being revalidated, if any
+	char revalidated;   // got 304 for cache_entry, the body is replayed from the cache
+	char cache_store;   // collecting the body to store it in the cache
+	char no_store;  // the response must not be cached, Cache-Control: no-store or Vary
+	char *etag;
+	char *last_modified;
+	char *cache_data;
+	size_t cache_size;
+	size_t cache_alloc;
+
 	// Custom pointer to pass to callback functions below
 	void *customp;
 
@@ -112,6 +152,11 @@ static size_t wswcurl_readheader( void *ptr, size_t size, size_t nmemb, void *st
 static void wswcurl_pause( wswcurl_req *req );
 static void wswcurl_unpause( wswcurl_req *req );
 static time_t wswcurl_now( void );
+static size_t wswcurl_rxdata( wswcurl_req *req, void *ptr, size_t numb );
+static wswcurl_cache_t *wswcurl_cache_find( const char *url );
+static void wswcurl_cache_release( wswcurl_cache_t *entry );
+static void wswcurl_cache_store( wswcurl_req *req );
+static void wswcurl_cache_clear( void );
 
 ///////////////////////
 // Local variables
@@ -120,6 +165,12 @@ static wswcurl_req *http_requests_hnode; // The item node in the list
 static qmutex_t *http_requests_mutex = NULL;
 static CURLM *curlmulti = NULL;     // Curl MULTI handle
 static int curlmulti_num_handles = 0;
+static CURLSH *curlshare = NULL;    // DNS and TLS session cache shared by all requests
+static qmutex_t *curlshare_mutexes[CURL_LOCK_DATA_LAST];
+
+static wswcurl_cache_t cache_headnode;
+static size_t cache_size = 0;
+static qmutex_t *cache_mutex = NULL;
 
 static struct mempool_s *wswcurl_mempool;
 static CURL *curldummy = NULL;
@@ -127,6 +178,8 @@ static qmutex_t *curldummy_mutex = NULL;
 
 static cvar_t *http_proxy;
 static cvar_t *http_proxyuserpwd;
+static cvar_t *http_cache;
+static cvar_t *http_maxhostconnections;
 
 #ifdef USE_OPENSSL
 static qmutex_t **crypto_mutexes = NULL;
@@ -163,6 +216,10 @@ static CURLMsg *(*qcurl_multi_info_read)( CURLM *, int * );
 static CURLcode (*qcurl_easy_pause)( CURL *, int );
 static CURLcode (*qcurl_global_init)( long flags );
 static void (*qcurl_global_cleanup)( void );
+static CURLMcode (*qcurl_multi_setopt)( CURLM *, CURLMoption, ... );
+static CURLSH *(*qcurl_share_init)( void );
+static CURLSHcode (*qcurl_share_setopt)( CURLSH *, CURLSHoption, ... );
+static CURLSHcode (*qcurl_share_cleanup)( CURLSH * );
 
 static dllfunc_t libcurlfuncs[] =
 {
@@ -187,6 +244,10 @@ static dllfunc_t libcurlfuncs[] =
 	{ "curl_easy_pause", ( void ** )&qcurl_easy_pause },
 	{ "curl_global_init", ( void ** )&qcurl_global_init },
 	{ "curl_global_cleanup", ( void ** )&qcurl_global_cleanup },
+	{ "curl_multi_setopt", ( void ** )&qcurl_multi_setopt },
+	{ "curl_share_init", ( void ** )&qcurl_share_init },
+	{ "curl_share_setopt", ( void ** )&qcurl_share_setopt },
+	{ "curl_share_cleanup", ( void ** )&qcurl_share_cleanup },
 
 	{ NULL, NULL }
 };
@@ -214,6 +275,10 @@ static dllfunc_t libcurlfuncs[] =
 #define qcurl_easy_pause curl_easy_pause
 #define qcurl_global_init curl_global_init
 #define qcurl_global_cleanup curl_global_cleanup
+#define qcurl_multi_setopt curl_multi_setopt
+#define qcurl_share_init curl_share_init
+#define qcurl_share_setopt curl_share_setopt
+#define qcurl_share_cleanup curl_share_cleanup
 
 #endif
 
@@ -334,6 +399,7 @@ int wswcurl_set_postfields( wswcurl_req *req, const char *fields, size_t size )
 
 	// Specify we want to POST data
 	qcurl_easy_setopt( req->curl, CURLOPT_POST, 1 );
+	req->nocache = 1;
 
 	// Set the expected POST size
 	qcurl_easy_setopt( req->curl, CURLOPT_POSTFIELDSIZE, (long)size );
@@ -391,6 +457,7 @@ size_t wswcurl_urldecode( const char *src, char *dst, size_t size ) {
 
 void wswcurl_start( wswcurl_req *req ) {
 	CURLcode res;
+	wswcurl_cache_t *entry;
 
 	if( !req ) {
 		return;
@@ -404,6 +471,33 @@ void wswcurl_start( wswcurl_req *req ) {
 		return;
 	}
 
+	if( req->post ) {
+		req->nocache = 1;
+	}
+
+	// make the request conditional if we have a cached response to revalidate
+	if( !req->nocache && http_cache->integer && !Q_strnicmp( req->url, "http", 4 ) ) {
+		req->cache_store = 1;
+
+		QMutex_Lock( cache_mutex );
+		entry = wswcurl_cache_find( req->url );
+		if( entry ) {
+			entry->refcount++;
+		}
+		QMutex_Unlock( cache_mutex );
+
+		// the validators never change while we hold the reference
+		if( entry ) {
+			req->cache_entry = entry;
+			if( entry->etag ) {
+				wswcurl_header( req, "If-None-Match", "%s", entry->etag );
+			}
+			if( entry->last_modified ) {
+				wswcurl_header( req, "If-Modified-Since", "%s", entry->last_modified );
+			}
+		}
+	}
+
 	if( req->txhead ) {
 		CURLSETOPT( req->curl, res, CURLOPT_HTTPHEADER, req->txhead );
 	}
@@ -497,6 +591,19 @@ advance:
 	return written;
 }
 
+static void wswcurl_share_lock( CURL *handle, curl_lock_data data, curl_lock_access access, void *userptr ) {
+	( void )handle;
+	( void )access;
+	( void )userptr;
+	QMutex_Lock( curlshare_mutexes[data] );
+}
+
+static void wswcurl_share_unlock( CURL *handle, curl_lock_data data, void *userptr ) {
+	( void )handle;
+	( void )userptr;
+	QMutex_Unlock( curlshare_mutexes[data] );
+}
+
 #ifdef USE_OPENSSL
 static void wswcurl_crypto_lockcallback( int mode, int type, const char *file, int line ) {
 	( void )file;
@@ -520,6 +627,13 @@ void wswcurl_init( void ) {
 	http_proxy = Cvar_Get( "http_proxy", "", CVAR_ARCHIVE );
 	http_proxyuserpwd = Cvar_Get( "http_proxyuserpwd", "", CVAR_ARCHIVE );
 
+	// connection pool and response cache settings
+	http_cache = Cvar_Get( "http_cache", "1", CVAR_ARCHIVE );
+	http_maxhostconnections = Cvar_Get( "http_maxhostconnections", "4", CVAR_ARCHIVE );
+
+	cache_headnode.prev = cache_headnode.next = &cache_headnode;
+	cache_mutex = QMutex_Create();
+
 	wswcurl_loadlib();
 
 	if( curlLibrary ) {
@@ -527,6 +641,33 @@ void wswcurl_init( void ) {
 
 		curldummy = qcurl_easy_init();
 		curlmulti = qcurl_multi_init();
+		curlshare = qcurl_share_init();
+	}
+
+	if( curlmulti ) {
+		// connections stay in the multi handle's cache after their requests are done,
+		// keep enough of them alive so that the next report to the same host reuses one
+		qcurl_multi_setopt( curlmulti, CURLMOPT_MAXCONNECTS, (long)WMAXIDLECONNECTIONS );
+#if LIBCURL_VERSION_NUM >= 0x071e00
+		qcurl_multi_setopt( curlmulti, CURLMOPT_MAX_HOST_CONNECTIONS, (long)max( http_maxhostconnections->integer, 1 ) );
+#endif
+#ifdef CURLPIPE_MULTIPLEX
+		// HTTP/1.1 pipelining is gone from curl, multiplex over HTTP/2 where the server allows it
+		qcurl_multi_setopt( curlmulti, CURLMOPT_PIPELINING, (long)CURLPIPE_MULTIPLEX );
+#endif
+	}
+
+	if( curlshare ) {
+		int i;
+
+		// share DNS lookups and TLS sessions, so that new connections skip
+		// the lookup and resume the TLS session instead of a full handshake
+		for( i = 0; i < CURL_LOCK_DATA_LAST; i++ )
+			curlshare_mutexes[i] = QMutex_Create();
+		qcurl_share_setopt( curlshare, CURLSHOPT_LOCKFUNC, wswcurl_share_lock );
+		qcurl_share_setopt( curlshare, CURLSHOPT_UNLOCKFUNC, wswcurl_share_unlock );
+		qcurl_share_setopt( curlshare, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS );
+		qcurl_share_setopt( curlshare, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION );
 	}
 
 	curldummy_mutex = QMutex_Create();
@@ -564,6 +705,19 @@ void wswcurl_cleanup( void ) {
 		curlmulti = NULL;
 	}
 
+	if( curlshare ) {
+		int i;
+
+		qcurl_share_cleanup( curlshare );
+		curlshare = NULL;
+
+		for( i = 0; i < CURL_LOCK_DATA_LAST; i++ )
+			QMutex_Destroy( &curlshare_mutexes[i] );
+	}
+
+	wswcurl_cache_clear();
+	QMutex_Destroy( &cache_mutex );
+
 	QMutex_Destroy( &curldummy_mutex );
 
 	QMutex_Destroy( &http_requests_mutex );
@@ -747,6 +901,16 @@ wswcurl_req *wswcurl_create( const char *iface, const char *furl, ... ) {
 		CURLSETOPT( curl, res, CURLOPT_INTERFACE, ( void * )iface );
 	}
 	CURLSETOPT( curl, res, CURLOPT_NOSIGNAL, 1 );
+	if( curlshare ) {
+		CURLSETOPT( curl, res, CURLOPT_SHARE, curlshare );
+	}
+#if LIBCURL_VERSION_NUM >= 0x071900
+	CURLSETOPT( curl, res, CURLOPT_TCP_KEEPALIVE, 1 );
+#endif
+#if LIBCURL_VERSION_NUM >= 0x072b00
+	// rather wait for a connection that can be multiplexed than open a new one
+	CURLSETOPT( curl, res, CURLOPT_PIPEWAIT, 1 );
+#endif
 
 	if( developer->integer ) {
 		CURLSETOPT( curl, res, CURLOPT_DEBUGFUNCTION, &wswcurl_debug_callback );
@@ -802,6 +966,9 @@ void wswcurl_set_resume_from( wswcurl_req *req, long resume ) {
 	if( code != CURLE_OK ) {
 		Com_Printf( "Failed to set file resume from length\n" );
 	}
+	if( resume ) {
+		req->nocache = 1;
+	}
 }
 
 void wswcurl_delete( wswcurl_req *req ) {
@@ -827,6 +994,22 @@ void wswcurl_delete( wswcurl_req *req ) {
 		WFREE( req->url );
 	}
 
+	if( req->etag ) {
+		WFREE( req->etag );
+	}
+	if( req->last_modified ) {
+		WFREE( req->last_modified );
+	}
+	if( req->cache_data ) {
+		WFREE( req->cache_data );
+	}
+	if( req->cache_entry ) {
+		QMutex_Lock( cache_mutex );
+		wswcurl_cache_release( req->cache_entry );
+		QMutex_Unlock( cache_mutex );
+		req->cache_entry = NULL;
+	}
+
 	if( req->bhead ) {
 		chained_buffer_t *cb = req->bhead;
 		chained_buffer_t *next = cb->next;
@@ -884,6 +1067,9 @@ int wswcurl_isvalidhandle( wswcurl_req *req ) {
 
 const char *wswcurl_get_content_type( wswcurl_req *req ) {
 	char *content_type = NULL;
+	if( req->revalidated ) {
+		return req->cache_entry->content_type;
+	}
 	qcurl_easy_getinfo( req->curl, CURLINFO_CONTENT_TYPE, &content_type );
 	return content_type;
 }
@@ -915,15 +1101,36 @@ int wswcurl_get_status( const wswcurl_req *req ) {
 ///////////////////////
 // static functions
 
+// Returns a copy of the header value with the surrounding whitespace stripped.
+// Header values are case sensitive, so they're copied from the raw line.
+static char *wswcurl_copyheadervalue( const char *line, size_t len, size_t namelen ) {
+	const char *start = line + namelen, *end = line + len;
+	char *value;
+
+	while( start < end && ( *start == ' ' || *start == '\t' ) ) {
+		start++;
+	}
+	while( end > start && ( end[-1] == '\n' || end[-1] == '\r' || end[-1] == ' ' || end[-1] == '\t' ) ) {
+		end--;
+	}
+
+	value = ( char * )WMALLOC( end - start + 1 );
+	memcpy( value, start, end - start );
+	value[end - start] = '\0';
+	return value;
+}
+
 // Some versions of CURL don't report the correct exepected size when following redirects
 // This manual interpretation of the expected size fixes this.
 static size_t wswcurl_readheader( void *ptr, size_t size, size_t nmemb, void *stream ) {
 	char buf[1024], *str;
 	int slen;
+	size_t len;
 	wswcurl_req *req = (wswcurl_req*)stream;
 
+	len = ( size * nmemb ) > ( sizeof( buf ) - 1 ) ? ( sizeof( buf ) - 1 ) : ( size * nmemb );
 	memset( buf, 0, sizeof( buf ) );
-	memcpy( buf, ptr, ( size * nmemb ) > ( sizeof( buf ) - 1 ) ? ( sizeof( buf ) - 1 ) : ( size * nmemb ) );
+	memcpy( buf, ptr, len );
 	str = buf;
 	while( *str ) {
 		if( ( *str >= 'a' ) && ( *str <= 'z' ) ) {
@@ -932,6 +1139,35 @@ static size_t wswcurl_readheader( void *ptr, size_t size, size_t nmemb, void *st
 		str++;
 	}
 
+	// cache validators, a new status line starts a new response (redirects)
+	if( !strncmp( buf, "HTTP/", 5 ) ) {
+		if( req->etag ) {
+			WFREE( req->etag );
+			req->etag = NULL;
+		}
+		if( req->last_modified ) {
+			WFREE( req->last_modified );
+			req->last_modified = NULL;
+		}
+		req->no_store = 0;
+	} else if( !strncmp( buf, "ETAG:", 5 ) ) {
+		if( req->etag ) {
+			WFREE( req->etag );
+		}
+		req->etag = wswcurl_copyheadervalue( ptr, len, 5 );
+	} else if( !strncmp( buf, "LAST-MODIFIED:", 14 ) ) {
+		if( req->last_modified ) {
+			WFREE( req->last_modified );
+		}
+		req->last_modified = wswcurl_copyheadervalue( ptr, len, 14 );
+	} else if( !strncmp( buf, "CACHE-CONTROL:", 14 ) && strstr( buf, "NO-STORE" ) ) {
+		req->no_store = 1;
+	} else if( !strncmp( buf, "VARY:", 5 ) ) {
+		// entries are only keyed by the url, a variant picked by other
+		// request headers could be served for a request it doesn't match
+		req->no_store = 1;
+	}
+
 	if( ( str = (char*)strstr( buf, "CONTENT-LENGTH:" ) ) ) {
 		int length;
 
@@ -960,6 +1196,13 @@ static size_t wswcurl_readheader( void *ptr, size_t size, size_t nmemb, void *st
 
 	qcurl_easy_getinfo( req->curl, CURLINFO_RESPONSE_CODE, &( req->respcode ) );
 
+	// our cached copy is still valid, present it as a regular response
+	if( req->respcode == 304 && req->cache_entry ) {
+		req->revalidated = 1;
+		req->respcode = 200;
+		req->rx_expsize = req->cache_entry->size;
+	}
+
 	// call header callback function
 	if( req->callback_header ) {
 		req->callback_header( req, buf, req->customp );
@@ -970,8 +1213,7 @@ static size_t wswcurl_readheader( void *ptr, size_t size, size_t nmemb, void *st
 }
 
 static size_t wswcurl_write( void *ptr, size_t size, size_t nmemb, void *stream ) {
-	float progress;
-	long numb;
+	size_t numb;
 	wswcurl_req *req = (wswcurl_req*)stream;
 
 	if( !req->headers_done ) {
@@ -979,6 +1221,32 @@ static size_t wswcurl_write( void *ptr, size_t size, size_t nmemb, void *stream
 	}
 
 	numb = size * nmemb;
+
+	// keep a copy of the body for the response cache
+	if( req->cache_store ) {
+		if( req->respcode != 200 || req->rx_expsize > WCACHEMAXENTRYSIZE || req->cache_size + numb > WCACHEMAXENTRYSIZE ) {
+			req->cache_store = 0;
+			if( req->cache_data ) {
+				WFREE( req->cache_data );
+				req->cache_data = NULL;
+			}
+		} else {
+			if( req->cache_size + numb > req->cache_alloc ) {
+				req->cache_alloc = max( req->cache_size + numb, req->cache_alloc * 2 );
+				req->cache_data = ( char * )WREALLOC( req->cache_data, req->cache_alloc );
+			}
+			memcpy( req->cache_data + req->cache_size, ptr, numb );
+			req->cache_size += numb;
+		}
+	}
+
+	return wswcurl_rxdata( req, ptr, numb );
+}
+
+// Passes received body data to the read callback or buffers it
+static size_t wswcurl_rxdata( wswcurl_req *req, void *ptr, size_t numb ) {
+	float progress;
+
 	req->rxreceived += numb;
 	req->last_action = wswcurl_now();
 
@@ -1045,6 +1313,17 @@ static int wswcurl_checkmsg( void ) {
 			r->status = WSTATUS_FINISHED;
 			qcurl_easy_getinfo( r->curl, CURLINFO_RESPONSE_CODE, &( r->respcode ) );
 
+			if( r->revalidated ) {
+				// not modified, replay the cached body
+				r->respcode = 200;
+				r->rx_expsize = r->cache_entry->size;
+				if( r->cache_entry->size ) {
+					wswcurl_rxdata( r, r->cache_entry->data, r->cache_entry->size );
+				}
+			} else if( r->cache_store && r->respcode == 200 && ( r->etag || r->last_modified ) && !r->no_store ) {
+				wswcurl_cache_store( r );
+			}
+
 			if( r->callback_done ) {
 				r->callback_done( r, r->respcode, r->customp );
 			}
@@ -1103,3 +1382,136 @@ int wswcurl_eof( wswcurl_req *req ) {
 static time_t wswcurl_now( void ) {
 	return time( NULL );
 }
+
+///////////////////////
+// response cache
+
+// Returns the entry for the url, marking it as the most recently used. Call with cache_mutex locked.
+static wswcurl_cache_t *wswcurl_cache_find( const char *url ) {
+	wswcurl_cache_t *entry;
+
+	for( entry = cache_headnode.next; entry != &cache_headnode; entry = entry->next ) {
+		if( !strcmp( entry->url, url ) ) {
+			break;
+		}
+	}
+	if( entry == &cache_headnode ) {
+		return NULL;
+	}
+
+	entry->prev->next = entry->next;
+	entry->next->prev = entry->prev;
+	entry->prev = &cache_headnode;
+	entry->next = cache_headnode.next;
+	entry->next->prev = entry;
+	cache_headnode.next = entry;
+
+	return entry;
+}
+
+static void wswcurl_cache_free( wswcurl_cache_t *entry ) {
+	WFREE( entry->url );
+	if( entry->etag ) {
+		WFREE( entry->etag );
+	}
+	if( entry->last_modified ) {
+		WFREE( entry->last_modified );
+	}
+	if( entry->content_type ) {
+		WFREE( entry->content_type );
+	}
+	if( entry->data ) {
+		WFREE( entry->data );
+	}
+	WFREE( entry );
+}
+
+// Call with cache_mutex locked.
+static void wswcurl_cache_unlink( wswcurl_cache_t *entry ) {
+	entry->prev->next = entry->next;
+	entry->next->prev = entry->prev;
+	entry->linked = 0;
+	cache_size -= entry->size;
+
+	if( !entry->refcount ) {
+		wswcurl_cache_free( entry );
+	}
+}
+
+// Call with cache_mutex locked.
+static void wswcurl_cache_release( wswcurl_cache_t *entry ) {
+	entry->refcount--;
+	if( !entry->refcount && !entry->linked ) {
+		wswcurl_cache_free( entry );
+	}
+}
+
+static char *wswcurl_cache_copystring( const char *str ) {
+	char *copy;
+
+	if( !str ) {
+		return NULL;
+	}
+	copy = ( char * )WMALLOC( strlen( str ) + 1 );
+	strcpy( copy, str );
+	return copy;
+}
+
+// Stores the body collected by a finished request, replacing the previous entry for the url
+static void wswcurl_cache_store( wswcurl_req *req ) {
+	wswcurl_cache_t *entry;
+	char *content_type = NULL;
+
+	qcurl_easy_getinfo( req->curl, CURLINFO_CONTENT_TYPE, &content_type );
+
+	entry = ( wswcurl_cache_t * )WMALLOC( sizeof( *entry ) );
+	memset( entry, 0, sizeof( *entry ) );
+	entry->url = wswcurl_cache_copystring( req->url );
+	entry->content_type = wswcurl_cache_copystring( content_type );
+
+	// the request doesn't need these anymore, hand them over
+	entry->etag = req->etag;
+	entry->last_modified = req->last_modified;
+	entry->data = req->cache_data;
+	entry->size = req->cache_size;
+	req->etag = req->last_modified = req->cache_data = NULL;
+	req->cache_size = req->cache_alloc = 0;
+	req->cache_store = 0;
+
+	QMutex_Lock( cache_mutex );
+
+	if( req->cache_entry && req->cache_entry->linked ) {
+		wswcurl_cache_unlink( req->cache_entry );
+	} else {
+		wswcurl_cache_t *old = wswcurl_cache_find( req->url );
+		if( old ) {
+			wswcurl_cache_unlink( old );
+		}
+	}
+
+	// evict the least recently used entries
+	while( cache_size + entry->size > WCACHEMAXSIZE && cache_headnode.prev != &cache_headnode ) {
+		wswcurl_cache_unlink( cache_headnode.prev );
+	}
+
+	entry->linked = 1;
+	entry->prev = &cache_headnode;
+	entry->next = cache_headnode.next;
+	entry->next->prev = entry;
+	cache_headnode.next = entry;
+	cache_size += entry->size;
+
+	QMutex_Unlock( cache_mutex );
+}
+
+static void wswcurl_cache_clear( void ) {
+	if( !cache_mutex ) {
+		return;
+	}
+
+	QMutex_Lock( cache_mutex );
+	while( cache_headnode.next != &cache_headnode ) {
+		wswcurl_cache_unlink( cache_headnode.next );
+	}
+	QMutex_Unlock( cache_mutex );
+}
@@ -34,14 +34,18 @@ static ref_cmdbuf_t *RF_GetNextAdapterFrame( ref_frontendAdapter_t *adapter );
 static void RF_AdapterFrame( ref_frontendAdapter_t *adapter ) {
 	ref_cmdbuf_t *frame;
 
+	ri.Prof_Begin( "RF_AdapterCmds" );
 	if( adapter->noWait )
 		adapter->cmdPipe->RunCmds( adapter->cmdPipe );
 	else
 		adapter->cmdPipe->WaitForCmds( adapter->cmdPipe, Q_THREADS_WAIT_INFINITE );
+	ri.Prof_End( "RF_AdapterCmds" );
 
 	frame = RF_GetNextAdapterFrame( adapter );
 	if( frame ) {
+		ri.Prof_Begin( "RF_RunFrame" );
 		frame->RunCmds( frame );
+		ri.Prof_End( "RF_RunFrame" );
 	}
 }
 
@@ -51,6 +55,8 @@ static void RF_AdapterFrame( ref_frontendAdapter_t *adapter ) {
 static void *RF_AdapterThreadProc( void *param ) {
 	ref_frontendAdapter_t *adapter = param;
 
+	ri.Prof_SetThreadName( "renderer" );
+
 	GLimp_MakeCurrent( adapter->GLcontext, GLimp_GetWindowSurface( NULL ) );
 
 	while( !adapter->shutdown ) {
@@ -59,6 +65,8 @@ static void *RF_AdapterThreadProc( void *param ) {
 
 	GLimp_MakeCurrent( NULL, NULL );
 
+	ri.Prof_ReleaseThread();
+
 	return NULL;
 }
 
@@ -321,6 +329,8 @@ void RF_EndFrame( void ) {
 	}
 
 	rrf.adapter.cmdPipe->Fence( rrf.adapter.cmdPipe );
+
+	ri.Prof_Mark( "frame submitted" );
 }
 
 void RF_BeginRegistration( void ) {
@@ -586,6 +596,25 @@ void RF_LightForOrigin( const vec3_t origin, vec3_t dir, vec4_t ambient, vec4_t
 	R_LightForOrigin( origin, dir, ambient, diffuse, radius, false, false );
 }
 
+/*
+* RF_GetFogNumForSphere
+*
+* Returns the fog volume the sphere is in as a poly fog number, -1 if none
+*/
+int RF_GetFogNumForSphere( const vec3_t centre, float radius ) {
+	int i;
+	vec3_t mins, maxs;
+	mfog_t *fog;
+
+	for( i = 0; i < 3; i++ ) {
+		mins[i] = centre[i] - radius;
+		maxs[i] = centre[i] + radius;
+	}
+
+	fog = R_WorldFogForBounds( mins, maxs );
+	return fog ? fog - rsh.worldBrushModel->fogs + 1 : -1;
+}
+
 /*
 * RF_GetShaderForOrigin
 *
@@ -97,6 +97,7 @@ void RF_StopAviDemo( void );
 void RF_TransformVectorToScreen( const refdef_t *rd, const vec3_t in, vec2_t out );
 bool RF_LerpTag( orientation_t *orient, const model_t *mod, int oldframe, int frame, float lerpfrac, const char *name );
 void RF_LightForOrigin( const vec3_t origin, vec3_t dir, vec4_t ambient, vec4_t diffuse, float radius );
+int RF_GetFogNumForSphere( const vec3_t centre, float radius );
 shader_t *RF_GetShaderForOrigin( const vec3_t origin );
 struct cinematics_s *RF_GetShaderCinematic( shader_t *shader );
 void RF_Finish( void );
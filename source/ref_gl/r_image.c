@@ -19,6 +19,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 #include "r_local.h"
 #include "r_imagelib.h"
+#include "r_imagefilter.h"
 #include "../qalgo/hash.h"
 
 #define MAX_GLIMAGES        8192
@@ -33,6 +34,12 @@ static image_t r_images[MAX_GLIMAGES];
 static image_t r_images_hash_headnode[IMAGES_HASH_SIZE], *r_free_images;
 static qmutex_t *r_imagesLock;
 
+// the loader pipes are written to by both the main thread and the decoders
+static qmutex_t *loader_lock;
+
+static int r_numDecodedImages;         // decoder thread stats, guarded by loader_lock
+static uint64_t r_imageDecodeTime;
+
 static int r_unpackAlignment[NUM_QGL_CONTEXTS];
 
 static unsigned *r_8to24table[2];
@@ -59,6 +66,8 @@ static int gl_filter_depth = GL_LINEAR;
 static int gl_anisotropic_filter = 0;
 static void R_InitImageLoader( int id );
 static void R_ShutdownImageLoader( int id );
+static void R_InitImageDecoders( void );
+static void R_ShutdownImageDecoders( void );
 static bool R_LoadAsyncImageFromDisk( image_t *image );
 
 typedef struct {
@@ -294,6 +303,9 @@ void R_PrintImageList( const char *mask, bool ( *filter )( const char *mask, con
 
 	Com_Printf( "Total texels count (counting mipmaps, approx): %.0f\n", texels );
 	Com_Printf( "%i RGBA images, totalling %.3f megabytes\n", numImages, total_bytes / 1048576.0 );
+	if( r_numDecodedImages ) {
+		Com_Printf( "%i images decoded off the GL threads, %.1f ms of decoding\n", r_numDecodedImages, r_imageDecodeTime / 1000.0 );
+	}
 }
 
 /*
@@ -310,6 +322,7 @@ enum {
 	TEXTURE_LINE_BUF,
 	TEXTURE_CUT_BUF,
 	TEXTURE_FLIPPING_BUF0,TEXTURE_FLIPPING_BUF1,TEXTURE_FLIPPING_BUF2,TEXTURE_FLIPPING_BUF3,TEXTURE_FLIPPING_BUF4,TEXTURE_FLIPPING_BUF5,
+	TEXTURE_MIPMAP_BUF,
 
 	NUM_IMAGE_BUFFERS
 };
@@ -317,8 +330,12 @@ enum {
 static uint8_t *r_screenShotBuffer;
 static size_t r_screenShotBufferSize;
 
-static uint8_t *r_imageBuffers[NUM_QGL_CONTEXTS][NUM_IMAGE_BUFFERS];
-static size_t r_imageBufSize[NUM_QGL_CONTEXTS][NUM_IMAGE_BUFFERS];
+// each GL context and each decoder thread has its own set of temporary buffers
+#define NUM_IMAGE_BUFFER_SLOTS      ( NUM_QGL_CONTEXTS + MAX_IMAGE_DECODER_THREADS )
+#define IMAGE_DECODER_SLOT( id )    ( NUM_QGL_CONTEXTS + ( id ) )
+
+static uint8_t *r_imageBuffers[NUM_IMAGE_BUFFER_SLOTS][NUM_IMAGE_BUFFERS];
+static size_t r_imageBufSize[NUM_IMAGE_BUFFER_SLOTS][NUM_IMAGE_BUFFERS];
 
 #define R_PrepareImageBuffer( ctx,buffer,size ) _R_PrepareImageBuffer( ctx,buffer,size,__FILE__,__LINE__ )
 
@@ -346,7 +363,7 @@ static uint8_t *_R_PrepareImageBuffer( int ctx, int buffer, size_t size,
 void R_FreeImageBuffers( void ) {
 	int i, j;
 
-	for( i = 0; i < NUM_QGL_CONTEXTS; i++ )
+	for( i = 0; i < NUM_IMAGE_BUFFER_SLOTS; i++ )
 		for( j = 0; j < NUM_IMAGE_BUFFERS; j++ ) {
 			if( r_imageBuffers[i][j] ) {
 				R_Free( r_imageBuffers[i][j] );
@@ -584,55 +601,239 @@ static void R_CutImage( const uint8_t *in, int inwidth, int height, uint8_t *out
 }
 
 /*
-* R_ResampleTexture
+=================================================================
+
+IMAGE FILTER WORKERS
+
+=================================================================
 */
-static void R_ResampleTexture( int ctx, const uint8_t *in, int inwidth, int inheight, uint8_t *out,
-							   int outwidth, int outheight, int samples, int alignment ) {
-	int i, j, k;
-	int inwidthS, outwidthS;
-	unsigned int frac, fracstep;
-	const uint8_t *inrow, *inrow2, *pix1, *pix2, *pix3, *pix4;
-	unsigned *p1, *p2;
-	uint8_t *opix;
 
-	if( inwidth == outwidth && inheight == outheight ) {
-		memcpy( out, in, inheight * Q_ALIGN( inwidth * samples, alignment ) );
-		return;
+#define NUM_IMAGE_FILTER_THREADS        2
+#define IMAGE_FILTER_MIN_TEXELS         ( 256 * 256 ) // don't bother splitting smaller images
+
+typedef enum {
+	IMAGE_FILTER_MIPMAP,
+	IMAGE_FILTER_MIPMAP16,
+	IMAGE_FILTER_RESAMPLE,
+	IMAGE_FILTER_RESAMPLE16,
+} imageFilterType_t;
+
+typedef struct {
+	imageFilterType_t type;
+	const void *in;
+	void *out;
+	int inwidth, inheight;
+	int outwidth, outheight;
+	int samples, alignment;
+	int rMask, gMask, bMask, aMask;
+	const unsigned *table;
+	int pending;
+	struct qcondvar_s *done;        // woken by the filter thread finishing the last block
+} imageFilterJob_t;
+
+enum {
+	CMD_FILTER_RUN,
+	CMD_FILTER_QUIT,
+
+	NUM_FILTER_CMDS
+};
+
+typedef struct {
+	int id;
+	imageFilterJob_t *job;
+	int first;
+	int rows;
+} filterRunCmd_t;
+
+typedef unsigned (*queueCmdHandler_t)( const void * );
+
+static qbufPipe_t *filter_queue[NUM_IMAGE_FILTER_THREADS] = { NULL };
+static qthread_t *filter_thread[NUM_IMAGE_FILTER_THREADS] = { NULL };
+static qmutex_t *filter_lock;
+
+static void *R_ImageFilterThreadProc( void *param );
+
+/*
+* R_RunImageFilterRows
+*/
+static void R_RunImageFilterRows( const imageFilterJob_t *job, int first, int rows ) {
+	switch( job->type ) {
+		case IMAGE_FILTER_MIPMAP:
+			R_MipMapRows( job->in, job->out, job->inwidth, job->inheight, job->samples, job->alignment, first, rows );
+			break;
+		case IMAGE_FILTER_MIPMAP16:
+			R_MipMap16Rows( job->in, job->out, job->inwidth, job->inheight,
+							job->rMask, job->gMask, job->bMask, job->aMask, first, rows );
+			break;
+		case IMAGE_FILTER_RESAMPLE:
+			R_ResampleRows( job->in, job->inwidth, job->inheight, job->out, job->outwidth, job->outheight,
+							job->samples, job->alignment, job->table, first, rows );
+			break;
+		case IMAGE_FILTER_RESAMPLE16:
+			R_Resample16Rows( job->in, job->inwidth, job->inheight, job->out, job->outwidth, job->outheight,
+							  job->rMask, job->gMask, job->bMask, job->aMask, job->table, first, rows );
+			break;
 	}
+}
 
-	p1 = ( unsigned * )R_PrepareImageBuffer( ctx, TEXTURE_LINE_BUF, outwidth * sizeof( *p1 ) * 2 );
-	p2 = p1 + outwidth;
+/*
+* R_RunImageFilter
+*
+* Splits output rows between the filter threads and the calling thread.
+* Returns false if the job was run on the calling thread alone.
+*/
+static bool R_RunImageFilter( imageFilterJob_t *job ) {
+	int i, block, first;
+	filterRunCmd_t cmd;
+	const int rows = job->outheight;
+
+	if( !filter_thread[0] || job->outwidth * job->outheight < IMAGE_FILTER_MIN_TEXELS ) {
+		R_RunImageFilterRows( job, 0, rows );
+		return false;
+	}
+
+	block = ( rows + NUM_IMAGE_FILTER_THREADS ) / ( NUM_IMAGE_FILTER_THREADS + 1 );
+
+	job->pending = NUM_IMAGE_FILTER_THREADS;
+	job->done = ri.CondVar_Create();
+
+	cmd.id = CMD_FILTER_RUN;
+	cmd.job = job;
+	cmd.rows = block;
+
+	// the pipes are shared by all loader threads
+	ri.Mutex_Lock( filter_lock );
+	for( i = 0, first = block; i < NUM_IMAGE_FILTER_THREADS; i++, first += block ) {
+		cmd.first = first;
+		ri.BufPipe_WriteCmd( filter_queue[i], &cmd, sizeof( cmd ) );
+	}
+	ri.Mutex_Unlock( filter_lock );
 
-	fracstep = inwidth * 0x10000 / outwidth;
+	R_RunImageFilterRows( job, 0, block );
 
-	frac = fracstep >> 2;
-	for( i = 0; i < outwidth; i++ ) {
-		p1[i] = samples * ( frac >> 16 );
-		frac += fracstep;
+	ri.Mutex_Lock( filter_lock );
+	while( job->pending ) {
+		ri.CondVar_Wait( job->done, filter_lock, Q_THREADS_WAIT_INFINITE );
 	}
+	ri.Mutex_Unlock( filter_lock );
 
-	frac = 3 * ( fracstep >> 2 );
-	for( i = 0; i < outwidth; i++ ) {
-		p2[i] = samples * ( frac >> 16 );
-		frac += fracstep;
+	ri.CondVar_Destroy( &job->done );
+	return true;
+}
+
+/*
+* R_InitImageFilterThreads
+*/
+static void R_InitImageFilterThreads( void ) {
+	int i;
+
+	filter_lock = ri.Mutex_Create();
+
+	for( i = 0; i < NUM_IMAGE_FILTER_THREADS; i++ ) {
+		filter_queue[i] = ri.BufPipe_Create( 0x1000, 1 );
+		filter_thread[i] = ri.Thread_Create( R_ImageFilterThreadProc, filter_queue[i] );
 	}
+}
 
-	inwidthS = Q_ALIGN( inwidth * samples, alignment );
-	outwidthS = Q_ALIGN( outwidth * samples, alignment );
-	for( i = 0; i < outheight; i++, out += outwidthS ) {
-		inrow = in + inwidthS * (int)( ( i + 0.25 ) * inheight / outheight );
-		inrow2 = in + inwidthS * (int)( ( i + 0.75 ) * inheight / outheight );
-		for( j = 0; j < outwidth; j++ ) {
-			pix1 = inrow + p1[j];
-			pix2 = inrow + p2[j];
-			pix3 = inrow2 + p1[j];
-			pix4 = inrow2 + p2[j];
-			opix = out + j * samples;
+/*
+* R_ShutdownImageFilterThreads
+*/
+static void R_ShutdownImageFilterThreads( void ) {
+	int i;
+	int cmd = CMD_FILTER_QUIT;
 
-			for( k = 0; k < samples; k++ )
-				opix[k] = ( pix1[k] + pix2[k] + pix3[k] + pix4[k] ) >> 2;
+	for( i = 0; i < NUM_IMAGE_FILTER_THREADS; i++ ) {
+		if( !filter_thread[i] ) {
+			continue;
 		}
+
+		ri.BufPipe_WriteCmd( filter_queue[i], &cmd, sizeof( cmd ) );
+		ri.BufPipe_Finish( filter_queue[i] );
+
+		ri.Thread_Join( filter_thread[i] );
+		filter_thread[i] = NULL;
+
+		ri.BufPipe_Destroy( &filter_queue[i] );
+	}
+
+	ri.Mutex_Destroy( &filter_lock );
+}
+
+/*
+* R_HandleFilterRunCmd
+*/
+static unsigned R_HandleFilterRunCmd( void *pcmd ) {
+	filterRunCmd_t *cmd = pcmd;
+	imageFilterJob_t *job = cmd->job;
+
+	R_RunImageFilterRows( job, cmd->first, cmd->rows );
+
+	ri.Mutex_Lock( filter_lock );
+	if( !--job->pending ) {
+		ri.CondVar_Wake( job->done );
+	}
+	ri.Mutex_Unlock( filter_lock );
+
+	return sizeof( *cmd );
+}
+
+/*
+* R_HandleFilterQuitCmd
+*/
+static unsigned R_HandleFilterQuitCmd( void *pcmd ) {
+	return 0;
+}
+
+/*
+* R_ImageFilterCmdsWaiter
+*/
+static int R_ImageFilterCmdsWaiter( qbufPipe_t *queue, queueCmdHandler_t *cmdHandlers, bool timeout ) {
+	return ri.BufPipe_ReadCmds( queue, cmdHandlers );
+}
+
+/*
+* R_ImageFilterThreadProc
+*/
+static void *R_ImageFilterThreadProc( void *param ) {
+	qbufPipe_t *cmdQueue = param;
+	queueCmdHandler_t cmdHandlers[NUM_FILTER_CMDS] =
+	{
+		(queueCmdHandler_t)R_HandleFilterRunCmd,
+		(queueCmdHandler_t)R_HandleFilterQuitCmd,
+	};
+
+	ri.BufPipe_Wait( cmdQueue, R_ImageFilterCmdsWaiter, cmdHandlers, Q_THREADS_WAIT_INFINITE );
+
+	return NULL;
+}
+
+/*
+* R_ResampleTexture
+*/
+static void R_ResampleTexture( int ctx, const uint8_t *in, int inwidth, int inheight, uint8_t *out,
+							   int outwidth, int outheight, int samples, int alignment ) {
+	imageFilterJob_t job;
+
+	if( inwidth == outwidth && inheight == outheight ) {
+		memcpy( out, in, inheight * Q_ALIGN( inwidth * samples, alignment ) );
+		return;
 	}
+
+	memset( &job, 0, sizeof( job ) );
+	job.type = IMAGE_FILTER_RESAMPLE;
+	job.in = in;
+	job.out = out;
+	job.inwidth = inwidth;
+	job.inheight = inheight;
+	job.outwidth = outwidth;
+	job.outheight = outheight;
+	job.samples = samples;
+	job.alignment = alignment;
+	job.table = ( unsigned * )R_PrepareImageBuffer( ctx, TEXTURE_LINE_BUF, outwidth * sizeof( unsigned ) * 2 );
+
+	R_ResampleColumnTable( ( unsigned * )job.table, inwidth, outwidth, samples );
+
+	R_RunImageFilter( &job );
 }
 
 /*
@@ -642,53 +843,50 @@ static void R_ResampleTexture( int ctx, const uint8_t *in, int inwidth, int inhe
 */
 static void R_ResampleTexture16( int ctx, const unsigned short *in, int inwidth, int inheight,
 								 unsigned short *out, int outwidth, int outheight, int rMask, int gMask, int bMask, int aMask ) {
-	int i, j;
-	int inwidthA, outwidthA;
-	unsigned int frac, fracstep;
-	const unsigned short *inrow, *inrow2, *pix1, *pix2, *pix3, *pix4;
-	unsigned *p1, *p2;
-	unsigned short *opix;
+	imageFilterJob_t job;
 
 	if( inwidth == outwidth && inheight == outheight ) {
 		memcpy( out, in, inheight * Q_ALIGN( inwidth * sizeof( unsigned short ), 4 ) );
 		return;
 	}
 
-	p1 = ( unsigned * )R_PrepareImageBuffer( ctx, TEXTURE_LINE_BUF, outwidth * sizeof( *p1 ) * 2 );
-	p2 = p1 + outwidth;
+	memset( &job, 0, sizeof( job ) );
+	job.type = IMAGE_FILTER_RESAMPLE16;
+	job.in = in;
+	job.out = out;
+	job.inwidth = inwidth;
+	job.inheight = inheight;
+	job.outwidth = outwidth;
+	job.outheight = outheight;
+	job.rMask = rMask;
+	job.gMask = gMask;
+	job.bMask = bMask;
+	job.aMask = aMask;
+	job.table = ( unsigned * )R_PrepareImageBuffer( ctx, TEXTURE_LINE_BUF, outwidth * sizeof( unsigned ) * 2 );
 
-	fracstep = inwidth * 0x10000 / outwidth;
+	R_ResampleColumnTable( ( unsigned * )job.table, inwidth, outwidth, 1 );
 
-	frac = fracstep >> 2;
-	for( i = 0; i < outwidth; i++ ) {
-		p1[i] = frac >> 16;
-		frac += fracstep;
-	}
-
-	frac = 3 * ( fracstep >> 2 );
-	for( i = 0; i < outwidth; i++ ) {
-		p2[i] = frac >> 16;
-		frac += fracstep;
-	}
+	R_RunImageFilter( &job );
+}
 
-	inwidthA = Q_ALIGN( inwidth, 2 );
-	outwidthA = Q_ALIGN( outwidth, 2 );
-	for( i = 0; i < outheight; i++, out += outwidthA ) {
-		inrow = in + inwidthA * (int)( ( i + 0.25 ) * inheight / outheight );
-		inrow2 = in + inwidthA * (int)( ( i + 0.75 ) * inheight / outheight );
-		for( j = 0; j < outwidth; j++ ) {
-			pix1 = inrow + p1[j];
-			pix2 = inrow + p2[j];
-			pix3 = inrow2 + p1[j];
-			pix4 = inrow2 + p2[j];
-			opix = out + j;
+/*
+* R_MipMapJob
+*
+* Filters in place when run on a single thread, otherwise filters into
+* a temporary buffer since the rows of the next level overlap the source.
+*/
+static void R_MipMapJob( int ctx, imageFilterJob_t *job, size_t rowSize ) {
+	uint8_t *in = job->out;
+	size_t size = rowSize * job->outheight;
 
-			*opix = ( ( ( ( *pix1 & rMask ) + ( *pix2 & rMask ) + ( *pix3 & rMask ) + ( *pix4 & rMask ) ) >> 2 ) & rMask ) |
-					( ( ( ( *pix1 & gMask ) + ( *pix2 & gMask ) + ( *pix3 & gMask ) + ( *pix4 & gMask ) ) >> 2 ) & gMask ) |
-					( ( ( ( *pix1 & bMask ) + ( *pix2 & bMask ) + ( *pix3 & bMask ) + ( *pix4 & bMask ) ) >> 2 ) & bMask ) |
-					( ( ( ( *pix1 & aMask ) + ( *pix2 & aMask ) + ( *pix3 & aMask ) + ( *pix4 & aMask ) ) >> 2 ) & aMask );
-		}
+	if( !filter_thread[0] || job->outwidth * job->outheight < IMAGE_FILTER_MIN_TEXELS ) {
+		R_RunImageFilterRows( job, 0, job->outheight );
+		return;
 	}
+
+	job->out = R_PrepareImageBuffer( ctx, TEXTURE_MIPMAP_BUF, size );
+	R_RunImageFilter( job );
+	memcpy( in, job->out, size );
 }
 
 /*
@@ -696,36 +894,21 @@ static void R_ResampleTexture16( int ctx, const unsigned short *in, int inwidth,
 *
 * Operates in place, quartering the size of the texture
 */
-static void R_MipMap( uint8_t *in, int width, int height, int samples, int alignment ) {
-	int i, j, k;
-	int instride = Q_ALIGN( width * samples, alignment );
-	int outwidth, outheight, outpadding;
-	uint8_t *out = in;
-	uint8_t *next;
-	int inofs;
-
-	outwidth = width >> 1;
-	outheight = height >> 1;
-	if( !outwidth ) {
-		outwidth = 1;
-	}
-	if( !outheight ) {
-		outheight = 1;
-	}
-	outpadding = Q_ALIGN( outwidth * samples, alignment ) - outwidth * samples;
-
-	for( i = 0; i < outheight; i++, in += instride * 2, out += outpadding ) {
-		next = ( ( ( i << 1 ) + 1 ) < height ) ? ( in + instride ) : in;
-		for( j = 0, inofs = 0; j < outwidth; j++, inofs += samples ) {
-			if( ( ( j << 1 ) + 1 ) < width ) {
-				for( k = 0; k < samples; ++k, ++inofs )
-					*( out++ ) = ( in[inofs] + in[inofs + samples] + next[inofs] + next[inofs + samples] ) >> 2;
-			} else {
-				for( k = 0; k < samples; ++k, ++inofs )
-					*( out++ ) = ( in[inofs] + next[inofs] ) >> 1;
-			}
-		}
-	}
+static void R_MipMap( int ctx, uint8_t *in, int width, int height, int samples, int alignment ) {
+	imageFilterJob_t job;
+
+	memset( &job, 0, sizeof( job ) );
+	job.type = IMAGE_FILTER_MIPMAP;
+	job.in = in;
+	job.out = in;
+	job.inwidth = width;
+	job.inheight = height;
+	job.outwidth = max( width >> 1, 1 );
+	job.outheight = max( height >> 1, 1 );
+	job.samples = samples;
+	job.alignment = alignment;
+
+	R_MipMapJob( ctx, &job, Q_ALIGN( job.outwidth * samples, alignment ) );
 }
 
 /*
@@ -733,45 +916,23 @@ static void R_MipMap( uint8_t *in, int width, int height, int samples, int align
 *
 * Operates in place, quartering the size of the 16-bit texture, assumes unpack alignment of 4
 */
-static void R_MipMap16( unsigned short *in, int width, int height, int rMask, int gMask, int bMask, int aMask ) {
-	int i, j;
-	int instride = Q_ALIGN( width, 2 );
-	int outwidth, outheight, outpadding;
-	unsigned short *out = in;
-	unsigned short *next;
-	int col, p[4];
-
-	outwidth = width >> 1;
-	outheight = height >> 1;
-	if( !outwidth ) {
-		outwidth = 1;
-	}
-	if( !outheight ) {
-		outheight = 1;
-	}
-	outpadding = outwidth & 1;
-
-	for( i = 0; i < outheight; i++, in += instride * 2, out += outpadding ) {
-		next = ( ( ( i << 1 ) + 1 ) < height ) ? ( in + instride ) : in;
-		for( j = 0; j < outwidth; j++ ) {
-			col = j << 1;
-			p[0] = in[col];
-			p[1] = next[col];
-			if( ( col + 1 ) < width ) {
-				p[2] = in[col + 1];
-				p[3] = next[col + 1];
-				*( out++ ) =    ( ( ( ( p[0] & rMask ) + ( p[1] & rMask ) + ( p[2] & rMask ) + ( p[3] & rMask ) ) >> 2 ) & rMask ) |
-							 ( ( ( ( p[0] & gMask ) + ( p[1] & gMask ) + ( p[2] & gMask ) + ( p[3] & gMask ) ) >> 2 ) & gMask ) |
-							 ( ( ( ( p[0] & bMask ) + ( p[1] & bMask ) + ( p[2] & bMask ) + ( p[3] & bMask ) ) >> 2 ) & bMask ) |
-							 ( ( ( ( p[0] & aMask ) + ( p[1] & aMask ) + ( p[2] & aMask ) + ( p[3] & aMask ) ) >> 2 ) & aMask );
-			} else {
-				*( out++ ) =    ( ( ( ( p[0] & rMask ) + ( p[1] & rMask ) ) >> 1 ) & rMask ) |
-							 ( ( ( ( p[0] & gMask ) + ( p[1] & gMask ) ) >> 1 ) & gMask ) |
-							 ( ( ( ( p[0] & bMask ) + ( p[1] & bMask ) ) >> 1 ) & bMask ) |
-							 ( ( ( ( p[0] & aMask ) + ( p[1] & aMask ) ) >> 1 ) & aMask );
-			}
-		}
-	}
+static void R_MipMap16( int ctx, unsigned short *in, int width, int height, int rMask, int gMask, int bMask, int aMask ) {
+	imageFilterJob_t job;
+
+	memset( &job, 0, sizeof( job ) );
+	job.type = IMAGE_FILTER_MIPMAP16;
+	job.in = in;
+	job.out = in;
+	job.inwidth = width;
+	job.inheight = height;
+	job.outwidth = max( width >> 1, 1 );
+	job.outheight = max( height >> 1, 1 );
+	job.rMask = rMask;
+	job.gMask = gMask;
+	job.bMask = bMask;
+	job.aMask = aMask;
+
+	R_MipMapJob( ctx, &job, Q_ALIGN( job.outwidth * sizeof( unsigned short ), 4 ) );
 }
 
 /*
@@ -1094,7 +1255,7 @@ static void R_Upload32( int ctx, uint8_t **data, int layer,
 				w = scaledWidth;
 				h = scaledHeight;
 				while( w > minmipsize || h > minmipsize ) {
-					R_MipMap( mip, w, h, samples, 1 );
+					R_MipMap( ctx, mip, w, h, samples, 1 );
 
 					w >>= 1;
 					h >>= 1;
@@ -1395,9 +1556,9 @@ static void R_UploadMipmapped( int ctx, uint8_t **data,
 			}
 			face = scaled[j];
 			if( type == GL_UNSIGNED_BYTE ) {
-				R_MipMap( face, oldWidth, oldHeight, pixelSize, 4 );
+				R_MipMap( ctx, face, oldWidth, oldHeight, pixelSize, 4 );
 			} else {
-				R_MipMap16( ( unsigned short * )face, oldWidth, oldHeight, rMask, gMask, bMask, aMask );
+				R_MipMap16( ctx, ( unsigned short * )face, oldWidth, oldHeight, rMask, gMask, bMask, aMask );
 			}
 			qglTexImage2D( target + j, i, comp, scaledWidth, scaledHeight, 0, format, type, face );
 		}
@@ -1788,31 +1949,27 @@ static int LoadMipTex( uint8_t **pic, int width, int height, int flags ) {
 }
 
 /*
-* R_LoadImageFromDisk
+* R_ReadImageFacesFromDisk
+*
+* Reads the image or all 6 sides of the cubemap into the temporary buffers of the slot,
+* returns the number of samples per pixel or 0 if the image is missing.
 */
-static bool R_LoadImageFromDisk( int ctx, image_t *image ) {
-	int flags = image->flags;
+static int R_ReadImageFacesFromDisk( int ctx, const image_t *image, uint8_t **pic, int *width, int *height, int *flags,
+									 char *extension, size_t extension_size ) {
 	size_t len = strlen( image->name );
 	char pathname[1024];
 	size_t pathsize = sizeof( pathname );
-	int width = 1, height = 1, samples = 1;
-	bool loaded = false;
+	int samples = 0;
 
+	*width = *height = 1;
 	if( len >= pathsize - 7 ) {
-		return false;
+		return 0;
 	}
 
 	memcpy( pathname, image->name, len + 1 );
 
-	Q_strncatz( pathname, ".ktx", pathsize );
-	if( R_LoadKTX( ctx, image, pathname ) ) {
-		return true;
-	}
-	pathname[len] = 0;
-
-	if( flags & IT_CUBEMAP ) {
+	if( *flags & IT_CUBEMAP ) {
 		int i, j, k;
-		uint8_t *pic[6];
 		struct cubemapSufAndFlip {
 			char *suf; int flags;
 		} cubemapSides[2][6] = {
@@ -1848,22 +2005,22 @@ static bool R_LoadImageFromDisk( int ctx, image_t *image ) {
 
 					Q_strncatz( pathname, ".tga", pathsize );
 					samples = R_ReadImageFromDisk( ctx, pathname, pathsize,
-												   &( pic[j] ), &width, &height, &flags, j );
+												   &( pic[j] ), width, height, flags, j );
 					if( pic[j] ) {
-						if( width != height ) {
+						if( *width != *height ) {
 							ri.Com_DPrintf( S_COLOR_YELLOW "Not square cubemap image %s\n", pathname );
 							break;
 						}
 						if( !j ) {
-							lastSize = width;
-						} else if( lastSize != width ) {
+							lastSize = *width;
+						} else if( lastSize != *width ) {
 							ri.Com_DPrintf( S_COLOR_YELLOW "Different cubemap image size: %s\n", pathname );
 							break;
 						}
 						if( cbflags & ( IT_FLIPX | IT_FLIPY | IT_FLIPDIAGONAL ) ) {
 							uint8_t *temp = R_PrepareImageBuffer( ctx,
-								TEXTURE_FLIPPING_BUF0 + j, width * height * samples );
-							R_FlipTexture( pic[j], temp, width, height, samples,
+								TEXTURE_FLIPPING_BUF0 + j, *width * *height * samples );
+							R_FlipTexture( pic[j], temp, *width, *height, samples,
 										   ( cbflags & IT_FLIPX ) ? true : false,
 										   ( cbflags & IT_FLIPY ) ? true : false,
 										   ( cbflags & IT_FLIPDIAGONAL ) ? true : false );
@@ -1883,52 +2040,263 @@ static bool R_LoadImageFromDisk( int ctx, image_t *image ) {
 		}
 
 		if( k != 2 ) {
-			image->width = width;
-			image->height = height;
-			image->samples = samples;
+			Q_strncpyz( extension, &pathname[len + k + 2], extension_size );
+			return samples;
+		}
+	} else {
+		Q_strncatz( pathname, ".tga", pathsize );
+		samples = R_ReadImageFromDisk( ctx, pathname, pathsize, pic, width, height, flags, 0 );
+
+		if( pic[0] ) {
+			Q_strncpyz( extension, &pathname[len], extension_size );
+			return samples;
+		}
+	}
+
+	ri.Com_DPrintf( S_COLOR_YELLOW "Missing image: %s\n", image->name );
+	return 0;
+}
 
-			R_BindImage( image );
+/*
+* R_LoadImageFromDisk
+*/
+static bool R_LoadImageFromDisk( int ctx, image_t *image ) {
+	int flags = image->flags;
+	size_t len = strlen( image->name );
+	char pathname[1024];
+	int width, height, samples;
+	uint8_t *pic[6] = { NULL, NULL, NULL, NULL, NULL, NULL };
+
+	if( len >= sizeof( pathname ) - 7 ) {
+		return false;
+	}
 
-			R_Upload32( ctx, pic, 0, 0, 0, width, height, flags, image->minmipsize, &image->upload_width,
+	Q_snprintfz( pathname, sizeof( pathname ), "%s.ktx", image->name );
+	if( R_LoadKTX( ctx, image, pathname ) ) {
+		return true;
+	}
+
+	samples = R_ReadImageFacesFromDisk( ctx, image, pic, &width, &height, &flags,
+										image->extension, sizeof( image->extension ) );
+	if( !samples ) {
+		return false;
+	}
+
+	image->width = width;
+	image->height = height;
+	image->samples = samples;
+
+	R_BindImage( image );
+
+	R_Upload32( ctx, pic, 0, 0, 0, width, height, flags, image->minmipsize, &image->upload_width,
 				&image->upload_height, samples, false, false );
 
-			image->error = qglGetError();
-			Q_strncpyz( image->extension, &pathname[len + k + 2], sizeof( image->extension ) );
-			loaded = true;
-		} else {
-			ri.Com_DPrintf( S_COLOR_YELLOW "Missing image: %s\n", image->name );
-		}
+	image->error = qglGetError();
+
+	// Update IT_LOADFLAGS that may be set by R_ReadImageFromDisk.
+	image->flags = flags;
+	R_DeferDataSync();
+
+	return true;
+}
+
+/*
+=================================================================
+
+STAGED IMAGES
+
+Images decoded, resampled and mipmapped on decoder threads into
+a single allocation, with no GL calls involved. The loader thread
+owning a shared context only uploads the finished mip chain.
+
+=================================================================
+*/
+
+typedef struct {
+	int flags;
+	int width, height;                  // source size
+	int upload_width, upload_height;    // size of the first mip level
+	int samples;
+	int faces;
+	int mips;
+	char extension[8];
+	uint8_t *pixels;                    // faces * mips, all levels of a face are consecutive
+} imageStaging_t;
+
+/*
+* R_StageMipMap
+*/
+static void R_StageMipMap( const uint8_t *in, uint8_t *out, int width, int height, int samples ) {
+	imageFilterJob_t job;
+
+	memset( &job, 0, sizeof( job ) );
+	job.type = IMAGE_FILTER_MIPMAP;
+	job.in = in;
+	job.out = out;
+	job.inwidth = width;
+	job.inheight = height;
+	job.outwidth = max( width >> 1, 1 );
+	job.outheight = max( height >> 1, 1 );
+	job.samples = samples;
+	job.alignment = 1;
+
+	R_RunImageFilter( &job );
+}
+
+/*
+* R_StageImage32
+*
+* CPU part of R_Upload32 for images loaded from disk.
+*/
+static imageStaging_t *R_StageImage32( int slot, uint8_t **data, int width, int height, int flags, int minmipsize, int samples ) {
+	int i, j, w, h;
+	int faces, mips;
+	int scaledWidth, scaledHeight;
+	size_t size;
+	uint8_t *out;
+	imageStaging_t *st;
+
+	R_ScaledImageSize( width, height, &scaledWidth, &scaledHeight, flags, 1, minmipsize, false );
+
+	if( flags & IT_CUBEMAP ) {
+		faces = 6;
 	} else {
-		uint8_t *pic = NULL;
+		if( flags & ( IT_LEFTHALF | IT_RIGHTHALF ) ) {
+			// assume width represents half of the original image width
+			uint8_t *temp = R_PrepareImageBuffer( slot, TEXTURE_CUT_BUF, width * height * samples );
+			if( flags & IT_LEFTHALF ) {
+				R_CutImage( *data, width * 2, height, temp, 0, 0, width, height, samples );
+			} else {
+				R_CutImage( *data, width * 2, height, temp, width, 0, width, height, samples );
+			}
+			data = &r_imageBuffers[slot][TEXTURE_CUT_BUF];
+		}
 
-		Q_strncatz( pathname, ".tga", pathsize );
-		samples = R_ReadImageFromDisk( ctx, pathname, pathsize, &pic, &width, &height, &flags, 0 );
+		if( flags & ( IT_FLIPX | IT_FLIPY | IT_FLIPDIAGONAL ) ) {
+			uint8_t *temp = R_PrepareImageBuffer( slot, TEXTURE_FLIPPING_BUF0, width * height * samples );
+			R_FlipTexture( data[0], temp, width, height, samples,
+						   ( flags & IT_FLIPX ) ? true : false,
+						   ( flags & IT_FLIPY ) ? true : false,
+						   ( flags & IT_FLIPDIAGONAL ) ? true : false );
+			data = &r_imageBuffers[slot][TEXTURE_FLIPPING_BUF0];
+		}
 
-		if( pic ) {
-			image->width = width;
-			image->height = height;
-			image->samples = samples;
+		faces = 1;
+	}
 
-			R_BindImage( image );
+	mips = ( flags & IT_NOMIPMAP ) ? 1 : R_MipCount( scaledWidth, scaledHeight, minmipsize );
 
-			R_Upload32( ctx, &pic, 0, 0, 0, width, height, flags, image->minmipsize, &image->upload_width,
-						&image->upload_height, samples, false, false );
+	size = 0;
+	for( j = 0, w = scaledWidth, h = scaledHeight; j < mips; j++ ) {
+		size += w * h * samples;
+		w = max( w >> 1, 1 );
+		h = max( h >> 1, 1 );
+	}
 
-			image->error = qglGetError();
-			Q_strncpyz( image->extension, &pathname[len], sizeof( image->extension ) );
-			loaded = true;
-		} else {
-			ri.Com_DPrintf( S_COLOR_YELLOW "Missing image: %s\n", image->name );
+	st = R_MallocExt( r_imagesPool, sizeof( *st ) + size * faces, 16, 0 );
+	st->flags = flags;
+	st->width = width;
+	st->height = height;
+	st->upload_width = scaledWidth;
+	st->upload_height = scaledHeight;
+	st->samples = samples;
+	st->faces = faces;
+	st->mips = mips;
+	st->extension[0] = '\0';
+	st->pixels = ( uint8_t * )( st + 1 );
+
+	out = st->pixels;
+	for( i = 0; i < faces; i++ ) {
+		R_ResampleTexture( slot, data[i], width, height, out, scaledWidth, scaledHeight, samples, 1 );
+
+		for( j = 1, w = scaledWidth, h = scaledHeight; j < mips; j++ ) {
+			uint8_t *next = out + w * h * samples;
+
+			R_StageMipMap( out, next, w, h, samples );
+
+			out = next;
+			w = max( w >> 1, 1 );
+			h = max( h >> 1, 1 );
 		}
+		out += w * h * samples;
 	}
 
-	if( loaded ) {
-		// Update IT_LOADFLAGS that may be set by R_ReadImageFromDisk.
-		image->flags = flags;
-		R_DeferDataSync();
+	return st;
+}
+
+/*
+* R_UploadStagedImage
+*/
+static void R_UploadStagedImage( int ctx, image_t *image, const imageStaging_t *st ) {
+	int i, j, w, h;
+	int comp, format, type;
+	int target;
+	const uint8_t *data = st->pixels;
+
+	image->width = st->width;
+	image->height = st->height;
+	image->samples = st->samples;
+	image->upload_width = st->upload_width;
+	image->upload_height = st->upload_height;
+	Q_strncpyz( image->extension, st->extension, sizeof( image->extension ) );
+
+	R_BindImage( image );
+
+	R_TextureTarget( st->flags, &target );
+	R_TextureFormat( st->flags, st->samples, &comp, &format, &type );
+	R_SetupTexParameters( st->flags, st->upload_width, st->upload_height, image->minmipsize );
+
+	R_UnpackAlignment( ctx, 1 );
+
+	for( i = 0; i < st->faces; i++ ) {
+		for( j = 0, w = st->upload_width, h = st->upload_height; j < st->mips; j++ ) {
+			qglTexImage2D( target + i, j, comp, w, h, 0, format, type, data );
+
+			data += w * h * st->samples;
+			w = max( w >> 1, 1 );
+			h = max( h >> 1, 1 );
+		}
 	}
 
-	return loaded;
+	image->error = qglGetError();
+
+	// Update IT_LOADFLAGS that may be set by R_ReadImageFromDisk.
+	image->flags = st->flags;
+	R_DeferDataSync();
+}
+
+/*
+* R_DecodeImageFromDisk
+*
+* Returns NULL if the image is missing. If the image can't be decoded
+* without GL (KTX), *fallback is set and the loader should load it instead.
+*/
+static imageStaging_t *R_DecodeImageFromDisk( int slot, const image_t *image, bool *fallback ) {
+	int flags = image->flags;
+	int width, height, samples;
+	char pathname[1024];
+	char extension[8];
+	uint8_t *pic[6] = { NULL, NULL, NULL, NULL, NULL, NULL };
+	imageStaging_t *st;
+
+	*fallback = false;
+
+	if( !( flags & ( IT_FLIPX | IT_FLIPY | IT_FLIPDIAGONAL ) ) ) {
+		Q_snprintfz( pathname, sizeof( pathname ), "%s.ktx", image->name );
+		if( ri.FS_FOpenFile( pathname, NULL, FS_READ ) != -1 ) {
+			*fallback = true;
+			return NULL;
+		}
+	}
+
+	samples = R_ReadImageFacesFromDisk( slot, image, pic, &width, &height, &flags, extension, sizeof( extension ) );
+	if( !samples ) {
+		return NULL;
+	}
+
+	st = R_StageImage32( slot, pic, width, height, flags, image->minmipsize, samples );
+	Q_strncpyz( st->extension, extension, sizeof( st->extension ) );
+	return st;
 }
 
 /*
@@ -3054,10 +3422,16 @@ void R_InitImages( void ) {
 		r_images[i].next = &r_images[i + 1];
 	}
 
+	R_InitImageFilterThreads();
+
+	loader_lock = ri.Mutex_Create();
+
 	for( i = 0; i < NUM_LOADER_THREADS; i++ ) {
 		R_InitImageLoader( i );
 	}
 
+	R_InitImageDecoders();
+
 	R_InitStretchRawImages();
 	R_InitBuiltinImages();
 }
@@ -3132,10 +3506,16 @@ void R_ShutdownImages( void ) {
 		return;
 	}
 
+	R_ShutdownImageDecoders();
+
 	for( i = 0; i < NUM_LOADER_THREADS; i++ ) {
 		R_ShutdownImageLoader( i );
 	}
 
+	ri.Mutex_Destroy( &loader_lock );
+
+	R_ShutdownImageFilterThreads();
+
 	R_ReleaseBuiltinImages();
 
 	for( i = 0, image = r_images; i < MAX_GLIMAGES; i++, image++ ) {
@@ -3185,10 +3565,18 @@ enum {
 	CMD_LOADER_SHUTDOWN,
 	CMD_LOADER_LOAD_PIC,
 	CMD_LOADER_DATA_SYNC,
+	CMD_LOADER_UPLOAD_STAGED,
 
 	NUM_LOADER_CMDS
 };
 
+enum {
+	CMD_DECODER_DECODE_PIC,
+	CMD_DECODER_SHUTDOWN,
+
+	NUM_DECODER_CMDS
+};
+
 typedef struct {
 	int id;
 	int self;
@@ -3200,7 +3588,12 @@ typedef struct {
 	int pic;
 } loaderPicCmd_t;
 
-typedef unsigned (*queueCmdHandler_t)( const void * );
+typedef struct {
+	int id;
+	int self;
+	int pic;
+	imageStaging_t *staging;
+} loaderStagedCmd_t;
 
 static qbufPipe_t *loader_queue[NUM_LOADER_THREADS] = { NULL };
 static qthread_t *loader_thread[NUM_LOADER_THREADS] = { NULL };
@@ -3208,7 +3601,12 @@ static qthread_t *loader_thread[NUM_LOADER_THREADS] = { NULL };
 static void *loader_gl_context[NUM_LOADER_THREADS] = { NULL };
 static void *loader_gl_surface[NUM_LOADER_THREADS] = { NULL };
 
+static qbufPipe_t *decoder_queue[MAX_IMAGE_DECODER_THREADS] = { NULL };
+static qthread_t *decoder_thread[MAX_IMAGE_DECODER_THREADS] = { NULL };
+static int num_decoders;
+
 static void *R_ImageLoaderThreadProc( void *param );
+static void *R_ImageDecoderThreadProc( void *param );
 
 /*
 * R_IssueInitLoaderCmd
@@ -3237,7 +3635,9 @@ static void R_IssueLoadPicLoaderCmd( int id, int pic ) {
 	cmd.id = CMD_LOADER_LOAD_PIC;
 	cmd.self = id;
 	cmd.pic = pic;
+	ri.Mutex_Lock( loader_lock );
 	ri.BufPipe_WriteCmd( loader_queue[id], &cmd, sizeof( cmd ) );
+	ri.Mutex_Unlock( loader_lock );
 }
 
 /*
@@ -3246,7 +3646,43 @@ static void R_IssueLoadPicLoaderCmd( int id, int pic ) {
 static void R_IssueDataSyncLoaderCmd( int id ) {
 	int cmd;
 	cmd = CMD_LOADER_DATA_SYNC;
+	ri.Mutex_Lock( loader_lock );
+	ri.BufPipe_WriteCmd( loader_queue[id], &cmd, sizeof( cmd ) );
+	ri.Mutex_Unlock( loader_lock );
+}
+
+/*
+* R_IssueUploadStagedLoaderCmd
+*/
+static void R_IssueUploadStagedLoaderCmd( int id, int pic, imageStaging_t *staging ) {
+	loaderStagedCmd_t cmd;
+	cmd.id = CMD_LOADER_UPLOAD_STAGED;
+	cmd.self = id;
+	cmd.pic = pic;
+	cmd.staging = staging;
+	ri.Mutex_Lock( loader_lock );
 	ri.BufPipe_WriteCmd( loader_queue[id], &cmd, sizeof( cmd ) );
+	ri.Mutex_Unlock( loader_lock );
+}
+
+/*
+* R_IssueDecodePicDecoderCmd
+*/
+static void R_IssueDecodePicDecoderCmd( int id, int pic ) {
+	loaderPicCmd_t cmd;
+	cmd.id = CMD_DECODER_DECODE_PIC;
+	cmd.self = id;
+	cmd.pic = pic;
+	ri.BufPipe_WriteCmd( decoder_queue[id], &cmd, sizeof( cmd ) );
+}
+
+/*
+* R_IssueShutdownDecoderCmd
+*/
+static void R_IssueShutdownDecoderCmd( int id ) {
+	int cmd;
+	cmd = CMD_DECODER_SHUTDOWN;
+	ri.BufPipe_WriteCmd( decoder_queue[id], &cmd, sizeof( cmd ) );
 }
 
 /*
@@ -3272,12 +3708,57 @@ static void R_InitImageLoader( int id ) {
 	ri.BufPipe_Finish( loader_queue[id] );
 }
 
+/*
+* R_InitImageDecoders
+*
+* Decoders only make sense when there are loader threads to upload the results.
+*/
+static void R_InitImageDecoders( void ) {
+	int i;
+
+	num_decoders = 0;
+	if( !loader_gl_context[0] ) {
+		return;
+	}
+
+	num_decoders = Q_bound( 0, r_imagedecoders->integer, MAX_IMAGE_DECODER_THREADS );
+	for( i = 0; i < num_decoders; i++ ) {
+		decoder_queue[i] = ri.BufPipe_Create( 0x4000, 1 );
+		decoder_thread[i] = ri.Thread_Create( R_ImageDecoderThreadProc, decoder_queue[i] );
+	}
+}
+
+/*
+* R_ShutdownImageDecoders
+*/
+static void R_ShutdownImageDecoders( void ) {
+	int i;
+
+	for( i = 0; i < num_decoders; i++ ) {
+		R_IssueShutdownDecoderCmd( i );
+
+		ri.BufPipe_Finish( decoder_queue[i] );
+
+		ri.Thread_Join( decoder_thread[i] );
+		decoder_thread[i] = NULL;
+
+		ri.BufPipe_Destroy( &decoder_queue[i] );
+	}
+
+	num_decoders = 0;
+}
+
 /*
 * R_FinishLoadingImages
 */
 void R_FinishLoadingImages( void ) {
 	int i;
 
+	// decoders feed the loaders, so drain them first
+	for( i = 0; i < num_decoders; i++ ) {
+		ri.BufPipe_Finish( decoder_queue[i] );
+	}
+
 	for( i = 0; i < NUM_LOADER_THREADS; i++ ) {
 		if( loader_gl_context[i] ) {
 			R_IssueDataSyncLoaderCmd( i );
@@ -3318,7 +3799,11 @@ static bool R_LoadAsyncImageFromDisk( image_t *image ) {
 	R_UnbindImage( image );
 	qglFinish();
 
-	R_IssueLoadPicLoaderCmd( id, pic );
+	if( num_decoders ) {
+		R_IssueDecodePicDecoderCmd( pic % num_decoders, pic );
+	} else {
+		R_IssueLoadPicLoaderCmd( id, pic );
+	}
 	return true;
 }
 
@@ -3397,6 +3882,27 @@ static unsigned R_HandleLoadPicLoaderCmd( void *pcmd ) {
 	return sizeof( *cmd );
 }
 
+/*
+* R_HandleUploadStagedLoaderCmd
+*/
+static unsigned R_HandleUploadStagedLoaderCmd( void *pcmd ) {
+	loaderStagedCmd_t *cmd = pcmd;
+	image_t *image = r_images + cmd->pic;
+
+	R_UploadStagedImage( QGL_CONTEXT_LOADER + cmd->self, image, cmd->staging );
+	R_UnbindImage( image );
+
+	R_Free( cmd->staging );
+
+	// see R_HandleLoadPicLoaderCmd
+	if( !rsh.registrationOpen ) {
+		qglFinish();
+	}
+	image->loaded = true;
+
+	return sizeof( *cmd );
+}
+
 /*
 * R_HandleDataSyncLoaderCmd
 */
@@ -3426,6 +3932,68 @@ static void *R_ImageLoaderThreadProc( void *param ) {
 		(queueCmdHandler_t)R_HandleShutdownLoaderCmd,
 		(queueCmdHandler_t)R_HandleLoadPicLoaderCmd,
 		(queueCmdHandler_t)R_HandleDataSyncLoaderCmd,
+		(queueCmdHandler_t)R_HandleUploadStagedLoaderCmd,
+	};
+
+	ri.BufPipe_Wait( cmdQueue, R_ImageLoaderCmdsWaiter, cmdHandlers, Q_THREADS_WAIT_INFINITE );
+
+	return NULL;
+}
+
+//
+
+/*
+* R_HandleDecodePicDecoderCmd
+*/
+static unsigned R_HandleDecodePicDecoderCmd( void *pcmd ) {
+	loaderPicCmd_t *cmd = pcmd;
+	image_t *image = r_images + cmd->pic;
+	imageStaging_t *staging;
+	bool fallback;
+	uint64_t time;
+	int loader;
+
+	loader = cmd->pic % NUM_LOADER_THREADS;
+	if( loader_gl_context[loader] == NULL ) {
+		loader = 0;
+	}
+
+	time = ri.Sys_Microseconds();
+	staging = R_DecodeImageFromDisk( IMAGE_DECODER_SLOT( cmd->self ), image, &fallback );
+	time = ri.Sys_Microseconds() - time;
+
+	if( staging ) {
+		R_IssueUploadStagedLoaderCmd( loader, cmd->pic, staging );
+	} else if( fallback ) {
+		R_IssueLoadPicLoaderCmd( loader, cmd->pic );
+	} else {
+		image->missing = true;
+	}
+
+	ri.Mutex_Lock( loader_lock );
+	r_numDecodedImages++;
+	r_imageDecodeTime += time;
+	ri.Mutex_Unlock( loader_lock );
+
+	return sizeof( *cmd );
+}
+
+/*
+* R_HandleShutdownDecoderCmd
+*/
+static unsigned R_HandleShutdownDecoderCmd( void *pcmd ) {
+	return 0;
+}
+
+/*
+* R_ImageDecoderThreadProc
+*/
+static void *R_ImageDecoderThreadProc( void *param ) {
+	qbufPipe_t *cmdQueue = param;
+	queueCmdHandler_t cmdHandlers[NUM_DECODER_CMDS] =
+	{
+		(queueCmdHandler_t)R_HandleDecodePicDecoderCmd,
+		(queueCmdHandler_t)R_HandleShutdownDecoderCmd,
 	};
 
 	ri.BufPipe_Wait( cmdQueue, R_ImageLoaderCmdsWaiter, cmdHandlers, Q_THREADS_WAIT_INFINITE );
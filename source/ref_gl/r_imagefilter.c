@@ -0,0 +1,394 @@
+/*
+Copyright (C) 2018 Warsow development team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+#include "../gameshared/q_arch.h"
+#include "r_imagefilter.h"
+
+#if defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && ( _M_IX86_FP >= 2 ) )
+#define R_IMAGEFILTER_SSE2
+#include <emmintrin.h>
+#elif defined( __ARM_NEON ) || defined( __ARM_NEON__ )
+#define R_IMAGEFILTER_NEON
+#include <arm_neon.h>
+#endif
+
+/*
+* R_ImageFilterArch
+*/
+const char *R_ImageFilterArch( void ) {
+#if defined( R_IMAGEFILTER_SSE2 )
+	return "SSE2";
+#elif defined( R_IMAGEFILTER_NEON )
+	return "NEON";
+#else
+	return "generic";
+#endif
+}
+
+/*
+* R_LoadPixel32
+*/
+static inline uint32_t R_LoadPixel32( const uint8_t *p ) {
+	uint32_t v;
+	memcpy( &v, p, sizeof( v ) );
+	return v;
+}
+
+/*
+* R_MipMapRowSpan_Generic
+*
+* Filters output pixels [first, outwidth) of a single row
+*/
+static void R_MipMapRowSpan_Generic( const uint8_t *in, const uint8_t *next, uint8_t *out,
+									 int width, int outwidth, int samples, int first ) {
+	int j, k, inofs;
+
+	out += first * samples;
+	for( j = first, inofs = first * samples * 2; j < outwidth; j++, inofs += samples ) {
+		if( ( ( j << 1 ) + 1 ) < width ) {
+			for( k = 0; k < samples; ++k, ++inofs )
+				*( out++ ) = ( in[inofs] + in[inofs + samples] + next[inofs] + next[inofs + samples] ) >> 2;
+		} else {
+			for( k = 0; k < samples; ++k, ++inofs )
+				*( out++ ) = ( in[inofs] + next[inofs] ) >> 1;
+		}
+	}
+}
+
+/*
+* R_MipMapRowSpan
+*
+* Returns the number of output pixels filtered, the rest is left for the generic path
+*/
+static int R_MipMapRowSpan( const uint8_t *in, const uint8_t *next, uint8_t *out, int width, int samples ) {
+	int j = 0;
+	const int full = width >> 1;
+
+#if defined( R_IMAGEFILTER_SSE2 )
+	const __m128i zero = _mm_setzero_si128();
+
+	if( samples == 4 ) {
+		// 4 input pixels from each row -> 2 output pixels
+		for( ; j + 2 <= full; j += 2 ) {
+			__m128i a = _mm_loadu_si128( ( const __m128i * )( in + j * 8 ) );
+			__m128i b = _mm_loadu_si128( ( const __m128i * )( next + j * 8 ) );
+			__m128i lo = _mm_add_epi16( _mm_unpacklo_epi8( a, zero ), _mm_unpacklo_epi8( b, zero ) );
+			__m128i hi = _mm_add_epi16( _mm_unpackhi_epi8( a, zero ), _mm_unpackhi_epi8( b, zero ) );
+			__m128i sum = _mm_add_epi16( _mm_unpacklo_epi64( lo, hi ), _mm_unpackhi_epi64( lo, hi ) );
+			sum = _mm_srli_epi16( sum, 2 );
+			_mm_storel_epi64( ( __m128i * )( out + j * 4 ), _mm_packus_epi16( sum, sum ) );
+		}
+	} else if( samples == 1 ) {
+		// 16 input pixels from each row -> 8 output pixels
+		const __m128i ones = _mm_set1_epi16( 1 );
+
+		for( ; j + 8 <= full; j += 8 ) {
+			__m128i a = _mm_loadu_si128( ( const __m128i * )( in + j * 2 ) );
+			__m128i b = _mm_loadu_si128( ( const __m128i * )( next + j * 2 ) );
+			__m128i lo = _mm_add_epi16( _mm_unpacklo_epi8( a, zero ), _mm_unpacklo_epi8( b, zero ) );
+			__m128i hi = _mm_add_epi16( _mm_unpackhi_epi8( a, zero ), _mm_unpackhi_epi8( b, zero ) );
+			__m128i sum = _mm_packs_epi32( _mm_srli_epi32( _mm_madd_epi16( lo, ones ), 2 ),
+										   _mm_srli_epi32( _mm_madd_epi16( hi, ones ), 2 ) );
+			_mm_storel_epi64( ( __m128i * )( out + j ), _mm_packus_epi16( sum, sum ) );
+		}
+	}
+#elif defined( R_IMAGEFILTER_NEON )
+	if( samples == 4 ) {
+		for( ; j + 2 <= full; j += 2 ) {
+			uint8x16_t a = vld1q_u8( in + j * 8 );
+			uint8x16_t b = vld1q_u8( next + j * 8 );
+			uint16x8_t lo = vaddl_u8( vget_low_u8( a ), vget_low_u8( b ) );
+			uint16x8_t hi = vaddl_u8( vget_high_u8( a ), vget_high_u8( b ) );
+			uint16x8_t sum = vcombine_u16( vadd_u16( vget_low_u16( lo ), vget_high_u16( lo ) ),
+										   vadd_u16( vget_low_u16( hi ), vget_high_u16( hi ) ) );
+			vst1_u8( out + j * 4, vshrn_n_u16( sum, 2 ) );
+		}
+	} else if( samples == 1 ) {
+		for( ; j + 8 <= full; j += 8 ) {
+			uint16x8_t sum = vaddq_u16( vpaddlq_u8( vld1q_u8( in + j * 2 ) ), vpaddlq_u8( vld1q_u8( next + j * 2 ) ) );
+			vst1_u8( out + j, vshrn_n_u16( sum, 2 ) );
+		}
+	}
+#endif
+
+	return j;
+}
+
+/*
+* R_MipMapRows_
+*/
+static void R_MipMapRows_( const uint8_t *in, uint8_t *out, int width, int height, int samples, int alignment,
+						   int firstRow, int numRows, bool simd ) {
+	int i;
+	int instride = Q_ALIGN( width * samples, alignment );
+	int outwidth, outheight, outstride;
+	const uint8_t *next;
+
+	outwidth = width >> 1;
+	outheight = height >> 1;
+	if( !outwidth ) {
+		outwidth = 1;
+	}
+	if( !outheight ) {
+		outheight = 1;
+	}
+	outstride = Q_ALIGN( outwidth * samples, alignment );
+
+	if( firstRow + numRows > outheight ) {
+		numRows = outheight - firstRow;
+	}
+
+	in += firstRow * instride * 2;
+	out += firstRow * outstride;
+	for( i = firstRow; i < firstRow + numRows; i++, in += instride * 2, out += outstride ) {
+		next = ( ( ( i << 1 ) + 1 ) < height ) ? ( in + instride ) : in;
+		R_MipMapRowSpan_Generic( in, next, out, width, outwidth, samples,
+								 simd ? R_MipMapRowSpan( in, next, out, width, samples ) : 0 );
+	}
+}
+
+/*
+* R_MipMapRows
+*/
+void R_MipMapRows( const uint8_t *in, uint8_t *out, int width, int height, int samples, int alignment,
+				   int firstRow, int numRows ) {
+	R_MipMapRows_( in, out, width, height, samples, alignment, firstRow, numRows, true );
+}
+
+/*
+* R_MipMapRows_Generic
+*/
+void R_MipMapRows_Generic( const uint8_t *in, uint8_t *out, int width, int height, int samples, int alignment,
+						   int firstRow, int numRows ) {
+	R_MipMapRows_( in, out, width, height, samples, alignment, firstRow, numRows, false );
+}
+
+/*
+* R_MipMap16Rows
+*
+* Assumes unpack alignment of 4
+*/
+void R_MipMap16Rows( const unsigned short *in, unsigned short *out, int width, int height,
+					 int rMask, int gMask, int bMask, int aMask, int firstRow, int numRows ) {
+	int i, j;
+	int instride = Q_ALIGN( width, 2 );
+	int outwidth, outheight, outstride;
+	const unsigned short *next;
+	int col, p[4];
+
+	outwidth = width >> 1;
+	outheight = height >> 1;
+	if( !outwidth ) {
+		outwidth = 1;
+	}
+	if( !outheight ) {
+		outheight = 1;
+	}
+	outstride = Q_ALIGN( outwidth, 2 );
+
+	if( firstRow + numRows > outheight ) {
+		numRows = outheight - firstRow;
+	}
+
+	in += firstRow * instride * 2;
+	out += firstRow * outstride;
+	for( i = firstRow; i < firstRow + numRows; i++, in += instride * 2, out += outstride - outwidth ) {
+		next = ( ( ( i << 1 ) + 1 ) < height ) ? ( in + instride ) : in;
+		for( j = 0; j < outwidth; j++ ) {
+			col = j << 1;
+			p[0] = in[col];
+			p[1] = next[col];
+			if( ( col + 1 ) < width ) {
+				p[2] = in[col + 1];
+				p[3] = next[col + 1];
+				*( out++ ) =    ( ( ( ( p[0] & rMask ) + ( p[1] & rMask ) + ( p[2] & rMask ) + ( p[3] & rMask ) ) >> 2 ) & rMask ) |
+							 ( ( ( ( p[0] & gMask ) + ( p[1] & gMask ) + ( p[2] & gMask ) + ( p[3] & gMask ) ) >> 2 ) & gMask ) |
+							 ( ( ( ( p[0] & bMask ) + ( p[1] & bMask ) + ( p[2] & bMask ) + ( p[3] & bMask ) ) >> 2 ) & bMask ) |
+							 ( ( ( ( p[0] & aMask ) + ( p[1] & aMask ) + ( p[2] & aMask ) + ( p[3] & aMask ) ) >> 2 ) & aMask );
+			} else {
+				*( out++ ) =    ( ( ( ( p[0] & rMask ) + ( p[1] & rMask ) ) >> 1 ) & rMask ) |
+							 ( ( ( ( p[0] & gMask ) + ( p[1] & gMask ) ) >> 1 ) & gMask ) |
+							 ( ( ( ( p[0] & bMask ) + ( p[1] & bMask ) ) >> 1 ) & bMask ) |
+							 ( ( ( ( p[0] & aMask ) + ( p[1] & aMask ) ) >> 1 ) & aMask );
+			}
+		}
+	}
+}
+
+/*
+* R_ResampleColumnTable
+*
+* Fills two sets of column offsets, at 1/4 and 3/4 of each output pixel
+*/
+void R_ResampleColumnTable( unsigned *table, int inwidth, int outwidth, int samples ) {
+	int i;
+	unsigned int frac, fracstep;
+	unsigned *p1 = table, *p2 = table + outwidth;
+
+	fracstep = inwidth * 0x10000 / outwidth;
+
+	frac = fracstep >> 2;
+	for( i = 0; i < outwidth; i++ ) {
+		p1[i] = samples * ( frac >> 16 );
+		frac += fracstep;
+	}
+
+	frac = 3 * ( fracstep >> 2 );
+	for( i = 0; i < outwidth; i++ ) {
+		p2[i] = samples * ( frac >> 16 );
+		frac += fracstep;
+	}
+}
+
+/*
+* R_ResampleRowSpan
+*
+* Returns the number of output pixels filtered, the rest is left for the generic path
+*/
+static int R_ResampleRowSpan( const uint8_t *inrow, const uint8_t *inrow2, uint8_t *out,
+							  int outwidth, int samples, const unsigned *p1, const unsigned *p2 ) {
+	int j = 0;
+
+	if( samples != 4 ) {
+		return 0;
+	}
+
+#if defined( R_IMAGEFILTER_SSE2 )
+	{
+		const __m128i zero = _mm_setzero_si128();
+
+		for( ; j + 2 <= outwidth; j += 2 ) {
+			__m128i a = _mm_unpacklo_epi32( _mm_cvtsi32_si128( R_LoadPixel32( inrow + p1[j] ) ),
+											_mm_cvtsi32_si128( R_LoadPixel32( inrow + p1[j + 1] ) ) );
+			__m128i b = _mm_unpacklo_epi32( _mm_cvtsi32_si128( R_LoadPixel32( inrow + p2[j] ) ),
+											_mm_cvtsi32_si128( R_LoadPixel32( inrow + p2[j + 1] ) ) );
+			__m128i c = _mm_unpacklo_epi32( _mm_cvtsi32_si128( R_LoadPixel32( inrow2 + p1[j] ) ),
+											_mm_cvtsi32_si128( R_LoadPixel32( inrow2 + p1[j + 1] ) ) );
+			__m128i d = _mm_unpacklo_epi32( _mm_cvtsi32_si128( R_LoadPixel32( inrow2 + p2[j] ) ),
+											_mm_cvtsi32_si128( R_LoadPixel32( inrow2 + p2[j + 1] ) ) );
+			__m128i sum = _mm_add_epi16( _mm_add_epi16( _mm_unpacklo_epi8( a, zero ), _mm_unpacklo_epi8( b, zero ) ),
+										 _mm_add_epi16( _mm_unpacklo_epi8( c, zero ), _mm_unpacklo_epi8( d, zero ) ) );
+			sum = _mm_srli_epi16( sum, 2 );
+			_mm_storel_epi64( ( __m128i * )( out + j * 4 ), _mm_packus_epi16( sum, sum ) );
+		}
+	}
+#elif defined( R_IMAGEFILTER_NEON )
+	for( ; j + 2 <= outwidth; j += 2 ) {
+		uint8x8_t a = vcreate_u8( R_LoadPixel32( inrow + p1[j] ) | ( (uint64_t)R_LoadPixel32( inrow + p1[j + 1] ) << 32 ) );
+		uint8x8_t b = vcreate_u8( R_LoadPixel32( inrow + p2[j] ) | ( (uint64_t)R_LoadPixel32( inrow + p2[j + 1] ) << 32 ) );
+		uint8x8_t c = vcreate_u8( R_LoadPixel32( inrow2 + p1[j] ) | ( (uint64_t)R_LoadPixel32( inrow2 + p1[j + 1] ) << 32 ) );
+		uint8x8_t d = vcreate_u8( R_LoadPixel32( inrow2 + p2[j] ) | ( (uint64_t)R_LoadPixel32( inrow2 + p2[j + 1] ) << 32 ) );
+		uint16x8_t sum = vaddq_u16( vaddl_u8( a, b ), vaddl_u8( c, d ) );
+		vst1_u8( out + j * 4, vshrn_n_u16( sum, 2 ) );
+	}
+#endif
+
+	return j;
+}
+
+/*
+* R_ResampleRows_
+*/
+static void R_ResampleRows_( const uint8_t *in, int inwidth, int inheight, uint8_t *out, int outwidth, int outheight,
+							 int samples, int alignment, const unsigned *table, int firstRow, int numRows, bool simd ) {
+	int i, j, k;
+	int inwidthS, outwidthS;
+	const unsigned *p1 = table, *p2 = table + outwidth;
+	const uint8_t *inrow, *inrow2, *pix1, *pix2, *pix3, *pix4;
+	uint8_t *opix;
+
+	if( firstRow + numRows > outheight ) {
+		numRows = outheight - firstRow;
+	}
+
+	inwidthS = Q_ALIGN( inwidth * samples, alignment );
+	outwidthS = Q_ALIGN( outwidth * samples, alignment );
+	out += firstRow * outwidthS;
+	for( i = firstRow; i < firstRow + numRows; i++, out += outwidthS ) {
+		inrow = in + inwidthS * (int)( ( i + 0.25 ) * inheight / outheight );
+		inrow2 = in + inwidthS * (int)( ( i + 0.75 ) * inheight / outheight );
+
+		j = simd ? R_ResampleRowSpan( inrow, inrow2, out, outwidth, samples, p1, p2 ) : 0;
+		for( ; j < outwidth; j++ ) {
+			pix1 = inrow + p1[j];
+			pix2 = inrow + p2[j];
+			pix3 = inrow2 + p1[j];
+			pix4 = inrow2 + p2[j];
+			opix = out + j * samples;
+
+			for( k = 0; k < samples; k++ )
+				opix[k] = ( pix1[k] + pix2[k] + pix3[k] + pix4[k] ) >> 2;
+		}
+	}
+}
+
+/*
+* R_ResampleRows
+*/
+void R_ResampleRows( const uint8_t *in, int inwidth, int inheight, uint8_t *out, int outwidth, int outheight,
+					 int samples, int alignment, const unsigned *table, int firstRow, int numRows ) {
+	R_ResampleRows_( in, inwidth, inheight, out, outwidth, outheight, samples, alignment, table, firstRow, numRows, true );
+}
+
+/*
+* R_ResampleRows_Generic
+*/
+void R_ResampleRows_Generic( const uint8_t *in, int inwidth, int inheight, uint8_t *out, int outwidth, int outheight,
+							 int samples, int alignment, const unsigned *table, int firstRow, int numRows ) {
+	R_ResampleRows_( in, inwidth, inheight, out, outwidth, outheight, samples, alignment, table, firstRow, numRows, false );
+}
+
+/*
+* R_Resample16Rows
+*
+* Assumes 16-bit unpack alignment
+*/
+void R_Resample16Rows( const unsigned short *in, int inwidth, int inheight, unsigned short *out, int outwidth, int outheight,
+					   int rMask, int gMask, int bMask, int aMask, const unsigned *table, int firstRow, int numRows ) {
+	int i, j;
+	int inwidthA, outwidthA;
+	const unsigned *p1 = table, *p2 = table + outwidth;
+	const unsigned short *inrow, *inrow2, *pix1, *pix2, *pix3, *pix4;
+	unsigned short *opix;
+
+	if( firstRow + numRows > outheight ) {
+		numRows = outheight - firstRow;
+	}
+
+	inwidthA = Q_ALIGN( inwidth, 2 );
+	outwidthA = Q_ALIGN( outwidth, 2 );
+	out += firstRow * outwidthA;
+	for( i = firstRow; i < firstRow + numRows; i++, out += outwidthA ) {
+		inrow = in + inwidthA * (int)( ( i + 0.25 ) * inheight / outheight );
+		inrow2 = in + inwidthA * (int)( ( i + 0.75 ) * inheight / outheight );
+		for( j = 0; j < outwidth; j++ ) {
+			pix1 = inrow + p1[j];
+			pix2 = inrow + p2[j];
+			pix3 = inrow2 + p1[j];
+			pix4 = inrow2 + p2[j];
+			opix = out + j;
+
+			*opix = ( ( ( ( *pix1 & rMask ) + ( *pix2 & rMask ) + ( *pix3 & rMask ) + ( *pix4 & rMask ) ) >> 2 ) & rMask ) |
+					( ( ( ( *pix1 & gMask ) + ( *pix2 & gMask ) + ( *pix3 & gMask ) + ( *pix4 & gMask ) ) >> 2 ) & gMask ) |
+					( ( ( ( *pix1 & bMask ) + ( *pix2 & bMask ) + ( *pix3 & bMask ) + ( *pix4 & bMask ) ) >> 2 ) & bMask ) |
+					( ( ( ( *pix1 & aMask ) + ( *pix2 & aMask ) + ( *pix3 & aMask ) + ( *pix4 & aMask ) ) >> 2 ) & aMask );
+		}
+	}
+}
@@ -0,0 +1,60 @@
+/*
+Copyright (C) 2018 Warsow development team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+#ifndef R_IMAGEFILTER_H
+#define R_IMAGEFILTER_H
+
+// Row-range texture filtering kernels used by the image uploader.
+//
+// The kernels don't depend on the renderer imports, so they can be run
+// in parallel over disjoint row ranges and linked into standalone tools.
+// All vectorized paths are bit-exact with the scalar reference code.
+
+const char *R_ImageFilterArch( void );
+
+/*
+* Box-filter mipmapping. Output row i is computed from input rows 2i and 2i+1.
+* Writing in place (out == in) is only allowed when all rows are processed
+* by a single call, in ascending order.
+*/
+void R_MipMapRows( const uint8_t *in, uint8_t *out, int width, int height, int samples, int alignment,
+				   int firstRow, int numRows );
+void R_MipMap16Rows( const unsigned short *in, unsigned short *out, int width, int height,
+					 int rMask, int gMask, int bMask, int aMask, int firstRow, int numRows );
+
+/*
+* 4-tap resampling. The column offset tables (2 * outwidth entries) must be
+* filled by R_ResampleColumnTable before running any row range.
+*/
+void R_ResampleColumnTable( unsigned *table, int inwidth, int outwidth, int samples );
+void R_ResampleRows( const uint8_t *in, int inwidth, int inheight, uint8_t *out, int outwidth, int outheight,
+					 int samples, int alignment, const unsigned *table, int firstRow, int numRows );
+void R_Resample16Rows( const unsigned short *in, int inwidth, int inheight, unsigned short *out, int outwidth, int outheight,
+					   int rMask, int gMask, int bMask, int aMask, const unsigned *table, int firstRow, int numRows );
+
+/*
+* Scalar reference implementations, exposed for validation.
+*/
+void R_MipMapRows_Generic( const uint8_t *in, uint8_t *out, int width, int height, int samples, int alignment,
+						   int firstRow, int numRows );
+void R_ResampleRows_Generic( const uint8_t *in, int inwidth, int inheight, uint8_t *out, int outwidth, int outheight,
+							 int samples, int alignment, const unsigned *table, int firstRow, int numRows );
+
+#endif // R_IMAGEFILTER_H
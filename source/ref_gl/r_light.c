@@ -1273,12 +1273,11 @@ static void R_CompileRtLightVisInfo( rtlight_t *l, mbrushmodel_t *bm, r_lightWor
 }
 
 /*
-* R_GetRtLightVisInfo
+* R_GetRtLightVisInfo_
 */
-void R_GetRtLightVisInfo( mbrushmodel_t *bm, rtlight_t *l ) {
+static void R_GetRtLightVisInfo_( mbrushmodel_t *bm, rtlight_t *l, r_lightWorldVis_t *vis ) {
 	unsigned i;
 	mleaf_t *leaf;
-	r_lightWorldVis_t *vis = &r_lightWorldVis;
 
 	l->area = -1;
 	l->cluster = CLUSTER_INVALID;
@@ -1289,7 +1288,7 @@ void R_GetRtLightVisInfo( mbrushmodel_t *bm, rtlight_t *l ) {
 		l->area = leaf->area;
 	}
 
-	R_AllocLightWorldVis( &r_lightWorldVis, bm );
+	R_AllocLightWorldVis( vis, bm );
 
 	R_GetRtLightLeafVisInfo( l, bm->nodes, bm, vis );
 
@@ -1330,6 +1329,354 @@ void R_GetRtLightVisInfo( mbrushmodel_t *bm, rtlight_t *l ) {
 	}
 }
 
+/*
+* R_GetRtLightVisInfo
+*/
+void R_GetRtLightVisInfo( mbrushmodel_t *bm, rtlight_t *l ) {
+	R_GetRtLightVisInfo_( bm, l, &r_lightWorldVis );
+}
+
+/*
+=============================================================================
+
+WORLD LIGHTS VISIBILITY CACHE
+
+=============================================================================
+*/
+
+// Visibility info for static world lights is computed on the job threads
+// at map load and stored in a per-map file in the cache directory. The
+// file is keyed by the BSP checksum and the world surface layout, and each
+// light record by the light parameters the visibility depends on.
+
+#define RTLIGHTVIS_CACHE_IDENT      ( ( 'V' << 24 ) + ( 'L' << 16 ) + ( 'T' << 8 ) + 'R' )
+#define RTLIGHTVIS_CACHE_VERSION    2
+#define RTLIGHTVIS_CACHE_EXTENSION  ".rlv"
+
+typedef struct {
+	int ident;
+	int version;
+	unsigned layoutHash;
+	unsigned numLights;
+} rtLightVisCacheHeader_t;
+
+typedef struct {
+	vec3_t origin;
+	mat3_t axis;
+	float intensity;
+	vec3_t lightmins, lightmaxs;
+	int shadow;
+	int sky;
+} rtLightVisKey_t;
+
+typedef struct {
+	rtLightVisKey_t key;
+	int cluster, area;
+	vec3_t worldmins, worldmaxs;
+	unsigned numVisLeafs;
+	unsigned surfaceInfoSize;
+	unsigned numReceiveSurfaces, numShadowSurfaces;
+} rtLightVisCacheLight_t;
+
+typedef struct {
+	mbrushmodel_t *bm;
+	rtlight_t *lights;
+	const unsigned *indices;
+} rtLightVisJob_t;
+
+/*
+* R_RtLightVisKey
+*/
+static void R_RtLightVisKey( const rtlight_t *l, rtLightVisKey_t *key ) {
+	memset( key, 0, sizeof( *key ) );
+	VectorCopy( l->origin, key->origin );
+	Matrix3_Copy( l->axis, key->axis );
+	key->intensity = l->intensity;
+	VectorCopy( l->lightmins, key->lightmins );
+	VectorCopy( l->lightmaxs, key->lightmaxs );
+	key->shadow = l->shadow ? 1 : 0;
+	key->sky = l->sky ? 1 : 0;
+}
+
+/*
+* R_RtLightSurfaceInfoSize
+*
+* Returns the number of words in the surfaceInfo array:
+* numDrawSurfs, (drawSurf, numVisSurfs, (surf, receivermask, castermask)[numVisSurfs])[numDrawSurfs]
+*/
+static unsigned R_RtLightSurfaceInfoSize( const unsigned *surfaceInfo ) {
+	unsigned i, numDrawSurfs;
+	const unsigned *p;
+
+	if( !surfaceInfo ) {
+		return 0;
+	}
+
+	numDrawSurfs = surfaceInfo[0];
+	p = surfaceInfo + 1;
+	for( i = 0; i < numDrawSurfs; i++ ) {
+		p += 2 + p[1] * 3;
+	}
+	return p - surfaceInfo;
+}
+
+/*
+* R_WorldLayoutHash
+*
+* Light visibility also depends on the drawsurface grouping and on the
+* shader flags of world surfaces, which aren't covered by the BSP checksum.
+*/
+static unsigned R_WorldLayoutHash( const mbrushmodel_t *bm ) {
+	unsigned i, j;
+	unsigned hash = 2166136261u;
+
+#define HASH_WORD( w ) ( hash = ( hash ^ (unsigned)( w ) ) * 16777619u )
+	HASH_WORD( bm->checksum );
+	HASH_WORD( bm->numleafs );
+	HASH_WORD( bm->numsurfaces );
+	HASH_WORD( bm->numDrawSurfaces );
+
+	for( i = 0; i < bm->numDrawSurfaces; i++ ) {
+		const drawSurfaceBSP_t *drawSurf = bm->drawSurfaces + i;
+
+		HASH_WORD( drawSurf->numWorldSurfaces );
+		for( j = 0; j < drawSurf->numWorldSurfaces; j++ ) {
+			HASH_WORD( drawSurf->worldSurfaces[j] );
+		}
+	}
+
+	for( i = 0; i < bm->numsurfaces; i++ ) {
+		const msurface_t *surf = bm->surfaces + i;
+
+		HASH_WORD( surf->drawSurf );
+		HASH_WORD( ( R_SurfNoDlight( surf ) ? 1 : 0 ) | ( R_SurfNoShadow( surf ) ? 2 : 0 ) | ( surf->flags & SURF_SKY ) );
+	}
+#undef HASH_WORD
+
+	return hash;
+}
+
+/*
+* R_RtLightVisCacheFileName
+*/
+static void R_RtLightVisCacheFileName( const model_t *model, char *dest, size_t size ) {
+	Q_strncpyz( dest, model->name, size );
+	COM_ReplaceExtension( dest, RTLIGHTVIS_CACHE_EXTENSION, size );
+}
+
+/*
+* R_LoadRtLightsVisCache
+*
+* Restores visibility info for lights whose parameters match the cached
+* ones, marking them in the loaded array. Returns the number of restored lights.
+*/
+static unsigned R_LoadRtLightsVisCache( model_t *model, unsigned layoutHash, bool *loaded ) {
+	unsigned i, numLoaded;
+	int file;
+	char name[MAX_QPATH];
+	rtLightVisCacheHeader_t header;
+	rtLightVisCacheLight_t rec;
+	rtLightVisKey_t key;
+	mbrushmodel_t *bm = ( mbrushmodel_t * )model->extradata;
+
+	R_RtLightVisCacheFileName( model, name, sizeof( name ) );
+	if( ri.FS_FOpenFile( name, &file, FS_READ | FS_CACHE ) < 0 ) {
+		return 0;
+	}
+
+	if( ri.FS_Read( &header, sizeof( header ), file ) != sizeof( header )
+		|| header.ident != RTLIGHTVIS_CACHE_IDENT || header.version != RTLIGHTVIS_CACHE_VERSION
+		|| header.layoutHash != layoutHash ) {
+		ri.FS_FCloseFile( file );
+		return 0;
+	}
+
+	numLoaded = 0;
+	for( i = 0; i < header.numLights && i < bm->numRtLights; i++ ) {
+		rtlight_t *l = bm->rtLights + i;
+		unsigned *visLeafs, *surfaceInfo;
+
+		if( ri.FS_Read( &rec, sizeof( rec ), file ) != sizeof( rec ) ) {
+			break;
+		}
+		if( rec.numVisLeafs > bm->numleafs || rec.surfaceInfoSize < 1 ||
+			rec.surfaceInfoSize > 1 + bm->numDrawSurfaces * 2 + bm->numsurfaces * 3 ) {
+			break;
+		}
+
+		R_RtLightVisKey( l, &key );
+		if( l->directional || memcmp( &key, &rec.key, sizeof( key ) ) ) {
+			ri.FS_Seek( file, ( rec.numVisLeafs + rec.surfaceInfoSize ) * sizeof( unsigned ), FS_SEEK_CUR );
+			continue;
+		}
+
+		visLeafs = R_MallocExt( model->mempool, sizeof( unsigned ) * rec.numVisLeafs, 0, 1 );
+		surfaceInfo = R_MallocExt( model->mempool, sizeof( unsigned ) * rec.surfaceInfoSize, 0, 1 );
+		if( ri.FS_Read( visLeafs, sizeof( unsigned ) * rec.numVisLeafs, file ) != (int)( sizeof( unsigned ) * rec.numVisLeafs )
+			|| ri.FS_Read( surfaceInfo, sizeof( unsigned ) * rec.surfaceInfoSize, file ) != (int)( sizeof( unsigned ) * rec.surfaceInfoSize )
+			|| R_RtLightSurfaceInfoSize( surfaceInfo ) != rec.surfaceInfoSize ) {
+			R_Free( visLeafs );
+			R_Free( surfaceInfo );
+			break;
+		}
+
+		l->cluster = rec.cluster;
+		l->area = rec.area;
+		VectorCopy( rec.worldmins, l->worldmins );
+		VectorCopy( rec.worldmaxs, l->worldmaxs );
+		l->numVisLeafs = rec.numVisLeafs;
+		l->visLeafs = visLeafs;
+		l->surfaceInfo = surfaceInfo;
+		l->numReceiveSurfaces = rec.numReceiveSurfaces;
+		l->numShadowSurfaces = rec.numShadowSurfaces;
+
+		loaded[i] = true;
+		numLoaded++;
+	}
+
+	ri.FS_FCloseFile( file );
+	return numLoaded;
+}
+
+/*
+* R_WriteRtLightsVisCache
+*/
+static void R_WriteRtLightsVisCache( model_t *model, unsigned layoutHash ) {
+	unsigned i;
+	int file;
+	char name[MAX_QPATH];
+	rtLightVisCacheHeader_t header;
+	rtLightVisCacheLight_t rec;
+	mbrushmodel_t *bm = ( mbrushmodel_t * )model->extradata;
+
+	R_RtLightVisCacheFileName( model, name, sizeof( name ) );
+	if( ri.FS_FOpenFile( name, &file, FS_WRITE | FS_CACHE ) == -1 ) {
+		Com_Printf( S_COLOR_YELLOW "Could not open %s for writing.\n", name );
+		return;
+	}
+
+	// written invalid and fixed up at the end, see below
+	header.ident = 0;
+	header.version = RTLIGHTVIS_CACHE_VERSION;
+	header.layoutHash = layoutHash;
+	header.numLights = bm->numRtLights;
+	ri.FS_Write( &header, sizeof( header ), file );
+
+	for( i = 0; i < bm->numRtLights; i++ ) {
+		const rtlight_t *l = bm->rtLights + i;
+
+		memset( &rec, 0, sizeof( rec ) );
+		R_RtLightVisKey( l, &rec.key );
+		rec.cluster = l->cluster;
+		rec.area = l->area;
+		VectorCopy( l->worldmins, rec.worldmins );
+		VectorCopy( l->worldmaxs, rec.worldmaxs );
+		rec.numVisLeafs = l->visLeafs ? l->numVisLeafs : 0;
+		rec.surfaceInfoSize = R_RtLightSurfaceInfoSize( l->surfaceInfo );
+		rec.numReceiveSurfaces = l->numReceiveSurfaces;
+		rec.numShadowSurfaces = l->numShadowSurfaces;
+		if( l->directional ) {
+			// never matched on load
+			rec.key.intensity = -1;
+		}
+
+		ri.FS_Write( &rec, sizeof( rec ), file );
+		ri.FS_Write( l->visLeafs, sizeof( unsigned ) * rec.numVisLeafs, file );
+		ri.FS_Write( l->surfaceInfo, sizeof( unsigned ) * rec.surfaceInfoSize, file );
+	}
+
+	ri.FS_FCloseFile( file );
+
+	if( ri.FS_FOpenFile( name, &file, FS_UPDATE | FS_CACHE ) != -1 ) {
+		header.ident = RTLIGHTVIS_CACHE_IDENT;
+		ri.FS_Write( &header, sizeof( header ), file );
+		ri.FS_FCloseFile( file );
+	}
+}
+
+/*
+* R_GetRtLightsVisInfoJob
+*/
+static void R_GetRtLightsVisInfoJob( unsigned first, unsigned items, jobarg_t *arg ) {
+	unsigned i;
+	const rtLightVisJob_t *job = arg->parg;
+	r_lightWorldVis_t vis;
+
+	// each job thread needs its own scratch space
+	memset( &vis, 0, sizeof( vis ) );
+
+	for( i = first; i < first + items; i++ ) {
+		R_GetRtLightVisInfo_( job->bm, job->lights + job->indices[i], &vis );
+	}
+
+	R_Free( vis.visLeafs );
+	R_Free( vis.surfMasks );
+	R_Free( vis.drawSurfPvs );
+}
+
+/*
+* R_GetWorldRtLightsVisInfo
+*
+* Computes visibility info for all static world lights at once, restoring
+* it from the disk cache when possible.
+*/
+void R_GetWorldRtLightsVisInfo( model_t *model ) {
+	unsigned i, numLoaded, numMissing;
+	unsigned layoutHash;
+	unsigned *missing;
+	bool *loaded;
+	int64_t time;
+	mbrushmodel_t *bm;
+	rtLightVisJob_t job;
+	jobarg_t arg;
+
+	if( !model || !( bm = ( mbrushmodel_t * )model->extradata ) || !bm->numRtLights ) {
+		return;
+	}
+
+	time = ri.Sys_Milliseconds();
+
+	loaded = R_Malloc( sizeof( *loaded ) * bm->numRtLights );
+	missing = R_Malloc( sizeof( *missing ) * bm->numRtLights );
+
+	layoutHash = R_WorldLayoutHash( bm );
+
+	numLoaded = 0;
+	if( r_bspcache->integer ) {
+		numLoaded = R_LoadRtLightsVisCache( model, layoutHash, loaded );
+	}
+
+	numMissing = 0;
+	for( i = 0; i < bm->numRtLights; i++ ) {
+		if( !loaded[i] ) {
+			missing[numMissing++] = i;
+		}
+	}
+
+	if( numMissing ) {
+		job.bm = bm;
+		job.lights = bm->rtLights;
+		job.indices = missing;
+
+		arg.iarg = 0;
+		arg.uarg = 0;
+		arg.parg = &job;
+
+		RJ_ScheduleJob( &R_GetRtLightsVisInfoJob, &arg, numMissing );
+		RJ_FinishJobs();
+
+		if( r_bspcache->integer ) {
+			R_WriteRtLightsVisCache( model, layoutHash );
+		}
+	}
+
+	ri.Com_DPrintf( "Light visibility for %u world lights: %u cached, %u computed in %i ms\n",
+		bm->numRtLights, numLoaded, numMissing, (int)( ri.Sys_Milliseconds() - time ) );
+
+	R_Free( missing );
+	R_Free( loaded );
+}
+
 /*
 * R_SetRtLightColor
 */
@@ -174,6 +174,7 @@ bool		R_AllocLightmap_Block( lightmapAllocState_t *state, int blockwidth, int bl
 void		R_InitRtLight( rtlight_t *l, const vec3_t origin, const vec_t *axis, float radius, const vec3_t color );
 void		R_InitRtDirectionalLight( rtlight_t *l, vec3_t corners[8], const vec3_t color );
 void		R_GetRtLightVisInfo( mbrushmodel_t *bm, rtlight_t *l );
+void		R_GetWorldRtLightsVisInfo( struct model_s *model );
 
 void		R_SetRtLightColor( rtlight_t *l, const vec3_t color );
 
@@ -46,6 +46,7 @@ typedef vec_t instancePoint_t[8]; // quaternion for rotation + xyz pos + uniform
 #define NUM_CUSTOMCOLORS        16
 
 #define NUM_LOADER_THREADS      4 // optimal value found by testing, when there are too many, CPU usage may be 100%
+#define MAX_IMAGE_DECODER_THREADS   16 // CPU-only threads feeding the loaders, see r_imagedecoders
 
 #ifdef CGAMEGETLIGHTORIGIN
 #define SHADOW_MAPPING          2
@@ -403,6 +404,7 @@ extern cvar_t *r_dynamiclight;
 extern cvar_t *r_coronascale;
 extern cvar_t *r_detailtextures;
 extern cvar_t *r_subdivisions;
+extern cvar_t *r_bspcache;
 extern cvar_t *r_showtris;
 extern cvar_t *r_showtris2D;
 extern cvar_t *r_draworder;
@@ -486,6 +488,7 @@ extern cvar_t *r_gamma;
 extern cvar_t *r_texturemode;
 extern cvar_t *r_texturefilter;
 extern cvar_t *r_texturecompression;
+extern cvar_t *r_imagedecoders;
 extern cvar_t *r_mode;
 extern cvar_t *r_nobind;
 extern cvar_t *r_picmip;
@@ -683,6 +686,7 @@ void        R_DataSync( void );
 void        R_DeferDataSync( void );
 
 mfog_t      *R_FogForBounds( const vec3_t mins, const vec3_t maxs );
+mfog_t      *R_WorldFogForBounds( const vec3_t mins, const vec3_t maxs );
 mfog_t      *R_FogForSphere( const vec3_t centre, const float radius );
 
 int			R_ComputeLOD( float dist, float lodDistance, float lodScale, int lodBias );
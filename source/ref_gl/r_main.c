@@ -103,15 +103,27 @@ void R_TransformForEntity( const entity_t *e ) {
 * R_FogForBounds
 */
 mfog_t *R_FogForBounds( const vec3_t mins, const vec3_t maxs ) {
-	unsigned int i, j;
-	mfog_t *fog;
-
-	if( !rsh.worldModel || ( rn.refdef.rdflags & RDF_NOWORLDMODEL ) || !rsh.worldBrushModel->numfogs ) {
+	if( rn.refdef.rdflags & RDF_NOWORLDMODEL ) {
 		return NULL;
 	}
 	if( rn.renderFlags & RF_SHADOWMAPVIEW ) {
 		return NULL;
 	}
+	return R_WorldFogForBounds( mins, maxs );
+}
+
+/*
+* R_WorldFogForBounds
+*
+* Doesn't depend on the view being rendered, so it can be used by the frontend.
+*/
+mfog_t *R_WorldFogForBounds( const vec3_t mins, const vec3_t maxs ) {
+	unsigned int i, j;
+	mfog_t *fog;
+
+	if( !rsh.worldModel || !rsh.worldBrushModel->numfogs ) {
+		return NULL;
+	}
 	if( rsh.worldBrushModel->globalfog ) {
 		return rsh.worldBrushModel->globalfog;
 	}
@@ -2014,7 +2026,10 @@ void R_EndFrame( void ) {
 
 	RB_EndFrame();
 
+	ri.Prof_Begin( "GLimp_EndFrame" );
 	GLimp_EndFrame();
+	ri.Prof_End( "GLimp_EndFrame" );
+	ri.Prof_Mark( "frame presented" );
 
 	rf.transformMatrixStackSize[0] = 0;
 	rf.transformMatrixStackSize[1] = 0;
@@ -1347,8 +1347,6 @@ static void R_LoadWorldRtLightsFromMap( model_t *model ) {
 			if( cubemap[0] != '\0' ) {
 				l->cubemapFilter = R_FindImage( cubemap, NULL, IT_SRGB | IT_CLAMP | IT_CUBEMAP, 1, IMAGE_TAG_WORLD );
 			}
-
-			R_GetRtLightVisInfo( bmodel, l );
 		}
 	}
 
@@ -1358,6 +1356,8 @@ static void R_LoadWorldRtLightsFromMap( model_t *model ) {
 		memcpy( bmodel->rtLights, lights, numLights * sizeof( rtlight_t ) );
 	}
 
+	R_GetWorldRtLightsVisInfo( model );
+
 	R_Free( lights );
 }
 
@@ -1484,8 +1484,6 @@ static void R_LoadWorldRtLights( model_t *model ) {
 			l->cubemapFilter = R_FindImage( cubemap, NULL, IT_SRGB | IT_CLAMP | IT_CUBEMAP, 1, IMAGE_TAG_WORLD );
 		}
 
-		R_GetRtLightVisInfo( bmodel, l );
-
 		if( *s == '\r' )
 			s++;
 		if( *s == '\n' )
@@ -1499,6 +1497,8 @@ static void R_LoadWorldRtLights( model_t *model ) {
 		memcpy( bmodel->rtLights, lights, numLights * sizeof( rtlight_t ) );
 	}
 
+	R_GetWorldRtLightsVisInfo( model );
+
 	R_Free( buf );
 	R_Free( lights );
 }
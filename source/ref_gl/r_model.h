@@ -80,7 +80,7 @@ typedef struct msurface_s {
 
 	unsigned int drawSurf;
 
-	int fragmentframe;                  // for multi-check avoidance
+	int traceframe;                     // for multi-check avoidance in R_TraceLine
 
 	vec4_t plane;
 
@@ -137,6 +137,7 @@ typedef struct {
 
 typedef struct mbrushmodel_s {
 	const bspFormatDesc_t *format;
+	unsigned checksum;                  // of the geometry and visibility lumps
 
 	dvis_t          *pvs;
 
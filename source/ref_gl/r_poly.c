@@ -141,21 +141,25 @@ void R_DrawStretchPoly( const poly_t *poly, float x_offset, float y_offset ) {
 
 //==================================================================================
 
-static int numFragmentVerts;
-static int maxFragmentVerts;
-static vec4_t *fragmentVerts;
-
-static int numClippedFragments;
-static int maxClippedFragments;
-static fragment_t *clippedFragments;
-
-static cplane_t fragmentPlanes[6];
-static vec3_t fragmentOrigin;
-static vec3_t fragmentNormal;
-static float fragmentRadius;
-static float fragmentDiameterSquared;
-
-static int r_fragmentframecount;
+// the clipping state lives on the stack of R_GetClippedFragments,
+// so fragments can be clipped from any thread
+typedef struct {
+	int numVerts;
+	int maxVerts;
+	vec4_t *verts;
+
+	int numFragments;
+	int maxFragments;
+	fragment_t *fragments;
+
+	cplane_t planes[6];
+	vec3_t origin;
+	vec3_t normal;
+	float radius;
+	float diameterSquared;
+
+	uint8_t *checkedSurfaces;       // bit per world surface, for multi-check avoidance
+} fragmentClip_t;
 
 #define MAX_FRAGMENT_VERTS  64
 
@@ -167,7 +171,7 @@ static int r_fragmentframecount;
 * a convex fragment (polygon, trifan) which the result of clipping
 * the input winding by six fragment planes.
 */
-static bool R_WindingClipFragment( const vec3_t *wVerts, int numVerts, const msurface_t *surf, vec3_t snorm ) {
+static bool R_WindingClipFragment( fragmentClip_t *clip, const vec3_t *wVerts, int numVerts, const msurface_t *surf, vec3_t snorm ) {
 	int i, j;
 	int stage, newc, numv;
 	cplane_t *plane;
@@ -183,7 +187,7 @@ static bool R_WindingClipFragment( const vec3_t *wVerts, int numVerts, const msu
 	numv = numVerts;
 	verts = wVerts;
 
-	for( stage = 0, plane = fragmentPlanes; stage < 6; stage++, plane++ ) {
+	for( stage = 0, plane = clip->planes; stage < 6; stage++, plane++ ) {
 		for( i = 0, v = verts[0], front = false; i < numv; i++, v += 3 ) {
 			d = PlaneDiff( v, plane );
 
@@ -253,22 +257,22 @@ static bool R_WindingClipFragment( const vec3_t *wVerts, int numVerts, const msu
 	}
 
 	// fully clipped
-	if( numFragmentVerts + numv > maxFragmentVerts ) {
+	if( clip->numVerts + numv > clip->maxVerts ) {
 		return false;
 	}
 
-	fr = &clippedFragments[numClippedFragments++];
+	fr = &clip->fragments[clip->numFragments++];
 	fr->numverts = numv;
-	fr->firstvert = numFragmentVerts;
+	fr->firstvert = clip->numVerts;
 	fr->fognum = surf->fog ? surf->fog - rsh.worldBrushModel->fogs + 1 : -1;
 	VectorCopy( snorm, fr->normal );
-	for( i = 0, v = verts[0], nextv = fragmentVerts[numFragmentVerts]; i < numv; i++, v += 3, nextv += 4 ) {
+	for( i = 0, v = verts[0], nextv = clip->verts[clip->numVerts]; i < numv; i++, v += 3, nextv += 4 ) {
 		VectorCopy( v, nextv );
 		nextv[3] = 1;
 	}
 
-	numFragmentVerts += numv;
-	if( numFragmentVerts == maxFragmentVerts && numClippedFragments == maxClippedFragments ) {
+	clip->numVerts += numv;
+	if( clip->numVerts == clip->maxVerts && clip->numFragments == clip->maxFragments ) {
 		return true;
 	}
 
@@ -284,7 +288,7 @@ static bool R_WindingClipFragment( const vec3_t *wVerts, int numVerts, const msu
 			v2 = ( i == 3 ) ? verts[0] : v + 3;
 			VectorSubtract( v, v2, t );
 
-			d = fragmentDiameterSquared - DotProduct( t, t );
+			d = clip->diameterSquared - DotProduct( t, t );
 			if( d > 0.01 || d < -0.01 ) {
 				return false;
 			}
@@ -303,7 +307,7 @@ static bool R_WindingClipFragment( const vec3_t *wVerts, int numVerts, const msu
 * q2 polys) or tristrips for ultra-fast clipping, providing there's
 * enough stack space (depending on MAX_FRAGMENT_VERTS value).
 */
-static bool R_PlanarSurfClipFragment( const msurface_t *surf, vec3_t normal ) {
+static bool R_PlanarSurfClipFragment( fragmentClip_t *clip, const msurface_t *surf, vec3_t normal ) {
 	int i;
 	const mesh_t *mesh;
 	const elem_t *elem;
@@ -346,7 +350,7 @@ static bool R_PlanarSurfClipFragment( const msurface_t *surf, vec3_t normal ) {
 			}
 		}
 
-		if( R_WindingClipFragment( poly, 3, surf, snorm ) ) {
+		if( R_WindingClipFragment( clip, poly, 3, surf, snorm ) ) {
 			return true;
 		}
 	}
@@ -357,7 +361,7 @@ static bool R_PlanarSurfClipFragment( const msurface_t *surf, vec3_t normal ) {
 /*
 * R_PatchSurfClipFragment
 */
-static bool R_PatchSurfClipFragment( const msurface_t *surf, vec3_t normal ) {
+static bool R_PatchSurfClipFragment( fragmentClip_t *clip, const msurface_t *surf, vec3_t normal ) {
 	int i, j;
 	const mesh_t *mesh;
 	const elem_t *elem;
@@ -397,7 +401,7 @@ tri2:
 			continue; // greater than 60 degrees
 
 		}
-		if( R_WindingClipFragment( poly, 3, surf, snorm ) ) {
+		if( R_WindingClipFragment( clip, poly, 3, surf, snorm ) ) {
 			return true;
 		}
 
@@ -424,8 +428,8 @@ bool R_SurfPotentiallyFragmented( const msurface_t *surf ) {
 /*
 * R_RecursiveFragmentNode
 */
-static void R_RecursiveFragmentNode( void ) {
-	unsigned i;
+static void R_RecursiveFragmentNode( fragmentClip_t *clip ) {
+	unsigned i, surfnum;
 	int stackdepth = 0;
 	float dist;
 	bool inside;
@@ -438,24 +442,25 @@ static void R_RecursiveFragmentNode( void ) {
 			leaf = ( mleaf_t * )node;
 
 			for( i = 0; i < leaf->numFragmentSurfaces; i++ ) {
-				if( numFragmentVerts == maxFragmentVerts || numClippedFragments == maxClippedFragments ) {
+				if( clip->numVerts == clip->maxVerts || clip->numFragments == clip->maxFragments ) {
 					return; // already reached the limit
 
 				}
-				surf = rsh.worldBrushModel->surfaces + leaf->fragmentSurfaces[i];
-				if( surf->fragmentframe == r_fragmentframecount ) {
+				surfnum = leaf->fragmentSurfaces[i];
+				if( clip->checkedSurfaces[surfnum >> 3] & ( 1 << ( surfnum & 7 ) ) ) {
 					continue;
 				}
-				surf->fragmentframe = r_fragmentframecount;
+				clip->checkedSurfaces[surfnum >> 3] |= 1 << ( surfnum & 7 );
 
-				if( !BoundsOverlapSphere( surf->mins, surf->maxs, fragmentOrigin, fragmentRadius ) ) {
+				surf = rsh.worldBrushModel->surfaces + surfnum;
+				if( !BoundsOverlapSphere( surf->mins, surf->maxs, clip->origin, clip->radius ) ) {
 					continue;
 				}
 
 				if( surf->facetype == FACETYPE_PATCH ) {
-					inside = R_PatchSurfClipFragment( surf, fragmentNormal );
+					inside = R_PatchSurfClipFragment( clip, surf, clip->normal );
 				} else {
-					inside = R_PlanarSurfClipFragment( surf, fragmentNormal );
+					inside = R_PlanarSurfClipFragment( clip, surf, clip->normal );
 				}
 
 				// if there some fragments that are inside a surface, that doesn't mean that
@@ -465,7 +470,7 @@ static void R_RecursiveFragmentNode( void ) {
 				(void)inside; // hush compiler warning
 			}
 
-			if( numFragmentVerts == maxFragmentVerts || numClippedFragments == maxClippedFragments ) {
+			if( clip->numVerts == clip->maxVerts || clip->numFragments == clip->maxFragments ) {
 				return; // already reached the limit
 
 			}
@@ -476,13 +481,13 @@ static void R_RecursiveFragmentNode( void ) {
 			continue;
 		}
 
-		dist = PlaneDiff( fragmentOrigin, node->plane );
-		if( dist > fragmentRadius ) {
+		dist = PlaneDiff( clip->origin, node->plane );
+		if( dist > clip->radius ) {
 			node = node->children[0];
 			continue;
 		}
 
-		if( ( dist >= -fragmentRadius ) && ( stackdepth < sizeof( localstack ) / sizeof( mnode_t * ) ) ) {
+		if( ( dist >= -clip->radius ) && ( stackdepth < sizeof( localstack ) / sizeof( mnode_t * ) ) ) {
 			localstack[stackdepth++] = node->children[0];
 		}
 		node = node->children[1];
@@ -491,11 +496,14 @@ static void R_RecursiveFragmentNode( void ) {
 
 /*
 * R_GetClippedFragments
+*
+* Only reads the world model, so it can be called from any thread.
 */
 int R_GetClippedFragments( const vec3_t origin, float radius, vec3_t axis[3],
 						   int maxfverts, vec4_t *fverts, int maxfragments, fragment_t *fragments ) {
 	int i;
 	float d;
+	fragmentClip_t clip;
 
 	assert( maxfverts > 0 );
 	assert( fverts );
@@ -503,37 +511,43 @@ int R_GetClippedFragments( const vec3_t origin, float radius, vec3_t axis[3],
 	assert( maxfragments > 0 );
 	assert( fragments );
 
-	r_fragmentframecount++;
+	if( !rsh.worldBrushModel || !rsh.worldBrushModel->numsurfaces ) {
+		return 0;
+	}
 
 	// initialize fragments
-	numFragmentVerts = 0;
-	maxFragmentVerts = maxfverts;
-	fragmentVerts = fverts;
+	clip.numVerts = 0;
+	clip.maxVerts = maxfverts;
+	clip.verts = fverts;
 
-	numClippedFragments = 0;
-	maxClippedFragments = maxfragments;
-	clippedFragments = fragments;
+	clip.numFragments = 0;
+	clip.maxFragments = maxfragments;
+	clip.fragments = fragments;
 
-	VectorCopy( origin, fragmentOrigin );
-	VectorCopy( axis[0], fragmentNormal );
-	fragmentRadius = radius;
-	fragmentDiameterSquared = radius * radius * 4;
+	VectorCopy( origin, clip.origin );
+	VectorCopy( axis[0], clip.normal );
+	clip.radius = radius;
+	clip.diameterSquared = radius * radius * 4;
 
 	// calculate clipping planes
 	for( i = 0; i < 3; i++ ) {
 		float radius0 = ( i ? radius : 40 );
 		d = DotProduct( origin, axis[i] );
 
-		VectorCopy( axis[i], fragmentPlanes[i * 2].normal );
-		fragmentPlanes[i * 2].dist = d - radius0;
-		fragmentPlanes[i * 2].type = PlaneTypeForNormal( fragmentPlanes[i * 2].normal );
+		VectorCopy( axis[i], clip.planes[i * 2].normal );
+		clip.planes[i * 2].dist = d - radius0;
+		clip.planes[i * 2].type = PlaneTypeForNormal( clip.planes[i * 2].normal );
 
-		VectorNegate( axis[i], fragmentPlanes[i * 2 + 1].normal );
-		fragmentPlanes[i * 2 + 1].dist = -d - radius0;
-		fragmentPlanes[i * 2 + 1].type = PlaneTypeForNormal( fragmentPlanes[i * 2 + 1].normal );
+		VectorNegate( axis[i], clip.planes[i * 2 + 1].normal );
+		clip.planes[i * 2 + 1].dist = -d - radius0;
+		clip.planes[i * 2 + 1].type = PlaneTypeForNormal( clip.planes[i * 2 + 1].normal );
 	}
 
-	R_RecursiveFragmentNode();
+	clip.checkedSurfaces = R_Malloc( ( rsh.worldBrushModel->numsurfaces + 7 ) / 8 );
+
+	R_RecursiveFragmentNode( &clip );
+
+	R_Free( clip.checkedSurfaces );
 
-	return numClippedFragments;
+	return clip.numFragments;
 }
@@ -78,6 +78,7 @@ QF_DLL_EXPORT ref_export_t *GetRefAPI( ref_import_t *import ) {
 	globals.Finish = RF_Finish;
 	globals.BlurScreen = RF_BlurScreen;
 
+	globals.GetFogNumForSphere = RF_GetFogNumForSphere;
 	globals.GetShaderForOrigin = RF_GetShaderForOrigin;
 	globals.GetShaderCinematic = RF_GetShaderCinematic;
 
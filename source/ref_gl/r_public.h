@@ -22,7 +22,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 #include "../cgame/ref.h"
 
-#define REF_API_VERSION 24
+#define REF_API_VERSION 25
 
 //
 // these are the functions exported by the refresh module
@@ -113,6 +113,10 @@ typedef struct {
 	void ( *Mutex_Destroy )( struct qmutex_s **mutex );
 	void ( *Mutex_Lock )( struct qmutex_s *mutex );
 	void ( *Mutex_Unlock )( struct qmutex_s *mutex );
+	struct qcondvar_s *( *CondVar_Create )( void );
+	void ( *CondVar_Destroy )( struct qcondvar_s **cond );
+	bool ( *CondVar_Wait )( struct qcondvar_s *cond, struct qmutex_s *mutex, unsigned int timeout_msec );
+	void ( *CondVar_Wake )( struct qcondvar_s *cond );
 
 	struct qbufPipe_s *( *BufPipe_Create )( size_t bufSize, int flags );
 	void ( *BufPipe_Destroy )( struct qbufPipe_s **pqueue );
@@ -121,6 +125,13 @@ typedef struct {
 	int ( *BufPipe_ReadCmds )( struct qbufPipe_s *queue, unsigned( **cmdHandlers )( const void * ) );
 	void ( *BufPipe_Wait )( struct qbufPipe_s *queue, int ( *read )( struct qbufPipe_s *, unsigned( ** )( const void * ), bool ),
 							unsigned( **cmdHandlers )( const void * ), unsigned timeout_msec );
+
+	// profiling
+	void ( *Prof_SetThreadName )( const char *name );
+	void ( *Prof_ReleaseThread )( void );
+	void ( *Prof_Begin )( const char *name );
+	void ( *Prof_End )( const char *name );
+	void ( *Prof_Mark )( const char *name );
 } ref_import_t;
 
 typedef struct {
@@ -207,6 +218,7 @@ typedef struct {
 	int ( *GetClippedFragments )( const vec3_t origin, float radius, vec3_t axis[3], int maxfverts, vec4_t *fverts,
 								  int maxfragments, fragment_t *fragments );
 
+	int ( *GetFogNumForSphere )( const vec3_t centre, float radius );
 	struct shader_s * ( *GetShaderForOrigin )( const vec3_t origin );
 	struct cinematics_s * ( *GetShaderCinematic )( struct shader_s *shader );
 
@@ -53,6 +53,8 @@ static int loadmodel_maxpatchgroups;
 static mpatchgroup_t *loadmodel_patchgroups;
 static int *loadmodel_patchgrouprefs;
 
+static unsigned loadmodel_checksum;
+
 // current model format descriptor
 static const bspFormatDesc_t *mod_bspFormat;
 
@@ -1578,6 +1580,377 @@ static void Mod_ApplySuperStylesToFace( const rdface_t *in, msurface_t *out ) {
 	out->superLightStyle = R_AddSuperLightStyle( loadmodel, lightmaps, lightmapStyles, vertexStyles, lmRects );
 }
 
+/*
+===============================================================================
+
+RENDER DATA CACHE
+
+===============================================================================
+*/
+
+// The tessellated and tangent-space surface meshes are stored in a per-map
+// binary file in the cache directory, keyed by the BSP checksum and the
+// settings that affect mesh generation. The lightmap coordinates are stored
+// unpacked, as the atlas layout depends on the GL limits.
+
+#define BSPCACHE_IDENT          ( ( 'C' << 24 ) + ( 'R' << 16 ) + ( 'S' << 8 ) + 'B' )
+#define BSPCACHE_VERSION        1
+#define BSPCACHE_EXTENSION      ".rdc"
+
+typedef struct {
+	int ident;
+	int version;
+	unsigned checksum;
+	int numsurfaces;
+	int subdivisions;
+	int lightmapArrays;
+	int vertexLight;
+	int fullbright;
+	int numlightmaps;
+	unsigned dataSize;
+} bspCacheHeader_t;
+
+// array offsets are relative to the start of the surface vertex data,
+// which always begins with the positions, so 0 means "no array"
+typedef struct {
+	unsigned dataOffset;
+	unsigned dataSize;
+	unsigned numVerts, numElems;
+	unsigned numInstances;
+	unsigned normals, sVectors, st;
+	unsigned lmst[MAX_LIGHTMAPS];
+	unsigned lmlayers[( MAX_LIGHTMAPS + 3 ) / 4];
+	unsigned colors[MAX_LIGHTMAPS];
+	unsigned elems, instances;
+	vec4_t plane;
+} bspCacheSurface_t;
+
+/*
+* Mod_BSPChecksum
+*
+* Hashes the lumps the surface meshes and world visibility are derived from.
+*/
+static unsigned Mod_BSPChecksum( const dheader_t *header ) {
+	int i;
+	size_t j, size;
+	unsigned hash = 2166136261u;
+	const uint8_t *data;
+	static const int lumps[] = {
+		LUMP_SHADERREFS, LUMP_PLANES, LUMP_NODES, LUMP_LEAFS, LUMP_LEAFFACES, LUMP_MODELS,
+		LUMP_VERTEXES, LUMP_ELEMENTS, LUMP_FACES, LUMP_VISIBILITY
+	};
+
+	for( i = 0; i < (int)( sizeof( lumps ) / sizeof( lumps[0] ) ); i++ ) {
+		data = ( const uint8_t * )header + LittleLong( header->lumps[lumps[i]].fileofs );
+		size = LittleLong( header->lumps[lumps[i]].filelen );
+
+		hash = ( hash ^ (unsigned)size ) * 16777619u;
+
+		// FNV-1a over 32-bit words, then the tail bytes
+		for( j = 0; j + 4 <= size; j += 4, data += 4 ) {
+			unsigned word;
+			memcpy( &word, data, 4 );
+			hash = ( hash ^ word ) * 16777619u;
+		}
+		for( ; j < size; j++, data++ ) {
+			hash = ( hash ^ *data ) * 16777619u;
+		}
+	}
+
+	return hash;
+}
+
+/*
+* Mod_BSPCacheFileName
+*/
+static void Mod_BSPCacheFileName( char *dest, size_t size ) {
+	Q_strncpyz( dest, loadmodel->name, size );
+	COM_ReplaceExtension( dest, BSPCACHE_EXTENSION, size );
+}
+
+/*
+* Mod_SetupBSPCacheHeader
+*/
+static void Mod_SetupBSPCacheHeader( bspCacheHeader_t *header ) {
+	memset( header, 0, sizeof( *header ) );
+	header->ident = BSPCACHE_IDENT;
+	header->version = BSPCACHE_VERSION;
+	header->checksum = loadmodel_checksum;
+	header->numsurfaces = loadbmodel->numsurfaces;
+	header->subdivisions = (int)( Q_bound( SUBDIVISIONS_MIN, r_subdivisions->value, SUBDIVISIONS_MAX ) * 256.0f );
+	header->lightmapArrays = mapConfig.lightmapArrays ? 1 : 0;
+	header->vertexLight = r_lighting_vertexlight->integer ? 1 : 0;
+	header->fullbright = r_fullbright->integer ? 1 : 0;
+	header->numlightmaps = loadmodel_numlightmaps;
+}
+
+/*
+* Mod_BSPCacheArrayValid
+*
+* Checks that an array of the surface record lies within the surface data.
+*/
+static bool Mod_BSPCacheArrayValid( const bspCacheSurface_t *rec, unsigned offset, unsigned count,
+									size_t elemSize, unsigned align ) {
+	if( !offset ) {
+		return true;
+	}
+	if( ( offset & ( align - 1 ) ) || offset >= rec->dataSize ) {
+		return false;
+	}
+	return (size_t)count * elemSize <= rec->dataSize - offset;
+}
+
+/*
+* Mod_BSPCacheSurfaceValid
+*/
+static bool Mod_BSPCacheSurfaceValid( const bspCacheSurface_t *rec, unsigned dataSize ) {
+	int j;
+	unsigned numVerts = rec->numVerts;
+
+	if( rec->dataOffset > dataSize || rec->dataSize > dataSize - rec->dataOffset || ( rec->dataOffset & 15 ) ) {
+		return false;
+	}
+	if( !numVerts ) {
+		return true;
+	}
+	if( numVerts > USHRT_MAX || rec->numElems > USHRT_MAX || !rec->elems ) {
+		return false;
+	}
+
+	// the positions are always at the start
+	if( (size_t)numVerts * sizeof( vec4_t ) > rec->dataSize ) {
+		return false;
+	}
+	if( !Mod_BSPCacheArrayValid( rec, rec->normals, numVerts, sizeof( vec4_t ), sizeof( float ) )
+		|| !Mod_BSPCacheArrayValid( rec, rec->sVectors, numVerts, sizeof( vec4_t ), sizeof( float ) )
+		|| !Mod_BSPCacheArrayValid( rec, rec->st, numVerts, sizeof( vec2_t ), sizeof( float ) )
+		|| !Mod_BSPCacheArrayValid( rec, rec->elems, rec->numElems, sizeof( elem_t ), sizeof( elem_t ) ) ) {
+		return false;
+	}
+	for( j = 0; j < MAX_LIGHTMAPS; j++ ) {
+		if( !Mod_BSPCacheArrayValid( rec, rec->lmst[j], numVerts, sizeof( vec2_t ), sizeof( float ) )
+			|| !Mod_BSPCacheArrayValid( rec, rec->colors[j], numVerts, sizeof( byte_vec4_t ), 1 ) ) {
+			return false;
+		}
+	}
+	for( j = 0; j < ( MAX_LIGHTMAPS + 3 ) / 4; j++ ) {
+		if( !Mod_BSPCacheArrayValid( rec, rec->lmlayers[j], numVerts, sizeof( byte_vec4_t ), 1 ) ) {
+			return false;
+		}
+	}
+
+	// instances are only ever stored along with their array
+	if( !rec->instances ) {
+		return rec->numInstances == 0;
+	}
+	return Mod_BSPCacheArrayValid( rec, rec->instances, rec->numInstances, sizeof( instancePoint_t ), 16 );
+}
+
+/*
+* Mod_LoadBSPCache
+*
+* Reads all surface meshes into a single block in one pass. Returns false
+* if the cache is missing, stale or damaged, in which case the surfaces
+* are left untouched.
+*/
+static bool Mod_LoadBSPCache( void ) {
+	int i, j, file, length;
+	unsigned numsurfaces;
+	char name[MAX_QPATH];
+	bspCacheHeader_t header, expected;
+	bspCacheSurface_t *records = NULL;
+	uint8_t *data = NULL;
+	msurface_t *surf;
+
+	if( !r_bspcache->integer || !loadbmodel->numsurfaces ) {
+		return false;
+	}
+
+	Mod_BSPCacheFileName( name, sizeof( name ) );
+	length = ri.FS_FOpenFile( name, &file, FS_READ | FS_CACHE );
+	if( length < 0 ) {
+		return false;
+	}
+
+	numsurfaces = loadbmodel->numsurfaces;
+	Mod_SetupBSPCacheHeader( &expected );
+
+	if( ri.FS_Read( &header, sizeof( header ), file ) != sizeof( header ) ) {
+		goto fail;
+	}
+	expected.dataSize = header.dataSize;
+	if( memcmp( &header, &expected, sizeof( header ) ) ) {
+		ri.Com_DPrintf( "Ignoring stale render data cache %s\n", name );
+		goto fail;
+	}
+	if( (size_t)length != sizeof( header ) + numsurfaces * sizeof( *records ) + header.dataSize ) {
+		goto fail;
+	}
+
+	records = R_Malloc( numsurfaces * sizeof( *records ) );
+	if( ri.FS_Read( records, numsurfaces * sizeof( *records ), file ) != (int)( numsurfaces * sizeof( *records ) ) ) {
+		goto fail;
+	}
+
+	if( header.dataSize ) {
+		data = Mod_Malloc( loadmodel, header.dataSize );
+		if( ri.FS_Read( data, header.dataSize, file ) != (int)header.dataSize ) {
+			goto fail;
+		}
+	}
+
+	// validate everything before touching the surfaces
+	for( i = 0; i < (int)numsurfaces; i++ ) {
+		if( !Mod_BSPCacheSurfaceValid( records + i, header.dataSize ) ) {
+			ri.Com_DPrintf( "Ignoring damaged render data cache %s\n", name );
+			goto fail;
+		}
+	}
+
+	for( i = 0, surf = loadbmodel->surfaces; i < (int)numsurfaces; i++, surf++ ) {
+		const bspCacheSurface_t *rec = records + i;
+		uint8_t *buffer = data + rec->dataOffset;
+		mesh_t *mesh = &surf->mesh;
+
+		memset( mesh, 0, sizeof( *mesh ) );
+		if( !rec->numVerts ) {
+			continue;
+		}
+
+#define CACHED_ARRAY( type, ofs ) ( ( ofs ) ? ( type )( buffer + ( ofs ) ) : NULL )
+		mesh->numVerts = rec->numVerts;
+		mesh->numElems = rec->numElems;
+		mesh->xyzArray = ( vec4_t * )buffer;
+		mesh->normalsArray = CACHED_ARRAY( vec4_t *, rec->normals );
+		mesh->sVectorsArray = CACHED_ARRAY( vec4_t *, rec->sVectors );
+		mesh->stArray = CACHED_ARRAY( vec2_t *, rec->st );
+		for( j = 0; j < MAX_LIGHTMAPS; j++ ) {
+			mesh->lmstArray[j] = CACHED_ARRAY( vec2_t *, rec->lmst[j] );
+			mesh->colorsArray[j] = CACHED_ARRAY( byte_vec4_t *, rec->colors[j] );
+		}
+		for( j = 0; j < ( MAX_LIGHTMAPS + 3 ) / 4; j++ ) {
+			mesh->lmlayersArray[j] = CACHED_ARRAY( byte_vec4_t *, rec->lmlayers[j] );
+		}
+		mesh->elems = CACHED_ARRAY( elem_t *, rec->elems );
+		surf->numInstances = rec->numInstances;
+		surf->instances = CACHED_ARRAY( instancePoint_t *, rec->instances );
+#undef CACHED_ARRAY
+
+		if( surf->facetype == FACETYPE_PLANAR ) {
+			Vector4Copy( rec->plane, surf->plane );
+		}
+	}
+
+	R_Free( records );
+	ri.FS_FCloseFile( file );
+	return true;
+
+fail:
+	if( records ) {
+		R_Free( records );
+	}
+	if( data ) {
+		Mod_MemFree( data );
+	}
+	ri.FS_FCloseFile( file );
+	return false;
+}
+
+/*
+* Mod_WriteBSPCache
+*
+* Must be called before the lightmap coordinates are remapped to the atlas.
+*/
+static void Mod_WriteBSPCache( void ) {
+	int i, j, file;
+	unsigned numsurfaces, dataSize;
+	char name[MAX_QPATH];
+	bspCacheHeader_t header;
+	bspCacheSurface_t *records, *rec;
+	const msurface_t *surf;
+	static const uint8_t zeros[16];
+
+	if( !r_bspcache->integer || !loadbmodel->numsurfaces ) {
+		return;
+	}
+
+	numsurfaces = loadbmodel->numsurfaces;
+	records = R_Malloc( numsurfaces * sizeof( *records ) );
+
+	// each surface mesh lives in a single allocation which starts with the positions
+	dataSize = 0;
+	for( i = 0, surf = loadbmodel->surfaces, rec = records; i < (int)numsurfaces; i++, surf++, rec++ ) {
+		const mesh_t *mesh = &surf->mesh;
+		const uint8_t *base = ( const uint8_t * )mesh->xyzArray;
+		size_t end;
+
+		if( !mesh->numVerts || !base ) {
+			continue;
+		}
+
+#define CACHE_OFFSET( ptr ) ( ( ptr ) ? (unsigned)( ( const uint8_t * )( ptr ) - base ) : 0 )
+		rec->numVerts = mesh->numVerts;
+		rec->numElems = mesh->numElems;
+		rec->normals = CACHE_OFFSET( mesh->normalsArray );
+		rec->sVectors = CACHE_OFFSET( mesh->sVectorsArray );
+		rec->st = CACHE_OFFSET( mesh->stArray );
+		for( j = 0; j < MAX_LIGHTMAPS; j++ ) {
+			rec->lmst[j] = CACHE_OFFSET( mesh->lmstArray[j] );
+			rec->colors[j] = CACHE_OFFSET( mesh->colorsArray[j] );
+		}
+		for( j = 0; j < ( MAX_LIGHTMAPS + 3 ) / 4; j++ ) {
+			rec->lmlayers[j] = CACHE_OFFSET( mesh->lmlayersArray[j] );
+		}
+		rec->elems = CACHE_OFFSET( mesh->elems );
+		rec->instances = CACHE_OFFSET( surf->instances );
+#undef CACHE_OFFSET
+
+		rec->numInstances = surf->instances ? surf->numInstances : 0;
+		Vector4Copy( surf->plane, rec->plane );
+
+		end = rec->elems + mesh->numElems * sizeof( elem_t );
+		if( rec->instances ) {
+			end = max( end, rec->instances + rec->numInstances * sizeof( instancePoint_t ) );
+		}
+
+		rec->dataOffset = dataSize;
+		rec->dataSize = end;
+		dataSize += Q_ALIGN( end, 16 );
+	}
+
+	Mod_BSPCacheFileName( name, sizeof( name ) );
+	if( ri.FS_FOpenFile( name, &file, FS_WRITE | FS_CACHE ) == -1 ) {
+		Com_Printf( S_COLOR_YELLOW "Could not open %s for writing.\n", name );
+		R_Free( records );
+		return;
+	}
+
+	// the header is written invalid and fixed up once all data is in place,
+	// so that an interrupted write never produces a valid-looking cache
+	Mod_SetupBSPCacheHeader( &header );
+	header.dataSize = dataSize;
+	header.ident = 0;
+	ri.FS_Write( &header, sizeof( header ), file );
+	ri.FS_Write( records, numsurfaces * sizeof( *records ), file );
+
+	for( i = 0, surf = loadbmodel->surfaces, rec = records; i < (int)numsurfaces; i++, surf++, rec++ ) {
+		if( !rec->dataSize ) {
+			continue;
+		}
+		ri.FS_Write( surf->mesh.xyzArray, rec->dataSize, file );
+		ri.FS_Write( zeros, Q_ALIGN( rec->dataSize, 16 ) - rec->dataSize, file );
+	}
+
+	ri.FS_FCloseFile( file );
+	R_Free( records );
+
+	if( ri.FS_FOpenFile( name, &file, FS_UPDATE | FS_CACHE ) != -1 ) {
+		header.ident = BSPCACHE_IDENT;
+		ri.FS_Write( &header, sizeof( header ), file );
+		ri.FS_FCloseFile( file );
+	}
+}
+
 /*
 * Mod_Finish
 */
@@ -1590,6 +1963,7 @@ static void Mod_Finish( const lump_t *faces, const lump_t *light, vec3_t gridSiz
 
 	// remembe the BSP format just in case
 	loadbmodel->format = mod_bspFormat;
+	loadbmodel->checksum = loadmodel_checksum;
 
 	// set up lightgrid
 	if( gridSize[0] < 1 || gridSize[1] < 1 || gridSize[2] < 1 ) {
@@ -1651,13 +2025,21 @@ static void Mod_Finish( const lump_t *faces, const lump_t *light, vec3_t gridSiz
 
 	R_SortSuperLightStyles( loadmodel );
 
+	if( !Mod_LoadBSPCache() ) {
+		in = loadmodel_dsurfaces;
+		surf = loadbmodel->surfaces;
+		for( i = 0; i < loadbmodel->numsurfaces; i++, in++, surf++ ) {
+			Mod_CreateMeshForSurface( in, surf, loadmodel_patchgrouprefs[i] );
+		}
+
+		Mod_WriteBSPCache();
+	}
+
 	in = loadmodel_dsurfaces;
 	surf = loadbmodel->surfaces;
 	for( i = 0; i < loadbmodel->numsurfaces; i++, in++, surf++ ) {
 		shader_t *shader;
 
-		Mod_CreateMeshForSurface( in, surf, loadmodel_patchgrouprefs[i] );
-
 		Mod_ApplySuperStylesToFace( in, surf );
 
 		shader = surf->shader;
@@ -1725,6 +2107,9 @@ void Mod_LoadQ3BrushModel( model_t *mod, model_t *parent, void *buffer, bspForma
 	header = (dheader_t *)buffer;
 	mod_base = (uint8_t *)header;
 
+	// the faces lump is modified in place while loading, so checksum the pristine data
+	loadmodel_checksum = Mod_BSPChecksum( header );
+
 	// swap all the lumps
 	for( i = 0; i < sizeof( dheader_t ) / 4; i++ )
 		( (int *)header )[i] = LittleLong( ( (int *)header )[i] );
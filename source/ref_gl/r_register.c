@@ -44,6 +44,7 @@ cvar_t *r_dynamiclight;
 cvar_t *r_coronascale;
 cvar_t *r_detailtextures;
 cvar_t *r_subdivisions;
+cvar_t *r_bspcache;
 cvar_t *r_showtris;
 cvar_t *r_showtris2D;
 cvar_t *r_draworder;
@@ -128,6 +129,7 @@ cvar_t *r_gamma;
 cvar_t *r_texturemode;
 cvar_t *r_texturefilter;
 cvar_t *r_texturecompression;
+cvar_t *r_imagedecoders;
 cvar_t *r_picmip;
 cvar_t *r_skymip;
 cvar_t *r_nobind;
@@ -1105,6 +1107,7 @@ static void R_Register( const char *screenshotsPrefix ) {
 	r_dynamiclight = ri.Cvar_Get( "r_dynamiclight", "1", CVAR_ARCHIVE );
 	r_coronascale = ri.Cvar_Get( "r_coronascale", "0.4", 0 );
 	r_subdivisions = ri.Cvar_Get( "r_subdivisions", STR_TOSTR( SUBDIVISIONS_DEFAULT ), CVAR_ARCHIVE | CVAR_LATCH_VIDEO );
+	r_bspcache = ri.Cvar_Get( "r_bspcache", "1", CVAR_ARCHIVE );
 	r_draworder = ri.Cvar_Get( "r_draworder", "0", CVAR_CHEAT );
 
 	r_fastsky = ri.Cvar_Get( "r_fastsky", "0", CVAR_ARCHIVE );
@@ -1190,6 +1193,7 @@ static void R_Register( const char *screenshotsPrefix ) {
 	r_texturemode = ri.Cvar_Get( "r_texturemode", "GL_LINEAR_MIPMAP_LINEAR", CVAR_ARCHIVE );
 	r_texturefilter = ri.Cvar_Get( "r_texturefilter", "4", CVAR_ARCHIVE );
 	r_texturecompression = ri.Cvar_Get( "r_texturecompression", "0", CVAR_ARCHIVE | CVAR_LATCH_VIDEO );
+	r_imagedecoders = ri.Cvar_Get( "r_imagedecoders", "4", CVAR_ARCHIVE | CVAR_LATCH_VIDEO );
 	r_stencilbits = ri.Cvar_Get( "r_stencilbits", "0", CVAR_ARCHIVE | CVAR_LATCH_VIDEO );
 
 	r_screenshot_jpeg = ri.Cvar_Get( "r_screenshot_jpeg", "1", CVAR_ARCHIVE );
@@ -144,10 +144,10 @@ static int R_TraceAgainstLeaf( mleaf_t *leaf ) {
 	for( i = 0; i < leaf->numVisSurfaces; i++ ) {
 		surf = rsh.worldBrushModel->surfaces + leaf->visSurfaces[i];
 
-		if( surf->fragmentframe == r_traceframecount ) {
+		if( surf->traceframe == r_traceframecount ) {
 			continue;   // do not test the same surface more than once
 		}
-		surf->fragmentframe = r_traceframecount;
+		surf->traceframe = r_traceframecount;
 
 		if( surf->flags & trace_umask ) {
 			continue;
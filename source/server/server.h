@@ -124,6 +124,7 @@ typedef struct client_s {
 
 	bool reliable;                  // no need for acks, connection is reliable
 	bool mv;                        // send multiview data to the client
+	int protocol;                   // protocol version the client connected with
 	bool individual_socket;         // client has it's own socket that has to be checked separately
 
 	socket_t socket;
@@ -209,6 +210,16 @@ typedef struct {
 	client_t client;                // special client for writing the messages
 	char meta_data[SNAP_MAX_DEMO_META_DATA_SIZE];
 	size_t meta_data_realsize;
+	int64_t nextKeyframeTime;
+	snapDemoIndex_t index;
+
+	// messages are written to the file by a separate thread
+	qbufPipe_t *queue;
+	qthread_t *writer;
+	qmutex_t *queueLock;
+	volatile int queuedBytes;       // bytes waiting in the queue, see SV_Demo_WriteMessage
+	int offset;                     // uncompressed file position once the queue is written
+	int droppedFrames;
 } server_static_demo_t;
 
 typedef server_static_demo_t demorec_t;
@@ -320,6 +331,7 @@ extern cvar_t *sv_highchars;
 //wsw : jal
 extern cvar_t *sv_maxrate;
 extern cvar_t *sv_compresspackets;
+extern cvar_t *sv_anglebits;
 extern cvar_t *sv_public;         // should heartbeats be sent
 
 // wsw : debug netcode
@@ -445,7 +457,7 @@ void SV_BroadcastCommand( _Printf_format_string_ const char *format, ... );
 //
 void SV_ParseClientMessage( client_t *client, msg_t *msg );
 bool SV_ClientConnect( const socket_t *socket, const netadr_t *address, client_t *client, char *userinfo,
-					   int game_port, int challenge, bool fakeClient,
+					   int protocol, int game_port, int challenge, bool fakeClient,
 					   unsigned int ticket_id, int session_id );
 
 #ifndef _MSC_VER
@@ -485,6 +497,7 @@ void SV_ShutdownGameProgs( void );
 // sv_demos.c
 //
 void SV_Demo_WriteSnap( void );
+void SV_Demo_AddServerCommand( const char *command );
 void SV_Demo_Start_f( void );
 void SV_Demo_Stop_f( void );
 void SV_Demo_Cancel_f( void );
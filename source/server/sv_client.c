@@ -63,7 +63,7 @@ void SV_ClientCloseDownload( client_t *client ) {
 * this is the only place a client_t is ever initialized
 */
 bool SV_ClientConnect( const socket_t *socket, const netadr_t *address, client_t *client, char *userinfo,
-					   int game_port, int challenge, bool fakeClient,
+					   int protocol, int game_port, int challenge, bool fakeClient,
 					   unsigned int ticket_id, int session_id ) {
 	int i;
 	edict_t *ent;
@@ -96,6 +96,7 @@ bool SV_ClientConnect( const socket_t *socket, const netadr_t *address, client_t
 	client->edict = ent;
 	client->challenge = challenge; // save challenge for checksumming
 	client->mv = false;
+	client->protocol = protocol;
 
 	client->mm_session = session_id;
 	client->mm_ticket = ticket_id;
@@ -142,9 +143,9 @@ bool SV_ClientConnect( const socket_t *socket, const netadr_t *address, client_t
 		Info_SetValueForKey( userinfo, "cl_mm_session", va( "%d", client->mm_session ) );
 	} else {
 		if( client->individual_socket ) {
-			Netchan_Setup( &client->netchan, &client->socket, address, game_port );
+			Netchan_Setup( &client->netchan, &client->socket, address, game_port, protocol );
 		} else {
-			Netchan_Setup( &client->netchan, socket, address, game_port );
+			Netchan_Setup( &client->netchan, socket, address, game_port, protocol );
 		}
 	}
 
@@ -276,7 +277,7 @@ static void SV_New_f( client_t *client ) {
 
 	// send the serverdata
 	MSG_WriteUint8( &tmpMessage, svc_serverdata );
-	MSG_WriteInt32( &tmpMessage, APP_PROTOCOL_VERSION );
+	MSG_WriteInt32( &tmpMessage, client->protocol );
 	MSG_WriteInt32( &tmpMessage, svs.spawncount );
 	MSG_WriteInt16( &tmpMessage, (unsigned short)svc.snapFrameTime );
 	MSG_WriteString( &tmpMessage, FS_BaseGameDirectory() );
@@ -22,18 +22,157 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 #define SV_DEMO_DIR va( "demos/server%s%s", sv_demodir->string[0] ? "/" : "", sv_demodir->string[0] ? sv_demodir->string : "" )
 
+// Compressing and writing the messages is left to a separate thread so that
+// neither zlib nor the disk stall the server frame. Snapshots are dropped
+// when the writer falls too far behind, see SV_Demo_WriteMessage.
+
+#define SV_DEMO_QUEUE_SIZE      0x100000
+#define SV_DEMO_MAX_QUEUED      ( SV_DEMO_QUEUE_SIZE - 2 * (int)( sizeof( demoWriteCmd_t ) + MAX_MSGLEN ) )
+
+enum {
+	DEMO_CMD_WRITE,
+	DEMO_CMD_SHUTDOWN,
+
+	NUM_DEMO_CMDS
+};
+
+typedef unsigned (*queueCmdHandler_t)( const void * );
+
+typedef struct {
+	int id;
+	int file;
+	int length;                     // followed by the message, padded to a multiple of sizeof( int )
+} demoWriteCmd_t;
+
+static ATTRIBUTE_ALIGNED( 16 ) uint8_t demo_cmdbuf[sizeof( demoWriteCmd_t ) + MAX_MSGLEN];
+
+/*
+* SV_Demo_WriteCmdSize
+*/
+static int SV_Demo_WriteCmdSize( int length ) {
+	return sizeof( demoWriteCmd_t ) + ( ( length + sizeof( int ) - 1 ) & ~( sizeof( int ) - 1 ) );
+}
+
+/*
+* SV_Demo_HandleWriteCmd
+*/
+static unsigned SV_Demo_HandleWriteCmd( const void *pcmd ) {
+	const demoWriteCmd_t *cmd = pcmd;
+	int size = SV_Demo_WriteCmdSize( cmd->length );
+	msg_t msg;
+
+	MSG_Init( &msg, (uint8_t *)( cmd + 1 ), cmd->length );
+	msg.cursize = cmd->length;
+	SNAP_RecordDemoMessage( cmd->file, &msg, 0 );
+
+	QAtomic_Add( &svs.demo.queuedBytes, -size, svs.demo.queueLock );
+	return size;
+}
+
+/*
+* SV_Demo_HandleShutdownCmd
+*/
+static unsigned SV_Demo_HandleShutdownCmd( const void *pcmd ) {
+	return 0;
+}
+
+/*
+* SV_Demo_WriterCmdsWaiter
+*/
+static int SV_Demo_WriterCmdsWaiter( qbufPipe_t *queue, queueCmdHandler_t *cmdHandlers, bool timeout ) {
+	return QBufPipe_ReadCmds( queue, cmdHandlers );
+}
+
+/*
+* SV_Demo_WriterThreadProc
+*/
+static void *SV_Demo_WriterThreadProc( void *param ) {
+	queueCmdHandler_t cmdHandlers[NUM_DEMO_CMDS] =
+	{
+		(queueCmdHandler_t)SV_Demo_HandleWriteCmd,
+		(queueCmdHandler_t)SV_Demo_HandleShutdownCmd,
+	};
+
+	QBufPipe_Wait( param, SV_Demo_WriterCmdsWaiter, cmdHandlers, Q_THREADS_WAIT_INFINITE );
+
+	return NULL;
+}
+
+/*
+* SV_Demo_StartWriter
+*
+* Must be called once the messages written directly to the file are out.
+*/
+static void SV_Demo_StartWriter( void ) {
+	svs.demo.offset = FS_Tell( svs.demo.file );
+	svs.demo.queuedBytes = 0;
+	svs.demo.droppedFrames = 0;
+	svs.demo.queueLock = QMutex_Create();
+	svs.demo.queue = QBufPipe_Create( SV_DEMO_QUEUE_SIZE, 1 );
+	svs.demo.writer = QThread_Create( SV_Demo_WriterThreadProc, svs.demo.queue );
+}
+
+/*
+* SV_Demo_StopWriter
+*
+* Blocks until everything queued is in the file.
+*/
+static void SV_Demo_StopWriter( void ) {
+	int cmd = DEMO_CMD_SHUTDOWN;
+
+	if( !svs.demo.queue ) {
+		return;
+	}
+
+	QBufPipe_WriteCmd( svs.demo.queue, &cmd, sizeof( cmd ) );
+	QThread_Join( svs.demo.writer );
+	svs.demo.writer = NULL;
+
+	QBufPipe_Destroy( &svs.demo.queue );
+	QMutex_Destroy( &svs.demo.queueLock );
+}
+
 /*
 * SV_Demo_WriteMessage
 *
-* Writes given message to the demofile
+* Queues the message built in demo_cmdbuf for the writer thread. Returns
+* false if the message was dropped because the writer is too far behind.
 */
-static void SV_Demo_WriteMessage( msg_t *msg ) {
+static bool SV_Demo_WriteMessage( msg_t *msg ) {
+	int size;
+	demoWriteCmd_t *cmd = (demoWriteCmd_t *)demo_cmdbuf;
+
 	assert( svs.demo.file );
 	if( !svs.demo.file ) {
-		return;
+		return false;
 	}
 
-	SNAP_RecordDemoMessage( svs.demo.file, msg, 0 );
+	assert( msg->data == demo_cmdbuf + sizeof( *cmd ) );
+	if( !msg->cursize ) {
+		return true;
+	}
+
+	// the writer thread only ever decreases the count so it's safe to check
+	// without the lock. Keeping the total below the size of the queue means
+	// writing to it never blocks.
+	size = SV_Demo_WriteCmdSize( msg->cursize );
+	if( svs.demo.queuedBytes + size > SV_DEMO_MAX_QUEUED ) {
+		if( !svs.demo.droppedFrames ) {
+			Com_Printf( "Server demo writer is falling behind, dropping snapshots\n" );
+		}
+		svs.demo.droppedFrames++;
+		return false;
+	}
+
+	cmd->id = DEMO_CMD_WRITE;
+	cmd->file = svs.demo.file;
+	cmd->length = msg->cursize;
+
+	QAtomic_Add( &svs.demo.queuedBytes, size, svs.demo.queueLock );
+	QBufPipe_WriteCmd( svs.demo.queue, cmd, size );
+
+	svs.demo.offset += 4 + msg->cursize;
+	return true;
 }
 
 /*
@@ -51,9 +190,10 @@ static void SV_Demo_WriteStartMessages( void ) {
 * SV_Demo_WriteSnap
 */
 void SV_Demo_WriteSnap( void ) {
-	int i;
+	int i, offset;
+	int64_t reliableAcknowledge;
+	bool keyframe;
 	msg_t msg;
-	uint8_t msg_buffer[MAX_MSGLEN];
 
 	if( !svs.demo.file ) {
 		return;
@@ -71,15 +211,31 @@ void SV_Demo_WriteSnap( void ) {
 		return;
 	}
 
-	MSG_Init( &msg, msg_buffer, sizeof( msg_buffer ) );
+	MSG_Init( &msg, demo_cmdbuf + sizeof( demoWriteCmd_t ), MAX_MSGLEN );
+
+	// write a non-delta frame every now and then so players can seek to it
+	keyframe = svs.gametime >= svs.demo.nextKeyframeTime;
+	if( keyframe ) {
+		svs.demo.client.nodelta = true;
+		svs.demo.nextKeyframeTime = svs.gametime + SNAP_DEMO_KEYFRAME_INTERVAL;
+	}
 
 	SV_BuildClientFrameSnap( &svs.demo.client );
 
 	SV_WriteFrameSnapToClient( &svs.demo.client, &msg );
 
+	reliableAcknowledge = svs.demo.client.reliableAcknowledge;
 	SV_AddReliableCommandsToMessage( &svs.demo.client, &msg );
 
-	SV_Demo_WriteMessage( &msg );
+	offset = svs.demo.offset;
+
+	if( !SV_Demo_WriteMessage( &msg ) ) {
+		// resend the commands with the next frame, which can't delta from this one
+		svs.demo.client.reliableAcknowledge = reliableAcknowledge;
+		svs.demo.nextKeyframeTime = svs.gametime;
+	} else if( keyframe ) {
+		SNAP_AddDemoKeyframe( &svs.demo.index, offset, svs.gametime, sv.configstrings[0], NULL, 0 );
+	}
 
 	svs.demo.duration = svs.gametime - svs.demo.basetime;
 	svs.demo.client.lastframe = sv.framenum; // FIXME: is this needed?
@@ -183,11 +339,11 @@ void SV_Demo_Start_f( void ) {
 	svs.demo.basetime = svs.gametime;
 	svs.demo.localtime = time( NULL );
 	SV_Demo_WriteStartMessages();
+	SV_Demo_StartWriter();
 
-	// write one nodelta frame
-	svs.demo.client.nodelta = true;
+	// the first frame is always a keyframe
+	svs.demo.nextKeyframeTime = 0;
 	SV_Demo_WriteSnap();
-	svs.demo.client.nodelta = false;
 }
 
 /*
@@ -201,12 +357,21 @@ static void SV_Demo_Stop( bool cancel, bool silent ) {
 		return;
 	}
 
+	SV_Demo_StopWriter();
+
 	if( cancel ) {
 		Com_Printf( "Canceled server demo recording: %s\n", svs.demo.filename );
 	} else {
+		int indexOffset;
+
 		SNAP_StopDemoRecording( svs.demo.file );
+		indexOffset = SNAP_WriteDemoIndex( svs.demo.file, &svs.demo.index );
+		SV_SetDemoMetaKeyValue( SNAP_DEMO_INDEX_META_KEY, va( "%i", indexOffset ) );
 
 		Com_Printf( "Stopped server demo recording: %s\n", svs.demo.filename );
+		if( svs.demo.droppedFrames ) {
+			Com_Printf( "%i snapshots were dropped while recording\n", svs.demo.droppedFrames );
+		}
 	}
 
 	FS_FCloseFile( svs.demo.file );
@@ -240,6 +405,7 @@ static void SV_Demo_Stop( bool cancel, bool silent ) {
 	svs.demo.basetime = svs.demo.duration = 0;
 
 	SNAP_FreeClientFrames( &svs.demo.client );
+	SNAP_FreeDemoIndex( &svs.demo.index );
 
 	Mem_ZoneFree( svs.demo.filename );
 	svs.demo.filename = NULL;
@@ -265,6 +431,28 @@ void SV_Demo_Cancel_f( void ) {
 	SV_Demo_Stop( true, atoi( Cmd_Argv( 1 ) ) != 0 );
 }
 
+/*
+* SV_Demo_AddServerCommand
+*
+* Commands aren't acknowledged while the writer drops snapshots, so stop
+* the recording before they overflow instead of dropping the demo client.
+*/
+void SV_Demo_AddServerCommand( const char *command ) {
+	client_t *client = &svs.demo.client;
+
+	if( !svs.demo.file ) {
+		return;
+	}
+
+	if( client->reliableSequence - client->reliableAcknowledge >= MAX_RELIABLE_COMMANDS ) {
+		Com_Printf( "Server demo writer fell too far behind the server commands\n" );
+		SV_Demo_Stop( false, false );
+		return;
+	}
+
+	SV_AddServerCommand( client, command );
+}
+
 /*
 * SV_Demo_Purge_f
 *
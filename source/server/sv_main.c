@@ -81,6 +81,7 @@ cvar_t *sv_reconnectlimit; // minimum seconds between connect messages
 
 cvar_t *sv_maxrate;
 cvar_t *sv_compresspackets;
+cvar_t *sv_anglebits;            // precision of entity angles for clients using bit-packed entities
 cvar_t *sv_masterservers;
 cvar_t *sv_masterservers_steam;
 cvar_t *sv_skilllevel;
@@ -162,7 +163,7 @@ static bool SV_ProcessPacket( netchan_t *netchan, msg_t *msg ) {
 	MSG_ReadInt32( msg ); // sequence_ack
 	MSG_ReadInt16( msg ); // game_port
 	if( msg->compressed ) {
-		zerror = Netchan_DecompressMessage( msg );
+		zerror = Netchan_DecompressMessage( msg, netchan->zdict );
 		if( zerror < 0 ) {
 			// compression error. Drop the packet
 			Com_DPrintf( "SV_ProcessPacket: Compression error %i. Dropping packet\n", zerror );
@@ -953,6 +954,7 @@ void SV_Init( void ) {
 	// wsw : jal : cap client's exceding server rules
 	sv_maxrate =            Cvar_Get( "sv_maxrate", "0", CVAR_DEVELOPER );
 	sv_compresspackets =        Cvar_Get( "sv_compresspackets", "1", CVAR_DEVELOPER );
+	sv_anglebits =          Cvar_Get( "sv_anglebits", "12", CVAR_ARCHIVE );
 	sv_skilllevel =         Cvar_Get( "sv_skilllevel", "2", CVAR_SERVERINFO | CVAR_ARCHIVE | CVAR_LATCH );
 
 	if( sv_skilllevel->integer > 2 ) {
@@ -472,7 +472,8 @@ static void SVC_InfoResponse( const socket_t *socket, const netadr_t *address )
 	//	return;
 
 	// different protocol version
-	if( atoi( Cmd_Argv( 1 ) ) != APP_PROTOCOL_VERSION ) {
+	i = atoi( Cmd_Argv( 1 ) );
+	if( i < APP_PROTOCOL_VERSION_MIN || i > APP_PROTOCOL_VERSION ) {
 		return;
 	}
 
@@ -619,8 +620,9 @@ static void SVC_DirectConnect( const socket_t *socket, const netadr_t *address )
 
 	Com_DPrintf( "SVC_DirectConnect (%s)\n", Cmd_Args() );
 
+	// clients using the previous protocol version are still accepted
 	version = atoi( Cmd_Argv( 1 ) );
-	if( version != APP_PROTOCOL_VERSION ) {
+	if( version < APP_PROTOCOL_VERSION_MIN || version > APP_PROTOCOL_VERSION ) {
 		if( version <= 6 ) { // before reject packet was added
 			Netchan_OutOfBandPrint( socket, address, "print\nServer is version %4.2f. Protocol %3i\n",
 									APP_VERSION, APP_PROTOCOL_VERSION );
@@ -782,7 +784,7 @@ static void SVC_DirectConnect( const socket_t *socket, const netadr_t *address )
 	}
 
 	// get the game a chance to reject this connection or modify the userinfo
-	if( !SV_ClientConnect( socket, address, newcl, userinfo, game_port, challenge, false,
+	if( !SV_ClientConnect( socket, address, newcl, userinfo, version, game_port, challenge, false,
 						   ticket_id, session_id ) ) {
 		char *rejtype, *rejflag, *rejtypeflag, *rejmsg;
 
@@ -868,7 +870,7 @@ int SVC_FakeConnect( char *fakeUserinfo, char *fakeSocketType, const char *fakeI
 
 	NET_InitAddress( &address, NA_NOTRANSMIT );
 	// get the game a chance to reject this connection or modify the userinfo
-	if( !SV_ClientConnect( NULL, &address, newcl, userinfo, -1, -1, true, 0, 0 ) ) {
+	if( !SV_ClientConnect( NULL, &address, newcl, userinfo, APP_PROTOCOL_VERSION, -1, -1, true, 0, 0 ) ) {
 		Com_DPrintf( "Game rejected a connection.\n" );
 		return -1;
 	}
@@ -166,7 +166,7 @@ void SV_SendServerCommand( client_t *cl, const char *format, ... ) {
 
 	// add to demo
 	if( svs.demo.file ) {
-		SV_AddServerCommand( &svs.demo.client, message );
+		SV_Demo_AddServerCommand( message );
 	}
 }
 
@@ -294,7 +294,7 @@ bool SV_Netchan_Transmit( netchan_t *netchan, msg_t *msg ) {
 	}
 
 	if( sv_compresspackets->integer ) {
-		zerror = Netchan_CompressMessage( msg );
+		zerror = Netchan_CompressMessage( msg, netchan->zdict );
 		if( zerror < 0 ) { // it's compression error, just send uncompressed
 			Com_DPrintf( "SV_Netchan_Transmit (ignoring compression): Compression error %i\n", zerror );
 		}
@@ -54,6 +54,197 @@ static void S_EnqueueCmd( sndCmdPipe_t *queue, const void *cmd, unsigned cmd_siz
 	trap_BufPipe_WriteCmd( queue, cmd, cmd_size );
 }
 
+// =====================================================================
+
+#define SND_BATCH_FRESH     4       // set in the mailbox until the mixer picks the batch up
+#define SND_BATCH_NONE      3       // the client is merging into a reclaimed batch
+
+/*
+* S_CreateSoundCmdBatches
+*/
+sndCmdBatchQueue_t *S_CreateSoundCmdBatches( void ) {
+	sndCmdBatchQueue_t *queue;
+
+	queue = S_Malloc( sizeof( *queue ) );
+	queue->write = 0;
+	queue->read = 1;
+	queue->mailbox = 2;
+	return queue;
+}
+
+/*
+* S_DestroySoundCmdBatches
+*/
+void S_DestroySoundCmdBatches( sndCmdBatchQueue_t **pqueue ) {
+	if( *pqueue ) {
+		S_Free( *pqueue );
+		*pqueue = NULL;
+	}
+}
+
+/*
+* S_ResetCmdBatch
+*/
+static void S_ResetCmdBatch( sndCmdBatch_t *batch ) {
+	unsigned i;
+
+	for( i = 0; i < batch->numSpats; i++ ) {
+		batch->spatIndex[batch->spats[i].entnum] = 0;
+	}
+	batch->numSpats = 0;
+	batch->cmdsSize = 0;
+	batch->numLoops = 0;
+	batch->hasListener = false;
+}
+
+/*
+* S_MergeCmdBatch
+*
+* Appends the newer batch to the older one, which hasn't been seen by the mixer.
+*/
+static void S_MergeCmdBatch( sndCmdBatch_t *older, const sndCmdBatch_t *newer ) {
+	unsigned i;
+	sndCmdSetEntitySpatialization_t *spat;
+
+	if( older->cmdsSize + newer->cmdsSize <= sizeof( older->cmds ) ) {
+		memcpy( (uint8_t *)older->cmds + older->cmdsSize, newer->cmds, newer->cmdsSize );
+		older->cmdsSize += newer->cmdsSize;
+	}
+
+	for( i = 0; i < newer->numSpats; i++ ) {
+		const sndCmdSetEntitySpatialization_t *nspat = &newer->spats[i];
+
+		if( older->spatIndex[nspat->entnum] ) {
+			spat = &older->spats[older->spatIndex[nspat->entnum] - 1];
+		} else {
+			spat = &older->spats[older->numSpats++];
+			older->spatIndex[nspat->entnum] = older->numSpats;
+		}
+		*spat = *nspat;
+	}
+
+	// loop sounds are re-added every frame
+	memcpy( older->loops, newer->loops, newer->numLoops * sizeof( newer->loops[0] ) );
+	older->numLoops = newer->numLoops;
+
+	if( newer->hasListener ) {
+		older->listener = newer->listener;
+		older->hasListener = true;
+	}
+}
+
+/*
+* S_PublishSoundCmdBatch
+*
+* Hands the batch filled since the last call over to the mixer thread.
+* Never blocks: if the mixer hasn't picked up the previous batch yet,
+* the new commands are merged into it.
+*/
+void S_PublishSoundCmdBatch( sndCmdBatchQueue_t *queue ) {
+	int cur, fresh;
+
+	while( true ) {
+		cur = queue->mailbox;
+
+		if( cur & SND_BATCH_FRESH ) {
+			// reclaim the pending batch, the mixer skips the mailbox meanwhile
+			if( !trap_Atomic_CAS( &queue->mailbox, cur, SND_BATCH_NONE, NULL ) ) {
+				continue;
+			}
+
+			fresh = cur & ~SND_BATCH_FRESH;
+			S_MergeCmdBatch( &queue->batches[fresh], &queue->batches[queue->write] );
+			S_ResetCmdBatch( &queue->batches[queue->write] );
+			trap_Atomic_CAS( &queue->mailbox, SND_BATCH_NONE, fresh | SND_BATCH_FRESH, NULL );
+			return;
+		}
+
+		if( trap_Atomic_CAS( &queue->mailbox, cur, queue->write | SND_BATCH_FRESH, NULL ) ) {
+			// the mixer is done with the batch it left in the mailbox
+			queue->write = cur;
+			S_ResetCmdBatch( &queue->batches[queue->write] );
+			return;
+		}
+	}
+}
+
+/*
+* S_DiscardSoundCmdBatches
+*
+* Drops sounds and loops the mixer hasn't seen yet so that they can't
+* outlive a stop or clear command issued through the pipe.
+*/
+void S_DiscardSoundCmdBatches( sndCmdBatchQueue_t *queue ) {
+	int cur, fresh;
+	sndCmdBatch_t *batch = &queue->batches[queue->write];
+
+	batch->cmdsSize = 0;
+	batch->numLoops = 0;
+
+	cur = queue->mailbox;
+	if( ( cur & SND_BATCH_FRESH ) && trap_Atomic_CAS( &queue->mailbox, cur, SND_BATCH_NONE, NULL ) ) {
+		fresh = cur & ~SND_BATCH_FRESH;
+		queue->batches[fresh].cmdsSize = 0;
+		queue->batches[fresh].numLoops = 0;
+		trap_Atomic_CAS( &queue->mailbox, SND_BATCH_NONE, cur, NULL );
+	}
+}
+
+/*
+* S_ReadSoundCmdBatch
+*
+* Called by the mixer thread, executes the latest published batch if there's one.
+*/
+void S_ReadSoundCmdBatch( sndCmdBatchQueue_t *queue, pipeCmdHandler_t *cmdHandlers ) {
+	unsigned i, size;
+	int cur;
+	const sndCmdBatch_t *batch;
+
+	cur = queue->mailbox;
+	if( !( cur & SND_BATCH_FRESH ) ) {
+		return;
+	}
+	if( !trap_Atomic_CAS( &queue->mailbox, cur, queue->read, NULL ) ) {
+		return;
+	}
+
+	queue->read = cur & ~SND_BATCH_FRESH;
+	batch = &queue->batches[queue->read];
+
+	for( i = 0; i < batch->numSpats; i++ ) {
+		cmdHandlers[SND_CMD_SET_ENTITY_SPATIALIZATION]( &batch->spats[i] );
+	}
+
+	for( i = 0; i < batch->cmdsSize; i += size ) {
+		const int *cmd = (const int *)( (const uint8_t *)batch->cmds + i );
+		size = cmdHandlers[*cmd]( cmd );
+	}
+
+	for( i = 0; i < batch->numLoops; i++ ) {
+		cmdHandlers[SND_CMD_ADD_LOOP_SOUND]( &batch->loops[i] );
+	}
+
+	if( batch->hasListener ) {
+		cmdHandlers[SND_CMD_SET_LISTENER]( &batch->listener );
+	}
+}
+
+/*
+* S_BatchCmd
+*
+* Sounds that don't fit into the batch are dropped.
+*/
+static void S_BatchCmd( sndCmdBatchQueue_t *queue, const void *cmd, unsigned cmd_size ) {
+	sndCmdBatch_t *batch = &queue->batches[queue->write];
+
+	if( batch->cmdsSize + cmd_size > sizeof( batch->cmds ) ) {
+		return;
+	}
+
+	memcpy( (uint8_t *)batch->cmds + batch->cmdsSize, cmd, cmd_size );
+	batch->cmdsSize += cmd_size;
+}
+
 /*
 * S_IssueInitCmd
 */
@@ -131,58 +322,71 @@ void S_IssueSetAttenuationCmd( sndCmdPipe_t *queue, int model,
 
 /*
 * S_IssueSetEntitySpatializationCmd
+*
+* Overwrites any earlier spatialization of the same entity in the batch.
 */
-void S_IssueSetEntitySpatializationCmd( sndCmdPipe_t *queue, const smdCmdSpatialization_t *spat ) {
+void S_IssueSetEntitySpatializationCmd( sndCmdBatchQueue_t *queue, const smdCmdSpatialization_t *spat ) {
 	unsigned i;
+	sndCmdSetEntitySpatialization_t *cmd;
+	sndCmdBatch_t *batch = &queue->batches[queue->write];
 
-	sndCmdSetEntitySpatialization_t cmd;
-	cmd.id = SND_CMD_SET_ENTITY_SPATIALIZATION;
-	cmd.entnum = spat->entnum;
-	for( i = 0; i < 3; i++ ) {
-		cmd.origin[i] = spat->origin[i];
-		cmd.velocity[i] = spat->velocity[i];
+	if( spat->entnum < 0 || spat->entnum >= MAX_EDICTS ) {
+		return;
 	}
 
-	S_EnqueueCmd( queue, &cmd, sizeof( cmd ) );
+	if( batch->spatIndex[spat->entnum] ) {
+		cmd = &batch->spats[batch->spatIndex[spat->entnum] - 1];
+	} else {
+		cmd = &batch->spats[batch->numSpats++];
+		batch->spatIndex[spat->entnum] = batch->numSpats;
+	}
+
+	cmd->id = SND_CMD_SET_ENTITY_SPATIALIZATION;
+	cmd->entnum = spat->entnum;
+	for( i = 0; i < 3; i++ ) {
+		cmd->origin[i] = spat->origin[i];
+		cmd->velocity[i] = spat->velocity[i];
+	}
 }
 
 /*
 * S_IssueSetListenerCmd
 */
-void S_IssueSetListenerCmd( sndCmdPipe_t *queue, const vec3_t origin,
+void S_IssueSetListenerCmd( sndCmdBatchQueue_t *queue, const vec3_t origin,
 							const vec3_t velocity, const mat3_t axis, bool avidump ) {
 	unsigned i;
+	sndCmdBatch_t *batch = &queue->batches[queue->write];
 
-	sndCmdSetListener_t cmd;
-	cmd.id = SND_CMD_SET_LISTENER;
-	cmd.avidump = (int)avidump;
+	sndCmdSetListener_t *cmd = &batch->listener;
+	cmd->id = SND_CMD_SET_LISTENER;
+	cmd->avidump = (int)avidump;
 	for( i = 0; i < 3; i++ ) {
-		cmd.origin[i] = origin[i];
-		cmd.velocity[i] = velocity[i];
+		cmd->origin[i] = origin[i];
+		cmd->velocity[i] = velocity[i];
 	}
 	for( i = 0; i < 9; i++ ) {
-		cmd.axis[i] = axis[i];
+		cmd->axis[i] = axis[i];
 	}
 
-	S_EnqueueCmd( queue, &cmd, sizeof( cmd ) );
+	batch->hasListener = true;
 }
 
 /*
 * S_IssueStartLocalSoundCmd
 */
-void S_IssueStartLocalSoundCmd( sndCmdPipe_t *queue, int sfx, int channel, float fvol ) {
+void S_IssueStartLocalSoundCmd( sndCmdBatchQueue_t *queue, int sfx, int channel, float fvol ) {
 	sndCmdStartLocalSound_t cmd;
 	cmd.id = SND_CMD_START_LOCAL_SOUND;
 	cmd.sfx = sfx;
 	cmd.channel = channel;
 	cmd.fvol = fvol;
-	S_EnqueueCmd( queue, &cmd, sizeof( cmd ) );
+	S_BatchCmd( queue, &cmd, sizeof( cmd ) );
 }
 
 /*
 * S_IssueStartFixedSoundCmd
 */
-void S_IssueStartFixedSoundCmd( sndCmdPipe_t *queue, int sfx, const vec3_t origin,
+void S_IssueStartFixedSoundCmd( sndCmdBatchQueue_t *queue, int sfx, const vec3_t origin,
 								int channel, float fvol, float attenuation ) {
 	unsigned i;
 
@@ -196,26 +400,26 @@ void S_IssueStartFixedSoundCmd( sndCmdPipe_t *queue, int sfx, const vec3_t origi
 	cmd.fvol = fvol;
 	cmd.attenuation = attenuation;
 
-	S_EnqueueCmd( queue, &cmd, sizeof( cmd ) );
+	S_BatchCmd( queue, &cmd, sizeof( cmd ) );
 }
 
 /*
 * S_IssueStartGlobalSoundCmd
 */
-void S_IssueStartGlobalSoundCmd( sndCmdPipe_t *queue, int sfx, int channel,
+void S_IssueStartGlobalSoundCmd( sndCmdBatchQueue_t *queue, int sfx, int channel,
 								 float fvol ) {
 	sndCmdStartGlobalSound_t cmd;
 	cmd.id = SND_CMD_START_GLOBAL_SOUND;
 	cmd.sfx = sfx;
 	cmd.channel = channel;
 	cmd.fvol = fvol;
-	S_EnqueueCmd( queue, &cmd, sizeof( cmd ) );
+	S_BatchCmd( queue, &cmd, sizeof( cmd ) );
 }
 
 /*
 * S_IssueStartRelativeSoundCmd
 */
-void S_IssueStartRelativeSoundCmd( sndCmdPipe_t *queue, int sfx, int entnum,
+void S_IssueStartRelativeSoundCmd( sndCmdBatchQueue_t *queue, int sfx, int entnum,
 								   int channel, float fvol, float attenuation ) {
 	sndCmdStartRelativeSound_t cmd;
 	cmd.id = SND_CMD_START_RELATIVE_SOUND;
@@ -224,7 +428,7 @@ void S_IssueStartRelativeSoundCmd( sndCmdPipe_t *queue, int sfx, int entnum,
 	cmd.channel = channel;
 	cmd.fvol = fvol;
 	cmd.attenuation = attenuation;
-	S_EnqueueCmd( queue, &cmd, sizeof( cmd ) );
+	S_BatchCmd( queue, &cmd, sizeof( cmd ) );
 }
 
 /*
@@ -264,15 +468,21 @@ void S_IssueLockBackgroundTrackCmd( sndCmdPipe_t *queue, bool lock ) {
 /*
 * S_IssueAddLoopSoundCmd
 */
-void S_IssueAddLoopSoundCmd( sndCmdPipe_t *queue, int sfx, int entnum,
+void S_IssueAddLoopSoundCmd( sndCmdBatchQueue_t *queue, int sfx, int entnum,
 							 float fvol, float attenuation ) {
-	sndAddLoopSoundCmd_t cmd;
-	cmd.id = SND_CMD_ADD_LOOP_SOUND;
-	cmd.sfx = sfx;
-	cmd.entnum = entnum;
-	cmd.fvol = fvol;
-	cmd.attenuation = attenuation;
-	S_EnqueueCmd( queue, &cmd, sizeof( cmd ) );
+	sndAddLoopSoundCmd_t *cmd;
+	sndCmdBatch_t *batch = &queue->batches[queue->write];
+
+	if( batch->numLoops == SND_BATCH_LOOPS_MAX ) {
+		return;
+	}
+
+	cmd = &batch->loops[batch->numLoops++];
+	cmd->id = SND_CMD_ADD_LOOP_SOUND;
+	cmd->sfx = sfx;
+	cmd->entnum = entnum;
+	cmd->fvol = fvol;
+	cmd->attenuation = attenuation;
 }
 
 /*
@@ -360,37 +570,6 @@ void S_IssueStuffCmd( sndCmdPipe_t *queue, const char *text ) {
 	S_EnqueueCmd( queue, &cmd, sizeof( cmd ) );
 }
 
-/*
-* S_IssueSetMulEntitySpatializationCmd
-*/
-void S_IssueSetMulEntitySpatializationCmd( sndCmdPipe_t *queue, unsigned numEnts,
-										   const smdCmdSpatialization_t *spat ) {
-	unsigned i, j;
-
-	for( j = 0; j < numEnts; ) {
-		unsigned n;
-		sndCmdSetMulEntitySpatialization_t cmd;
-
-		cmd.id = SND_CMD_SET_MUL_ENTITY_SPATIALIZATION;
-		cmd.numents = numEnts - j;
-		if( cmd.numents > SND_SPATIALIZE_ENTS_MAX ) {
-			cmd.numents = SND_SPATIALIZE_ENTS_MAX;
-		}
-
-		for( n = 0; n < cmd.numents; n++ ) {
-			cmd.entnum[n] = spat[n].entnum;
-			for( i = 0; i < 3; i++ ) {
-				cmd.origin[n][i] = spat[n].origin[i];
-				cmd.velocity[n][i] = spat[n].velocity[i];
-			}
-		}
-
-		S_EnqueueCmd( queue, &cmd, sizeof( cmd ) );
-
-		j += cmd.numents;
-	}
-}
-
 /*
 * S_ReadEnqueuedCmds
 */
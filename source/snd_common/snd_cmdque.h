@@ -23,7 +23,10 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 #define SND_COMMANDS_BUFSIZE    0x100000
 
-#define SND_SPATIALIZE_ENTS_MAX 8
+#define SND_SPATIALIZE_ENTS_MAX MAX_EDICTS
+
+#define SND_BATCH_CMDS_SIZE     0x10000
+#define SND_BATCH_LOOPS_MAX     MAX_EDICTS
 
 typedef struct qbufPipe_s sndCmdPipe_t;
 typedef unsigned (*pipeCmdHandler_t)( const void * );
@@ -53,7 +56,6 @@ enum {
 	SND_CMD_RAW_SAMPLES,
 	SND_CMD_POSITIONED_RAW_SAMPLES,
 	SND_CMD_STUFFCMD,
-	SND_CMD_SET_MUL_ENTITY_SPATIALIZATION,
 
 	SND_CMD_NUM_CMDS
 };
@@ -220,13 +222,41 @@ typedef struct {
 	char text[80];
 } sndStuffCmd_t;
 
+// Per-frame sounds, loops, spatializations and the listener are collected
+// into a batch by the client and handed over to the mixer thread by swapping
+// an index in a single atomic mailbox. Batches that the mixer hasn't picked
+// up yet are merged: sounds are appended, loops are replaced and the last
+// spatialization of each entity wins.
 typedef struct {
-	int id;
-	unsigned numents;
-	int entnum[SND_SPATIALIZE_ENTS_MAX];
-	float origin[SND_SPATIALIZE_ENTS_MAX][3];
-	float velocity[SND_SPATIALIZE_ENTS_MAX][3];
-} sndCmdSetMulEntitySpatialization_t;
+	unsigned cmdsSize;
+	int cmds[SND_BATCH_CMDS_SIZE / sizeof( int )];
+
+	unsigned numLoops;
+	sndAddLoopSoundCmd_t loops[SND_BATCH_LOOPS_MAX];
+
+	unsigned numSpats;
+	sndCmdSetEntitySpatialization_t spats[SND_SPATIALIZE_ENTS_MAX];
+	int spatIndex[MAX_EDICTS];      // index into spats plus one, 0 if unset
+
+	bool hasListener;
+	sndCmdSetListener_t listener;
+} sndCmdBatch_t;
+
+typedef struct {
+	volatile int mailbox;
+	int write;                      // only touched by the client
+	int read;                       // only touched by the mixer
+	sndCmdBatch_t batches[3];
+} sndCmdBatchQueue_t;
+
+// defined by each backend, shared with its mixer thread
+extern sndCmdBatchQueue_t *s_cmdBatches;
+
+sndCmdBatchQueue_t *S_CreateSoundCmdBatches( void );
+void S_DestroySoundCmdBatches( sndCmdBatchQueue_t **pqueue );
+void S_PublishSoundCmdBatch( sndCmdBatchQueue_t *queue );
+void S_DiscardSoundCmdBatches( sndCmdBatchQueue_t *queue );
+void S_ReadSoundCmdBatch( sndCmdBatchQueue_t *queue, pipeCmdHandler_t *cmdHandlers );
 
 sndCmdPipe_t *S_CreateSoundCmdPipe( void );
 void S_DestroySoundCmdPipe( sndCmdPipe_t **pqueue );
@@ -243,21 +273,21 @@ void S_IssueFreeSfxCmd( sndCmdPipe_t *queue, int sfx );
 void S_IssueLoadSfxCmd( sndCmdPipe_t *queue, int sfx );
 void S_IssueSetAttenuationCmd( sndCmdPipe_t *queue, int model,
 							   float maxdistance, float refdistance );
-void S_IssueSetEntitySpatializationCmd( sndCmdPipe_t *queue, const smdCmdSpatialization_t *spat );
-void S_IssueSetListenerCmd( sndCmdPipe_t *queue, const vec3_t origin,
+void S_IssueSetEntitySpatializationCmd( sndCmdBatchQueue_t *queue, const smdCmdSpatialization_t *spat );
+void S_IssueSetListenerCmd( sndCmdBatchQueue_t *queue, const vec3_t origin,
 							const vec3_t velocity, const mat3_t axis, bool avidump );
-void S_IssueStartLocalSoundCmd( sndCmdPipe_t *queue, int sfx, int channel, float fvol );
-void S_IssueStartFixedSoundCmd( sndCmdPipe_t *queue, int sfx, const vec3_t origin,
+void S_IssueStartLocalSoundCmd( sndCmdBatchQueue_t *queue, int sfx, int channel, float fvol );
+void S_IssueStartFixedSoundCmd( sndCmdBatchQueue_t *queue, int sfx, const vec3_t origin,
 								int channel, float fvol, float attenuation );
-void S_IssueStartGlobalSoundCmd( sndCmdPipe_t *queue, int sfx, int channel,
+void S_IssueStartGlobalSoundCmd( sndCmdBatchQueue_t *queue, int sfx, int channel,
 								 float fvol );
-void S_IssueStartRelativeSoundCmd( sndCmdPipe_t *queue, int sfx, int entnum,
+void S_IssueStartRelativeSoundCmd( sndCmdBatchQueue_t *queue, int sfx, int entnum,
 								   int channel, float fvol, float attenuation );
 void S_IssueStartBackgroundTrackCmd( sndCmdPipe_t *queue, const char *intro,
 									 const char *loop, int mode );
 void S_IssueStopBackgroundTrackCmd( sndCmdPipe_t *queue );
 void S_IssueLockBackgroundTrackCmd( sndCmdPipe_t *queue, bool lock );
-void S_IssueAddLoopSoundCmd( sndCmdPipe_t *queue, int sfx, int entnum,
+void S_IssueAddLoopSoundCmd( sndCmdBatchQueue_t *queue, int sfx, int entnum,
 							 float fvol, float attenuation );
 void S_IssueAdvanceBackgroundTrackCmd( sndCmdPipe_t *queue, int val );
 void S_IssuePauseBackgroundTrackCmd( sndCmdPipe_t *queue );
@@ -270,7 +300,5 @@ void S_IssuePositionedRawSamplesCmd( sndCmdPipe_t *queue, int entnum,
 									 float fvol, float attenuation, unsigned int samples, unsigned int rate,
 									 unsigned short width, unsigned short channels, uint8_t *data );
 void S_IssueStuffCmd( sndCmdPipe_t *queue, const char *text );
-void S_IssueSetMulEntitySpatializationCmd( sndCmdPipe_t *queue, unsigned numEnts,
-										   const smdCmdSpatialization_t *spat );
 
 #endif // SND_CMDQUEUE_H
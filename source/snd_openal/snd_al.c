@@ -629,17 +629,6 @@ static unsigned S_HandleStuffCmd( const sndStuffCmd_t *cmd ) {
 	return sizeof( *cmd );
 }
 
-/*
-* S_HandleSetMulEntitySpatializationCmd
-*/
-static unsigned S_HandleSetMulEntitySpatializationCmd( const sndCmdSetMulEntitySpatialization_t *cmd ) {
-	unsigned i;
-	//Com_Printf("S_HandleSetEntitySpatializationCmd\n");
-	for( i = 0; i < cmd->numents; i++ )
-		S_SetEntitySpatialization( cmd->entnum[i], cmd->origin[i], cmd->velocity[i] );
-	return sizeof( *cmd );
-}
-
 static pipeCmdHandler_t sndCmdHandlers[SND_CMD_NUM_CMDS] =
 {
 	/* SND_CMD_INIT */
@@ -690,8 +679,6 @@ static pipeCmdHandler_t sndCmdHandlers[SND_CMD_NUM_CMDS] =
 	(pipeCmdHandler_t)S_HandlePositionedRawSamplesCmd,
 	/* SND_CMD_STUFFCMD */
 	(pipeCmdHandler_t)S_HandleStuffCmd,
-	/* SND_CMD_SET_MUL_ENTITY_SPATIALIZATION */
-	(pipeCmdHandler_t)S_HandleSetMulEntitySpatializationCmd,
 };
 
 /*
@@ -708,6 +695,7 @@ static int S_EnqueuedCmdsWaiter( sndCmdPipe_t *queue, pipeCmdHandler_t *cmdHandl
 
 	if( timeout || now >= s_last_update_time + UPDATE_MSEC ) {
 		s_last_update_time = now;
+		S_ReadSoundCmdBatch( s_cmdBatches, cmdHandlers );
 		S_Update();
 	}
 
@@ -22,6 +22,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "snd_cmdque.h"
 
 static sndCmdPipe_t *s_cmdPipe;
+sndCmdBatchQueue_t *s_cmdBatches;
 
 static struct qthread_s *s_backThread;
 
@@ -39,11 +40,6 @@ cvar_t *s_globalfocus;
 static int s_registration_sequence = 1;
 static bool s_registering;
 
-// batch entity spatializations
-static unsigned s_num_ent_spats;
-static smdCmdSpatialization_t s_ent_spats[SND_SPATIALIZE_ENTS_MAX];
-static const unsigned s_max_ent_spats = sizeof( s_ent_spats ) / sizeof( s_ent_spats[0] );
-
 static void SF_UnregisterSound( sfx_t *sfx );
 static void SF_FreeSound( sfx_t *sfx );
 
@@ -100,8 +96,6 @@ static void SF_ListDevices_f( void ) {
 bool SF_Init( void *hwnd, int maxEntities, bool verbose ) {
 	soundpool = S_MemAllocPool( "OpenAL sound module" );
 
-	s_num_ent_spats = 0;
-
 #ifdef OPENAL_RUNTIME
 	if( !QAL_Init( ALDRIVER, verbose ) ) {
 #ifdef ALDRIVER_ALT
@@ -137,6 +131,8 @@ bool SF_Init( void *hwnd, int maxEntities, bool verbose ) {
 		return false;
 	}
 
+	s_cmdBatches = S_CreateSoundCmdBatches();
+
 	s_backThread = trap_Thread_Create( S_BackgroundUpdateProc, s_cmdPipe );
 
 	S_IssueInitCmd( s_cmdPipe, hwnd, maxEntities, verbose );
@@ -182,6 +178,8 @@ void SF_Shutdown( bool verbose ) {
 
 	S_DestroySoundCmdPipe( &s_cmdPipe );
 
+	S_DestroySoundCmdBatches( &s_cmdBatches );
+
 #ifdef ENABLE_PLAY
 	trap_Cmd_RemoveCommand( "play" );
 #endif
@@ -301,6 +299,7 @@ void SF_LockBackgroundTrack( bool lock ) {
 * SF_StopAllSounds
 */
 void SF_StopAllSounds( bool clear, bool stopMusic ) {
+	S_DiscardSoundCmdBatches( s_cmdBatches );
 	S_IssueStopAllSoundsCmd( s_cmdPipe, clear, stopMusic );
 }
 
@@ -350,18 +349,13 @@ void SF_SetAttenuationModel( int model, float maxdistance, float refdistance ) {
 * SF_SetEntitySpatialization
 */
 void SF_SetEntitySpatialization( int entnum, const vec3_t origin, const vec3_t velocity ) {
-	smdCmdSpatialization_t *spat;
+	smdCmdSpatialization_t spat;
 
-	if( s_num_ent_spats == s_max_ent_spats ) {
-		// flush all spatializations at once to free room
-		S_IssueSetMulEntitySpatializationCmd( s_cmdPipe, s_num_ent_spats, s_ent_spats );
-		s_num_ent_spats = 0;
-	}
+	spat.entnum = entnum;
+	VectorCopy( origin, spat.origin );
+	VectorCopy( velocity, spat.velocity );
 
-	spat = &s_ent_spats[s_num_ent_spats++];
-	spat->entnum = entnum;
-	VectorCopy( origin, spat->origin );
-	VectorCopy( velocity, spat->velocity );
+	S_IssueSetEntitySpatializationCmd( s_cmdBatches, &spat );
 }
 
 /*
@@ -369,7 +363,7 @@ void SF_SetEntitySpatialization( int entnum, const vec3_t origin, const vec3_t v
 */
 void SF_StartFixedSound( sfx_t *sfx, const vec3_t origin, int channel, float fvol, float attenuation ) {
 	if( sfx != NULL ) {
-		S_IssueStartFixedSoundCmd( s_cmdPipe, sfx->id, origin, channel, fvol, attenuation );
+		S_IssueStartFixedSoundCmd( s_cmdBatches, sfx->id, origin, channel, fvol, attenuation );
 	}
 }
 
@@ -378,7 +372,7 @@ void SF_StartFixedSound( sfx_t *sfx, const vec3_t origin, int channel, float fvo
 */
 void SF_StartRelativeSound( sfx_t *sfx, int entnum, int channel, float fvol, float attenuation ) {
 	if( sfx != NULL ) {
-		S_IssueStartRelativeSoundCmd( s_cmdPipe, sfx->id, entnum, channel, fvol, attenuation );
+		S_IssueStartRelativeSoundCmd( s_cmdBatches, sfx->id, entnum, channel, fvol, attenuation );
 	}
 }
 
@@ -387,7 +381,7 @@ void SF_StartRelativeSound( sfx_t *sfx, int entnum, int channel, float fvol, flo
 */
 void SF_StartGlobalSound( sfx_t *sfx, int channel, float fvol ) {
 	if( sfx != NULL ) {
-		S_IssueStartGlobalSoundCmd( s_cmdPipe, sfx->id, channel, fvol );
+		S_IssueStartGlobalSoundCmd( s_cmdBatches, sfx->id, channel, fvol );
 	}
 }
 
@@ -396,7 +390,7 @@ void SF_StartGlobalSound( sfx_t *sfx, int channel, float fvol ) {
 */
 void SF_StartLocalSound( sfx_t *sfx, int channel, float fvol ) {
 	if( sfx != NULL ) {
-		S_IssueStartLocalSoundCmd( s_cmdPipe, sfx->id, channel, fvol );
+		S_IssueStartLocalSoundCmd( s_cmdBatches, sfx->id, channel, fvol );
 	}
 }
 
@@ -404,6 +398,7 @@ void SF_StartLocalSound( sfx_t *sfx, int channel, float fvol ) {
 * SF_Clear
 */
 void SF_Clear( void ) {
+	S_DiscardSoundCmdBatches( s_cmdBatches );
 	S_IssueClearCmd( s_cmdPipe );
 }
 
@@ -412,7 +407,7 @@ void SF_Clear( void ) {
 */
 void SF_AddLoopSound( sfx_t *sfx, int entnum, float fvol, float attenuation ) {
 	if( sfx != NULL ) {
-		S_IssueAddLoopSoundCmd( s_cmdPipe, sfx->id, entnum, fvol, attenuation );
+		S_IssueAddLoopSoundCmd( s_cmdBatches, sfx->id, entnum, fvol, attenuation );
 	}
 }
 
@@ -420,12 +415,9 @@ void SF_AddLoopSound( sfx_t *sfx, int entnum, float fvol, float attenuation ) {
 * SF_Update
 */
 void SF_Update( const vec3_t origin, const vec3_t velocity, const mat3_t axis, bool avidump ) {
-	if( s_num_ent_spats ) {
-		S_IssueSetMulEntitySpatializationCmd( s_cmdPipe, s_num_ent_spats, s_ent_spats );
-		s_num_ent_spats = 0;
-	}
+	S_IssueSetListenerCmd( s_cmdBatches, origin, velocity, axis, avidump );
 
-	S_IssueSetListenerCmd( s_cmdPipe, origin, velocity, axis, avidump );
+	S_PublishSoundCmdBatch( s_cmdBatches );
 }
 
 /*
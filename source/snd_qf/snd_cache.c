@@ -0,0 +1,637 @@
+/*
+Copyright (C) 2018 Warsow development team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+// snd_cache.c: streaming of long sounds
+//
+// Sounds longer than s_streamthreshold seconds aren't decoded at registration.
+// Only their first chunk stays resident so they can start playing right away,
+// the rest is decoded one chunk ahead of the mixer by the decoder thread.
+// Decoded chunks stay around until the cache needs room for others, then the
+// least recently mixed ones are freed. Chunk states are changed to queued and
+// back to empty by the mixer, the decoder only fills queued chunks and marks
+// them as ready. All state changes and checks are atomic compare-and-swaps,
+// which are full barriers, so the data of a ready chunk is visible to the mixer.
+
+#include "snd_local.h"
+
+#define STREAM_PIPE_SIZE        0x4000
+
+#define FRACTIONAL_BITS         14
+#define FRACTIONAL_MASK         ( ( 1 << FRACTIONAL_BITS ) - 1 )
+
+enum {
+	STREAM_CMD_DECODE,
+	STREAM_CMD_CLOSE,
+	STREAM_CMD_SHUTDOWN,
+
+	NUM_STREAM_CMDS
+};
+
+typedef unsigned (*queueCmdHandler_t)( const void * );
+
+typedef struct {
+	int id;
+	sfxstream_t *stream;
+	int chunk;
+} streamDecodeCmd_t;
+
+typedef struct {
+	int id;
+	sfxstream_t *stream;
+} streamCloseCmd_t;
+
+typedef struct {
+	const sfxstream_t *stream;
+	int file;
+	void *vorbisFile;
+} streamReader_t;
+
+static qbufPipe_t *s_streamPipe;
+static struct qthread_s *s_streamThread;
+static struct qmutex_s *s_streamLock;
+
+static struct {
+	size_t size;            // bytes of decoded chunks, not counting the resident ones
+	int loads;
+	int evictions;
+	int stalls;
+} s_streamCache;
+
+static streamReader_t s_streamReader;   // only used by the decoder thread
+
+/*
+* S_StreamChunkReady
+*/
+static bool S_StreamChunkReady( sfxchunk_t *chunk ) {
+	return trap_Atomic_CAS( &chunk->state, SFXCHUNK_READY, SFXCHUNK_READY, NULL );
+}
+
+/*
+* S_StreamChunkSize
+*/
+static size_t S_StreamChunkSize( const sfxstream_t *stream, int chunk ) {
+	unsigned int first = chunk * stream->chunkLength;
+	unsigned int last = min( first + stream->chunkLength, stream->length );
+
+	return ( last - first + ( chunk ? S_STREAM_PREFIX : 0 ) ) * stream->frameSize;
+}
+
+/*
+* S_OpenStreamReader
+*/
+static bool S_OpenStreamReader( streamReader_t *reader, const sfxstream_t *stream ) {
+	memset( reader, 0, sizeof( *reader ) );
+
+	if( stream->ogg ) {
+		reader->vorbisFile = SNDOGG_OpenStream( stream->sfx->name );
+		if( !reader->vorbisFile ) {
+			return false;
+		}
+	} else {
+		trap_FS_FOpenFile( stream->sfx->name, &reader->file, FS_READ );
+		if( !reader->file ) {
+			return false;
+		}
+	}
+
+	reader->stream = stream;
+	return true;
+}
+
+/*
+* S_CloseStreamReader
+*/
+static void S_CloseStreamReader( streamReader_t *reader ) {
+	if( reader->vorbisFile ) {
+		SNDOGG_CloseStream( reader->vorbisFile );
+	}
+	if( reader->file ) {
+		trap_FS_FCloseFile( reader->file );
+	}
+	memset( reader, 0, sizeof( *reader ) );
+}
+
+/*
+* S_ReadStreamSamples
+*
+* Reads source sample frames, 16-bit samples are converted to native byte order.
+*/
+static bool S_ReadStreamSamples( streamReader_t *reader, unsigned int first, unsigned int count, uint8_t *out ) {
+	const sfxstream_t *stream = reader->stream;
+	int size = count * stream->channels * stream->width;
+
+	if( stream->ogg ) {
+		return SNDOGG_ReadStream( reader->vorbisFile, first, count, stream->channels, out );
+	}
+
+	if( trap_FS_Seek( reader->file, stream->dataofs + first * stream->channels * stream->width, FS_SEEK_SET ) < 0 ) {
+		return false;
+	}
+	if( trap_FS_Read( out, size, reader->file ) != size ) {
+		return false;
+	}
+
+	if( stream->width == 2 ) {
+		int i;
+		short *samples = (short *)out;
+
+		for( i = 0; i < size / 2; i++ )
+			samples[i] = LittleShort( samples[i] );
+	}
+
+	return true;
+}
+
+/*
+* S_StreamSourceFrame
+*
+* Returns the source frame the resampled frame is interpolated from, stepping
+* through each second of the sound the same way as ResampleSfx.
+*/
+static unsigned int S_StreamSourceFrame( const sfxstream_t *stream, unsigned int frame, unsigned int *frac ) {
+	unsigned int samplefrac = ( frame % stream->speed ) * stream->fracstep;
+
+	*frac = samplefrac & FRACTIONAL_MASK;
+	return ( frame / stream->speed ) * stream->rate + ( samplefrac >> FRACTIONAL_BITS );
+}
+
+/*
+* S_DecodeStreamChunk
+*/
+static bool S_DecodeStreamChunk( streamReader_t *reader, const sfxstream_t *stream, int chunk, uint8_t *out ) {
+	unsigned int i, j, frac;
+	unsigned int first = chunk * stream->chunkLength - ( chunk ? S_STREAM_PREFIX : 0 );
+	unsigned int last = min( ( chunk + 1 ) * stream->chunkLength, stream->length );
+	unsigned int srcFirst, srcLast;
+	const unsigned int channels = stream->channels;
+	uint8_t *src;
+	bool res;
+
+	srcFirst = S_StreamSourceFrame( stream, first, &frac );
+	srcLast = min( S_StreamSourceFrame( stream, last - 1, &frac ) + 2, stream->samples );
+
+	src = S_Malloc( ( srcLast - srcFirst ) * channels * stream->width );
+	res = S_ReadStreamSamples( reader, srcFirst, srcLast - srcFirst, src );
+
+	if( res ) {
+		for( i = first; i < last; i++ ) {
+			unsigned int s = S_StreamSourceFrame( stream, i, &frac );
+			bool interpolate = s + 1 < stream->samples;
+
+			for( j = 0; j < channels; j++ ) {
+				unsigned int in = ( s - srcFirst ) * channels + j;
+				int a, b;
+
+				if( stream->width == 2 ) {
+					a = ( (short *)src )[in];
+					b = interpolate ? ( (short *)src )[in + channels] : a;
+					*( (short *)out ) = ( ( ( b - a ) * (int)frac ) >> FRACTIONAL_BITS ) + a;
+					out += sizeof( short );
+				} else {
+					a = src[in] - 128;
+					b = interpolate ? src[in + channels] - 128 : a;
+					*( (signed char *)out ) = ( ( ( b - a ) * (int)frac ) >> FRACTIONAL_BITS ) + a;
+					out += sizeof( signed char );
+				}
+			}
+		}
+	}
+
+	S_Free( src );
+
+	return res;
+}
+
+/*
+* S_HandleStreamDecodeCmd
+*/
+static unsigned S_HandleStreamDecodeCmd( const void *pcmd ) {
+	const streamDecodeCmd_t *cmd = pcmd;
+	sfxstream_t *stream = cmd->stream;
+	sfxchunk_t *chunk = &stream->chunks[cmd->chunk];
+	uint8_t *data;
+
+	data = S_Malloc( S_StreamChunkSize( stream, cmd->chunk ) );
+
+	// keep reading from the same file as long as the same sound is playing
+	if( s_streamReader.stream != stream ) {
+		S_CloseStreamReader( &s_streamReader );
+		S_OpenStreamReader( &s_streamReader, stream );
+	}
+
+	if( !s_streamReader.stream || !S_DecodeStreamChunk( &s_streamReader, stream, cmd->chunk, data ) ) {
+		// play silence instead of stalling the channel forever
+		Com_Printf( "S_HandleStreamDecodeCmd: error reading %s\n", stream->sfx->name );
+		memset( data, 0, S_StreamChunkSize( stream, cmd->chunk ) );
+		S_CloseStreamReader( &s_streamReader );
+	}
+
+	chunk->data = data;
+	trap_Atomic_CAS( &chunk->state, SFXCHUNK_QUEUED, SFXCHUNK_READY, NULL );
+	return sizeof( *cmd );
+}
+
+/*
+* S_HandleStreamCloseCmd
+*/
+static unsigned S_HandleStreamCloseCmd( const void *pcmd ) {
+	const streamCloseCmd_t *cmd = pcmd;
+
+	if( s_streamReader.stream == cmd->stream ) {
+		S_CloseStreamReader( &s_streamReader );
+	}
+	return sizeof( *cmd );
+}
+
+/*
+* S_HandleStreamShutdownCmd
+*/
+static unsigned S_HandleStreamShutdownCmd( const void *pcmd ) {
+	S_CloseStreamReader( &s_streamReader );
+	return 0;
+}
+
+/*
+* S_StreamCmdsWaiter
+*/
+static int S_StreamCmdsWaiter( qbufPipe_t *queue, queueCmdHandler_t *cmdHandlers, bool timeout ) {
+	return trap_BufPipe_ReadCmds( queue, cmdHandlers );
+}
+
+/*
+* S_StreamThreadProc
+*/
+static void *S_StreamThreadProc( void *param ) {
+	queueCmdHandler_t cmdHandlers[NUM_STREAM_CMDS] =
+	{
+		(queueCmdHandler_t)S_HandleStreamDecodeCmd,
+		(queueCmdHandler_t)S_HandleStreamCloseCmd,
+		(queueCmdHandler_t)S_HandleStreamShutdownCmd,
+	};
+
+	trap_BufPipe_Wait( param, S_StreamCmdsWaiter, cmdHandlers, Q_THREADS_WAIT_INFINITE );
+
+	return NULL;
+}
+
+/*
+* S_InitSoundCache
+*/
+void S_InitSoundCache( void ) {
+	memset( &s_streamCache, 0, sizeof( s_streamCache ) );
+
+	s_streamLock = trap_Mutex_Create();
+	s_streamPipe = trap_BufPipe_Create( STREAM_PIPE_SIZE, 1 );
+	s_streamThread = trap_Thread_Create( S_StreamThreadProc, s_streamPipe );
+}
+
+/*
+* S_ShutdownSoundCache
+*
+* All sounds must have been freed.
+*/
+void S_ShutdownSoundCache( void ) {
+	int cmd = STREAM_CMD_SHUTDOWN;
+
+	if( !s_streamPipe ) {
+		return;
+	}
+
+	trap_BufPipe_WriteCmd( s_streamPipe, &cmd, sizeof( cmd ) );
+	trap_Thread_Join( s_streamThread );
+	s_streamThread = NULL;
+
+	trap_BufPipe_Destroy( &s_streamPipe );
+	trap_Mutex_Destroy( &s_streamLock );
+}
+
+/*
+* S_StreamSound
+*
+* Returns true if the sound is long enough to be streamed.
+*/
+bool S_StreamSound( const wavinfo_t *info ) {
+	if( !s_streamPipe || s_streamthreshold->value <= 0 ) {
+		return false;
+	}
+	if( info->rate <= 0 || info->samples <= 0 ) {
+		return false;
+	}
+
+	// leave the sounds ResampleSfx can't handle to it so the error is reported
+	if( info->rate * info->channels > ( 1 << ( 32 - FRACTIONAL_BITS ) ) ) {
+		return false;
+	}
+
+	return (float)info->samples / (float)info->rate > s_streamthreshold->value;
+}
+
+/*
+* S_LoadSoundStream
+*
+* Sets up streaming of a sound from the .wav samples at info->dataofs or from
+* an .ogg file and decodes the first chunk.
+*/
+sfxcache_t *S_LoadSoundStream( sfx_t *s, const wavinfo_t *info, bool ogg ) {
+	sfxcache_t *sc;
+	sfxstream_t *stream;
+	streamReader_t reader;
+	bool res;
+
+	assert( s && s->name[0] );
+	assert( !s->cache && !s->stream );
+
+	stream = S_Malloc( sizeof( *stream ) );
+	stream->sfx = s;
+	stream->ogg = ogg;
+	stream->rate = info->rate;
+	stream->samples = info->samples;
+	stream->channels = info->channels;
+	stream->width = info->width;
+	stream->dataofs = info->dataofs;
+	stream->speed = dma.speed;
+	stream->fracstep = (unsigned int)( (double)info->rate / dma.speed * ( 1 << FRACTIONAL_BITS ) );
+	stream->frameSize = info->channels * info->width;
+	stream->length = (unsigned int)( (double)info->samples * (double)dma.speed / (double)info->rate );
+	stream->chunkLength = dma.speed;
+	stream->numChunks = ( stream->length + stream->chunkLength - 1 ) / stream->chunkLength;
+	stream->chunks = S_Malloc( stream->numChunks * sizeof( *stream->chunks ) );
+
+	// the first chunk is resident
+	stream->chunks[0].data = S_Malloc( S_StreamChunkSize( stream, 0 ) );
+	res = S_OpenStreamReader( &reader, stream );
+	if( res ) {
+		res = S_DecodeStreamChunk( &reader, stream, 0, stream->chunks[0].data );
+		S_CloseStreamReader( &reader );
+	}
+
+	if( !res ) {
+		Com_Printf( "Error reading %s\n", s->name );
+		S_Free( stream->chunks[0].data );
+		S_Free( stream->chunks );
+		S_Free( stream );
+		return NULL;
+	}
+
+	stream->chunks[0].state = SFXCHUNK_READY;
+
+	sc = S_Malloc( sizeof( sfxcache_t ) );
+	sc->length = stream->length;
+	sc->channels = info->channels;
+	sc->width = info->width;
+	sc->speed = dma.speed;
+	sc->loopstart = info->loopstart < 0 ? sc->length : info->loopstart * ( (double)sc->length / (double)info->samples );
+
+	trap_Mutex_Lock( s_streamLock );
+	s->stream = stream;
+	s->cache = sc;
+	trap_Mutex_Unlock( s_streamLock );
+
+	return sc;
+}
+
+/*
+* S_EvictStreamChunks
+*
+* Frees the least recently mixed chunks until there's room for size bytes.
+* The pinned chunk of the pinned stream is kept, its samples are being mixed.
+*/
+static void S_EvictStreamChunks( size_t size, const sfxstream_t *pinnedStream, int pinnedChunk ) {
+	int i, j;
+	size_t budget = s_streamcache->value * 1024 * 1024;
+	sfxstream_t *stream;
+	sfxstream_t *lruStream;
+	int lruChunk;
+	int64_t lruTime;
+
+	while( s_streamCache.size + size > budget ) {
+		lruStream = NULL;
+		lruChunk = 0;
+		lruTime = 0;
+
+		for( i = 0; i < num_sfx; i++ ) {
+			stream = known_sfx[i].stream;
+			if( !stream ) {
+				continue;
+			}
+
+			for( j = 1; j < stream->numChunks; j++ ) {
+				sfxchunk_t *chunk = &stream->chunks[j];
+				if( stream == pinnedStream && j == pinnedChunk ) {
+					continue;
+				}
+				if( !S_StreamChunkReady( chunk ) ) {
+					continue;
+				}
+				if( !lruStream || chunk->lastUsed < lruTime ) {
+					lruStream = stream;
+					lruChunk = j;
+					lruTime = chunk->lastUsed;
+				}
+			}
+		}
+
+		if( !lruStream ) {
+			// everything is queued, go over the budget for now
+			break;
+		}
+
+		trap_Atomic_CAS( &lruStream->chunks[lruChunk].state, SFXCHUNK_READY, SFXCHUNK_EMPTY, NULL );
+		S_Free( lruStream->chunks[lruChunk].data );
+		lruStream->chunks[lruChunk].data = NULL;
+		s_streamCache.size -= S_StreamChunkSize( lruStream, lruChunk );
+		s_streamCache.evictions++;
+	}
+}
+
+/*
+* S_RequestStreamChunk
+*
+* Queues the chunk for decoding unless it's already queued or ready.
+* Room is made for it without evicting the pinned chunk.
+*/
+static void S_RequestStreamChunk( sfxstream_t *stream, int chunk, int pinnedChunk ) {
+	size_t size;
+	streamDecodeCmd_t cmd;
+
+	if( !trap_Atomic_CAS( &stream->chunks[chunk].state, SFXCHUNK_EMPTY, SFXCHUNK_QUEUED, NULL ) ) {
+		return;
+	}
+
+	trap_Mutex_Lock( s_streamLock );
+
+	size = S_StreamChunkSize( stream, chunk );
+	S_EvictStreamChunks( size, stream, pinnedChunk );
+
+	stream->chunks[chunk].lastUsed = trap_Milliseconds();
+	s_streamCache.size += size;
+	s_streamCache.loads++;
+
+	cmd.id = STREAM_CMD_DECODE;
+	cmd.stream = stream;
+	cmd.chunk = chunk;
+	trap_BufPipe_WriteCmd( s_streamPipe, &cmd, sizeof( cmd ) );
+
+	trap_Mutex_Unlock( s_streamLock );
+}
+
+/*
+* S_GetSoundSamples
+*
+* Returns the samples at pos and clamps count to the number of sample frames
+* that follow them in memory. Returns NULL if the samples of a streamed sound
+* haven't been decoded yet, in which case they are requested.
+*/
+const uint8_t *S_GetSoundSamples( sfx_t *sfx, const sfxcache_t *sc, unsigned int pos, unsigned int *count ) {
+	int c, next;
+	unsigned int first;
+	sfxchunk_t *chunk;
+	sfxstream_t *stream = sfx->stream;
+
+	if( !stream ) {
+		return sc->data + pos * sc->channels * sc->width;
+	}
+
+	c = min( pos / stream->chunkLength, (unsigned)stream->numChunks - 1 );
+	first = c * stream->chunkLength;
+	if( pos + *count > first + stream->chunkLength ) {
+		*count = first + stream->chunkLength - pos;
+	}
+
+	chunk = &stream->chunks[c];
+	if( !S_StreamChunkReady( chunk ) ) {
+		S_RequestStreamChunk( stream, c, -1 );
+
+		// like the rest of the stream cache stats, only touched under the lock
+		trap_Mutex_Lock( s_streamLock );
+		s_streamCache.stalls++;
+		trap_Mutex_Unlock( s_streamLock );
+		return NULL;
+	}
+
+	chunk->lastUsed = trap_Milliseconds();
+
+	// have the decoder stay a chunk ahead, making room for it mustn't
+	// free the chunk that's returned
+	next = c + 1;
+	if( next == stream->numChunks ) {
+		next = sc->loopstart < sc->length ? sc->loopstart / stream->chunkLength : 0;
+	}
+	if( next > 0 ) {
+		S_RequestStreamChunk( stream, next, c );
+	}
+
+	return chunk->data + ( pos - first + ( c ? S_STREAM_PREFIX : 0 ) ) * stream->frameSize;
+}
+
+/*
+* S_FreeSound
+*/
+void S_FreeSound( sfx_t *sfx ) {
+	int i;
+	sfxstream_t *stream = sfx->stream;
+
+	if( stream ) {
+		streamCloseCmd_t cmd;
+
+		trap_Mutex_Lock( s_streamLock );
+
+		// wait for the queued chunks to be decoded
+		cmd.id = STREAM_CMD_CLOSE;
+		cmd.stream = stream;
+		trap_BufPipe_WriteCmd( s_streamPipe, &cmd, sizeof( cmd ) );
+		trap_BufPipe_Finish( s_streamPipe );
+
+		for( i = 0; i < stream->numChunks; i++ ) {
+			if( !stream->chunks[i].data ) {
+				continue;
+			}
+			if( i ) {
+				s_streamCache.size -= S_StreamChunkSize( stream, i );
+			}
+			S_Free( stream->chunks[i].data );
+		}
+
+		sfx->stream = NULL;
+
+		trap_Mutex_Unlock( s_streamLock );
+
+		S_Free( stream->chunks );
+		S_Free( stream );
+	}
+
+	if( sfx->cache ) {
+		S_Free( sfx->cache );
+		sfx->cache = NULL;
+	}
+}
+
+/*
+* S_SoundResidentSize
+*
+* Returns the number of bytes of samples that stay in memory.
+*/
+int S_SoundResidentSize( const sfx_t *sfx ) {
+	const sfxcache_t *sc = sfx->cache;
+
+	if( !sc ) {
+		return 0;
+	}
+	if( sfx->stream ) {
+		return S_StreamChunkSize( sfx->stream, 0 );
+	}
+	return sc->length * sc->width * sc->channels;
+}
+
+/*
+* S_SoundCacheList
+*
+* Prints the decoded chunks of streamed sounds and the stats of the cache.
+*/
+void S_SoundCacheList( void ) {
+	int i, j, numStreams, numDecoded;
+	sfxstream_t *stream;
+
+	trap_Mutex_Lock( s_streamLock );
+
+	numStreams = 0;
+	for( i = 0; i < num_sfx; i++ ) {
+		stream = known_sfx[i].stream;
+		if( !stream ) {
+			continue;
+		}
+
+		numDecoded = 0;
+		for( j = 1; j < stream->numChunks; j++ ) {
+			if( S_StreamChunkReady( &stream->chunks[j] ) ) {
+				numDecoded++;
+			}
+		}
+
+		Com_Printf( "S %3i/%3i chunks : %s\n", numDecoded, stream->numChunks - 1, known_sfx[i].name );
+		numStreams++;
+	}
+
+	Com_Printf( "Streamed: %i sounds, %i/%i KB decoded\n", numStreams,
+				(int)( s_streamCache.size / 1024 ), (int)( s_streamcache->value * 1024 ) );
+	Com_Printf( "Stream cache: %i loads, %i evictions, %i stalls\n",
+				s_streamCache.loads, s_streamCache.evictions, s_streamCache.stalls );
+
+	trap_Mutex_Unlock( s_streamLock );
+}
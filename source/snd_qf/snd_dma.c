@@ -72,6 +72,16 @@ static char *s_aviDumpFileName;
 
 static entity_spatialization_t s_ent_spatialization[MAX_EDICTS];
 
+// distances and listener space directions of entities, see S_SpatializeEntities
+static struct {
+	unsigned frame;
+	unsigned entframe[MAX_EDICTS];  // the entity's data is valid if equal to frame, which is never 0
+	vec_t dist[MAX_EDICTS];
+	vec_t forward[MAX_EDICTS];
+	vec_t right[MAX_EDICTS];
+	vec_t up[MAX_EDICTS];
+} s_ent_listener;
+
 static void S_StopAllSounds( bool clear, bool stopMusic );
 static void S_ClearSoundTime( void );
 static void S_ClearRawSounds( void );
@@ -105,7 +115,7 @@ static void S_SoundList_f( void ) {
 		}
 		sc = sfx->cache;
 		if( sc ) {
-			size = sc->length * sc->width * sc->channels;
+			size = S_SoundResidentSize( sfx );
 			total += size;
 			if( sc->loopstart < sc->length ) {
 				Com_Printf( "L" );
@@ -122,6 +132,8 @@ static void S_SoundList_f( void ) {
 		}
 	}
 	Com_Printf( "Total resident: %i\n", total );
+
+	S_SoundCacheList();
 }
 
 /*
@@ -135,6 +147,9 @@ static bool S_Init( void *hwnd, int maxEntities, bool verbose ) {
 	s_active = true;
 	s_last_update_time = 0;
 
+	memset( &s_ent_listener, 0, sizeof( s_ent_listener ) );
+	s_ent_listener.frame = 1;
+
 	if( verbose ) {
 		Com_Printf( "Sound sampling rate: %i\n", dma.speed );
 	}
@@ -259,31 +274,143 @@ static float S_GainForAttenuation( float dist, float attenuation ) {
 }
 
 /*
-* S_SpatializeOrigin
+* S_ListenerDirection
+*
+* Returns the distance to origin and stores its direction in listener space.
+*/
+static vec_t S_ListenerDirection( const vec3_t origin, vec3_t dir ) {
+	vec3_t vec;
+
+	VectorSubtract( origin, listenerOrigin, vec );
+	Matrix3_TransformVector( listenerAxis, vec, dir );
+
+	return VectorNormalize( dir );
+}
+
+/*
+* S_AddSpatializedEntity
 */
-#define Q3STEREODIRECTION
-static void S_SpatializeOrigin( const vec3_t origin, float master_vol, float dist_mult, int *left_vol, int *right_vol ) {
+static void S_AddSpatializedEntity( int entnum, int *ents, int *numEnts ) {
+	if( entnum < 0 || entnum >= MAX_EDICTS ) {
+		return;
+	}
+	if( s_ent_listener.entframe[entnum] == s_ent_listener.frame ) {
+		return;
+	}
+
+	s_ent_listener.entframe[entnum] = s_ent_listener.frame;
+	ents[( *numEnts )++] = entnum;
+}
+
+/*
+* S_SpatializeEntities
+*
+* Computes the distances and directions of all entities that have sounds
+* attached to them, once for all of their channels. Uses a struct of arrays
+* so the compiler can vectorize the math.
+*/
+static void S_SpatializeEntities( void ) {
+	int i, entnum, numEnts;
+	channel_t *ch;
+	static int ents[MAX_EDICTS];
+	static vec_t x[MAX_EDICTS], y[MAX_EDICTS], z[MAX_EDICTS];
+
+	// invalidates the directions computed for the previous listener position
+	if( !++s_ent_listener.frame ) {
+		s_ent_listener.frame = 1;
+	}
+
+	numEnts = 0;
+
+	for( i = 0, ch = channels; i < MAX_CHANNELS; i++, ch++ ) {
+		if( ch->sfx && !ch->autosound && !ch->fixed_origin ) {
+			S_AddSpatializedEntity( ch->entnum, ents, &numEnts );
+		}
+	}
+	for( i = 0; i < num_loopsfx; i++ ) {
+		if( loop_sfx[i].sfx && loop_sfx[i].attenuation ) {
+			S_AddSpatializedEntity( loop_sfx[i].entnum, ents, &numEnts );
+		}
+	}
+	for( i = 0; i < MAX_RAW_SOUNDS; i++ ) {
+		if( raw_sounds[i] && raw_sounds[i]->attenuation ) {
+			S_AddSpatializedEntity( raw_sounds[i]->entnum, ents, &numEnts );
+		}
+	}
+
+	for( i = 0; i < numEnts; i++ ) {
+		const vec_t *origin = s_ent_spatialization[ents[i]].origin;
+		x[i] = origin[0] - listenerOrigin[0];
+		y[i] = origin[1] - listenerOrigin[1];
+		z[i] = origin[2] - listenerOrigin[2];
+	}
+
+	for( i = 0; i < numEnts; i++ ) {
+		vec_t fx = listenerAxis[0] * x[i] + listenerAxis[1] * y[i] + listenerAxis[2] * z[i];
+		vec_t fy = listenerAxis[3] * x[i] + listenerAxis[4] * y[i] + listenerAxis[5] * z[i];
+		vec_t fz = listenerAxis[6] * x[i] + listenerAxis[7] * y[i] + listenerAxis[8] * z[i];
+		vec_t length = fx * fx + fy * fy + fz * fz;
+		vec_t ilength = 0;
+
+		if( length ) {
+			length = sqrt( length );
+			ilength = 1.0 / length;
+		}
+
+		x[i] = fx * ilength;
+		y[i] = fy * ilength;
+		z[i] = fz * ilength;
+		s_ent_listener.dist[ents[i]] = length;
+	}
+
+	for( i = 0; i < numEnts; i++ ) {
+		entnum = ents[i];
+		s_ent_listener.forward[entnum] = x[i];
+		s_ent_listener.right[entnum] = y[i];
+		s_ent_listener.up[entnum] = z[i];
+	}
+}
+
+/*
+* S_EntityListenerDirection
+*
+* Returns the distance to the entity and stores its direction in listener space.
+*/
+static vec_t S_EntityListenerDirection( int entnum, vec3_t dir ) {
+	if( entnum < 0 || entnum >= MAX_EDICTS ) {
+		VectorClear( dir );
+		return 0;
+	}
+
+	if( s_ent_listener.entframe[entnum] != s_ent_listener.frame ) {
+		// a sound started since the last update or the entity has moved
+		s_ent_listener.dist[entnum] = S_ListenerDirection( s_ent_spatialization[entnum].origin, dir );
+		s_ent_listener.forward[entnum] = dir[0];
+		s_ent_listener.right[entnum] = dir[1];
+		s_ent_listener.up[entnum] = dir[2];
+		s_ent_listener.entframe[entnum] = s_ent_listener.frame;
+		return s_ent_listener.dist[entnum];
+	}
+
+	dir[0] = s_ent_listener.forward[entnum];
+	dir[1] = s_ent_listener.right[entnum];
+	dir[2] = s_ent_listener.up[entnum];
+	return s_ent_listener.dist[entnum];
+}
+
+/*
+* S_SpatializeDirection
+*/
+static void S_SpatializeDirection( vec_t dist, const vec3_t dir, float master_vol, float dist_mult, int *left_vol, int *right_vol ) {
 	vec_t dot;
-	vec_t dist;
 	vec_t lscale, rscale, scale;
-	vec3_t source_vec;
 
 	// calculate stereo separation and distance attenuation
-	VectorSubtract( origin, listenerOrigin, source_vec );
-
-	dist = VectorNormalize( source_vec );
-
 	if( dma.channels == 1 || !dist_mult ) { // no attenuation = no spatialization
 		rscale = 1.0f;
 		lscale = 1.0f;
 	} else {
-#ifdef Q3STEREODIRECTION
-		vec3_t vec;
-		Matrix3_TransformVector( listenerAxis, source_vec, vec );
-		dot = vec[1];
-#else
-		dot = DotProduct( source_vec, listenerAxis[RIGHT] );
-#endif
+		dot = dir[1];
 		rscale = 0.5 * ( 1.0 + dot );
 		lscale = 0.5 * ( 1.0 - dot );
 		if( rscale < 0 ) {
@@ -311,22 +438,15 @@ static void S_SpatializeOrigin( const vec3_t origin, float master_vol, float dis
 }
 
 /*
-* S_SpatializeOriginHF
+* S_SpatializeDirectionHQ
 */
-static void S_SpatializeOriginHQ( const vec3_t origin, float master_vol, float dist_mult,
-								  int *left_vol, int *right_vol, int *lcoeff, int *rcoeff, unsigned int *ldelay, unsigned int *rdelay ) {
+static void S_SpatializeDirectionHQ( vec_t dist, const vec3_t source_vec, float master_vol, float dist_mult,
+									 int *left_vol, int *right_vol, int *lcoeff, int *rcoeff, unsigned int *ldelay, unsigned int *rdelay ) {
 	vec_t dot;
-	vec_t dist;
 	vec_t lscale, rscale, scale;
-	vec3_t vec, source_vec;
 	vec_t lgainhf, rgainhf;
 
 	// calculate stereo separation and distance attenuation
-	VectorSubtract( origin, listenerOrigin, vec );
-	Matrix3_TransformVector( listenerAxis, vec, source_vec );
-
-	dist = VectorNormalize( source_vec );
-
 	if( dma.channels == 1 || !dist_mult ) { // no attenuation = no spatialization
 		rscale = 1.0f;
 		lscale = 1.0f;
@@ -412,21 +532,20 @@ static void S_SpatializeOriginHQ( const vec3_t origin, float master_vol, float d
 * S_Spatialize
 */
 static void S_SpatializeChannel( channel_t *ch ) {
-	vec3_t origin, velocity;
+	vec_t dist;
+	vec3_t dir;
 
 	if( ch->fixed_origin ) {
-		VectorCopy( ch->origin, origin );
-		VectorClear( velocity );
+		dist = S_ListenerDirection( ch->origin, dir );
 	} else {
-		VectorCopy( s_ent_spatialization[ch->entnum].origin, origin );
-		VectorCopy( s_ent_spatialization[ch->entnum].velocity, velocity );
+		dist = S_EntityListenerDirection( ch->entnum, dir );
 	}
 
 	if( s_pseudoAcoustics->value ) {
-		S_SpatializeOriginHQ( origin, ch->master_vol, ch->dist_mult, &ch->leftvol, &ch->rightvol,
-							  &ch->lpf_lcoeff, &ch->lpf_rcoeff, &ch->ldelay, &ch->rdelay );
+		S_SpatializeDirectionHQ( dist, dir, ch->master_vol, ch->dist_mult, &ch->leftvol, &ch->rightvol,
+								 &ch->lpf_lcoeff, &ch->lpf_rcoeff, &ch->ldelay, &ch->rdelay );
 	} else {
-		S_SpatializeOrigin( origin, ch->master_vol, ch->dist_mult, &ch->leftvol, &ch->rightvol );
+		S_SpatializeDirection( dist, dir, ch->master_vol, ch->dist_mult, &ch->leftvol, &ch->rightvol );
 		ch->lpf_lcoeff = ch->lpf_rcoeff = 0.0f;
 		ch->ldelay = ch->rdelay = 0;
 	}
@@ -441,6 +560,7 @@ void S_SetEntitySpatialization( int entnum, const vec3_t origin, const vec3_t ve
 	}
 	VectorCopy( origin, s_ent_spatialization[entnum].origin );
 	VectorCopy( velocity, s_ent_spatialization[entnum].velocity );
+	s_ent_listener.entframe[entnum] = 0;
 }
 
 /*
@@ -677,12 +797,13 @@ void S_AddLoopSound( sfx_t *sfx, int entnum, float fvol, float attenuation ) {
 }
 
 /*
-* S_LoopSoundOrigin
+* S_SpatializeLoopSound
 */
-static const vec_t *S_LoopSoundOrigin( loopsfx_t *loopsfx ) {
-	int entnum = loopsfx->entnum;
-	return entnum < 0 || entnum >= MAX_EDICTS ? listenerOrigin :
-		   s_ent_spatialization[entnum].origin;
+static void S_SpatializeLoopSound( const loopsfx_t *loopsfx, float master_vol, float dist_mult, int *left_vol, int *right_vol ) {
+	vec3_t dir;
+	vec_t dist = S_EntityListenerDirection( loopsfx->entnum, dir );
+
+	S_SpatializeDirection( dist, dir, master_vol, dist_mult, left_vol, right_vol );
 }
 
 /*
@@ -708,8 +829,7 @@ static void S_AddLoopSounds( void ) {
 
 		// find the total contribution of all sounds of this type
 		if( loop_sfx[i].attenuation ) {
-			S_SpatializeOrigin( S_LoopSoundOrigin( &loop_sfx[i] ),
-								loop_sfx[i].volume, loop_sfx[i].attenuation, &left_total, &right_total );
+			S_SpatializeLoopSound( &loop_sfx[i], loop_sfx[i].volume, loop_sfx[i].attenuation, &left_total, &right_total );
 
 			for( j = i + 1; j < num_loopsfx; j++ ) {
 				if( loop_sfx[j].sfx != loop_sfx[i].sfx ) {
@@ -722,8 +842,7 @@ static void S_AddLoopSounds( void ) {
 
 				loop_sfx[j].sfx = NULL; // don't check this again later
 
-				S_SpatializeOrigin( S_LoopSoundOrigin( &loop_sfx[j] ),
-									loop_sfx[i].volume, loop_sfx[i].attenuation, &left, &right );
+				S_SpatializeLoopSound( &loop_sfx[j], loop_sfx[i].volume, loop_sfx[i].attenuation, &left, &right );
 				left_total += left;
 				right_total += right;
 			}
@@ -1055,8 +1174,10 @@ static void S_SpatializeRawSounds( void ) {
 
 		// spatialization
 		if( rawsound->attenuation && rawsound->entnum >= 0 && rawsound->entnum < MAX_EDICTS ) {
-			S_SpatializeOrigin( s_ent_spatialization[rawsound->entnum].origin,
-								rawsound->volume, rawsound->attenuation, &left, &right );
+			vec3_t dir;
+			vec_t dist = S_EntityListenerDirection( rawsound->entnum, dir );
+
+			S_SpatializeDirection( dist, dir, rawsound->volume, rawsound->attenuation, &left, &right );
 		} else {
 			left = right = rawsound->volume;
 		}
@@ -1164,6 +1285,8 @@ static void S_Spatialize( void ) {
 
 	S_FreeIdleRawSounds();
 
+	S_SpatializeEntities();
+
 	// update spatialization for dynamic sounds
 	ch = channels;
 	for( i = 0; i < MAX_CHANNELS; i++, ch++ ) {
@@ -1357,10 +1480,7 @@ static unsigned S_HandleFreeSfxCmd( const sndCmdFreeSfx_t *cmd ) {
 	sfx_t *sfx;
 	//Com_Printf("S_HandleFreeSfxCmd\n");
 	sfx = known_sfx + cmd->sfx;
-	if( sfx->cache ) {
-		S_Free( sfx->cache );
-		sfx->cache = NULL;
-	}
+	S_FreeSound( sfx );
 	return sizeof( *cmd );
 }
 
@@ -1563,17 +1683,6 @@ static unsigned S_HandleStuffCmd( const sndStuffCmd_t *cmd ) {
 	return sizeof( *cmd );
 }
 
-/*
-* S_HandleSetMulEntitySpatializationCmd
-*/
-static unsigned S_HandleSetMulEntitySpatializationCmd( const sndCmdSetMulEntitySpatialization_t *cmd ) {
-	unsigned i;
-	//Com_Printf("S_HandleSetEntitySpatializationCmd\n");
-	for( i = 0; i < cmd->numents; i++ )
-		S_SetEntitySpatialization( cmd->entnum[i], cmd->origin[i], cmd->velocity[i] );
-	return sizeof( *cmd );
-}
-
 static pipeCmdHandler_t sndCmdHandlers[SND_CMD_NUM_CMDS] =
 {
 	/* SND_CMD_INIT */
@@ -1624,8 +1733,6 @@ static pipeCmdHandler_t sndCmdHandlers[SND_CMD_NUM_CMDS] =
 	(pipeCmdHandler_t)S_HandlePositionedRawSamplesCmd,
 	/* SND_CMD_STUFFCMD */
 	(pipeCmdHandler_t)S_HandleStuffCmd,
-	/* SND_CMD_SET_MUL_ENTITY_SPATIALIZATION */
-	(pipeCmdHandler_t)S_HandleSetMulEntitySpatializationCmd,
 };
 
 /*
@@ -1642,6 +1749,7 @@ static int S_EnqueuedCmdsWaiter( sndCmdPipe_t *queue, pipeCmdHandler_t *cmdHandl
 
 	if( timeout || now >= s_last_update_time + UPDATE_MSEC ) {
 		s_last_update_time = now;
+		S_ReadSoundCmdBatch( s_cmdBatches, cmdHandlers );
 		S_Update();
 	}
 
@@ -32,7 +32,7 @@ typedef struct { char *name; void **funcPointer; } dllfunc_t;
 #include "../client/snd_public.h"
 #include "snd_syscalls.h"
 
-// !!! if this is changed, the asm code must change !!!
+// !!! if this is changed, the mixing kernels in snd_mixkernels.c must change !!!
 typedef struct {
 	int left;
 	int right;
@@ -47,11 +47,44 @@ typedef struct {
 	uint8_t data[1];          // variable sized
 } sfxcache_t;
 
+#define S_STREAM_PREFIX     256     // sample frames of the previous chunk decoded along with each chunk
+
+enum {
+	SFXCHUNK_EMPTY,
+	SFXCHUNK_QUEUED,
+	SFXCHUNK_READY
+};
+
+typedef struct {
+	volatile int state;     // only changed and checked with trap_Atomic_CAS, see snd_cache.c
+	int64_t lastUsed;
+	uint8_t *data;          // S_STREAM_PREFIX sample frames, except for the first chunk, then the chunk's own
+} sfxchunk_t;
+
+// long sounds are decoded in chunks on demand, see snd_cache.c
+typedef struct sfxstream_s {
+	struct sfx_s *sfx;
+	bool ogg;
+	int rate;               // of the source samples
+	int samples;            // number of source sample frames
+	unsigned short channels;
+	unsigned short width;
+	int dataofs;            // .wav samples start this many bytes from file start
+	unsigned int speed;     // of the resampled sound
+	unsigned int fracstep;
+	unsigned int frameSize;
+	unsigned int length;    // resampled sample frames
+	unsigned int chunkLength;
+	int numChunks;
+	sfxchunk_t *chunks;
+} sfxstream_t;
+
 typedef struct sfx_s {
 	char name[MAX_QPATH];
 	int registration_sequence;
 	bool isUrl;
 	sfxcache_t *cache;
+	sfxstream_t *stream;    // set if the samples in cache aren't resident
 } sfx_t;
 
 typedef struct {
@@ -115,6 +148,9 @@ typedef struct {
 	unsigned int ldelay;    // invidual ear delay offset for both channels
 	unsigned int rdelay;
 	rawsound_t *rawsamples; // got no static sfx, read samples directly
+	bool mixed;             // the mix volumes are valid
+	int mixleftvol;         // paint volumes of the last mixed samples, ramped
+	int mixrightvol;        // towards the current ones to avoid clicks
 } channel_t;
 
 typedef struct {
@@ -199,6 +235,9 @@ void    SNDOGG_Init( bool verbose );
 void    SNDOGG_Shutdown( bool verbose );
 bool SNDOGG_OpenTrack( bgTrack_t *track, bool *delay );
 sfxcache_t *SNDOGG_Load( sfx_t *s );
+void *SNDOGG_OpenStream( const char *name );
+bool SNDOGG_ReadStream( void *vorbisFile, unsigned int first, unsigned int samples, int channels, uint8_t *out );
+void SNDOGG_CloseStream( void *vorbisFile );
 
 //====================================================================
 
@@ -237,6 +276,8 @@ extern cvar_t *s_swapstereo;
 extern cvar_t *s_pseudoAcoustics;
 extern cvar_t *s_separationDelay;
 extern cvar_t *s_globalfocus;
+extern cvar_t *s_streamcache;
+extern cvar_t *s_streamthreshold;
 
 extern struct mempool_s *soundpool;
 
@@ -256,6 +297,15 @@ void S_InitScaletable( void );
 
 sfxcache_t *S_LoadSound( sfx_t *s );
 
+void S_InitSoundCache( void );
+void S_ShutdownSoundCache( void );
+bool S_StreamSound( const wavinfo_t *info );
+sfxcache_t *S_LoadSoundStream( sfx_t *s, const wavinfo_t *info, bool ogg );
+const uint8_t *S_GetSoundSamples( sfx_t *sfx, const sfxcache_t *sc, unsigned int pos, unsigned int *count );
+void S_FreeSound( sfx_t *sfx );
+int S_SoundResidentSize( const sfx_t *sfx );
+void S_SoundCacheList( void );
+
 void S_IssuePlaysound( playsound_t *ps );
 
 int S_PaintChannels( unsigned int endtime, int dumpfile, float gain );
@@ -22,17 +22,13 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "snd_cmdque.h"
 
 static sndCmdPipe_t *s_cmdPipe;
+sndCmdBatchQueue_t *s_cmdBatches;
 
 static struct qthread_s *s_backThread;
 
 static int s_registration_sequence;
 static bool s_registering;
 
-// batch entity spatializations
-static unsigned s_num_ent_spats;
-static smdCmdSpatialization_t s_ent_spats[SND_SPATIALIZE_ENTS_MAX];
-static const unsigned s_max_ent_spats = sizeof( s_ent_spats ) / sizeof( s_ent_spats[0] );
-
 struct mempool_s *soundpool;
 
 cvar_t *developer;
@@ -47,6 +43,8 @@ cvar_t *s_swapstereo;
 cvar_t *s_pseudoAcoustics;
 cvar_t *s_separationDelay;
 cvar_t *s_globalfocus;
+cvar_t *s_streamcache;
+cvar_t *s_streamthreshold;
 
 sfx_t known_sfx[MAX_SFX];
 int num_sfx;
@@ -220,7 +218,7 @@ void SF_FreeSounds( void ) {
 		if( !sfx->name[0] ) {
 			continue;
 		}
-		S_Free( sfx->cache );
+		S_FreeSound( sfx );
 		memset( sfx, 0, sizeof( *sfx ) );
 	}
 }
@@ -244,7 +242,7 @@ void SF_EndRegistration( void ) {
 		}
 		if( sfx->registration_sequence != s_registration_sequence ) {
 			// we don't need this sound
-			S_Free( sfx->cache );
+			S_FreeSound( sfx );
 			memset( sfx, 0, sizeof( *sfx ) );
 		}
 	}
@@ -268,6 +266,8 @@ bool SF_Init( void *hwnd, int maxEntities, bool verbose ) {
 	s_pseudoAcoustics = trap_Cvar_Get( "s_pseudoAcoustics", "0", CVAR_ARCHIVE );
 	s_separationDelay = trap_Cvar_Get( "s_separationDelay", "1.0", CVAR_ARCHIVE );
 	s_globalfocus = trap_Cvar_Get( "s_globalfocus", "0", CVAR_ARCHIVE );
+	s_streamcache = trap_Cvar_Get( "s_streamcache", "8", CVAR_ARCHIVE );
+	s_streamthreshold = trap_Cvar_Get( "s_streamthreshold", "5", CVAR_ARCHIVE | CVAR_LATCH_SOUND );
 
 #ifdef ENABLE_PLAY
 	trap_Cmd_AddCommand( "play", SF_Play_f );
@@ -283,8 +283,6 @@ bool SF_Init( void *hwnd, int maxEntities, bool verbose ) {
 
 	num_sfx = 0;
 
-	s_num_ent_spats = 0;
-
 	s_registration_sequence = 1;
 	s_registering = false;
 
@@ -293,6 +291,10 @@ bool SF_Init( void *hwnd, int maxEntities, bool verbose ) {
 		return false;
 	}
 
+	s_cmdBatches = S_CreateSoundCmdBatches();
+
+	S_InitSoundCache();
+
 	s_backThread = trap_Thread_Create( S_BackgroundUpdateProc, s_cmdPipe );
 
 	S_IssueInitCmd( s_cmdPipe, hwnd, maxEntities, verbose );
@@ -338,6 +340,10 @@ void SF_Shutdown( bool verbose ) {
 
 	S_DestroySoundCmdPipe( &s_cmdPipe );
 
+	S_DestroySoundCmdBatches( &s_cmdBatches );
+
+	S_ShutdownSoundCache();
+
 #ifdef ENABLE_PLAY
 	trap_Cmd_RemoveCommand( "play" );
 #endif
@@ -392,6 +398,7 @@ void SF_LockBackgroundTrack( bool lock ) {
 * SF_StopAllSounds
 */
 void SF_StopAllSounds( bool clear, bool stopMusic ) {
+	S_DiscardSoundCmdBatches( s_cmdBatches );
 	S_IssueStopAllSoundsCmd( s_cmdPipe, clear, stopMusic );
 }
 
@@ -441,18 +448,13 @@ void SF_SetAttenuationModel( int model, float maxdistance, float refdistance ) {
 * SF_SetEntitySpatialization
 */
 void SF_SetEntitySpatialization( int entnum, const vec3_t origin, const vec3_t velocity ) {
-	smdCmdSpatialization_t *spat;
+	smdCmdSpatialization_t spat;
 
-	if( s_num_ent_spats == s_max_ent_spats ) {
-		// flush all spatializations at once to free room
-		S_IssueSetMulEntitySpatializationCmd( s_cmdPipe, s_num_ent_spats, s_ent_spats );
-		s_num_ent_spats = 0;
-	}
+	spat.entnum = entnum;
+	VectorCopy( origin, spat.origin );
+	VectorCopy( velocity, spat.velocity );
 
-	spat = &s_ent_spats[s_num_ent_spats++];
-	spat->entnum = entnum;
-	VectorCopy( origin, spat->origin );
-	VectorCopy( velocity, spat->velocity );
+	S_IssueSetEntitySpatializationCmd( s_cmdBatches, &spat );
 }
 
 /*
@@ -460,7 +462,7 @@ void SF_SetEntitySpatialization( int entnum, const vec3_t origin, const vec3_t v
 */
 void SF_StartFixedSound( sfx_t *sfx, const vec3_t origin, int channel, float fvol, float attenuation ) {
 	if( sfx != NULL ) {
-		S_IssueStartFixedSoundCmd( s_cmdPipe, sfx - known_sfx, origin, channel, fvol, attenuation );
+		S_IssueStartFixedSoundCmd( s_cmdBatches, sfx - known_sfx, origin, channel, fvol, attenuation );
 	}
 }
 
@@ -469,7 +471,7 @@ void SF_StartFixedSound( sfx_t *sfx, const vec3_t origin, int channel, float fvo
 */
 void SF_StartRelativeSound( sfx_t *sfx, int entnum, int channel, float fvol, float attenuation ) {
 	if( sfx != NULL ) {
-		S_IssueStartRelativeSoundCmd( s_cmdPipe, sfx - known_sfx, entnum, channel, fvol, attenuation );
+		S_IssueStartRelativeSoundCmd( s_cmdBatches, sfx - known_sfx, entnum, channel, fvol, attenuation );
 	}
 }
 
@@ -478,7 +480,7 @@ void SF_StartRelativeSound( sfx_t *sfx, int entnum, int channel, float fvol, flo
 */
 void SF_StartGlobalSound( sfx_t *sfx, int channel, float fvol ) {
 	if( sfx != NULL ) {
-		S_IssueStartGlobalSoundCmd( s_cmdPipe, sfx - known_sfx, channel, fvol );
+		S_IssueStartGlobalSoundCmd( s_cmdBatches, sfx - known_sfx, channel, fvol );
 	}
 }
 
@@ -487,7 +489,7 @@ void SF_StartGlobalSound( sfx_t *sfx, int channel, float fvol ) {
 */
 void SF_StartLocalSound( sfx_t *sfx, int channel, float fvol ) {
 	if( sfx != NULL ) {
-		S_IssueStartLocalSoundCmd( s_cmdPipe, sfx - known_sfx, channel, fvol );
+		S_IssueStartLocalSoundCmd( s_cmdBatches, sfx - known_sfx, channel, fvol );
 	}
 }
 
@@ -495,6 +497,7 @@ void SF_StartLocalSound( sfx_t *sfx, int channel, float fvol ) {
 * SF_Clear
 */
 void SF_Clear( void ) {
+	S_DiscardSoundCmdBatches( s_cmdBatches );
 	S_IssueClearCmd( s_cmdPipe );
 }
 
@@ -503,7 +506,7 @@ void SF_Clear( void ) {
 */
 void SF_AddLoopSound( sfx_t *sfx, int entnum, float fvol, float attenuation ) {
 	if( sfx != NULL ) {
-		S_IssueAddLoopSoundCmd( s_cmdPipe, sfx - known_sfx, entnum, fvol, attenuation );
+		S_IssueAddLoopSoundCmd( s_cmdBatches, sfx - known_sfx, entnum, fvol, attenuation );
 	}
 }
 
@@ -511,12 +514,9 @@ void SF_AddLoopSound( sfx_t *sfx, int entnum, float fvol, float attenuation ) {
 * SF_Update
 */
 void SF_Update( const vec3_t origin, const vec3_t velocity, const mat3_t axis, bool avidump ) {
-	if( s_num_ent_spats ) {
-		S_IssueSetMulEntitySpatializationCmd( s_cmdPipe, s_num_ent_spats, s_ent_spats );
-		s_num_ent_spats = 0;
-	}
+	S_IssueSetListenerCmd( s_cmdBatches, origin, velocity, axis, avidump );
 
-	S_IssueSetListenerCmd( s_cmdPipe, origin, velocity, axis, avidump );
+	S_PublishSoundCmdBatch( s_cmdBatches );
 }
 
 /*
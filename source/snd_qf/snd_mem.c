@@ -209,6 +209,11 @@ sfxcache_t *S_LoadSound_Wav( sfx_t *s ) {
 		return NULL;
 	}
 
+	if( S_StreamSound( &info ) ) {
+		S_Free( data );
+		return S_LoadSoundStream( s, &info, false );
+	}
+
 	// calculate resampled length
 	len = (int) ( (double) info.samples * (double) dma.speed / (double) info.rate );
 	len = len * info.width * info.channels;
@@ -21,204 +21,37 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 #include "snd_local.h"
 
+#include "snd_mixkernels.h"
+
 #define PAINTBUFFER_SIZE    2048
+#define MIX_RAMP_FRAMES     128     // volume changes are spread over this many sample frames
 static portable_samplepair_t paintbuffer[PAINTBUFFER_SIZE];
 static int snd_scaletable[32][256];
-static int *snd_p, snd_linear_count, snd_vol, music_vol;
-static short *snd_out;
-
-#if defined ( __arm__ ) && defined ( __GNUC__ )
-// 40-50% faster than the C version.
-// Uses signed saturation instruction (available since ARMv6 or Thumb2) instead of comparisons,
-// with the right shift being a part of the saturation instruction.
-
-static void S_WriteLinearBlastStereo16( void ) {
-	int i;
-	int val;
-
-	for( i = 0; i < snd_linear_count; i += 2 ) {
-		val = snd_p[i];
-		__asm__ ( "ssat %0, #16, %0, asr #8\n" : "+r" ( val ) );
-		snd_out[i] = val;
-
-		val = snd_p[i + 1];
-		__asm__ ( "ssat %0, #16, %0, asr #8\n" : "+r" ( val ) );
-		snd_out[i + 1] = val;
-	}
-}
-
-static void S_WriteSwappedLinearBlastStereo16( void ) {
-	int i;
-	int val;
-
-	for( i = 0; i < snd_linear_count; i += 2 ) {
-		val = snd_p[i + 1];
-		__asm__ ( "ssat %0, #16, %0, asr #8\n" : "+r" ( val ) );
-		snd_out[i] = val;
-
-		val = snd_p[i];
-		__asm__ ( "ssat %0, #16, %0, asr #8\n" : "+r" ( val ) );
-		snd_out[i + 1] = val;
-	}
-}
-#elif defined ( _MSC_VER ) && defined( id386 )
-static ATTRIBUTE_NAKED void S_WriteLinearBlastStereo16( void ) {
-	__asm {
-		push edi
-		push ebx
-		mov ecx, ds:dword ptr[snd_linear_count]
-		mov ebx, ds:dword ptr[snd_p]
-		mov edi, ds:dword ptr[snd_out]
-
-LWLBLoopTop:
-		mov eax, ds:dword ptr[-8 + ebx + ecx * 4]
-		sar eax, 8
-		cmp eax, 07FFFh
-		jg LClampHigh
-		cmp eax, 0FFFF8000h
-		jnl LClampDone
-		mov eax, 0FFFF8000h
-		jmp LClampDone
-
-LClampHigh:
-		mov eax, 07FFFh
-
-LClampDone:
-		mov edx, ds:dword ptr[-4 + ebx + ecx * 4]
-		sar edx, 8
-		cmp edx, 07FFFh
-		jg LClampHigh2
-		cmp edx, 0FFFF8000h
-		jnl LClampDone2
-		mov edx, 0FFFF8000h
-		jmp LClampDone2
-
-LClampHigh2:
-		mov edx, 07FFFh
-
-LClampDone2:
-		shl edx, 16
-		and eax, 0FFFFh
-		or edx, eax
-		mov ds:dword ptr[-4 + edi + ecx * 2], edx
-		sub ecx, 2
-		jnz LWLBLoopTop
-		pop ebx
-		pop edi
-		ret
-	}
-}
-
-static ATTRIBUTE_NAKED void S_WriteSwappedLinearBlastStereo16( void ) {
-	__asm {
-		push edi
-		push ebx
-		mov ecx, ds:dword ptr[snd_linear_count]
-		mov ebx, ds:dword ptr[snd_p]
-		mov edi, ds:dword ptr[snd_out]
-
-LWLBLoopTop:
-		mov eax, ds:dword ptr[-4 + ebx + ecx * 4]
-		sar eax, 8
-		cmp eax, 07FFFh
-		jg LClampHigh
-		cmp eax, 0FFFF8000h
-		jnl LClampDone
-		mov eax, 0FFFF8000h
-		jmp LClampDone
-
-LClampHigh:
-		mov eax, 07FFFh
-
-LClampDone:
-		mov edx, ds:dword ptr[-8 + ebx + ecx * 4]
-		sar edx, 8
-		cmp edx, 07FFFh
-		jg LClampHigh2
-		cmp edx, 0FFFF8000h
-		jnl LClampDone2
-		mov edx, 0FFFF8000h
-		jmp LClampDone2
-
-LClampHigh2:
-		mov edx, 07FFFh
-
-LClampDone2:
-		shl edx, 16
-		and eax, 0FFFFh
-		or edx, eax
-		mov ds:dword ptr[-4 + edi + ecx * 2], edx
-		sub ecx, 2
-		jnz LWLBLoopTop
-		pop ebx
-		pop edi
-		ret
-	}
-}
-#else
-#ifdef _MSC_VER
-#pragma warning( push )
-#pragma warning( disable : 4310 )       // cast truncates constant value
-#endif
-static void S_WriteLinearBlastStereo16( void ) {
-	int i;
-	int val;
-
-	for( i = 0; i < snd_linear_count; i += 2 ) {
-		val = snd_p[i] >> 8;
-		snd_out[i] = Q_bound( (short)0x8000, val, 0x7fff );
-
-		val = snd_p[i + 1] >> 8;
-		snd_out[i + 1] = Q_bound( (short)0x8000, val, 0x7fff );
-	}
-}
-
-static void S_WriteSwappedLinearBlastStereo16( void ) {
-	int i;
-	int val;
-
-	for( i = 0; i < snd_linear_count; i += 2 ) {
-		val = snd_p[i + 1] >> 8;
-		snd_out[i] = Q_bound( (short)0x8000, val, 0x7fff );
-
-		val = snd_p[i] >> 8;
-		snd_out[i + 1] = Q_bound( (short)0x8000, val, 0x7fff );
-	}
-#ifdef _MSC_VER
-#pragma warning( pop )
-#endif
-}
-#endif
+static int snd_vol, music_vol;
 
 static void S_TransferStereo16( unsigned int *pbuf, int endtime ) {
 	int lpos;
 	int lpaintedtime;
+	int count;
+	int *p;
 
-	snd_p = (int *) paintbuffer;
+	p = (int *) paintbuffer;
 	lpaintedtime = paintedtime;
 
 	while( lpaintedtime < endtime ) {
 		// handle recirculating buffer issues
 		lpos = lpaintedtime & ( ( dma.samples >> 1 ) - 1 );
 
-		snd_out = (short *) pbuf + ( lpos << 1 );
-
-		snd_linear_count = ( dma.samples >> 1 ) - lpos;
-		if( lpaintedtime + snd_linear_count > endtime ) {
-			snd_linear_count = endtime - lpaintedtime;
+		count = ( dma.samples >> 1 ) - lpos;
+		if( lpaintedtime + count > endtime ) {
+			count = endtime - lpaintedtime;
 		}
 
-		snd_linear_count <<= 1;
-
 		// write a linear blast of samples
-		if( s_swapstereo->integer ) {
-			S_WriteSwappedLinearBlastStereo16();
-		} else {
-			S_WriteLinearBlastStereo16();
-		}
+		S_ClipSamples( p, (short *) pbuf + ( lpos << 1 ), count, s_swapstereo->integer != 0 );
 
-		snd_p += snd_linear_count;
-		lpaintedtime += ( snd_linear_count >> 1 );
+		p += count << 1;
+		lpaintedtime += count;
 	}
 }
 
@@ -340,10 +173,10 @@ CHANNEL MIXING
 ===============================================================================
 */
 
-static void S_PaintChannelFrom8( channel_t *ch, sfxcache_t *sc, unsigned int endtime, int offset );
-static void S_PaintChannelFrom16( channel_t *ch, sfxcache_t *sc, unsigned int endtime, int offset );
-static void S_PaintChannelFrom8HQ( channel_t *ch, sfxcache_t *sc, unsigned int endtime, int offset );
-static void S_PaintChannelFrom16HQ( channel_t *ch, sfxcache_t *sc, unsigned int endtime, int offset );
+static void S_PaintChannelFrom8( channel_t *ch, sfxcache_t *sc, const uint8_t *data, unsigned int count, int offset );
+static void S_PaintChannelFrom16( channel_t *ch, sfxcache_t *sc, const uint8_t *data, unsigned int count, int offset );
+static void S_PaintChannelFrom8HQ( channel_t *ch, sfxcache_t *sc, const uint8_t *data, unsigned int count, int offset );
+static void S_PaintChannelFrom16HQ( channel_t *ch, sfxcache_t *sc, const uint8_t *data, unsigned int count, int offset );
 
 int S_PaintChannels( unsigned int endtime, int dumpfile, float gain ) {
 	unsigned int i;
@@ -437,17 +270,28 @@ int S_PaintChannels( unsigned int endtime, int dumpfile, float gain ) {
 				}
 
 				if( count > 0 && ch->sfx ) {
-					if( s_pseudoAcoustics->value ) {
+					// streamed sounds are painted a chunk at a time
+					const uint8_t *data = S_GetSoundSamples( ch->sfx, sc, ch->pos, &count );
+
+					if( !data ) {
+						// the chunk is still being decoded, hold the channel back
+						ch->end += count;
+					} else if( s_pseudoAcoustics->value ) {
+						if( ch->sfx->stream ) {
+							// the ear delay can't go further back than the decoded prefix
+							ch->ldelay = min( ch->ldelay, S_STREAM_PREFIX );
+							ch->rdelay = min( ch->rdelay, S_STREAM_PREFIX );
+						}
 						if( sc->width == 1 ) {
-							S_PaintChannelFrom8HQ( ch, sc, count, ltime - paintedtime );
+							S_PaintChannelFrom8HQ( ch, sc, data, count, ltime - paintedtime );
 						} else {
-							S_PaintChannelFrom16HQ( ch, sc, count, ltime - paintedtime );
+							S_PaintChannelFrom16HQ( ch, sc, data, count, ltime - paintedtime );
 						}
 					} else {
 						if( sc->width == 1 ) {
-							S_PaintChannelFrom8( ch, sc, count, ltime - paintedtime );
+							S_PaintChannelFrom8( ch, sc, data, count, ltime - paintedtime );
 						} else {
-							S_PaintChannelFrom16( ch, sc, count, ltime - paintedtime );
+							S_PaintChannelFrom16( ch, sc, data, count, ltime - paintedtime );
 						}
 					}
 					ltime += count;
@@ -494,13 +338,69 @@ void S_InitScaletable( void ) {
 	}
 }
 
-static void S_PaintChannelFrom8( channel_t *ch, sfxcache_t *sc, unsigned int count, int offset ) {
-	unsigned int i;
-	int j;
-	int *lscale, *rscale;
-	unsigned char *sfx;
-	portable_samplepair_t *samp;
+/*
+* S_PaintChannelSamples
+*
+* Paint volumes scale the 16-bit samples by 1/256th, see snd_mixkernels.h.
+* Volume changes are ramped over MIX_RAMP_FRAMES sample frames.
+*/
+static void S_PaintChannelSamples( channel_t *ch, sfxcache_t *sc, const uint8_t *data, unsigned int count, int offset,
+								   int leftvol, int rightvol ) {
+	unsigned int ramped = 0;
+	int *paint = (int *)&paintbuffer[offset];
+	sndMixRamp_t ramp;
+
+	leftvol = Q_bound( 0, leftvol, S_MIX_MAX_VOLUME );
+	rightvol = Q_bound( 0, rightvol, S_MIX_MAX_VOLUME );
+
+	if( !ch->mixed ) {
+		// don't fade in new sounds
+		ch->mixed = true;
+		ch->mixleftvol = leftvol;
+		ch->mixrightvol = rightvol;
+	}
+
+	if( ch->mixleftvol != leftvol || ch->mixrightvol != rightvol ) {
+		ramped = min( count, MIX_RAMP_FRAMES );
+		ramp.left = ch->mixleftvol << 8;
+		ramp.right = ch->mixrightvol << 8;
+		ramp.leftStep = ( ( leftvol - ch->mixleftvol ) << 8 ) / MIX_RAMP_FRAMES;
+		ramp.rightStep = ( ( rightvol - ch->mixrightvol ) << 8 ) / MIX_RAMP_FRAMES;
+		S_MixSamples( paint, data, ramped, sc->width, sc->channels, &ramp );
+
+		if( ramped < MIX_RAMP_FRAMES ) {
+			// continue from here next time
+			ch->mixleftvol = ( ramp.left + (int)ramped * ramp.leftStep ) >> 8;
+			ch->mixrightvol = ( ramp.right + (int)ramped * ramp.rightStep ) >> 8;
+		} else {
+			ch->mixleftvol = leftvol;
+			ch->mixrightvol = rightvol;
+		}
+	}
+
+	if( ramped < count ) {
+		ramp.left = leftvol << 8;
+		ramp.right = rightvol << 8;
+		ramp.leftStep = ramp.rightStep = 0;
+		S_MixSamples( paint + ramped * 2, data + ramped * sc->channels * sc->width, count - ramped,
+					  sc->width, sc->channels, &ramp );
+	}
+
+	ch->pos += count;
+}
 
+/*
+* S_SetChannelMixVolumes
+*
+* For the paths that mix at constant volumes.
+*/
+static void S_SetChannelMixVolumes( channel_t *ch, int leftvol, int rightvol ) {
+	ch->mixed = true;
+	ch->mixleftvol = Q_bound( 0, leftvol, S_MIX_MAX_VOLUME );
+	ch->mixrightvol = Q_bound( 0, rightvol, S_MIX_MAX_VOLUME );
+}
+
+static void S_PaintChannelFrom8( channel_t *ch, sfxcache_t *sc, const uint8_t *data, unsigned int count, int offset ) {
 	if( ch->leftvol > 255 ) {
 		ch->leftvol = 255;
 	}
@@ -513,69 +413,20 @@ static void S_PaintChannelFrom8( channel_t *ch, sfxcache_t *sc, unsigned int cou
 		return;
 	}
 
-	lscale = snd_scaletable[ch->leftvol >> 3];
-	rscale = snd_scaletable[ch->rightvol >> 3];
-
-	samp = &paintbuffer[offset];
-
-	if( sc->channels == 2 ) {
-		sfx = (unsigned char *)sc->data + ch->pos * 2;
-
-		for( i = 0; i < count; i++, samp++ ) {
-			samp->left += lscale[*sfx++];
-			samp->right += rscale[*sfx++];
-		}
-	} else {
-		sfx = (unsigned char *)sc->data + ch->pos;
-
-		for( i = 0; i < count; i++, samp++ ) {
-			j = *sfx++;
-			samp->left += lscale[j];
-			samp->right += rscale[j];
-		}
-	}
-
-	ch->pos += count;
+	// the scale tables hold the samples multiplied by the paint volume
+	S_PaintChannelSamples( ch, sc, data, count, offset, snd_scaletable[ch->leftvol >> 3][1], snd_scaletable[ch->rightvol >> 3][1] );
 }
 
-static void S_PaintChannelFrom16( channel_t *ch, sfxcache_t *sc, unsigned int count, int offset ) {
-	unsigned int i;
-	int j;
-	int leftvol, rightvol;
-	signed short *sfx;
-	portable_samplepair_t *samp;
-
+static void S_PaintChannelFrom16( channel_t *ch, sfxcache_t *sc, const uint8_t *data, unsigned int count, int offset ) {
 	if( !snd_vol ) {
 		ch->pos += count;
 		return;
 	}
 
-	leftvol = ch->leftvol * snd_vol;
-	rightvol = ch->rightvol * snd_vol;
-
-	samp = &paintbuffer[offset];
-
-	if( sc->channels == 2 ) {
-		sfx = (signed short *)sc->data + ch->pos * 2;
-
-		for( i = 0; i < count; i++, samp++ ) {
-			samp->left += ( *sfx++ *leftvol ) >> 8;
-			samp->right += ( *sfx++ *rightvol ) >> 8;
-		}
-	} else {
-		sfx = (signed short *)sc->data + ch->pos;
-
-		for( i = 0; i < count; i++, samp++ ) {
-			j = *sfx++;
-			samp->left += ( j * leftvol ) >> 8;
-			samp->right += ( j * rightvol ) >> 8;
-		}
-	}
-
-	ch->pos += count;
+	S_PaintChannelSamples( ch, sc, data, count, offset, ch->leftvol * snd_vol, ch->rightvol * snd_vol );
 }
 
-static void S_PaintChannelFrom8HQ( channel_t *ch, sfxcache_t *sc, unsigned int count, int offset ) {
+static void S_PaintChannelFrom8HQ( channel_t *ch, sfxcache_t *sc, const uint8_t *data, unsigned int count, int offset ) {
 	unsigned int i;
 	int j, k;
 	int *lscale, *rscale;
@@ -597,17 +448,14 @@ static void S_PaintChannelFrom8HQ( channel_t *ch, sfxcache_t *sc, unsigned int c
 	lscale = snd_scaletable[ch->leftvol >> 3];
 	rscale = snd_scaletable[ch->rightvol >> 3];
 
-	samp = &paintbuffer[offset];
-
 	if( sc->channels == 2 ) {
-		sfx = (unsigned char *)sc->data + ch->pos * 2;
-
-		for( i = 0; i < count; i++, samp++ ) {
-			samp->left += lscale[*sfx++];
-			samp->right += rscale[*sfx++];
-		}
+		S_PaintChannelSamples( ch, sc, data, count, offset, lscale[1], rscale[1] );
+		return;
 	} else {
-		sfx = (unsigned char *)sc->data + ch->pos;
+		S_SetChannelMixVolumes( ch, lscale[1], rscale[1] );
+
+		samp = &paintbuffer[offset];
+		sfx = (unsigned char *)data;
 
 		// initialize our counter here
 		i = 0;
@@ -646,7 +494,7 @@ static void S_PaintChannelFrom8HQ( channel_t *ch, sfxcache_t *sc, unsigned int c
 	ch->pos += count;
 }
 
-static void S_PaintChannelFrom16HQ( channel_t *ch, sfxcache_t *sc, unsigned int count, int offset ) {
+static void S_PaintChannelFrom16HQ( channel_t *ch, sfxcache_t *sc, const uint8_t *data, unsigned int count, int offset ) {
 	unsigned int i;
 	int j, k;
 	int leftvol, rightvol;
@@ -661,17 +509,14 @@ static void S_PaintChannelFrom16HQ( channel_t *ch, sfxcache_t *sc, unsigned int
 	leftvol = ch->leftvol * snd_vol;
 	rightvol = ch->rightvol * snd_vol;
 
-	samp = &paintbuffer[offset];
-
 	if( sc->channels == 2 ) {
-		sfx = (signed short *)sc->data + ch->pos * 2;
-
-		for( i = 0; i < count; i++, samp++ ) {
-			samp->left += ( *sfx++ *leftvol ) >> 8;
-			samp->right += ( *sfx++ *rightvol ) >> 8;
-		}
+		S_PaintChannelSamples( ch, sc, data, count, offset, leftvol, rightvol );
+		return;
 	} else {
-		sfx = (signed short *)sc->data + ch->pos;
+		S_SetChannelMixVolumes( ch, leftvol, rightvol );
+
+		samp = &paintbuffer[offset];
+		sfx = (signed short *)data;
 
 		// initialize our counter here
 		i = 0;
@@ -0,0 +1,293 @@
+/*
+Copyright (C) 2018 Warsow development team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+#include "../gameshared/q_arch.h"
+#include "snd_mixkernels.h"
+
+#if defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && ( _M_IX86_FP >= 2 ) )
+#define S_MIX_SSE2
+#include <emmintrin.h>
+#elif defined( __ARM_NEON ) || defined( __ARM_NEON__ )
+#define S_MIX_NEON
+#include <arm_neon.h>
+#endif
+
+/*
+* S_MixArch
+*/
+const char *S_MixArch( void ) {
+#if defined( S_MIX_SSE2 )
+	return "SSE2";
+#elif defined( S_MIX_NEON )
+	return "NEON";
+#else
+	return "generic";
+#endif
+}
+
+/*
+* S_LoadSample
+*/
+static inline int S_LoadSample( const void *samples, int index, int width ) {
+	if( width == 1 ) {
+		return ( (const signed char *)samples )[index] * 256;
+	}
+	return ( (const short *)samples )[index];
+}
+
+/*
+* S_MixSpan_Generic
+*
+* Mixes sample frames [first, count)
+*/
+static void S_MixSpan_Generic( int *paint, const void *samples, int first, int count, int width, int channels,
+							   const sndMixRamp_t *ramp ) {
+	int i, l, r;
+	int left = ramp->left + first * ramp->leftStep;
+	int right = ramp->right + first * ramp->rightStep;
+
+	for( i = first; i < count; i++ ) {
+		if( channels == 2 ) {
+			l = S_LoadSample( samples, i * 2, width );
+			r = S_LoadSample( samples, i * 2 + 1, width );
+		} else {
+			l = r = S_LoadSample( samples, i, width );
+		}
+
+		paint[i * 2] += ( l * ( left >> 8 ) ) >> 8;
+		paint[i * 2 + 1] += ( r * ( right >> 8 ) ) >> 8;
+		left += ramp->leftStep;
+		right += ramp->rightStep;
+	}
+}
+
+#if defined( S_MIX_SSE2 )
+/*
+* S_LoadFrames_SSE2
+*
+* Returns 4 sample frames as interleaved 16-bit left and right samples
+*/
+static inline __m128i S_LoadFrames_SSE2( const void *samples, int i, int width, int channels ) {
+	const __m128i zero = _mm_setzero_si128();
+	__m128i s;
+	int word;
+
+	if( width == 2 ) {
+		const short *in = (const short *)samples + i * channels;
+		if( channels == 2 ) {
+			return _mm_loadu_si128( ( const __m128i * )in );
+		}
+		s = _mm_loadl_epi64( ( const __m128i * )in );
+		return _mm_unpacklo_epi16( s, s );
+	}
+
+	if( channels == 2 ) {
+		s = _mm_loadl_epi64( ( const __m128i * )( (const uint8_t *)samples + i * 2 ) );
+		return _mm_unpacklo_epi8( zero, s );
+	}
+
+	memcpy( &word, (const uint8_t *)samples + i, sizeof( word ) );
+	s = _mm_unpacklo_epi8( zero, _mm_cvtsi32_si128( word ) );
+	return _mm_unpacklo_epi16( s, s );
+}
+
+/*
+* S_MixSpan_SSE2
+*
+* Returns the number of sample frames mixed, the rest is left for the generic path.
+* There's no 32-bit multiply in SSE2, so the volume is split into its high and
+* low bytes: ( s * ( 256 * hi + lo ) ) >> 8 == s * hi + ( ( s * lo ) >> 8 ).
+*/
+static int S_MixSpan_SSE2( int *paint, const void *samples, int count, int width, int channels, const sndMixRamp_t *ramp ) {
+	int i;
+	const __m128i lowByte = _mm_set1_epi32( 0xff );
+	const __m128i step2 = _mm_setr_epi32( ramp->leftStep * 2, ramp->rightStep * 2, ramp->leftStep * 2, ramp->rightStep * 2 );
+	const __m128i step4 = _mm_add_epi32( step2, step2 );
+	__m128i vol01 = _mm_setr_epi32( ramp->left, ramp->right, ramp->left + ramp->leftStep, ramp->right + ramp->rightStep );
+	__m128i vol23 = _mm_add_epi32( vol01, step2 );
+
+	for( i = 0; i + 4 <= count; i += 4 ) {
+		__m128i s = S_LoadFrames_SSE2( samples, i, width, channels );
+		__m128i v01 = _mm_srai_epi32( vol01, 8 );
+		__m128i v23 = _mm_srai_epi32( vol23, 8 );
+		__m128i hi = _mm_packs_epi32( _mm_srai_epi32( v01, 8 ), _mm_srai_epi32( v23, 8 ) );
+		__m128i lo = _mm_packs_epi32( _mm_and_si128( v01, lowByte ), _mm_and_si128( v23, lowByte ) );
+		__m128i hil = _mm_mullo_epi16( s, hi ), hih = _mm_mulhi_epi16( s, hi );
+		__m128i lol = _mm_mullo_epi16( s, lo ), loh = _mm_mulhi_epi16( s, lo );
+		__m128i r0 = _mm_add_epi32( _mm_unpacklo_epi16( hil, hih ), _mm_srai_epi32( _mm_unpacklo_epi16( lol, loh ), 8 ) );
+		__m128i r1 = _mm_add_epi32( _mm_unpackhi_epi16( hil, hih ), _mm_srai_epi32( _mm_unpackhi_epi16( lol, loh ), 8 ) );
+		__m128i *out = ( __m128i * )( paint + i * 2 );
+
+		_mm_storeu_si128( out, _mm_add_epi32( _mm_loadu_si128( out ), r0 ) );
+		_mm_storeu_si128( out + 1, _mm_add_epi32( _mm_loadu_si128( out + 1 ), r1 ) );
+
+		vol01 = _mm_add_epi32( vol01, step4 );
+		vol23 = _mm_add_epi32( vol23, step4 );
+	}
+
+	return i;
+}
+#elif defined( S_MIX_NEON )
+/*
+* S_LoadFrames_NEON
+*/
+static inline int16x8_t S_LoadFrames_NEON( const void *samples, int i, int width, int channels ) {
+	int16x4_t s;
+	int16x4x2_t z;
+	uint32_t word;
+
+	if( width == 2 ) {
+		const short *in = (const short *)samples + i * channels;
+		if( channels == 2 ) {
+			return vld1q_s16( in );
+		}
+		s = vld1_s16( in );
+	} else {
+		if( channels == 2 ) {
+			return vshll_n_s8( vld1_s8( (const int8_t *)samples + i * 2 ), 8 );
+		}
+		memcpy( &word, (const uint8_t *)samples + i, sizeof( word ) );
+		s = vget_low_s16( vshll_n_s8( vreinterpret_s8_u32( vdup_n_u32( word ) ), 8 ) );
+	}
+
+	z = vzip_s16( s, s );
+	return vcombine_s16( z.val[0], z.val[1] );
+}
+
+/*
+* S_MixSpan_NEON
+*
+* Returns the number of sample frames mixed, the rest is left for the generic path
+*/
+static int S_MixSpan_NEON( int *paint, const void *samples, int count, int width, int channels, const sndMixRamp_t *ramp ) {
+	int i;
+	const int32_t steps[4] = { ramp->leftStep * 2, ramp->rightStep * 2, ramp->leftStep * 2, ramp->rightStep * 2 };
+	const int32_t vols[4] = { ramp->left, ramp->right, ramp->left + ramp->leftStep, ramp->right + ramp->rightStep };
+	const int32x4_t step2 = vld1q_s32( steps );
+	const int32x4_t step4 = vaddq_s32( step2, step2 );
+	int32x4_t vol01 = vld1q_s32( vols );
+	int32x4_t vol23 = vaddq_s32( vol01, step2 );
+
+	for( i = 0; i + 4 <= count; i += 4 ) {
+		int16x8_t s = S_LoadFrames_NEON( samples, i, width, channels );
+		int32x4_t r0 = vshrq_n_s32( vmulq_s32( vmovl_s16( vget_low_s16( s ) ), vshrq_n_s32( vol01, 8 ) ), 8 );
+		int32x4_t r1 = vshrq_n_s32( vmulq_s32( vmovl_s16( vget_high_s16( s ) ), vshrq_n_s32( vol23, 8 ) ), 8 );
+		int *out = paint + i * 2;
+
+		vst1q_s32( out, vaddq_s32( vld1q_s32( out ), r0 ) );
+		vst1q_s32( out + 4, vaddq_s32( vld1q_s32( out + 4 ), r1 ) );
+
+		vol01 = vaddq_s32( vol01, step4 );
+		vol23 = vaddq_s32( vol23, step4 );
+	}
+
+	return i;
+}
+#endif
+
+/*
+* S_MixSamples
+*/
+void S_MixSamples( int *paint, const void *samples, int count, int width, int channels, const sndMixRamp_t *ramp ) {
+	int first = 0;
+
+#if defined( S_MIX_SSE2 )
+	first = S_MixSpan_SSE2( paint, samples, count, width, channels, ramp );
+#elif defined( S_MIX_NEON )
+	first = S_MixSpan_NEON( paint, samples, count, width, channels, ramp );
+#endif
+
+	S_MixSpan_Generic( paint, samples, first, count, width, channels, ramp );
+}
+
+/*
+* S_MixSamples_Generic
+*/
+void S_MixSamples_Generic( int *paint, const void *samples, int count, int width, int channels, const sndMixRamp_t *ramp ) {
+	S_MixSpan_Generic( paint, samples, 0, count, width, channels, ramp );
+}
+
+/*
+* S_ClipSample
+*/
+static inline short S_ClipSample( int val ) {
+#if defined ( __arm__ ) && defined ( __GNUC__ )
+	// signed saturation (ARMv6 or Thumb2) with the shift as part of the instruction
+	__asm__ ( "ssat %0, #16, %0, asr #8\n" : "+r" ( val ) );
+	return val;
+#else
+	val >>= 8;
+	return val > 0x7fff ? 0x7fff : val < -0x8000 ? -0x8000 : val;
+#endif
+}
+
+/*
+* S_ClipSpan_Generic
+*
+* Clips sample frames [first, count)
+*/
+static void S_ClipSpan_Generic( const int *paint, short *out, int first, int count, bool swap ) {
+	int i;
+	const int l = swap ? 1 : 0;
+
+	for( i = first * 2; i < count * 2; i += 2 ) {
+		out[i] = S_ClipSample( paint[i + l] );
+		out[i + 1] = S_ClipSample( paint[i + 1 - l] );
+	}
+}
+
+/*
+* S_ClipSamples
+*/
+void S_ClipSamples( const int *paint, short *out, int count, bool swap ) {
+	int i = 0;
+
+#if defined( S_MIX_SSE2 )
+	// packs saturates exactly like the scalar clamp
+	for( ; i + 4 <= count; i += 4 ) {
+		__m128i a = _mm_srai_epi32( _mm_loadu_si128( ( const __m128i * )( paint + i * 2 ) ), 8 );
+		__m128i b = _mm_srai_epi32( _mm_loadu_si128( ( const __m128i * )( paint + i * 2 + 4 ) ), 8 );
+		if( swap ) {
+			a = _mm_shuffle_epi32( a, _MM_SHUFFLE( 2, 3, 0, 1 ) );
+			b = _mm_shuffle_epi32( b, _MM_SHUFFLE( 2, 3, 0, 1 ) );
+		}
+		_mm_storeu_si128( ( __m128i * )( out + i * 2 ), _mm_packs_epi32( a, b ) );
+	}
+#elif defined( S_MIX_NEON )
+	for( ; i + 4 <= count; i += 4 ) {
+		int32x4_t a = vld1q_s32( paint + i * 2 );
+		int32x4_t b = vld1q_s32( paint + i * 2 + 4 );
+		if( swap ) {
+			a = vrev64q_s32( a );
+			b = vrev64q_s32( b );
+		}
+		vst1q_s16( out + i * 2, vcombine_s16( vqshrn_n_s32( a, 8 ), vqshrn_n_s32( b, 8 ) ) );
+	}
+#endif
+
+	S_ClipSpan_Generic( paint, out, i, count, swap );
+}
+
+/*
+* S_ClipSamples_Generic
+*/
+void S_ClipSamples_Generic( const int *paint, short *out, int count, bool swap ) {
+	S_ClipSpan_Generic( paint, out, 0, count, swap );
+}
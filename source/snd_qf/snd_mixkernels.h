@@ -0,0 +1,64 @@
+/*
+Copyright (C) 2018 Warsow development team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+#ifndef SND_MIXKERNELS_H
+#define SND_MIXKERNELS_H
+
+// Paint buffer mixing and clipping kernels used by the mixer.
+//
+// The paint buffer holds interleaved left and right samples with 8 bits of
+// fraction. The kernels don't depend on the sound imports so they can be
+// linked into standalone tools. All vectorized paths are bit-exact with the
+// scalar reference code.
+
+#define S_MIX_MAX_VOLUME    0xffff
+
+/*
+* Volumes have 8 bits of fraction on top of the 0..S_MIX_MAX_VOLUME range
+* and change by the step after every sample frame. A 16-bit sample s mixed
+* at volume v adds ( s * ( v >> 8 ) ) >> 8 to the paint buffer. 8-bit samples
+* are signed and mixed as if they were shifted left by 8 bits.
+*/
+typedef struct {
+	int left, right;
+	int leftStep, rightStep;
+} sndMixRamp_t;
+
+const char *S_MixArch( void );
+
+/*
+* Adds count sample frames of 8 or 16-bit mono or stereo samples to the
+* paint buffer. The volumes must stay within range for the whole run.
+*/
+void S_MixSamples( int *paint, const void *samples, int count, int width, int channels, const sndMixRamp_t *ramp );
+
+/*
+* Converts count stereo sample frames of the paint buffer to saturated 16-bit
+* samples, optionally swapping the left and right channels.
+*/
+void S_ClipSamples( const int *paint, short *out, int count, bool swap );
+
+/*
+* Scalar reference implementations, exposed for validation.
+*/
+void S_MixSamples_Generic( int *paint, const void *samples, int count, int width, int channels, const sndMixRamp_t *ramp );
+void S_ClipSamples_Generic( const int *paint, short *out, int count, bool swap );
+
+#endif // SND_MIXKERNELS_H
@@ -39,6 +39,7 @@ long ( *qov_read )( OggVorbis_File *vf, char *buffer, int length, int bigendianp
 long ( *qov_streams )( OggVorbis_File *vf );
 long ( *qov_seekable )( OggVorbis_File *vf );
 int ( *qov_pcm_seek )( OggVorbis_File *vf, ogg_int64_t pos );
+ogg_int64_t ( *qov_pcm_tell )( OggVorbis_File *vf );
 
 dllfunc_t oggvorbisfuncs[] =
 {
@@ -52,6 +53,7 @@ dllfunc_t oggvorbisfuncs[] =
 	{ "ov_streams", ( void ** )&qov_streams },
 	{ "ov_seekable", ( void ** )&qov_seekable },
 	{ "ov_pcm_seek", ( void ** )&qov_pcm_seek },
+	{ "ov_pcm_tell", ( void ** )&qov_pcm_tell },
 
 	{ NULL, NULL }
 };
@@ -68,6 +70,7 @@ dllfunc_t oggvorbisfuncs[] =
 #define qov_streams ov_streams
 #define qov_seekable ov_seekable
 #define qov_pcm_seek ov_pcm_seek
+#define qov_pcm_tell ov_pcm_tell
 
 #endif // VORBISLIB_RUNTIME
 
@@ -152,6 +155,7 @@ static void SNDOGG_FClose( bgTrack_t *track );
 sfxcache_t *SNDOGG_Load( sfx_t *s ) {
 	OggVorbis_File vorbisfile;
 	vorbis_info *vi;
+	wavinfo_t info;
 	sfxcache_t *sc;
 	char *buffer;
 	int filenum, bitstream, bytes_read, bytes_read_total, len, samples;
@@ -197,6 +201,18 @@ sfxcache_t *SNDOGG_Load( sfx_t *s ) {
 	}
 
 	samples = (int)qov_pcm_total( &vorbisfile, -1 );
+
+	info.rate = vi->rate;
+	info.width = 2;
+	info.channels = vi->channels;
+	info.loopstart = -1;
+	info.samples = samples;
+	info.dataofs = 0;
+	if( S_StreamSound( &info ) ) {
+		qov_clear( &vorbisfile ); // Does FS_FCloseFile and also kills vorbis_info vi*
+		return S_LoadSoundStream( s, &info, true );
+	}
+
 	len = (int) ( (double) samples * (double) dma.speed / (double) vi->rate );
 	len = len * 2 * vi->channels;
 
@@ -252,6 +268,77 @@ sfxcache_t *SNDOGG_Load( sfx_t *s ) {
 	return sc;
 }
 
+/*
+* SNDOGG_OpenStream
+*
+* Opens an .ogg file for reading samples at random positions.
+*/
+void *SNDOGG_OpenStream( const char *name ) {
+	int filenum;
+	OggVorbis_File *vf;
+	ov_callbacks callbacks = { ovcb_read, ovcb_seek, ovcb_close, ovcb_tell };
+
+#ifdef VORBISLIB_RUNTIME
+	if( !vorbisLibrary ) {
+		return NULL;
+	}
+#endif
+
+	trap_FS_FOpenFile( name, &filenum, FS_READ );
+	if( !filenum ) {
+		return NULL;
+	}
+
+	vf = S_Malloc( sizeof( OggVorbis_File ) );
+	if( qov_open_callbacks( (void *)(intptr_t)filenum, vf, NULL, 0, callbacks ) < 0 ) {
+		trap_FS_FCloseFile( filenum );
+		S_Free( vf );
+		return NULL;
+	}
+
+	return vf;
+}
+
+/*
+* SNDOGG_ReadStream
+*
+* Reads 16-bit sample frames, seeking only if they don't follow the previous ones.
+*/
+bool SNDOGG_ReadStream( void *vorbisFile, unsigned int first, unsigned int samples, int channels, uint8_t *out ) {
+	OggVorbis_File *vf = vorbisFile;
+	int bitstream, bytes_read, bytes_read_total, len;
+
+	if( (unsigned int)qov_pcm_tell( vf ) != first ) {
+		if( qov_pcm_seek( vf, first ) < 0 ) {
+			return false;
+		}
+	}
+
+	len = samples * 2 * channels;
+	bytes_read = bytes_read_total = 0;
+	do {
+		bytes_read_total += bytes_read;
+
+#ifdef ENDIAN_BIG
+		bytes_read = qov_read( vf, (char *)out + bytes_read_total, len - bytes_read_total, 1, 2, 1, &bitstream );
+#elif defined ( ENDIAN_LITTLE )
+		bytes_read = qov_read( vf, (char *)out + bytes_read_total, len - bytes_read_total, 0, 2, 1, &bitstream );
+#else
+#error "runtime endianess detection support missing"
+#endif
+	} while( bytes_read > 0 && bytes_read_total < len );
+
+	return bytes_read_total == len;
+}
+
+/*
+* SNDOGG_CloseStream
+*/
+void SNDOGG_CloseStream( void *vorbisFile ) {
+	qov_clear( vorbisFile ); // Does FS_FCloseFile
+	S_Free( vorbisFile );
+}
+
 /*
 * SNDOGG_OpenTrack
 */
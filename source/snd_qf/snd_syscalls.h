@@ -212,6 +212,10 @@ static inline void trap_Mutex_Unlock( struct qmutex_s *mutex ) {
 	SOUND_IMPORT.Mutex_Unlock( mutex );
 }
 
+static inline bool trap_Atomic_CAS( volatile int *value, int oldval, int newval, struct qmutex_s *mutex ) {
+	return SOUND_IMPORT.Atomic_CAS( value, oldval, newval, mutex );
+}
+
 static inline qbufPipe_t *trap_BufPipe_Create( size_t bufSize, int flags ) {
 	return SOUND_IMPORT.BufPipe_Create( bufSize, flags );
 }
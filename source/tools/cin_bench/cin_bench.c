@@ -0,0 +1,584 @@
+/*
+Copyright (C) 2018 Warsow development team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+// cin_bench -- decodes cinematics to memory as fast as possible with the cin
+// module linked in, on a virtual clock and without audio, and prints the
+// frame rate of each
+//
+// usage: cin_bench cinematic [cinematic...]
+//
+// Names are opened relative to the current directory. The extension is
+// replaced with the ones the cin module knows, like the engine does.
+//
+// Each cinematic is decoded twice, on the calling thread and then on the
+// async worker, and the frames from both runs must be identical.
+
+#include "../../qcommon/qcommon.h"
+#include "../../cin/cin_public.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/time.h>
+#include <dlfcn.h>
+#endif
+
+#define MAX_BENCH_FILES     16
+
+// how long to wait for the async worker to catch up with the virtual clock
+#define BENCH_ASYNC_TIMEOUT 250000
+
+// keeps the data that follows it aligned
+typedef union benchAlloc_u {
+	struct {
+		union benchAlloc_u *prev, *next;
+	} link;
+	uint8_t align[32];
+} benchAlloc_t;
+
+struct mempool_s {
+	benchAlloc_t head;
+};
+
+typedef struct {
+	FILE *fp;
+	int length;
+} benchFile_t;
+
+static benchFile_t benchFiles[MAX_BENCH_FILES];
+
+static cvar_t benchCvars[] = {
+	// toggled by Bench_Cinematic, read by the cin module on open
+	{ "cin_async", "0", "0", NULL, 0, false, 0, 0 },
+	{ "developer", "0", "0", NULL, 0, false, 0, 0 },
+};
+
+static int64_t benchTime;
+
+cin_export_t *GetCinematicsAPI( cin_import_t *import );
+
+#ifndef _MSC_VER
+static void Bench_Error( const char *msg ) __attribute__( ( noreturn ) );
+#endif
+
+/*
+* Q_malloc
+*/
+void *Q_malloc( size_t size ) {
+	void *buf = calloc( 1, size );
+
+	if( !buf ) {
+		Sys_Error( "Q_malloc: failed on allocation of %" PRIuPTR " bytes.\n", (uintptr_t)size );
+	}
+	return buf;
+}
+
+/*
+* Q_free
+*/
+void Q_free( void *buf ) {
+	free( buf );
+}
+
+/*
+* Bench_Microseconds
+*/
+static uint64_t Bench_Microseconds( void ) {
+#ifdef _WIN32
+	static LARGE_INTEGER freq;
+	LARGE_INTEGER now;
+	if( !freq.QuadPart ) {
+		QueryPerformanceFrequency( &freq );
+	}
+	QueryPerformanceCounter( &now );
+	return ( uint64_t )( now.QuadPart * 1000000 / freq.QuadPart );
+#else
+	struct timeval tv;
+	gettimeofday( &tv, NULL );
+	return ( uint64_t )tv.tv_sec * 1000000 + tv.tv_usec;
+#endif
+}
+
+/*
+* Bench_Milliseconds
+*
+* The cin module runs on the virtual clock advanced by Bench_Cinematic.
+*/
+static int64_t Bench_Milliseconds( void ) {
+	return benchTime;
+}
+
+/*
+* Bench_Error
+*/
+static void Bench_Error( const char *msg ) {
+	fprintf( stderr, "%s\n", msg );
+	exit( EXIT_FAILURE );
+}
+
+/*
+* Bench_Print
+*/
+static void Bench_Print( const char *msg ) {
+	fputs( msg, stdout );
+}
+
+/*
+* Bench_CvarGet
+*/
+static cvar_t *Bench_CvarGet( const char *name, const char *value, int flags ) {
+	size_t i;
+
+	for( i = 0; i < sizeof( benchCvars ) / sizeof( benchCvars[0] ); i++ ) {
+		if( !strcmp( benchCvars[i].name, name ) ) {
+			return &benchCvars[i];
+		}
+	}
+
+	Bench_Error( va( "Unknown cvar %s", name ) );
+	return NULL;
+}
+
+/*
+* Bench_CvarValue
+*/
+static float Bench_CvarValue( const char *name ) {
+	return Bench_CvarGet( name, NULL, 0 )->value;
+}
+
+/*
+* Bench_FOpenFile
+*/
+static int Bench_FOpenFile( const char *filename, int *filenum, int mode ) {
+	int i, length;
+	FILE *fp;
+
+	if( filenum ) {
+		*filenum = 0;
+	}
+	if( mode != FS_READ ) {
+		return -1;
+	}
+
+	fp = fopen( filename, "rb" );
+	if( !fp ) {
+		return -1;
+	}
+	fseek( fp, 0, SEEK_END );
+	length = (int)ftell( fp );
+	fseek( fp, 0, SEEK_SET );
+
+	if( !filenum ) {
+		fclose( fp );
+		return length;
+	}
+
+	for( i = 0; i < MAX_BENCH_FILES; i++ ) {
+		if( !benchFiles[i].fp ) {
+			benchFiles[i].fp = fp;
+			benchFiles[i].length = length;
+			*filenum = i + 1;
+			return length;
+		}
+	}
+
+	fclose( fp );
+	return -1;
+}
+
+/*
+* Bench_File
+*/
+static benchFile_t *Bench_File( int file ) {
+	if( file < 1 || file > MAX_BENCH_FILES || !benchFiles[file - 1].fp ) {
+		Bench_Error( va( "Invalid file handle %i", file ) );
+	}
+	return &benchFiles[file - 1];
+}
+
+/*
+* Bench_FRead
+*/
+static int Bench_FRead( void *buffer, size_t len, int file ) {
+	return (int)fread( buffer, 1, len, Bench_File( file )->fp );
+}
+
+/*
+* Bench_FTell
+*/
+static int Bench_FTell( int file ) {
+	return (int)ftell( Bench_File( file )->fp );
+}
+
+/*
+* Bench_FSeek
+*/
+static int Bench_FSeek( int file, int offset, int whence ) {
+	int origin = whence == FS_SEEK_SET ? SEEK_SET : ( whence == FS_SEEK_END ? SEEK_END : SEEK_CUR );
+
+	return fseek( Bench_File( file )->fp, offset, origin ) ? -1 : 0;
+}
+
+/*
+* Bench_FEof
+*/
+static int Bench_FEof( int file ) {
+	benchFile_t *f = Bench_File( file );
+
+	return ftell( f->fp ) >= f->length;
+}
+
+/*
+* Bench_FCloseFile
+*/
+static void Bench_FCloseFile( int file ) {
+	benchFile_t *f;
+
+	if( !file ) {
+		return;
+	}
+
+	f = Bench_File( file );
+	fclose( f->fp );
+	f->fp = NULL;
+}
+
+/*
+* Bench_IsUrl
+*/
+static bool Bench_IsUrl( const char *url ) {
+	return false;
+}
+
+/*
+* Bench_LoadLibrary
+*
+* Tries the '|' separated names in order, like Com_LoadSysLibrary.
+*/
+static void *Bench_LoadLibrary( const char *name, dllfunc_t *funcs ) {
+	char *names, *s;
+	void *lib = NULL;
+	dllfunc_t *func;
+
+	names = Q_malloc( strlen( name ) + 1 );
+	strcpy( names, name );
+
+	for( s = strtok( names, "|" ); s && !lib; s = strtok( NULL, "|" ) ) {
+#ifdef _WIN32
+		lib = (void *)LoadLibraryA( s );
+#else
+		lib = dlopen( s, RTLD_NOW );
+#endif
+		if( !lib ) {
+			continue;
+		}
+
+		for( func = funcs; func->name; func++ ) {
+#ifdef _WIN32
+			*func->funcPointer = (void *)GetProcAddress( (HMODULE)lib, func->name );
+#else
+			*func->funcPointer = dlsym( lib, func->name );
+#endif
+			if( !*func->funcPointer ) {
+				break;
+			}
+		}
+
+		if( func->name ) {
+			fprintf( stderr, "%s has no %s\n", s, func->name );
+#ifdef _WIN32
+			FreeLibrary( (HMODULE)lib );
+#else
+			dlclose( lib );
+#endif
+			lib = NULL;
+		}
+	}
+
+	Q_free( names );
+	return lib;
+}
+
+/*
+* Bench_UnloadLibrary
+*/
+static void Bench_UnloadLibrary( void **lib ) {
+	if( !*lib ) {
+		return;
+	}
+#ifdef _WIN32
+	FreeLibrary( (HMODULE)*lib );
+#else
+	dlclose( *lib );
+#endif
+	*lib = NULL;
+}
+
+/*
+* Bench_MemAllocPool
+*/
+static struct mempool_s *Bench_MemAllocPool( const char *name, const char *filename, int fileline ) {
+	struct mempool_s *pool = Q_malloc( sizeof( *pool ) );
+
+	pool->head.link.prev = pool->head.link.next = &pool->head;
+	return pool;
+}
+
+/*
+* Bench_MemAlloc
+*/
+static void *Bench_MemAlloc( struct mempool_s *pool, size_t size, const char *filename, int fileline ) {
+	benchAlloc_t *a = Q_malloc( sizeof( *a ) + size );
+
+	a->link.prev = &pool->head;
+	a->link.next = pool->head.link.next;
+	a->link.next->link.prev = a;
+	a->link.prev->link.next = a;
+	return a + 1;
+}
+
+/*
+* Bench_MemFree
+*/
+static void Bench_MemFree( void *data, const char *filename, int fileline ) {
+	benchAlloc_t *a;
+
+	if( !data ) {
+		return;
+	}
+
+	a = ( benchAlloc_t * )data - 1;
+	a->link.prev->link.next = a->link.next;
+	a->link.next->link.prev = a->link.prev;
+	Q_free( a );
+}
+
+/*
+* Bench_MemEmptyPool
+*/
+static void Bench_MemEmptyPool( struct mempool_s *pool, const char *filename, int fileline ) {
+	while( pool->head.link.next != &pool->head ) {
+		Bench_MemFree( pool->head.link.next + 1, filename, fileline );
+	}
+}
+
+/*
+* Bench_MemFreePool
+*/
+static void Bench_MemFreePool( struct mempool_s **pool, const char *filename, int fileline ) {
+	if( !*pool ) {
+		return;
+	}
+
+	Bench_MemEmptyPool( *pool, filename, fileline );
+	Q_free( *pool );
+	*pool = NULL;
+}
+
+/*
+* Bench_Checksum
+*/
+static uint32_t Bench_Checksum( uint32_t hash, const uint8_t *data, size_t size ) {
+	size_t i;
+
+	for( i = 0; i < size; i++ ) {
+		hash = ( hash ^ data[i] ) * 16777619;
+	}
+	return hash;
+}
+
+/*
+* Bench_FrameChecksum
+*
+* Hashes the visible rows, so that frames with different strides compare equal.
+*/
+static uint32_t Bench_FrameChecksum( uint32_t hash, const void *frame, bool yuv, int width, int height ) {
+	int i, row;
+
+	if( !yuv ) {
+		return Bench_Checksum( hash, frame, (size_t)width * height * 3 );
+	}
+
+	for( i = 0; i < 3; i++ ) {
+		const cin_img_plane_t *plane = &( ( const cin_yuv_t * )frame )->yuv[i];
+		size_t rowSize = min( plane->width, abs( plane->stride ) );
+
+		for( row = 0; row < plane->height; row++ ) {
+			hash = Bench_Checksum( hash, plane->data + plane->stride * row, rowSize );
+		}
+	}
+	return hash;
+}
+
+/*
+* Bench_NeedNextFrame
+*/
+static bool Bench_NeedNextFrame( cin_export_t *cin_export, struct cinematics_s *cin, bool async ) {
+	uint64_t start = Bench_Microseconds();
+
+	while( !cin_export->NeedNextFrame( cin, benchTime ) ) {
+		// the worker decodes in the background, give it time to catch up
+		if( !async || Bench_Microseconds() - start > BENCH_ASYNC_TIMEOUT ) {
+			return false;
+		}
+		QThread_Yield();
+	}
+	return true;
+}
+
+/*
+* Bench_Cinematic
+*
+* Runs the decoder on a virtual clock, one frame at a time.
+*/
+static bool Bench_Cinematic( cin_export_t *cin_export, const char *name, bool async,
+							 unsigned int *numFrames, uint32_t *checksum ) {
+	int i, width, height, frameWidth = 0, frameHeight = 0;
+	struct cinematics_s *cin;
+	bool yuv, redraw;
+	float framerate;
+	void *frame;
+	unsigned int frames = 0;
+	uint32_t hash = 2166136261u;
+	uint64_t usec;
+	double sec;
+
+	benchCvars[0].integer = async ? 1 : 0;
+
+	benchTime = 0;
+	cin = cin_export->Open( name, 0, CIN_NOAUDIO, &yuv, &framerate );
+	if( !cin ) {
+		fprintf( stderr, "Couldn't open %s\n", name );
+		return false;
+	}
+	if( framerate <= 0 ) {
+		fprintf( stderr, "%s has no valid framerate\n", cin_export->FileName( cin ) );
+		cin_export->Close( cin );
+		return false;
+	}
+
+	usec = Bench_Microseconds();
+	for( i = 1;; i++ ) {
+		benchTime = (int64_t)( i * 1000.0 / framerate ) + 1;
+		if( !Bench_NeedNextFrame( cin_export, cin, async ) ) {
+			continue;
+		}
+
+		redraw = false;
+		if( yuv ) {
+			frame = cin_export->ReadNextFrameYUV( cin, &width, &height, NULL, NULL, &redraw );
+		} else {
+			frame = cin_export->ReadNextFrame( cin, &width, &height, NULL, NULL, &redraw );
+		}
+		if( !frame ) {
+			break;
+		}
+
+		if( redraw ) {
+			hash = Bench_FrameChecksum( hash, frame, yuv, width, height );
+			frameWidth = width;
+			frameHeight = height;
+			frames++;
+		}
+	}
+	usec = Bench_Microseconds() - usec;
+	sec = usec > 0 ? usec * 0.000001 : 0.000001;
+
+	printf( "%s: %u frames (%ix%i%s%s) in %.2f sec, %.1f fps, %.1fx realtime\n", cin_export->FileName( cin ), frames,
+			frameWidth, frameHeight, yuv ? " YUV" : "", async ? ", async" : "", sec, frames / sec, frames / sec / framerate );
+
+	cin_export->Close( cin );
+
+	*numFrames = frames;
+	*checksum = hash;
+	return true;
+}
+
+int main( int argc, char **argv ) {
+	int i, numFailed = 0;
+	cin_import_t import;
+	cin_export_t *cin_export;
+
+	if( argc < 2 ) {
+		fprintf( stderr, "usage: %s cinematic [cinematic...]\n", argv[0] );
+		return EXIT_FAILURE;
+	}
+
+	memset( &import, 0, sizeof( import ) );
+	import.Error = Bench_Error;
+	import.Print = Bench_Print;
+	import.Cvar_Get = Bench_CvarGet;
+	import.Cvar_Value = Bench_CvarValue;
+	import.FS_FOpenFile = Bench_FOpenFile;
+	import.FS_Read = Bench_FRead;
+	import.FS_Tell = Bench_FTell;
+	import.FS_Seek = Bench_FSeek;
+	import.FS_Eof = Bench_FEof;
+	import.FS_FCloseFile = Bench_FCloseFile;
+	import.FS_IsUrl = Bench_IsUrl;
+	import.Sys_Milliseconds = Bench_Milliseconds;
+	import.Sys_Microseconds = Bench_Microseconds;
+	import.Sys_LoadLibrary = Bench_LoadLibrary;
+	import.Sys_UnloadLibrary = Bench_UnloadLibrary;
+	import.Mem_AllocPool = Bench_MemAllocPool;
+	import.Mem_Alloc = Bench_MemAlloc;
+	import.Mem_Free = Bench_MemFree;
+	import.Mem_FreePool = Bench_MemFreePool;
+	import.Mem_EmptyPool = Bench_MemEmptyPool;
+	import.Thread_Create = QThread_Create;
+	import.Thread_Join = QThread_Join;
+	import.Mutex_Create = QMutex_Create;
+	import.Mutex_Destroy = QMutex_Destroy;
+	import.Mutex_Lock = QMutex_Lock;
+	import.Mutex_Unlock = QMutex_Unlock;
+	import.BufPipe_Create = QBufPipe_Create;
+	import.BufPipe_Destroy = QBufPipe_Destroy;
+	import.BufPipe_Finish = QBufPipe_Finish;
+	import.BufPipe_WriteCmd = QBufPipe_WriteCmd;
+	import.BufPipe_ReadCmds = QBufPipe_ReadCmds;
+	import.BufPipe_Wait = QBufPipe_Wait;
+
+	cin_export = GetCinematicsAPI( &import );
+	if( cin_export->API() != CIN_API_VERSION || !cin_export->Init( false ) ) {
+		fprintf( stderr, "Couldn't initialize the cin module\n" );
+		return EXIT_FAILURE;
+	}
+
+	for( i = 1; i < argc; i++ ) {
+		unsigned int frames[2];
+		uint32_t checksums[2];
+
+		if( !Bench_Cinematic( cin_export, argv[i], false, &frames[0], &checksums[0] )
+			|| !Bench_Cinematic( cin_export, argv[i], true, &frames[1], &checksums[1] ) ) {
+			numFailed++;
+			continue;
+		}
+
+		if( frames[0] != frames[1] || checksums[0] != checksums[1] ) {
+			fprintf( stderr, "%s: async frames differ (%u frames, checksum %08x vs %u frames, checksum %08x)\n",
+					 argv[i], frames[0], checksums[0], frames[1], checksums[1] );
+			numFailed++;
+		}
+	}
+
+	cin_export->Shutdown( false );
+
+	return numFailed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
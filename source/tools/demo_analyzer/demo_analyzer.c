@@ -0,0 +1,911 @@
+/*
+Copyright (C) 2018 Warsow development team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+// demo_analyzer -- decodes every snapshot of many demos on worker threads,
+// without a client, and writes per-frame records of the game state, players,
+// entities and commands to compact column files for stats and review
+//
+// usage: demo_analyzer [-threads n] [-out dir] demo [demo...]
+//
+// Each demo gets a .cols file next to it, or in the -out directory. It starts
+// with "WDCF", a version byte and the table schemas: a varint table count,
+// then for each table its name, a varint column count and the type byte and
+// name of each column. Names are a varint length followed by the bytes.
+//
+// Rows follow in chunks of up to CHUNK_ROWS rows: a varint table index, a
+// varint row count, then each column as a varint byte length and its data.
+// Integers are zigzag varints of the difference to the previous row of the
+// chunk, floats are little-endian IEEE singles and strings are stored like
+// names. Every chunk can be decoded on its own.
+
+#include "../../qcommon/qcommon.h"
+#include "../../qcommon/snap_read.h"
+
+#include <setjmp.h>
+#include <sys/stat.h>
+#include <zlib.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/time.h>
+#include <unistd.h>
+#endif
+
+#define COLS_VERSION        1
+#define COLS_EXTENSION      ".cols"
+#define CHUNK_ROWS          4096
+#define MAX_COLUMNS         160
+#define MAX_AREA_BYTES      256
+#define DEFAULT_THREADS     4
+#define MAX_THREADS         64
+
+typedef enum {
+	COL_INT,
+	COL_FLOAT,
+	COL_STRING
+} colType_t;
+
+enum {
+	TABLE_FRAMES,
+	TABLE_PLAYERS,
+	TABLE_ENTITIES,
+	TABLE_COMMANDS,
+
+	NUM_TABLES
+};
+
+enum {
+	COMMAND_SERVER,     // reliable server commands, configstring changes among them
+	COMMAND_GAME        // game commands carried by frames
+};
+
+typedef struct {
+	uint8_t *data;
+	size_t size, maxSize;
+} buffer_t;
+
+typedef struct {
+	char name[32];
+	colType_t type;
+	int64_t last;
+	buffer_t data;
+} column_t;
+
+typedef struct {
+	const char *name;
+	int numColumns;
+	column_t columns[MAX_COLUMNS];
+	int numRows;
+	int column;             // the next column of the current row
+	int64_t totalRows;
+} table_t;
+
+typedef struct {
+	snapshot_t snapShots[UPDATE_BACKUP];
+	uint8_t areabits[UPDATE_BACKUP][MAX_AREA_BYTES];
+	entity_state_t baselines[MAX_EDICTS];
+	uint8_t msgData[MAX_MSGLEN];
+
+	table_t tables[NUM_TABLES];
+	buffer_t chunk;
+	FILE *out;
+
+	bool reliable;
+	snapshot_t *lastFrame;
+	int64_t frames;
+} analyzer_t;
+
+static const char *tableNames[NUM_TABLES] = { "frames", "players", "entities", "commands" };
+
+static char **demos;
+static int numDemos;
+static const char *outDir;
+
+static qmutex_t *queueLock;
+static int nextDemo;
+static int64_t totalFrames, totalRows[NUM_TABLES];
+static int numFailed;
+
+static ATTRIBUTE_THREAD_LOCAL jmp_buf *abortDemo;
+
+/*
+* Com_Printf
+*/
+void Com_Printf( const char *format, ... ) {
+	va_list argptr;
+
+	va_start( argptr, format );
+	vprintf( format, argptr );
+	va_end( argptr );
+}
+
+/*
+* Com_Error
+*
+* Errors stop the current demo and the thread moves on to the next one.
+*/
+void Com_Error( com_error_code_t code, const char *format, ... ) {
+	va_list argptr;
+
+	va_start( argptr, format );
+	vfprintf( stderr, format, argptr );
+	va_end( argptr );
+	fputc( '\n', stderr );
+
+	if( abortDemo ) {
+		longjmp( *abortDemo, 1 );
+	}
+	exit( EXIT_FAILURE );
+}
+
+/*
+* Sys_Error
+*/
+void Sys_Error( const char *format, ... ) {
+	va_list argptr;
+
+	va_start( argptr, format );
+	vfprintf( stderr, format, argptr );
+	va_end( argptr );
+	fputc( '\n', stderr );
+
+	exit( EXIT_FAILURE );
+}
+
+/*
+* Q_malloc
+*/
+void *Q_malloc( size_t size ) {
+	void *buf = calloc( 1, size );
+
+	if( !buf ) {
+		Sys_Error( "Q_malloc: failed on allocation of %" PRIuPTR " bytes.\n", (uintptr_t)size );
+	}
+	return buf;
+}
+
+/*
+* Q_free
+*/
+void Q_free( void *buf ) {
+	free( buf );
+}
+
+/*
+* Analyzer_Microseconds
+*/
+static uint64_t Analyzer_Microseconds( void ) {
+#ifdef _WIN32
+	static LARGE_INTEGER freq;
+	LARGE_INTEGER now;
+	if( !freq.QuadPart ) {
+		QueryPerformanceFrequency( &freq );
+	}
+	QueryPerformanceCounter( &now );
+	return ( uint64_t )( now.QuadPart * 1000000 / freq.QuadPart );
+#else
+	struct timeval tv;
+	gettimeofday( &tv, NULL );
+	return ( uint64_t )tv.tv_sec * 1000000 + tv.tv_usec;
+#endif
+}
+
+/*
+* Analyzer_NumProcessors
+*/
+static int Analyzer_NumProcessors( void ) {
+#ifdef _WIN32
+	SYSTEM_INFO info;
+	GetSystemInfo( &info );
+	return info.dwNumberOfProcessors;
+#elif defined( _SC_NPROCESSORS_ONLN )
+	return sysconf( _SC_NPROCESSORS_ONLN );
+#else
+	return DEFAULT_THREADS;
+#endif
+}
+
+/*
+=============================================================================
+
+COLUMN FILES
+
+=============================================================================
+*/
+
+/*
+* Buf_Write
+*/
+static void Buf_Write( buffer_t *buf, const void *data, size_t size ) {
+	if( buf->size + size > buf->maxSize ) {
+		buf->maxSize = max( buf->maxSize * 2, buf->size + size + 1024 );
+		buf->data = realloc( buf->data, buf->maxSize );
+		if( !buf->data ) {
+			Sys_Error( "Buf_Write: out of memory" );
+		}
+	}
+	memcpy( buf->data + buf->size, data, size );
+	buf->size += size;
+}
+
+/*
+* Buf_WriteVarint
+*/
+static void Buf_WriteVarint( buffer_t *buf, uint64_t value ) {
+	uint8_t bytes[10];
+	int n = 0;
+
+	do {
+		bytes[n] = value & 0x7f;
+		value >>= 7;
+		if( value ) {
+			bytes[n] |= 0x80;
+		}
+		n++;
+	} while( value );
+
+	Buf_Write( buf, bytes, n );
+}
+
+/*
+* Buf_WriteString
+*/
+static void Buf_WriteString( buffer_t *buf, const char *s ) {
+	size_t len = strlen( s );
+
+	Buf_WriteVarint( buf, len );
+	Buf_Write( buf, s, len );
+}
+
+/*
+* Table_AddColumn
+*/
+static void Table_AddColumn( table_t *table, const char *name, colType_t type ) {
+	column_t *col;
+
+	if( table->numColumns == MAX_COLUMNS ) {
+		Sys_Error( "Table_AddColumn: too many columns in %s", table->name );
+	}
+
+	col = &table->columns[table->numColumns++];
+	Q_strncpyz( col->name, name, sizeof( col->name ) );
+	col->type = type;
+}
+
+/*
+* Table_NextColumn
+*/
+static column_t *Table_NextColumn( table_t *table, colType_t type ) {
+	column_t *col = &table->columns[table->column++];
+
+	assert( col->type == type );
+	return col;
+}
+
+/*
+* Table_Int
+*/
+static void Table_Int( table_t *table, int64_t value ) {
+	column_t *col = Table_NextColumn( table, COL_INT );
+	int64_t delta = value - col->last;
+
+	Buf_WriteVarint( &col->data, ( ( uint64_t )delta << 1 ) ^ ( uint64_t )( delta >> 63 ) );
+	col->last = value;
+}
+
+/*
+* Table_Float
+*/
+static void Table_Float( table_t *table, float value ) {
+	column_t *col = Table_NextColumn( table, COL_FLOAT );
+	union {
+		float f;
+		uint32_t i;
+	} u;
+	uint8_t bytes[4];
+
+	u.f = value;
+	bytes[0] = u.i & 0xff;
+	bytes[1] = ( u.i >> 8 ) & 0xff;
+	bytes[2] = ( u.i >> 16 ) & 0xff;
+	bytes[3] = u.i >> 24;
+	Buf_Write( &col->data, bytes, 4 );
+}
+
+/*
+* Table_Vec3
+*/
+static void Table_Vec3( table_t *table, const float *v ) {
+	Table_Float( table, v[0] );
+	Table_Float( table, v[1] );
+	Table_Float( table, v[2] );
+}
+
+/*
+* Table_String
+*/
+static void Table_String( table_t *table, const char *s ) {
+	Buf_WriteString( &Table_NextColumn( table, COL_STRING )->data, s );
+}
+
+/*
+* Analyzer_FlushTable
+*/
+static void Analyzer_FlushTable( analyzer_t *an, int tableNum ) {
+	int i;
+	table_t *table = &an->tables[tableNum];
+
+	if( !table->numRows ) {
+		return;
+	}
+
+	an->chunk.size = 0;
+	Buf_WriteVarint( &an->chunk, tableNum );
+	Buf_WriteVarint( &an->chunk, table->numRows );
+	for( i = 0; i < table->numColumns; i++ ) {
+		column_t *col = &table->columns[i];
+
+		Buf_WriteVarint( &an->chunk, col->data.size );
+		Buf_Write( &an->chunk, col->data.data, col->data.size );
+		col->data.size = 0;
+		col->last = 0;
+	}
+	fwrite( an->chunk.data, 1, an->chunk.size, an->out );
+
+	table->totalRows += table->numRows;
+	table->numRows = 0;
+}
+
+/*
+* Analyzer_BeginRow
+*/
+static table_t *Analyzer_BeginRow( analyzer_t *an, int tableNum ) {
+	table_t *table = &an->tables[tableNum];
+
+	table->column = 0;
+	return table;
+}
+
+/*
+* Analyzer_EndRow
+*/
+static void Analyzer_EndRow( analyzer_t *an, int tableNum ) {
+	table_t *table = &an->tables[tableNum];
+
+	assert( table->column == table->numColumns );
+	if( ++table->numRows == CHUNK_ROWS ) {
+		Analyzer_FlushTable( an, tableNum );
+	}
+}
+
+/*
+* Analyzer_InitTables
+*/
+static void Analyzer_InitTables( analyzer_t *an ) {
+	int i;
+	table_t *table;
+
+	for( i = 0; i < NUM_TABLES; i++ ) {
+		an->tables[i].name = tableNames[i];
+	}
+
+	table = &an->tables[TABLE_FRAMES];
+	Table_AddColumn( table, "frame", COL_INT );
+	Table_AddColumn( table, "time", COL_INT );
+	Table_AddColumn( table, "delta", COL_INT );
+	Table_AddColumn( table, "numplayers", COL_INT );
+	Table_AddColumn( table, "numentities", COL_INT );
+	for( i = 0; i < MAX_GAME_STATS; i++ ) {
+		Table_AddColumn( table, va( "gamestat%i", i ), COL_INT );
+	}
+
+	table = &an->tables[TABLE_PLAYERS];
+	Table_AddColumn( table, "frame", COL_INT );
+	Table_AddColumn( table, "playernum", COL_INT );
+	Table_AddColumn( table, "povnum", COL_INT );
+	Table_AddColumn( table, "pmtype", COL_INT );
+	Table_AddColumn( table, "pmflags", COL_INT );
+	Table_AddColumn( table, "origin_x", COL_FLOAT );
+	Table_AddColumn( table, "origin_y", COL_FLOAT );
+	Table_AddColumn( table, "origin_z", COL_FLOAT );
+	Table_AddColumn( table, "velocity_x", COL_FLOAT );
+	Table_AddColumn( table, "velocity_y", COL_FLOAT );
+	Table_AddColumn( table, "velocity_z", COL_FLOAT );
+	Table_AddColumn( table, "pitch", COL_FLOAT );
+	Table_AddColumn( table, "yaw", COL_FLOAT );
+	Table_AddColumn( table, "roll", COL_FLOAT );
+	Table_AddColumn( table, "event0", COL_INT );
+	Table_AddColumn( table, "eventparm0", COL_INT );
+	Table_AddColumn( table, "event1", COL_INT );
+	Table_AddColumn( table, "eventparm1", COL_INT );
+	Table_AddColumn( table, "keys", COL_INT );
+	Table_AddColumn( table, "weaponstate", COL_INT );
+	for( i = 0; i < PS_MAX_STATS; i++ ) {
+		Table_AddColumn( table, va( "stat%i", i ), COL_INT );
+	}
+
+	table = &an->tables[TABLE_ENTITIES];
+	Table_AddColumn( table, "frame", COL_INT );
+	Table_AddColumn( table, "number", COL_INT );
+	Table_AddColumn( table, "type", COL_INT );
+	Table_AddColumn( table, "solid", COL_INT );
+	Table_AddColumn( table, "modelindex", COL_INT );
+	Table_AddColumn( table, "modelindex2", COL_INT );
+	Table_AddColumn( table, "origin_x", COL_FLOAT );
+	Table_AddColumn( table, "origin_y", COL_FLOAT );
+	Table_AddColumn( table, "origin_z", COL_FLOAT );
+	Table_AddColumn( table, "pitch", COL_FLOAT );
+	Table_AddColumn( table, "yaw", COL_FLOAT );
+	Table_AddColumn( table, "roll", COL_FLOAT );
+	Table_AddColumn( table, "animframe", COL_INT );
+	Table_AddColumn( table, "effects", COL_INT );
+	Table_AddColumn( table, "event0", COL_INT );
+	Table_AddColumn( table, "eventparm0", COL_INT );
+	Table_AddColumn( table, "event1", COL_INT );
+	Table_AddColumn( table, "eventparm1", COL_INT );
+	Table_AddColumn( table, "owner", COL_INT );
+	Table_AddColumn( table, "target", COL_INT );
+	Table_AddColumn( table, "weapon", COL_INT );
+	Table_AddColumn( table, "team", COL_INT );
+
+	table = &an->tables[TABLE_COMMANDS];
+	Table_AddColumn( table, "frame", COL_INT );
+	Table_AddColumn( table, "source", COL_INT );
+	Table_AddColumn( table, "text", COL_STRING );
+}
+
+/*
+* Analyzer_WriteHeader
+*/
+static void Analyzer_WriteHeader( analyzer_t *an ) {
+	int i, j;
+
+	an->chunk.size = 0;
+	Buf_Write( &an->chunk, "WDCF", 4 );
+	Buf_WriteVarint( &an->chunk, COLS_VERSION );
+	Buf_WriteVarint( &an->chunk, NUM_TABLES );
+	for( i = 0; i < NUM_TABLES; i++ ) {
+		const table_t *table = &an->tables[i];
+
+		Buf_WriteString( &an->chunk, table->name );
+		Buf_WriteVarint( &an->chunk, table->numColumns );
+		for( j = 0; j < table->numColumns; j++ ) {
+			uint8_t type = table->columns[j].type;
+			Buf_Write( &an->chunk, &type, 1 );
+			Buf_WriteString( &an->chunk, table->columns[j].name );
+		}
+	}
+	fwrite( an->chunk.data, 1, an->chunk.size, an->out );
+}
+
+/*
+=============================================================================
+
+DEMO PARSING
+
+=============================================================================
+*/
+
+/*
+* Analyzer_Command
+*/
+static void Analyzer_Command( analyzer_t *an, int source, const char *text ) {
+	table_t *t = Analyzer_BeginRow( an, TABLE_COMMANDS );
+
+	Table_Int( t, an->lastFrame ? an->lastFrame->serverFrame : 0 );
+	Table_Int( t, source );
+	Table_String( t, text );
+	Analyzer_EndRow( an, TABLE_COMMANDS );
+}
+
+/*
+* Analyzer_Frame
+*/
+static void Analyzer_Frame( analyzer_t *an, msg_t *msg ) {
+	int i;
+	table_t *t;
+	snapshot_t *frame;
+
+	frame = SNAP_ParseFrame( msg, an->lastFrame, NULL, an->snapShots, an->baselines, 0 );
+	if( !frame->valid ) {
+		return;
+	}
+
+	an->lastFrame = frame;
+	an->frames++;
+
+	t = Analyzer_BeginRow( an, TABLE_FRAMES );
+	Table_Int( t, frame->serverFrame );
+	Table_Int( t, frame->serverTime );
+	Table_Int( t, frame->delta ? 1 : 0 );
+	Table_Int( t, frame->numplayers );
+	Table_Int( t, frame->numEntities );
+	for( i = 0; i < MAX_GAME_STATS; i++ ) {
+		Table_Int( t, frame->gameState.stats[i] );
+	}
+	Analyzer_EndRow( an, TABLE_FRAMES );
+
+	for( i = 0; i < frame->numplayers; i++ ) {
+		const player_state_t *ps = &frame->playerStates[i];
+		int j;
+
+		t = Analyzer_BeginRow( an, TABLE_PLAYERS );
+		Table_Int( t, frame->serverFrame );
+		Table_Int( t, ps->playerNum );
+		Table_Int( t, ps->POVnum );
+		Table_Int( t, ps->pmove.pm_type );
+		Table_Int( t, ps->pmove.pm_flags );
+		Table_Vec3( t, ps->pmove.origin );
+		Table_Vec3( t, ps->pmove.velocity );
+		Table_Vec3( t, ps->viewangles );
+		Table_Int( t, ps->event[0] );
+		Table_Int( t, ps->eventParm[0] );
+		Table_Int( t, ps->event[1] );
+		Table_Int( t, ps->eventParm[1] );
+		Table_Int( t, ps->plrkeys );
+		Table_Int( t, ps->weaponState );
+		for( j = 0; j < PS_MAX_STATS; j++ ) {
+			Table_Int( t, ps->stats[j] );
+		}
+		Analyzer_EndRow( an, TABLE_PLAYERS );
+	}
+
+	for( i = 0; i < frame->numEntities; i++ ) {
+		const entity_state_t *ent = &frame->parsedEntities[i];
+
+		t = Analyzer_BeginRow( an, TABLE_ENTITIES );
+		Table_Int( t, frame->serverFrame );
+		Table_Int( t, ent->number );
+		Table_Int( t, ent->type );
+		Table_Int( t, ent->solid );
+		Table_Int( t, ent->modelindex );
+		Table_Int( t, ent->modelindex2 );
+		Table_Vec3( t, ent->origin );
+		Table_Vec3( t, ent->angles );
+		Table_Int( t, ent->frame );
+		Table_Int( t, ent->effects );
+		Table_Int( t, ent->events[0] );
+		Table_Int( t, ent->eventParms[0] );
+		Table_Int( t, ent->events[1] );
+		Table_Int( t, ent->eventParms[1] );
+		Table_Int( t, ent->ownerNum );
+		Table_Int( t, ent->targetNum );
+		Table_Int( t, ent->weapon );
+		Table_Int( t, ent->team );
+		Analyzer_EndRow( an, TABLE_ENTITIES );
+	}
+
+	for( i = 0; i < frame->numgamecommands; i++ ) {
+		Analyzer_Command( an, COMMAND_GAME, frame->gamecommandsData + frame->gamecommands[i].commandOffset );
+	}
+}
+
+/*
+* Analyzer_ServerData
+*/
+static bool Analyzer_ServerData( msg_t *msg ) {
+	int bitflags, numpure;
+
+	MSG_ReadInt32( msg );   // protocol
+	MSG_ReadInt32( msg );   // spawn count
+	MSG_ReadInt16( msg );   // snap frame time
+	MSG_ReadString( msg );  // base game directory
+	MSG_ReadString( msg );  // game directory
+	MSG_ReadInt16( msg );   // player number
+	MSG_ReadString( msg );  // level name
+
+	bitflags = MSG_ReadUint8( msg );
+	if( bitflags & SV_BITFLAGS_HTTP ) {
+		if( bitflags & SV_BITFLAGS_HTTP_BASEURL ) {
+			MSG_ReadString( msg );
+		} else {
+			MSG_ReadInt16( msg );
+		}
+	}
+
+	for( numpure = MSG_ReadInt16( msg ); numpure > 0; numpure-- ) {
+		MSG_ReadString( msg );
+		MSG_ReadInt32( msg );
+	}
+
+	return ( bitflags & SV_BITFLAGS_RELIABLE ) != 0;
+}
+
+/*
+* Analyzer_Message
+*/
+static void Analyzer_Message( analyzer_t *an, msg_t *msg ) {
+	int cmd, len;
+
+	while( msg->readcount < msg->cursize ) {
+		cmd = MSG_ReadUint8( msg );
+		switch( cmd ) {
+			case svc_nop:
+				break;
+			case svc_demoinfo:
+				MSG_ReadInt32( msg );
+				MSG_ReadInt32( msg );
+				MSG_ReadInt32( msg );
+				MSG_SkipData( msg, MSG_ReadInt32( msg ) );
+				break;
+			case svc_serverdata:
+				an->reliable = Analyzer_ServerData( msg );
+				break;
+			case svc_servercmd:
+				if( !an->reliable ) {
+					MSG_ReadInt32( msg );
+				}
+				Analyzer_Command( an, COMMAND_SERVER, MSG_ReadString( msg ) );
+				break;
+			case svc_servercs:
+				Analyzer_Command( an, COMMAND_SERVER, MSG_ReadString( msg ) );
+				break;
+			case svc_spawnbaseline:
+				SNAP_ParseBaseline( msg, an->baselines );
+				break;
+			case svc_clcack:
+				MSG_ReadUintBase128( msg );
+				MSG_ReadUintBase128( msg );
+				break;
+			case svc_frame:
+				Analyzer_Frame( an, msg );
+				break;
+			case svc_extension:
+				MSG_ReadUint8( msg );
+				MSG_ReadUint8( msg );
+				len = MSG_ReadInt16( msg );
+				MSG_SkipData( msg, len );
+				break;
+			default:
+				Com_Error( ERR_DROP, "Unexpected server command %i", cmd );
+				break;
+		}
+	}
+}
+
+/*
+* Analyzer_OutputName
+*/
+static void Analyzer_OutputName( const char *demo, char *dest, size_t size ) {
+	const char *base;
+
+	if( outDir ) {
+		base = strrchr( demo, '/' );
+#ifdef _WIN32
+		if( strrchr( demo, '\\' ) > base ) {
+			base = strrchr( demo, '\\' );
+		}
+#endif
+		base = base ? base + 1 : demo;
+		Q_snprintfz( dest, size, "%s/%s", outDir, base );
+	} else {
+		Q_strncpyz( dest, demo, size );
+	}
+
+	COM_ReplaceExtension( dest, COLS_EXTENSION, size );
+}
+
+/*
+* Analyzer_Demo
+*
+* Reads the demo messages like SNAP_ReadDemoMessage does: a little-endian
+* length followed by the message, until a length of -1.
+*/
+static bool Analyzer_Demo( analyzer_t *an, const char *filename ) {
+	int i;
+	uint8_t len[4];
+	uint32_t msglen;
+	bool ok = true;
+	gzFile f;
+	msg_t msg;
+	jmp_buf abort;
+	char outName[1024];
+
+	f = gzopen( filename, "rb" );
+	if( !f ) {
+		fprintf( stderr, "Couldn't open %s\n", filename );
+		return false;
+	}
+
+	Analyzer_OutputName( filename, outName, sizeof( outName ) );
+	an->out = fopen( outName, "wb" );
+	if( !an->out ) {
+		fprintf( stderr, "Couldn't open %s for writing\n", outName );
+		gzclose( f );
+		return false;
+	}
+
+	memset( an->baselines, 0, sizeof( an->baselines ) );
+	memset( an->snapShots, 0, sizeof( an->snapShots ) );
+	for( i = 0; i < UPDATE_BACKUP; i++ ) {
+		an->snapShots[i].areabytes = MAX_AREA_BYTES;
+		an->snapShots[i].areabits = an->areabits[i];
+	}
+	for( i = 0; i < NUM_TABLES; i++ ) {
+		an->tables[i].totalRows = 0;
+	}
+	an->reliable = false;
+	an->lastFrame = NULL;
+	an->frames = 0;
+
+	Analyzer_WriteHeader( an );
+
+	abortDemo = &abort;
+	if( setjmp( abort ) ) {
+		fprintf( stderr, "Stopped parsing %s\n", filename );
+		ok = false;
+	} else {
+		MSG_Init( &msg, an->msgData, sizeof( an->msgData ) );
+
+		while( gzread( f, len, 4 ) == 4 ) {
+			msglen = len[0] | ( len[1] << 8 ) | ( len[2] << 16 ) | ( ( uint32_t )len[3] << 24 );
+			if( msglen == 0xFFFFFFFF ) {
+				break;
+			}
+			if( msglen > MAX_MSGLEN ) {
+				fprintf( stderr, "%s: message length %u exceeds %i\n", filename, msglen, MAX_MSGLEN );
+				ok = false;
+				break;
+			}
+			if( gzread( f, an->msgData, msglen ) != (int)msglen ) {
+				fprintf( stderr, "%s: truncated message\n", filename );
+				ok = false;
+				break;
+			}
+
+			msg.cursize = msglen;
+			msg.readcount = 0;
+			Analyzer_Message( an, &msg );
+		}
+	}
+	abortDemo = NULL;
+
+	// keep whatever was decoded before an error
+	for( i = 0; i < NUM_TABLES; i++ ) {
+		Analyzer_FlushTable( an, i );
+		an->tables[i].numRows = 0;
+	}
+
+	fclose( an->out );
+	an->out = NULL;
+	gzclose( f );
+
+	QMutex_Lock( queueLock );
+	printf( "%s: %" PRIi64 " snapshots, %" PRIi64 " player and %" PRIi64 " entity records -> %s\n",
+			filename, an->frames, an->tables[TABLE_PLAYERS].totalRows, an->tables[TABLE_ENTITIES].totalRows, outName );
+	totalFrames += an->frames;
+	for( i = 0; i < NUM_TABLES; i++ ) {
+		totalRows[i] += an->tables[i].totalRows;
+	}
+	QMutex_Unlock( queueLock );
+
+	return ok;
+}
+
+/*
+* Analyzer_IsFile
+*/
+static bool Analyzer_IsFile( const char *filename ) {
+	struct stat st;
+
+	if( stat( filename, &st ) < 0 ) {
+		fprintf( stderr, "Couldn't open %s\n", filename );
+		return false;
+	}
+	if( ( st.st_mode & S_IFMT ) != S_IFREG ) {
+		fprintf( stderr, "Skipping %s, not a regular file\n", filename );
+		return false;
+	}
+	return true;
+}
+
+/*
+* Analyzer_Thread
+*/
+static void *Analyzer_Thread( void *param ) {
+	int i, demo;
+	analyzer_t *an;
+
+	an = Q_malloc( sizeof( *an ) );
+	Analyzer_InitTables( an );
+
+	while( true ) {
+		QMutex_Lock( queueLock );
+		demo = nextDemo < numDemos ? nextDemo++ : -1;
+		QMutex_Unlock( queueLock );
+
+		if( demo < 0 ) {
+			break;
+		}
+
+		if( !Analyzer_Demo( an, demos[demo] ) ) {
+			QMutex_Lock( queueLock );
+			numFailed++;
+			QMutex_Unlock( queueLock );
+		}
+	}
+
+	for( i = 0; i < NUM_TABLES; i++ ) {
+		int j;
+		for( j = 0; j < an->tables[i].numColumns; j++ ) {
+			free( an->tables[i].columns[j].data.data );
+		}
+	}
+	free( an->chunk.data );
+	Q_free( an );
+
+	return NULL;
+}
+
+int main( int argc, char **argv ) {
+	int i, numThreads = 0, numSkipped = 0;
+	uint64_t start, time;
+	qthread_t *threads[MAX_THREADS];
+
+	demos = malloc( argc * sizeof( *demos ) );
+	for( i = 1; i < argc; i++ ) {
+		if( !strcmp( argv[i], "-threads" ) && i + 1 < argc ) {
+			numThreads = atoi( argv[++i] );
+		} else if( !strcmp( argv[i], "-out" ) && i + 1 < argc ) {
+			outDir = argv[++i];
+		} else if( argv[i][0] == '-' ) {
+			fprintf( stderr, "Unknown option %s\n", argv[i] );
+			numDemos = 0;
+			break;
+		} else if( Analyzer_IsFile( argv[i] ) ) {
+			demos[numDemos++] = argv[i];
+		} else {
+			numSkipped++;
+		}
+	}
+
+	if( !numDemos ) {
+		fprintf( stderr, "usage: %s [-threads n] [-out dir] demo [demo...]\n", argv[0] );
+		free( demos );
+		return EXIT_FAILURE;
+	}
+
+	if( numThreads <= 0 ) {
+		numThreads = Analyzer_NumProcessors();
+	}
+	numThreads = Q_bound( 1, numThreads, min( numDemos, MAX_THREADS ) );
+
+	queueLock = QMutex_Create();
+
+	start = Analyzer_Microseconds();
+	for( i = 0; i < numThreads; i++ ) {
+		threads[i] = QThread_Create( Analyzer_Thread, NULL );
+	}
+	for( i = 0; i < numThreads; i++ ) {
+		QThread_Join( threads[i] );
+	}
+	time = Analyzer_Microseconds() - start;
+
+	printf( "total: %i demos on %i threads, %" PRIi64 " snapshots, %" PRIi64 " frame, %" PRIi64 " player, %" PRIi64 " entity and %" PRIi64 " command records in %.2f s (%.0f snapshots/s)\n",
+			numDemos, numThreads, totalFrames, totalRows[TABLE_FRAMES], totalRows[TABLE_PLAYERS],
+			totalRows[TABLE_ENTITIES], totalRows[TABLE_COMMANDS], time / 1000000.0,
+			time ? totalFrames * 1000000.0 / time : 0.0 );
+
+	QMutex_Destroy( &queueLock );
+	free( demos );
+
+	return numFailed || numSkipped ? EXIT_FAILURE : EXIT_SUCCESS;
+}
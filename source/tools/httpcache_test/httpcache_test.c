@@ -0,0 +1,757 @@
+/*
+Copyright (C) 2018 Warsow development team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+// httpcache_test -- runs wswcurl against a tiny HTTP/1.1 server on the
+// loopback interface and checks that connections are reused and that the
+// response cache revalidates and replays bodies correctly
+//
+// usage: httpcache_test [-v]
+//
+// Every resource is fetched twice in a row. The second request must be
+// conditional and answered with 304 by the server, while the caller still
+// gets a 200 with the original body. Responses with Vary must not be cached.
+// All requests must go over a single connection. Exits with a non-zero
+// status if any check fails.
+
+#ifdef _WIN32
+#include <winsock2.h>
+#endif
+
+#include "../../qcommon/qcommon.h"
+#include "../../qcommon/wswcurl.h"
+
+#ifdef _WIN32
+typedef int socklen_t;
+#define Test_CloseSocket closesocket
+#else
+#include <sys/time.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/select.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <dlfcn.h>
+#define Test_CloseSocket close
+#endif
+
+#define MAX_TEST_CLIENTS    4
+#define MAX_REQUEST_SIZE    4096
+#define MAX_BODY_SIZE       1024
+
+// abort a fetch which hasn't finished after this many milliseconds
+#define TEST_FETCH_TIMEOUT  5000
+
+#define TEST_LAST_MODIFIED  "Sat, 01 Sep 2018 12:00:00 GMT"
+
+typedef struct {
+	const char *path;
+	const char *etag;
+	const char *lastModified;
+	const char *vary;
+	const char *body;
+
+	// updated by the server thread
+	int requests;
+	int conditional;    // requests that carried any validator
+	int notModified;    // requests answered with 304
+} testResource_t;
+
+typedef struct {
+	socket_handle_t socket;
+	size_t size;
+	char data[MAX_REQUEST_SIZE];
+} testClient_t;
+
+typedef struct {
+	bool done;
+	int status;
+	size_t size;
+	char body[MAX_BODY_SIZE];
+	char contentType[64];
+} testFetch_t;
+
+// keeps the data that follows it aligned
+typedef union testAlloc_u {
+	struct {
+		union testAlloc_u *prev, *next;
+	} link;
+	uint8_t align[32];
+} testAlloc_t;
+
+struct mempool_s {
+	testAlloc_t head;
+};
+
+static testResource_t testResources[] = {
+	{ "/etag", "\"wsw-1\"", NULL, NULL, "revalidated with If-None-Match\n" },
+	{ "/lastmodified", NULL, TEST_LAST_MODIFIED, NULL, "revalidated with If-Modified-Since\n" },
+	{ "/vary", "\"wsw-2\"", NULL, "Accept-Encoding", "must not be cached\n" },
+};
+
+static const int numTestResources = sizeof( testResources ) / sizeof( testResources[0] );
+
+static cvar_t testCvars[] = {
+	{ "http_proxy", "", "", NULL, 0, false, 0, 0 },
+	{ "http_proxyuserpwd", "", "", NULL, 0, false, 0, 0 },
+	{ "http_cache", "1", "1", NULL, 0, false, 1, 1 },
+	{ "http_maxhostconnections", "4", "4", NULL, 0, false, 4, 4 },
+	{ "developer", "0", "0", NULL, 0, false, 0, 0 },
+};
+
+static qmutex_t *serverLock;
+static socket_handle_t serverSocket = INVALID_SOCKET;
+static volatile bool serverQuit;
+static int serverConnections;
+
+static int numFailed;
+
+cvar_t *developer;
+mempool_t *tempMemPool;
+
+/*
+* Com_Printf
+*/
+void Com_Printf( const char *format, ... ) {
+	va_list argptr;
+
+	va_start( argptr, format );
+	vprintf( format, argptr );
+	va_end( argptr );
+}
+
+/*
+* Com_Error
+*/
+void Com_Error( com_error_code_t code, const char *format, ... ) {
+	va_list argptr;
+
+	va_start( argptr, format );
+	vfprintf( stderr, format, argptr );
+	va_end( argptr );
+	fputc( '\n', stderr );
+
+	exit( EXIT_FAILURE );
+}
+
+/*
+* Sys_Error
+*/
+void Sys_Error( const char *format, ... ) {
+	va_list argptr;
+
+	va_start( argptr, format );
+	vfprintf( stderr, format, argptr );
+	va_end( argptr );
+	fputc( '\n', stderr );
+
+	exit( EXIT_FAILURE );
+}
+
+/*
+* Q_malloc
+*/
+void *Q_malloc( size_t size ) {
+	void *buf = calloc( 1, size );
+
+	if( !buf ) {
+		Sys_Error( "Q_malloc: failed on allocation of %" PRIuPTR " bytes.\n", (uintptr_t)size );
+	}
+	return buf;
+}
+
+/*
+* Q_free
+*/
+void Q_free( void *buf ) {
+	free( buf );
+}
+
+/*
+* Cvar_Get
+*/
+cvar_t *Cvar_Get( const char *var_name, const char *value, cvar_flag_t flags ) {
+	size_t i;
+
+	for( i = 0; i < sizeof( testCvars ) / sizeof( testCvars[0] ); i++ ) {
+		if( !strcmp( testCvars[i].name, var_name ) ) {
+			return &testCvars[i];
+		}
+	}
+
+	Sys_Error( "Unknown cvar %s", var_name );
+	return NULL;
+}
+
+/*
+* Com_LoadSysLibrary
+*
+* Tries the '|' separated names in order.
+*/
+void *Com_LoadSysLibrary( const char *name, dllfunc_t *funcs ) {
+	char *names, *s;
+	void *lib = NULL;
+	dllfunc_t *func;
+
+	names = Q_malloc( strlen( name ) + 1 );
+	strcpy( names, name );
+
+	for( s = strtok( names, "|" ); s && !lib; s = strtok( NULL, "|" ) ) {
+#ifdef _WIN32
+		lib = (void *)LoadLibraryA( s );
+#else
+		lib = dlopen( s, RTLD_NOW );
+#endif
+		if( !lib ) {
+			continue;
+		}
+
+		for( func = funcs; func->name; func++ ) {
+#ifdef _WIN32
+			*func->funcPointer = (void *)GetProcAddress( (HMODULE)lib, func->name );
+#else
+			*func->funcPointer = dlsym( lib, func->name );
+#endif
+			if( !*func->funcPointer ) {
+				break;
+			}
+		}
+
+		if( func->name ) {
+			fprintf( stderr, "%s has no %s\n", s, func->name );
+#ifdef _WIN32
+			FreeLibrary( (HMODULE)lib );
+#else
+			dlclose( lib );
+#endif
+			lib = NULL;
+		}
+	}
+
+	Q_free( names );
+	return lib;
+}
+
+/*
+* Com_UnloadLibrary
+*/
+void Com_UnloadLibrary( void **lib ) {
+	if( !*lib ) {
+		return;
+	}
+#ifdef _WIN32
+	FreeLibrary( (HMODULE)*lib );
+#else
+	dlclose( *lib );
+#endif
+	*lib = NULL;
+}
+
+/*
+* _Mem_AllocPool
+*/
+mempool_t *_Mem_AllocPool( mempool_t *parent, const char *name, int flags, const char *filename, int fileline ) {
+	mempool_t *pool = Q_malloc( sizeof( *pool ) );
+
+	pool->head.link.prev = pool->head.link.next = &pool->head;
+	return pool;
+}
+
+/*
+* _Mem_Alloc
+*/
+void *_Mem_Alloc( mempool_t *pool, size_t size, int musthave, int canthave, const char *filename, int fileline ) {
+	testAlloc_t *a = Q_malloc( sizeof( *a ) + size );
+
+	a->link.prev = &pool->head;
+	a->link.next = pool->head.link.next;
+	a->link.next->link.prev = a;
+	a->link.prev->link.next = a;
+	return a + 1;
+}
+
+/*
+* _Mem_Realloc
+*/
+void *_Mem_Realloc( void *data, size_t size, const char *filename, int fileline ) {
+	testAlloc_t *a = ( testAlloc_t * )data - 1;
+
+	a = realloc( a, sizeof( *a ) + size );
+	if( !a ) {
+		Sys_Error( "Mem_Realloc: failed on allocation of %" PRIuPTR " bytes.\n", (uintptr_t)size );
+	}
+
+	// the neighbours still point at the old block
+	a->link.next->link.prev = a;
+	a->link.prev->link.next = a;
+	return a + 1;
+}
+
+/*
+* _Mem_Free
+*/
+void _Mem_Free( void *data, int musthave, int canthave, const char *filename, int fileline ) {
+	testAlloc_t *a;
+
+	if( !data ) {
+		return;
+	}
+
+	a = ( testAlloc_t * )data - 1;
+	a->link.prev->link.next = a->link.next;
+	a->link.next->link.prev = a->link.prev;
+	Q_free( a );
+}
+
+/*
+* _Mem_FreePool
+*/
+void _Mem_FreePool( mempool_t **pool, int musthave, int canthave, const char *filename, int fileline ) {
+	if( !*pool ) {
+		return;
+	}
+
+	while( ( *pool )->head.link.next != &( *pool )->head ) {
+		_Mem_Free( ( *pool )->head.link.next + 1, musthave, canthave, filename, fileline );
+	}
+	Q_free( *pool );
+	*pool = NULL;
+}
+
+/*
+* Test_Milliseconds
+*/
+static int64_t Test_Milliseconds( void ) {
+#ifdef _WIN32
+	return (int64_t)GetTickCount();
+#else
+	struct timeval tv;
+	gettimeofday( &tv, NULL );
+	return (int64_t)tv.tv_sec * 1000 + tv.tv_usec / 1000;
+#endif
+}
+
+/*
+* Test_Sleep
+*/
+static void Test_Sleep( unsigned int millis ) {
+#ifdef _WIN32
+	Sleep( millis );
+#else
+	usleep( millis * 1000 );
+#endif
+}
+
+/*
+* Test_Check
+*/
+static void Test_Check( bool passed, const char *what, const char *path ) {
+	printf( "%s: %s %s\n", passed ? "ok" : "FAILED", path, what );
+	if( !passed ) {
+		numFailed++;
+	}
+}
+
+/*
+* Server_FindHeader
+*
+* Returns the value of the header in the request, which ends at the empty line.
+*/
+static const char *Server_FindHeader( const char *request, const char *name, char *value, size_t size ) {
+	const char *line, *end;
+	size_t len = strlen( name );
+
+	for( line = strstr( request, "\r\n" ); line && line[2] != '\r'; line = strstr( line + 2, "\r\n" ) ) {
+		if( Q_strnicmp( line + 2, name, len ) || line[2 + len] != ':' ) {
+			continue;
+		}
+
+		line += 2 + len + 1;
+		while( *line == ' ' || *line == '\t' ) {
+			line++;
+		}
+		end = strstr( line, "\r\n" );
+		Q_strncpyz( value, line, min( size, (size_t)( end - line + 1 ) ) );
+		return value;
+	}
+
+	return NULL;
+}
+
+/*
+* Server_Respond
+*/
+static void Server_Respond( socket_handle_t s, const char *request ) {
+	int i;
+	char path[MAX_QPATH], value[256];
+	char response[MAX_REQUEST_SIZE];
+	const char *sep;
+	testResource_t *res = NULL;
+	bool conditional, notModified;
+
+	// "GET /path HTTP/1.1"
+	sep = strchr( request, ' ' );
+	if( sep ) {
+		Q_strncpyz( path, sep + 1, sizeof( path ) );
+		if( strchr( path, ' ' ) ) {
+			*strchr( path, ' ' ) = '\0';
+		}
+
+		for( i = 0; i < numTestResources; i++ ) {
+			if( !strcmp( testResources[i].path, path ) ) {
+				res = &testResources[i];
+				break;
+			}
+		}
+	}
+
+	if( !res ) {
+		Q_strncpyz( response, "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\n\r\n", sizeof( response ) );
+		send( s, response, (int)strlen( response ), 0 );
+		return;
+	}
+
+	conditional = notModified = false;
+	if( Server_FindHeader( request, "If-None-Match", value, sizeof( value ) ) ) {
+		conditional = true;
+		notModified = res->etag && !strcmp( value, res->etag );
+	} else if( Server_FindHeader( request, "If-Modified-Since", value, sizeof( value ) ) ) {
+		conditional = true;
+		notModified = res->lastModified && !strcmp( value, res->lastModified );
+	}
+
+	QMutex_Lock( serverLock );
+	res->requests++;
+	if( conditional ) {
+		res->conditional++;
+	}
+	if( notModified ) {
+		res->notModified++;
+	}
+	QMutex_Unlock( serverLock );
+
+	Q_snprintfz( response, sizeof( response ), notModified ? "HTTP/1.1 304 Not Modified\r\n" : "HTTP/1.1 200 OK\r\n" );
+	if( res->etag ) {
+		Q_strncatz( response, va( "ETag: %s\r\n", res->etag ), sizeof( response ) );
+	}
+	if( res->lastModified ) {
+		Q_strncatz( response, va( "Last-Modified: %s\r\n", res->lastModified ), sizeof( response ) );
+	}
+	if( res->vary ) {
+		Q_strncatz( response, va( "Vary: %s\r\n", res->vary ), sizeof( response ) );
+	}
+	if( notModified ) {
+		Q_strncatz( response, "\r\n", sizeof( response ) );
+	} else {
+		Q_strncatz( response, va( "Content-Type: text/plain\r\nContent-Length: %i\r\n\r\n%s",
+			(int)strlen( res->body ), res->body ), sizeof( response ) );
+	}
+
+	send( s, response, (int)strlen( response ), 0 );
+}
+
+/*
+* Server_Read
+*
+* Answers the complete requests received on the connection.
+* Returns false when the connection is closed.
+*/
+static bool Server_Read( testClient_t *client ) {
+	int ret;
+	char *end;
+	size_t len;
+
+	ret = recv( client->socket, client->data + client->size, (int)( sizeof( client->data ) - client->size - 1 ), 0 );
+	if( ret <= 0 ) {
+		return false;
+	}
+	client->size += ret;
+	client->data[client->size] = '\0';
+
+	// requests to the test resources never have a body
+	while( ( end = strstr( client->data, "\r\n\r\n" ) ) ) {
+		end[2] = '\0';
+		Server_Respond( client->socket, client->data );
+
+		len = end + 4 - client->data;
+		memmove( client->data, end + 4, client->size - len + 1 );
+		client->size -= len;
+	}
+
+	return client->size < sizeof( client->data ) - 1;
+}
+
+/*
+* Server_Thread
+*/
+static void *Server_Thread( void *param ) {
+	int i;
+	socket_handle_t s, maxs;
+	fd_set fds;
+	struct timeval tv;
+	testClient_t clients[MAX_TEST_CLIENTS];
+
+	for( i = 0; i < MAX_TEST_CLIENTS; i++ ) {
+		clients[i].socket = INVALID_SOCKET;
+	}
+
+	while( !serverQuit ) {
+		FD_ZERO( &fds );
+		FD_SET( serverSocket, &fds );
+		maxs = serverSocket;
+		for( i = 0; i < MAX_TEST_CLIENTS; i++ ) {
+			if( clients[i].socket != INVALID_SOCKET ) {
+				FD_SET( clients[i].socket, &fds );
+				maxs = max( maxs, clients[i].socket );
+			}
+		}
+
+		// wake up now and then to check for quitting
+		tv.tv_sec = 0;
+		tv.tv_usec = 50000;
+		if( select( (int)maxs + 1, &fds, NULL, NULL, &tv ) <= 0 ) {
+			continue;
+		}
+
+		if( FD_ISSET( serverSocket, &fds ) ) {
+			s = accept( serverSocket, NULL, NULL );
+			if( s != INVALID_SOCKET ) {
+				QMutex_Lock( serverLock );
+				serverConnections++;
+				QMutex_Unlock( serverLock );
+
+				for( i = 0; i < MAX_TEST_CLIENTS; i++ ) {
+					if( clients[i].socket == INVALID_SOCKET ) {
+						clients[i].socket = s;
+						clients[i].size = 0;
+						break;
+					}
+				}
+				if( i == MAX_TEST_CLIENTS ) {
+					Test_CloseSocket( s );
+				}
+			}
+		}
+
+		for( i = 0; i < MAX_TEST_CLIENTS; i++ ) {
+			if( clients[i].socket != INVALID_SOCKET && FD_ISSET( clients[i].socket, &fds ) ) {
+				if( !Server_Read( &clients[i] ) ) {
+					Test_CloseSocket( clients[i].socket );
+					clients[i].socket = INVALID_SOCKET;
+				}
+			}
+		}
+	}
+
+	for( i = 0; i < MAX_TEST_CLIENTS; i++ ) {
+		if( clients[i].socket != INVALID_SOCKET ) {
+			Test_CloseSocket( clients[i].socket );
+		}
+	}
+
+	return NULL;
+}
+
+/*
+* Server_Start
+*
+* Listens on an ephemeral loopback port and returns it, 0 on failure.
+*/
+static int Server_Start( void ) {
+	struct sockaddr_in addr;
+	socklen_t addrlen = sizeof( addr );
+
+	serverSocket = socket( AF_INET, SOCK_STREAM, IPPROTO_TCP );
+	if( serverSocket == INVALID_SOCKET ) {
+		return 0;
+	}
+
+	memset( &addr, 0, sizeof( addr ) );
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl( INADDR_LOOPBACK );
+	addr.sin_port = 0;
+
+	if( bind( serverSocket, ( struct sockaddr * )&addr, sizeof( addr ) ) || listen( serverSocket, MAX_TEST_CLIENTS )
+		|| getsockname( serverSocket, ( struct sockaddr * )&addr, &addrlen ) ) {
+		Test_CloseSocket( serverSocket );
+		serverSocket = INVALID_SOCKET;
+		return 0;
+	}
+
+	return ntohs( addr.sin_port );
+}
+
+/*
+* Test_Read
+*/
+static size_t Test_Read( wswcurl_req *req, const void *buf, size_t numb, float percentage, void *customp ) {
+	testFetch_t *fetch = customp;
+
+	if( fetch->size + numb >= sizeof( fetch->body ) ) {
+		return 0;
+	}
+
+	memcpy( fetch->body + fetch->size, buf, numb );
+	fetch->size += numb;
+	fetch->body[fetch->size] = '\0';
+	return numb;
+}
+
+/*
+* Test_Done
+*/
+static void Test_Done( wswcurl_req *req, int status, void *customp ) {
+	testFetch_t *fetch = customp;
+	const char *contentType = wswcurl_get_content_type( req );
+
+	Q_strncpyz( fetch->contentType, contentType ? contentType : "", sizeof( fetch->contentType ) );
+	fetch->status = status;
+	fetch->done = true;
+}
+
+/*
+* Test_Fetch
+*
+* Runs a single request to completion.
+*/
+static bool Test_Fetch( int port, const char *path, testFetch_t *fetch ) {
+	wswcurl_req *req;
+	int64_t start;
+
+	memset( fetch, 0, sizeof( *fetch ) );
+
+	req = wswcurl_create( NULL, "http://127.0.0.1:%i%s", port, path );
+	if( !req ) {
+		return false;
+	}
+
+	wswcurl_stream_callbacks( req, Test_Read, Test_Done, NULL, fetch );
+	wswcurl_start( req );
+
+	start = Test_Milliseconds();
+	while( !fetch->done && Test_Milliseconds() - start < TEST_FETCH_TIMEOUT ) {
+		wswcurl_perform();
+		Test_Sleep( 1 );
+	}
+
+	wswcurl_delete( req );
+	return fetch->done;
+}
+
+/*
+* Test_Resource
+*/
+static void Test_Resource( int port, testResource_t *res ) {
+	int i;
+	testFetch_t fetch;
+	bool cacheable = res->vary == NULL;
+
+	for( i = 0; i < 2; i++ ) {
+		if( !Test_Fetch( port, res->path, &fetch ) ) {
+			Test_Check( false, "request didn't finish", res->path );
+			return;
+		}
+
+		Test_Check( fetch.status == 200, va( "#%i status is %i", i + 1, fetch.status ), res->path );
+		Test_Check( !strcmp( fetch.body, res->body ), va( "#%i body matches", i + 1 ), res->path );
+		Test_Check( !strcmp( fetch.contentType, "text/plain" ), va( "#%i content type is '%s'", i + 1, fetch.contentType ), res->path );
+	}
+
+	QMutex_Lock( serverLock );
+	Test_Check( res->requests == 2, va( "reached the server %i times", res->requests ), res->path );
+	if( cacheable ) {
+		Test_Check( res->conditional == 1, "second request was conditional", res->path );
+		Test_Check( res->notModified == 1, "second request got 304", res->path );
+	} else {
+		Test_Check( res->conditional == 0, "wasn't cached", res->path );
+	}
+	QMutex_Unlock( serverLock );
+}
+
+int main( int argc, char **argv ) {
+	int i, port;
+	qthread_t *thread;
+
+	for( i = 1; i < argc; i++ ) {
+		if( !strcmp( argv[i], "-v" ) ) {
+			Cvar_Get( "developer", "0", 0 )->integer = 1;
+		} else {
+			fprintf( stderr, "Unknown option %s\n", argv[i] );
+			fprintf( stderr, "usage: %s [-v]\n", argv[0] );
+			return EXIT_FAILURE;
+		}
+	}
+
+#ifdef _WIN32
+	{
+		WSADATA wsaData;
+		if( WSAStartup( MAKEWORD( 2, 2 ), &wsaData ) ) {
+			fprintf( stderr, "WSAStartup failed\n" );
+			return EXIT_FAILURE;
+		}
+	}
+#else
+	// curl honors the proxy environment, the server must be reached directly
+	setenv( "no_proxy", "127.0.0.1", 1 );
+#endif
+
+	developer = Cvar_Get( "developer", "0", 0 );
+	tempMemPool = _Mem_AllocPool( NULL, "Temporary", 0, __FILE__, __LINE__ );
+
+	port = Server_Start();
+	if( !port ) {
+		fprintf( stderr, "Failed to start the server\n" );
+		return EXIT_FAILURE;
+	}
+
+	serverLock = QMutex_Create();
+	thread = QThread_Create( Server_Thread, NULL );
+
+	wswcurl_init();
+
+	for( i = 0; i < numTestResources; i++ ) {
+		Test_Resource( port, &testResources[i] );
+	}
+
+	QMutex_Lock( serverLock );
+	Test_Check( serverConnections == 1, va( "requests used %i connection(s)", serverConnections ), "*" );
+	QMutex_Unlock( serverLock );
+
+	wswcurl_cleanup();
+
+	serverQuit = true;
+	QThread_Join( thread );
+	QMutex_Destroy( &serverLock );
+	Test_CloseSocket( serverSocket );
+
+	_Mem_FreePool( &tempMemPool, 0, 0, __FILE__, __LINE__ );
+
+#ifdef _WIN32
+	WSACleanup();
+#endif
+
+	if( numFailed ) {
+		printf( "%i check(s) failed\n", numFailed );
+		return EXIT_FAILURE;
+	}
+
+	printf( "all checks passed\n" );
+	return EXIT_SUCCESS;
+}
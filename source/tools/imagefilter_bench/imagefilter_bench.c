@@ -0,0 +1,297 @@
+/*
+Copyright (C) 2018 Warsow development team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+// imagefilter_bench -- runs the texture mipmapping and resampling kernels
+// over a directory of PNG images (or a synthetic image) without a renderer
+//
+// usage: imagefilter_bench [directory] [iterations]
+
+#include "../../gameshared/q_arch.h"
+#include "../../ref_gl/r_imagefilter.h"
+
+#include <png.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <sys/time.h>
+#endif
+
+#define DEFAULT_ITERATIONS  10
+#define SYNTHETIC_SIZE      2048
+
+#define BENCH_MAX( a, b ) ( ( a ) > ( b ) ? ( a ) : ( b ) )
+
+typedef struct {
+	int width, height, samples;
+	uint8_t *pixels;
+} benchImage_t;
+
+typedef struct {
+	double generic, simd;
+	bool exact;
+} benchResult_t;
+
+/*
+* Bench_Microseconds
+*/
+static uint64_t Bench_Microseconds( void ) {
+#ifdef _WIN32
+	static LARGE_INTEGER freq;
+	LARGE_INTEGER now;
+	if( !freq.QuadPart ) {
+		QueryPerformanceFrequency( &freq );
+	}
+	QueryPerformanceCounter( &now );
+	return ( uint64_t )( now.QuadPart * 1000000 / freq.QuadPart );
+#else
+	struct timeval tv;
+	gettimeofday( &tv, NULL );
+	return ( uint64_t )tv.tv_sec * 1000000 + tv.tv_usec;
+#endif
+}
+
+/*
+* Bench_LoadPNG
+*/
+static bool Bench_LoadPNG( const char *filename, benchImage_t *image ) {
+	png_image png;
+
+	memset( &png, 0, sizeof( png ) );
+	png.version = PNG_IMAGE_VERSION;
+
+	if( !png_image_begin_read_from_file( &png, filename ) ) {
+		return false;
+	}
+
+	png.format = PNG_FORMAT_RGBA;
+	image->width = png.width;
+	image->height = png.height;
+	image->samples = 4;
+	image->pixels = malloc( PNG_IMAGE_SIZE( png ) );
+
+	if( !png_image_finish_read( &png, NULL, image->pixels, 0, NULL ) ) {
+		free( image->pixels );
+		image->pixels = NULL;
+		return false;
+	}
+
+	return true;
+}
+
+/*
+* Bench_SyntheticImage
+*/
+static void Bench_SyntheticImage( benchImage_t *image, int size ) {
+	int i;
+	unsigned seed = 0x1234567;
+
+	image->width = image->height = size;
+	image->samples = 4;
+	image->pixels = malloc( size * size * 4 );
+	for( i = 0; i < size * size * 4; i++ ) {
+		seed = seed * 1103515245 + 12345;
+		image->pixels[i] = ( seed >> 16 ) & 255;
+	}
+}
+
+/*
+* Bench_MipChain
+*
+* Builds the full mipmap chain in place, just like the uploader does
+*/
+static void Bench_MipChain( uint8_t *data, int width, int height, int samples,
+							void ( *mipmap )( const uint8_t *, uint8_t *, int, int, int, int, int, int ) ) {
+	while( width > 1 || height > 1 ) {
+		mipmap( data, data, width, height, samples, 1, 0, height );
+		width = BENCH_MAX( width >> 1, 1 );
+		height = BENCH_MAX( height >> 1, 1 );
+	}
+}
+
+/*
+* Bench_Image
+*
+* Returns false if the buffers couldn't be allocated
+*/
+static bool Bench_Image( const benchImage_t *image, int iterations, benchResult_t *mip, benchResult_t *resample ) {
+	int i;
+	uint64_t t;
+	const int w = image->width, h = image->height, samples = image->samples;
+	const int ow = BENCH_MAX( w * 3 / 4, 1 ), oh = BENCH_MAX( h * 3 / 4, 1 );
+	const size_t size = (size_t)w * h * samples, osize = (size_t)ow * oh * samples;
+	uint8_t *a = malloc( size ), *b = malloc( size );
+	uint8_t *ra = malloc( osize ), *rb = malloc( osize );
+	unsigned *table = malloc( sizeof( *table ) * ow * 2 );
+	bool ok = a && b && ra && rb && table && iterations > 0;
+
+	memset( mip, 0, sizeof( *mip ) );
+	memset( resample, 0, sizeof( *resample ) );
+
+	if( !ok ) {
+		goto done;
+	}
+
+	for( i = 0; i < iterations; i++ ) {
+		memcpy( a, image->pixels, size );
+		t = Bench_Microseconds();
+		Bench_MipChain( a, w, h, samples, R_MipMapRows_Generic );
+		mip->generic += Bench_Microseconds() - t;
+
+		memcpy( b, image->pixels, size );
+		t = Bench_Microseconds();
+		Bench_MipChain( b, w, h, samples, R_MipMapRows );
+		mip->simd += Bench_Microseconds() - t;
+	}
+
+	// the whole buffer holds the last mipmaps and the untouched tail of the source
+	mip->exact = memcmp( a, b, size ) == 0;
+
+	R_ResampleColumnTable( table, w, ow, samples );
+	for( i = 0; i < iterations; i++ ) {
+		t = Bench_Microseconds();
+		R_ResampleRows_Generic( image->pixels, w, h, ra, ow, oh, samples, 1, table, 0, oh );
+		resample->generic += Bench_Microseconds() - t;
+
+		t = Bench_Microseconds();
+		R_ResampleRows( image->pixels, w, h, rb, ow, oh, samples, 1, table, 0, oh );
+		resample->simd += Bench_Microseconds() - t;
+	}
+
+	resample->exact = memcmp( ra, rb, osize ) == 0;
+
+	mip->generic /= iterations * 1000.0;
+	mip->simd /= iterations * 1000.0;
+	resample->generic /= iterations * 1000.0;
+	resample->simd /= iterations * 1000.0;
+
+done:
+	free( a );
+	free( b );
+	free( ra );
+	free( rb );
+	free( table );
+
+	return ok;
+}
+
+/*
+* Bench_Report
+*/
+static bool Bench_Report( const char *name, const benchImage_t *image, int iterations ) {
+	benchResult_t mip, resample;
+
+	if( !Bench_Image( image, iterations, &mip, &resample ) ) {
+		fprintf( stderr, "%s: out of memory\n", name );
+		return false;
+	}
+
+	printf( "%-40s %5ix%-5i mip %8.3f / %8.3f ms%s  resample %8.3f / %8.3f ms%s\n", name,
+			image->width, image->height,
+			mip.generic, mip.simd, mip.exact ? "" : " MISMATCH",
+			resample.generic, resample.simd, resample.exact ? "" : " MISMATCH" );
+
+	return mip.exact && resample.exact;
+}
+
+/*
+* Bench_File
+*/
+static int Bench_File( const char *dir, const char *name, int iterations ) {
+	char path[1024];
+	benchImage_t image;
+	size_t len = strlen( name );
+
+	if( len < 4 || Q_stricmp( name + len - 4, ".png" ) ) {
+		return 0;
+	}
+
+	snprintf( path, sizeof( path ), "%s/%s", dir, name );
+	if( !Bench_LoadPNG( path, &image ) ) {
+		fprintf( stderr, "Couldn't load %s\n", path );
+		return 0;
+	}
+
+	len = Bench_Report( name, &image, iterations ) ? 1 : -1;
+	free( image.pixels );
+	return (int)len;
+}
+
+int main( int argc, char **argv ) {
+	int iterations = DEFAULT_ITERATIONS;
+	int numImages = 0, numMismatches = 0, res;
+
+	if( argc > 2 ) {
+		iterations = BENCH_MAX( atoi( argv[2] ), 1 );
+	}
+
+	printf( "imagefilter_bench: %s kernels, %i iterations, generic / vectorized times\n", R_ImageFilterArch(), iterations );
+
+	if( argc < 2 ) {
+		benchImage_t image;
+
+		Bench_SyntheticImage( &image, SYNTHETIC_SIZE );
+		numMismatches += Bench_Report( "<synthetic>", &image, iterations ) ? 0 : 1;
+		free( image.pixels );
+		return numMismatches ? EXIT_FAILURE : EXIT_SUCCESS;
+	}
+
+#ifdef _WIN32
+	{
+		char pattern[1024];
+		WIN32_FIND_DATAA fd;
+		HANDLE h;
+
+		snprintf( pattern, sizeof( pattern ), "%s\\*.png", argv[1] );
+		h = FindFirstFileA( pattern, &fd );
+		if( h == INVALID_HANDLE_VALUE ) {
+			fprintf( stderr, "No images found in %s\n", argv[1] );
+			return EXIT_FAILURE;
+		}
+		do {
+			res = Bench_File( argv[1], fd.cFileName, iterations );
+			numImages += res != 0;
+			numMismatches += res < 0;
+		} while( FindNextFileA( h, &fd ) );
+		FindClose( h );
+	}
+#else
+	{
+		DIR *dir;
+		struct dirent *ent;
+
+		dir = opendir( argv[1] );
+		if( !dir ) {
+			fprintf( stderr, "Couldn't open %s\n", argv[1] );
+			return EXIT_FAILURE;
+		}
+		while( ( ent = readdir( dir ) ) != NULL ) {
+			res = Bench_File( argv[1], ent->d_name, iterations );
+			numImages += res != 0;
+			numMismatches += res < 0;
+		}
+		closedir( dir );
+	}
+#endif
+
+	printf( "%i images, %i mismatches\n", numImages, numMismatches );
+	return numMismatches ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,353 @@
+/*
+Copyright (C) 2018 Warsow development team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+// netcompress_bench -- replays the server messages stored in demo files
+// through the netchan compressors and compares sizes and times
+//
+// usage: netcompress_bench [-train dictfile] demo [demo...]
+//
+// -train writes a new preset dictionary, built from the most common strings
+// in the demos, as a C string that can be pasted into qcommon/net_dict.c
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <zlib.h>
+
+#include "../../qcommon/net_dict.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/time.h>
+#endif
+
+#define MAX_MSGLEN          32768   // keep in sync with qcommon.h
+#define MAX_DICT_SIZE       4096
+#define MIN_TOKEN_LEN       4
+#define MAX_TOKEN_LEN       64
+#define TOKEN_HASH_SIZE     0x40000
+
+enum {
+	MODE_COMPRESS2,     // what netchan did before: a fresh stream per message
+	MODE_STREAM,        // reused stream, reset per message
+	MODE_DICT,          // reused stream with the preset dictionary
+
+	NUM_MODES
+};
+
+static const char *modeNames[NUM_MODES] = { "compress2", "stream", "stream+dict" };
+static const int levels[] = { 1, 6, 9 };
+
+typedef struct {
+	unsigned length;
+	uint8_t *data;
+} benchMessage_t;
+
+typedef struct {
+	unsigned length;
+	unsigned count;
+	char text[MAX_TOKEN_LEN];
+} benchToken_t;
+
+static benchMessage_t *messages;
+static int numMessages, maxMessages;
+static uint64_t totalBytes;
+
+/*
+* Bench_Microseconds
+*/
+static uint64_t Bench_Microseconds( void ) {
+#ifdef _WIN32
+	static LARGE_INTEGER freq;
+	LARGE_INTEGER now;
+	if( !freq.QuadPart ) {
+		QueryPerformanceFrequency( &freq );
+	}
+	QueryPerformanceCounter( &now );
+	return ( uint64_t )( now.QuadPart * 1000000 / freq.QuadPart );
+#else
+	struct timeval tv;
+	gettimeofday( &tv, NULL );
+	return ( uint64_t )tv.tv_sec * 1000000 + tv.tv_usec;
+#endif
+}
+
+/*
+* Bench_LoadDemo
+*
+* Demos are a sequence of little-endian lengths each followed by a message,
+* terminated by a length of -1. gzread reads both plain and gzipped files.
+*/
+static int Bench_LoadDemo( const char *filename ) {
+	int count = 0;
+	uint8_t len[4];
+	uint32_t msglen;
+	gzFile f;
+
+	f = gzopen( filename, "rb" );
+	if( !f ) {
+		fprintf( stderr, "Couldn't open %s\n", filename );
+		return -1;
+	}
+
+	while( gzread( f, len, 4 ) == 4 ) {
+		msglen = len[0] | ( len[1] << 8 ) | ( len[2] << 16 ) | ( ( uint32_t )len[3] << 24 );
+		if( msglen == 0xFFFFFFFF || msglen > MAX_MSGLEN ) {
+			break;
+		}
+
+		if( numMessages == maxMessages ) {
+			maxMessages = maxMessages ? maxMessages * 2 : 1024;
+			messages = realloc( messages, maxMessages * sizeof( *messages ) );
+		}
+
+		messages[numMessages].length = msglen;
+		messages[numMessages].data = malloc( msglen ? msglen : 1 );
+		if( gzread( f, messages[numMessages].data, msglen ) != (int)msglen ) {
+			free( messages[numMessages].data );
+			break;
+		}
+
+		numMessages++;
+		totalBytes += msglen;
+		count++;
+	}
+
+	gzclose( f );
+	return count;
+}
+
+/*
+* Bench_Run
+*/
+static bool Bench_Run( int mode, int level ) {
+	int i, res;
+	uLongf outlen;
+	uint64_t start, time = 0, compressed = 0;
+	bool exact = true;
+	z_stream dstrm, istrm;
+	static uint8_t out[MAX_MSGLEN * 2], check[MAX_MSGLEN];
+
+	memset( &dstrm, 0, sizeof( dstrm ) );
+	memset( &istrm, 0, sizeof( istrm ) );
+	deflateInit2( &dstrm, level, Z_DEFLATED, MAX_WBITS, MAX_MEM_LEVEL, Z_DEFAULT_STRATEGY );
+	inflateInit2( &istrm, MAX_WBITS );
+
+	for( i = 0; i < numMessages; i++ ) {
+		const benchMessage_t *msg = &messages[i];
+
+		start = Bench_Microseconds();
+		if( mode == MODE_COMPRESS2 ) {
+			outlen = sizeof( out );
+			compress2( out, &outlen, msg->data, msg->length, level );
+		} else {
+			deflateReset( &dstrm );
+			if( mode == MODE_DICT ) {
+				deflateSetDictionary( &dstrm, netchan_zdict, netchan_zdictSize );
+			}
+			dstrm.next_in = msg->data;
+			dstrm.avail_in = msg->length;
+			dstrm.next_out = out;
+			dstrm.avail_out = sizeof( out );
+			deflate( &dstrm, Z_FINISH );
+			outlen = dstrm.total_out;
+		}
+		time += Bench_Microseconds() - start;
+
+		// netchan sends the message uncompressed when that's smaller
+		compressed += outlen < msg->length ? outlen : msg->length;
+
+		// make sure the message survives the trip through the netchan decoder
+		inflateReset( &istrm );
+		istrm.next_in = out;
+		istrm.avail_in = outlen;
+		istrm.next_out = check;
+		istrm.avail_out = sizeof( check );
+		res = inflate( &istrm, Z_FINISH );
+		if( res == Z_NEED_DICT ) {
+			inflateSetDictionary( &istrm, netchan_zdict, netchan_zdictSize );
+			res = inflate( &istrm, Z_FINISH );
+		}
+		if( res != Z_STREAM_END || istrm.total_out != msg->length || memcmp( check, msg->data, msg->length ) ) {
+			exact = false;
+		}
+	}
+
+	deflateEnd( &dstrm );
+	inflateEnd( &istrm );
+
+	printf( "  level %i %-12s %10llu bytes (%5.1f%%) %8.2f us/msg%s\n", level, modeNames[mode],
+			( unsigned long long )compressed, totalBytes ? 100.0 * compressed / totalBytes : 0.0,
+			numMessages ? (double)time / numMessages : 0.0, exact ? "" : "  MISMATCH" );
+	return exact;
+}
+
+/*
+* Bench_TokenHash
+*/
+static unsigned Bench_TokenHash( const uint8_t *s, unsigned len ) {
+	unsigned i, hash = 2166136261u;
+	for( i = 0; i < len; i++ ) {
+		hash = ( hash ^ s[i] ) * 16777619u;
+	}
+	return hash;
+}
+
+/*
+* Bench_CompareTokens
+*
+* Ascending by the number of bytes a token covers, so the most valuable
+* tokens end up closest to the end of the dictionary.
+*/
+static int Bench_CompareTokens( const void *a, const void *b ) {
+	const benchToken_t *ta = a, *tb = b;
+	uint64_t va = ( uint64_t )ta->count * ta->length, vb = ( uint64_t )tb->count * tb->length;
+	return va < vb ? -1 : va > vb ? 1 : 0;
+}
+
+/*
+* Bench_Train
+*
+* Counts the runs of printable characters in all messages and keeps the ones
+* covering the most bytes, up to MAX_DICT_SIZE.
+*/
+static bool Bench_Train( const char *filename ) {
+	int i, first;
+	unsigned j, k, start, len, size, numTokens = 0;
+	benchToken_t *table, *tokens;
+	FILE *f;
+
+	table = calloc( TOKEN_HASH_SIZE, sizeof( *table ) );
+
+	for( i = 0; i < numMessages; i++ ) {
+		const uint8_t *data = messages[i].data;
+
+		for( j = 0; j < messages[i].length; j = start + len + 1 ) {
+			start = j;
+			for( len = 0; start + len < messages[i].length; len++ ) {
+				uint8_t c = data[start + len];
+				if( c < 32 || c >= 127 ) {
+					break;
+				}
+			}
+			if( len < MIN_TOKEN_LEN ) {
+				continue;
+			}
+			if( len > MAX_TOKEN_LEN - 1 ) {
+				len = MAX_TOKEN_LEN - 1;
+			}
+
+			k = Bench_TokenHash( data + start, len ) & ( TOKEN_HASH_SIZE - 1 );
+			while( table[k].length && ( table[k].length != len || memcmp( table[k].text, data + start, len ) ) ) {
+				k = ( k + 1 ) & ( TOKEN_HASH_SIZE - 1 );
+			}
+			if( !table[k].length ) {
+				if( numTokens >= TOKEN_HASH_SIZE / 2 ) {
+					continue;
+				}
+				table[k].length = len;
+				memcpy( table[k].text, data + start, len );
+				numTokens++;
+			}
+			table[k].count++;
+		}
+	}
+
+	tokens = table;
+	for( j = 0, k = 0; j < TOKEN_HASH_SIZE; j++ ) {
+		if( table[j].length && table[j].count > 1 ) {
+			tokens[k++] = table[j];
+		}
+	}
+	numTokens = k;
+	qsort( tokens, numTokens, sizeof( *tokens ), Bench_CompareTokens );
+
+	// drop the least valuable tokens until the rest fits
+	size = 0;
+	for( first = numTokens; first > 0 && size + tokens[first - 1].length <= MAX_DICT_SIZE; first-- ) {
+		size += tokens[first - 1].length;
+	}
+
+	f = fopen( filename, "w" );
+	if( !f ) {
+		fprintf( stderr, "Couldn't open %s for writing\n", filename );
+		free( table );
+		return false;
+	}
+
+	fprintf( f, "// %u bytes from %i messages\n", size, numMessages );
+	for( j = first; j < numTokens; j++ ) {
+		fputs( "\t\"", f );
+		for( k = 0; k < tokens[j].length; k++ ) {
+			char c = tokens[j].text[k];
+			if( c == '"' || c == '\\' ) {
+				fputc( '\\', f );
+			}
+			fputc( c, f );
+		}
+		fputs( "\"\n", f );
+	}
+	fclose( f );
+
+	printf( "Wrote %u bytes of dictionary to %s\n", size, filename );
+	free( table );
+	return true;
+}
+
+int main( int argc, char **argv ) {
+	int i, mode, numMismatches = 0;
+	const char *trainFile = NULL;
+
+	for( i = 1; i < argc; i++ ) {
+		if( !strcmp( argv[i], "-train" ) && i + 1 < argc ) {
+			trainFile = argv[++i];
+		} else if( Bench_LoadDemo( argv[i] ) < 0 ) {
+			return EXIT_FAILURE;
+		}
+	}
+
+	if( !numMessages ) {
+		fprintf( stderr, "usage: %s [-train dictfile] demo [demo...]\n", argv[0] );
+		return EXIT_FAILURE;
+	}
+
+	printf( "netcompress_bench: %i messages, %llu bytes, %u bytes of preset dictionary\n",
+			numMessages, ( unsigned long long )totalBytes, netchan_zdictSize );
+
+	for( i = 0; i < (int)( sizeof( levels ) / sizeof( levels[0] ) ); i++ ) {
+		for( mode = 0; mode < NUM_MODES; mode++ ) {
+			numMismatches += Bench_Run( mode, levels[i] ) ? 0 : 1;
+		}
+	}
+
+	if( trainFile && !Bench_Train( trainFile ) ) {
+		return EXIT_FAILURE;
+	}
+
+	for( i = 0; i < numMessages; i++ ) {
+		free( messages[i].data );
+	}
+	free( messages );
+
+	return numMismatches ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,414 @@
+/*
+Copyright (C) 2018 Warsow development team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+// snapdelta_bench -- parses the snapshots stored in demo files and re-encodes
+// their packet entities both byte-aligned and bit-packed, reporting the bytes
+// per snapshot of each and checking that the bit-packed entities decode back
+// within the quantization error
+//
+// usage: snapdelta_bench [-anglebits n] demo [demo...]
+
+#include "../../qcommon/qcommon.h"
+#include "../../qcommon/snap_read.h"
+
+#include <setjmp.h>
+#include <zlib.h>
+
+#define DEFAULT_ANGLE_BITS  12
+#define MAX_AREA_BYTES      256
+
+typedef struct {
+	int64_t frames;
+	int64_t frameBytes;         // whole svc_frame as stored in the demo
+	int64_t byteEntities;       // svc_packetentities
+	int64_t bitEntities;        // svc_bitpacketentities
+	int64_t mismatches;
+} benchStats_t;
+
+static int angleBits = DEFAULT_ANGLE_BITS;
+
+static snapshot_t snapShots[UPDATE_BACKUP];
+static uint8_t areabits[UPDATE_BACKUP][MAX_AREA_BYTES];
+static entity_state_t baselines[MAX_EDICTS];
+static entity_state_t decoded[MAX_PARSE_ENTITIES];
+
+static jmp_buf abortDemo;
+
+/*
+* Com_Printf
+*/
+void Com_Printf( const char *format, ... ) {
+	va_list argptr;
+
+	va_start( argptr, format );
+	vprintf( format, argptr );
+	va_end( argptr );
+}
+
+/*
+* Com_Error
+*
+* Errors stop the current demo and move on to the next one.
+*/
+void Com_Error( com_error_code_t code, const char *format, ... ) {
+	va_list argptr;
+
+	va_start( argptr, format );
+	vfprintf( stderr, format, argptr );
+	va_end( argptr );
+	fputc( '\n', stderr );
+
+	longjmp( abortDemo, 1 );
+}
+
+/*
+* Sys_Error
+*/
+void Sys_Error( const char *format, ... ) {
+	va_list argptr;
+
+	va_start( argptr, format );
+	vfprintf( stderr, format, argptr );
+	va_end( argptr );
+	fputc( '\n', stderr );
+
+	exit( EXIT_FAILURE );
+}
+
+/*
+* Bench_EmitPacketEntities
+*
+* Mirrors SNAP_EmitPacketEntities for parsed snapshots.
+*/
+static void Bench_EmitPacketEntities( msg_t *msg, const snapshot_t *from, const snapshot_t *to, bool bitpacked ) {
+	int oldindex = 0, newindex = 0, oldnum, newnum;
+	int numFrom = from ? from->numEntities : 0;
+	int lastNumber = 0;
+	const entity_state_t *oldent, *newent;
+	msg_bitstream_t bits;
+
+	if( bitpacked ) {
+		MSG_WriteUint8( msg, svc_bitpacketentities );
+		MSG_BeginWritingBits( &bits, msg );
+		MSG_WriteBits( &bits, angleBits - 1, 4 );
+	} else {
+		MSG_WriteUint8( msg, svc_packetentities );
+	}
+
+	while( newindex < to->numEntities || oldindex < numFrom ) {
+		newent = newindex < to->numEntities ? &to->parsedEntities[newindex] : NULL;
+		newnum = newent ? newent->number : 9999;
+		oldent = oldindex < numFrom ? &from->parsedEntities[oldindex] : NULL;
+		oldnum = oldent ? oldent->number : 9999;
+
+		if( newnum == oldnum ) {
+			oldindex++;
+			newindex++;
+		} else if( newnum < oldnum ) {
+			oldent = &baselines[newnum];
+			newindex++;
+		} else {
+			newent = NULL;
+			oldindex++;
+		}
+
+		if( bitpacked ) {
+			MSG_WriteDeltaEntityBits( &bits, oldent, newent, &lastNumber, angleBits, newnum < oldnum );
+		} else {
+			MSG_WriteDeltaEntity( msg, oldent, newent, newnum < oldnum );
+		}
+	}
+
+	if( bitpacked ) {
+		MSG_WriteBitsVarint( &bits, 0 );
+		MSG_EndWritingBits( &bits );
+	} else {
+		MSG_WriteInt16( msg, 0 );
+	}
+}
+
+/*
+* Bench_DecodeBitEntities
+*
+* Returns the number of entities that don't match the parsed snapshot.
+*/
+static int Bench_DecodeBitEntities( msg_t *msg, const snapshot_t *from, const snapshot_t *to ) {
+	int i, oldindex = 0, number, lastNumber = 0, numDecoded = 0, mismatches = 0;
+	int numFrom = from ? from->numEntities : 0;
+	int decodedBits;
+	bool remove;
+	msg_bitstream_t bits;
+
+	MSG_BeginReading( msg );
+	MSG_ReadUint8( msg );
+	MSG_BeginReadingBits( &bits, msg );
+	decodedBits = MSG_ReadBits( &bits, 4 ) + 1;
+
+	while( ( number = MSG_ReadEntityNumberBits( &bits, &lastNumber, &remove ) ) != 0 && number < MAX_EDICTS ) {
+		for( ; oldindex < numFrom && from->parsedEntities[oldindex].number < number; oldindex++ ) {
+			decoded[numDecoded++ & ( MAX_PARSE_ENTITIES - 1 )] = from->parsedEntities[oldindex];
+		}
+		if( oldindex < numFrom && from->parsedEntities[oldindex].number == number ) {
+			if( !remove ) {
+				MSG_ReadDeltaEntityBits( &bits, &from->parsedEntities[oldindex], &decoded[numDecoded++ & ( MAX_PARSE_ENTITIES - 1 )], number, decodedBits );
+			}
+			oldindex++;
+		} else if( !remove ) {
+			MSG_ReadDeltaEntityBits( &bits, &baselines[number], &decoded[numDecoded++ & ( MAX_PARSE_ENTITIES - 1 )], number, decodedBits );
+		}
+	}
+	for( ; oldindex < numFrom; oldindex++ ) {
+		decoded[numDecoded++ & ( MAX_PARSE_ENTITIES - 1 )] = from->parsedEntities[oldindex];
+	}
+
+	if( numDecoded != to->numEntities ) {
+		return abs( numDecoded - to->numEntities );
+	}
+
+	for( i = 0; i < numDecoded; i++ ) {
+		entity_state_t expected = to->parsedEntities[i], got = decoded[i];
+		int j;
+
+		for( j = 0; j < 3; j++ ) {
+			float d = fabsf( anglemod( got.angles[j] ) - anglemod( expected.angles[j] ) );
+			if( min( d, 360.0f - d ) <= 180.0f / ( 1 << decodedBits ) + 0.001f ) {
+				got.angles[j] = expected.angles[j];
+			}
+			if( fabsf( got.origin[j] - expected.origin[j] ) <= 0.5f / MSG_COORD_SCALE + 0.01f ) {
+				got.origin[j] = expected.origin[j];
+			}
+		}
+
+		if( memcmp( &got, &expected, sizeof( got ) ) ) {
+			mismatches++;
+		}
+	}
+
+	return mismatches;
+}
+
+/*
+* Bench_Frame
+*/
+static void Bench_Frame( msg_t *msg, snapshot_t **lastFrame, benchStats_t *stats ) {
+	size_t start = msg->readcount;
+	snapshot_t *frame, *deltaFrame;
+	msg_t out;
+	static uint8_t outData[MAX_MSGLEN * 2];
+
+	frame = SNAP_ParseFrame( msg, *lastFrame, NULL, snapShots, baselines, 0 );
+	if( !frame->valid ) {
+		return;
+	}
+	*lastFrame = frame;
+
+	deltaFrame = NULL;
+	if( frame->delta ) {
+		deltaFrame = &snapShots[frame->deltaFrameNum & UPDATE_MASK];
+	}
+
+	stats->frames++;
+	stats->frameBytes += msg->readcount - start + 1;
+
+	MSG_Init( &out, outData, sizeof( outData ) );
+	Bench_EmitPacketEntities( &out, deltaFrame, frame, false );
+	stats->byteEntities += out.cursize;
+
+	MSG_Init( &out, outData, sizeof( outData ) );
+	Bench_EmitPacketEntities( &out, deltaFrame, frame, true );
+	stats->bitEntities += out.cursize;
+
+	stats->mismatches += Bench_DecodeBitEntities( &out, deltaFrame, frame );
+}
+
+/*
+* Bench_ServerData
+*/
+static bool Bench_ServerData( msg_t *msg ) {
+	int bitflags, numpure;
+
+	MSG_ReadInt32( msg );   // protocol
+	MSG_ReadInt32( msg );   // spawn count
+	MSG_ReadInt16( msg );   // snap frame time
+	MSG_ReadString( msg );  // base game directory
+	MSG_ReadString( msg );  // game directory
+	MSG_ReadInt16( msg );   // player number
+	MSG_ReadString( msg );  // level name
+
+	bitflags = MSG_ReadUint8( msg );
+	if( bitflags & SV_BITFLAGS_HTTP ) {
+		if( bitflags & SV_BITFLAGS_HTTP_BASEURL ) {
+			MSG_ReadString( msg );
+		} else {
+			MSG_ReadInt16( msg );
+		}
+	}
+
+	for( numpure = MSG_ReadInt16( msg ); numpure > 0; numpure-- ) {
+		MSG_ReadString( msg );
+		MSG_ReadInt32( msg );
+	}
+
+	return ( bitflags & SV_BITFLAGS_RELIABLE ) != 0;
+}
+
+/*
+* Bench_Message
+*/
+static void Bench_Message( msg_t *msg, bool *reliable, snapshot_t **lastFrame, benchStats_t *stats ) {
+	int cmd, len;
+
+	while( msg->readcount < msg->cursize ) {
+		cmd = MSG_ReadUint8( msg );
+		switch( cmd ) {
+			case svc_nop:
+				break;
+			case svc_demoinfo:
+				MSG_ReadInt32( msg );
+				MSG_ReadInt32( msg );
+				MSG_ReadInt32( msg );
+				MSG_SkipData( msg, MSG_ReadInt32( msg ) );
+				break;
+			case svc_serverdata:
+				*reliable = Bench_ServerData( msg );
+				break;
+			case svc_servercmd:
+				if( !*reliable ) {
+					MSG_ReadInt32( msg );
+				}
+				MSG_ReadString( msg );
+				break;
+			case svc_servercs:
+				MSG_ReadString( msg );
+				break;
+			case svc_spawnbaseline:
+				SNAP_ParseBaseline( msg, baselines );
+				break;
+			case svc_clcack:
+				MSG_ReadUintBase128( msg );
+				MSG_ReadUintBase128( msg );
+				break;
+			case svc_frame:
+				Bench_Frame( msg, lastFrame, stats );
+				break;
+			case svc_extension:
+				MSG_ReadUint8( msg );
+				MSG_ReadUint8( msg );
+				len = MSG_ReadInt16( msg );
+				MSG_SkipData( msg, len );
+				break;
+			default:
+				Com_Error( ERR_DROP, "Unexpected server command %i", cmd );
+				break;
+		}
+	}
+}
+
+/*
+* Bench_Demo
+*/
+static bool Bench_Demo( const char *filename, benchStats_t *total ) {
+	uint8_t len[4];
+	uint32_t msglen;
+	bool reliable = false;
+	gzFile f;
+	msg_t msg;
+	benchStats_t stats;
+	snapshot_t *lastFrame = NULL;
+	static uint8_t msgData[MAX_MSGLEN];
+	int i;
+
+	f = gzopen( filename, "rb" );
+	if( !f ) {
+		fprintf( stderr, "Couldn't open %s\n", filename );
+		return false;
+	}
+
+	memset( &stats, 0, sizeof( stats ) );
+	memset( baselines, 0, sizeof( baselines ) );
+	memset( snapShots, 0, sizeof( snapShots ) );
+	for( i = 0; i < UPDATE_BACKUP; i++ ) {
+		snapShots[i].areabytes = MAX_AREA_BYTES;
+		snapShots[i].areabits = areabits[i];
+	}
+
+	if( setjmp( abortDemo ) ) {
+		fprintf( stderr, "Stopped parsing %s\n", filename );
+	} else {
+		while( gzread( f, len, 4 ) == 4 ) {
+			msglen = len[0] | ( len[1] << 8 ) | ( len[2] << 16 ) | ( ( uint32_t )len[3] << 24 );
+			if( msglen == 0xFFFFFFFF || msglen > MAX_MSGLEN ) {
+				break;
+			}
+
+			MSG_Init( &msg, msgData, sizeof( msgData ) );
+			if( gzread( f, msgData, msglen ) != (int)msglen ) {
+				break;
+			}
+			msg.cursize = msglen;
+			Bench_Message( &msg, &reliable, &lastFrame, &stats );
+		}
+	}
+
+	gzclose( f );
+
+	if( stats.frames ) {
+		printf( "%s: %" PRIi64 " snapshots, %.1f bytes per snapshot, entities %.1f byte-aligned / %.1f bit-packed bytes (%.1f%%)%s\n",
+				filename, stats.frames, (double)stats.frameBytes / stats.frames,
+				(double)stats.byteEntities / stats.frames, (double)stats.bitEntities / stats.frames,
+				stats.byteEntities ? 100.0 * stats.bitEntities / stats.byteEntities : 0.0,
+				stats.mismatches ? va( ", %" PRIi64 " MISMATCHES", stats.mismatches ) : "" );
+	}
+
+	total->frames += stats.frames;
+	total->frameBytes += stats.frameBytes;
+	total->byteEntities += stats.byteEntities;
+	total->bitEntities += stats.bitEntities;
+	total->mismatches += stats.mismatches;
+	return true;
+}
+
+int main( int argc, char **argv ) {
+	int i, numDemos = 0;
+	benchStats_t total;
+
+	memset( &total, 0, sizeof( total ) );
+
+	for( i = 1; i < argc; i++ ) {
+		if( !strcmp( argv[i], "-anglebits" ) && i + 1 < argc ) {
+			angleBits = Q_bound( MSG_ANGLE_BITS_MIN, atoi( argv[++i] ), MSG_ANGLE_BITS_MAX );
+		} else if( Bench_Demo( argv[i], &total ) ) {
+			numDemos++;
+		}
+	}
+
+	if( !numDemos ) {
+		fprintf( stderr, "usage: %s [-anglebits n] demo [demo...]\n", argv[0] );
+		return EXIT_FAILURE;
+	}
+
+	if( total.frames ) {
+		printf( "total: %" PRIi64 " snapshots, entities %.1f byte-aligned / %.1f bit-packed bytes per snapshot (%.1f%%), %i angle bits\n",
+				total.frames, (double)total.byteEntities / total.frames, (double)total.bitEntities / total.frames,
+				total.byteEntities ? 100.0 * total.bitEntities / total.byteEntities : 0.0, angleBits );
+	}
+
+	return total.mismatches ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,217 @@
+/*
+Copyright (C) 2018 Warsow development team
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+// sndmix_bench -- mixes synthetic channels into a paint buffer and clips it
+// to 16-bit output with the snd_qf kernels, no audio device needed
+//
+// usage: sndmix_bench [channels] [iterations]
+
+#include "../../gameshared/q_arch.h"
+#include "../../snd_qf/snd_mixkernels.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/time.h>
+#endif
+
+#define DEFAULT_CHANNELS    64
+#define DEFAULT_ITERATIONS  200
+#define PAINT_FRAMES        2048    // same as the mixer's paint buffer
+#define SOUND_FRAMES        ( PAINT_FRAMES + 7 )
+#define RAMP_FRAMES         128
+
+#define BENCH_MAX( a, b ) ( ( a ) > ( b ) ? ( a ) : ( b ) )
+
+typedef struct {
+	int width, channels;
+	int offset, count;      // paint buffer range covered by the channel
+	sndMixRamp_t ramp;
+	uint8_t *samples;
+} benchChannel_t;
+
+typedef struct {
+	double generic, simd;
+	bool exact;
+} benchResult_t;
+
+static unsigned seed = 0x1234567;
+
+/*
+* Bench_Microseconds
+*/
+static uint64_t Bench_Microseconds( void ) {
+#ifdef _WIN32
+	static LARGE_INTEGER freq;
+	LARGE_INTEGER now;
+	if( !freq.QuadPart ) {
+		QueryPerformanceFrequency( &freq );
+	}
+	QueryPerformanceCounter( &now );
+	return ( uint64_t )( now.QuadPart * 1000000 / freq.QuadPart );
+#else
+	struct timeval tv;
+	gettimeofday( &tv, NULL );
+	return ( uint64_t )tv.tv_sec * 1000000 + tv.tv_usec;
+#endif
+}
+
+/*
+* Bench_Random
+*/
+static unsigned Bench_Random( void ) {
+	seed = seed * 1103515245 + 12345;
+	return seed >> 8;
+}
+
+/*
+* Bench_InitChannel
+*
+* Random format, odd offsets and lengths to exercise the scalar tails,
+* and a volume ramp on every other channel.
+*/
+static void Bench_InitChannel( benchChannel_t *ch, int num ) {
+	int i, size, left, right;
+
+	ch->width = num & 1 ? 2 : 1;
+	ch->channels = num & 2 ? 2 : 1;
+	ch->offset = Bench_Random() % 16;
+	ch->count = PAINT_FRAMES - ch->offset - Bench_Random() % 16;
+
+	size = SOUND_FRAMES * ch->width * ch->channels;
+	ch->samples = malloc( size );
+	for( i = 0; i < size; i++ ) {
+		ch->samples[i] = Bench_Random() & 255;
+	}
+
+	left = Bench_Random() % ( S_MIX_MAX_VOLUME + 1 );
+	right = Bench_Random() % ( S_MIX_MAX_VOLUME + 1 );
+	ch->ramp.left = left << 8;
+	ch->ramp.right = right << 8;
+	ch->ramp.leftStep = ch->ramp.rightStep = 0;
+	if( num & 4 ) {
+		// stays in range over the whole run, the mixer only ramps the first frames
+		ch->ramp.leftStep = ( ( (int)( Bench_Random() % ( S_MIX_MAX_VOLUME + 1 ) ) - left ) << 8 ) / ch->count;
+		ch->ramp.rightStep = ( ( (int)( Bench_Random() % ( S_MIX_MAX_VOLUME + 1 ) ) - right ) << 8 ) / ch->count;
+	}
+}
+
+/*
+* Bench_Mix
+*/
+static void Bench_Mix( int *paint, const benchChannel_t *chans, int numChannels,
+					   void ( *mix )( int *, const void *, int, int, int, const sndMixRamp_t * ) ) {
+	int i;
+
+	memset( paint, 0, PAINT_FRAMES * 2 * sizeof( *paint ) );
+	for( i = 0; i < numChannels; i++ ) {
+		const benchChannel_t *ch = &chans[i];
+		mix( paint + ch->offset * 2, ch->samples, ch->count, ch->width, ch->channels, &ch->ramp );
+	}
+}
+
+/*
+* Bench_Run
+*/
+static void Bench_Run( const benchChannel_t *chans, int numChannels, int iterations,
+					   benchResult_t *mix, benchResult_t *clip ) {
+	int i;
+	uint64_t t;
+	int *a = malloc( PAINT_FRAMES * 2 * sizeof( *a ) ), *b = malloc( PAINT_FRAMES * 2 * sizeof( *b ) );
+	short *oa = malloc( PAINT_FRAMES * 2 * sizeof( *oa ) ), *ob = malloc( PAINT_FRAMES * 2 * sizeof( *ob ) );
+
+	memset( mix, 0, sizeof( *mix ) );
+	memset( clip, 0, sizeof( *clip ) );
+
+	for( i = 0; i < iterations; i++ ) {
+		t = Bench_Microseconds();
+		Bench_Mix( a, chans, numChannels, S_MixSamples_Generic );
+		mix->generic += Bench_Microseconds() - t;
+
+		t = Bench_Microseconds();
+		Bench_Mix( b, chans, numChannels, S_MixSamples );
+		mix->simd += Bench_Microseconds() - t;
+	}
+
+	mix->exact = memcmp( a, b, PAINT_FRAMES * 2 * sizeof( *a ) ) == 0;
+
+	// with this many channels plenty of samples are out of range
+	clip->exact = true;
+	for( i = 0; i < iterations; i++ ) {
+		bool swap = ( i & 1 ) != 0;
+
+		t = Bench_Microseconds();
+		S_ClipSamples_Generic( a, oa, PAINT_FRAMES - ( i & 3 ), swap );
+		clip->generic += Bench_Microseconds() - t;
+
+		t = Bench_Microseconds();
+		S_ClipSamples( a, ob, PAINT_FRAMES - ( i & 3 ), swap );
+		clip->simd += Bench_Microseconds() - t;
+
+		if( memcmp( oa, ob, ( PAINT_FRAMES - ( i & 3 ) ) * 2 * sizeof( *oa ) ) ) {
+			clip->exact = false;
+		}
+	}
+
+	mix->generic /= iterations;
+	mix->simd /= iterations;
+	clip->generic /= iterations;
+	clip->simd /= iterations;
+
+	free( a );
+	free( b );
+	free( oa );
+	free( ob );
+}
+
+int main( int argc, char **argv ) {
+	int i, numChannels = DEFAULT_CHANNELS, iterations = DEFAULT_ITERATIONS;
+	benchChannel_t *chans;
+	benchResult_t mix, clip;
+
+	if( argc > 1 ) {
+		numChannels = BENCH_MAX( atoi( argv[1] ), 1 );
+	}
+	if( argc > 2 ) {
+		iterations = BENCH_MAX( atoi( argv[2] ), 1 );
+	}
+
+	chans = malloc( numChannels * sizeof( *chans ) );
+	for( i = 0; i < numChannels; i++ ) {
+		Bench_InitChannel( &chans[i], i );
+	}
+
+	printf( "sndmix_bench: %s kernels, %i channels, %i frames, %i iterations, generic / vectorized times\n",
+			S_MixArch(), numChannels, PAINT_FRAMES, iterations );
+
+	Bench_Run( chans, numChannels, iterations, &mix, &clip );
+
+	printf( "mix  %9.2f / %9.2f us (%.2fx)%s\n", mix.generic, mix.simd,
+			mix.simd > 0 ? mix.generic / mix.simd : 0.0, mix.exact ? "" : " MISMATCH" );
+	printf( "clip %9.2f / %9.2f us (%.2fx)%s\n", clip.generic, clip.simd,
+			clip.simd > 0 ? clip.generic / clip.simd : 0.0, clip.exact ? "" : " MISMATCH" );
+
+	for( i = 0; i < numChannels; i++ ) {
+		free( chans[i].samples );
+	}
+	free( chans );
+
+	return mix.exact && clip.exact ? EXIT_SUCCESS : EXIT_FAILURE;
+}
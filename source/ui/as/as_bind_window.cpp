@@ -90,6 +90,7 @@ public:
 		return ui_document->getRocketDocument();
 	}
 
+	/// Queues the document to be loaded in the background.
 	void preload( const asstring_t &location ) {
 		if( !UI_Main::preloadEnabled() ) {
 			return;
@@ -99,7 +100,7 @@ public:
 		if( stack == NULL ) {
 			return;
 		}
-		stack->preloadDocument( location.buffer );
+		stack->enqueuePreload( location.buffer );
 	}
 
 	/// Loads modal document from the URL.
@@ -6,9 +6,17 @@
 #include "as/asui_local.h"
 
 #include <list>
+#include <map>
+#include <vector>
 
 #define UI_AS_MODULE "UI_AS_MODULE"
 
+// compiled modules are cached in memory and on disk, keyed by the module name
+// and validated against a hash of all script sections
+#define UI_AS_BYTECODE_MAGIC        ( 'U' | ( 'I' << 8 ) | ( 'B' << 16 ) | ( 'C' << 24 ) )
+#define UI_AS_BYTECODE_VERSION      1
+#define UI_AS_BYTECODE_FILE_FORMAT  "cache/ui/%08x.asbc"
+
 namespace ASUI
 {
 
@@ -18,63 +26,49 @@ typedef WSWUI::UI_Main UI_Main;
 
 class BinaryBufferStream : public asIBinaryStream
 {
-	// TODO: use vector!
-	unsigned char *data;
-	size_t size;        // size of data stored
-	size_t allocated;   // actual allocated size
+	std::vector<unsigned char> data;
 	size_t offset;      // read-head
+	bool overrun;
 
 public:
-	BinaryBufferStream() : data( 0 ), size( 0 ), allocated( 0 ), offset( 0 ) {
+	BinaryBufferStream() : offset( 0 ), overrun( false ) {
 	}
 
-	BinaryBufferStream( void *_data, size_t _size )
-		: data( 0 ), size( _size ), allocated( _size ), offset( 0 ) {
-		data = __newa__( unsigned char, _size );
-		memcpy( data, _data, _size );
+	BinaryBufferStream( const void *_data, size_t _size )
+		: data( ( const unsigned char * )_data, ( const unsigned char * )_data + _size ), offset( 0 ), overrun( false ) {
 	}
 
-	~BinaryBufferStream() {
-		if( data ) {
-			__delete__( data );
-		}
-	}
+	size_t getDataSize() { return data.size(); }
+	void *getData() { return data.empty() ? NULL : &data[0]; }
 
-	size_t getDataSize() { return size; }
-	void *getData() { return data; }
+	// true if there was an attempt to read past the end of the data
+	bool hasOverrun() const { return overrun; }
 
 	// asIBinaryStream implementation
 	void Read( void *ptr, asUINT _size ) {
-		if( !data || !ptr ) {
+		if( !ptr ) {
 			trap::Error( "BinaryBuffer::Read null pointer" );
 			return;
 		}
-		if( ( offset + _size ) > allocated ) {
-			trap::Error( "BinaryBuffer::Read tried to read more bytes than available" );
+		if( ( offset + _size ) > data.size() ) {
+			// truncated data, the caller is expected to check hasOverrun
+			memset( ptr, 0, _size );
+			offset = data.size();
+			overrun = true;
 			return;
 		}
 
-		memcpy( ptr, data + offset, _size );
+		memcpy( ptr, &data[offset], _size );
 		offset += _size;
 	}
 
 	void Write( const void *ptr, asUINT _size ) {
-		if( !data || !ptr ) {
+		if( !ptr ) {
 			trap::Error( "BinaryBuffer::Write null pointer" );
 			return;
 		}
 
-		if( ( size + _size ) > allocated ) {
-			// reallocate
-			allocated = size + _size;
-			unsigned char *tmp = __newa__( unsigned char, allocated );    // allocate little more?
-			memcpy( tmp, data, size );
-			__delete__( data );   // note! regular delete works for unsigned char*
-			data = tmp;
-		}
-
-		memcpy( data + size, ptr, _size );
-		size += _size;
+		data.insert( data.end(), ( const unsigned char * )ptr, ( const unsigned char * )ptr + _size );
 	}
 };
 
@@ -131,6 +125,18 @@ public:
 
 //=======================================
 
+typedef struct {
+	unsigned int magic;
+	unsigned int version;
+	unsigned int apiVersion;
+	unsigned int asVersion;
+	unsigned int hash;      // hash of the script sections
+	unsigned int nameLength;
+	unsigned int size;      // size of the byte code following the module name
+} byteCodeHeader_t;
+
+//=======================================
+
 class ASModule : public ASInterface
 {
 	UI_Main *ui_main;
@@ -139,15 +145,152 @@ class ASModule : public ASInterface
 	struct angelwrap_api_s *as_api;
 	asIObjectType *stringObjectType;
 
+	cvar_t *ui_scriptcache;
+
 	static const asDWORD accessMask = 0x1;
 
+	// script sections are held back until the module is built, so that
+	// compiling can be skipped altogether if we have cached byte code
+	struct PendingBuild {
+		unsigned int hash;
+		std::vector<std::pair<std::string, std::string> > sections;
+
+		PendingBuild() : hash( 0x811c9dc5 ) {}
+	};
+	typedef std::map<asIScriptModule *, PendingBuild> PendingBuildMap;
+	PendingBuildMap pendingBuilds;
+
+	struct CachedByteCode {
+		unsigned int hash;
+		std::vector<unsigned char> data;
+	};
+	typedef std::map<std::string, CachedByteCode> ByteCodeCache;
+	ByteCodeCache byteCodeCache;
+
+	// FNV-1a, including the terminating zero
+	static unsigned int hashString( unsigned int hash, const char *str ) {
+		do {
+			hash = ( hash ^ ( unsigned char )*str ) * 0x01000193;
+		} while( *str++ );
+		return hash;
+	}
+
+	static void byteCodeFileName( const char *name, char *path, size_t size ) {
+		Q_snprintfz( path, size, UI_AS_BYTECODE_FILE_FORMAT, hashString( 0x811c9dc5, name ) );
+	}
+
+	static void initByteCodeHeader( byteCodeHeader_t *header, const char *name, unsigned int hash, size_t size ) {
+		header->magic = UI_AS_BYTECODE_MAGIC;
+		header->version = UI_AS_BYTECODE_VERSION;
+		header->apiVersion = UI_API_VERSION;
+		header->asVersion = ANGELSCRIPT_VERSION;
+		header->hash = hash;
+		header->nameLength = strlen( name );
+		header->size = size;
+	}
+
+	bool readByteCodeFile( const char *name, unsigned int hash, std::vector<unsigned char> &data ) {
+		int fh;
+		int length;
+		bool valid;
+		byteCodeHeader_t header, expected;
+		char path[MAX_QPATH];
+
+		byteCodeFileName( name, path, sizeof( path ) );
+		length = trap::FS_FOpenFile( path, &fh, FS_READ | FS_CACHE );
+		if( length == -1 ) {
+			return false;
+		}
+
+		valid = false;
+		if( length > (int)sizeof( header ) && trap::FS_Read( &header, sizeof( header ), fh ) == sizeof( header ) ) {
+			initByteCodeHeader( &expected, name, hash, header.size );
+			if( !memcmp( &header, &expected, sizeof( header ) ) && header.size && header.nameLength
+				&& (size_t)length == sizeof( header ) + header.nameLength + header.size ) {
+				std::vector<char> storedName( header.nameLength );
+
+				// the file name is only a hash, make sure this is the right module
+				if( trap::FS_Read( &storedName[0], header.nameLength, fh ) == (int)header.nameLength
+					&& !memcmp( &storedName[0], name, header.nameLength ) ) {
+					data.resize( header.size );
+					valid = trap::FS_Read( &data[0], header.size, fh ) == (int)header.size;
+				}
+			}
+		}
+
+		trap::FS_FCloseFile( fh );
+		return valid;
+	}
+
+	void writeByteCodeFile( const char *name, unsigned int hash, const std::vector<unsigned char> &data ) {
+		int fh;
+		byteCodeHeader_t header;
+		char path[MAX_QPATH];
+
+		byteCodeFileName( name, path, sizeof( path ) );
+		if( trap::FS_FOpenFile( path, &fh, FS_WRITE | FS_CACHE ) == -1 ) {
+			Com_Printf( S_COLOR_YELLOW "Could not open %s for writing.\n", path );
+			return;
+		}
+
+		initByteCodeHeader( &header, name, hash, data.size() );
+		trap::FS_Write( &header, sizeof( header ), fh );
+		trap::FS_Write( name, header.nameLength, fh );
+		trap::FS_Write( &data[0], data.size(), fh );
+		trap::FS_FCloseFile( fh );
+	}
+
+	bool loadByteCode( asIScriptModule *module, const char *name, unsigned int hash ) {
+		ByteCodeCache::iterator it = byteCodeCache.find( name );
+
+		if( it == byteCodeCache.end() || it->second.hash != hash ) {
+			CachedByteCode cached;
+
+			if( !readByteCodeFile( name, hash, cached.data ) ) {
+				return false;
+			}
+			cached.hash = hash;
+
+			it = byteCodeCache.insert( std::make_pair( std::string( name ), CachedByteCode() ) ).first;
+			it->second.hash = hash;
+			it->second.data.swap( cached.data );
+		}
+
+		BinaryBufferStream stream( &it->second.data[0], it->second.data.size() );
+		if( module->LoadByteCode( &stream ) < 0 || stream.hasOverrun() ) {
+			// the module is rebuilt from source, which also resets it
+			byteCodeCache.erase( it );
+			return false;
+		}
+
+		if( ui_main->debugOn() ) {
+			Com_Printf( "ASModule: loaded cached byte code for %s\n", name );
+		}
+		return true;
+	}
+
+	void saveByteCode( asIScriptModule *module, const char *name, unsigned int hash ) {
+		BinaryBufferStream stream;
+
+		if( module->SaveByteCode( &stream ) < 0 || !stream.getDataSize() ) {
+			return;
+		}
+
+		CachedByteCode &cached = byteCodeCache[name];
+		cached.hash = hash;
+		cached.data.assign( ( unsigned char * )stream.getData(), ( unsigned char * )stream.getData() + stream.getDataSize() );
+
+		writeByteCodeFile( name, hash, cached.data );
+	}
+
 // private class, its ok to have everything as public :)
 
 public:
 	ASModule()
 		: ui_main( 0 ), engine( 0 ),
 		as_api( 0 ),
-		stringObjectType( 0 ) {
+		stringObjectType( 0 ),
+		ui_scriptcache( 0 ) {
 	}
 
 	virtual ~ASModule( void ) {
@@ -172,6 +315,8 @@ public:
 
 		engine->SetDefaultAccessMask( accessMask );
 
+		ui_scriptcache = trap::Cvar_Get( "ui_scriptcache", "1", CVAR_ARCHIVE );
+
 		stringObjectType = engine->GetObjectTypeById( engine->GetTypeIdByDecl( "String" ) );
 
 		/*
@@ -194,6 +339,9 @@ public:
 
 		as_api = NULL;
 
+		pendingBuilds.clear();
+		byteCodeCache.clear();
+
 		stringObjectType = 0;
 	}
 
@@ -249,20 +397,54 @@ public:
 		if( !module ) {
 			return false;
 		}
-		return module->Build() >= 0;
+
+		PendingBuildMap::iterator it = pendingBuilds.find( module );
+		if( it == pendingBuilds.end() ) {
+			return module->Build() >= 0;
+		}
+
+		PendingBuild build;
+		build.hash = it->second.hash;
+		build.sections.swap( it->second.sections );
+		pendingBuilds.erase( it );
+
+		const char *name = module->GetName();
+		bool useCache = ui_scriptcache->integer != 0;
+		if( useCache && loadByteCode( module, name, build.hash ) ) {
+			return true;
+		}
+
+		for( size_t i = 0; i < build.sections.size(); i++ ) {
+			module->AddScriptSection( build.sections[i].first.c_str(), build.sections[i].second.c_str() );
+		}
+
+		if( module->Build() < 0 ) {
+			return false;
+		}
+
+		// inline event handlers are only compiled into the module later on,
+		// so this is just the code from the script sections
+		if( useCache ) {
+			saveByteCode( module, name, build.hash );
+		}
+		return true;
 	}
 
 	virtual bool addScript( asIScriptModule *module, const char *name, const char *code ) {
-		// TODO: precache SaveByteCode/LoadByteCode
-		// (this can be done on a global .rml level too)
 		// TODO: figure out if name can be NULL, or otherwise create
 		// temp name from NULL argument to differentiate <script> tags
 		// without source
 		if( !module ) {
 			return false;
 		}
+		if( !name ) {
+			name = "";
+		}
 
-		return module->AddScriptSection( name, code ) >= 0;
+		PendingBuild &build = pendingBuilds[module];
+		build.hash = hashString( hashString( build.hash, name ), code );
+		build.sections.push_back( std::make_pair( std::string( name ), std::string( code ) ) );
+		return true;
 	}
 
 	virtual bool addFunction( asIScriptModule *module, const char *name, const char *code, asIScriptFunction **outFunction ) {
@@ -270,8 +452,6 @@ public:
 		return module ? ( module->CompileFunction( name, code, 0, asCOMP_ADD_TO_MODULE, outFunction ) >= 0 ) : false;
 	}
 
-	// TODO: disk/mem-cache fully compiled set (use Binary*Stream)
-
 	// testing, dumpapi, note that path has to end with '/'
 	virtual void dumpAPI( const char *path, bool markdown, bool singleFile, unsigned andMask, unsigned notMask ) {
 		if( andMask == 0 ) {
@@ -286,6 +466,7 @@ public:
 
 	virtual void buildReset( asIScriptModule *module ) {
 		if( engine && module ) {
+			pendingBuilds.erase( module );
 			module->Discard();
 		}
 		garbageCollectFullCycle();
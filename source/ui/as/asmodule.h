@@ -45,6 +45,7 @@ public:
 	virtual asIScriptModule *startBuilding( const char *moduleName ) = 0;
 
 	// compile all added scripts, set final module name
+	// byte code of unchanged scripts is loaded from the cache instead
 	virtual bool finishBuilding( asIScriptModule *module ) = 0;
 
 	// adds a script either to module, or the following.
@@ -76,13 +77,6 @@ public:
 
 	// creates a new dictionary object, which can be natively passed on to scripts
 	virtual CScriptDictionaryInterface *createDictionary( void ) = 0;
-
-	// caching, TODO!
-	// void *getBytecode(size_t &size);
-	// void setByteCode(void *bytecode, size_t size);
-
-	// void saveBytecode(const char *filename);
-	// void loadBytecode(const char *filename);
 };
 
 ASInterface * GetASModule( WSWUI::UI_Main *main );
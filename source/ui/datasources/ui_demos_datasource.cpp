@@ -32,6 +32,9 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #define PATH_ROOT       "demos"
 #define PATH_PARENT     ".."
 
+// number of rows to notify listeners of per frame
+#define ROWS_PER_FRAME  64
+
 namespace WSWUI
 {
 
@@ -74,6 +77,9 @@ void DemoCollection::PopulateList( void ) {
 	numDirectories = demoList.size();
 
 	getFileList( demoList, fullPath, demoExtension.c_str(), true );
+
+	// have the engine read meta data of the listed demos in the background
+	trap::CL_IndexDemos( path.c_str() );
 }
 
 bool DemoCollection::IsRoot( void ) const {
@@ -133,10 +139,10 @@ bool DemosDataSourceHelper::UpdateFrame( int *firstRowAdded, int *numRowsAdded )
 		return false;
 	}
 
-	// add 1 row at a time
+	// add rows in batches, as thousands of demos take too long to add one per frame
 	*firstRowAdded = int( updateIndex );
-	*numRowsAdded = 1;
-	updateIndex++;
+	*numRowsAdded = int( std::min( demoList.size() - updateIndex, DemoList::size_type( ROWS_PER_FRAME ) ) );
+	updateIndex += *numRowsAdded;
 
 	return true;
 }
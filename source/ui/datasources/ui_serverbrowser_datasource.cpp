@@ -369,21 +369,29 @@ void ServerInfoFetcher::updateFrame() {
 
 	// populate active queries with ones on the waiting line
 	if( now > lastQueryTime + QUERY_TIMEOUT_MSEC && numWaiting() > 0 ) {
+		std::string cmd( "pingserver" );
+
 		lastQueryTime = now;
-		startQuery( serverQueue.front() );
-		serverQueue.pop();
+		for( unsigned int i = 0; i < QUERY_BATCH && numWaiting() > 0; i++ ) {
+			startQuery( serverQueue.front(), cmd );
+			serverQueue.pop();
+		}
+
+		// execute command to initiate the queries
+		cmd += "\n";
+		trap::Cmd_ExecuteText( EXEC_APPEND, cmd.c_str() );
 	}
 }
 
 // initiates a query
-void ServerInfoFetcher::startQuery( const std::string &adr ) {
+void ServerInfoFetcher::startQuery( const std::string &adr, std::string &cmd ) {
 	numIssuedQueries++;
 
 	// add to the active list
 	activeQueries.push_back( std::make_pair( trap::Milliseconds(), adr ) );
 
-	// execute command to initiate the query
-	trap::Cmd_ExecuteText( EXEC_APPEND, va( "pingserver %s\n", adr.c_str() ) );
+	cmd += " ";
+	cmd += adr;
 }
 
 //=====================================
@@ -517,6 +525,82 @@ void ServerBrowserDataSource::addServerToTable( ServerInfo &info, const String &
 	}
 }
 
+// merges a batch of servers, which are not in the table yet and are sorted by compare, into the table
+template<typename Comparator>
+void ServerBrowserDataSource::mergeServersToTable( ReferenceList &referenceList, const std::vector<ServerInfo *> &added,
+												   Comparator compare, const String &tableName ) {
+	ReferenceList::iterator it = referenceList.begin();
+	int index = 0, runStart = 0, runLength = 0;
+
+	for( std::vector<ServerInfo *>::const_iterator it_added = added.begin(); it_added != added.end(); ++it_added ) {
+		// same position lower_bound would give, the batch is sorted so we never go back
+		while( it != referenceList.end() && compare( *it, *it_added ) ) {
+			++it;
+			++index;
+		}
+
+		referenceList.insert( it, *it_added );
+
+		// notify rocket on runs of adjacent rows, rows after the run aren't in the list yet
+		if( runLength && runStart + runLength != index ) {
+			NotifyRowAdd( tableName, runStart, runLength );
+			runLength = 0;
+		}
+		if( !runLength ) {
+			runStart = index;
+		}
+		runLength++;
+		index++;
+	}
+
+	if( runLength ) {
+		NotifyRowAdd( tableName, runStart, runLength );
+	}
+}
+
+void ServerBrowserDataSource::addServersToTable( const ReferenceList &batch, const String &tableName ) {
+	ReferenceList &referenceList = referenceListMap[tableName];
+	std::set<ServerInfo *> pending( batch.begin(), batch.end() );
+	std::vector<ServerInfo *> added;
+	int index = 0, runStart = 0, runLength = 0;
+
+	// notify rocket on the change of rows already in the table
+	for( ReferenceList::iterator it = referenceList.begin(); it != referenceList.end() && !pending.empty(); ++it, ++index ) {
+		std::set<ServerInfo *>::iterator it_p = pending.find( *it );
+		if( it_p == pending.end() ) {
+			continue;
+		}
+		pending.erase( it_p );
+
+		if( runLength && runStart + runLength != index ) {
+			NotifyRowChange( tableName, runStart, runLength );
+			runLength = 0;
+		}
+		if( !runLength ) {
+			runStart = index;
+		}
+		runLength++;
+	}
+
+	if( runLength ) {
+		NotifyRowChange( tableName, runStart, runLength );
+	}
+
+	if( pending.empty() ) {
+		return;
+	}
+
+	// sort the new ones and merge them in a single pass
+	added.assign( pending.begin(), pending.end() );
+	if( sortDirection < 0 ) {
+		std::sort( added.begin(), added.end(), sortCompare );
+		mergeServersToTable( referenceList, added, sortCompare, tableName );
+	} else {
+		std::sort( added.begin(), added.end(), ServerInfo::ReverseComparePtrFunction( sortCompare ) );
+		mergeServersToTable( referenceList, added, ServerInfo::InvertComparePtrFunction( sortCompare ), tableName );
+	}
+}
+
 void ServerBrowserDataSource::removeServerFromTable( ServerInfo &info, const String &tableName ) {
 	ReferenceList &referenceList = referenceListMap[tableName];
 
@@ -541,26 +625,35 @@ void ServerBrowserDataSource::updateFrame() {
 	// query queue
 	fetcher.updateFrame();
 
-	// incoming info queue
-	if( trap::Milliseconds() > lastUpdateTime + REFRESH_TIMEOUT_MSEC ) {
+	// incoming info queue, merged into the tables in bulk
+	if( !referenceQueue.empty() ) {
+		ReferenceListMap batches;
+
 		while( referenceQueue.size() > 0 ) {
-			ServerInfo &serverInfo = *( referenceQueue.front() );
+			ServerInfo *serverInfo = referenceQueue.front();
 
 			// yes this is safe, its only a pointer
 			referenceQueue.pop_front();
 
 			// put to the visible list if it passes the filters
-			if( filter.filterServer( serverInfo ) ) {
+			if( filter.filterServer( *serverInfo ) ) {
 				String tableName;
 
-				tableNameForServerInfo( serverInfo, tableName );
-				addServerToTable( serverInfo, tableName );
+				tableNameForServerInfo( *serverInfo, tableName );
+				batches[tableName].push_back( serverInfo );
 
-				if( serverInfo.favorite ) {
-					addServerToTable( serverInfo, TABLE_NAME_FAVORITES );
+				if( serverInfo->favorite ) {
+					batches[TABLE_NAME_FAVORITES].push_back( serverInfo );
 				}
 			}
 		}
+
+		for( ReferenceListMap::iterator it = batches.begin(); it != batches.end(); ++it ) {
+			addServersToTable( it->second, it->first );
+		}
+	}
+
+	if( trap::Milliseconds() > lastUpdateTime + REFRESH_TIMEOUT_MSEC ) {
 		lastUpdateTime = trap::Milliseconds();
 
 		if( active && fetcher.numActive() == 0 && fetcher.numWaiting() == 0 && fetcher.numIssued() > 0 ) {
@@ -125,6 +125,15 @@ public:
 		}
 	};
 
+	// strict weak ordering counterpart of the above, for std::sort
+	struct ReverseComparePtrFunction {
+		ComparePtrFunction function;
+		ReverseComparePtrFunction( ComparePtrFunction _function ) : function( _function ) {}
+		bool operator()( const ServerInfo *lhs, const ServerInfo *rhs ) {
+			return function( rhs, lhs );
+		}
+	};
+
 	// struct that can be used for both values and pointers
 	template<typename T, T ServerInfo::*comp_member>
 	struct _LessBinary {
@@ -197,7 +206,8 @@ class ServerInfoFetcher
 {
 	// amount if simultaneous queries
 	static const unsigned int TIMEOUT_SEC = 5;      // secs until we replace with another job
-	static const unsigned int QUERY_TIMEOUT_MSEC = 50;      // time between subsequent queries to individual servers
+	static const unsigned int QUERY_TIMEOUT_MSEC = 50;      // time between subsequent batches of queries
+	static const unsigned int QUERY_BATCH = 10;             // queries per batch, the client paces the actual packets
 
 	// waiting line
 	typedef std::queue<std::string> StringQueue;
@@ -240,8 +250,8 @@ private:
 		}
 	};
 
-	// initiates a query
-	void startQuery( const std::string &adr );
+	// initiates a query, the command is executed by the caller
+	void startQuery( const std::string &adr, std::string &cmd );
 };
 
 //================================================
@@ -259,7 +269,7 @@ class ServerBrowserDataSource : public Rocket::Controls::DataSource
 	typedef std::pair<ServerInfoList::iterator, bool> ServerInfoListPair;
 
 	static const unsigned int MAX_RETRIES = 3;
-	static const unsigned int REFRESH_TIMEOUT_MSEC = 1000;      // time between subsequent table updates
+	static const unsigned int REFRESH_TIMEOUT_MSEC = 1000;      // time between checks for the end of an update
 
 	// constants
 	/*
@@ -398,6 +408,10 @@ private:
 
 	void tableNameForServerInfo( const ServerInfo &, String &table ) const;
 	void addServerToTable( ServerInfo &info, const String &tableName );
+	void addServersToTable( const ReferenceList &batch, const String &tableName );
+	template<typename Comparator>
+	void mergeServersToTable( ReferenceList &referenceList, const std::vector<ServerInfo *> &added,
+							  Comparator compare, const String &tableName );
 	void removeServerFromTable( ServerInfo &info, const String &tableName );
 	void notifyOfFavoriteChange( uint64_t iaddr, bool add );
 };
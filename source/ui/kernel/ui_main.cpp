@@ -35,6 +35,11 @@
 #include "formatters/ui_empty_formatter.h"
 #include "formatters/ui_serverflags_formatter.h"
 
+// don't preload documents in the menu before it's been idle for this long
+#define UI_PRELOAD_IDLE_TIME    1000
+// minimum time between preloading two documents
+#define UI_PRELOAD_INTERVAL     100
+
 namespace WSWUI
 {
 UI_Main *UI_Main::self = 0;
@@ -55,7 +60,7 @@ UI_Main::UI_Main( int vidWidth, int vidHeight, float pixelRatio,
 
 	// other members
 	overlayMenuURL( "" ),
-	mousex( 0 ), mousey( 0 ), gameProtocol( protocol ),
+	mousex( 0 ), mousey( 0 ), lastInputTime( 0 ), nextPreloadTime( 0 ), gameProtocol( protocol ),
 	menuVisible( false ), overlayMenuVisible( false ), forceMenu( false ), showNavigationStack( false ),
 	demoExtension( demoExtension ), invalidateAjaxCache( false ),
 	ui_basepath( nullptr ), ui_cursor( nullptr ), ui_developer( nullptr ), ui_preload( nullptr ) {
@@ -288,6 +293,34 @@ void UI_Main::loadCursor( void ) {
 	rocketModule->loadCursor( UI_CONTEXT_OVERLAY, basecursor.c_str() );
 }
 
+void UI_Main::preloadDocuments( void ) {
+	if( !preloadEnabled() ) {
+		return;
+	}
+
+	// the menu is forced on the connect screen, don't slow down loading
+	if( forceMenu ) {
+		return;
+	}
+	if( menuVisible && refreshState.time < lastInputTime + UI_PRELOAD_IDLE_TIME ) {
+		return;
+	}
+	if( refreshState.time < nextPreloadTime ) {
+		return;
+	}
+
+	// one document at a time
+	for( int i = 0; i < UI_NUM_CONTEXTS; i++ ) {
+		UI_Navigation &navigation = navigations[i];
+		for( UI_Navigation::iterator it = navigation.begin(); it != navigation.end(); ++it ) {
+			if( ( *it )->preloadNext() ) {
+				nextPreloadTime = refreshState.time + UI_PRELOAD_INTERVAL;
+				return;
+			}
+		}
+	}
+}
+
 bool UI_Main::initRocket( void ) {
 	// this may throw runtime_error.. ok pass it back up
 	rocketModule = __new__( RocketModule )( refreshState.width, refreshState.height, refreshState.pixelRatio );
@@ -641,6 +674,10 @@ void UI_Main::mouseMove( int contextId, int frameTime, int x, int y, bool absolu
 		mousedy = mousey - oldmousey;
 	}
 
+	if( mousex != oldmousex || mousey != oldmousey ) {
+		lastInputTime = refreshState.time;
+	}
+
 	rocketModule->mouseMove( contextId, mousex, mousey );
 
 	if( showCursor ) {
@@ -655,11 +692,13 @@ bool UI_Main::mouseHover( int contextId ) {
 }
 
 void UI_Main::textInput( int contextId, wchar_t c ) {
+	lastInputTime = refreshState.time;
 	rocketModule->textInput( contextId, c );
 }
 
 void UI_Main::keyEvent( int contextId, int key, bool pressed ) {
 	// TODO: handle some special keys here?
+	lastInputTime = refreshState.time;
 	rocketModule->keyEvent( contextId, key, pressed );
 }
 
@@ -797,6 +836,8 @@ void UI_Main::refreshScreen( unsigned int time, int clientState, int serverState
 		}
 	}
 
+	preloadDocuments();
+
 	// stuff we need to render without using rocket
 	customRender();
 
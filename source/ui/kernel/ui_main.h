@@ -152,6 +152,9 @@ private:
 
 	void loadCursor( void );
 
+	// loads queued documents while the player is in game or idle in the menu
+	void preloadDocuments( void );
+
 
 	/**
 	 * Adds cursor movement from the gamepad sticks.
@@ -211,6 +214,9 @@ private:
 	int mousex, mousey;
 	int mousedx, mousedy; // relative mouse movement for this frame
 
+	int64_t lastInputTime;
+	int64_t nextPreloadTime;
+
 	int gameProtocol;
 	bool menuVisible;
 	bool overlayMenuVisible;
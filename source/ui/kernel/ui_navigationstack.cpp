@@ -9,6 +9,9 @@ namespace WSWUI
 
 namespace Core = Rocket::Core;
 
+#define UI_PRELOAD_MAX_QUEUED       32
+#define UI_PRELOAD_MAX_TRANSITIONS  3
+
 //==========================================
 
 // DocumentCache
@@ -52,6 +55,11 @@ Document *DocumentCache::getDocument( const std::string &name, NavigationStack *
 	return document;
 }
 
+bool DocumentCache::hasDocument( const std::string &name ) {
+	Document match( name );
+	return documentSet.find( &match ) != documentSet.end();
+}
+
 // release document
 DocumentCache::DocumentSet::iterator DocumentCache::purgeDocument( DocumentSet::iterator it ) {
 	Document *doc = *it;
@@ -212,6 +220,11 @@ Document *NavigationStack::pushDocument( const std::string &name, bool modal, bo
 	documentStack.push_back( doc );
 	modalTop = modal;
 
+	// modal documents are unloaded when popped, so don't bother preloading them
+	if( !modal ) {
+		learnTransition( top ? top->getName() : "", documentRealname );
+	}
+
 	attachMainEventListenerToTop( top );
 
 	// show doc, do stuff.. install eventlisteners?
@@ -244,6 +257,69 @@ Document *NavigationStack::preloadDocument( const std::string &name ) {
 	return doc;
 }
 
+void NavigationStack::enqueuePreload( const std::string &name ) {
+	std::string documentRealname = getFullpath( name );
+
+	if( !documentRealname.length() || cache.hasDocument( documentRealname ) ) {
+		return;
+	}
+	if( std::find( preloadQueue.begin(), preloadQueue.end(), documentRealname ) != preloadQueue.end() ) {
+		return;
+	}
+	if( preloadQueue.size() >= UI_PRELOAD_MAX_QUEUED ) {
+		return;
+	}
+
+	preloadQueue.push_back( documentRealname );
+}
+
+bool NavigationStack::preloadNext( void ) {
+	if( stackLocked ) {
+		return false;
+	}
+
+	// documents likely to be opened next from the top of the stack
+	Document *top = !documentStack.empty() ? documentStack.back() : nullptr;
+	TransitionMap::iterator it = transitions.find( top ? top->getName() : "" );
+	if( it != transitions.end() ) {
+		for( DocumentNameList::iterator next = it->second.begin(); next != it->second.end(); ++next )
+			enqueuePreload( *next );
+	}
+
+	while( !preloadQueue.empty() ) {
+		std::string name = preloadQueue.front();
+		preloadQueue.pop_front();
+
+		// might have been pushed meanwhile
+		if( cache.hasDocument( name ) ) {
+			continue;
+		}
+
+		if( UI_Main::Get()->debugOn() ) {
+			Com_Printf( "NavigationStack::preloadNext preloading %s\n", name.c_str() );
+		}
+
+		if( !preloadDocument( name ) ) {
+			// don't keep retrying documents that fail to load
+			for( it = transitions.begin(); it != transitions.end(); ++it )
+				it->second.remove( name );
+		}
+		return true;
+	}
+
+	return false;
+}
+
+void NavigationStack::learnTransition( const std::string &from, const std::string &to ) {
+	DocumentNameList &next = transitions[from];
+
+	next.remove( to );
+	next.push_front( to );
+	if( next.size() > UI_PRELOAD_MAX_TRANSITIONS ) {
+		next.pop_back();
+	}
+}
+
 void NavigationStack::_popDocument( bool focusOnNext ) {
 	modalTop = false;
 
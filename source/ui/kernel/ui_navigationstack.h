@@ -3,6 +3,7 @@
 #define __NAVIGATIONSTACK_H__
 
 #include <list>
+#include <map>
 #include <set>
 #include <string>
 
@@ -21,6 +22,7 @@ public:
 
 	// load or fetch document
 	Document *getDocument( const std::string &name, NavigationStack *stack = NULL );
+	bool hasDocument( const std::string &name );
 	// release document
 	void purgeDocument( Document *doc );
 	// release all documents
@@ -78,6 +80,10 @@ public:
 	// stack operations
 	Document *pushDocument( const std::string &name, bool modal = false, bool show = true );
 	Document *preloadDocument( const std::string &name );
+	// queues document for preloading in the background
+	void enqueuePreload( const std::string &name );
+	// loads the next queued document that isn't cached yet, returns false if there was none
+	bool preloadNext( void );
 	void popDocument( void );
 	void popAllDocuments( void );
 	bool hasDocuments( void ) const;
@@ -105,6 +111,7 @@ public:
 private:
 	void _popDocument( bool focusOnNext = true );
 	void attachMainEventListenerToTop( Document *prev );
+	void learnTransition( const std::string &from, const std::string &to );
 
 	std::string getFullpath( const std::string &name );
 
@@ -121,6 +128,14 @@ private:
 	// locking the stack prevents documents from being pushed into the stack
 	bool stackLocked;
 	std::string defaultPath;
+
+	typedef std::list<std::string> DocumentNameList;
+	// documents to preload, full paths
+	DocumentNameList preloadQueue;
+	// documents recently pushed on top of each document, most recent first,
+	// the empty name stands for the bottom of the stack
+	typedef std::map<std::string, DocumentNameList> TransitionMap;
+	TransitionMap transitions;
 };
 
 }
@@ -289,6 +289,10 @@ inline size_t CL_ReadDemoMetaData( const char *demopath, char *meta_data, size_t
 	return UI_IMPORT.CL_ReadDemoMetaData( demopath, meta_data, meta_data_size );
 }
 
+inline void CL_IndexDemos( const char *dir ) {
+	UI_IMPORT.CL_IndexDemos( dir );
+}
+
 inline int CL_PlayerNum( void ) {
 	return UI_IMPORT.CL_PlayerNum();
 }